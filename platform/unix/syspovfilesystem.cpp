@@ -38,13 +38,15 @@
 #include "syspovfilesystem.h"
 
 // C++ variants of C standard header files
-//  (none at the moment)
+#include <cstdio>
 
 // C++ standard header files
 #include <limits>
 
 // POSIX standard header files
 #include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 // POV-Ray header files (base module)
@@ -73,6 +75,33 @@ bool DeleteFile(const UCS2String& fileName)
 
 //******************************************************************************
 
+#if !POV_USE_DEFAULT_RENAMEFILE
+
+bool RenameFile(const UCS2String& oldName, const UCS2String& newName)
+{
+    return (std::rename(UCS2toSysString(oldName).c_str(), UCS2toSysString(newName).c_str()) == 0);
+}
+
+#endif // POV_USE_DEFAULT_RENAMEFILE
+
+//******************************************************************************
+
+#if !POV_USE_DEFAULT_FILEINFO
+
+bool GetFileInfo(const UCS2String& fileName, std::int_least64_t& size, std::int_least64_t& modified)
+{
+    struct stat info;
+    if ((stat(UCS2toSysString(fileName).c_str(), &info) != 0) || !S_ISREG(info.st_mode))
+        return false;
+    size = std::int_least64_t(info.st_size);
+    modified = std::int_least64_t(info.st_mtime);
+    return true;
+}
+
+#endif // POV_USE_DEFAULT_FILEINFO
+
+//******************************************************************************
+
 #if !POV_USE_DEFAULT_LARGEFILE
 
 #ifndef POVUNIX_LSEEK64
@@ -144,6 +173,77 @@ void LargeFile::Close()
 
 //******************************************************************************
 
+#if !POV_USE_DEFAULT_MAPPEDFILE
+
+struct MappedFile::Data final
+{
+    void* address;
+    std::size_t size;
+    Data() : address(nullptr), size(0) {}
+};
+
+MappedFile::MappedFile() :
+    mpData(new Data)
+{}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+bool MappedFile::Open(const UCS2String& fileName)
+{
+    Close();
+
+    int handle = open(UCS2toSysString(fileName).c_str(), O_RDONLY);
+    if (handle == -1)
+        return false;
+
+    struct stat info;
+    if ((fstat(handle, &info) != 0) || (info.st_size <= 0) ||
+        (std::uintmax_t(info.st_size) > std::numeric_limits<std::size_t>::max()))
+    {
+        close(handle);
+        return false;
+    }
+
+    void* address = mmap(nullptr, std::size_t(info.st_size), PROT_READ, MAP_SHARED, handle, 0);
+
+    // The mapping remains valid after the file has been closed.
+    close(handle);
+
+    if (address == MAP_FAILED)
+        return false;
+
+    mpData->address = address;
+    mpData->size = std::size_t(info.st_size);
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (mpData->address != nullptr)
+    {
+        munmap(mpData->address, mpData->size);
+        mpData->address = nullptr;
+        mpData->size = 0;
+    }
+}
+
+const void* MappedFile::GetData() const
+{
+    return mpData->address;
+}
+
+std::size_t MappedFile::GetSize() const
+{
+    return mpData->size;
+}
+
+#endif // POV_USE_DEFAULT_MAPPEDFILE
+
+//******************************************************************************
+
 #if !POV_USE_DEFAULT_TEMPORARYFILE
 
 static UCS2String gTempPath;
@@ -84,6 +84,36 @@ bool DeleteFile(const UCS2String& fileName)
 
 //******************************************************************************
 
+#if !POV_USE_DEFAULT_RENAMEFILE
+
+bool RenameFile(const UCS2String& oldName, const UCS2String& newName)
+{
+    // TODO - use `MoveFileExW()` instead.
+    return (MoveFileExA(UCS2toSysString(oldName).c_str(), UCS2toSysString(newName).c_str(),
+                        MOVEFILE_REPLACE_EXISTING) != 0);
+}
+
+#endif // POV_USE_DEFAULT_RENAMEFILE
+
+//******************************************************************************
+
+#if !POV_USE_DEFAULT_FILEINFO
+
+bool GetFileInfo(const UCS2String& fileName, std::int_least64_t& size, std::int_least64_t& modified)
+{
+    // TODO - use `_wstat64()` instead.
+    struct _stat64 info;
+    if ((_stat64(UCS2toSysString(fileName).c_str(), &info) != 0) || ((info.st_mode & _S_IFREG) == 0))
+        return false;
+    size = std::int_least64_t(info.st_size);
+    modified = std::int_least64_t(info.st_mtime);
+    return true;
+}
+
+#endif // POV_USE_DEFAULT_FILEINFO
+
+//******************************************************************************
+
 #if !POV_USE_DEFAULT_LARGEFILE
 
 using Offset = decltype(_lseeki64(0,0,0));
@@ -152,6 +182,89 @@ void LargeFile::Close()
 
 //******************************************************************************
 
+#if !POV_USE_DEFAULT_MAPPEDFILE
+
+struct MappedFile::Data final
+{
+    HANDLE mapping;
+    const void* address;
+    std::size_t size;
+    Data() : mapping(nullptr), address(nullptr), size(0) {}
+};
+
+MappedFile::MappedFile() :
+    mpData(new Data)
+{}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+bool MappedFile::Open(const UCS2String& fileName)
+{
+    Close();
+
+    HANDLE file = CreateFileW(reinterpret_cast<const wchar_t*>(fileName.c_str()), GENERIC_READ, FILE_SHARE_READ,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || (size.QuadPart <= 0) ||
+        (std::uintmax_t(size.QuadPart) > std::numeric_limits<std::size_t>::max()))
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    // The mapping remains valid after the file has been closed.
+    CloseHandle(file);
+
+    if (mapping == nullptr)
+        return false;
+
+    const void* address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (address == nullptr)
+    {
+        CloseHandle(mapping);
+        return false;
+    }
+
+    mpData->mapping = mapping;
+    mpData->address = address;
+    mpData->size = std::size_t(size.QuadPart);
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (mpData->address != nullptr)
+    {
+        UnmapViewOfFile(mpData->address);
+        CloseHandle(mpData->mapping);
+        mpData->mapping = nullptr;
+        mpData->address = nullptr;
+        mpData->size = 0;
+    }
+}
+
+const void* MappedFile::GetData() const
+{
+    return mpData->address;
+}
+
+std::size_t MappedFile::GetSize() const
+{
+    return mpData->size;
+}
+
+#endif // POV_USE_DEFAULT_MAPPEDFILE
+
+//******************************************************************************
+
 #if !POV_USE_DEFAULT_TEMPORARYFILE
 
 static std::wstring GetTempFilePath()
@@ -508,12 +508,299 @@ void AVX2FMA3DNoise(Vector3d& result, const Vector3d& EPoint)
 
 }
 
+
+/*****************************************************************************
+* Multi-point noise
+******************************************************************************/
+
+/// Lattice cell data for four scaled copies of a point, one lane per copy.
+///
+/// @note
+///     The existing single-point functions already use the vector registers across the four
+///     gradient coefficients; batching only pays off where all four lanes carry a point, so
+///     leftover points are handed to those functions instead of padding the lanes.
+///
+struct AVX2FMA3NoiseLanes final
+{
+    __m256d x_ix, x_jx, y_iy, y_jy, z_iz, z_jz;
+    __m256d sz, tz;
+    __m256d txty, sxty, txsy, sxsy;
+    int iz[4];
+    int ixiy_hash[4], jxiy_hash[4], ixjy_hash[4], jxjy_hash[4];
+};
+
+static inline void AVX2FMA3SetupLanes(AVX2FMA3NoiseLanes& l, const Vector3d& EPoint, const DBL *scale)
+{
+    const __m256d ONE_PD = _mm256_set1_pd(1.0);
+    const __m256d epsy = _mm256_set1_pd(1.0 - EPSILON);
+
+    const __m256d s_vec = _mm256_loadu_pd(scale);
+
+    const __m256d x = _mm256_mul_pd(_mm256_set1_pd(EPoint[X]), s_vec);
+    const __m256d y = _mm256_mul_pd(_mm256_set1_pd(EPoint[Y]), s_vec);
+    const __m256d z = _mm256_mul_pd(_mm256_set1_pd(EPoint[Z]), s_vec);
+
+    const __m128i tmp_x = _mm256_cvttpd_epi32(_mm256_blendv_pd(x, _mm256_sub_pd(x, epsy), x));
+    const __m128i tmp_y = _mm256_cvttpd_epi32(_mm256_blendv_pd(y, _mm256_sub_pd(y, epsy), y));
+    const __m128i tmp_z = _mm256_cvttpd_epi32(_mm256_blendv_pd(z, _mm256_sub_pd(z, epsy), z));
+
+    const __m128i mask = _mm_set1_epi32(0xfff);
+    alignas(16) int ix[4], iy[4];
+    _mm_store_si128((__m128i*)(ix), _mm_and_si128(_mm_sub_epi32(tmp_x, _mm_set1_epi32(NOISE_MINX)), mask));
+    _mm_store_si128((__m128i*)(iy), _mm_and_si128(_mm_sub_epi32(tmp_y, _mm_set1_epi32(NOISE_MINY)), mask));
+    _mm_storeu_si128((__m128i*)(l.iz), _mm_and_si128(_mm_sub_epi32(tmp_z, _mm_set1_epi32(NOISE_MINZ)), mask));
+
+    l.x_ix = _mm256_sub_pd(x, _mm256_cvtepi32_pd(tmp_x));
+    l.y_iy = _mm256_sub_pd(y, _mm256_cvtepi32_pd(tmp_y));
+    l.z_iz = _mm256_sub_pd(z, _mm256_cvtepi32_pd(tmp_z));
+    l.x_jx = _mm256_sub_pd(l.x_ix, ONE_PD);
+    l.y_jy = _mm256_sub_pd(l.y_iy, ONE_PD);
+    l.z_jz = _mm256_sub_pd(l.z_iz, ONE_PD);
+
+    const __m256d THREE_PD = _mm256_set1_pd(3.0);
+    const __m256d sx = _mm256_mul_pd(l.x_ix, _mm256_mul_pd(l.x_ix, _mm256_sub_pd(THREE_PD, _mm256_add_pd(l.x_ix, l.x_ix))));
+    const __m256d sy = _mm256_mul_pd(l.y_iy, _mm256_mul_pd(l.y_iy, _mm256_sub_pd(THREE_PD, _mm256_add_pd(l.y_iy, l.y_iy))));
+    l.sz = _mm256_mul_pd(l.z_iz, _mm256_mul_pd(l.z_iz, _mm256_sub_pd(THREE_PD, _mm256_add_pd(l.z_iz, l.z_iz))));
+
+    const __m256d tx = _mm256_sub_pd(ONE_PD, sx);
+    const __m256d ty = _mm256_sub_pd(ONE_PD, sy);
+    l.tz = _mm256_sub_pd(ONE_PD, l.sz);
+
+    l.txty = _mm256_mul_pd(tx, ty);
+    l.sxty = _mm256_mul_pd(sx, ty);
+    l.txsy = _mm256_mul_pd(tx, sy);
+    l.sxsy = _mm256_mul_pd(sx, sy);
+
+    for (int k = 0; k < 4; k++)
+    {
+        l.ixiy_hash[k] = Hash2d(ix[k],     iy[k]);
+        l.jxiy_hash[k] = Hash2d(ix[k] + 1, iy[k]);
+        l.ixjy_hash[k] = Hash2d(ix[k],     iy[k] + 1);
+        l.jxjy_hash[k] = Hash2d(ix[k] + 1, iy[k] + 1);
+    }
+}
+
+/// Evaluate one lattice corner's gradient for four lanes.
+///
+/// The four table rows are loaded and transposed, so that each register holds one
+/// coefficient for all four lanes.
+///
+static inline __m256d AVX2FMA3CornerLanes(const int *hash, const int *iz, int dz, int offset,
+                                          const __m256d& x, const __m256d& y, const __m256d& z)
+{
+    const __m256d r0 = LOAD_32BYTES_FROM_TABLE(&AVX2RTable[Hash1dRTableIndexAVX(hash[0], iz[0] + dz)] + offset);
+    const __m256d r1 = LOAD_32BYTES_FROM_TABLE(&AVX2RTable[Hash1dRTableIndexAVX(hash[1], iz[1] + dz)] + offset);
+    const __m256d r2 = LOAD_32BYTES_FROM_TABLE(&AVX2RTable[Hash1dRTableIndexAVX(hash[2], iz[2] + dz)] + offset);
+    const __m256d r3 = LOAD_32BYTES_FROM_TABLE(&AVX2RTable[Hash1dRTableIndexAVX(hash[3], iz[3] + dz)] + offset);
+
+    const __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+    const __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+    const __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+    const __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+
+    const __m256d c0 = _mm256_permute2f128_pd(t0, t2, 0x20);
+    const __m256d c1 = _mm256_permute2f128_pd(t1, t3, 0x20);
+    const __m256d c2 = _mm256_permute2f128_pd(t0, t2, 0x31);
+    const __m256d c3 = _mm256_permute2f128_pd(t1, t3, 0x31);
+
+    return FMA_PD(c3, z, FMA_PD(c2, y, FMA_PD(c1, x, _mm256_mul_pd(c0, _mm256_set1_pd(0.5)))));
+}
+
+#define INCSUMAVX_LANES(sum,hash,dz,offset,w,x,y,z) \
+    sum = FMA_PD(w, AVX2FMA3CornerLanes(l.hash, l.iz, dz, offset, l.x, l.y, l.z), sum)
+
+/*****************************************************************************
+*
+* FUNCTION
+*
+*   AVX2FMA3MultiNoise
+*
+* INPUT
+*
+*   EPoint -- 3-D point at which noise is evaluated
+*   scale  -- Factors by which to scale the point
+*   count  -- Number of factors
+*
+* OUTPUT
+*
+*   DBL *result
+*
+* RETURNS
+*
+* AUTHOR
+*
+*   Robert Skinner based on Ken Perlin
+*
+* DESCRIPTION
+*   Version of "Noise" evaluating four points side by side.
+*
+* CHANGES
+*
+******************************************************************************/
+
+void AVX2FMA3MultiNoise(DBL *result, const Vector3d& EPoint, const DBL *scale, int count, int noise_generator)
+{
+    AVX2FMA3NoiseLanes l;
+
+    if (noise_generator == kNoiseGen_Perlin)
+    {
+        for (int k = 0; k < count; k++)
+            result[k] = AVX2FMA3Noise(EPoint * scale[k], noise_generator);
+        return;
+    }
+
+    __m256d bias, factor;
+    if (noise_generator == kNoiseGen_RangeCorrected)
+    {
+        // see AVX2FMA3Noise() for details of range here
+        bias   = _mm256_set1_pd(1.05242);
+        factor = _mm256_set1_pd(0.48985582);
+    }
+    else
+    {
+        bias   = _mm256_set1_pd(0.5);
+        factor = _mm256_set1_pd(1.0);
+    }
+
+    int first;
+    for (first = 0; first + 4 <= count; first += 4)
+    {
+        AVX2FMA3SetupLanes(l, EPoint, scale + first);
+
+        __m256d sumr  = _mm256_setzero_pd();
+        __m256d sumr1 = _mm256_setzero_pd();
+
+        INCSUMAVX_LANES(sumr,  ixiy_hash, 0, 0, _mm256_mul_pd(l.txty, l.tz), x_ix, y_iy, z_iz);
+        INCSUMAVX_LANES(sumr1, jxiy_hash, 0, 0, _mm256_mul_pd(l.sxty, l.tz), x_jx, y_iy, z_iz);
+        INCSUMAVX_LANES(sumr,  ixjy_hash, 0, 0, _mm256_mul_pd(l.txsy, l.tz), x_ix, y_jy, z_iz);
+        INCSUMAVX_LANES(sumr1, jxjy_hash, 0, 0, _mm256_mul_pd(l.sxsy, l.tz), x_jx, y_jy, z_iz);
+        INCSUMAVX_LANES(sumr,  ixiy_hash, 1, 0, _mm256_mul_pd(l.txty, l.sz), x_ix, y_iy, z_jz);
+        INCSUMAVX_LANES(sumr1, jxiy_hash, 1, 0, _mm256_mul_pd(l.sxty, l.sz), x_jx, y_iy, z_jz);
+        INCSUMAVX_LANES(sumr,  ixjy_hash, 1, 0, _mm256_mul_pd(l.txsy, l.sz), x_ix, y_jy, z_jz);
+        INCSUMAVX_LANES(sumr1, jxjy_hash, 1, 0, _mm256_mul_pd(l.sxsy, l.sz), x_jx, y_jy, z_jz);
+
+        sumr = _mm256_mul_pd(_mm256_add_pd(_mm256_add_pd(sumr, sumr1), bias), factor);
+        sumr = _mm256_min_pd(_mm256_max_pd(sumr, _mm256_setzero_pd()), _mm256_set1_pd(1.0));
+        _mm256_storeu_pd(result + first, sumr);
+    }
+
+    // Too few points left to fill all lanes.
+    for (; first < count; first++)
+        result[first] = AVX2FMA3Noise(EPoint * scale[first], noise_generator);
+
+#if CHECK_FUNCTIONAL
+    for (int k = 0; k < count; k++)
+    {
+        DBL orig_sum = PortableNoise(EPoint * scale[k], noise_generator);
+        if (fabs(orig_sum - result[k]) >= EPSILON)
+        {
+            throw POV_EXCEPTION_STRING("MultiNoise error");
+        }
+    }
+#endif
+
+    _mm256_zeroupper();
+}
+
+
+/*****************************************************************************
+*
+* FUNCTION
+*
+*   AVX2FMA3MultiDNoise
+*
+* INPUT
+*
+*   EPoint -- 3-D point at which noise is evaluated
+*   scale  -- Factors by which to scale the point
+*   count  -- Number of factors
+*
+* OUTPUT
+*
+*   Vector3d *result
+*
+* RETURNS
+*
+* AUTHOR
+*
+*   Robert Skinner based on Ken Perlin
+*
+* DESCRIPTION
+*   Version of "DNoise" evaluating four points side by side.
+*
+* CHANGES
+*
+******************************************************************************/
+
+#define INCSUMAVX_LANES_VECTOR(hash,dz,w,x,y,z) \
+    ss = w; \
+    INCSUMAVX_LANES(rx, hash, dz, 0, ss, x, y, z); \
+    INCSUMAVX_LANES(ry, hash, dz, 4, ss, x, y, z); \
+    INCSUMAVX_LANES(rz, hash, dz, 8, ss, x, y, z);
+
+void AVX2FMA3MultiDNoise(Vector3d *result, const Vector3d& EPoint, const DBL *scale, int count)
+{
+    AVX2FMA3NoiseLanes l;
+    alignas(32) DBL resx[4], resy[4], resz[4];
+    __m256d ss;
+
+    int first;
+    for (first = 0; first + 4 <= count; first += 4)
+    {
+        AVX2FMA3SetupLanes(l, EPoint, scale + first);
+
+        __m256d rx = _mm256_setzero_pd(), ry = _mm256_setzero_pd(), rz = _mm256_setzero_pd();
+
+        INCSUMAVX_LANES_VECTOR(ixiy_hash, 0, _mm256_mul_pd(l.txty, l.tz), x_ix, y_iy, z_iz);
+        INCSUMAVX_LANES_VECTOR(jxiy_hash, 0, _mm256_mul_pd(l.sxty, l.tz), x_jx, y_iy, z_iz);
+        INCSUMAVX_LANES_VECTOR(jxjy_hash, 0, _mm256_mul_pd(l.sxsy, l.tz), x_jx, y_jy, z_iz);
+        INCSUMAVX_LANES_VECTOR(ixjy_hash, 0, _mm256_mul_pd(l.txsy, l.tz), x_ix, y_jy, z_iz);
+        INCSUMAVX_LANES_VECTOR(ixjy_hash, 1, _mm256_mul_pd(l.txsy, l.sz), x_ix, y_jy, z_jz);
+        INCSUMAVX_LANES_VECTOR(jxjy_hash, 1, _mm256_mul_pd(l.sxsy, l.sz), x_jx, y_jy, z_jz);
+        INCSUMAVX_LANES_VECTOR(jxiy_hash, 1, _mm256_mul_pd(l.sxty, l.sz), x_jx, y_iy, z_jz);
+        INCSUMAVX_LANES_VECTOR(ixiy_hash, 1, _mm256_mul_pd(l.txty, l.sz), x_ix, y_iy, z_jz);
+
+        _mm256_store_pd(resx, rx);
+        _mm256_store_pd(resy, ry);
+        _mm256_store_pd(resz, rz);
+
+        for (int k = 0; k < 4; k++)
+            result[first + k] = Vector3d(resx[k], resy[k], resz[k]);
+    }
+
+    // Too few points left to fill all lanes.
+    for (; first < count; first++)
+        AVX2FMA3DNoise(result[first], EPoint * scale[first]);
+
+#if CHECK_FUNCTIONAL
+    for (int k = 0; k < count; k++)
+    {
+        Vector3d portable_res;
+        PortableDNoise(portable_res, EPoint * scale[k]);
+        if ((fabs(portable_res[X] - result[k][X]) >= EPSILON) ||
+            (fabs(portable_res[Y] - result[k][Y]) >= EPSILON) ||
+            (fabs(portable_res[Z] - result[k][Z]) >= EPSILON))
+        {
+            throw POV_EXCEPTION_STRING("MultiDNoise error");
+        }
+    }
+#endif
+
+    _mm256_zeroupper();
+}
+
+#undef INCSUMAVX_LANES_VECTOR
+#undef INCSUMAVX_LANES
+
+
 #else // DISABLE_OPTIMIZED_NOISE_AVX2FMA3
 
 const bool kAVX2FMA3NoiseEnabled = false;
 void AVX2FMA3NoiseInit() { POV_ASSERT(false); }
 DBL AVX2FMA3Noise(const Vector3d& EPoint, int noise_generator) { POV_ASSERT(false); return 0.0; }
 void AVX2FMA3DNoise(Vector3d& result, const Vector3d& EPoint) { POV_ASSERT(false); }
+void AVX2FMA3MultiNoise(DBL *result, const Vector3d& EPoint, const DBL *scale, int count, int noise_generator) { POV_ASSERT(false); }
+void AVX2FMA3MultiDNoise(Vector3d *result, const Vector3d& EPoint, const DBL *scale, int count) { POV_ASSERT(false); }
 
 #endif // DISABLE_OPTIMIZED_NOISE_AVX2FMA3
 
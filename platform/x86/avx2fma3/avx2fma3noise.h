@@ -57,6 +57,12 @@ DBL AVX2FMA3Noise(const Vector3d& EPoint, int noise_generator);
 /// @author Optimized by Intel
 void AVX2FMA3DNoise(Vector3d& result, const Vector3d& EPoint);
 
+/// Optimized MultiNoise function using AVX2 and FMA3 instructions.
+void AVX2FMA3MultiNoise(DBL *result, const Vector3d& EPoint, const DBL *scale, int count, int noise_generator);
+
+/// Optimized MultiDNoise function using AVX2 and FMA3 instructions.
+void AVX2FMA3MultiDNoise(Vector3d *result, const Vector3d& EPoint, const DBL *scale, int count);
+
 }
 // end of namespace pov
 
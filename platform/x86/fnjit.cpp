@@ -0,0 +1,1090 @@
+//******************************************************************************
+///
+/// @file platform/x86/fnjit.cpp
+///
+/// This module translates the instruction set of the function virtual machine
+/// into native x86-64 code, using scalar SSE2 instructions.
+///
+/// @copyright
+/// @parblock
+///
+/// Persistence of Vision Ray Tracer ('POV-Ray') version 3.8.
+/// Copyright 1991-2019 Persistence of Vision Raytracer Pty. Ltd.
+///
+/// POV-Ray is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Affero General Public License as
+/// published by the Free Software Foundation, either version 3 of the
+/// License, or (at your option) any later version.
+///
+/// POV-Ray is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU Affero General Public License for more details.
+///
+/// You should have received a copy of the GNU Affero General Public License
+/// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// ----------------------------------------------------------------------------
+///
+/// POV-Ray is based on the popular DKB raytracer version 2.12.
+/// DKBTrace was originally written by David K. Buck.
+/// DKBTrace Ver 2.0-2.12 were written by David K. Buck & Aaron A. Collins.
+///
+/// @endparblock
+///
+//******************************************************************************
+
+// Unit header file must be the first file included within POV-Ray *.cpp files (pulls in config)
+#include "vm/fnpovfpu.h"
+
+#ifdef TRY_FUNCTION_JIT
+
+// C++ variants of C standard header files
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// C++ standard header files
+#include <algorithm>
+#include <exception>
+#include <vector>
+
+// other library header files
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+// POV-Ray header files (base module)
+#include "base/pov_err.h"
+
+// POV-Ray header files (core module)
+#include "core/scene/tracethreaddata.h"
+#include "core/support/statistics.h"
+
+// POV-Ray header files (VM module)
+#include "vm/fnintern.h"
+
+// this must be the last file included
+#include "base/povdebug.h"
+
+/*****************************************************************************
+*
+* Native code layout
+*
+* Each function is translated into a native routine taking a pointer to a
+* JITFrame, which holds the virtual machine state shared between a function
+* and the functions it calls.  While the routine runs, the registers of the
+* virtual machine are kept in the native registers listed below, and are
+* written back to the frame around calls into other code.
+*
+*   R0 - R7   xmm0 - xmm7
+*   scratch   xmm8
+*   frame     rbx
+*   SP(0)     r12 (address of the current stack position)
+*   CC        r14d
+*
+* Functions that use instructions the code generator does not handle (only
+* jsr at the moment), or that call such functions, are left to the
+* interpreter.  Native routines call each other directly, counting the
+* nesting depth in the frame to enforce the same recursion limit as the
+* interpreter; as the native stack must not overflow, exceeding the limit
+* is always a fatal error.
+*
+* Native code has no unwind information, so C++ exceptions must never pass
+* through it.  Helpers that may throw catch any exception, store it in the
+* frame and set its failure flag; the native code checks the flag after each
+* such call and returns immediately, and the exception is re-thrown once
+* control is back in C++.
+*
+******************************************************************************/
+
+namespace pov
+{
+
+using std::vector;
+
+struct JITFrame final
+{
+    DBL r[8];
+    DBL *stack;
+    DBL *globals;
+    FPUContext *context;
+    std::exception_ptr *exception;
+    unsigned int sp;
+    unsigned int ccr;
+    unsigned int maxstack;
+    unsigned int depth;
+    unsigned int failed;
+};
+
+typedef void (*JITRoutine)(JITFrame *frame);
+
+enum
+{
+    RAX = 0, RCX, RDX, RBX, RSP, RBP, RSI, RDI,
+    R8, R9, R10, R11, R12, R13, R14, R15
+};
+
+enum
+{
+    CC_B = 0x2, CC_AE = 0x3, CC_E = 0x4, CC_NE = 0x5, CC_BE = 0x6, CC_A = 0x7,
+    CC_P = 0xA, CC_NP = 0xB
+};
+
+enum
+{
+    CMP_EQ = 0, CMP_NE, CMP_LT, CMP_LE, CMP_GT, CMP_GE
+};
+
+const int kScratchXMM = 8;
+
+#if defined(_WIN32)
+const int kArgReg[3] = { RCX, RDX, R8 };
+const int kLocalStackSize = 32 + 3 * 16; // shadow space and saved xmm6 - xmm8
+#else
+const int kArgReg[3] = { RDI, RSI, RDX };
+const int kLocalStackSize = 0;
+#endif
+
+const unsigned int kLiteralAbsMask  = 0;
+const unsigned int kLiteralSignMask = 1;
+
+/*****************************************************************************
+* Helpers called from native code
+******************************************************************************/
+
+static void JITFail(JITFrame *frame)
+{
+    *frame->exception = std::current_exception();
+    frame->failed = 1;
+}
+
+static void JITException(JITFrame *frame, unsigned int fn, const char *msg)
+{
+    try
+    {
+        POVFPU_Exception(frame->context, fn, msg);
+    }
+    catch(...)
+    {
+        JITFail(frame);
+    }
+}
+
+static void JITRecursionLimit(JITFrame *frame, unsigned int fn)
+{
+    try
+    {
+        POVFPU_Exception(frame->context, fn, "Maximum function evaluation recursion level reached.");
+        throw POV_EXCEPTION_STRING("Maximum function evaluation recursion level reached.");
+    }
+    catch(...)
+    {
+        JITFail(frame);
+    }
+}
+
+static DBL JITMod(DBL a, DBL b)
+{
+    return fmod(a, b);
+}
+
+static DBL JITTrap(JITFrame *frame, unsigned int k, unsigned int fn)
+{
+    DBL r = 0.0;
+    try
+    {
+        r = POVFPU_TrapTable[k].fn(frame->context, &frame->stack[frame->sp], fn);
+    }
+    catch(...)
+    {
+        JITFail(frame);
+    }
+    frame->stack = frame->context->dblstackbase;
+    frame->maxstack = frame->context->maxdblstacksize;
+    return r;
+}
+
+static void JITTrapS(JITFrame *frame, unsigned int k, unsigned int fn)
+{
+    try
+    {
+        POVFPU_TrapSTable[k].fn(frame->context, &frame->stack[frame->sp], fn, frame->sp);
+    }
+    catch(...)
+    {
+        JITFail(frame);
+    }
+    frame->stack = frame->context->dblstackbase;
+    frame->maxstack = frame->context->maxdblstacksize;
+}
+
+static void JITGrow(JITFrame *frame, unsigned int k, unsigned int fn)
+{
+    FPUContext *context = frame->context;
+    unsigned int sp = frame->sp;
+
+    try
+    {
+        if((unsigned int)((unsigned int)sp + (unsigned int)k) >= (unsigned int)MAX_K)
+        {
+            POVFPU_Exception(context, fn, "Stack full. Possible infinite recursive function call.");
+        }
+        else if(sp + k >= context->maxdblstacksize)
+        {
+            context->maxdblstacksize = context->maxdblstacksize + std::max(k + 1, (unsigned int)INITIAL_DBL_STACK_SIZE);
+            context->dblstackbase = reinterpret_cast<DBL *>(POV_REALLOC(context->dblstackbase, sizeof(DBL) * context->maxdblstacksize, "fn: stack"));
+        }
+    }
+    catch(...)
+    {
+        JITFail(frame);
+    }
+
+    frame->stack = context->dblstackbase;
+    frame->maxstack = context->maxdblstacksize;
+}
+
+// Re-throws an exception caught by one of the helpers above, once the
+// native code has returned.
+static inline void JITCheckFailure(const JITFrame& frame)
+{
+    if(frame.failed != 0)
+        std::rethrow_exception(*frame.exception);
+}
+
+/*****************************************************************************
+* Code generator
+******************************************************************************/
+
+class JITCompiler final
+{
+    public:
+
+        JITCompiler(vector<FunctionEntry>& functions, vector<DBL>& consts, FUNCTION fn) :
+            functions(functions), consts(consts), fn(fn)
+        {
+            AddLiteral(0x7fffffffffffffffULL);
+            AddLiteral(0x8000000000000000ULL);
+        }
+
+        bool Compile(const FunctionCode& f);
+        const vector<unsigned char>& Code() const { return code; }
+
+    private:
+
+        struct Fixup
+        {
+            size_t pos;
+            unsigned int target;
+        };
+
+        vector<FunctionEntry>& functions;
+        vector<DBL>& consts;
+        FUNCTION fn;
+
+        vector<unsigned char> code;
+        vector<uint64_t> literals;
+        vector<Fixup> branchFixups;
+        vector<Fixup> literalFixups;
+        vector<size_t> exitFixups;
+
+        unsigned int AddLiteral(uint64_t bits);
+        unsigned int AddConstant(DBL v);
+
+        void Byte(unsigned int b) { code.push_back((unsigned char)b); }
+        void DWord(uint32_t v) { for(int i = 0; i < 4; i++) Byte((v >> (i * 8)) & 0xff); }
+        void QWord(uint64_t v) { for(int i = 0; i < 8; i++) Byte((v >> (i * 8)) & 0xff); }
+        void Patch(size_t pos, size_t target) { int32_t rel = (int32_t)(target - (pos + 4)); memcpy(&code[pos], &rel, 4); }
+
+        void Rex(bool w, int reg, int base);
+        void ModRMReg(int reg, int rm) { Byte(0xC0 | ((reg & 7) << 3) | (rm & 7)); }
+        void ModRMMem(int reg, int base, int32_t disp);
+
+        void SSE(int prefix, int op, int reg, int rm);
+        void SSEMem(int prefix, int op, int reg, int base, int32_t disp);
+        void SSELiteral(int prefix, int op, int reg, unsigned int literal);
+
+        void MovRR64(int dst, int src) { Rex(true, src, dst); Byte(0x89); ModRMReg(src, dst); }
+        void MovRI32(int dst, uint32_t imm) { Rex(false, 0, dst); Byte(0xB8 + (dst & 7)); DWord(imm); }
+        void MovRI64(int dst, uint64_t imm) { Rex(true, 0, dst); Byte(0xB8 + (dst & 7)); QWord(imm); }
+        void Load32(int dst, int base, int32_t disp) { Rex(false, dst, base); Byte(0x8B); ModRMMem(dst, base, disp); }
+        void Store32(int base, int32_t disp, int src) { Rex(false, src, base); Byte(0x89); ModRMMem(src, base, disp); }
+        void AluRI(bool w, int ext, int dst, uint32_t imm) { Rex(w, 0, dst); Byte(0x81); ModRMReg(ext, dst); DWord(imm); }
+        void AluMI32(int ext, int base, int32_t disp, uint32_t imm) { Rex(false, 0, base); Byte(0x81); ModRMMem(ext, base, disp); DWord(imm); }
+        void Store32Reg(int dst, int src) { Rex(false, src, dst); Byte(0x89); ModRMReg(src, dst); }
+        void Push(int reg) { Rex(false, 0, reg); Byte(0x50 + (reg & 7)); }
+        void Pop(int reg) { Rex(false, 0, reg); Byte(0x58 + (reg & 7)); }
+        size_t Jcc(int cc) { Byte(0x0F); Byte(0x80 + cc); DWord(0); return code.size() - 4; }
+        size_t Jmp() { Byte(0xE9); DWord(0); return code.size() - 4; }
+        void Call(const void *target) { MovRI64(RAX, (uint64_t)(uintptr_t)target); Byte(0xFF); Byte(0xD0); }
+
+        void SpillRegisters();
+        void ReloadRegisters(int first = 0);
+        void ReloadStackPointer();
+        void CompareToBool(int cmp, int a, int b);
+        void ConditionToRegister(int reg);
+        void CompareToCondition(int c, int d);
+        void SetFromCondition(int cc, int ccr, int reg);
+        void Branch(int cc, int ccr, unsigned int target);
+        void ExceptionUnless(int cc, const char *msg);
+        void Exception(const char *msg);
+        void ExitOnFailure();
+        void CallMod(int d, int s, bool literal, unsigned int k);
+        void Prologue();
+        void Epilogue();
+        void Link();
+};
+
+unsigned int JITCompiler::AddLiteral(uint64_t bits)
+{
+    for(unsigned int i = 0; i < literals.size(); i++)
+    {
+        if(literals[i] == bits)
+            return i;
+    }
+    literals.push_back(bits);
+    return (unsigned int)(literals.size() - 1);
+}
+
+unsigned int JITCompiler::AddConstant(DBL v)
+{
+    uint64_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    return AddLiteral(bits);
+}
+
+void JITCompiler::Rex(bool w, int reg, int base)
+{
+    unsigned int rex = 0x40 | (w ? 0x08 : 0) | ((reg & 8) ? 0x04 : 0) | ((base & 8) ? 0x01 : 0);
+    if(rex != 0x40)
+        Byte(rex);
+}
+
+void JITCompiler::ModRMMem(int reg, int base, int32_t disp)
+{
+    Byte(0x80 | ((reg & 7) << 3) | (base & 7));
+    if((base & 7) == RSP)
+        Byte(0x24);
+    DWord((uint32_t)disp);
+}
+
+void JITCompiler::SSE(int prefix, int op, int reg, int rm)
+{
+    if(prefix != 0)
+        Byte(prefix);
+    Rex(false, reg, rm);
+    Byte(0x0F);
+    Byte(op);
+    ModRMReg(reg, rm);
+}
+
+void JITCompiler::SSEMem(int prefix, int op, int reg, int base, int32_t disp)
+{
+    if(prefix != 0)
+        Byte(prefix);
+    Rex(false, reg, base);
+    Byte(0x0F);
+    Byte(op);
+    ModRMMem(reg, base, disp);
+}
+
+void JITCompiler::SSELiteral(int prefix, int op, int reg, unsigned int literal)
+{
+    if(prefix != 0)
+        Byte(prefix);
+    Rex(false, reg, 0);
+    Byte(0x0F);
+    Byte(op);
+    Byte(0x05 | ((reg & 7) << 3)); // rip-relative
+    literalFixups.push_back(Fixup{ code.size(), literal });
+    DWord(0);
+}
+
+void JITCompiler::SpillRegisters()
+{
+    for(int i = 0; i < 8; i++)
+        SSEMem(0xF2, 0x11, i, RBX, offsetof(JITFrame, r) + i * sizeof(DBL)); // movsd [rbx+r[i]], xmm(i)
+}
+
+void JITCompiler::ReloadRegisters(int first)
+{
+    for(int i = first; i < 8; i++)
+        SSEMem(0xF2, 0x10, i, RBX, offsetof(JITFrame, r) + i * sizeof(DBL)); // movsd xmm(i), [rbx+r[i]]
+}
+
+void JITCompiler::ReloadStackPointer()
+{
+    Load32(RAX, RBX, offsetof(JITFrame, sp));                           // mov  eax, [rbx+sp]
+    Rex(true, 0, RAX); Byte(0xC1); ModRMReg(4, RAX); Byte(3);           // shl  rax, 3
+    Rex(true, RAX, RBX); Byte(0x03); ModRMMem(RAX, RBX, offsetof(JITFrame, stack)); // add rax, [rbx+stack]
+    MovRR64(R12, RAX);                                                  // mov  r12, rax
+}
+
+// Sets al to the result of (a cmp b) with the semantics of the C++ operators, clobbers cl.
+void JITCompiler::CompareToBool(int cmp, int a, int b)
+{
+    switch(cmp)
+    {
+        case CMP_EQ:
+            SSE(0x66, 0x2E, a, b);                      // ucomisd a, b
+            Byte(0x0F); Byte(0x90 + CC_E); Byte(0xC0);  // sete  al
+            Byte(0x0F); Byte(0x90 + CC_NP); Byte(0xC1); // setnp cl
+            Byte(0x20); Byte(0xC8);                     // and   al, cl
+            break;
+        case CMP_NE:
+            SSE(0x66, 0x2E, a, b);                      // ucomisd a, b
+            Byte(0x0F); Byte(0x90 + CC_NE); Byte(0xC0); // setne al
+            Byte(0x0F); Byte(0x90 + CC_P); Byte(0xC1);  // setp  cl
+            Byte(0x08); Byte(0xC8);                     // or    al, cl
+            break;
+        case CMP_LT:
+            SSE(0x66, 0x2E, b, a);                      // ucomisd b, a
+            Byte(0x0F); Byte(0x90 + CC_A); Byte(0xC0);  // seta  al
+            break;
+        case CMP_LE:
+            SSE(0x66, 0x2E, b, a);                      // ucomisd b, a
+            Byte(0x0F); Byte(0x90 + CC_AE); Byte(0xC0); // setae al
+            break;
+        case CMP_GT:
+            SSE(0x66, 0x2E, a, b);                      // ucomisd a, b
+            Byte(0x0F); Byte(0x90 + CC_A); Byte(0xC0);  // seta  al
+            break;
+        case CMP_GE:
+            SSE(0x66, 0x2E, a, b);                      // ucomisd a, b
+            Byte(0x0F); Byte(0x90 + CC_AE); Byte(0xC0); // setae al
+            break;
+    }
+}
+
+// Converts the boolean in al to 0.0 or 1.0 in the given register.
+void JITCompiler::ConditionToRegister(int reg)
+{
+    Byte(0x0F); Byte(0xB6); Byte(0xC0);     // movzx eax, al
+    SSE(0xF2, 0x2A, reg, RAX);              // cvtsi2sd reg, eax
+}
+
+// Sets the condition code to the result of comparing Rd against c, as cmp does.
+void JITCompiler::CompareToCondition(int c, int d)
+{
+    CompareToBool(CMP_GT, c, d);
+    Byte(0x0F); Byte(0xB6); Byte(0xD0);     // movzx edx, al
+    Byte(0x01); Byte(0xD2);                 // add   edx, edx
+    CompareToBool(CMP_EQ, c, d);
+    Byte(0x0F); Byte(0xB6); Byte(0xC0);     // movzx eax, al
+    Byte(0x09); Byte(0xD0);                 // or    eax, edx
+    Store32Reg(R14, RAX);                   // mov   r14d, eax
+}
+
+void JITCompiler::SetFromCondition(int cc, int ccr, int reg)
+{
+    Rex(false, 0, R14); Byte(0x83); ModRMReg(7, R14); Byte(ccr); // cmp r14d, ccr
+    Byte(0x0F); Byte(0x90 + cc); Byte(0xC0);                      // setcc al
+    ConditionToRegister(reg);
+}
+
+void JITCompiler::Branch(int cc, int ccr, unsigned int target)
+{
+    Rex(false, 0, R14); Byte(0x83); ModRMReg(7, R14); Byte(ccr); // cmp r14d, ccr
+    branchFixups.push_back(Fixup{ Jcc(cc), target });
+}
+
+// Raises a function exception unless the flags satisfy the condition.
+void JITCompiler::ExceptionUnless(int cc, const char *msg)
+{
+    size_t skip = Jcc(cc);
+    Exception(msg);
+    Patch(skip, code.size());
+}
+
+void JITCompiler::Exception(const char *msg)
+{
+    SpillRegisters();
+    MovRR64(kArgReg[0], RBX);
+    MovRI32(kArgReg[1], fn);
+    MovRI64(kArgReg[2], (uint64_t)(uintptr_t)msg);
+    Call(reinterpret_cast<const void *>(JITException));
+    ExitOnFailure();
+    ReloadRegisters();
+}
+
+// Returns immediately if a helper or called function has failed.
+void JITCompiler::ExitOnFailure()
+{
+    AluMI32(7, RBX, offsetof(JITFrame, failed), 0);                 // cmp dword [rbx+failed], 0
+    exitFixups.push_back(Jcc(CC_NE));
+}
+
+void JITCompiler::CallMod(int d, int s, bool literal, unsigned int k)
+{
+    SpillRegisters();
+    if(d != 0)
+        SSEMem(0xF2, 0x10, 0, RBX, offsetof(JITFrame, r) + d * sizeof(DBL));       // movsd xmm0, [rbx+r[d]]
+    if(literal)
+        SSELiteral(0xF2, 0x10, 1, k);                                               // movsd xmm1, [rip+const]
+    else
+        SSEMem(0xF2, 0x10, 1, RBX, offsetof(JITFrame, r) + s * sizeof(DBL));       // movsd xmm1, [rbx+r[s]]
+    Call(reinterpret_cast<const void *>(JITMod));
+    SSEMem(0xF2, 0x11, 0, RBX, offsetof(JITFrame, r) + d * sizeof(DBL));           // movsd [rbx+r[d]], xmm0
+    ReloadRegisters();
+}
+
+void JITCompiler::Prologue()
+{
+    Push(RBX);
+    Push(R12);
+    Push(R14);
+    if(kLocalStackSize > 0)
+    {
+        AluRI(true, 5, RSP, kLocalStackSize);                   // sub rsp, size
+        for(int i = 6; i <= 8; i++)
+            SSEMem(0xF3, 0x7F, i, RSP, 32 + (i - 6) * 16);      // movdqu [rsp+n], xmm(i)
+    }
+    MovRR64(RBX, kArgReg[0]);
+    ReloadRegisters();
+    Load32(R14, RBX, offsetof(JITFrame, ccr));
+    ReloadStackPointer();
+}
+
+void JITCompiler::Epilogue()
+{
+    SpillRegisters();
+    Store32(RBX, offsetof(JITFrame, ccr), R14);
+    if(kLocalStackSize > 0)
+    {
+        for(int i = 6; i <= 8; i++)
+            SSEMem(0xF3, 0x6F, i, RSP, 32 + (i - 6) * 16);      // movdqu xmm(i), [rsp+n]
+        AluRI(true, 0, RSP, kLocalStackSize);                   // add rsp, size
+    }
+    Pop(R14);
+    Pop(R12);
+    Pop(RBX);
+    Byte(0xC3);
+}
+
+void JITCompiler::Link()
+{
+    // literal pool follows the code, aligned for the 128 bit masks
+    while((code.size() & 15) != 0)
+        Byte(0xCC);
+
+    size_t pool = code.size();
+
+    // masks are 128 bits wide, all other entries are scalar
+    QWord(literals[kLiteralAbsMask]);
+    QWord(literals[kLiteralAbsMask]);
+    QWord(literals[kLiteralSignMask]);
+    QWord(literals[kLiteralSignMask]);
+    for(size_t i = 2; i < literals.size(); i++)
+        QWord(literals[i]);
+
+    for(auto& f : literalFixups)
+    {
+        size_t offset = (f.target < 2) ? (f.target * 16) : (32 + (f.target - 2) * 8);
+        Patch(f.pos, pool + offset);
+    }
+}
+
+bool JITCompiler::Compile(const FunctionCode& f)
+{
+    vector<size_t> position(f.program_size);
+
+    Prologue();
+
+    for(unsigned int pc = 0; pc < f.program_size; pc++)
+    {
+        unsigned int op = GET_OP(f.program[pc]);
+        unsigned int k = GET_K(f.program[pc]);
+        int i = op >> 6;
+        int s = (op >> 3) & 7;
+        int d = op & 7;
+
+        position[pc] = code.size();
+
+        switch(i)
+        {
+            case 0: // add   Rs, Rd
+            case 1: // sub   Rs, Rd
+            case 2: // mul   Rs, Rd
+            case 3: // div   Rs, Rd
+                SSE(0xF2, (i == 0) ? 0x58 : (i == 1) ? 0x5C : (i == 2) ? 0x59 : 0x5E, d, s);
+                break;
+            case 4: // mod   Rs, Rd
+                CallMod(d, s, false, 0);
+                break;
+            case 5: // move  Rs, Rd
+                if(s != d)
+                    SSE(0x66, 0x28, d, s);                      // movapd d, s
+                break;
+            case 6: // cmp   Rs, Rd
+                CompareToCondition(s, d);
+                break;
+            case 7: // neg   Rs, Rd
+            case 8: // abs   Rs, Rd
+                if(s != d)
+                    SSE(0x66, 0x28, d, s);                      // movapd d, s
+                if(i == 7)
+                    SSELiteral(0x66, 0x57, d, kLiteralSignMask);  // xorpd d, sign
+                else
+                    SSELiteral(0x66, 0x54, d, kLiteralAbsMask);   // andpd d, abs
+                break;
+            case 9:
+                if((s < 7) && (k >= consts.size()))
+                    return false;
+                switch(s)
+                {
+                    case 0: // addi  k, Rd
+                    case 1: // subi  k, Rd
+                    case 2: // muli  k, Rd
+                    case 3: // divi  k, Rd
+                        SSELiteral(0xF2, (s == 0) ? 0x58 : (s == 1) ? 0x5C : (s == 2) ? 0x59 : 0x5E, d, AddConstant(consts[k]));
+                        break;
+                    case 4: // modi  k, Rd
+                        CallMod(d, 0, true, AddConstant(consts[k]));
+                        break;
+                    case 5: // loadi k, Rd
+                        SSELiteral(0xF2, 0x10, d, AddConstant(consts[k]));
+                        break;
+                    case 6: // cmpi  k, Rd
+                        SSELiteral(0xF2, 0x10, kScratchXMM, AddConstant(consts[k]));
+                        CompareToCondition(kScratchXMM, d);
+                        break;
+                }
+                break;
+            case 10:
+                switch(s)
+                {
+                    case 0: SetFromCondition(CC_E,  1, d); break; // seq   Rd
+                    case 1: SetFromCondition(CC_NE, 1, d); break; // sne   Rd
+                    case 2: SetFromCondition(CC_E,  2, d); break; // slt   Rd
+                    case 3: SetFromCondition(CC_AE, 1, d); break; // sle   Rd
+                    case 4: SetFromCondition(CC_E,  0, d); break; // sgt   Rd
+                    case 5: SetFromCondition(CC_BE, 1, d); break; // sge   Rd
+                    case 6: // teq   Rd
+                    case 7: // tne   Rd
+                        SSE(0x66, 0x57, kScratchXMM, kScratchXMM);          // xorpd xmm8, xmm8
+                        CompareToBool((s == 6) ? CMP_EQ : CMP_NE, d, kScratchXMM);
+                        ConditionToRegister(d);
+                        break;
+                }
+                break;
+            case 11:
+                if(s == 0) // load  0(k), Rd
+                {
+                    Rex(true, RAX, RBX); Byte(0x8B); ModRMMem(RAX, RBX, offsetof(JITFrame, globals)); // mov rax, [rbx+globals]
+                    SSEMem(0xF2, 0x10, d, RAX, k * sizeof(DBL));
+                }
+                else if(s == 1) // load  SP(k), Rd
+                    SSEMem(0xF2, 0x10, d, R12, k * sizeof(DBL));
+                break;
+            case 12:
+                if(s == 0) // store Rs, 0(k)
+                {
+                    Rex(true, RAX, RBX); Byte(0x8B); ModRMMem(RAX, RBX, offsetof(JITFrame, globals)); // mov rax, [rbx+globals]
+                    SSEMem(0xF2, 0x11, d, RAX, k * sizeof(DBL));
+                }
+                else if(s == 1) // store Rs, SP(k)
+                    SSEMem(0xF2, 0x11, d, R12, k * sizeof(DBL));
+                break;
+            case 13:
+                if(d != 0)
+                    break;
+                if(k >= f.program_size)
+                    return false;
+                switch(s)
+                {
+                    case 0: Branch(CC_E,  1, k); break; // beq   k
+                    case 1: Branch(CC_NE, 1, k); break; // bne   k
+                    case 2: Branch(CC_E,  2, k); break; // blt   k
+                    case 3: Branch(CC_AE, 1, k); break; // ble   k
+                    case 4: Branch(CC_E,  0, k); break; // bgt   k
+                    case 5: Branch(CC_BE, 1, k); break; // bge   k
+                }
+                break;
+            case 14:
+                if(s <= 5) // xeq ... xge   Rs
+                {
+                    static const int kXCC[6] = { CMP_EQ, CMP_NE, CMP_LT, CMP_LE, CMP_GT, CMP_GE };
+                    SSE(0x66, 0x57, kScratchXMM, kScratchXMM);              // xorpd xmm8, xmm8
+                    CompareToBool(kXCC[s], d, kScratchXMM);
+                    Byte(0x84); Byte(0xC0);                                 // test al, al
+                    ExceptionUnless(CC_E, nullptr);
+                }
+                else if(s == 6) // xdz   R0, Rs
+                {
+                    SSE(0x66, 0x57, kScratchXMM, kScratchXMM);              // xorpd xmm8, xmm8
+                    CompareToBool(CMP_EQ, 0, kScratchXMM);
+                    Byte(0x0F); Byte(0xB6); Byte(0xD0);                     // movzx edx, al
+                    CompareToBool(CMP_EQ, d, kScratchXMM);
+                    Byte(0x20); Byte(0xD0);                                 // and al, dl
+                    ExceptionUnless(CC_E, nullptr);
+                }
+                break;
+            case 15:
+                switch(op & 63)
+                {
+                    case 0: // jsr   k
+                        return false;
+                    case 1: // jmp   k
+                        if(k >= f.program_size)
+                            return false;
+                        branchFixups.push_back(Fixup{ Jmp(), k });
+                        break;
+                    case 2: // rts
+                        exitFixups.push_back(Jmp());
+                        break;
+                    case 3: // call  k
+                        if((k >= functions.size()) || (functions[k].reference_count == 0) || (functions[k].jit_code == nullptr))
+                            return false;
+                        AluMI32(0, RBX, offsetof(JITFrame, depth), 1);                  // add dword [rbx+depth], 1
+                        AluMI32(7, RBX, offsetof(JITFrame, depth), MAX_CALL_STACK_SIZE); // cmp dword [rbx+depth], MAX_CALL_STACK_SIZE
+                        {
+                            size_t ok = Jcc(CC_B);
+                            SpillRegisters();
+                            MovRR64(kArgReg[0], RBX);
+                            MovRI32(kArgReg[1], fn);
+                            Call(reinterpret_cast<const void *>(JITRecursionLimit));
+                            ExitOnFailure();
+                            ReloadRegisters();
+                            Patch(ok, code.size());
+                        }
+                        SpillRegisters();
+                        Store32(RBX, offsetof(JITFrame, ccr), R14);
+                        MovRR64(kArgReg[0], RBX);
+                        Call(functions[k].jit_code);
+                        ExitOnFailure();
+                        AluMI32(5, RBX, offsetof(JITFrame, depth), 1);                  // sub dword [rbx+depth], 1
+                        ReloadRegisters();
+                        Load32(R14, RBX, offsetof(JITFrame, ccr));
+                        ReloadStackPointer();
+                        break;
+                    case 4: // sys1  k
+                    case 5: // sys2  k
+                        if(k >= (((op & 63) == 4) ? POVFPU_Sys1TableSize : POVFPU_Sys2TableSize))
+                            return false;
+                        SpillRegisters();
+                        if((op & 63) == 4)
+                            Call(reinterpret_cast<const void *>(POVFPU_Sys1Table[k]));
+                        else
+                            Call(reinterpret_cast<const void *>(POVFPU_Sys2Table[k]));
+                        ReloadRegisters(1);
+                        break;
+                    case 6: // trap  k
+                    case 7: // traps k
+                        if(k >= (((op & 63) == 6) ? POVFPU_TrapTableSize : POVFPU_TrapSTableSize))
+                            return false;
+                        SpillRegisters();
+                        MovRR64(kArgReg[0], RBX);
+                        MovRI32(kArgReg[1], k);
+                        MovRI32(kArgReg[2], fn);
+                        if((op & 63) == 6)
+                        {
+                            Call(reinterpret_cast<const void *>(JITTrap));
+                            ExitOnFailure();
+                            ReloadRegisters(1);
+                        }
+                        else
+                        {
+                            Call(reinterpret_cast<const void *>(JITTrapS));
+                            ExitOnFailure();
+                            ReloadRegisters();
+                        }
+                        ReloadStackPointer();
+                        break;
+                    case 8: // grow  k
+                    {
+                        Load32(RAX, RBX, offsetof(JITFrame, sp));                   // mov eax, [rbx+sp]
+                        AluRI(false, 0, RAX, k);                                    // add eax, k
+                        AluRI(false, 7, RAX, MAX_K);                                // cmp eax, MAX_K
+                        size_t full = Jcc(CC_AE);
+                        Rex(false, RAX, RBX); Byte(0x3B); ModRMMem(RAX, RBX, offsetof(JITFrame, maxstack)); // cmp eax, [rbx+maxstack]
+                        size_t done = Jcc(CC_B);
+                        Patch(full, code.size());
+                        SpillRegisters();
+                        MovRR64(kArgReg[0], RBX);
+                        MovRI32(kArgReg[1], k);
+                        MovRI32(kArgReg[2], fn);
+                        Call(reinterpret_cast<const void *>(JITGrow));
+                        ExitOnFailure();
+                        ReloadRegisters();
+                        ReloadStackPointer();
+                        Patch(done, code.size());
+                        break;
+                    }
+                    case 9: // push  k
+                        Load32(RAX, RBX, offsetof(JITFrame, sp));                   // mov eax, [rbx+sp]
+                        AluRI(false, 0, RAX, k);                                    // add eax, k
+                        Rex(false, RAX, RBX); Byte(0x3B); ModRMMem(RAX, RBX, offsetof(JITFrame, maxstack)); // cmp eax, [rbx+maxstack]
+                        ExceptionUnless(CC_B, "Function evaluation stack overflow.");
+                        AluMI32(0, RBX, offsetof(JITFrame, sp), k);                 // add dword [rbx+sp], k
+                        AluRI(true, 0, R12, k * sizeof(DBL));                       // add r12, k * 8
+                        break;
+                    case 10: // pop   k
+                        AluMI32(7, RBX, offsetof(JITFrame, sp), k);                 // cmp dword [rbx+sp], k
+                        ExceptionUnless(CC_AE, "Function evaluation stack underflow.");
+                        AluMI32(5, RBX, offsetof(JITFrame, sp), k);                 // sub dword [rbx+sp], k
+                        AluRI(true, 5, R12, k * sizeof(DBL));                       // sub r12, k * 8
+                        break;
+                    default: // nop
+                        break;
+                }
+                break;
+            default: // nop
+                break;
+        }
+    }
+
+    size_t exit = code.size();
+    Epilogue();
+
+    for(auto& b : branchFixups)
+        Patch(b.pos, position[b.target]);
+    for(auto pos : exitFixups)
+        Patch(pos, exit);
+
+    Link();
+
+    return true;
+}
+
+/*****************************************************************************
+* Executable memory
+******************************************************************************/
+
+static void *AllocateCode(const vector<unsigned char>& code)
+{
+#if defined(_WIN32)
+    void *mem = VirtualAlloc(nullptr, code.size(), MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    if(mem == nullptr)
+        return nullptr;
+    memcpy(mem, code.data(), code.size());
+    DWORD oldProtect;
+    if(!VirtualProtect(mem, code.size(), PAGE_EXECUTE_READ, &oldProtect))
+    {
+        VirtualFree(mem, 0, MEM_RELEASE);
+        return nullptr;
+    }
+    FlushInstructionCache(GetCurrentProcess(), mem, code.size());
+    return mem;
+#else
+    void *mem = mmap(nullptr, code.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(mem == MAP_FAILED)
+        return nullptr;
+    memcpy(mem, code.data(), code.size());
+    if(mprotect(mem, code.size(), PROT_READ | PROT_EXEC) != 0)
+    {
+        munmap(mem, code.size());
+        return nullptr;
+    }
+    return mem;
+#endif
+}
+
+static void FreeCode(void *mem, size_t size)
+{
+#if defined(_WIN32)
+    VirtualFree(mem, 0, MEM_RELEASE);
+#else
+    munmap(mem, size);
+#endif
+}
+
+/*****************************************************************************
+*
+* FUNCTION
+*
+*   POVFPU_JITCompile
+*
+* INPUT
+*
+*   vm - virtual machine the function belongs to
+*   fn - function reference number
+*
+* DESCRIPTION
+*
+*   Translate a function that has just been added to the virtual machine
+*   into native code.  If the function cannot be translated, it is left to
+*   the interpreter.
+*
+******************************************************************************/
+
+void POVFPU_JITCompile(FunctionVM *vm, FUNCTION fn)
+{
+    FunctionEntry& f = vm->functions[fn];
+
+    f.jit_code = nullptr;
+    f.jit_size = 0;
+
+    if((f.fn.program == nullptr) || (f.fn.program_size == 0))
+        return;
+
+    JITCompiler compiler(vm->functions, vm->consts, fn);
+
+    if(!compiler.Compile(f.fn))
+        return;
+
+    f.jit_code = AllocateCode(compiler.Code());
+    if(f.jit_code != nullptr)
+        f.jit_size = compiler.Code().size();
+}
+
+/*****************************************************************************
+*
+* FUNCTION
+*
+*   POVFPU_JITRelease
+*
+* INPUT
+*
+*   f - function entry about to be deleted
+*
+* DESCRIPTION
+*
+*   Free the native code of a function.
+*
+******************************************************************************/
+
+void POVFPU_JITRelease(FunctionEntry *f)
+{
+    if(f->jit_code != nullptr)
+    {
+        FreeCode(f->jit_code, f->jit_size);
+        f->jit_code = nullptr;
+        f->jit_size = 0;
+    }
+}
+
+/*****************************************************************************
+*
+* FUNCTION
+*
+*   POVFPU_RunJIT
+*
+* INPUT
+*
+*   context - function context
+*   fn - function reference number
+*
+* RETURNS
+*
+*   DBL - result found in R0
+*
+* DESCRIPTION
+*
+*   Execute a function, using its native code if available and the
+*   interpreter otherwise.
+*
+******************************************************************************/
+
+DBL POVFPU_RunJIT(FPUContext *context, FUNCTION fn)
+{
+    FunctionVM *vm = context->functionvm.get();
+    JITRoutine routine = reinterpret_cast<JITRoutine>(vm->functions[fn].jit_code);
+
+    if(routine == nullptr)
+        return POVFPU_RunDefault(context, fn);
+
+    context->threaddata->Stats()[Ray_Function_VM_Calls]++;
+
+    std::exception_ptr exception;
+    JITFrame frame;
+    for(int i = 0; i < 8; i++)
+        frame.r[i] = 0.0;
+    frame.stack = context->dblstackbase;
+    frame.globals = vm->globals.data();
+    frame.context = context;
+    frame.exception = &exception;
+    frame.sp = 0;
+    frame.ccr = 0;
+    frame.maxstack = context->maxdblstacksize;
+    frame.depth = 0;
+    frame.failed = 0;
+
+    routine(&frame);
+    JITCheckFailure(frame);
+
+    return frame.r[0];
+}
+
+/*****************************************************************************
+*
+* FUNCTION
+*
+*   POVFPU_RunBatchJIT
+*
+* INPUT
+*
+*   context - function context
+*   fn - function reference number
+*   args - argument arrays, args[k][i] being argument k of evaluation i
+*   argc - number of arguments
+*   count - number of evaluations
+*
+* OUTPUT
+*
+*   results - result found in R0 for each evaluation
+*
+* DESCRIPTION
+*
+*   Execute a function for a batch of argument tuples, setting up the
+*   native code frame only once for the whole batch.
+*
+******************************************************************************/
+
+void POVFPU_RunBatchJIT(FPUContext *context, FUNCTION fn, const DBL * const *args, unsigned int argc, DBL *results, size_t count)
+{
+    FunctionVM *vm = context->functionvm.get();
+    JITRoutine routine = reinterpret_cast<JITRoutine>(vm->functions[fn].jit_code);
+
+    if(routine == nullptr)
+    {
+        POVFPU_RunBatchDefault(context, fn, args, argc, results, count);
+        return;
+    }
+
+    if(count == 0)
+        return;
+
+    // make sure the arguments fit, so they can be stored directly below
+    if(argc > 0)
+        context->SetLocal(argc - 1, 0.0);
+
+    context->threaddata->Stats()[Ray_Function_VM_Calls] += count;
+
+    std::exception_ptr exception;
+    JITFrame frame;
+    frame.globals = vm->globals.data();
+    frame.context = context;
+    frame.exception = &exception;
+    frame.failed = 0;
+
+    for(size_t i = 0; i < count; i++)
+    {
+        // the routine may have grown the stack during the previous evaluation
+        DBL *stack = context->dblstackbase;
+
+        for(unsigned int k = 0; k < argc; k++)
+            stack[k] = args[k][i];
+
+        for(int r = 0; r < 8; r++)
+            frame.r[r] = 0.0;
+        frame.stack = stack;
+        frame.sp = 0;
+        frame.ccr = 0;
+        frame.maxstack = context->maxdblstacksize;
+        frame.depth = 0;
+
+        routine(&frame);
+        JITCheckFailure(frame);
+
+        results[i] = frame.r[0];
+    }
+}
+
+}
+// end of namespace pov
+
+#endif // TRY_FUNCTION_JIT
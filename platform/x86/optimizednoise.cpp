@@ -81,7 +81,9 @@ OptimizedNoiseInfo gaOptimizedNoiseInfo[] = {
         &kAVX2FMA3NoiseEnabled,     // enabled,
         AVX2FMA3Supported,          // supported,
         CPUInfo::IsIntel,           // recommended,
-        AVX2FMA3NoiseInit           // init
+        AVX2FMA3NoiseInit,          // init,
+        AVX2FMA3MultiNoise,         // multiNoise,
+        AVX2FMA3MultiDNoise         // multiDNoise
     },
 #endif
 #ifdef TRY_OPTIMIZED_NOISE_AVXFMA4
@@ -93,7 +95,9 @@ OptimizedNoiseInfo gaOptimizedNoiseInfo[] = {
         &kAVXFMA4NoiseEnabled,      // enabled,
         AVXFMA4Supported,           // supported,
         nullptr,                    // recommended,
-        nullptr                     // init
+        nullptr,                    // init,
+        nullptr,                    // multiNoise,
+        nullptr                     // multiDNoise
     },
 #endif
 #ifdef TRY_OPTIMIZED_NOISE_AVX
@@ -105,7 +109,9 @@ OptimizedNoiseInfo gaOptimizedNoiseInfo[] = {
         &kAVXNoiseEnabled,          // enabled,
         AVXSupported,               // supported,
         CPUInfo::IsIntel,           // recommended,
-        AVXNoiseInit                // init
+        AVXNoiseInit,               // init,
+        nullptr,                    // multiNoise,
+        nullptr                     // multiDNoise
     },
 #endif
 #ifdef TRY_OPTIMIZED_NOISE_AVX_PORTABLE
@@ -117,7 +123,9 @@ OptimizedNoiseInfo gaOptimizedNoiseInfo[] = {
         &kAVXPortableNoiseEnabled,  // enabled,
         AVXSupported,               // supported,
         nullptr,                    // recommended,
-        nullptr                     // init
+        nullptr,                    // init,
+        nullptr,                    // multiNoise,
+        nullptr                     // multiDNoise
     },
 #endif
     // End-of-list entry.
@@ -51,6 +51,7 @@
 
 // POV-Ray header files (core module)
 #include "core/bounding/bsptree.h"
+#include "core/bounding/bvhtree.h"
 #include "core/math/matrix.h"
 #include "core/scene/object.h"
 #include "core/scene/tracethreaddata.h"
@@ -149,10 +150,11 @@ class BSPProgress final : public BSPTree::Progress
         BSPProgress() = delete;
 };
 
-BoundingTask::BoundingTask(std::shared_ptr<BackendSceneData> sd, unsigned int bt, size_t seed) :
+BoundingTask::BoundingTask(std::shared_ptr<BackendSceneData> sd, unsigned int bt, unsigned int rt, size_t seed) :
     SceneTask(new TraceThreadData(std::dynamic_pointer_cast<SceneData>(sd), seed), boost::bind(&BoundingTask::SendFatalError, this, _1), "Bounding", sd),
     sceneData(sd),
-    boundingThreshold(bt)
+    boundingThreshold(bt),
+    renderThreads(rt)
 {
 }
 
@@ -178,6 +180,23 @@ void BoundingTask::Run()
 
     switch(sceneData->boundingMethod)
     {
+        case 3:
+        {
+            // wide SAH bounding volume hierarchy
+            SceneObjects objects(sceneData->objects);
+            BSPProgress progress(sceneData->sceneId, sceneData->frontendAddress, *this);
+
+            sceneData->objects.clear();
+            sceneData->objects.insert(sceneData->objects.end(), objects.finite.begin(), objects.finite.end());
+            sceneData->objects.insert(sceneData->objects.end(), objects.infinite.begin(), objects.infinite.end());
+            sceneData->numberOfFiniteObjects = objects.finite.size();
+            sceneData->numberOfInfiniteObjects = objects.infinite.size() - objects.numLights;
+            sceneData->bvhTree = new BVHTree();
+            sceneData->bvhTree->build(progress, objects,
+                                      sceneData->nodes, sceneData->objectNodes, sceneData->maxObjects, sceneData->averageObjects,
+                                      sceneData->maxDepth, sceneData->averageDepth);
+            break;
+        }
         case 2:
         {
             // new BSP tree code
@@ -189,7 +208,7 @@ void BoundingTask::Run()
             sceneData->objects.insert(sceneData->objects.end(), objects.infinite.begin(), objects.infinite.end());
             sceneData->numberOfFiniteObjects = objects.finite.size();
             sceneData->numberOfInfiniteObjects = objects.infinite.size() - objects.numLights;
-            sceneData->tree = new BSPTree(sceneData->bspMaxDepth, sceneData->bspObjectIsectCost, sceneData->bspBaseAccessCost, sceneData->bspChildAccessCost, sceneData->bspMissChance);
+            sceneData->tree = new BSPTree(sceneData->bspMaxDepth, sceneData->bspObjectIsectCost, sceneData->bspBaseAccessCost, sceneData->bspChildAccessCost, sceneData->bspMissChance, renderThreads);
             sceneData->tree->build(progress, objects,
                                    sceneData->nodes, sceneData->splitNodes, sceneData->objectNodes, sceneData->emptyNodes,
                                    sceneData->maxObjects, sceneData->averageObjects, sceneData->maxDepth, sceneData->averageDepth,
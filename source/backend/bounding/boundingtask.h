@@ -61,7 +61,7 @@ namespace pov
 class BoundingTask final : public SceneTask
 {
     public:
-        BoundingTask(std::shared_ptr<BackendSceneData> sd, unsigned int bt, size_t seed);
+        BoundingTask(std::shared_ptr<BackendSceneData> sd, unsigned int bt, unsigned int rt, size_t seed);
         virtual ~BoundingTask() override;
 
         virtual void Run() override;
@@ -74,6 +74,7 @@ class BoundingTask final : public SceneTask
     private:
         std::shared_ptr<BackendSceneData> sceneData;
         unsigned int boundingThreshold;
+        unsigned int renderThreads;
 
         void SendFatalError(pov_base::Exception& e);
 };
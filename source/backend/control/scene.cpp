@@ -80,6 +80,7 @@ Scene::Scene(POVMSAddress backendAddr, POVMSAddress frontendAddr, RenderBackend:
     parserControlThread(nullptr)
 {
     sceneData->tree = nullptr;
+    sceneData->bvhTree = nullptr;
     sceneData->sceneId = sid;
     sceneData->backendAddress = backendAddr;
     sceneData->frontendAddress = frontendAddr;
@@ -119,6 +120,10 @@ void Scene::StartParser(POVMS_Object& parseOptions)
 
     sceneData->inputFile = parseOptions.TryGetUCS2String(kPOVAttrib_InputFile, "object.pov");
     sceneData->headerFile = parseOptions.TryGetUCS2String(kPOVAttrib_IncludeHeader, "");
+    sceneData->includeCachePath = parseOptions.TryGetUCS2String(kPOVAttrib_IncludeCachePath, "");
+    sceneData->includeCacheMaxFileSize = POV_OFF_T(max(0, parseOptions.TryGetInt(kPOVAttrib_IncludeCacheMaxFileSize, 64))) << 20;
+    sceneData->textureCachePath = parseOptions.TryGetUCS2String(kPOVAttrib_TextureCachePath, "");
+    sceneData->textureCacheMemory = size_t(max(1, parseOptions.TryGetInt(kPOVAttrib_TextureCacheMemory, 512))) << 20;
 
     DBL outputWidth  = parseOptions.TryGetFloat(kPOVAttrib_Width, 160);
     DBL outputHeight = parseOptions.TryGetFloat(kPOVAttrib_Height, 120);
@@ -129,7 +134,7 @@ void Scene::StartParser(POVMS_Object& parseOptions)
 
     sceneData->splitUnions = parseOptions.TryGetBool(kPOVAttrib_SplitUnions, false);
     sceneData->removeBounds = parseOptions.TryGetBool(kPOVAttrib_RemoveBounds, true);
-    sceneData->boundingMethod = clip<int>(parseOptions.TryGetInt(kPOVAttrib_BoundingMethod, 1), 1, 2);
+    sceneData->boundingMethod = clip<int>(parseOptions.TryGetInt(kPOVAttrib_BoundingMethod, 1), 1, 3);
     if(parseOptions.TryGetBool(kPOVAttrib_Bounding, true) == false)
         sceneData->boundingMethod = 0;
 
@@ -180,9 +185,15 @@ void Scene::StartParser(POVMS_Object& parseOptions)
         }
     }
 
+    pov_parser::ParserOptions parserOptions(bool(parseOptions.Exist(kPOVAttrib_Clock)), parseOptions.TryGetFloat(kPOVAttrib_Clock, 0.0), seed);
+    // static objects can only be carried over between the frames of an animation
+    parserOptions.reuseStaticObjects = parseOptions.TryGetBool(kPOVAttrib_ReuseStaticObjects, false) && parseOptions.Exist(kPOVAttrib_ContinuedAnimation);
+    parserOptions.continuedAnimation = parseOptions.TryGetBool(kPOVAttrib_ContinuedAnimation, false);
+    parserOptions.lastAnimationFrame = parseOptions.TryGetBool(kPOVAttrib_LastAnimationFrame, true);
+
     // do parsing
     sceneThreadData.push_back(dynamic_cast<TraceThreadData *>(parserTasks.AppendTask(new ParserTask(
-        sceneData, pov_parser::ParserOptions(bool(parseOptions.Exist(kPOVAttrib_Clock)), parseOptions.TryGetFloat(kPOVAttrib_Clock, 0.0), seed)
+        sceneData, parserOptions
         ))));
 
     // wait for parsing
@@ -193,6 +204,7 @@ void Scene::StartParser(POVMS_Object& parseOptions)
     sceneThreadData.push_back(dynamic_cast<TraceThreadData *>(parserTasks.AppendTask(new BoundingTask(
         sceneData,
         clip<int>(parseOptions.TryGetInt(kPOVAttrib_BoundingThreshold, DEFAULT_AUTO_BOUNDINGTHRESHOLD),1,SIGNED16_MAX),
+        max(parseOptions.TryGetInt(kPOVAttrib_MaxRenderThreads, 1), 1),
         seed
         ))));
 
@@ -322,6 +334,15 @@ void Scene::GetStatistics(POVMS_Object& parserStats)
         parserStats.SetFloat(kPOVAttrib_BSPAverageAborts, sceneData->averageAborts);
         parserStats.SetFloat(kPOVAttrib_BSPAverageAbortObjects, sceneData->averageAbortObjects);
     }
+    else if(sceneData->boundingMethod == 3)
+    {
+        parserStats.SetInt(kPOVAttrib_BVHNodes, sceneData->nodes);
+        parserStats.SetInt(kPOVAttrib_BVHLeafNodes, sceneData->objectNodes);
+        parserStats.SetInt(kPOVAttrib_BVHMaxObjects, sceneData->maxObjects);
+        parserStats.SetFloat(kPOVAttrib_BVHAverageObjects, sceneData->averageObjects);
+        parserStats.SetInt(kPOVAttrib_BVHMaxDepth, sceneData->maxDepth);
+        parserStats.SetFloat(kPOVAttrib_BVHAverageDepth, sceneData->averageDepth);
+    }
 }
 
 void Scene::SendStatistics(TaskQueue&)
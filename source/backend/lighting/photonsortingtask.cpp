@@ -81,12 +81,13 @@ namespace pov
 */
 PhotonSortingTask::PhotonSortingTask(ViewData *vd, const std::vector<PhotonMap*>& surfaceMaps,
                                      const std::vector<PhotonMap*>& mediaMaps, PhotonShootingStrategy* strategy,
-                                     size_t seed) :
+                                     unsigned int st, size_t seed) :
     RenderTask(vd, seed, "Photon"),
     surfaceMaps(surfaceMaps),
     mediaMaps(mediaMaps),
     strategy(strategy),
-    cooperate(*this)
+    cooperate(*this),
+    sortThreads(st)
 {
 }
 
@@ -128,10 +129,17 @@ void PhotonSortingTask::Run()
             mpMessageFactory->Error(POV_EXCEPTION_STRING("Failed to load photon map from disk"), "Could not load photon map (%s)",GetSceneData()->photonSettings.fileName.c_str());
 
         // set photon options automatically
+        // (the photons were saved in kd-tree order, so they need not be sorted again)
         if (GetSceneData()->surfacePhotonMap.numPhotons>0)
+        {
+            GetSceneData()->surfacePhotonMap.buildLocationArrays();
             GetSceneData()->surfacePhotonMap.setGatherOptions(GetSceneData()->photonSettings,false);
+        }
         if (GetSceneData()->mediaPhotonMap.numPhotons>0)
+        {
+            GetSceneData()->mediaPhotonMap.buildLocationArrays();
             GetSceneData()->mediaPhotonMap.setGatherOptions(GetSceneData()->photonSettings,true);
+        }
     }
 
     // good idea to make sure all warnings and errors arrive frontend now [trf]
@@ -171,7 +179,7 @@ void PhotonSortingTask::sortPhotonMap()
     {
     //povwin::WIN32_DEBUG_FILE_OUTPUT("\n\nsurfacePhotonMap.buildTree about to be called\n");
 
-        GetSceneData()->surfacePhotonMap.buildTree();
+        GetSceneData()->surfacePhotonMap.buildTree(sortThreads);
         GetSceneData()->surfacePhotonMap.setGatherOptions(GetSceneData()->photonSettings,false);
 //      povwin::WIN32_DEBUG_FILE_OUTPUT("gatherNumSteps: %d\n",GetSceneData()->surfacePhotonMap.gatherNumSteps);
 //      povwin::WIN32_DEBUG_FILE_OUTPUT("gatherRadStep: %lf\n",GetSceneData()->surfacePhotonMap.gatherRadStep);
@@ -185,7 +193,7 @@ void PhotonSortingTask::sortPhotonMap()
     /* ----------- global photons ------------- */
     if (globalPhotonMap.numPhotons>0)
     {
-        globalPhotonMap.buildTree();
+        globalPhotonMap.buildTree(sortThreads);
         globalPhotonMap.setGatherOptions(false);
     }
 #endif
@@ -193,7 +201,7 @@ void PhotonSortingTask::sortPhotonMap()
     /* ----------- media photons ------------- */
     if (GetSceneData()->mediaPhotonMap.numPhotons>0)
     {
-        GetSceneData()->mediaPhotonMap.buildTree();
+        GetSceneData()->mediaPhotonMap.buildTree(sortThreads);
         GetSceneData()->mediaPhotonMap.setGatherOptions(GetSceneData()->photonSettings,true);
     }
 
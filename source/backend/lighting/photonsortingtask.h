@@ -68,7 +68,7 @@ class PhotonSortingTask final : public RenderTask
         PhotonShootingStrategy* strategy;
 
         PhotonSortingTask(ViewData *vd, const std::vector<PhotonMap*>& surfaceMaps, const std::vector<PhotonMap*>& mediaMaps,
-                          PhotonShootingStrategy* strategy, size_t seed);
+                          PhotonShootingStrategy* strategy, unsigned int st, size_t seed);
         virtual ~PhotonSortingTask() override;
 
         virtual void Run() override;
@@ -91,6 +91,7 @@ class PhotonSortingTask final : public RenderTask
         };
 
         CooperateFunction cooperate;
+        unsigned int sortThreads;
 };
 
 }
@@ -0,0 +1,309 @@
+//******************************************************************************
+///
+/// @file backend/lighting/staticlightingcache.cpp
+///
+/// Implementation of the re-use of radiosity samples and photon maps across animation frames.
+///
+/// @copyright
+/// @parblock
+///
+/// Persistence of Vision Ray Tracer ('POV-Ray') version 3.8.
+/// Copyright 1991-2019 Persistence of Vision Raytracer Pty. Ltd.
+///
+/// POV-Ray is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Affero General Public License as
+/// published by the Free Software Foundation, either version 3 of the
+/// License, or (at your option) any later version.
+///
+/// POV-Ray is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU Affero General Public License for more details.
+///
+/// You should have received a copy of the GNU Affero General Public License
+/// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// ----------------------------------------------------------------------------
+///
+/// POV-Ray is based on the popular DKB raytracer version 2.12.
+/// DKBTrace was originally written by David K. Buck.
+/// DKBTrace Ver 2.0-2.12 were written by David K. Buck & Aaron A. Collins.
+///
+/// @endparblock
+///
+//******************************************************************************
+
+// Unit header file must be the first file included within POV-Ray *.cpp files (pulls in config)
+#include "backend/lighting/staticlightingcache.h"
+
+// C++ variants of C standard header files
+//  (none at the moment)
+
+// C++ standard header files
+#include <functional>
+#include <mutex>
+
+// POV-Ray header files (base module)
+//  (none at the moment)
+
+// POV-Ray header files (core module)
+#include "core/bounding/boundingbox.h"
+#include "core/material/interior.h"
+#include "core/material/pigment.h"
+#include "core/material/texture.h"
+#include "core/math/matrix.h"
+#include "core/scene/object.h"
+#include "core/scene/scenedata.h"
+
+// POV-Ray header files (backend module)
+//  (none at the moment)
+
+// this must be the last file included
+#include "base/povdebug.h"
+
+namespace pov
+{
+
+static std::mutex gCacheMutex;
+
+// NB: The data is intentionally never destroyed at program exit, as the order of destruction of
+// static objects is undefined.
+static StaticLightingCachePtr& gpCache = *(new StaticLightingCachePtr);
+static size_t gCacheFingerprint = 0;
+
+//******************************************************************************
+
+static inline void Mix(size_t& hash, size_t value)
+{
+    hash = hash * 31 + value;
+}
+
+static inline void Mix(size_t& hash, double value)
+{
+    Mix(hash, std::hash<double>()(value));
+}
+
+static inline void Mix(size_t& hash, const Vector3d& v)
+{
+    for (int i = 0; i < 3; ++i)
+        Mix(hash, v[i]);
+}
+
+static inline void Mix(size_t& hash, const MathColour& c)
+{
+    for (int i = 0; i < MathColour::channels; ++i)
+        Mix(hash, double(c[i]));
+}
+
+static inline void Mix(size_t& hash, const TransColour& c)
+{
+    Mix(hash, c.colour());
+    Mix(hash, double(c.filter()));
+    Mix(hash, double(c.transm()));
+}
+
+static void Mix(size_t& hash, const TRANSFORM *trans)
+{
+    Mix(hash, size_t(trans != nullptr));
+    if (trans == nullptr)
+        return;
+    for (int i = 0; i < 4; ++i)
+        for (int j = 0; j < 4; ++j)
+            Mix(hash, trans->matrix[i][j]);
+}
+
+static void Mix(size_t& hash, const PIGMENT *pigment)
+{
+    Mix(hash, size_t(pigment != nullptr));
+    if (pigment == nullptr)
+        return;
+    Mix(hash, size_t(pigment->Type));
+    Mix(hash, pigment->colour);
+    const ColourBlendMap *colourMap = dynamic_cast<const ColourBlendMap *>(pigment->Blend_Map.get());
+    if (colourMap != nullptr)
+    {
+        for (const ColourBlendMap::Entry& entry : colourMap->Blend_Map_Entries)
+        {
+            Mix(hash, double(entry.value));
+            Mix(hash, entry.Vals);
+        }
+    }
+}
+
+static void Mix(size_t& hash, const FINISH *finish)
+{
+    Mix(hash, size_t(finish != nullptr));
+    if (finish == nullptr)
+        return;
+    Mix(hash, double(finish->Diffuse));
+    Mix(hash, double(finish->DiffuseBack));
+    Mix(hash, double(finish->Brilliance));
+    Mix(hash, double(finish->Specular));
+    Mix(hash, double(finish->Phong));
+    Mix(hash, finish->Ambient);
+    Mix(hash, finish->Emission);
+    Mix(hash, finish->Reflection_Max);
+    Mix(hash, finish->Reflection_Min);
+    Mix(hash, finish->SubsurfaceTranslucency);
+}
+
+static void Mix(size_t& hash, const TEXTURE *texture)
+{
+    for (; texture != nullptr; texture = texture->Next)
+    {
+        Mix(hash, size_t(texture->Type));
+        if (texture->Blend_Map)
+        {
+            for (const TextureBlendMapEntry& entry : texture->Blend_Map->Blend_Map_Entries)
+            {
+                Mix(hash, double(entry.value));
+                Mix(hash, entry.Vals);
+            }
+        }
+        for (const TEXTURE *material : texture->Materials)
+            Mix(hash, material);
+        Mix(hash, texture->Pigment);
+        Mix(hash, texture->Finish);
+    }
+    Mix(hash, size_t(0)); // mark the end of the layers
+}
+
+static void Mix(size_t& hash, const Interior *interior)
+{
+    Mix(hash, size_t(interior != nullptr));
+    if (interior == nullptr)
+        return;
+    Mix(hash, double(interior->IOR));
+    Mix(hash, double(interior->Dispersion));
+    Mix(hash, double(interior->Caustics));
+    Mix(hash, double(interior->Fade_Distance));
+    Mix(hash, double(interior->Fade_Power));
+    Mix(hash, interior->Fade_Colour);
+    Mix(hash, interior->media.size());
+}
+
+static void Mix(size_t& hash, ConstObjectPtr object)
+{
+    Mix(hash, size_t(object->Type));
+    Mix(hash, size_t(object->Flags));
+    for (int i = 0; i < 3; ++i)
+    {
+        Mix(hash, double(object->BBox.lowerLeft[i]));
+        Mix(hash, double(object->BBox.size[i]));
+    }
+    Mix(hash, object->Trans);
+    Mix(hash, object->Texture);
+    Mix(hash, object->Interior_Texture);
+    Mix(hash, object->interior.get());
+
+    if (object->Type & IS_COMPOUND_OBJECT)
+    {
+        const std::vector<ObjectPtr>& children = static_cast<const CompoundObject *>(object)->children;
+        Mix(hash, children.size());
+        for (ConstObjectPtr child : children)
+            Mix(hash, child);
+    }
+}
+
+size_t StaticLightingCache::Fingerprint(const SceneData& sceneData)
+{
+    size_t hash = 0;
+
+    Mix(hash, sceneData.objects.size());
+    for (ConstObjectPtr object : sceneData.objects)
+        Mix(hash, object);
+
+    Mix(hash, sceneData.lightSources.size());
+    for (auto& light : sceneData.lightSources)
+    {
+        Mix(hash, light->colour);
+        Mix(hash, light->Center);
+        Mix(hash, light->Direction);
+        Mix(hash, light->Points_At);
+        Mix(hash, light->Axis1);
+        Mix(hash, light->Axis2);
+        Mix(hash, light->Coeff);
+        Mix(hash, light->Radius);
+        Mix(hash, light->Falloff);
+        Mix(hash, light->Fade_Distance);
+        Mix(hash, light->Fade_Power);
+        Mix(hash, size_t(light->Area_Size1));
+        Mix(hash, size_t(light->Area_Size2));
+        Mix(hash, size_t(light->Light_Type));
+        Mix(hash, size_t(light->Area_Light));
+        Mix(hash, size_t(light->Parallel));
+        Mix(hash, size_t(light->Photon_Area_Light));
+        Mix(hash, size_t(light->Media_Interaction));
+        Mix(hash, size_t(light->Media_Attenuation));
+    }
+
+    const SceneRadiositySettings& rs = sceneData.radiositySettings;
+    Mix(hash, size_t(rs.radiosityEnabled));
+    Mix(hash, rs.brightness);
+    Mix(hash, size_t(rs.count));
+    Mix(hash, rs.errorBound);
+    Mix(hash, rs.grayThreshold);
+    Mix(hash, rs.lowErrorFactor);
+    Mix(hash, rs.minimumReuse);
+    Mix(hash, rs.maximumReuse);
+    Mix(hash, size_t(rs.nearestCount));
+    Mix(hash, size_t(rs.recursionLimit));
+    Mix(hash, rs.maxSample);
+    Mix(hash, rs.adcBailout);
+    Mix(hash, size_t(rs.normal));
+    Mix(hash, size_t(rs.media));
+    Mix(hash, size_t(rs.subsurface));
+    Mix(hash, size_t(rs.brilliance));
+
+    const ScenePhotonSettings& ps = sceneData.photonSettings;
+    Mix(hash, size_t(ps.photonsEnabled));
+    Mix(hash, ps.surfaceSeparation);
+    Mix(hash, ps.globalSeparation);
+    Mix(hash, size_t(ps.surfaceCount));
+    Mix(hash, ps.expandTolerance);
+    Mix(hash, size_t(ps.minExpandCount));
+    Mix(hash, size_t(ps.minGatherCount));
+    Mix(hash, size_t(ps.maxGatherCount));
+    Mix(hash, size_t(ps.Max_Trace_Level));
+    Mix(hash, ps.adcBailout);
+    Mix(hash, ps.jitter);
+    Mix(hash, ps.autoStopPercent);
+    Mix(hash, ps.mediaSpacingFactor);
+    Mix(hash, size_t(ps.maxMediaSteps));
+
+    Mix(hash, size_t(sceneData.parsedMaxTraceLevel));
+    Mix(hash, sceneData.parsedAdcBailout);
+
+    return hash;
+}
+
+//******************************************************************************
+
+StaticLightingCache::StaticLightingCache() :
+    havePhotons(false)
+{}
+
+StaticLightingCachePtr StaticLightingCache::Take(size_t fingerprint)
+{
+    std::lock_guard<std::mutex> lock(gCacheMutex);
+    StaticLightingCachePtr data(std::move(gpCache));
+    if ((data != nullptr) && (gCacheFingerprint != fingerprint))
+        data.reset();
+    return data;
+}
+
+void StaticLightingCache::Keep(StaticLightingCachePtr data, size_t fingerprint)
+{
+    std::lock_guard<std::mutex> lock(gCacheMutex);
+    gpCache = std::move(data);
+    gCacheFingerprint = fingerprint;
+}
+
+void StaticLightingCache::Discard()
+{
+    std::lock_guard<std::mutex> lock(gCacheMutex);
+    gpCache.reset();
+}
+
+}
+// end of namespace pov
@@ -0,0 +1,117 @@
+//******************************************************************************
+///
+/// @file backend/lighting/staticlightingcache.h
+///
+/// Declarations for re-using radiosity samples and photon maps across animation frames.
+///
+/// @copyright
+/// @parblock
+///
+/// Persistence of Vision Ray Tracer ('POV-Ray') version 3.8.
+/// Copyright 1991-2019 Persistence of Vision Raytracer Pty. Ltd.
+///
+/// POV-Ray is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Affero General Public License as
+/// published by the Free Software Foundation, either version 3 of the
+/// License, or (at your option) any later version.
+///
+/// POV-Ray is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU Affero General Public License for more details.
+///
+/// You should have received a copy of the GNU Affero General Public License
+/// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// ----------------------------------------------------------------------------
+///
+/// POV-Ray is based on the popular DKB raytracer version 2.12.
+/// DKBTrace was originally written by David K. Buck.
+/// DKBTrace Ver 2.0-2.12 were written by David K. Buck & Aaron A. Collins.
+///
+/// @endparblock
+///
+//******************************************************************************
+
+#ifndef POVRAY_BACKEND_STATICLIGHTINGCACHE_H
+#define POVRAY_BACKEND_STATICLIGHTINGCACHE_H
+
+// Module config header file must be the first file included within POV-Ray unit header files
+#include "backend/configbackend.h"
+
+// C++ variants of C standard header files
+//  (none at the moment)
+
+// C++ standard header files
+#include <memory>
+
+// POV-Ray header files (base module)
+//  (none at the moment)
+
+// POV-Ray header files (core module)
+#include "core/core_fwd.h"
+#include "core/lighting/photons.h"
+#include "core/lighting/radiosity.h"
+
+// POV-Ray header files (backend module)
+//  (none at the moment)
+
+namespace pov
+{
+
+class StaticLightingCache;
+using StaticLightingCachePtr = std::unique_ptr<StaticLightingCache>;
+
+/// Radiosity samples and photon maps carried over from one animation frame to the next.
+///
+/// Neither depends on the camera, so in an animation where only the camera moves they can be
+/// re-used as-is: The photon maps need not be shot again, and the radiosity pretrace only needs to
+/// gather samples in regions not already covered in earlier frames.
+///
+/// There is a single instance per process, covering one animation at a time. A fingerprint of the
+/// scene's light sources, lighting settings, and the objects' bounding boxes, transformations,
+/// textures and interiors guards against carrying the data over to a frame where these have changed.
+///
+/// @note
+///     The fingerprint covers the texture layers, plain pigment colours, colour maps and the
+///     finish parameters relevant to indirect lighting, but not the parameters of the patterns
+///     themselves (e.g. a `turbulence` or `phase` animated via `clock`), nor the shape parameters of
+///     objects that do not affect their bounding box or transformation (such as isosurface functions).
+///     Scenes animating such properties should turn off `Reuse_Static_Lighting`.
+///
+class StaticLightingCache final
+{
+public:
+
+    /// Radiosity samples, or `nullptr` if none.
+    std::unique_ptr<RadiosityCache> radiosityCache;
+    /// Whether the photon maps are valid.
+    bool havePhotons;
+    /// Surface photon map.
+    PhotonMap surfacePhotonMap;
+    /// Media photon map.
+    PhotonMap mediaPhotonMap;
+
+    /// Compute a fingerprint of the scene's objects, light sources and lighting settings.
+    static size_t Fingerprint(const SceneData& sceneData);
+
+    /// Take the data kept from the previous frame.
+    ///
+    /// @param[in]  fingerprint Fingerprint of the current frame's scene.
+    /// @return                 The data, or `nullptr` if there is none or it doesn't match the fingerprint.
+    ///
+    static StaticLightingCachePtr Take(size_t fingerprint);
+
+    /// Keep the data for the next frame.
+    static void Keep(StaticLightingCachePtr data, size_t fingerprint);
+
+    /// Discard any data kept from a previous frame.
+    static void Discard();
+
+    StaticLightingCache();
+};
+
+}
+// end of namespace pov
+
+#endif // POVRAY_BACKEND_STATICLIGHTINGCACHE_H
@@ -0,0 +1,115 @@
+//******************************************************************************
+///
+/// @file backend/render/subsurfacetask.cpp
+///
+/// Implementations related to the subsurface light transport pre-pass.
+///
+/// @copyright
+/// @parblock
+///
+/// Persistence of Vision Ray Tracer ('POV-Ray') version 3.8.
+/// Copyright 1991-2019 Persistence of Vision Raytracer Pty. Ltd.
+///
+/// POV-Ray is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Affero General Public License as
+/// published by the Free Software Foundation, either version 3 of the
+/// License, or (at your option) any later version.
+///
+/// POV-Ray is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU Affero General Public License for more details.
+///
+/// You should have received a copy of the GNU Affero General Public License
+/// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// ----------------------------------------------------------------------------
+///
+/// POV-Ray is based on the popular DKB raytracer version 2.12.
+/// DKBTrace was originally written by David K. Buck.
+/// DKBTrace Ver 2.0-2.12 were written by David K. Buck & Aaron A. Collins.
+///
+/// @endparblock
+///
+//******************************************************************************
+
+// Unit header file must be the first file included within POV-Ray *.cpp files (pulls in config)
+#include "backend/render/subsurfacetask.h"
+
+// C++ variants of C standard header files
+//  (none at the moment)
+
+// C++ standard header files
+#include <vector>
+
+// POV-Ray header files (base module)
+//  (none at the moment)
+
+// POV-Ray header files (core module)
+//  (none at the moment)
+
+// POV-Ray header files (POVMS module)
+//  (none at the moment)
+
+// POV-Ray header files (backend module)
+#include "backend/scene/backendscenedata.h"
+#include "backend/scene/view.h"
+#include "backend/scene/viewthreaddata.h"
+
+// this must be the last file included
+#include "base/povdebug.h"
+
+namespace pov
+{
+
+SubsurfaceTask::SubsurfaceTask(ViewData *vd, const std::shared_ptr<SubsurfaceCacheBuilder>& b, size_t seed) :
+    RenderTask(vd, seed, "Subsurface", vd->GetViewId()),
+    trace(vd->GetSceneData(), &vd->GetCamera(), GetViewDataPtr(), vd->GetSceneData()->parsedMaxTraceLevel, vd->GetSceneData()->parsedAdcBailout,
+          vd->GetQualityFeatureFlags(), cooperate, media, radiosity),
+    cooperate(*this),
+    media(GetViewDataPtr(), &trace, &photonGatherer),
+    radiosity(vd->GetSceneData(), GetViewDataPtr(),
+              vd->GetSceneData()->radiositySettings, vd->GetRadiosityCache(), cooperate, true, vd->GetCamera().Location),
+    photonGatherer(&vd->GetSceneData()->surfacePhotonMap, vd->GetSceneData()->photonSettings),
+    builder(b)
+{
+}
+
+SubsurfaceTask::~SubsurfaceTask()
+{
+}
+
+void SubsurfaceTask::Run()
+{
+    std::vector<SubsurfaceIrradianceCache::Sample> samples;
+    size_t job, first, count;
+
+    while (builder->GetNextChunk(job, first, count))
+    {
+        radiosity.BeforeTile(0);
+
+        TraceTicket ticket(GetSceneData()->parsedMaxTraceLevel, GetSceneData()->parsedAdcBailout, GetSceneData()->outputAlpha);
+        trace.ComputeSubsurfaceCacheSamples(builder->GetJob(job), first, count, samples, ticket);
+        builder->AddSamples(job, first, samples);
+
+        radiosity.AfterTile();
+        GetViewDataPtr()->AfterTile();
+
+        Cooperate();
+    }
+}
+
+void SubsurfaceTask::Stopped()
+{
+    // nothing to do for now
+}
+
+void SubsurfaceTask::Finish()
+{
+    GetViewDataPtr()->timeType = TraceThreadData::kRenderTime;
+    GetViewDataPtr()->realTime = ConsumedRealTime();
+    GetViewDataPtr()->cpuTime = ConsumedCPUTime();
+}
+
+}
+// end of namespace pov
@@ -0,0 +1,103 @@
+//******************************************************************************
+///
+/// @file backend/render/subsurfacetask.h
+///
+/// Declarations related to the subsurface light transport pre-pass.
+///
+/// @copyright
+/// @parblock
+///
+/// Persistence of Vision Ray Tracer ('POV-Ray') version 3.8.
+/// Copyright 1991-2019 Persistence of Vision Raytracer Pty. Ltd.
+///
+/// POV-Ray is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Affero General Public License as
+/// published by the Free Software Foundation, either version 3 of the
+/// License, or (at your option) any later version.
+///
+/// POV-Ray is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU Affero General Public License for more details.
+///
+/// You should have received a copy of the GNU Affero General Public License
+/// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// ----------------------------------------------------------------------------
+///
+/// POV-Ray is based on the popular DKB raytracer version 2.12.
+/// DKBTrace was originally written by David K. Buck.
+/// DKBTrace Ver 2.0-2.12 were written by David K. Buck & Aaron A. Collins.
+///
+/// @endparblock
+///
+//******************************************************************************
+
+#ifndef POVRAY_BACKEND_SUBSURFACETASK_H
+#define POVRAY_BACKEND_SUBSURFACETASK_H
+
+// Module config header file must be the first file included within POV-Ray unit header files
+#include "backend/configbackend.h"
+
+// C++ variants of C standard header files
+//  (none at the moment)
+
+// C++ standard header files
+#include <memory>
+
+// POV-Ray header files (base module)
+//  (none at the moment)
+
+// POV-Ray header files (core module)
+#include "core/lighting/photons.h"
+#include "core/lighting/radiosity.h"
+#include "core/lighting/subsurface.h"
+#include "core/material/media.h"
+#include "core/render/tracepixel.h"
+
+// POV-Ray header files (backend module)
+#include "backend/render/rendertask.h"
+
+namespace pov
+{
+
+/// Task computing the irradiance samples of the subsurface irradiance caches.
+///
+/// Any number of these tasks may share a single @ref SubsurfaceCacheBuilder, each processing chunks of lines until
+/// none are left. The caches themselves are built by calling @ref SubsurfaceCacheBuilder::Finish() once all tasks
+/// have completed.
+///
+class SubsurfaceTask final : public RenderTask
+{
+    public:
+        SubsurfaceTask(ViewData *vd, const std::shared_ptr<SubsurfaceCacheBuilder>& b, size_t seed);
+        virtual ~SubsurfaceTask() override;
+
+        virtual void Run() override;
+        virtual void Stopped() override;
+        virtual void Finish() override;
+    private:
+        class CooperateFunction final : public Trace::CooperateFunctor
+        {
+            public:
+                CooperateFunction(Task& t) : task(t) { }
+                virtual void operator()() override { task.Cooperate(); }
+            private:
+                Task& task;
+        };
+
+        /// tracing core
+        TracePixel trace;
+
+        CooperateFunction cooperate;
+        MediaFunction media;
+        RadiosityFunction radiosity;
+        PhotonGatherer photonGatherer;
+
+        std::shared_ptr<SubsurfaceCacheBuilder> builder;
+};
+
+}
+// end of namespace pov
+
+#endif // POVRAY_BACKEND_SUBSURFACETASK_H
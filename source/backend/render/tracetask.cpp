@@ -250,6 +250,7 @@ TraceTask::TraceTask(ViewData *vd, unsigned int tm, DBL js,
     passContributesToImage(contributesToImage),
     passCompletesImage((ps == 0) || ((ps == 1) && contributesToImage)),
     highReproducibility(hr),
+    blockQueue(0),
     media(GetViewDataPtr(), &trace, &photonGatherer),
     radiosity(vd->GetSceneData(), GetViewDataPtr(),
               vd->GetSceneData()->radiositySettings, vd->GetRadiosityCache(), cooperate, true, vd->GetCamera().Location),
@@ -286,6 +287,8 @@ TraceTask::~TraceTask()
 
 void TraceTask::Run()
 {
+    blockQueue = GetViewData()->GetBlockQueue();
+
 #ifdef RTR_HACK
     bool forever = GetViewData()->GetRealTimeRaytracing();
     do
@@ -400,54 +403,106 @@ void TraceTask::Finish()
 #endif
 }
 
-void TraceTask::SimpleSamplingM0()
+std::shared_ptr<ViewData::SharedRectangle> TraceTask::GetNextSharedRectangle(bool splitBlocks, bool& shared)
 {
     POVRect rect;
-    vector<RGBTColour> pixels;
     unsigned int serial;
 
-    while(GetViewData()->GetNextRectangle(rect, serial) == true)
+    shared = false;
+    if(GetViewData()->GetNextRectangle(rect, serial, blockQueue) == true)
+        return std::make_shared<ViewData::SharedRectangle>(rect, serial);
+
+    // no blocks left; help with the remaining rows of blocks still being rendered by other threads
+    shared = true;
+    if(splitBlocks)
+        return GetViewData()->StealRectangle();
+
+    return nullptr;
+}
+
+bool TraceTask::GetNextSharedRow(const std::shared_ptr<ViewData::SharedRectangle>& block, bool splitBlocks, bool& shared, unsigned int& row)
+{
+    if(block->GetNextRow(row) == false)
+        return false;
+
+    // once there is nothing left to dispatch, let idle threads help with the rest of this block
+    if(splitBlocks && !shared && GetViewData()->AllRectanglesDispatched())
     {
-        radiosity.BeforeTile(highReproducibility? serial : 0);
+        GetViewData()->ShareRectangle(block);
+        shared = true;
+    }
 
-        pixels.clear();
-        pixels.reserve(rect.GetArea());
+    return true;
+}
+
+void TraceTask::SimpleSamplingM0()
+{
+    std::shared_ptr<ViewData::SharedRectangle> block;
+    bool shared;
+
+    // With high reproducibility, radiosity sampling depends on each block being rendered in one go,
+    // so blocks must not be split between threads.
+    bool splitBlocks = !highReproducibility;
+
+    while((block = GetNextSharedRectangle(splitBlocks, shared)) != nullptr)
+    {
+        radiosity.BeforeTile(highReproducibility? block->serial : 0);
+
+        unsigned int row;
 
-        for(DBL y = DBL(rect.top); y <= DBL(rect.bottom); y++)
+        while(GetNextSharedRow(block, splitBlocks, shared, row) == true)
         {
-            for(DBL x = DBL(rect.left); x <= DBL(rect.right); x++)
+            const POVRect& blockRect = block->rect;
+            vector<RGBTColour>::iterator pixel = block->pixels.begin() + (row - blockRect.top) * blockRect.GetWidth();
+            DBL y = DBL(row);
+
+            // trace pixels in packets of neighbouring pixels, to share bounding hierarchy traversal
+            for(DBL x0 = DBL(blockRect.left); x0 <= DBL(blockRect.right); x0 += BBOX_PACKET_SIZE)
             {
-#ifdef PROFILE_INTERSECTIONS
-                POV_LONG it = std::numeric_limits<POV_ULONG>::max();
-                for (int i = 0 ; i < 3 ; i++)
+                Vector2d points[BBOX_PACKET_SIZE];
+                RGBTColour cols[BBOX_PACKET_SIZE];
+                int count = 0;
+
+                for(DBL x = x0; (x <= DBL(blockRect.right)) && (count < BBOX_PACKET_SIZE); x++)
                 {
-                    TransColour c;
-                    gIntersectionTime = 0;
-                    trace(x+0.5, y+0.5, GetViewData()->GetWidth(), GetViewData()->GetHeight(), c);
-                    if (gIntersectionTime < it)
-                        it = gIntersectionTime;
-                }
-                (*gIntersectionTimes)[(int) y] [(int) x] = it;
-                if (it < gMinVal)
-                    gMinVal = it;
-                if (it > gMaxVal)
-                    gMaxVal = it;
+#ifdef PROFILE_INTERSECTIONS
+                    POV_LONG it = std::numeric_limits<POV_ULONG>::max();
+                    for (int i = 0 ; i < 3 ; i++)
+                    {
+                        TransColour c;
+                        gIntersectionTime = 0;
+                        trace(x+0.5, y+0.5, GetViewData()->GetWidth(), GetViewData()->GetHeight(), c);
+                        if (gIntersectionTime < it)
+                            it = gIntersectionTime;
+                    }
+                    (*gIntersectionTimes)[(int) y] [(int) x] = it;
+                    if (it < gMinVal)
+                        gMinVal = it;
+                    if (it > gMaxVal)
+                        gMaxVal = it;
 #endif
-                RGBTColour col;
+                    points[count++] = Vector2d(x+0.5, y+0.5);
+                }
 
-                trace(x+0.5, y+0.5, GetViewData()->GetWidth(), GetViewData()->GetHeight(), col);
-                GetViewDataPtr()->Stats()[Number_Of_Pixels]++;
+                trace(points, count, GetViewData()->GetWidth(), GetViewData()->GetHeight(), cols);
 
-                pixels.push_back(col);
+                for(int i = 0; i < count; i++)
+                {
+                    GetViewDataPtr()->Stats()[Number_Of_Pixels]++;
 
-                Cooperate();
+                    *pixel++ = cols[i];
+
+                    Cooperate();
+                }
             }
+
+            if(block->CompletedRow() == true)
+                GetViewData()->CompletedRectangle(block->rect, block->serial, block->pixels, 1, passContributesToImage, passCompletesImage);
         }
 
         radiosity.AfterTile();
 
         GetViewDataPtr()->AfterTile();
-        GetViewData()->CompletedRectangle(rect, serial, pixels, 1, passContributesToImage, passCompletesImage);
 
         Cooperate();
     }
@@ -461,7 +516,7 @@ void TraceTask::SimpleSamplingM0P()
     vector<RGBTColour> pixelcolors;
     unsigned int serial;
 
-    while(GetViewData()->GetNextRectangle(rect, serial) == true)
+    while(GetViewData()->GetNextRectangle(rect, serial, blockQueue) == true)
     {
         radiosity.BeforeTile(highReproducibility? serial : 0);
 
@@ -525,23 +580,19 @@ void TraceTask::NonAdaptiveSupersamplingM1()
 
     jitterScale = jitterScale / DBL(aaDepth);
 
-    while(GetViewData()->GetNextRectangle(rect, serial) == true)
+    while(GetViewData()->GetNextRectangle(rect, serial, blockQueue) == true)
     {
         radiosity.BeforeTile(highReproducibility? serial : 0);
 
         SmartBlock pixels(rect.left, rect.top, rect.GetWidth(), rect.GetHeight());
 
         // sample line above current block
+        TracePixelRow(pixels, rect.left, rect.right, rect.top - 1);
         for(int x = rect.left; x <= rect.right; x++)
         {
-            trace(x+0.5, rect.top-0.5, GetViewData()->GetWidth(), GetViewData()->GetHeight(), pixels(x, rect.top - 1));
-            GetViewDataPtr()->Stats()[Number_Of_Pixels]++;
-
             // Cannot supersample this pixel, so just claim it was already supersampled! [trf]
             // [CJC] see comment for leftmost pixels below; similar situation applies here
             pixels.SetFlag(x, rect.top - 1, true);
-
-            Cooperate();
         }
 
         for(int y = rect.top; y <= rect.bottom; y++)
@@ -567,14 +618,12 @@ void TraceTask::NonAdaptiveSupersamplingM1()
 
             Cooperate();
 
+            // trace current line; supersampling a pixel only depends on its left and top neighbours,
+            // so we can trace the whole line in advance
+            TracePixelRow(pixels, rect.left, rect.right, y);
+
             for(int x = rect.left; x <= rect.right; x++)
             {
-                // trace current pixel
-                trace(x+0.5, y+0.5, GetViewData()->GetWidth(), GetViewData()->GetHeight(), pixels(x, y));
-                GetViewDataPtr()->Stats()[Number_Of_Pixels]++;
-
-                Cooperate();
-
                 bool sampleleft = (pixels.GetFlag(x - 1, y) == false);
                 bool sampletop = (pixels.GetFlag(x, y - 1) == false);
                 bool samplecurrent = true;
@@ -601,56 +650,109 @@ void TraceTask::NonAdaptiveSupersamplingM1()
     }
 }
 
+void TraceTask::TracePixelRow(SmartBlock& pixels, int left, int right, int y)
+{
+    // trace pixels in packets of neighbouring pixels, to share bounding hierarchy traversal
+    for(int x0 = left; x0 <= right; x0 += BBOX_PACKET_SIZE)
+    {
+        Vector2d points[BBOX_PACKET_SIZE];
+        RGBTColour cols[BBOX_PACKET_SIZE];
+        int count = 0;
+
+        for(int x = x0; (x <= right) && (count < BBOX_PACKET_SIZE); x++)
+            points[count++] = Vector2d(x+0.5, y+0.5);
+
+        trace(points, count, GetViewData()->GetWidth(), GetViewData()->GetHeight(), cols);
+
+        for(int i = 0; i < count; i++)
+        {
+            pixels(x0 + i, y) = cols[i];
+            GetViewDataPtr()->Stats()[Number_Of_Pixels]++;
+
+            Cooperate();
+        }
+    }
+}
+
+void TraceTask::TraceCornerRow(vector<RGBTColour>& corners, int left, int right, int y)
+{
+    for(int x = left; x <= right; x++)
+    {
+        // trace upper-left corners of all pixels
+        trace(x, y, GetViewData()->GetWidth(), GetViewData()->GetHeight(), corners[x - left]);
+        GetViewDataPtr()->Stats()[Number_Of_Pixels]++;
+
+        Cooperate();
+    }
+}
+
 void TraceTask::AdaptiveSupersamplingM2()
 {
-    POVRect rect;
-    unsigned int serial;
+    std::shared_ptr<ViewData::SharedRectangle> block;
+    bool shared;
     size_t subsize = (size_t(1) << aaDepth);
     SubdivisionBuffer buffer(subsize + 1);
+    vector<RGBTColour> upperCorners;
+    vector<RGBTColour> lowerCorners;
+
+    // With high reproducibility, radiosity sampling depends on each block being rendered in one go,
+    // so blocks must not be split between threads.
+    bool splitBlocks = !highReproducibility;
 
     jitterScale = jitterScale / DBL((1 << aaDepth) + 1);
 
-    while(GetViewData()->GetNextRectangle(rect, serial) == true)
+    while((block = GetNextSharedRectangle(splitBlocks, shared)) != nullptr)
     {
-        radiosity.BeforeTile(highReproducibility? serial : 0);
+        radiosity.BeforeTile(highReproducibility? block->serial : 0);
 
-        SmartBlock pixels(rect.left, rect.top, rect.GetWidth(), rect.GetHeight());
+        const POVRect& rect = block->rect;
+        bool haveCorners = false;
+        unsigned int lastRow = 0;
+        unsigned int row;
+
+        upperCorners.resize(rect.GetWidth() + 1);
+        lowerCorners.resize(rect.GetWidth() + 1);
 
-        for(int y = rect.top; y <= rect.bottom + 1; y++)
+        // Each row only depends on the corners along its upper and lower edge, so rows can be
+        // rendered independently; the upper corners need only be traced again if the row above
+        // has been rendered by another thread.
+        while(GetNextSharedRow(block, splitBlocks, shared, row) == true)
         {
-            for(int x = rect.left; x <= rect.right + 1; x++)
-            {
-                // trace upper-left corners of all pixels
-                trace(x, y, GetViewData()->GetWidth(), GetViewData()->GetHeight(), pixels(x, y));
-                GetViewDataPtr()->Stats()[Number_Of_Pixels]++;
+            if(haveCorners && (row == lastRow + 1))
+                upperCorners.swap(lowerCorners);
+            else
+                TraceCornerRow(upperCorners, rect.left, rect.right + 1, row);
+            TraceCornerRow(lowerCorners, rect.left, rect.right + 1, row + 1);
+            haveCorners = true;
+            lastRow = row;
 
-                Cooperate();
-            }
-        }
+            vector<RGBTColour>::iterator pixel = block->pixels.begin() + (row - rect.top) * rect.GetWidth();
 
-        // note that the bottom and/or right corner are the
-        // upper-left corner of the bottom and/or right pixels
-        for(int y = rect.top; y <= rect.bottom; y++)
-        {
-            for(int x = rect.left; x <= rect.right; x++)
+            // note that the bottom and/or right corner are the
+            // upper-left corner of the bottom and/or right pixels
+            for(int x = rect.left; x <= rect.right; x++, pixel++)
             {
+                unsigned int i = x - rect.left;
+
                 buffer.Clear();
 
-                buffer.SetSample(0, 0, pixels(x, y));
-                buffer.SetSample(0, subsize, pixels(x, y + 1));
-                buffer.SetSample(subsize, 0, pixels(x + 1, y));
-                buffer.SetSample(subsize, subsize, pixels(x + 1, y + 1));
+                buffer.SetSample(0, 0, upperCorners[i]);
+                buffer.SetSample(0, subsize, lowerCorners[i]);
+                buffer.SetSample(subsize, 0, upperCorners[i + 1]);
+                buffer.SetSample(subsize, subsize, lowerCorners[i + 1]);
 
-                SubdivideOnePixel(DBL(x), DBL(y), 0.5, 0, 0, subsize, buffer, pixels(x, y), aaDepth - 1);
+                SubdivideOnePixel(DBL(x), DBL(row), 0.5, 0, 0, subsize, buffer, *pixel, aaDepth - 1);
 
                 Cooperate();
             }
+
+            if(block->CompletedRow() == true)
+                GetViewData()->CompletedRectangle(rect, block->serial, block->pixels, 1, passContributesToImage, passCompletesImage);
         }
 
         radiosity.AfterTile();
 
         GetViewDataPtr()->AfterTile();
-        GetViewData()->CompletedRectangle(rect, serial, pixels.GetPixels(), 1, passContributesToImage, passCompletesImage);
 
         Cooperate();
     }
@@ -682,7 +784,7 @@ void TraceTask::StochasticSupersamplingM3()
     else
         confidenceFactor.push_back(0.0);
 
-    while(GetViewData()->GetNextRectangle(rect, serial) == true)
+    while(GetViewData()->GetNextRectangle(rect, serial, blockQueue) == true)
     {
         GetViewDataPtr()->stochasticRandomGenerator->Seed(GetViewDataPtr()->stochasticRandomSeedBase + serial);
 
@@ -43,6 +43,7 @@
 //  (none at the moment)
 
 // C++ standard header files
+#include <memory>
 #include <vector>
 
 // POV-Ray header files (base module)
@@ -55,6 +56,7 @@
 
 // POV-Ray header files (backend module)
 #include "backend/render/rendertask.h"
+#include "backend/scene/view.h"
 
 namespace pov
 {
@@ -67,6 +69,8 @@ namespace pov
     extern std::vector<std::vector<POV_ULONG>> *gIntersectionTimes;
 #endif
 
+class SmartBlock;
+
 class TraceTask final : public RenderTask
 {
     public:
@@ -116,6 +120,7 @@ class TraceTask final : public RenderTask
         bool passCompletesImage;        ///< Pass is the last one computing pixels for the final image.
         bool highReproducibility;
         pov_base::GammaCurvePtr aaGamma;
+        unsigned int blockQueue;        ///< Block queue owned by this thread.
 
         /// tracing core
         TracePixel trace;
@@ -131,6 +136,11 @@ class TraceTask final : public RenderTask
         void AdaptiveSupersamplingM2();
         void StochasticSupersamplingM3();
 
+        std::shared_ptr<ViewData::SharedRectangle> GetNextSharedRectangle(bool splitBlocks, bool& shared);
+        bool GetNextSharedRow(const std::shared_ptr<ViewData::SharedRectangle>& block, bool splitBlocks, bool& shared, unsigned int& row);
+
+        void TracePixelRow(SmartBlock& pixels, int left, int right, int y);
+        void TraceCornerRow(std::vector<RGBTColour>& corners, int left, int right, int y);
         void NonAdaptiveSupersamplingForOnePixel(DBL x, DBL y, RGBTColour& leftcol, RGBTColour& topcol, RGBTColour& curcol, bool& sampleleft, bool& sampletop, bool& samplecurrent);
         void SupersampleOnePixel(DBL x, DBL y, RGBTColour& col);
         void SubdivideOnePixel(DBL x, DBL y, DBL d, size_t bx, size_t by, size_t bstep, SubdivisionBuffer& buffer, RGBTColour& result, int level);
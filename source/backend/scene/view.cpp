@@ -48,14 +48,18 @@
 #include <boost/math/common_factor.hpp>
 
 // POV-Ray header files (base module)
+#include "base/fileinputoutput.h"
 #include "base/path.h"
 #include "base/povassert.h"
+#include "base/stringutilities.h"
 #include "base/timer.h"
 #include "base/image/colourspace.h"
 
 // POV-Ray header files (core module)
 #include "core/lighting/photons.h"
 #include "core/lighting/radiosity.h"
+#include "core/lighting/subsurface.h"
+#include "core/bounding/bvhtree.h"
 #include "core/math/matrix.h"
 #include "core/support/octree.h"
 
@@ -71,7 +75,9 @@
 #include "backend/lighting/photonshootingtask.h"
 #include "backend/lighting/photonsortingtask.h"
 #include "backend/lighting/photonstrategytask.h"
+#include "backend/lighting/staticlightingcache.h"
 #include "backend/render/radiositytask.h"
+#include "backend/render/subsurfacetask.h"
 #include "backend/render/tracetask.h"
 #include "backend/scene/backendscenedata.h"
 #include "backend/scene/viewthreaddata.h"
@@ -100,7 +106,13 @@ inline unsigned int MakePowerOfTwo(unsigned int i)
 }
 
 ViewData::ViewData(shared_ptr<BackendSceneData> sd) :
+    pixelsPending(0),
+    pixelsCompleted(0),
     nextBlock(0),
+    trackBusyBlocks(false),
+    blockQueues(1),
+    blocksQueued(0),
+    nextBlockQueue(0),
     completedFirstPass(false),
     highestTraceLevel(0),
     width(160),
@@ -233,27 +245,39 @@ void ViewData::getBlockXY(const unsigned int nb, unsigned int &x, unsigned int &
      }/* all values are covered */
 }
 
-bool ViewData::GetNextRectangle(POVRect& rect, unsigned int& serial)
+unsigned int ViewData::GetBlockQueue()
 {
-    std::lock_guard<std::mutex> lock(nextBlockMutex);
+    return (nextBlockQueue++ % blockQueues.size());
+}
+
+bool ViewData::GetNextRectangle(POVRect& rect, unsigned int& serial, unsigned int queue)
+{
+    // Take the next block from our own queue; once that has run empty, steal the next block from
+    // the queue of a neighbouring thread. Taking blocks from the front in both cases keeps the
+    // blocks being rendered close to the render pattern order.
+    bool found = false;
 
-    while(true)
+    for(unsigned int i = 0; (i < blockQueues.size()) && (found == false); i++)
     {
-        if(nextBlock >= (blockWidth * blockHeight))
-            return false;
+        BlockQueue& blockQueue = blockQueues[(queue + i) % blockQueues.size()];
+        std::lock_guard<std::mutex> lock(blockQueue.mutex);
 
-        unsigned int tempNextBlock = nextBlock; // TODO FIXME - works around nasty gcc (found using 4.0.1) bug failing to honor casting away of volatile on pass by value on template argument lookup [trf]
+        if(blockQueue.blocks.empty() == false)
+        {
+            serial = blockQueue.blocks.front();
+            blockQueue.blocks.pop_front();
+            found = true;
+        }
+    }
 
-        if((blockSkipList.empty() == true) || (blockSkipList.find((unsigned int)tempNextBlock) == blockSkipList.end()))
-            break;
+    if(found == false)
+        return false;
 
-        blockSkipList.erase((unsigned int)tempNextBlock);
-        nextBlock++;
-    }
+    blocksQueued--;
 
     unsigned int blockX;
     unsigned int blockY;
-    getBlockXY(nextBlock,blockX,blockY);
+    getBlockXY(serial,blockX,blockY);
 
     rect.left = renderArea.left + (blockX * blockSize);
     rect.right = min(renderArea.left + ((blockX + 1) * blockSize) - 1, renderArea.right);
@@ -262,11 +286,6 @@ bool ViewData::GetNextRectangle(POVRect& rect, unsigned int& serial)
 
     pixelsPending += rect.GetArea();
 
-    serial = nextBlock;
-    nextBlock++;
-
-    blockBusyList.insert(serial);
-
     return true;
 }
 
@@ -276,6 +295,8 @@ bool ViewData::GetNextRectangle(POVRect& rect, unsigned int& serial, BlockInfo*&
 
     BlockIdSet newPostponedList;
 
+    trackBusyBlocks = true;
+
     if (stride != 0)
     {
         unsigned int oldNextBlock = nextBlock;
@@ -532,11 +553,15 @@ void ViewData::CompletedRectangle(const POVRect& rect, unsigned int serial, cons
 
 void ViewData::CompletedRectangle(const POVRect& rect, unsigned int serial, float completion, BlockInfo* blockInfo)
 {
+    if(trackBusyBlocks)
     {
         std::lock_guard<std::mutex> lock(nextBlockMutex);
         blockBusyList.erase(serial);
         blockInfoList[serial] = blockInfo;
     }
+    else
+        // no other thread accesses this entry during the current pass
+        blockInfoList[serial] = blockInfo;
 
     if (realTimeRaytracing == true)
     {
@@ -569,11 +594,61 @@ void ViewData::SetNextRectangle(const BlockIdSet& bsl, unsigned int fs)
     blockSkipList = bsl;
     blockBusyList.clear(); // safety catch; shouldn't be necessary
     blockPostponedList.clear(); // safety catch; shouldn't be necessary
+    sharedRectangles.clear();
     nextBlock = fs;
+    trackBusyBlocks = false;
+
+    // deal the blocks to the render threads' queues in turn
+    unsigned int queued = 0;
+    for(BlockQueue& blockQueue : blockQueues)
+        blockQueue.blocks.clear();
+    for(unsigned int serial = fs; serial < blockWidth * blockHeight; serial++)
+    {
+        if((bsl.empty() == false) && (bsl.find(serial) != bsl.end()))
+            continue;
+        blockQueues[queued % blockQueues.size()].blocks.push_back(serial);
+        queued++;
+    }
+    blocksQueued = queued;
+    nextBlockQueue = 0;
+
     completedFirstPass = false; // TODO
     pixelsCompleted = 0; // TODO
 }
 
+void ViewData::ShareRectangle(const shared_ptr<SharedRectangle>& block)
+{
+    std::lock_guard<std::mutex> lock(nextBlockMutex);
+
+    sharedRectangles.push_back(block);
+}
+
+shared_ptr<ViewData::SharedRectangle> ViewData::StealRectangle()
+{
+    std::lock_guard<std::mutex> lock(nextBlockMutex);
+
+    shared_ptr<SharedRectangle> best;
+    unsigned int bestRows = 0;
+
+    for(std::list<shared_ptr<SharedRectangle>>::iterator i = sharedRectangles.begin(); i != sharedRectangles.end(); )
+    {
+        unsigned int rows = (*i)->GetRowsRemaining();
+        if(rows == 0)
+            i = sharedRectangles.erase(i);
+        else
+        {
+            if(rows > bestRows)
+            {
+                best = *i;
+                bestRows = rows;
+            }
+            i++;
+        }
+    }
+
+    return best;
+}
+
 void ViewData::SetHighestTraceLevel(unsigned int htl)
 {
     std::lock_guard<std::mutex> lock(setDataMutex);
@@ -594,6 +669,8 @@ RadiosityCache& ViewData::GetRadiosityCache()
 View::View(shared_ptr<BackendSceneData> sd, unsigned int width, unsigned int height, RenderBackend::ViewId vid) :
     viewData(sd),
     stopRequsted(false),
+    keepStaticLighting(false),
+    staticLightingFingerprint(0),
     mailbox(0),
     renderControlThread(nullptr)
 {
@@ -673,6 +750,21 @@ bool View::CheckCameraHollowObject(const Vector3d& point)
             if (((*object)->interior != nullptr) && Inside_BBox(point, (*object)->BBox) && (*object)->Inside(point, &threadData))
                 return true;
     }
+    else if(sd->boundingMethod == 3)
+    {
+        HasInteriorPointObjectCondition precond;
+        TruePointObjectCondition postcond;
+        TraceThreadData threadData(sd, seed); // TODO: avoid the need to construct threadData
+        BSPInsideCondFunctor ifn(point, sd->objects, &threadData, precond, postcond);
+
+        if ((*sd->bvhTree)(point, ifn, true))
+            return true;
+
+        // test infinite objects
+        for(vector<ObjectPtr>::iterator object = sd->objects.begin() + sd->numberOfFiniteObjects; object != sd->objects.end(); object++)
+            if (((*object)->interior != nullptr) && Inside_BBox(point, (*object)->BBox) && (*object)->Inside(point, &threadData))
+                return true;
+    }
     else if ((sd->boundingMethod == 0) || (sd->boundingSlabs == nullptr))
     {
         TraceThreadData threadData(sd, seed); // TODO: avoid the need to construct threadData
@@ -744,8 +836,14 @@ void View::StartRender(POVMS_Object& renderOptions)
 
     // TODO FIXME - [CLi] handle loading, storing (and later optionally deleting) of radiosity cache file for trace abort & continue feature
     // TODO FIXME - [CLi] if high reproducibility is a demand, timing of writing samples to disk is an issue regarding abort & continue
+    // Lighting shared between processes tracing different blocks of the same image (distributed rendering): One
+    // process computes the photons and radiosity pretrace for the whole image and saves them, without tracing
+    // anything itself; the others load them instead of computing them again.
+    UCS2String exportLighting = renderOptions.TryGetUCS2String(kPOVAttrib_ExportLighting, "");
+    UCS2String importLighting = renderOptions.TryGetUCS2String(kPOVAttrib_ImportLighting, "");
+
     bool loadRadiosityCache = renderOptions.TryGetBool(kPOVAttrib_RadiosityFromFile, false);
-    bool saveRadiosityCache = renderOptions.TryGetBool(kPOVAttrib_RadiosityToFile, false);
+    bool saveRadiosityCache = renderOptions.TryGetBool(kPOVAttrib_RadiosityToFile, false) && exportLighting.empty() && importLighting.empty();
     if (loadRadiosityCache || saveRadiosityCache)
     {
         // TODO FIXME - [CLi] I guess the radiosity file name needs more attention than this; probably a frontend job
@@ -755,6 +853,11 @@ void View::StartRender(POVMS_Object& renderOptions)
         if(saveRadiosityCache)
             viewData.radiosityCache.InitAutosave(radiosityFile, loadRadiosityCache); // if we loaded the file, add to existing data
     }
+    if (!exportLighting.empty())
+        viewData.radiosityCache.InitAutosave(Path(exportLighting + ASCIItoUCS2String(".rca")), false);
+    bool importedRadiosityCache = false;
+    if (!importLighting.empty())
+        importedRadiosityCache = viewData.radiosityCache.Load(Path(importLighting + ASCIItoUCS2String(".rca")));
 
     viewData.GetSceneData()->radiositySettings.vainPretrace = renderOptions.TryGetBool(kPOVAttrib_RadiosityVainPretrace, true);
 
@@ -766,6 +869,20 @@ void View::StartRender(POVMS_Object& renderOptions)
     viewData.GetSceneData()->photonSettings.photonsEnabled = viewData.GetSceneData()->photonSettings.photonsEnabled && (viewData.qualityFlags.photons);
     viewData.GetSceneData()->useSubsurface = viewData.GetSceneData()->useSubsurface && (viewData.qualityFlags.subsurface);
 
+    if (viewData.GetSceneData()->photonSettings.photonsEnabled && viewData.GetSceneData()->photonSettings.fileName.empty())
+    {
+        if (!exportLighting.empty())
+        {
+            viewData.GetSceneData()->photonSettings.fileName = UCS2toSysString(exportLighting) + ".ph";
+            viewData.GetSceneData()->photonSettings.loadFile = false;
+        }
+        else if (!importLighting.empty() && CheckIfFileExists(Path(importLighting + ASCIItoUCS2String(".ph"))))
+        {
+            viewData.GetSceneData()->photonSettings.fileName = UCS2toSysString(importLighting) + ".ph";
+            viewData.GetSceneData()->photonSettings.loadFile = true;
+        }
+    }
+
     if(viewData.GetSceneData()->photonSettings.Max_Trace_Level < 0)
         viewData.GetSceneData()->photonSettings.Max_Trace_Level = viewData.GetSceneData()->parsedMaxTraceLevel;
 
@@ -775,6 +892,41 @@ void View::StartRender(POVMS_Object& renderOptions)
 
     // TODO FIXME - end of todo fixme stuff above
 
+    // In an animation with static lighting (e.g. a camera-only walkthrough), pick up the radiosity
+    // samples and photons from the previous frame, provided the scene still matches.
+    StaticLightingCachePtr staticLighting;
+    bool reuseStaticLighting = renderOptions.TryGetBool(kPOVAttrib_ReuseStaticLighting, false) &&
+                               renderOptions.Exist(kPOVAttrib_ContinuedAnimation) &&
+                               !renderOptions.TryGetBool(kPOVAttrib_RadiosityFromFile, false) &&
+                               !renderOptions.TryGetBool(kPOVAttrib_RadiosityToFile, false) &&
+                               exportLighting.empty() && importLighting.empty();
+    if (reuseStaticLighting)
+    {
+        staticLightingFingerprint = StaticLightingCache::Fingerprint(*viewData.GetSceneData());
+        if (renderOptions.TryGetBool(kPOVAttrib_ContinuedAnimation, false))
+            staticLighting = StaticLightingCache::Take(staticLightingFingerprint);
+        else
+            StaticLightingCache::Discard();
+        keepStaticLighting = !renderOptions.TryGetBool(kPOVAttrib_LastAnimationFrame, true);
+    }
+    else
+        StaticLightingCache::Discard();
+
+    bool reusePhotons = false;
+    if (staticLighting != nullptr)
+    {
+        if ((staticLighting->radiosityCache != nullptr) && viewData.GetSceneData()->radiositySettings.radiosityEnabled)
+            viewData.radiosityCache.TakeSamples(*staticLighting->radiosityCache);
+        if (staticLighting->havePhotons && viewData.GetSceneData()->photonSettings.photonsEnabled &&
+            viewData.GetSceneData()->photonSettings.fileName.empty())
+        {
+            viewData.GetSceneData()->surfacePhotonMap.swap(staticLighting->surfacePhotonMap);
+            viewData.GetSceneData()->mediaPhotonMap.swap(staticLighting->mediaPhotonMap);
+            reusePhotons = true;
+        }
+        staticLighting.reset();
+    }
+
 
     DBL raleft = renderOptions.TryGetFloat(kPOVAttrib_Left, 1.0f);
     DBL ratop = renderOptions.TryGetFloat(kPOVAttrib_Top, 1.0f);
@@ -851,11 +1003,45 @@ void View::StartRender(POVMS_Object& renderOptions)
             blockskiplist->insert(*i);
     }
 
-    viewData.SetNextRectangle(*blockskiplist, nextblock);
+    // block subset (distributed rendering); the other blocks are traced by other processes,
+    // but the radiosity pretrace (unless imported) still covers the whole image so that all
+    // processes share the same pretrace results
+    shared_ptr<ViewData::BlockIdSet> traceskiplist(blockskiplist);
+    unsigned int subsetCount = (unsigned int)max(renderOptions.TryGetInt(kPOVAttrib_RenderBlockSubsetCount, 1), 1);
+    unsigned int subsetIndex = (unsigned int)max(renderOptions.TryGetInt(kPOVAttrib_RenderBlockSubsetIndex, 0), 0);
+    if (subsetCount > 1)
+    {
+        if (subsetIndex >= subsetCount)
+            throw POV_EXCEPTION(kParamErr, "Invalid render block subset index");
+
+        traceskiplist = shared_ptr<ViewData::BlockIdSet>(new ViewData::BlockIdSet(*blockskiplist));
+        for (unsigned int serial = 0; serial < viewData.blockWidth * viewData.blockHeight; serial++)
+            if (serial % subsetCount != subsetIndex)
+                traceskiplist->insert(serial);
+    }
+
+    // lighting export (distributed rendering); no blocks are traced at all
+    if (!exportLighting.empty())
+    {
+        traceskiplist = shared_ptr<ViewData::BlockIdSet>(new ViewData::BlockIdSet(*blockskiplist));
+        for (unsigned int serial = 0; serial < viewData.blockWidth * viewData.blockHeight; serial++)
+            traceskiplist->insert(serial);
+    }
 
     // render thread count
     int maxRenderThreads = renderOptions.TryGetInt(kPOVAttrib_MaxRenderThreads, 1);
 
+    // one block queue per render thread
+    viewData.blockQueues = vector<ViewData::BlockQueue>(max(maxRenderThreads, 1));
+
+    viewData.SetNextRectangle(*traceskiplist, nextblock);
+
+    // If no blocks are left to trace (e.g. when only collecting the blocks traced by other processes), there is no
+    // need for any photons, pretrace or other lighting data, unless they are to be exported.
+    bool computeLighting = !exportLighting.empty();
+    for (unsigned int serial = nextblock; (serial < viewData.blockWidth * viewData.blockHeight) && !computeLighting; serial++)
+        computeLighting = (traceskiplist->find(serial) == traceskiplist->end());
+
     viewData.realTimeRaytracing = renderOptions.TryGetBool(kPOVAttrib_RealTimeRaytracing, false); // TODO - experimental code
     if (viewData.realTimeRaytracing)
         viewData.rtrData = new RTRData(viewData, maxRenderThreads);
@@ -999,7 +1185,7 @@ void View::StartRender(POVMS_Object& renderOptions)
         renderTasks.AppendSync();
     }
     */
-    if(viewData.GetSceneData()->photonSettings.photonsEnabled)
+    if(viewData.GetSceneData()->photonSettings.photonsEnabled && !reusePhotons && computeLighting)
     {
         if (!viewData.GetSceneData()->photonSettings.fileName.empty() && viewData.GetSceneData()->photonSettings.loadFile)
         {
@@ -1009,7 +1195,7 @@ void View::StartRender(POVMS_Object& renderOptions)
             // when we pass a null parameter for the "strategy" (last parameter),
             // then this will LOAD the photon map
             viewThreadData.push_back(dynamic_cast<ViewThreadData *>(renderTasks.AppendTask(new PhotonSortingTask(
-                &viewData, surfaceMaps, mediaMaps, nullptr, seed
+                &viewData, surfaceMaps, mediaMaps, nullptr, maxRenderThreads, seed
                 ))));
             // wait for photons to finish
             renderTasks.AppendSync();
@@ -1045,7 +1231,7 @@ void View::StartRender(POVMS_Object& renderOptions)
 
             // this merges the maps, sorts, computes gather options, and then cleans up memory
             viewThreadData.push_back(dynamic_cast<ViewThreadData *>(renderTasks.AppendTask(new PhotonSortingTask(
-                &viewData, surfaceMaps, mediaMaps, strategy, seed
+                &viewData, surfaceMaps, mediaMaps, strategy, maxRenderThreads, seed
                 ))));
             // wait for photons to finish
             renderTasks.AppendSync();
@@ -1053,8 +1239,18 @@ void View::StartRender(POVMS_Object& renderOptions)
         }
     }
 
+    // do subsurface irradiance caches; if they need radiosity, they must wait for the pretrace, otherwise the
+    // pretrace can make use of them
+    bool subsurfaceCaches = viewData.GetSceneData()->useSubsurface &&
+                            (viewData.GetSceneData()->subsurfaceErrorBound > 0.0) &&
+                            viewData.GetQualityFeatureFlags().subsurface;
+    bool subsurfaceCachesNeedRadiosity = viewData.GetSceneData()->radiositySettings.radiosityEnabled &&
+                                         viewData.GetSceneData()->subsurfaceUseRadiosity;
+    if (subsurfaceCaches && !subsurfaceCachesNeedRadiosity && computeLighting && exportLighting.empty())
+        AppendSubsurfaceTasks(maxRenderThreads, seed);
+
     // do radiosity pretrace
-    if(viewData.GetSceneData()->radiositySettings.radiosityEnabled)
+    if(viewData.GetSceneData()->radiositySettings.radiosityEnabled && computeLighting && !importedRadiosityCache)
     {
         // TODO load radiosity data (if applicable)?
 
@@ -1068,7 +1264,7 @@ void View::StartRender(POVMS_Object& renderOptions)
             //         "stopped early, corresponding to a value of %lf.\n"
             //         "To avoid this warning, increase pretrace_end.", endSize / maxWidthHeight);
         }
-        int steps = (int)floor(log(startSize/endSize)/log(2.0) + (1.0 - EPSILON)) + 1;
+        unsigned int steps = (unsigned int)max(0, (int)floor(log(startSize/endSize)/log(2.0) + (1.0 - EPSILON)) + 1);
         if (steps > RadiosityFunction::PRETRACE_MAX - RadiosityFunction::PRETRACE_FIRST - 1)
         {
             steps = RadiosityFunction::PRETRACE_MAX - RadiosityFunction::PRETRACE_FIRST - 1;
@@ -1078,13 +1274,20 @@ void View::StartRender(POVMS_Object& renderOptions)
             //         "To avoid this warning, decrease pretrace_start or increase pretrace_end.", endSize / maxWidthHeight);
         }
 
+        // pretrace the blocks of other processes as well
+        if ((traceskiplist != blockskiplist) && (steps > 0))
+        {
+            renderTasks.AppendFunction(boost::bind(&View::SetNextRectangle, this, _1, blockskiplist, nextblock));
+            renderTasks.AppendSync();
+        }
+
         if (highReproducibility)
         {
             int nominalThreads = 1;
             int actualThreads;
             DBL stepSize = startSize;
             DBL actualSize;
-            for(int step = RadiosityFunction::PRETRACE_FIRST; step < RadiosityFunction::PRETRACE_FIRST + steps; step ++)
+            for(unsigned int step = RadiosityFunction::PRETRACE_FIRST; step < RadiosityFunction::PRETRACE_FIRST + steps; step ++)
             {
                 actualThreads = min(nominalThreads, maxRenderThreads);
                 actualSize = max(stepSize, endSize);
@@ -1098,8 +1301,11 @@ void View::StartRender(POVMS_Object& renderOptions)
                 // wait for previous pretrace step to finish
                 renderTasks.AppendSync();
 
-                // reset block size counter and block skip list for next pretrace step
-                renderTasks.AppendFunction(boost::bind(&View::SetNextRectangle, this, _1, blockskiplist, nextblock));
+                // reset block size counter and block skip list for next pretrace step (or main render)
+                if (step + 1 < RadiosityFunction::PRETRACE_FIRST + steps)
+                    renderTasks.AppendFunction(boost::bind(&View::SetNextRectangle, this, _1, blockskiplist, nextblock));
+                else
+                    renderTasks.AppendFunction(boost::bind(&View::SetNextRectangle, this, _1, traceskiplist, nextblock));
 
                 // wait for block size counter and block skip list reset to finish
                 renderTasks.AppendSync();
@@ -1120,7 +1326,7 @@ void View::StartRender(POVMS_Object& renderOptions)
             renderTasks.AppendSync();
 
             // reset block size counter and block skip list for main render
-            renderTasks.AppendFunction(boost::bind(&View::SetNextRectangle, this, _1, blockskiplist, nextblock));
+            renderTasks.AppendFunction(boost::bind(&View::SetNextRectangle, this, _1, traceskiplist, nextblock));
 
             // wait for block size counter and block skip list reset to finish
             renderTasks.AppendSync();
@@ -1129,6 +1335,9 @@ void View::StartRender(POVMS_Object& renderOptions)
         // TODO store radiosity data (if applicable)?
     }
 
+    if (subsurfaceCaches && subsurfaceCachesNeedRadiosity && computeLighting && exportLighting.empty())
+        AppendSubsurfaceTasks(maxRenderThreads, seed);
+
     // do render with mosaic preview
     if(previewstartsize > 1)
     {
@@ -1149,7 +1358,7 @@ void View::StartRender(POVMS_Object& renderOptions)
             renderTasks.AppendSync();
 
             // reset block size counter and block skip list
-            renderTasks.AppendFunction(boost::bind(&View::SetNextRectangle, this, _1, blockskiplist, nextblock));
+            renderTasks.AppendFunction(boost::bind(&View::SetNextRectangle, this, _1, traceskiplist, nextblock));
 
             // wait for block size counter and block skip list reset to finish
             renderTasks.AppendSync();
@@ -1168,7 +1377,7 @@ void View::StartRender(POVMS_Object& renderOptions)
             renderTasks.AppendSync();
 
             // reset block size counter and block skip list
-            renderTasks.AppendFunction(boost::bind(&View::SetNextRectangle, this, _1, blockskiplist, nextblock));
+            renderTasks.AppendFunction(boost::bind(&View::SetNextRectangle, this, _1, traceskiplist, nextblock));
 
             // wait for block size counter and block skip list reset to finish
             renderTasks.AppendSync();
@@ -1193,6 +1402,13 @@ void View::StartRender(POVMS_Object& renderOptions)
     // wait for render to finish
     renderTasks.AppendSync();
 
+    // keep radiosity samples and photons for the next frame
+    if (keepStaticLighting)
+    {
+        renderTasks.AppendFunction(boost::bind(&View::KeepStaticLighting, this, _1));
+        renderTasks.AppendSync();
+    }
+
     // send shutdown messages
     renderTasks.AppendFunction(boost::bind(&View::DispatchShutdownMessages, this, _1));
 
@@ -1210,6 +1426,49 @@ void View::StartRender(POVMS_Object& renderOptions)
     renderTasks.AppendMessage(doneMessage);
 }
 
+void View::KeepStaticLighting(TaskQueue&)
+{
+    StaticLightingCachePtr data(new StaticLightingCache);
+
+    if (viewData.GetSceneData()->radiositySettings.radiosityEnabled)
+    {
+        data->radiosityCache.reset(new RadiosityCache(viewData.GetSceneData()->radiositySettings));
+        data->radiosityCache->TakeSamples(viewData.radiosityCache);
+    }
+
+    if (viewData.GetSceneData()->photonSettings.photonsEnabled && viewData.GetSceneData()->photonSettings.fileName.empty())
+    {
+        data->surfacePhotonMap.swap(viewData.GetSceneData()->surfacePhotonMap);
+        data->mediaPhotonMap.swap(viewData.GetSceneData()->mediaPhotonMap);
+        data->havePhotons = true;
+    }
+
+    StaticLightingCache::Keep(std::move(data), staticLightingFingerprint);
+}
+
+void View::AppendSubsurfaceTasks(int threads, size_t seed)
+{
+    shared_ptr<SubsurfaceCacheBuilder> builder(new SubsurfaceCacheBuilder(*viewData.GetSceneData()));
+
+    for(int i = 0; i < threads; i++)
+        viewThreadData.push_back(dynamic_cast<ViewThreadData *>(renderTasks.AppendTask(new SubsurfaceTask(
+            &viewData, builder, seed
+            ))));
+
+    // wait for samples to be computed
+    renderTasks.AppendSync();
+
+    renderTasks.AppendFunction(boost::bind(&View::FinishSubsurfaceCaches, this, _1, builder));
+
+    // wait for caches to be built
+    renderTasks.AppendSync();
+}
+
+void View::FinishSubsurfaceCaches(TaskQueue&, shared_ptr<SubsurfaceCacheBuilder> builder)
+{
+    builder->Finish(viewData.GetSceneData()->subsurfaceCaches, viewData.GetSceneData()->mmPerUnit);
+}
+
 void View::StopRender()
 {
     renderTasks.Stop();
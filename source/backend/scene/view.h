@@ -44,7 +44,10 @@
 //  (none at the moment)
 
 // C++ standard header files
+#include <atomic>
 #include <condition_variable>
+#include <deque>
+#include <list>
 #include <memory>
 #include <mutex>
 #include <thread>
@@ -123,16 +126,57 @@ class ViewData final
                 virtual ~BlockInfo() {}
         };
 
+        /**
+         *  Rectangle whose rows may be rendered by more than one thread.
+         *  Once all rectangles have been dispatched, a thread still busy with a rectangle may split off
+         *  its remaining rows for threads that have run out of work, so that a single expensive
+         *  rectangle does not hold up the end of the render.
+         *  Rows are claimed one at a time; the thread completing the last row is responsible for
+         *  passing the rectangle on to @ref CompletedRectangle().
+         */
+        class SharedRectangle final
+        {
+            public:
+                SharedRectangle(const POVRect& r, unsigned int s) :
+                    rect(r), serial(s), pixels(r.GetArea()), nextRow(r.top), rowsDone(0) {}
+
+                /// Claim the next row to render, if any.
+                bool GetNextRow(unsigned int& y) { y = nextRow++; return (y <= rect.bottom); }
+                /// Report a claimed row as rendered. Returns true for the call completing the rectangle.
+                bool CompletedRow() { return (++rowsDone == rect.GetHeight()); }
+                /// Number of rows not yet claimed by any thread.
+                unsigned int GetRowsRemaining() const { unsigned int y = nextRow; return (y <= rect.bottom ? rect.bottom + 1 - y : 0); }
+
+                const POVRect rect;
+                const unsigned int serial;
+                /// Pixels of the rectangle, in row-major order; each row is written only by the thread that claimed it.
+                std::vector<RGBTColour> pixels;
+            private:
+                std::atomic<unsigned int> nextRow;
+                std::atomic<unsigned int> rowsDone;
+        };
+
+        /**
+         *  Get a block queue for a render thread.
+         *  Each render thread of a pass should call this method once, and pass the result to
+         *  @ref GetNextRectangle() for all the blocks it renders in that pass.
+         *  @return                 Index of the block queue owned by the calling thread.
+         */
+        unsigned int GetBlockQueue();
+
         /**
          *  Get the next sub-rectangle of the view to render (if any).
          *  This method is called by the render threads when they have
          *  completed rendering one block and are ready to start rendering
          *  the next block.
+         *  Blocks are taken from the thread's own queue first, and then from the queues of the
+         *  other threads, in order.
          *  @param  rect            Rectangle to render.
          *  @param  serial          Rectangle serial number.
+         *  @param  queue           Block queue owned by the calling thread, as returned by @ref GetBlockQueue().
          *  @return                 True if there is another rectangle to be dispatched, false otherwise.
          */
-        bool GetNextRectangle(POVRect& rect, unsigned int& serial);
+        bool GetNextRectangle(POVRect& rect, unsigned int& serial, unsigned int queue);
 
         /**
          *  Get the next sub-rectangle of the view to render (if any).
@@ -213,6 +257,27 @@ class ViewData final
          */
         void SetNextRectangle(const BlockIdSet& bsl, unsigned int fs);
 
+        /**
+         *  Check whether all rectangles of the current pass have been dispatched.
+         *  @return                 True if @ref GetNextRectangle() will not return any more rectangles.
+         */
+        inline bool AllRectanglesDispatched() const { return (blocksQueued == 0); }
+
+        /**
+         *  Offer the remaining rows of a rectangle to other render threads.
+         *  This method is called by a render thread once @ref AllRectanglesDispatched() reports that
+         *  there is no more work left to distribute otherwise.
+         *  @param  block           Rectangle currently being rendered.
+         */
+        void ShareRectangle(const std::shared_ptr<SharedRectangle>& block);
+
+        /**
+         *  Get a rectangle with rows left to render, offered by another render thread.
+         *  This method is called by render threads once @ref GetNextRectangle() has run out of work.
+         *  @return                 Shared rectangle with the most rows remaining, or empty pointer if there is none.
+         */
+        std::shared_ptr<SharedRectangle> StealRectangle();
+
         /**
          *  Get width of view in pixels.
          *  @return                 Width in pixels.
@@ -294,10 +359,17 @@ class ViewData final
             BlockPostponedEntry(unsigned int id, unsigned int p) : blockId(id), pass(p) {}
         };
 
+        /// Blocks to be rendered by one particular render thread, in render pattern order.
+        struct BlockQueue final
+        {
+            std::mutex mutex;
+            std::deque<unsigned int> blocks;
+        };
+
         /// pixels pending
-        volatile unsigned int pixelsPending;
+        std::atomic<unsigned int> pixelsPending;
         /// pixels completed
-        volatile unsigned int pixelsCompleted;
+        std::atomic<unsigned int> pixelsCompleted;
         /// Next block counter for algorithm to distribute parts of the scene to render threads.
         /// @note   Blocks with higher serial numbers may be dispatched out-of-order for certain reasons;
         ///         in that case, the dispatched block must be entered into @ref blockSkipList instead of
@@ -305,9 +377,14 @@ class ViewData final
         /// @note   When advancing this variable, the new value should be checked against @ref blockSkipList;
         ///         if the value is in the list, it should be removed, and this variable advanced again,
         ///         repeating the process until a value is reached that is not found in @ref blockSkipList.
+        /// @note   This variable is only used by the avoid-busy variant of @ref GetNextRectangle();
+        ///         the plain variant dispatches blocks from @ref blockQueues instead.
         volatile unsigned int nextBlock;
         /// next block counter mutex
         std::mutex nextBlockMutex;
+        /// Whether the current pass dispatches blocks via the avoid-busy variant of @ref GetNextRectangle(),
+        /// which requires @ref blockBusyList to be maintained.
+        std::atomic<bool> trackBusyBlocks;
         /// set data mutex
         std::mutex setDataMutex;
         /// Whether all blocks have been dispatched at least once.
@@ -334,6 +411,16 @@ class ViewData final
         BlockIdSet blockPostponedList;
         /// list of additional block information
         std::vector<BlockInfo*> blockInfoList;
+        /// Per-thread queues of blocks to be dispatched by the plain variant of @ref GetNextRectangle().
+        /// @ref SetNextRectangle() deals the blocks of a pass to the queues in turn, so that the threads
+        /// together still work through the blocks in render pattern order.
+        std::vector<BlockQueue> blockQueues;
+        /// number of blocks left in @ref blockQueues
+        std::atomic<unsigned int> blocksQueued;
+        /// next block queue to hand out to a render thread
+        std::atomic<unsigned int> nextBlockQueue;
+        /// list of rectangles offered for row stealing, guarded by @ref nextBlockMutex
+        std::list<std::shared_ptr<SharedRectangle>> sharedRectangles;
         /// area of view to be rendered
         POVRect renderArea;
         /// camera of this view
@@ -461,6 +548,10 @@ class View final
         ViewData viewData;
         /// stop request flag
         bool stopRequsted;
+        /// whether to keep the radiosity samples and photons for the next frame
+        bool keepStaticLighting;
+        /// fingerprint of the scene's lighting, to check against in the next frame
+        size_t staticLightingFingerprint;
         /// render control thread
         std::thread *renderControlThread;
         /// BSP tree mailbox
@@ -493,6 +584,26 @@ class View final
          */
         void SendStatistics(TaskQueue& taskq);
 
+        /**
+         *  Keep the radiosity samples and photons for the next frame of the animation.
+         *  @param  taskq           The task queue that executed this method.
+         */
+        void KeepStaticLighting(TaskQueue& taskq);
+
+        /**
+         *  Append the tasks computing the subsurface irradiance caches.
+         *  @param  threads         Number of render threads to use.
+         *  @param  seed            Stochastic seed.
+         */
+        void AppendSubsurfaceTasks(int threads, size_t seed);
+
+        /**
+         *  Build the subsurface irradiance caches from the samples computed by the subsurface tasks.
+         *  @param  taskq           The task queue that executed this method.
+         *  @param  builder         Builder holding the samples.
+         */
+        void FinishSubsurfaceCaches(TaskQueue& taskq, std::shared_ptr<SubsurfaceCacheBuilder> builder);
+
         /**
          *  Set the blocks not to generate with GetNextRectangle because they have
          *  already been rendered.
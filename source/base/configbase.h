@@ -776,6 +776,34 @@
     #define POV_USE_DEFAULT_DELETEFILE 1
 #endif
 
+/// @def POV_USE_DEFAULT_RENAMEFILE
+/// Whether to use a default implementation to rename a file.
+///
+/// Define as non-zero to use a default implementation for the @ref pov_base::Filesystem::RenameFile() method,
+/// or zero if the platform provides its own implementation.
+///
+/// @note
+///     The default implementation is only provided as a last-ditch resort. Wherever possible,
+///     implementations should provide their own implementation.
+///
+#ifndef POV_USE_DEFAULT_RENAMEFILE
+    #define POV_USE_DEFAULT_RENAMEFILE 1
+#endif
+
+/// @def POV_USE_DEFAULT_FILEINFO
+/// Whether to use a default implementation to query file size and modification time.
+///
+/// Define as non-zero to use a default implementation for the @ref pov_base::Filesystem::GetFileInfo() method,
+/// or zero if the platform provides its own implementation.
+///
+/// @note
+///     The default implementation always fails, forcing callers to fall back to examining the
+///     file content.
+///
+#ifndef POV_USE_DEFAULT_FILEINFO
+    #define POV_USE_DEFAULT_FILEINFO 1
+#endif
+
 /// @def POV_USE_DEFAULT_LARGEFILE
 /// Whether to use a default implementation for large file handling.
 ///
@@ -790,6 +818,20 @@
     #define POV_USE_DEFAULT_LARGEFILE 1
 #endif
 
+/// @def POV_USE_DEFAULT_MAPPEDFILE
+/// Whether to use a default implementation for memory-mapped files.
+///
+/// Define as non-zero to use a default implementation for the @ref pov_base::Filesystem::MappedFile class,
+/// or zero if the platform provides its own implementation.
+///
+/// @note
+///     The default implementation reads the entire file into memory, and therefore neither
+///     loads data on demand nor shares it with other processes.
+///
+#ifndef POV_USE_DEFAULT_MAPPEDFILE
+    #define POV_USE_DEFAULT_MAPPEDFILE 1
+#endif
+
 /// @def POV_OFF_T
 /// Type representing a particular absolute or relative location in a (large) file.
 ///
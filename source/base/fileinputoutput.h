@@ -89,6 +89,9 @@ enum
     POV_File_Data_RCA,
     POV_File_Data_LOG,
     POV_File_Data_Backup,
+    POV_File_Data_Tokens,
+    POV_File_Data_Mesh,
+    POV_File_Data_MipMap,
     POV_File_Font_TTF,
     POV_File_Count
 };
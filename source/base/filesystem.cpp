@@ -41,22 +41,25 @@
 #include "base/filesystem.h"
 
 // C++ variants of C standard header files
-#if POV_USE_DEFAULT_DELETEFILE
+#if POV_USE_DEFAULT_DELETEFILE || POV_USE_DEFAULT_RENAMEFILE
 #include <cstdio>
 #endif
 
 // C++ standard header files
-#if POV_USE_DEFAULT_LARGEFILE
+#if POV_USE_DEFAULT_LARGEFILE || POV_USE_DEFAULT_MAPPEDFILE
 #include <fstream>
 #include <ios>
 #include <limits>
 #endif
+#if POV_USE_DEFAULT_MAPPEDFILE
+#include <vector>
+#endif
 #if POV_USE_DEFAULT_TEMPORARYFILE
 #include <atomic>
 #endif
 
 // POV-Ray header files (base module)
-#if POV_USE_DEFAULT_DELETEFILE || POV_USE_DEFAULT_LARGEFILE || POV_USE_DEFAULT_TEMPORARYFILE
+#if POV_USE_DEFAULT_DELETEFILE || POV_USE_DEFAULT_RENAMEFILE || POV_USE_DEFAULT_LARGEFILE || POV_USE_DEFAULT_MAPPEDFILE || POV_USE_DEFAULT_TEMPORARYFILE
 #include "base/stringutilities.h"
 #endif
 
@@ -85,6 +88,32 @@ bool DeleteFile(const UCS2String& fileName)
 
 //******************************************************************************
 
+#if POV_USE_DEFAULT_RENAMEFILE
+
+bool RenameFile(const UCS2String& oldName, const UCS2String& newName)
+{
+    // Note: The C++ standard does not specify whether `rename` will or will not
+    // replace an existing file. On POSIX systems it will, atomically.
+    return (std::rename(UCS2toSysString(oldName).c_str(), UCS2toSysString(newName).c_str()) == 0);
+}
+
+#endif // POV_USE_DEFAULT_RENAMEFILE
+
+//******************************************************************************
+
+#if POV_USE_DEFAULT_FILEINFO
+
+bool GetFileInfo(const UCS2String& fileName, std::int_least64_t& size, std::int_least64_t& modified)
+{
+    // Note: Prior to C++17, the standard library provides no means to query
+    // the modification time of a file.
+    return false;
+}
+
+#endif // POV_USE_DEFAULT_FILEINFO
+
+//******************************************************************************
+
 #if POV_USE_DEFAULT_LARGEFILE
 
 using Offset = std::streamoff;
@@ -152,6 +181,68 @@ void LargeFile::Close()
 
 //******************************************************************************
 
+#if POV_USE_DEFAULT_MAPPEDFILE
+
+struct MappedFile::Data final
+{
+    std::vector<char> content;
+    bool open;
+    Data() : open(false) {}
+};
+
+MappedFile::MappedFile() :
+    mpData(new Data)
+{}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+bool MappedFile::Open(const UCS2String& fileName)
+{
+    Close();
+
+    std::ifstream stream(UCS2toSysString(fileName), std::ios_base::binary | std::ios_base::in | std::ios_base::ate);
+    if (!stream.is_open())
+        return false;
+
+    std::streamoff size = stream.tellg();
+    if ((size < 0) || (std::uintmax_t(size) > std::numeric_limits<std::size_t>::max()))
+        return false;
+
+    mpData->content.resize(std::size_t(size));
+    stream.seekg(0);
+    if ((size > 0) && !stream.read(mpData->content.data(), size))
+    {
+        mpData->content.clear();
+        return false;
+    }
+
+    mpData->open = true;
+    return true;
+}
+
+void MappedFile::Close()
+{
+    std::vector<char>().swap(mpData->content);
+    mpData->open = false;
+}
+
+const void* MappedFile::GetData() const
+{
+    return (mpData->open ? mpData->content.data() : nullptr);
+}
+
+std::size_t MappedFile::GetSize() const
+{
+    return mpData->content.size();
+}
+
+#endif // POV_USE_DEFAULT_MAPPEDFILE
+
+//******************************************************************************
+
 TemporaryFile::TemporaryFile() :
     mFileName(SuggestName())
 {}
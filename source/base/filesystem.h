@@ -86,6 +86,42 @@ namespace Filesystem
 ///
 bool DeleteFile(const UCS2String& fileName);
 
+/// Rename file.
+///
+/// This function shall try to rename the specified file, replacing any
+/// existing file of the new name. Where the platform supports it, the
+/// replacement should be atomic, so that other processes see either the old
+/// or the new file, and any process still using the old file keeps its copy.
+///
+/// @note
+///     The default implementation has some limitations; specifically, it only
+///     supports file names comprised of the _narrow execution character set_,
+///     and on some platforms may fail if the new name is already in use.
+///     Platforms are strongly encouraged to provide their own implementation.
+///
+/// @param  oldName     Current name of the file.
+/// @param  newName     New name of the file.
+/// @return             `true` if the file was renamed, `false` otherwise.
+///
+bool RenameFile(const UCS2String& oldName, const UCS2String& newName);
+
+/// Get file size and modification time.
+///
+/// This function shall try to query the size of the specified file, and the
+/// time it was last modified, in seconds since 1970-01-01 00:00:00 UTC (i.e.
+/// the same epoch and unit as `std::time()` on POSIX systems).
+///
+/// @note
+///     The default implementation does not support this, and always fails.
+///     Platforms are strongly encouraged to provide their own implementation.
+///
+/// @param[in]  fileName        Name of the file to query.
+/// @param[out] size            Size of the file in bytes.
+/// @param[out] modified        Time of the last modification of the file.
+/// @return                     `true` if the information was obtained, `false` otherwise.
+///
+bool GetFileInfo(const UCS2String& fileName, std::int_least64_t& size, std::int_least64_t& modified);
+
 /// Large file handling.
 ///
 /// This class provides basic random access to large (>2 GiB) files.
@@ -130,6 +166,47 @@ private:
     std::unique_ptr<Data> mpData;
 };
 
+/// Read-only memory-mapped file.
+///
+/// This class provides read-only access to the entire content of a file as a
+/// contiguous block of memory, allowing large data files to be used in-place
+/// without copying. Platforms that support it should map the file into the
+/// address space, so that pages are only loaded on demand and are shared with
+/// any other process mapping the same file.
+///
+/// @note
+///     The default implementation simply reads the entire file into memory.
+///     Platforms are encouraged to provide their own implementation.
+///
+class MappedFile final
+{
+public:
+
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /// Open and map file.
+    /// @return `true` if the file was mapped successfully, `false` otherwise.
+    bool Open(const UCS2String& fileName);
+
+    /// Unmap and close file.
+    void Close();
+
+    /// Get pointer to the mapped content, or `nullptr` if no file is mapped.
+    const void* GetData() const;
+
+    /// Get size of the mapped content.
+    std::size_t GetSize() const;
+
+private:
+
+    struct Data;
+    std::unique_ptr<Data> mpData;
+};
+
 /// Temporary file tracker.
 ///
 /// This class can be used to make sure that a given file is automatically
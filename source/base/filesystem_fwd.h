@@ -50,6 +50,9 @@ namespace pov_base
 namespace Filesystem
 {
 
+class MappedFile;
+using MappedFilePtr = std::shared_ptr<MappedFile>;
+
 class TemporaryFile;
 using TemporaryFilePtr = std::shared_ptr<TemporaryFile>;
 
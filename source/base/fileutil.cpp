@@ -140,6 +140,9 @@ POV_File_Extensions gPOV_File_Extensions[POV_File_Count] =
     {{ ".rca",  ".RCA",  "",      ""      }}, // POV_File_Data_RCA
     {{ ".log",  ".LOG",  "",      ""      }}, // POV_File_Data_LOG
     {{ ".bak",  ".BAK",  "",      ""      }}, // POV_File_Data_Backup
+    {{ ".tok",  ".TOK",  "",      ""      }}, // POV_File_Data_Tokens
+    {{ ".msh",  ".MSH",  "",      ""      }}, // POV_File_Data_Mesh
+    {{ ".mip",  ".MIP",  "",      ""      }}, // POV_File_Data_MipMap
     {{ ".ttf",  ".TTF",  "",      ""      }}  // POV_File_Font_TTF
 };
 
@@ -170,6 +173,9 @@ const int gFile_Type_To_Mask [POV_File_Count] =
     NO_FILE,   // POV_File_Data_RCA
     NO_FILE,   // POV_File_Data_LOG
     NO_FILE,   // POV_File_Data_Backup
+    NO_FILE,   // POV_File_Data_Tokens
+    NO_FILE,   // POV_File_Data_Mesh
+    NO_FILE,   // POV_File_Data_MipMap
     NO_FILE    // POV_File_Font_TTF
 };
 
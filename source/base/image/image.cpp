@@ -888,6 +888,10 @@ class GrayImage final : public Image
         {
             return false;
         }
+        virtual const void* GetRawPixelData() const override
+        {
+            return pixels.data();
+        }
 
         virtual bool GetBitValue(unsigned int x, unsigned int y) const override
         {
@@ -1109,6 +1113,10 @@ class GrayAImage final : public Image
         {
             return false;
         }
+        virtual const void* GetRawPixelData() const override
+        {
+            return pixels.data();
+        }
 
         virtual bool GetBitValue(unsigned int x, unsigned int y) const override
         {
@@ -1338,6 +1346,10 @@ class RGBImage final : public Image
         {
             return false;
         }
+        virtual const void* GetRawPixelData() const override
+        {
+            return pixels.data();
+        }
 
         virtual bool GetBitValue(unsigned int x, unsigned int y) const override
         {
@@ -1585,6 +1597,10 @@ class RGBAImage final : public Image
         {
             return false;
         }
+        virtual const void* GetRawPixelData() const override
+        {
+            return pixels.data();
+        }
 
         virtual bool GetBitValue(unsigned int x, unsigned int y) const override
         {
@@ -1841,6 +1857,10 @@ class RGBFTImage final : public Image
         {
             return false;
         }
+        virtual const void* GetRawPixelData() const override
+        {
+            return pixels.data();
+        }
 
         virtual bool GetBitValue(unsigned int x, unsigned int y) const override
         {
@@ -2096,6 +2116,14 @@ class NonlinearGrayImage final : public Image
             gammaLUT = gamma->GetLookupTable(TMAX);
             return true;
         }
+        virtual const void* GetRawPixelData() const override
+        {
+            return pixels.data();
+        }
+        virtual const float* GetDecodingTable() const override
+        {
+            return gammaLUT;
+        }
 
         virtual bool GetBitValue(unsigned int x, unsigned int y) const override
         {
@@ -2323,6 +2351,14 @@ class NonlinearGrayAImage final : public Image
             gammaLUT = gamma->GetLookupTable(TMAX);
             return true;
         }
+        virtual const void* GetRawPixelData() const override
+        {
+            return pixels.data();
+        }
+        virtual const float* GetDecodingTable() const override
+        {
+            return gammaLUT;
+        }
 
         virtual bool GetBitValue(unsigned int x, unsigned int y) const override
         {
@@ -2562,6 +2598,14 @@ class NonlinearRGBImage final : public Image
             gammaLUT = gamma->GetLookupTable(TMAX);
             return true;
         }
+        virtual const void* GetRawPixelData() const override
+        {
+            return pixels.data();
+        }
+        virtual const float* GetDecodingTable() const override
+        {
+            return gammaLUT;
+        }
 
         virtual bool GetBitValue(unsigned int x, unsigned int y) const override
         {
@@ -2815,6 +2859,14 @@ class NonlinearRGBAImage final : public Image
             gammaLUT = gamma->GetLookupTable(TMAX);
             return true;
         }
+        virtual const void* GetRawPixelData() const override
+        {
+            return pixels.data();
+        }
+        virtual const float* GetDecodingTable() const override
+        {
+            return gammaLUT;
+        }
 
         virtual bool GetBitValue(unsigned int x, unsigned int y) const override
         {
@@ -375,6 +375,21 @@ class Image
          */
         virtual bool TryDeferDecoding(GammaCurvePtr& gamma, unsigned int max) = 0;
 
+        /**
+         *  Get read access to the raw pixel data, if the container stores it in a single contiguous block.
+         *  The data is laid out row by row, with the channels of each pixel interleaved, using the container's
+         *  native channel type as implied by @ref GetImageDataType().
+         *  @return                 Pointer to the raw pixel data, or `nullptr` if not available.
+         */
+        virtual const void* GetRawPixelData() const { return nullptr; }
+
+        /**
+         *  Get the table used to decode raw colour channel values to linear values.
+         *  @return                 Pointer to a table of @ref GetMaxIntValue()+1 entries, or `nullptr` if the
+         *                          container is not gamma-encoded.
+         */
+        virtual const float* GetDecodingTable() const { return nullptr; }
+
         void GetRGBIndexedValue(unsigned char index, float& red, float& green, float& blue) const;
         void GetRGBAIndexedValue(unsigned char index, float& red, float& green, float& blue, float& alpha) const;
         void GetRGBTIndexedValue(unsigned char index, float& red, float& green, float& blue, float& transm) const;
@@ -0,0 +1,895 @@
+//******************************************************************************
+///
+/// @file base/image/mipmap.cpp
+///
+/// Implementation of tiled, MIP-mapped image cache files.
+///
+/// @copyright
+/// @parblock
+///
+/// Persistence of Vision Ray Tracer ('POV-Ray') version 3.8.
+/// Copyright 1991-2019 Persistence of Vision Raytracer Pty. Ltd.
+///
+/// POV-Ray is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Affero General Public License as
+/// published by the Free Software Foundation, either version 3 of the
+/// License, or (at your option) any later version.
+///
+/// POV-Ray is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU Affero General Public License for more details.
+///
+/// You should have received a copy of the GNU Affero General Public License
+/// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// ----------------------------------------------------------------------------
+///
+/// POV-Ray is based on the popular DKB raytracer version 2.12.
+/// DKBTrace was originally written by David K. Buck.
+/// DKBTrace Ver 2.0-2.12 were written by David K. Buck & Aaron A. Collins.
+///
+/// @endparblock
+///
+//******************************************************************************
+
+// Unit header file must be the first file included within POV-Ray *.cpp files (pulls in config)
+#include "base/image/mipmap.h"
+
+// C++ variants of C standard header files
+#include <cstring>
+
+// C++ standard header files
+#include <algorithm>
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+// POV-Ray header files (base module)
+#include "base/colour.h"
+#include "base/fileinputoutput.h"
+#include "base/pov_err.h"
+#include "base/safemath.h"
+#include "base/image/image.h"
+
+// this must be the last file included
+#include "base/povdebug.h"
+
+namespace pov_base
+{
+
+namespace MipMap
+{
+
+/*****************************************************************************
+* Local preprocessor defines
+******************************************************************************/
+
+#define CHECK_BOUNDS(x,y) POV_IMAGE_ASSERT(((x) < width) && ((y) < height))
+
+#define ALPHA_OPAQUE                (1.0f)
+#define FT_OPAQUE                   (0.0f)
+#define IS_NONZERO_RGB(r,g,b)       ((r)*(g)*(b) != 0.0f) // same test as in the regular image containers
+
+/*****************************************************************************
+* Local typedefs
+******************************************************************************/
+
+/// Identifies MIP-mapped image cache files.
+const char MIPMAP_FILE_MAGIC[8] = { 'P', 'O', 'V', 'M', 'I', 'P', 'M', '\x1a' };
+
+/// Version of the MIP-mapped image cache file format.
+const std::uint32_t MIPMAP_FILE_VERSION = 1;
+
+/// Byte order mark of MIP-mapped image cache files.
+const std::uint32_t MIPMAP_FILE_BYTE_ORDER = 0x01020304;
+
+/// Alignment of the sections of MIP-mapped image cache files.
+/// This matches the page and sector size of typical systems, so that each
+/// tile occupies as few of them as possible.
+const std::uint64_t MIPMAP_FILE_ALIGNMENT = 4096;
+
+/// Maximum number of levels of MIP-mapped image cache files.
+const unsigned int MIPMAP_FILE_MAX_LEVELS = 32;
+
+/// Edge length of the tiles, expressed as a power of two.
+const unsigned int kTileShift = 5;
+const unsigned int kTileSize  = 1u << kTileShift;
+const unsigned int kTileMask  = kTileSize - 1;
+
+/// Flags of MIP-mapped image cache files.
+enum : std::uint32_t
+{
+    kMipMapFilePremultiplied    = 0x0001,   ///< Alpha is premultiplied.
+    kMipMapFileOpaque           = 0x0002,   ///< The original image is fully opaque.
+    kMipMapFileGammaEncoded     = 0x0004,   ///< Colour channels use a non-linear encoding.
+};
+
+/// Location and dimensions of a level of a MIP-mapped image cache file.
+struct MipMapFileLevel final
+{
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint64_t offset;
+    std::uint64_t size;
+};
+
+/// Header of a MIP-mapped image cache file.
+struct MipMapFileHeader final
+{
+    char            magic[8];
+    std::uint32_t   version;
+    std::uint32_t   byteOrder;      ///< @ref MIPMAP_FILE_BYTE_ORDER as written by the creating machine.
+    std::uint32_t   dataType;       ///< Original @ref ImageDataType.
+    std::uint32_t   flags;
+    std::uint32_t   levelCount;
+    std::uint32_t   reserved;
+    std::uint64_t   sourceSize;
+    std::uint64_t   sourceHash;
+    std::uint64_t   sourceOptions;
+    std::uint64_t   fileSize;
+    std::uint64_t   tableOffset;    ///< Location of the decoding table, or zero for floating-point data.
+    std::uint64_t   tableSize;
+    MipMapFileLevel levels[MIPMAP_FILE_MAX_LEVELS];
+};
+
+/// Pixel format of a supported image data type.
+struct MipMapFormat final
+{
+    unsigned int channels;
+    unsigned int channelSize;   ///< Size of each channel in bytes.
+    unsigned int maxValue;      ///< Maximum integer value, or zero for floating-point data.
+    bool         alpha;
+};
+
+/// Default amount of memory to hold tiles of MIP-mapped image cache files.
+const std::size_t kDefaultTileCacheLimit = std::size_t(512) << 20;
+
+/// Number of tiles each thread keeps at hand, bypassing the shared cache.
+/// Must be a power of two.
+const unsigned int kThreadTileSlots = 16;
+
+/// Raw texel data of a tile.
+using TileData = std::vector<unsigned char>;
+using TilePtr = std::shared_ptr<const TileData>;
+
+/// Identifies a tile of a MIP-mapped image cache file.
+struct TileKey final
+{
+    std::uint64_t serial;   ///< Identifies the open file.
+    std::uint64_t tile;
+    unsigned int  level;
+
+    bool operator==(const TileKey& o) const { return (serial == o.serial) && (tile == o.tile) && (level == o.level); }
+};
+
+struct TileKeyHash final
+{
+    std::size_t operator()(const TileKey& key) const
+    {
+        return std::size_t((((key.serial << 5) | key.level) * 0x9E3779B97F4A7C15ull) ^ key.tile);
+    }
+};
+
+/// Tile held by a thread.
+struct TileSlot final
+{
+    TileKey key;
+    TilePtr data;
+};
+
+/*****************************************************************************
+* Local functions
+******************************************************************************/
+
+static bool GetMipMapFormat(ImageDataType type, MipMapFormat& format)
+{
+    switch (type)
+    {
+        case ImageDataType::Gray_Int8:
+        case ImageDataType::Gray_Gamma8:    format = { 1, 1, 255,   false }; return true;
+        case ImageDataType::Gray_Int16:
+        case ImageDataType::Gray_Gamma16:   format = { 1, 2, 65535, false }; return true;
+        case ImageDataType::GrayA_Int8:
+        case ImageDataType::GrayA_Gamma8:   format = { 2, 1, 255,   true  }; return true;
+        case ImageDataType::GrayA_Int16:
+        case ImageDataType::GrayA_Gamma16:  format = { 2, 2, 65535, true  }; return true;
+        case ImageDataType::RGB_Int8:
+        case ImageDataType::RGB_Gamma8:     format = { 3, 1, 255,   false }; return true;
+        case ImageDataType::RGB_Int16:
+        case ImageDataType::RGB_Gamma16:    format = { 3, 2, 65535, false }; return true;
+        case ImageDataType::RGBA_Int8:
+        case ImageDataType::RGBA_Gamma8:    format = { 4, 1, 255,   true  }; return true;
+        case ImageDataType::RGBA_Int16:
+        case ImageDataType::RGBA_Gamma16:   format = { 4, 2, 65535, true  }; return true;
+        case ImageDataType::RGBFT_Float:    format = { 5, 4, 0,     false }; return true;
+        default:                            return false;
+    }
+}
+
+/// Round a file offset up to the section alignment.
+static inline std::uint64_t AlignMipMapFileOffset(std::uint64_t offset)
+{
+    return (offset + MIPMAP_FILE_ALIGNMENT - 1) & ~(MIPMAP_FILE_ALIGNMENT - 1);
+}
+
+/// Get the size of a tiled level in bytes.
+static inline std::uint64_t GetTiledLevelSize(std::uint32_t width, std::uint32_t height, const MipMapFormat& format)
+{
+    std::uint64_t tilesX = (std::uint64_t(width)  + kTileMask) >> kTileShift;
+    std::uint64_t tilesY = (std::uint64_t(height) + kTileMask) >> kTileShift;
+    return tilesX * tilesY * kTileSize * kTileSize * format.channels * format.channelSize;
+}
+
+/// Get the dimension of the next smaller level.
+static inline std::uint32_t GetNextLevelSize(std::uint32_t size)
+{
+    return std::max<std::uint32_t>(1, (size + 1) / 2);
+}
+
+/// Encode a linear value to the integer value whose decoded value is closest.
+static inline unsigned int EncodeChannel(float value, const float *table, unsigned int maxValue)
+{
+    const float *p = std::lower_bound(table, table + maxValue + 1, value);
+    if (p == table)
+        return 0;
+    if (p == table + maxValue + 1)
+        return maxValue;
+    return (unsigned int)(p - table) - (((*p - value) > (value - p[-1])) ? 1 : 0);
+}
+
+/// Compute the next smaller level from a row-major level.
+///
+/// Averaging is done in linear space, using a 2x2 box filter; with straight
+/// alpha, colour channels are weighted by opacity so that transparent pixels
+/// do not bleed into the result.
+///
+template<typename T>
+static void Downsample(const std::vector<T>& src, std::uint32_t srcWidth, std::uint32_t srcHeight,
+                       std::vector<T>& dst, std::uint32_t dstWidth, std::uint32_t dstHeight,
+                       const MipMapFormat& format, const float *table, bool weighted)
+{
+    const unsigned int channels = format.channels;
+    const unsigned int colourChannels = format.alpha ? channels - 1 : channels;
+    const float maxValue = float(format.maxValue);
+    float sum[5];
+
+    dst.resize(size_t(dstWidth) * dstHeight * channels);
+
+    for (std::uint32_t y = 0; y < dstHeight; ++y)
+    {
+        std::uint32_t sy[2] = { std::min(2 * y, srcHeight - 1), std::min(2 * y + 1, srcHeight - 1) };
+        for (std::uint32_t x = 0; x < dstWidth; ++x)
+        {
+            std::uint32_t sx[2] = { std::min(2 * x, srcWidth - 1), std::min(2 * x + 1, srcWidth - 1) };
+            float weightSum = 0.0f;
+            std::fill(sum, sum + channels, 0.0f);
+
+            for (int j = 0; j < 2; ++j)
+            {
+                for (int i = 0; i < 2; ++i)
+                {
+                    const T *p = &src[(sx[i] + size_t(sy[j]) * srcWidth) * channels];
+                    float weight = 1.0f;
+                    if (format.alpha)
+                    {
+                        float alpha = float(p[channels - 1]) / maxValue;
+                        sum[channels - 1] += alpha;
+                        if (weighted)
+                            weight = alpha;
+                    }
+                    for (unsigned int c = 0; c < colourChannels; ++c)
+                        sum[c] += weight * (table != nullptr ? table[size_t(p[c])] : float(p[c]));
+                    weightSum += weight;
+                }
+            }
+
+            T *q = &dst[(x + size_t(y) * dstWidth) * channels];
+            if (format.alpha)
+            {
+                float alpha = sum[channels - 1] * 0.25f;
+                q[channels - 1] = T(std::min(unsigned(alpha * maxValue + 0.5f), format.maxValue));
+            }
+            if (weightSum <= 0.0f)
+            {
+                // fully transparent; fall back to a plain average
+                std::fill(sum, sum + colourChannels, 0.0f);
+                for (int j = 0; j < 2; ++j)
+                    for (int i = 0; i < 2; ++i)
+                        for (unsigned int c = 0; c < colourChannels; ++c)
+                        {
+                            T v = src[(sx[i] + size_t(sy[j]) * srcWidth) * channels + c];
+                            sum[c] += (table != nullptr ? table[size_t(v)] : float(v));
+                        }
+                weightSum = 4.0f;
+            }
+            for (unsigned int c = 0; c < colourChannels; ++c)
+            {
+                float value = sum[c] / weightSum;
+                if (table != nullptr)
+                    q[c] = T(EncodeChannel(value, table, format.maxValue));
+                else if (format.maxValue != 0)
+                    q[c] = T(std::min(unsigned(value + 0.5f), format.maxValue));
+                else
+                    q[c] = T(value);
+            }
+        }
+    }
+}
+
+template<typename T>
+static bool WriteTiledLevel(OStream *file, const std::vector<T>& level, std::uint32_t width, std::uint32_t height,
+                            const MipMapFormat& format)
+{
+    const unsigned int channels = format.channels;
+    std::uint32_t tilesX = (width  + kTileMask) >> kTileShift;
+    std::uint32_t tilesY = (height + kTileMask) >> kTileShift;
+    std::vector<T> tile(kTileSize * kTileSize * channels);
+
+    for (std::uint32_t ty = 0; ty < tilesY; ++ty)
+    {
+        for (std::uint32_t tx = 0; tx < tilesX; ++tx)
+        {
+            // Texels beyond the image edge replicate the edge, so that they
+            // are at least harmless should anything ever read them.
+            for (unsigned int j = 0; j < kTileSize; ++j)
+            {
+                std::uint32_t y = std::min((ty << kTileShift) + j, height - 1);
+                for (unsigned int i = 0; i < kTileSize; ++i)
+                {
+                    std::uint32_t x = std::min((tx << kTileShift) + i, width - 1);
+                    std::memcpy(&tile[((j << kTileShift) + i) * channels], &level[(x + size_t(y) * width) * channels], sizeof(T) * channels);
+                }
+            }
+            if (!file->write(tile.data(), tile.size() * sizeof(T)))
+                return false;
+        }
+    }
+    return true;
+}
+
+template<typename T>
+static void WriteLevels(OStream *file, const Image *image, MipMapFileHeader& header, const MipMapFormat& format,
+                        const std::vector<float>& table)
+{
+    std::vector<std::vector<T>> levels(header.levelCount);
+    const T *pixels = reinterpret_cast<const T *>(image->GetRawPixelData());
+    const float *decode = (table.empty() ? nullptr : table.data());
+    bool weighted = format.alpha && !image->IsPremultiplied();
+
+    levels[0].assign(pixels, pixels + SafeUnsignedProduct<size_t>(header.levels[0].width, header.levels[0].height, format.channels));
+    for (std::uint32_t i = 1; i < header.levelCount; ++i)
+        Downsample(levels[i-1], header.levels[i-1].width, header.levels[i-1].height,
+                   levels[i], header.levels[i].width, header.levels[i].height, format, decode, weighted);
+
+    static const char padding[MIPMAP_FILE_ALIGNMENT] = {};
+    bool ok = file->write(&header, sizeof(header));
+    std::uint64_t written = sizeof(header);
+    if (ok && !table.empty())
+    {
+        ok = file->write(padding, size_t(header.tableOffset - written)) &&
+             file->write(table.data(), size_t(header.tableSize));
+        written = header.tableOffset + header.tableSize;
+    }
+    for (std::uint32_t i = 0; ok && (i < header.levelCount); ++i)
+    {
+        ok = file->write(padding, size_t(header.levels[i].offset - written)) &&
+             WriteTiledLevel(file, levels[i], header.levels[i].width, header.levels[i].height, format);
+        written = header.levels[i].offset + header.levels[i].size;
+        levels[i].clear();
+    }
+
+    if (!ok)
+        throw POV_EXCEPTION(kFileDataErr, "Cannot write texture cache file.");
+}
+
+/*****************************************************************************
+* Local variables
+******************************************************************************/
+
+/// Tiles most recently used by the current thread.
+///
+/// Tiles are kept here by the slot their key hashes to, holding a reference
+/// that keeps the data alive even if it has since been discarded from the
+/// shared cache.
+///
+static thread_local TileSlot gThreadTiles[kThreadTileSlots];
+
+/// Source of the serial numbers identifying open files.
+static std::atomic<std::uint64_t> gNextFileSerial(1);
+
+/*****************************************************************************
+* Local classes
+******************************************************************************/
+
+/// Process-wide cache of tiles read from MIP-mapped image cache files.
+///
+/// The tiles are kept in order of their last use; whenever the total size
+/// exceeds the limit, the least recently used ones are discarded.
+///
+/// @note
+///     This class is thread-safe.
+///
+class TileCache final
+{
+    public:
+        static TileCache& GetInstance()
+        {
+            static TileCache instance;
+            return instance;
+        }
+
+        /// Get a tile, or `nullptr` if it is not in the cache.
+        TilePtr Get(const TileKey& key)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto i = index.find(key);
+            if (i == index.end())
+                return nullptr;
+            entries.splice(entries.begin(), entries, i->second);
+            return i->second->data;
+        }
+
+        /// Add a tile, returning the one already in the cache in case another
+        /// thread has been quicker.
+        TilePtr Insert(const TileKey& key, const TilePtr& data)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto i = index.find(key);
+            if (i != index.end())
+            {
+                entries.splice(entries.begin(), entries, i->second);
+                return i->second->data;
+            }
+            entries.push_front(Entry{ key, data });
+            index.emplace(key, entries.begin());
+            size += data->size();
+            Trim();
+            return data;
+        }
+
+        /// Discard all tiles of a file.
+        void Purge(std::uint64_t serial)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto i = entries.begin(); i != entries.end(); )
+            {
+                if (i->key.serial == serial)
+                {
+                    size -= i->data->size();
+                    index.erase(i->key);
+                    i = entries.erase(i);
+                }
+                else
+                    ++i;
+            }
+        }
+
+        void SetLimit(std::size_t bytes)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            limit = bytes;
+            Trim();
+        }
+
+    private:
+
+        struct Entry final
+        {
+            TileKey key;
+            TilePtr data;
+        };
+        using EntryList = std::list<Entry>;
+
+        std::mutex mutex;
+        EntryList entries; ///< Tiles, most recently used first.
+        std::unordered_map<TileKey, EntryList::iterator, TileKeyHash> index;
+        std::size_t size;
+        std::size_t limit;
+
+        TileCache() : size(0), limit(kDefaultTileCacheLimit) {}
+
+        void Trim()
+        {
+            // The most recently used tile is always kept, no matter how low the limit.
+            while ((size > limit) && (entries.size() > 1))
+            {
+                size -= entries.back().data->size();
+                index.erase(entries.back().key);
+                entries.pop_back();
+            }
+        }
+};
+
+/// An open MIP-mapped image cache file, shared by all its levels.
+class MipMapFile final
+{
+    public:
+        MipMapFile(const std::shared_ptr<IStream>& s, const MipMapFileHeader& h, const MipMapFormat& format, std::vector<float>&& t) :
+            stream(s),
+            header(h),
+            table(std::move(t)),
+            tileSize(kTileSize * kTileSize * format.channels * format.channelSize),
+            serial(gNextFileSerial++)
+        {}
+        ~MipMapFile()
+        {
+            TileCache::GetInstance().Purge(serial);
+        }
+
+        MipMapFile(const MipMapFile&) = delete;
+        MipMapFile& operator=(const MipMapFile&) = delete;
+
+        const MipMapFileHeader& GetHeader() const { return header; }
+        const float *GetTable() const { return (table.empty() ? nullptr : table.data()); }
+
+        /// Get the texels of a tile, reading it from the file if necessary.
+        /// The data remains valid until the calling thread gets another tile.
+        inline const unsigned char *GetTile(unsigned int level, std::uint64_t tile) const
+        {
+            TileSlot& slot = gThreadTiles[(tile + level * 7 + serial * 13) & (kThreadTileSlots - 1)];
+            if ((slot.key.serial != serial) || (slot.key.tile != tile) || (slot.key.level != level))
+                FetchTile(slot, TileKey{ serial, tile, level });
+            return slot.data->data();
+        }
+
+    private:
+        std::shared_ptr<IStream> stream;
+        mutable std::mutex mutex;
+        MipMapFileHeader header;
+        std::vector<float> table;
+        std::size_t tileSize;
+        std::uint64_t serial;
+
+        void FetchTile(TileSlot& slot, const TileKey& key) const
+        {
+            TileCache& cache = TileCache::GetInstance();
+            TilePtr data = cache.Get(key);
+            if (data == nullptr)
+            {
+                auto newData = std::make_shared<TileData>(tileSize);
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!stream->seekg(POV_OFF_T(header.levels[key.level].offset + key.tile * tileSize)) ||
+                        !stream->read(newData->data(), tileSize))
+                        throw POV_EXCEPTION(kFileDataErr, "Cannot read texture cache file.");
+                }
+                data = cache.Insert(key, newData);
+            }
+            slot.key  = key;
+            slot.data = data;
+        }
+};
+
+/// Read-only image container backed by one level of a MIP-mapped image cache file.
+///
+/// All access functions behave exactly like those of the regular image
+/// container for the original data type.
+///
+template<typename T, unsigned int TMAX, unsigned int C>
+class TiledImage final : public Image
+{
+    public:
+        TiledImage(const std::shared_ptr<const MipMapFile>& f, ImageDataType t, unsigned int l) :
+            Image(f->GetHeader().levels[l].width, f->GetHeader().levels[l].height, t),
+            file(f),
+            table(f->GetTable()),
+            tilesX((f->GetHeader().levels[l].width + kTileMask) >> kTileShift),
+            level(l),
+            opaque((f->GetHeader().flags & kMipMapFileOpaque) != 0),
+            gammaEncoded((f->GetHeader().flags & kMipMapFileGammaEncoded) != 0)
+        {
+            premultiplied = ((f->GetHeader().flags & kMipMapFilePremultiplied) != 0);
+        }
+        virtual ~TiledImage() override { }
+
+        virtual bool IsOpaque() const override { return opaque; }
+        virtual bool IsGrayscale() const override { return (C <= 2); }
+        virtual bool IsColour() const override { return (C >= 3); }
+        virtual bool IsFloat() const override { return (C == 5); }
+        virtual bool IsInt() const override { return (C != 5); }
+        virtual bool IsIndexed() const override { return false; }
+        virtual bool IsGammaEncoded() const override { return gammaEncoded; }
+        virtual bool HasAlphaChannel() const override { return ((C == 2) || (C == 4)); }
+        virtual bool HasFilterTransmit() const override { return (C == 5); }
+        virtual unsigned int GetMaxIntValue() const override { return TMAX; }
+        virtual bool TryDeferDecoding(GammaCurvePtr&, unsigned int) override { return false; }
+
+        virtual bool GetBitValue(unsigned int x, unsigned int y) const override
+        {
+            // TODO FIXME - [CLi] This ignores opacity information; other bit-based code doesn't.
+            if (C <= 2)
+                return (Texel(x, y)[0] != 0);
+            float red, green, blue;
+            GetRGBValue(x, y, red, green, blue);
+            return IS_NONZERO_RGB(red, green, blue);
+        }
+        virtual float GetGrayValue(unsigned int x, unsigned int y) const override
+        {
+            if (C <= 2)
+                return Decode(Texel(x, y)[0]);
+            float red, green, blue;
+            GetRGBValue(x, y, red, green, blue);
+            return RGB2Gray(red, green, blue);
+        }
+        virtual void GetGrayAValue(unsigned int x, unsigned int y, float& gray, float& alpha) const override
+        {
+            float red, green, blue;
+            GetRGBAValue(x, y, red, green, blue, alpha);
+            gray = (C <= 2 ? red : RGB2Gray(red, green, blue));
+        }
+        virtual void GetRGBValue(unsigned int x, unsigned int y, float& red, float& green, float& blue) const override
+        {
+            const T *p = Texel(x, y);
+            if (C <= 2)
+                red = green = blue = Decode(p[0]);
+            else
+            {
+                red   = Decode(p[0]);
+                green = Decode(p[1]);
+                blue  = Decode(p[2]);
+            }
+        }
+        virtual void GetRGBAValue(unsigned int x, unsigned int y, float& red, float& green, float& blue, float& alpha) const override
+        {
+            GetRGBValue(x, y, red, green, blue);
+            if ((C == 2) || (C == 4))
+                alpha = float(Texel(x, y)[C-1]) / float(TMAX);
+            else if (C == 5)
+                alpha = RGBFTColour::FTtoA(Texel(x, y)[3], Texel(x, y)[4]);
+            else
+                alpha = ALPHA_OPAQUE;
+        }
+        virtual void GetRGBTValue(unsigned int x, unsigned int y, float& red, float& green, float& blue, float& transm) const override
+        {
+            float alpha;
+            GetRGBAValue(x, y, red, green, blue, alpha);
+            if (C == 5)
+                transm = 1.0 - RGBFTColour::FTtoA(Texel(x, y)[3], Texel(x, y)[4]);
+            else if ((C == 2) || (C == 4))
+                transm = 1.0 - alpha;
+            else
+                transm = FT_OPAQUE;
+        }
+        virtual void GetRGBFTValue(unsigned int x, unsigned int y, float& red, float& green, float& blue, float& filter, float& transm) const override
+        {
+            float alpha;
+            GetRGBAValue(x, y, red, green, blue, alpha);
+            if (C == 5)
+            {
+                filter = Texel(x, y)[3];
+                transm = Texel(x, y)[4];
+            }
+            else if ((C == 2) || (C == 4))
+                RGBFTColour::AtoFT(alpha, filter, transm);
+            else
+                filter = transm = FT_OPAQUE;
+        }
+        virtual unsigned char GetIndexedValue(unsigned int x, unsigned int y) override
+        {
+            if (C != 1)
+                return 0;
+            return (unsigned char)(int(Texel(x, y)[0]) / ((TMAX + 1) >> 8));
+        }
+
+        virtual void SetBitValue(unsigned int, unsigned int, bool) override { ReadOnly(); }
+        virtual void SetGrayValue(unsigned int, unsigned int, float) override { ReadOnly(); }
+        virtual void SetGrayValue(unsigned int, unsigned int, unsigned int) override { ReadOnly(); }
+        virtual void SetGrayAValue(unsigned int, unsigned int, float, float) override { ReadOnly(); }
+        virtual void SetGrayAValue(unsigned int, unsigned int, unsigned int, unsigned int) override { ReadOnly(); }
+        virtual void SetRGBValue(unsigned int, unsigned int, float, float, float) override { ReadOnly(); }
+        virtual void SetRGBValue(unsigned int, unsigned int, unsigned int, unsigned int, unsigned int) override { ReadOnly(); }
+        virtual void SetRGBAValue(unsigned int, unsigned int, float, float, float, float) override { ReadOnly(); }
+        virtual void SetRGBAValue(unsigned int, unsigned int, unsigned int, unsigned int, unsigned int, unsigned int) override { ReadOnly(); }
+        virtual void SetRGBTValue(unsigned int, unsigned int, float, float, float, float) override { ReadOnly(); }
+        virtual void SetRGBTValue(unsigned int, unsigned int, const RGBTColour&) override { ReadOnly(); }
+        virtual void SetRGBFTValue(unsigned int, unsigned int, float, float, float, float, float) override { ReadOnly(); }
+        virtual void SetRGBFTValue(unsigned int, unsigned int, const RGBFTColour&) override { ReadOnly(); }
+
+        virtual void FillBitValue(bool) override { ReadOnly(); }
+        virtual void FillGrayValue(float) override { ReadOnly(); }
+        virtual void FillGrayValue(unsigned int) override { ReadOnly(); }
+        virtual void FillGrayAValue(float, float) override { ReadOnly(); }
+        virtual void FillGrayAValue(unsigned int, unsigned int) override { ReadOnly(); }
+        virtual void FillRGBValue(float, float, float) override { ReadOnly(); }
+        virtual void FillRGBValue(unsigned int, unsigned int, unsigned int) override { ReadOnly(); }
+        virtual void FillRGBAValue(float, float, float, float) override { ReadOnly(); }
+        virtual void FillRGBAValue(unsigned int, unsigned int, unsigned int, unsigned int) override { ReadOnly(); }
+        virtual void FillRGBTValue(float, float, float, float) override { ReadOnly(); }
+        virtual void FillRGBFTValue(float, float, float, float, float) override { ReadOnly(); }
+    private:
+        std::shared_ptr<const MipMapFile> file;
+        const float *table;
+        std::uint32_t tilesX;
+        unsigned int level;
+        bool opaque;
+        bool gammaEncoded;
+
+        inline const T *Texel(unsigned int x, unsigned int y) const
+        {
+            CHECK_BOUNDS(x, y);
+            std::uint64_t tile = (y >> kTileShift) * std::uint64_t(tilesX) + (x >> kTileShift);
+            const T *texels = reinterpret_cast<const T *>(file->GetTile(level, tile));
+            return texels + ((((y & kTileMask) << kTileShift) + (x & kTileMask)) * C);
+        }
+        inline float Decode(T value) const
+        {
+            return (C == 5 ? float(value) : table[size_t(value)]);
+        }
+        static void ReadOnly()
+        {
+            throw POV_EXCEPTION(kUncategorizedError, "Internal error: Modification not supported in cached texture images");
+        }
+};
+
+template<typename T, unsigned int TMAX>
+static Image *NewTiledImage(const std::shared_ptr<const MipMapFile>& file, ImageDataType type,
+                            unsigned int level, unsigned int channels)
+{
+    switch (channels)
+    {
+        case 1:  return new TiledImage<T, TMAX, 1>(file, type, level);
+        case 2:  return new TiledImage<T, TMAX, 2>(file, type, level);
+        case 3:  return new TiledImage<T, TMAX, 3>(file, type, level);
+        default: return new TiledImage<T, TMAX, 4>(file, type, level);
+    }
+}
+
+/*****************************************************************************
+* Global functions
+******************************************************************************/
+
+bool IsSupported(const Image *image)
+{
+    MipMapFormat format;
+    return (image != nullptr) && (image->GetRawPixelData() != nullptr) &&
+           GetMipMapFormat(image->GetImageDataType(), format);
+}
+
+void Write(OStream *file, const Image *image, const SourceKey& key)
+{
+    MipMapFileHeader header;
+    MipMapFormat format;
+    std::vector<float> table;
+
+    if (!GetMipMapFormat(image->GetImageDataType(), format) || (image->GetRawPixelData() == nullptr))
+        throw POV_EXCEPTION(kParamErr, "Image type not supported in texture cache files.");
+
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MIPMAP_FILE_MAGIC, sizeof(header.magic));
+    header.version       = MIPMAP_FILE_VERSION;
+    header.byteOrder     = MIPMAP_FILE_BYTE_ORDER;
+    header.dataType      = std::uint32_t(image->GetImageDataType());
+    header.sourceSize    = key.size;
+    header.sourceHash    = key.hash;
+    header.sourceOptions = key.options;
+
+    if (image->IsPremultiplied())
+        header.flags |= kMipMapFilePremultiplied;
+    if (image->IsOpaque())
+        header.flags |= kMipMapFileOpaque;
+    if (image->IsGammaEncoded())
+        header.flags |= kMipMapFileGammaEncoded;
+
+    std::uint64_t offset = AlignMipMapFileOffset(sizeof(header));
+
+    // Integer data is decoded via a table, which also serves to re-encode
+    // the averaged values of the smaller levels.
+    if (format.maxValue != 0)
+    {
+        const float *decode = image->GetDecodingTable();
+        table.resize(format.maxValue + 1);
+        for (unsigned int i = 0; i <= format.maxValue; ++i)
+            table[i] = (decode != nullptr ? decode[i] : float(i) / float(format.maxValue));
+        header.tableOffset = offset;
+        header.tableSize   = table.size() * sizeof(float);
+        offset = AlignMipMapFileOffset(offset + header.tableSize);
+    }
+
+    std::uint32_t width  = image->GetWidth();
+    std::uint32_t height = image->GetHeight();
+    while (header.levelCount < MIPMAP_FILE_MAX_LEVELS)
+    {
+        MipMapFileLevel& level = header.levels[header.levelCount++];
+        level.width  = width;
+        level.height = height;
+        level.offset = offset;
+        level.size   = GetTiledLevelSize(width, height, format);
+        offset = AlignMipMapFileOffset(offset + level.size);
+        if ((width == 1) && (height == 1))
+            break;
+        width  = GetNextLevelSize(width);
+        height = GetNextLevelSize(height);
+    }
+    // The last level is not padded, so that the file size is exact.
+    header.fileSize = header.levels[header.levelCount-1].offset + header.levels[header.levelCount-1].size;
+
+    switch (format.channelSize)
+    {
+        case 1:  WriteLevels<std::uint8_t> (file, image, header, format, table); break;
+        case 2:  WriteLevels<std::uint16_t>(file, image, header, format, table); break;
+        default: WriteLevels<float>        (file, image, header, format, table); break;
+    }
+}
+
+bool Read(const std::shared_ptr<IStream>& file, const SourceKey& key, std::vector<Image*>& levels)
+{
+    POV_OFF_T size = -1;
+    MipMapFileHeader header;
+    MipMapFormat format;
+
+    levels.clear();
+
+    if (file->seekg(0, IOBase::seek_end))
+        size = file->tellg();
+    if ((size < POV_OFF_T(sizeof(header))) || !file->seekg(0) || !file->read(&header, sizeof(header)) ||
+        (std::memcmp(header.magic, MIPMAP_FILE_MAGIC, sizeof(MIPMAP_FILE_MAGIC)) != 0))
+        return false;
+
+    std::uint64_t fileSize = std::uint64_t(size);
+
+    if ((header.version != MIPMAP_FILE_VERSION) || (header.byteOrder != MIPMAP_FILE_BYTE_ORDER) ||
+        (header.sourceSize != key.size) || (header.sourceHash != key.hash) || (header.sourceOptions != key.options))
+        return false;
+
+    ImageDataType type = ImageDataType(header.dataType);
+
+    /* Make sure the table and all levels lie within the file and are
+       suitably aligned, and that the level dimensions are consistent. */
+
+    bool valid = GetMipMapFormat(type, format) && (header.fileSize == fileSize) &&
+                 (header.levelCount >= 1) && (header.levelCount <= MIPMAP_FILE_MAX_LEVELS) &&
+                 (header.levels[0].width > 0) && (header.levels[0].height > 0);
+    if (valid && (format.maxValue != 0))
+        valid = (header.tableSize == (format.maxValue + 1) * sizeof(float)) &&
+                (header.tableOffset % MIPMAP_FILE_ALIGNMENT == 0) && (header.tableOffset >= sizeof(header)) &&
+                (header.tableOffset <= fileSize) && (header.tableSize <= fileSize - header.tableOffset);
+    else if (valid)
+        valid = (header.tableOffset == 0) && (header.tableSize == 0);
+    for (std::uint32_t i = 0; valid && (i < header.levelCount); ++i)
+    {
+        const MipMapFileLevel& level = header.levels[i];
+        valid = ((i == 0) || ((level.width  == GetNextLevelSize(header.levels[i-1].width)) &&
+                              (level.height == GetNextLevelSize(header.levels[i-1].height)))) &&
+                (level.size == GetTiledLevelSize(level.width, level.height, format)) &&
+                (level.offset % MIPMAP_FILE_ALIGNMENT == 0) && (level.offset >= sizeof(header)) &&
+                (level.offset <= fileSize) && (level.size <= fileSize - level.offset);
+    }
+
+    if (!valid)
+        return false;
+
+    // The decoding table is small enough to be kept in memory as a whole.
+    std::vector<float> table;
+    if (header.tableOffset != 0)
+    {
+        table.resize(format.maxValue + 1);
+        if (!file->seekg(POV_OFF_T(header.tableOffset)) || !file->read(table.data(), size_t(header.tableSize)))
+            return false;
+    }
+
+    auto pFile = std::make_shared<const MipMapFile>(file, header, format, std::move(table));
+    for (std::uint32_t i = 0; i < header.levelCount; ++i)
+    {
+        switch (format.channelSize)
+        {
+            case 1:  levels.push_back(NewTiledImage<std::uint8_t,  255>  (pFile, type, i, format.channels)); break;
+            case 2:  levels.push_back(NewTiledImage<std::uint16_t, 65535>(pFile, type, i, format.channels)); break;
+            default: levels.push_back(new TiledImage<float, 255, 5>      (pFile, type, i));                  break;
+        }
+    }
+
+    return true;
+}
+
+void SetTileCacheLimit(std::size_t bytes)
+{
+    TileCache::GetInstance().SetLimit(bytes);
+}
+
+}
+// end of namespace MipMap
+
+}
+// end of namespace pov_base
@@ -0,0 +1,128 @@
+//******************************************************************************
+///
+/// @file base/image/mipmap.h
+///
+/// Declarations related to tiled, MIP-mapped image cache files.
+///
+/// @copyright
+/// @parblock
+///
+/// Persistence of Vision Ray Tracer ('POV-Ray') version 3.8.
+/// Copyright 1991-2019 Persistence of Vision Raytracer Pty. Ltd.
+///
+/// POV-Ray is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Affero General Public License as
+/// published by the Free Software Foundation, either version 3 of the
+/// License, or (at your option) any later version.
+///
+/// POV-Ray is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU Affero General Public License for more details.
+///
+/// You should have received a copy of the GNU Affero General Public License
+/// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// ----------------------------------------------------------------------------
+///
+/// POV-Ray is based on the popular DKB raytracer version 2.12.
+/// DKBTrace was originally written by David K. Buck.
+/// DKBTrace Ver 2.0-2.12 were written by David K. Buck & Aaron A. Collins.
+///
+/// @endparblock
+///
+//******************************************************************************
+
+#ifndef POVRAY_BASE_MIPMAP_H
+#define POVRAY_BASE_MIPMAP_H
+
+// Module config header file must be the first file included within POV-Ray unit header files
+#include "base/configbase.h"
+
+// C++ variants of C standard header files
+#include <cstddef>
+#include <cstdint>
+
+// C++ standard header files
+#include <memory>
+#include <vector>
+
+// POV-Ray header files (base module)
+#include "base/fileinputoutput_fwd.h"
+#include "base/image/image_fwd.h"
+
+namespace pov_base
+{
+
+/// Tiled, MIP-mapped image cache files.
+///
+/// These files hold the raw pixel data of a decoded image, along with a
+/// series of successively halved versions of it, arranged in square tiles so
+/// that neighbouring pixels can be loaded together. Tiles are only read from
+/// the file once the renderer actually touches them, and are kept in a
+/// process-wide cache of limited size, from which the least recently used
+/// tiles are discarded as needed.
+///
+/// Since the files are merely a cache, they carry a caller-defined key
+/// identifying the original image file and the settings it was decoded with.
+///
+namespace MipMap
+{
+
+//##############################################################################
+///
+/// @addtogroup PovBaseImage
+///
+/// @{
+
+/// Key identifying the original image of a MIP-mapped image cache file.
+struct SourceKey final
+{
+    std::uint64_t size;     ///< Size of the original file.
+    std::uint64_t hash;     ///< Hash of the original file's content.
+    std::uint64_t options;  ///< Hash of the settings the original file was decoded with.
+};
+
+/// Test whether an image can be stored in a MIP-mapped image cache file.
+/// @note
+///     Palette-based images are not supported, as their indices cannot be
+///     averaged meaningfully.
+bool IsSupported(const Image *image);
+
+/// Write an image to a MIP-mapped image cache file.
+void Write(OStream *file, const Image *image, const SourceKey& key);
+
+/// Get the levels of a MIP-mapped image cache file.
+///
+/// @param[in]  file    The file.
+/// @param[in]  key     Key the file is expected to carry.
+/// @param[out] levels  Images representing the full resolution image and the
+///                     successively halved versions, in that order. The
+///                     images are read-only, and keep the file open to read
+///                     tiles on demand. The caller takes ownership.
+/// @return             `true` if the file was valid and matched the key,
+///                     `false` otherwise.
+///
+bool Read(const std::shared_ptr<IStream>& file, const SourceKey& key, std::vector<Image*>& levels);
+
+/// Set the amount of memory to hold tiles of MIP-mapped image cache files.
+///
+/// The limit applies to all such files in use by the process. Whenever it
+/// is exceeded, the least recently used tiles are discarded, to be read
+/// again from the file should they be needed later.
+///
+/// @param[in]  bytes   Maximum size of the tile cache in bytes.
+///
+void SetTileCacheLimit(std::size_t bytes);
+
+/// @}
+///
+//##############################################################################
+
+}
+// end of namespace MipMap
+
+}
+// end of namespace pov_base
+
+#endif // POVRAY_BASE_MIPMAP_H
@@ -45,10 +45,11 @@
 #include <cstring>
 
 // C++ standard header files
-//  (none at the moment)
+#include <algorithm>
 
 // POV-Ray header files (base module)
 #include "base/pov_err.h"
+#include "base/povassert.h"
 
 // POV-Ray header files (core module)
 #include "core/math/matrix.h"
@@ -76,6 +77,7 @@ int find_axis(BBOX_TREE **Finite, ptrdiff_t first, ptrdiff_t last);
 void calc_bbox(BoundingBox *BBox, BBOX_TREE **Finite, ptrdiff_t first, ptrdiff_t last);
 void build_area_table(BBOX_TREE **Finite, ptrdiff_t a, ptrdiff_t b, BBoxScalar *areas);
 bool sort_and_split(BBOX_TREE **Root, BBOX_TREE **&Finite, size_t *numOfFiniteObjects, ptrdiff_t first, ptrdiff_t last, size_t& maxfinitecount, BBoxScalar **areaCache);
+void check_and_push(BBoxPacketStack& Stack, const BBOX_TREE *Node, const BBoxRayPacket& packet, unsigned int mask, RenderStatistics& Stats);
 
 BBoxPriorityQueue::BBoxPriorityQueue()
 {
@@ -146,6 +148,101 @@ void BBoxPriorityQueue::Clear()
     mQueue.resize(BBQ_FIRST_ELEMENT);
 }
 
+BBoxPacketStack::BBoxPacketStack()
+{
+    mStack.reserve(INITIAL_PRIORITY_QUEUE_SIZE);
+}
+
+BBoxPacketStack::~BBoxPacketStack()
+{}
+
+void BBoxPacketStack::SortTop(size_t first)
+{
+    // Sort far-to-near, so that the nearest subtree ends up on top of the stack.
+    std::sort(mStack.begin() + first, mStack.end(),
+              [](const Entry& a, const Entry& b) { return a.nearest > b.nearest; });
+}
+
+BBoxRayPacket::BBoxRayPacket(const Ray* const rays[], int count) :
+    size(count),
+    allMask((1u << count) - 1)
+{
+    POV_ASSERT((count > 0) && (count <= BBOX_PACKET_SIZE));
+
+    for (int i = 0; i < BBOX_PACKET_SIZE; ++i)
+    {
+        for (int dim = X; dim <= Z; ++dim)
+        {
+            if (i < count)
+                origin[dim][i] = rays[i]->Origin[dim];
+            else
+                origin[dim][i] = 0.0;
+
+            // Treat almost parallel rays as parallel, as the branch-free slab test can't
+            // cope with the infinities (or NaNs) their inverse direction would produce.
+            if ((i < count) && (fabs(rays[i]->Direction[dim]) >= EPSILON))
+            {
+                invDirection[dim][i] = 1.0 / rays[i]->Direction[dim];
+                parallel[dim][i] = false;
+            }
+            else
+            {
+                // Unused lanes are also treated as parallel rays; they will be masked out anyway.
+                invDirection[dim][i] = 0.0;
+                parallel[dim][i] = true;
+            }
+        }
+    }
+}
+
+unsigned int BBoxRayPacket::Intersect(const BoundingBox& bbox, unsigned int active, BBoxScalar depth[BBOX_PACKET_SIZE]) const
+{
+    // This is the same slab test as in Check_And_Enqueue(), but rearranged to be free of
+    // data-dependent branches, so that the compiler can process all rays in parallel.
+
+    BBoxScalar dmax[BBOX_PACKET_SIZE];
+    unsigned int hit = 0;
+
+    for (int i = 0; i < BBOX_PACKET_SIZE; ++i)
+    {
+        depth[i] = -BOUND_HUGE;
+        dmax[i]  =  BOUND_HUGE;
+    }
+
+    for (int dim = X; dim <= Z; ++dim)
+    {
+        const BBoxScalar lower = bbox.lowerLeft[dim];
+        const BBoxScalar upper = bbox.lowerLeft[dim] + bbox.size[dim];
+
+        for (int i = 0; i < BBOX_PACKET_SIZE; ++i)
+        {
+            BBoxScalar t0 = (lower - origin[dim][i]) * invDirection[dim][i];
+            BBoxScalar t1 = (upper - origin[dim][i]) * invDirection[dim][i];
+            BBoxScalar tmin = (t0 < t1 ? t0 : t1);
+            BBoxScalar tmax = (t0 < t1 ? t1 : t0);
+
+            // Special case: The ray runs parallel to this slab; it is either entirely inside
+            // the slab (no effect on the end result) or entirely outside (no intersection).
+            bool inside = (origin[dim][i] >= lower) && (origin[dim][i] <= upper);
+            if (parallel[dim][i])
+            {
+                tmin = (inside ? -BOUND_HUGE :  BOUND_HUGE);
+                tmax = (inside ?  BOUND_HUGE : -BOUND_HUGE);
+            }
+
+            depth[i] = (tmin > depth[i] ? tmin : depth[i]);
+            dmax[i]  = (tmax < dmax[i]  ? tmax : dmax[i]);
+        }
+    }
+
+    // A box is hit if the slab intervals overlap, and the far end is (at least almost) in front of the observer.
+    for (int i = 0; i < BBOX_PACKET_SIZE; ++i)
+        if ((depth[i] <= dmax[i]) && (dmax[i] >= EPSILON))
+            hit |= (1u << i);
+
+    return (hit & active);
+}
+
 void Destroy_BBox_Tree(BBOX_TREE *Node)
 {
     if (Node != nullptr)
@@ -647,6 +744,116 @@ void Check_And_Enqueue(BBoxPriorityQueue& Queue, const BBOX_TREE *Node, const Bo
     Queue.Insert (dmin, Node);
 }
 
+void Intersect_BBox_Tree_Packet(BBoxPacketStack& stack, const BBOX_TREE *Root, const Ray* const rays[], int count, Intersection Best_Intersections[], bool found[], const RayObjectCondition& precondition, const RayObjectCondition& postcondition, TraceThreadData *Thread)
+{
+    BBoxPacketStack::Entry current;
+    Intersection New_Intersection;
+    ObjectPtr object;
+    unsigned int mask;
+    size_t first;
+
+    // Create the SoA direction data for all rays.
+    BBoxRayPacket packet(rays, count);
+
+    for (int i = 0; i < count; i++)
+        found[i] = false;
+
+    // Start with an empty stack.
+    stack.Clear();
+    New_Intersection.Object = nullptr;
+
+    // Check top node.
+    check_and_push(stack, Root, packet, packet.allMask, Thread->Stats());
+
+    while(!stack.IsEmpty())
+    {
+        stack.Pop(current);
+
+        // Drop any rays that have already found an intersection closer than this subtree;
+        // once no rays are left, the whole subtree can be skipped.
+        mask = current.mask;
+        for (int i = 0; i < count; i++)
+        {
+            if (current.depth[i] > Best_Intersections[i].Depth)
+                mask &= ~(1u << i);
+        }
+        if (mask == 0)
+            continue;
+
+        if(current.node->Entries)
+        {
+            // This is a node containing leaves to be checked.
+            first = stack.Size();
+            for (int i = 0; i < current.node->Entries; i++)
+                check_and_push(stack, current.node->Node[i], packet, mask, Thread->Stats());
+            stack.SortTop(first);
+        }
+        else
+        {
+            // This is a leaf, so test contained object against the remaining rays individually.
+            object = reinterpret_cast<ObjectPtr>(current.node->Node);
+            for (int i = 0; i < count; i++)
+            {
+                if ((mask & (1u << i)) == 0)
+                    continue;
+
+                if(precondition(*rays[i], object, 0.0) == true)
+                {
+                    if(Find_Intersection(&New_Intersection, object, *rays[i], postcondition, Thread))
+                    {
+                        if(New_Intersection.Depth < Best_Intersections[i].Depth)
+                        {
+                            Best_Intersections[i] = New_Intersection;
+                            found[i] = true;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void check_and_push(BBoxPacketStack& Stack, const BBOX_TREE *Node, const BBoxRayPacket& packet, unsigned int mask, RenderStatistics& Stats)
+{
+    BBoxScalar depth[BBOX_PACKET_SIZE];
+    unsigned int hit;
+
+    if(Node->Infinite == false)
+    {
+        hit = packet.Intersect(Node->BBox, mask, depth);
+
+        for (int i = 0; i < packet.size; i++)
+        {
+            if (mask & (1u << i))
+                Stats[nChecked]++;
+            if (hit & (1u << i))
+                Stats[nEnqueued]++;
+        }
+
+        // If none of the rays hit the box, the packet doesn't need to visit this subtree at all.
+        if (hit == 0)
+            return;
+    }
+    else
+    {
+        // Set intersection depth to -Max_Distance.
+        hit = mask;
+        for (int i = 0; i < BBOX_PACKET_SIZE; i++)
+            depth[i] = -MAX_DISTANCE;
+    }
+
+    BBoxPacketStack::Entry& entry = Stack.Push();
+    entry.node = Node;
+    entry.mask = hit;
+    entry.nearest = BOUND_HUGE;
+    for (int i = 0; i < BBOX_PACKET_SIZE; i++)
+    {
+        entry.depth[i] = depth[i];
+        if ((hit & (1u << i)) && (depth[i] < entry.nearest))
+            entry.nearest = depth[i];
+    }
+}
+
 BBOX_TREE *create_bbox_node(int size)
 {
     BBOX_TREE *New;
@@ -270,6 +270,85 @@ class BBoxPriorityQueue final
 };
 
 
+/// Maximum number of rays traversing the bounding box hierarchy together.
+///
+/// @note   Packet data is stored in structure-of-arrays layout, so this value
+///         should be a multiple of the native SIMD width for single-precision
+///         floats (4 for SSE, 8 for AVX).
+///
+const int BBOX_PACKET_SIZE = 4;
+
+/// Bundle of coherent rays traversing the bounding box hierarchy together.
+///
+/// All data is stored in structure-of-arrays layout, so that the slab test of a
+/// single bounding box against all rays of the packet compiles to a handful of
+/// SIMD instructions rather than a loop with data-dependent branches.
+///
+/// Rays running parallel to a slab are handled by substituting an inverse
+/// direction of zero and keeping track of whether the ray's origin is inside
+/// the slab, rather than relying on IEEE infinities.
+///
+class BBoxRayPacket final
+{
+    public:
+
+        BBoxRayPacket(const Ray* const rays[], int count);
+
+        /// Number of rays in the packet.
+        int size;
+        /// Mask of all rays in the packet.
+        unsigned int allMask;
+
+        BBoxScalar origin[3][BBOX_PACKET_SIZE];
+        BBoxScalar invDirection[3][BBOX_PACKET_SIZE];
+        bool parallel[3][BBOX_PACKET_SIZE];
+
+        /// Test a bounding box against all active rays of the packet.
+        ///
+        /// @param[in]  bbox        Bounding box to test.
+        /// @param[in]  active      Mask of rays to test.
+        /// @param[out] depth       Per-ray distance to the bounding box (only valid for rays that hit).
+        /// @return                 Mask of rays hitting the bounding box.
+        ///
+        unsigned int Intersect(const BoundingBox& bbox, unsigned int active, BBoxScalar depth[BBOX_PACKET_SIZE]) const;
+};
+
+/// Stack of BBox subtrees pending traversal by a @ref BBoxRayPacket.
+///
+/// Unlike @ref BBoxPriorityQueue, traversal order is only approximately front-to-back
+/// (children are pushed sorted by their nearest entry distance among the packet's
+/// rays), and each entry carries the mask of rays still interested in the subtree.
+///
+class BBoxPacketStack final
+{
+    public:
+
+        struct Entry final
+        {
+            ConstBBoxTreePtr node;
+            unsigned int mask;                  ///< Rays still interested in this subtree.
+            BBoxScalar depth[BBOX_PACKET_SIZE]; ///< Per-ray distance to the subtree's bounding box.
+            BBoxScalar nearest;                 ///< Smallest distance among the rays in the mask.
+        };
+
+        BBoxPacketStack();
+        ~BBoxPacketStack();
+
+        Entry& Push() { mStack.emplace_back(); return mStack.back(); }
+        void Pop(Entry& entry) { entry = mStack.back(); mStack.pop_back(); }
+        bool IsEmpty() const { return mStack.empty(); }
+        size_t Size() const { return mStack.size(); }
+        void Clear() { mStack.clear(); }
+
+        /// Sort all entries from the given position upward, so that the nearest ends up on top.
+        void SortTop(size_t first);
+
+    protected:
+
+        std::vector<Entry> mStack;
+};
+
+
 /*****************************************************************************
 * Global functions
 ******************************************************************************/
@@ -280,6 +359,7 @@ void Build_Bounding_Slabs(BBOX_TREE **Root, std::vector<ObjectPtr>& objects, uns
 void Recompute_BBox(BoundingBox *bbox, const TRANSFORM *trans);
 bool Intersect_BBox_Tree(BBoxPriorityQueue& pqueue, const BBOX_TREE *Root, const Ray& ray, Intersection *Best_Intersection, TraceThreadData *Thread);
 bool Intersect_BBox_Tree(BBoxPriorityQueue& pqueue, const BBOX_TREE *Root, const Ray& ray, Intersection *Best_Intersection, const RayObjectCondition& precondition, const RayObjectCondition& postcondition, TraceThreadData *Thread);
+void Intersect_BBox_Tree_Packet(BBoxPacketStack& stack, const BBOX_TREE *Root, const Ray* const rays[], int count, Intersection Best_Intersections[], bool found[], const RayObjectCondition& precondition, const RayObjectCondition& postcondition, TraceThreadData *Thread);
 void Check_And_Enqueue(BBoxPriorityQueue& Queue, const BBOX_TREE *Node, const BoundingBox *BBox, const Rayinfo *rayinfo, RenderStatistics& Stats);
 void Destroy_BBox_Tree(BBOX_TREE *Node);
 
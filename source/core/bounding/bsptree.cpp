@@ -43,7 +43,10 @@
 
 // C++ standard header files
 #include <algorithm>
+#include <chrono>
+#include <future>
 #include <list>
+#include <memory>
 #if BSP_WRITEBOUNDS || BSP_READNODES || BSP_WRITETREE
 #include <string>
 #endif
@@ -110,12 +113,36 @@ void BSPTree::Mailbox::clear()
 // missChance is only ever used with 1.0f added to it, so we do that now as well
 //
 // NB all these values are declared const in the class definition
-BSPTree::BSPTree(unsigned int md, float oic, float bac, float cac, float mc) :
+BSPTree::BSPTree(unsigned int md, float oic, float bac, float cac, float mc, unsigned int bt) :
     maxDepth((md == 0) || (md > MAX_BSP_TREE_LEVEL) ? MAX_BSP_TREE_LEVEL : md),
     objectIsectCost(oic == 0.0f ? OBJECT_ISECT_COST : oic),
     baseAccessCost(bac == 0.0f ? BASE_ACCESS_COST : bac),
     childAccessCost(cac == 0.0f ? CHILD_ACCESS_COST : cac),
-    missChance(mc == 0.0f ? MISS_CHANCE + 1.0f : mc + 1.0f)
+    missChance(mc == 0.0f ? MISS_CHANCE + 1.0f : mc + 1.0f),
+    buildThreads(max(1u, min((unsigned int)POV_BSP_BUILD_MAX_THREADS, bt))),
+    buildNodeCounter(nullptr),
+    buildAbort(nullptr)
+{
+}
+
+BSPTree::BSPTree(const BSPTree *parent) :
+    maxDepth(parent->maxDepth),
+    objectIsectCost(parent->objectIsectCost),
+    baseAccessCost(parent->baseAccessCost),
+    childAccessCost(parent->childAccessCost),
+    missChance(parent->missChance),
+    lastProgressNodeCounter(0),
+    maxObjectsInNode(0),
+    maxTreeDepth(0),
+    maxTreeDepthNodes(0),
+    emptyNodeCounter(0),
+    objectNodeCounter(0),
+    objectsInTreeCounter(0),
+    objectsAtMaxDepthCounter(0),
+    treeDepthCounter(0),
+    buildThreads(parent->buildThreads),
+    buildNodeCounter(parent->buildNodeCounter),
+    buildAbort(parent->buildAbort)
 {
 }
 
@@ -408,7 +435,32 @@ void BSPTree::build(const Progress& progress, const Objects& objects,
     ReadRecursive(progress, infile, 0, 0, objects.size() - 1);
     fclose(infile);
 #else
-    BuildRecursive(progress, objects, 0, 0, (unsigned int) indices.size(), bbox, maxDepth);
+    {
+        std::atomic<unsigned int> nodeCounter(1);
+        std::atomic<bool> abort(false);
+        unsigned int threads = buildThreads;
+
+#if BSP_WRITETREE
+        // the tree dump is written as the tree is built, so it must be built in order
+        threads = 1;
+#endif
+        buildNodeCounter = &nodeCounter;
+        buildAbort = &abort;
+
+        try
+        {
+            BuildRecursive(progress, objects, 0, 0, (unsigned int) indices.size(), bbox, maxDepth, threads);
+        }
+        catch(...)
+        {
+            buildNodeCounter = nullptr;
+            buildAbort = nullptr;
+            throw;
+        }
+
+        buildNodeCounter = nullptr;
+        buildAbort = nullptr;
+    }
 #endif
 
 #if BSP_WRITETREE
@@ -466,13 +518,18 @@ void BSPTree::clear()
     lists.clear();
 }
 
-void BSPTree::BuildRecursive(const Progress& progress, const Objects& objects, unsigned int inode, unsigned int indexbegin, unsigned int indexend, MinMaxBoundingBox& cell, unsigned int maxlevel)
+void BSPTree::BuildRecursive(const Progress& progress, const Objects& objects, unsigned int inode, unsigned int indexbegin, unsigned int indexend, MinMaxBoundingBox& cell, unsigned int maxlevel, unsigned int threads)
 {
+    // another thread failed or the build has been cancelled, so the tree is going to be discarded anyway
+    if(buildAbort->load(std::memory_order_relaxed) == true)
+        return;
+
     maxTreeDepth = max(maxTreeDepth, maxDepth - maxlevel);
 
-    if((nodes.size() - lastProgressNodeCounter) > NODE_PROGRESS_INTERVAL)
+    unsigned int nodecount = buildNodeCounter->load(std::memory_order_relaxed);
+    if((nodecount - lastProgressNodeCounter) > NODE_PROGRESS_INTERVAL)
     {
-        lastProgressNodeCounter = (unsigned int) nodes.size();
+        lastProgressNodeCounter = nodecount;
         progress(lastProgressNodeCounter);
     }
 
@@ -526,106 +583,49 @@ void BSPTree::BuildRecursive(const Progress& progress, const Objects& objects, u
     float bestcost = baseAccessCost + (cnt * objectIsectCost);
 
     // find best split axis and plane
+    if((threads > 1) && (cnt >= POV_BSP_BUILD_PARALLEL_THRESHOLD))
     {
-        float cellsize[5];
-
-        cellsize[X] = cellsize[X + 3] = cell.pmax[X] - cell.pmin[X];
-        cellsize[Y] = cellsize[Y + 3] = cell.pmax[Y] - cell.pmin[Y];
-        cellsize[Z] =                   cell.pmax[Z] - cell.pmin[Z];
-
-        // enh is node hit expectance
-        float enh = cellsize[X] * cellsize[Y] + cellsize[X] * cellsize[Z] + cellsize[Y] * cellsize[Z];
-        float enhinv = 1.0f / enh;
+        // sort the split candidates of the three axes concurrently, using as many of the threads
+        // available to this builder as possible; each axis has its own split array
+        float axiscost[3] = { bestcost, bestcost, bestcost };
+        unsigned int axissplit[3] = { 0, 0, 0 };
+        unsigned int axisscnt[3] = { 0, 0, 0 };
+        bool axisfound[3];
+
+        std::future<bool> ytask = std::async(std::launch::async, [&]()
+            { return FindBestSplit(objects, Y, indexbegin, indexend, cell, axiscost[Y], axissplit[Y], axisscnt[Y]); });
+        std::future<bool> ztask;
+        if(threads > 2)
+            ztask = std::async(std::launch::async, [&]()
+                { return FindBestSplit(objects, Z, indexbegin, indexend, cell, axiscost[Z], axissplit[Z], axisscnt[Z]); });
+        axisfound[X] = FindBestSplit(objects, X, indexbegin, indexend, cell, axiscost[X], axissplit[X], axisscnt[X]);
+        if(ztask.valid())
+            axisfound[Z] = ztask.get();
+        else
+            axisfound[Z] = FindBestSplit(objects, Z, indexbegin, indexend, cell, axiscost[Z], axissplit[Z], axisscnt[Z]);
+        axisfound[Y] = ytask.get();
 
-        // try every axis
+        // pick axes in the same order as the serial search so that the resulting tree is identical
         for(unsigned int axis = 0; axis < 3; axis++)
         {
-            unsigned int pa = 0; // objects only in left side
-            unsigned int pb = cnt; // objects only in right side
-            unsigned int pab = 0; // objects in both
-            float bmin = cell.pmin[axis];
-            float bmax = cell.pmax[axis];
-
-            // eph is plane hit expectance
-            float eph = cellsize[axis + 1] * cellsize[axis + 2];
-
-            // cph is plane hit relative chance (eph / enh)
-            float cph = eph * enhinv;
-
-            // relmul is used to calculate 'r' given the offset into the node
-            float relmul = 1.0f / cellsize[axis];
-
-            // chmul is used to calculate cah and cbh once we know r
-            float chmul = cellsize[axis] * (cellsize[axis + 1] + cellsize[axis + 2]) * enhinv;
-
-            // constcost is TK1 + TK2 + (1 + CPH) * TK3 in Eric's article
-            float constcost = baseAccessCost + ((1.0f + cph) * childAccessCost);
-
-            // since cph/2 is used in the main cost calculation we do the division here to avoid
-            // doing it multiple times in the below loop.
-            cph *= 0.5;
-
-            unsigned int scnt = 0;
-            for(unsigned int i = indexbegin; i < indexend; i++)
+            if(axisfound[axis] && (axiscost[axis] < bestcost))
             {
-                float smin = objects.GetMin(axis, indices[i]) - BSP_TOLERANCE;
-                float smax = objects.GetMax(axis, indices[i]) + BSP_TOLERANCE;
-
-                // (if they are equal for our purpose we consider it outside)
-                if((smin >= bmax) || (smax <= bmin))
-                    continue ;
-
-                if(smin < bmin)
-                {
-                    // definitely intersects a, may not intersect b
-                    // if it does intersect b then as it also intersects a, we need to add
-                    // one to the common count (pab) and decrement the right-only count (pb).
-                    pab++;
-                    pb--;
-                }
-                splits[axis][scnt++] = Split(Split::Min, indices[i], smin);
-                splits[axis][scnt++] = Split(Split::Max, indices[i], smax);
-            }
-
-            sort(splits[axis].begin(), splits[axis].begin() + scnt);
-
-            for(unsigned int i = 0; i < scnt; i++)
-            {
-                float plane = splits[axis][i].plane;
-
-                if(splits[axis][i].se == Split::Max) // leaving object
-                {
-                    pa++;
-                    pab--;
-                }
-
-                if((plane > bmin) && (plane < bmax))
-                {
-                    float r = (plane - cell.pmin[axis]) * relmul; // range 0.0 (close boundary) to 1.0 (far boundary)
-                    float cah = r * chmul;                        // chance of 'a' hit
-                    float cbh = (1.0f - r) * chmul;               // chance of 'b' hit
-
-                    // cost function as presented in Ray Tracing News Vol. 17 No. 1 by Eric Haines [trf]
-                    // NB cph has been pre-divided by 2 and missChance has had 1.0 added to it.
-                    float cost = constcost + (objectIsectCost * (pab + (cph  * ((missChance * pa) + (missChance * pb))) + (cah * pa) + (cbh * pb)));
-
-                    if(cost < bestcost)
-                    {
-                        bestcost = cost;
-                        bestsplit = i;
-                        bestaxis = axis;
-                        bestscnt = scnt;
-                    }
-                }
-
-                if(splits[axis][i].se == Split::Min) // entering object
-                {
-                    pab++;
-                    pb--;
-                }
+                bestcost = axiscost[axis];
+                bestsplit = axissplit[axis];
+                bestaxis = axis;
+                bestscnt = axisscnt[axis];
             }
         }
     }
+    else
+    {
+        // try every axis
+        for(unsigned int axis = 0; axis < 3; axis++)
+        {
+            if(FindBestSplit(objects, axis, indexbegin, indexend, cell, bestcost, bestsplit, bestscnt))
+                bestaxis = axis;
+        }
+    }
 
     if(bestaxis == Node::NoAxis) // no better split found, so stop at this node
     {
@@ -642,6 +642,7 @@ void BSPTree::BuildRecursive(const Progress& progress, const Objects& objects, u
         // create child nodes
         nodes.push_back(Node());
         nodes.push_back(Node());
+        buildNodeCounter->fetch_add(2, std::memory_order_relaxed);
 
         // set current node
         nodes[inode].type = Node::Split;
@@ -688,17 +689,58 @@ void BSPTree::BuildRecursive(const Progress& progress, const Objects& objects, u
         }
         unsigned int end = (unsigned int) indices.size();
 
-        // split left cell
-        ptemp = cell.pmax[bestaxis];
-        cell.pmax[bestaxis] = bestplane;
-        BuildRecursive(progress, objects, ichild, begin, middle, cell, maxlevel - 1);
-        cell.pmax[bestaxis] = ptemp;
+        if((threads > 1) && ((middle - begin) >= POV_BSP_BUILD_PARALLEL_THRESHOLD) && ((end - middle) >= POV_BSP_BUILD_PARALLEL_THRESHOLD))
+        {
+            // build left cell on a separate thread into a tree of its own, and merge it when done;
+            // the threads available to this builder are divided between the two cells
+            unsigned int subtreethreads = threads / 2;
+            std::unique_ptr<BSPTree> subtree(new BSPTree(this));
+            MinMaxBoundingBox subcell = cell;
+
+            subcell.pmax[bestaxis] = bestplane;
+            subtree->indices.assign(indices.begin() + begin, indices.begin() + middle);
+
+            std::future<void> task = std::async(std::launch::async, [&]()
+                { subtree->BuildSubtree(objects, subcell, maxlevel - 1, subtreethreads); });
+
+            try
+            {
+                // split right cell
+                ptemp = cell.pmin[bestaxis];
+                cell.pmin[bestaxis] = bestplane;
+                BuildRecursive(progress, objects, ichild + 1, middle, end, cell, maxlevel - 1, threads - subtreethreads);
+                cell.pmin[bestaxis] = ptemp;
+
+                // keep reporting progress (and giving the task a chance to be cancelled) while waiting
+                while(task.wait_for(std::chrono::milliseconds(100)) != std::future_status::ready)
+                    progress(buildNodeCounter->load(std::memory_order_relaxed));
+
+                task.get();
+            }
+            catch(...)
+            {
+                buildAbort->store(true);
+                if(task.valid())
+                    task.wait();
+                throw;
+            }
 
-        // split right cell
-        ptemp = cell.pmin[bestaxis];
-        cell.pmin[bestaxis] = bestplane;
-        BuildRecursive(progress, objects, ichild + 1, middle, end, cell, maxlevel - 1);
-        cell.pmin[bestaxis] = ptemp;
+            MergeSubtree(ichild, *subtree);
+        }
+        else
+        {
+            // split left cell
+            ptemp = cell.pmax[bestaxis];
+            cell.pmax[bestaxis] = bestplane;
+            BuildRecursive(progress, objects, ichild, begin, middle, cell, maxlevel - 1, threads);
+            cell.pmax[bestaxis] = ptemp;
+
+            // split right cell
+            ptemp = cell.pmin[bestaxis];
+            cell.pmin[bestaxis] = bestplane;
+            BuildRecursive(progress, objects, ichild + 1, middle, end, cell, maxlevel - 1, threads);
+            cell.pmin[bestaxis] = ptemp;
+        }
 
         // the efficiency of this code depends on the assumption that resize() does not
         // de-allocate memory when truncating a vector.
@@ -706,6 +748,167 @@ void BSPTree::BuildRecursive(const Progress& progress, const Objects& objects, u
     }
 }
 
+bool BSPTree::FindBestSplit(const Objects& objects, unsigned int axis, unsigned int indexbegin, unsigned int indexend, const MinMaxBoundingBox& cell,
+                            float& bestcost, unsigned int& bestsplit, unsigned int& bestscnt)
+{
+    unsigned int cnt = indexend - indexbegin; // number of objects
+    bool found = false;
+    float cellsize[5];
+
+    cellsize[X] = cellsize[X + 3] = cell.pmax[X] - cell.pmin[X];
+    cellsize[Y] = cellsize[Y + 3] = cell.pmax[Y] - cell.pmin[Y];
+    cellsize[Z] =                   cell.pmax[Z] - cell.pmin[Z];
+
+    // enh is node hit expectance
+    float enh = cellsize[X] * cellsize[Y] + cellsize[X] * cellsize[Z] + cellsize[Y] * cellsize[Z];
+    float enhinv = 1.0f / enh;
+
+    unsigned int pa = 0; // objects only in left side
+    unsigned int pb = cnt; // objects only in right side
+    unsigned int pab = 0; // objects in both
+    float bmin = cell.pmin[axis];
+    float bmax = cell.pmax[axis];
+
+    // eph is plane hit expectance
+    float eph = cellsize[axis + 1] * cellsize[axis + 2];
+
+    // cph is plane hit relative chance (eph / enh)
+    float cph = eph * enhinv;
+
+    // relmul is used to calculate 'r' given the offset into the node
+    float relmul = 1.0f / cellsize[axis];
+
+    // chmul is used to calculate cah and cbh once we know r
+    float chmul = cellsize[axis] * (cellsize[axis + 1] + cellsize[axis + 2]) * enhinv;
+
+    // constcost is TK1 + TK2 + (1 + CPH) * TK3 in Eric's article
+    float constcost = baseAccessCost + ((1.0f + cph) * childAccessCost);
+
+    // since cph/2 is used in the main cost calculation we do the division here to avoid
+    // doing it multiple times in the below loop.
+    cph *= 0.5;
+
+    unsigned int scnt = 0;
+    for(unsigned int i = indexbegin; i < indexend; i++)
+    {
+        float smin = objects.GetMin(axis, indices[i]) - BSP_TOLERANCE;
+        float smax = objects.GetMax(axis, indices[i]) + BSP_TOLERANCE;
+
+        // (if they are equal for our purpose we consider it outside)
+        if((smin >= bmax) || (smax <= bmin))
+            continue ;
+
+        if(smin < bmin)
+        {
+            // definitely intersects a, may not intersect b
+            // if it does intersect b then as it also intersects a, we need to add
+            // one to the common count (pab) and decrement the right-only count (pb).
+            pab++;
+            pb--;
+        }
+        splits[axis][scnt++] = Split(Split::Min, indices[i], smin);
+        splits[axis][scnt++] = Split(Split::Max, indices[i], smax);
+    }
+
+    sort(splits[axis].begin(), splits[axis].begin() + scnt);
+
+    for(unsigned int i = 0; i < scnt; i++)
+    {
+        float plane = splits[axis][i].plane;
+
+        if(splits[axis][i].se == Split::Max) // leaving object
+        {
+            pa++;
+            pab--;
+        }
+
+        if((plane > bmin) && (plane < bmax))
+        {
+            float r = (plane - cell.pmin[axis]) * relmul; // range 0.0 (close boundary) to 1.0 (far boundary)
+            float cah = r * chmul;                        // chance of 'a' hit
+            float cbh = (1.0f - r) * chmul;               // chance of 'b' hit
+
+            // cost function as presented in Ray Tracing News Vol. 17 No. 1 by Eric Haines [trf]
+            // NB cph has been pre-divided by 2 and missChance has had 1.0 added to it.
+            float cost = constcost + (objectIsectCost * (pab + (cph  * ((missChance * pa) + (missChance * pb))) + (cah * pa) + (cbh * pb)));
+
+            if(cost < bestcost)
+            {
+                bestcost = cost;
+                bestsplit = i;
+                bestscnt = scnt;
+                found = true;
+            }
+        }
+
+        if(splits[axis][i].se == Split::Min) // entering object
+        {
+            pab++;
+            pb--;
+        }
+    }
+
+    return found;
+}
+
+void BSPTree::BuildSubtree(const Objects& objects, const MinMaxBoundingBox& cell, unsigned int maxlevel, unsigned int threads)
+{
+    // progress is reported by the thread that started the build
+    class NoProgress final : public Progress
+    {
+        public:
+            virtual void operator()(unsigned int) const override { }
+    } noprogress;
+
+    MinMaxBoundingBox subcell = cell;
+    unsigned int cnt = (unsigned int) indices.size();
+
+    // only the objects of this subtree can end up in its split candidate arrays
+    splits[X].resize(cnt * 2);
+    splits[Y].resize(cnt * 2);
+    splits[Z].resize(cnt * 2);
+
+    nodes.push_back(Node());
+    BuildRecursive(noprogress, objects, 0, 0, cnt, subcell, maxlevel, threads);
+
+    splits[X].clear();
+    splits[Y].clear();
+    splits[Z].clear();
+}
+
+void BSPTree::MergeSubtree(unsigned int inode, const BSPTree& subtree)
+{
+    // the subtree root replaces the node it was built for, all other nodes are appended
+    unsigned int nodeoffset = (unsigned int) nodes.size() - 1;
+    unsigned int listoffset = (unsigned int) lists.size();
+
+    for(unsigned int i = 0; i < subtree.nodes.size(); i++)
+    {
+        Node node = subtree.nodes[i];
+
+        if(node.type == Node::Split)
+            node.index += nodeoffset;
+        else if(node.data == Node::ObjectList)
+            node.index2 += listoffset;
+
+        if(i == 0)
+            nodes[inode] = node;
+        else
+            nodes.push_back(node);
+    }
+
+    lists.insert(lists.end(), subtree.lists.begin(), subtree.lists.end());
+
+    maxObjectsInNode = max(maxObjectsInNode, subtree.maxObjectsInNode);
+    maxTreeDepth = max(maxTreeDepth, subtree.maxTreeDepth);
+    maxTreeDepthNodes += subtree.maxTreeDepthNodes;
+    emptyNodeCounter += subtree.emptyNodeCounter;
+    objectNodeCounter += subtree.objectNodeCounter;
+    objectsInTreeCounter += subtree.objectsInTreeCounter;
+    objectsAtMaxDepthCounter += subtree.objectsAtMaxDepthCounter;
+    treeDepthCounter += subtree.treeDepthCounter;
+}
+
 void BSPTree::SetObjectNode(unsigned int inode, unsigned int indexbegin, unsigned int indexend)
 {
     unsigned int count = indexend - indexbegin;
@@ -43,6 +43,7 @@
 //  (none at the moment)
 
 // C++ standard header files
+#include <atomic>
 #include <vector>
 
 // POV-Ray header files (base module)
@@ -132,7 +133,7 @@ class BSPTree final
                 virtual void operator()(unsigned int nodes) const = 0;
         };
 
-        BSPTree(unsigned int md = 0, float oic = 0.0f, float bac = 0.0f, float cac = 0.0f, float mc = 0.0f);
+        BSPTree(unsigned int md = 0, float oic = 0.0f, float bac = 0.0f, float cac = 0.0f, float mc = 0.0f, unsigned int bt = 1);
         virtual ~BSPTree();
 
         bool operator()(const BasicRay& ray, Intersect& isect, Mailbox& mailbox, double maxdist);
@@ -259,8 +260,21 @@ class BSPTree final
         POV_LONG treeDepthCounter;
         /// object index list (only used while building tree)
         std::vector<unsigned int> indices;
-
-        void BuildRecursive(const Progress& progress, const Objects& objects, unsigned int inode, unsigned int indexbegin, unsigned int indexend, MinMaxBoundingBox& cell, unsigned int maxlevel);
+        /// maximum number of threads to build the tree with
+        unsigned int buildThreads;
+        /// node counter shared with subtree builders (only used while building tree)
+        std::atomic<unsigned int> *buildNodeCounter;
+        /// abort flag shared with subtree builders (only used while building tree)
+        std::atomic<bool> *buildAbort;
+
+        /// Create a builder for a subtree of the specified tree, to be run on a separate thread.
+        explicit BSPTree(const BSPTree *parent);
+
+        void BuildRecursive(const Progress& progress, const Objects& objects, unsigned int inode, unsigned int indexbegin, unsigned int indexend, MinMaxBoundingBox& cell, unsigned int maxlevel, unsigned int threads);
+        void BuildSubtree(const Objects& objects, const MinMaxBoundingBox& cell, unsigned int maxlevel, unsigned int threads);
+        void MergeSubtree(unsigned int inode, const BSPTree& subtree);
+        bool FindBestSplit(const Objects& objects, unsigned int axis, unsigned int indexbegin, unsigned int indexend, const MinMaxBoundingBox& cell,
+                           float& bestcost, unsigned int& bestsplit, unsigned int& bestscnt);
         void SetObjectNode(unsigned int inode, unsigned int indexbegin, unsigned int indexend);
 
         void ReadRecursive(const Progress& progress, FILE *infile, unsigned int inode, unsigned int level, unsigned int maxIndex);
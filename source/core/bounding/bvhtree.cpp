@@ -0,0 +1,621 @@
+//******************************************************************************
+///
+/// @file core/bounding/bvhtree.cpp
+///
+/// Implementations related to the wide bounding volume hierarchy.
+///
+/// @copyright
+/// @parblock
+///
+/// Persistence of Vision Ray Tracer ('POV-Ray') version 3.8.
+/// Copyright 1991-2019 Persistence of Vision Raytracer Pty. Ltd.
+///
+/// POV-Ray is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Affero General Public License as
+/// published by the Free Software Foundation, either version 3 of the
+/// License, or (at your option) any later version.
+///
+/// POV-Ray is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU Affero General Public License for more details.
+///
+/// You should have received a copy of the GNU Affero General Public License
+/// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// ----------------------------------------------------------------------------
+///
+/// POV-Ray is based on the popular DKB raytracer version 2.12.
+/// DKBTrace was originally written by David K. Buck.
+/// DKBTrace Ver 2.0-2.12 were written by David K. Buck & Aaron A. Collins.
+///
+/// @endparblock
+///
+//******************************************************************************
+
+// Unit header file must be the first file included within POV-Ray *.cpp files (pulls in config)
+#include "core/bounding/bvhtree.h"
+
+// C++ variants of C standard header files
+//  (none at the moment)
+
+// C++ standard header files
+#include <algorithm>
+#include <cstdint>
+
+// POV-Ray header files (base module)
+//  (none at the moment)
+
+// POV-Ray header files (core module)
+#include "core/render/ray.h"
+
+// this must be the last file included
+#include "base/povdebug.h"
+
+namespace pov
+{
+
+using std::min;
+using std::max;
+using std::vector;
+
+#define MAX_BVH_TREE_LEVEL      64
+#define BVH_MAX_LEAF_OBJECTS    4
+#define BVH_SAH_BINS            16
+#define BVH_TRAVERSAL_COST      1.0f
+#define BVH_OBJECT_ISECT_COST   2.0f
+
+const unsigned int NODE_PROGRESS_INTERVAL = 1000;
+
+//******************************************************************************
+
+/// Half the surface area of a bounding box, which is all the SAH needs.
+static inline float HalfArea(const MinMaxBoundingBox& bbox)
+{
+    BBoxVector3d size = bbox.pmax - bbox.pmin;
+    if ((size[X] < 0.0f) || (size[Y] < 0.0f) || (size[Z] < 0.0f))
+        return 0.0f;
+    return size[X] * size[Y] + size[Y] * size[Z] + size[Z] * size[X];
+}
+
+static inline void MakeEmpty(MinMaxBoundingBox& bbox)
+{
+    bbox.pmin = BBoxVector3d(BOUND_HUGE);
+    bbox.pmax = BBoxVector3d(-BOUND_HUGE);
+}
+
+static inline void Extend(MinMaxBoundingBox& bbox, const MinMaxBoundingBox& other)
+{
+    bbox.pmin = min(bbox.pmin, other.pmin);
+    bbox.pmax = max(bbox.pmax, other.pmax);
+}
+
+//******************************************************************************
+
+BVHTree::BVHTree() :
+    pNodes(nullptr),
+    numNodes(0),
+    pLists(nullptr),
+    numObjects(0),
+    lastProgressNodeCounter(0),
+    maxObjectsInLeaf(0),
+    maxTreeDepth(0),
+    leafCounter(0),
+    treeDepthCounter(0)
+{
+}
+
+BVHTree::~BVHTree()
+{
+}
+
+bool BVHTree::operator()(const BasicRay& ray, Intersect& isect, double maxdist) const
+{
+    Traverse(ray, maxdist, [&](unsigned int first, unsigned int count, double& md)
+    {
+        for (unsigned int i = first, e = first + count; i < e; i++)
+            isect(pLists[i], md);
+    });
+
+    return isect(); // see if any objects were hit
+}
+
+bool BVHTree::operator()(const BasicRay& ray, IntersectLeaf& isect, double maxdist) const
+{
+    Traverse(ray, maxdist, [&](unsigned int first, unsigned int count, double& md)
+    {
+        isect(first, count, md);
+    });
+
+    return isect(); // see if any objects were hit
+}
+
+template<typename LEAF_FUNCTOR>
+void BVHTree::Traverse(const BasicRay& ray, double& maxdist, LEAF_FUNCTOR leaf) const
+{
+    struct TraceStack final
+    {
+        unsigned int index;
+        unsigned int count;
+        float rentry;
+    };
+
+    TraceStack tstack[MAX_BVH_TREE_LEVEL * kWidth];
+    unsigned int tstackpos = 0;
+    float origin[3];
+    float invdir[3];
+    bool positive[3];
+    bool parallel[3];
+
+    if (numNodes == 0)
+        return;
+
+    for (int dim = X; dim <= Z; ++dim)
+    {
+        origin[dim] = float(ray.Origin[dim]);
+        parallel[dim] = (ray.Direction[dim] == 0.0);
+        positive[dim] = (ray.Direction[dim] >= 0.0);
+        invdir[dim] = (parallel[dim] ? 0.0f : float(1.0 / ray.Direction[dim]));
+    }
+
+    tstack[tstackpos].index = 0;
+    tstack[tstackpos].count = 0;
+    tstack[tstackpos].rentry = -BOUND_HUGE;
+    tstackpos++;
+
+    while (tstackpos > 0)
+    {
+        const TraceStack& entry = tstack[--tstackpos];
+
+        // skip anything farther away than the nearest hit so far
+        if (entry.rentry > maxdist)
+            continue;
+
+        if (entry.count > 0)
+        {
+            // leaf; test all objects
+            leaf(entry.index, entry.count, maxdist);
+            continue;
+        }
+
+        const Node& node = pNodes[entry.index];
+        float rentry[kWidth];
+        float rexit[kWidth];
+
+        // Test the ray against all children at once; the loops are free of data-dependent
+        // branches, so that the compiler can vectorize them.
+
+        for (unsigned int i = 0; i < kWidth; i++)
+        {
+            rentry[i] = -BOUND_HUGE;
+            rexit[i]  =  BOUND_HUGE;
+        }
+
+        for (int dim = X; dim <= Z; ++dim)
+        {
+            const float *nearplane = (positive[dim] ? node.bmin[dim] : node.bmax[dim]);
+            const float *farplane  = (positive[dim] ? node.bmax[dim] : node.bmin[dim]);
+
+            if (parallel[dim])
+            {
+                // The ray runs parallel to this slab; it is either entirely inside the slab or entirely outside.
+                for (unsigned int i = 0; i < kWidth; i++)
+                {
+                    if ((origin[dim] < node.bmin[dim][i]) || (origin[dim] > node.bmax[dim][i]))
+                        rexit[i] = -BOUND_HUGE;
+                }
+            }
+            else
+            {
+                for (unsigned int i = 0; i < kWidth; i++)
+                {
+                    float tnear = (nearplane[i] - origin[dim]) * invdir[dim];
+                    float tfar  = (farplane[i]  - origin[dim]) * invdir[dim];
+                    rentry[i] = (tnear > rentry[i] ? tnear : rentry[i]);
+                    rexit[i]  = (tfar  < rexit[i]  ? tfar  : rexit[i]);
+                }
+            }
+        }
+
+        // Collect the children hit, sorted far-to-near so that the nearest one ends up on top of the stack.
+        // Unused slots have inverted bounds, and are therefore never hit.
+        unsigned int first = tstackpos;
+        for (unsigned int i = 0; i < kWidth; i++)
+        {
+            if ((rentry[i] <= rexit[i]) && (rexit[i] >= 0.0f) && (rentry[i] <= maxdist))
+            {
+                unsigned int j = tstackpos++;
+                while ((j > first) && (tstack[j - 1].rentry < rentry[i]))
+                {
+                    tstack[j] = tstack[j - 1];
+                    j--;
+                }
+                tstack[j].index = node.index[i];
+                tstack[j].count = node.count[i];
+                tstack[j].rentry = rentry[i];
+            }
+        }
+    }
+}
+
+bool BVHTree::operator()(const Vector3d& origin, Inside& inside, bool earlyExit) const
+{
+    unsigned int tstack[MAX_BVH_TREE_LEVEL * kWidth];
+    unsigned int tstackpos = 0;
+
+    if (numNodes == 0)
+        return false;
+
+    tstack[tstackpos++] = 0;
+    while (tstackpos > 0)
+    {
+        const Node& node = pNodes[tstack[--tstackpos]];
+
+        for (unsigned int i = 0; i < kWidth; i++)
+        {
+            // Unused slots have inverted bounds, and are therefore never entered.
+            if ((origin[X] < node.bmin[X][i]) || (origin[Y] < node.bmin[Y][i]) || (origin[Z] < node.bmin[Z][i]) ||
+                (origin[X] > node.bmax[X][i]) || (origin[Y] > node.bmax[Y][i]) || (origin[Z] > node.bmax[Z][i]))
+                continue;
+
+            if (node.count[i] > 0)
+            {
+                for (unsigned int j = node.index[i], e = node.index[i] + node.count[i]; j < e; j++)
+                    inside(pLists[j]);
+                if (earlyExit && inside())
+                    return true;
+            }
+            else
+                tstack[tstackpos++] = node.index[i];
+        }
+    }
+
+    return inside();
+}
+
+void BVHTree::build(const Progress& progress, const Objects& objects,
+                    unsigned int& totalnodes, unsigned int& leafnodes, unsigned int& maxobjects, float& averageobjects,
+                    unsigned int& maxdepth, float& averagedepth)
+{
+    BuildRange range;
+
+    clear();
+
+    lastProgressNodeCounter = 0;
+    maxObjectsInLeaf = 0;
+    maxTreeDepth = 0;
+    leafCounter = 0;
+    treeDepthCounter = 0;
+
+    progress(0);
+
+    // allocate memory that is going to be needed for building
+    objectBounds.resize(objects.size());
+    centroids.resize(objects.size());
+    lists.resize(objects.size());
+
+    for (unsigned int i = 0; i < objects.size(); i++)
+    {
+        objectBounds[i].pmin = BBoxVector3d(objects.GetMin(X, i), objects.GetMin(Y, i), objects.GetMin(Z, i));
+        objectBounds[i].pmax = BBoxVector3d(objects.GetMax(X, i), objects.GetMax(Y, i), objects.GetMax(Z, i));
+        centroids[i] = (objectBounds[i].pmin + objectBounds[i].pmax) * 0.5f;
+        lists[i] = i;
+    }
+
+    // recursively build tree
+    if (objects.size() > 0)
+    {
+        range.begin = 0;
+        range.end = objects.size();
+        range.splittable = true;
+        ComputeBounds(range);
+
+        (void)BuildRecursive(progress, range, 1);
+    }
+
+    // memory was only needed for building
+    vector<MinMaxBoundingBox>().swap(objectBounds);
+    vector<BBoxVector3d>().swap(centroids);
+
+    progress((unsigned int) nodes.size());
+
+    totalnodes = (unsigned int) nodes.size();
+    leafnodes = leafCounter;
+    maxobjects = maxObjectsInLeaf;
+    averageobjects = (leafCounter > 0 ? float(double(lists.size()) / double(leafCounter)) : 0.0f);
+    maxdepth = maxTreeDepth;
+    averagedepth = (leafCounter > 0 ? float(double(treeDepthCounter) / double(leafCounter)) : 0.0f);
+
+    // free up unused allocation in nodes
+    vector<Node> tmpnodes;
+    tmpnodes.swap(nodes);
+    nodes = tmpnodes;
+
+    pNodes = nodes.data();
+    numNodes = nodes.size();
+    pLists = lists.data();
+    numObjects = (unsigned int) lists.size();
+}
+
+void BVHTree::clear()
+{
+    nodes.clear();
+    lists.clear();
+    pNodes = nullptr;
+    numNodes = 0;
+    pLists = nullptr;
+    numObjects = 0;
+}
+
+bool BVHTree::Attach(const void *nodeData, std::size_t nodeDataSize, const unsigned int *objectList, unsigned int objectCount)
+{
+    clear();
+
+    if ((nodeData == nullptr) || (nodeDataSize == 0) || (nodeDataSize % sizeof(Node) != 0) ||
+        (reinterpret_cast<std::uintptr_t>(nodeData) % alignof(Node) != 0) ||
+        ((objectCount > 0) && (objectList == nullptr)) ||
+        (reinterpret_cast<std::uintptr_t>(objectList) % alignof(unsigned int) != 0))
+        return false;
+
+    const Node *nodeArray = reinterpret_cast<const Node*>(nodeData);
+    std::size_t nodeCount = nodeDataSize / sizeof(Node);
+
+    // Make sure traversal can neither leave the arrays nor loop, and that the depth does not
+    // exceed what the traversal stacks are sized for. Built trees always place children after
+    // their parent, so a single pass suffices to establish each node's level.
+    vector<unsigned char> level(nodeCount, 0);
+    level[0] = 1;
+    for (std::size_t n = 0; n < nodeCount; n++)
+    {
+        if (level[n] == 0)
+            return false;
+
+        const Node& node = nodeArray[n];
+        for (unsigned int i = 0; i < kWidth; i++)
+        {
+            if (node.count[i] > 0)
+            {
+                if (std::uint64_t(node.index[i]) + node.count[i] > objectCount)
+                    return false;
+            }
+            else if (node.index[i] == 0)
+            {
+                // unused slot; must never be entered
+                if (!(node.bmin[X][i] > node.bmax[X][i]))
+                    return false;
+            }
+            else
+            {
+                if ((node.index[i] <= n) || (node.index[i] >= nodeCount) ||
+                    (level[n] >= MAX_BVH_TREE_LEVEL) || (level[node.index[i]] != 0))
+                    return false;
+                level[node.index[i]] = level[n] + 1;
+            }
+        }
+    }
+
+    for (unsigned int i = 0; i < objectCount; i++)
+    {
+        if (objectList[i] >= objectCount)
+            return false;
+    }
+
+    pNodes = nodeArray;
+    numNodes = nodeCount;
+    pLists = objectList;
+    numObjects = objectCount;
+    return true;
+}
+
+unsigned int BVHTree::BuildRecursive(const Progress& progress, const BuildRange& range, unsigned int level)
+{
+    BuildRange children[kWidth];
+    unsigned int numChildren = 1;
+    unsigned int inode = (unsigned int) nodes.size();
+
+    nodes.push_back(Node());
+
+    if ((nodes.size() - lastProgressNodeCounter) > NODE_PROGRESS_INTERVAL)
+    {
+        progress((unsigned int) nodes.size());
+        lastProgressNodeCounter = (unsigned int) nodes.size();
+    }
+
+    // Collapse what would be several levels of a binary tree into a single node,
+    // by repeatedly splitting the child with the largest surface area.
+    children[0] = range;
+    while (numChildren < kWidth)
+    {
+        unsigned int best = kWidth;
+        float bestArea = -1.0f;
+
+        for (unsigned int i = 0; i < numChildren; i++)
+        {
+            if (children[i].splittable && (children[i].end - children[i].begin > 1) && (HalfArea(children[i].bbox) > bestArea))
+            {
+                best = i;
+                bestArea = HalfArea(children[i].bbox);
+            }
+        }
+
+        if (best == kWidth)
+            break;
+
+        if (SplitRange(children[best], children[best], children[numChildren]))
+            numChildren++;
+        else
+            children[best].splittable = false;
+    }
+
+    // NB: We must not hold a reference into the nodes array across recursive calls,
+    // as these may cause the array to be re-allocated.
+    for (unsigned int i = 0; i < kWidth; i++)
+    {
+        if (i >= numChildren)
+        {
+            // unused slot; inverted bounds make sure it is never hit
+            for (int dim = X; dim <= Z; ++dim)
+            {
+                nodes[inode].bmin[dim][i] =  BOUND_HUGE;
+                nodes[inode].bmax[dim][i] = -BOUND_HUGE;
+            }
+            nodes[inode].index[i] = 0;
+            nodes[inode].count[i] = 0;
+            continue;
+        }
+
+        const BuildRange& child = children[i];
+        unsigned int count = child.end - child.begin;
+
+        for (int dim = X; dim <= Z; ++dim)
+        {
+            nodes[inode].bmin[dim][i] = child.bbox.pmin[dim];
+            nodes[inode].bmax[dim][i] = child.bbox.pmax[dim];
+        }
+
+        if ((count <= BVH_MAX_LEAF_OBJECTS) || !child.splittable || (level >= MAX_BVH_TREE_LEVEL))
+        {
+            nodes[inode].index[i] = child.begin;
+            nodes[inode].count[i] = count;
+
+            leafCounter++;
+            treeDepthCounter += level;
+            maxObjectsInLeaf = max(maxObjectsInLeaf, count);
+            maxTreeDepth = max(maxTreeDepth, level);
+        }
+        else
+        {
+            unsigned int ichild = BuildRecursive(progress, child, level + 1);
+            nodes[inode].index[i] = ichild;
+            nodes[inode].count[i] = 0;
+        }
+    }
+
+    return inode;
+}
+
+bool BVHTree::SplitRange(const BuildRange& range, BuildRange& left, BuildRange& right)
+{
+    unsigned int count = range.end - range.begin;
+    unsigned int mid = range.begin;
+    BBoxVector3d cmin(BOUND_HUGE);
+    BBoxVector3d cmax(-BOUND_HUGE);
+    bool found = false;
+
+    if (count < 2)
+        return false;
+
+    // bin objects along the axis of largest centroid extent
+    for (unsigned int i = range.begin; i < range.end; i++)
+    {
+        cmin = min(cmin, centroids[lists[i]]);
+        cmax = max(cmax, centroids[lists[i]]);
+    }
+
+    BBoxVector3d extent = cmax - cmin;
+    unsigned int axis = ((extent[X] > extent[Y]) ? ((extent[X] > extent[Z]) ? X : Z) : ((extent[Y] > extent[Z]) ? Y : Z));
+
+    if (extent[axis] > 0.0f)
+    {
+        MinMaxBoundingBox binBounds[BVH_SAH_BINS];
+        unsigned int binCount[BVH_SAH_BINS];
+        float rightArea[BVH_SAH_BINS];
+        unsigned int rightCount[BVH_SAH_BINS];
+        MinMaxBoundingBox accum;
+        unsigned int accumCount;
+        const float binScale = float(BVH_SAH_BINS) / extent[axis];
+        const float binMin = cmin[axis];
+        auto binOf = [&](unsigned int obj) { return min((unsigned int)((centroids[obj][axis] - binMin) * binScale), (unsigned int)(BVH_SAH_BINS - 1)); };
+
+        for (unsigned int b = 0; b < BVH_SAH_BINS; b++)
+        {
+            MakeEmpty(binBounds[b]);
+            binCount[b] = 0;
+        }
+
+        for (unsigned int i = range.begin; i < range.end; i++)
+        {
+            unsigned int b = binOf(lists[i]);
+            Extend(binBounds[b], objectBounds[lists[i]]);
+            binCount[b]++;
+        }
+
+        // sweep from the right to get the cost of the right-hand side for each split position
+        MakeEmpty(accum);
+        accumCount = 0;
+        for (unsigned int b = BVH_SAH_BINS - 1; b > 0; b--)
+        {
+            Extend(accum, binBounds[b]);
+            accumCount += binCount[b];
+            rightArea[b - 1] = HalfArea(accum);
+            rightCount[b - 1] = accumCount;
+        }
+
+        // sweep from the left to find the cheapest split position
+        float bestCost = 0.0f;
+        unsigned int bestBin = 0;
+        MakeEmpty(accum);
+        accumCount = 0;
+        for (unsigned int b = 0; b < BVH_SAH_BINS - 1; b++)
+        {
+            Extend(accum, binBounds[b]);
+            accumCount += binCount[b];
+            if ((accumCount == 0) || (rightCount[b] == 0))
+                continue;
+            float cost = HalfArea(accum) * float(accumCount) + rightArea[b] * float(rightCount[b]);
+            if (!found || (cost < bestCost))
+            {
+                bestCost = cost;
+                bestBin = b;
+                found = true;
+            }
+        }
+
+        if (found)
+        {
+            // for small ranges, only split if the SAH predicts a benefit over a leaf
+            float area = HalfArea(range.bbox);
+            float splitCost = BVH_TRAVERSAL_COST * area + BVH_OBJECT_ISECT_COST * bestCost;
+            float leafCost = BVH_OBJECT_ISECT_COST * area * float(count);
+            if ((count <= BVH_MAX_LEAF_OBJECTS) && (splitCost >= leafCost))
+                return false;
+
+            mid = (unsigned int)(std::partition(lists.begin() + range.begin, lists.begin() + range.end,
+                                                [&](unsigned int obj) { return binOf(obj) <= bestBin; }) - lists.begin());
+        }
+    }
+
+    if (!found)
+    {
+        // all centroids coincide; small ranges go into a leaf, larger ones are split in the middle
+        if (count <= BVH_MAX_LEAF_OBJECTS)
+            return false;
+        mid = range.begin + count / 2;
+    }
+
+    // NB: `left` or `right` may alias `range`, so we must copy what we need first.
+    unsigned int begin = range.begin;
+    unsigned int end = range.end;
+
+    left.begin = begin;
+    left.end = mid;
+    left.splittable = true;
+    ComputeBounds(left);
+
+    right.begin = mid;
+    right.end = end;
+    right.splittable = true;
+    ComputeBounds(right);
+
+    return true;
+}
+
+void BVHTree::ComputeBounds(BuildRange& range) const
+{
+    MakeEmpty(range.bbox);
+    for (unsigned int i = range.begin; i < range.end; i++)
+        Extend(range.bbox, objectBounds[lists[i]]);
+}
+
+}
+// end of namespace pov
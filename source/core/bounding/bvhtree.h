@@ -0,0 +1,216 @@
+//******************************************************************************
+///
+/// @file core/bounding/bvhtree.h
+///
+/// Declarations related to the wide bounding volume hierarchy.
+///
+/// @copyright
+/// @parblock
+///
+/// Persistence of Vision Ray Tracer ('POV-Ray') version 3.8.
+/// Copyright 1991-2019 Persistence of Vision Raytracer Pty. Ltd.
+///
+/// POV-Ray is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Affero General Public License as
+/// published by the Free Software Foundation, either version 3 of the
+/// License, or (at your option) any later version.
+///
+/// POV-Ray is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU Affero General Public License for more details.
+///
+/// You should have received a copy of the GNU Affero General Public License
+/// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// ----------------------------------------------------------------------------
+///
+/// POV-Ray is based on the popular DKB raytracer version 2.12.
+/// DKBTrace was originally written by David K. Buck.
+/// DKBTrace Ver 2.0-2.12 were written by David K. Buck & Aaron A. Collins.
+///
+/// @endparblock
+///
+//******************************************************************************
+
+#ifndef POVRAY_CORE_BVHTREE_H
+#define POVRAY_CORE_BVHTREE_H
+
+// Module config header file must be the first file included within POV-Ray unit header files
+#include "core/configcore.h"
+
+// C++ variants of C standard header files
+//  (none at the moment)
+
+// C++ standard header files
+#include <cstddef>
+#include <vector>
+
+// POV-Ray header files (base module)
+//  (none at the moment)
+
+// POV-Ray header files (core module)
+#include "core/bounding/boundingbox.h"
+#include "core/bounding/bsptree.h"
+
+namespace pov
+{
+
+//##############################################################################
+///
+/// @defgroup PovCoreSupportBVHTree Wide Bounding Volume Hierarchy
+/// @ingroup PovCore
+///
+/// @{
+
+/// Flattened wide bounding volume hierarchy.
+///
+/// This is an alternative to both the bounding slabs and the @ref BSPTree, selected via
+/// `Bounding_Method=3`. The tree is built top-down using the surface area heuristic (SAH)
+/// over binned object centroids, and collapsed so that each node holds up to
+/// @ref POV_BVH_NODE_WIDTH children.
+///
+/// Nodes are stored in a single linear array, with the child bounding boxes of each node
+/// kept in structure-of-arrays layout, so that a ray can be tested against all children of
+/// a node at once, using SIMD instructions where the compiler supports them. Traversal is
+/// ordered front-to-back using an explicit stack rather than a priority queue.
+///
+/// To allow for re-use of the intersection and inside test functors, the interface mimics
+/// that of @ref BSPTree, except that no mailbox is needed since each object is referenced
+/// by exactly one leaf.
+///
+class BVHTree final
+{
+    public:
+
+        typedef BSPTree::Objects    Objects;
+        typedef BSPTree::Intersect  Intersect;
+        typedef BSPTree::Inside     Inside;
+        typedef BSPTree::Progress   Progress;
+
+        /// Intersection test for entire leaves rather than individual objects.
+        ///
+        /// Leaves are identified by a range of positions in @ref GetObjectList(), allowing
+        /// users to keep per-object data in arrays ordered the same way as the leaves.
+        ///
+        class IntersectLeaf
+        {
+            public:
+                IntersectLeaf() { }
+                virtual ~IntersectLeaf() { }
+
+                virtual bool operator()(unsigned int first, unsigned int count, double& maxdist) = 0;
+                virtual bool operator()() const = 0;
+        };
+
+        BVHTree();
+        ~BVHTree();
+
+        bool operator()(const BasicRay& ray, Intersect& isect, double maxdist) const;
+        bool operator()(const BasicRay& ray, IntersectLeaf& isect, double maxdist) const;
+        bool operator()(const Vector3d& origin, Inside& inside, bool earlyExit = false) const;
+
+        void build(const Progress& progress, const Objects& objects,
+                   unsigned int& nodes, unsigned int& leafNodes, unsigned int& maxObjects, float& averageObjects,
+                   unsigned int& maxDepth, float& averageDepth);
+
+        void clear();
+
+        /// Use a previously built tree stored elsewhere, rather than building one.
+        ///
+        /// The data is used in-place, and must remain valid for the lifetime of the tree (or until
+        /// @ref clear() is called). It must have been obtained via @ref GetNodeData() and
+        /// @ref GetObjectList() from a tree built with the same @ref GetNodeWidth(); since it may
+        /// originate from a file, it is checked for consistency first.
+        ///
+        /// @param[in]  nodeData        Raw node data.
+        /// @param[in]  nodeDataSize    Size of the raw node data, in bytes.
+        /// @param[in]  objectList      Object indices, in the order in which they are referenced by the leaves.
+        /// @param[in]  objectCount     Number of objects in the tree.
+        /// @return                     `true` if the data was found to be consistent and is now used by the tree.
+        ///
+        bool Attach(const void *nodeData, std::size_t nodeDataSize, const unsigned int *objectList, unsigned int objectCount);
+
+        /// Get the raw node data, suitable for @ref Attach().
+        const void *GetNodeData() const { return pNodes; }
+
+        /// Get the size of the raw node data, in bytes.
+        std::size_t GetNodeDataSize() const { return numNodes * sizeof(Node); }
+
+        /// Get the number of children per node.
+        static unsigned int GetNodeWidth() { return kWidth; }
+
+        /// Get the number of objects referenced by the leaves.
+        unsigned int GetObjectCount() const { return numObjects; }
+
+        /// Get the indices of all objects, in the order in which they are referenced by the leaves.
+        const unsigned int *GetObjectList() const { return pLists; }
+
+    private:
+
+        static const unsigned int kWidth = POV_BVH_NODE_WIDTH;
+
+        struct Node final
+        {
+            /// Per-child lower bounds, indexed by axis first.
+            float bmin[3][kWidth];
+            /// Per-child upper bounds, indexed by axis first.
+            float bmax[3][kWidth];
+            /// Per-child index of the child node (inner children), or first entry in the object list (leaves).
+            unsigned int index[kWidth];
+            /// Per-child number of objects (leaves), or zero (inner children and unused slots).
+            unsigned int count[kWidth];
+        };
+
+        /// Build-time representation of a (not yet finalized) child.
+        struct BuildRange final
+        {
+            unsigned int begin;
+            unsigned int end;
+            MinMaxBoundingBox bbox;
+            bool splittable;
+        };
+
+        /// array of all nodes built; the root is always at index 0
+        std::vector<Node> nodes;
+        /// array of all object indices referenced by leaves, as built
+        std::vector<unsigned int> lists;
+        /// nodes in use, either built or attached
+        const Node *pNodes;
+        /// number of nodes in use
+        std::size_t numNodes;
+        /// object indices in use, either built or attached
+        const unsigned int *pLists;
+        /// number of object indices in use
+        unsigned int numObjects;
+        /// object bounds, only used while building tree
+        std::vector<MinMaxBoundingBox> objectBounds;
+        /// object centroids, only used while building tree
+        std::vector<BBoxVector3d> centroids;
+        /// last node progress counter
+        unsigned int lastProgressNodeCounter;
+        /// maximum objects in leaf
+        unsigned int maxObjectsInLeaf;
+        /// maximum tree depth
+        unsigned int maxTreeDepth;
+        /// leaf counter
+        unsigned int leafCounter;
+        /// tree depth counter
+        POV_LONG treeDepthCounter;
+
+        template<typename LEAF_FUNCTOR>
+        void Traverse(const BasicRay& ray, double& maxdist, LEAF_FUNCTOR leaf) const;
+
+        unsigned int BuildRecursive(const Progress& progress, const BuildRange& range, unsigned int level);
+        bool SplitRange(const BuildRange& range, BuildRange& left, BuildRange& right);
+        void ComputeBounds(BuildRange& range) const;
+};
+
+/// @}
+///
+//##############################################################################
+
+}
+// end of namespace pov
+
+#endif // POVRAY_CORE_BVHTREE_H
@@ -128,6 +128,70 @@
     #define MAX_TRACE_LEVEL_LIMIT 256
 #endif
 
+/// @def POV_BVH_NODE_WIDTH
+/// Number of children per node of the wide bounding volume hierarchy (`Bounding_Method=3`).
+///
+/// Should match the number of single-precision floats per SIMD register: 4 for SSE, 8 for AVX.
+///
+#ifndef POV_BVH_NODE_WIDTH
+    #define POV_BVH_NODE_WIDTH 4
+#endif
+
+/// @def POV_BSP_BUILD_MAX_THREADS
+/// Maximum number of threads used to build the BSP tree (`Bounding_Method=2`).
+///
+/// The actual number is also limited by the number of render threads (`Work_Threads`). Set to 1 to
+/// build the tree on a single thread.
+///
+#ifndef POV_BSP_BUILD_MAX_THREADS
+    #define POV_BSP_BUILD_MAX_THREADS 16
+#endif
+
+/// @def POV_BSP_BUILD_PARALLEL_THRESHOLD
+/// Minimum number of objects in a BSP tree node to make building it in parallel worthwhile.
+///
+#ifndef POV_BSP_BUILD_PARALLEL_THRESHOLD
+    #define POV_BSP_BUILD_PARALLEL_THRESHOLD 4096
+#endif
+
+/// @def POV_MESH_TRIANGLE_BLOCK_SIZE
+/// Number of mesh triangles tested against a ray at once.
+///
+/// The test is done in double precision, so this should match the number of doubles per SIMD
+/// register: 2 for SSE, 4 for AVX. Larger values also work, but waste effort on small leaves.
+///
+#ifndef POV_MESH_TRIANGLE_BLOCK_SIZE
+    #define POV_MESH_TRIANGLE_BLOCK_SIZE 4
+#endif
+
+/// @def POV_PHOTON_BUILD_MAX_THREADS
+/// Maximum number of threads used to sort a photon map into a kd-tree.
+///
+/// The actual number is also limited by the number of render threads (`Work_Threads`). Set to 1 to
+/// sort photon maps on a single thread.
+///
+#ifndef POV_PHOTON_BUILD_MAX_THREADS
+    #define POV_PHOTON_BUILD_MAX_THREADS 16
+#endif
+
+/// @def POV_PHOTON_BUILD_PARALLEL_THRESHOLD
+/// Minimum number of photons in a kd-tree subrange to make sorting it on a separate thread worthwhile.
+///
+#ifndef POV_PHOTON_BUILD_PARALLEL_THRESHOLD
+    #define POV_PHOTON_BUILD_PARALLEL_THRESHOLD 65536
+#endif
+
+/// @def POV_PHOTON_GATHER_BLOCK_SIZE
+/// Size of photon kd-tree subranges that are tested against the gather radius in one go
+/// rather than traversed.
+///
+/// The distances are computed in double precision, so this should be a multiple of the number of
+/// doubles per SIMD register.
+///
+#ifndef POV_PHOTON_GATHER_BLOCK_SIZE
+    #define POV_PHOTON_GATHER_BLOCK_SIZE 8
+#endif
+
 //******************************************************************************
 ///
 /// @name Various Numerical Constants
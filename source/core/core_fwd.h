@@ -60,6 +60,8 @@ class PhotonShootingUnit;
 
 class SceneData;
 
+class SubsurfaceCacheBuilder;
+
 class TraceThreadData;
 
 }
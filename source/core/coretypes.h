@@ -138,6 +138,8 @@ typedef TEXTURE* TexturePtr;
 ///
 /// @{
 
+class MediaDensityGrid;
+
 class Media final
 {
     public:
@@ -170,6 +172,11 @@ class Media final
 
         std::vector<PIGMENT*> Density;
 
+        /// Resolution of the cached density grid along the longest axis, or 0 to always evaluate the density pigments.
+        int Density_Grid_Resolution;
+        /// Cached density grid, if any.
+        std::shared_ptr<MediaDensityGrid> densityGrid;
+
         Media();
         Media(const Media&);
         ~Media();
@@ -179,6 +186,12 @@ class Media final
         void Transform(const TRANSFORM *trans);
 
         void PostProcess();
+
+        /// Set up the cached density grid (if enabled) to cover a given region.
+        ///
+        /// @note   If a grid has already been set up, the region is enlarged to cover the previous one as well.
+        ///
+        void PrepareDensityGrid(const Vector3d& lo, const Vector3d& hi);
 };
 
 /// @}
@@ -208,6 +221,9 @@ class Interior final
         void Transform(const TRANSFORM *trans);
 
         void PostProcess();
+
+        /// Set up the cached density grids of the media to cover a given region.
+        void PrepareDensityGrids(const Vector3d& lo, const Vector3d& hi);
     private:
 
         Interior& operator=(const Interior&) = delete;
@@ -658,6 +674,24 @@ public:
     virtual void InitArguments(GenericFunctionContextPtr pContext) = 0;
     virtual void PushArgument(GenericFunctionContextPtr pContext, ARG_T arg) = 0;
     virtual RETURN_T Execute(GenericFunctionContextPtr pContext) = 0;
+
+    /// Evaluate the function for a batch of argument tuples.
+    ///
+    /// The arguments are passed in structure-of-arrays layout: `args[k][i]` is the k-th argument
+    /// of the i-th evaluation. The default implementation simply evaluates one tuple at a time;
+    /// implementations should override it if they can amortize per-call setup across the batch.
+    ///
+    virtual void ExecuteBatch(GenericFunctionContextPtr pContext, const ARG_T* const* args, unsigned int argc, RETURN_T* results, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            InitArguments(pContext);
+            for (unsigned int k = 0; k < argc; ++k)
+                PushArgument(pContext, args[k][i]);
+            results[i] = Execute(pContext);
+        }
+    }
+
     virtual GenericCustomFunction* Clone() const = 0;
     virtual const CustomFunctionSourceInfo* GetSourceInfo() const { return nullptr; }
 };
@@ -732,6 +766,20 @@ public:
         return Evaluate(argV.x(), argV.y(), argV.z());
     }
 
+    inline void EvaluateBatch(const ARG_T* argU, const ARG_T* argV, RETURN_T* results, size_t count)
+    {
+        const ARG_T* args[2] = { argU, argV };
+        mpFunction->ExecuteBatch(mpContext, args, 2, results, count);
+        mReInit = true;
+    }
+
+    inline void EvaluateBatch(const ARG_T* argX, const ARG_T* argY, const ARG_T* argZ, RETURN_T* results, size_t count)
+    {
+        const ARG_T* args[3] = { argX, argY, argZ };
+        mpFunction->ExecuteBatch(mpContext, args, 3, results, count);
+        mReInit = true;
+    }
+
 protected:
     GenericCustomFunction<RETURN_T,ARG_T>*  mpFunction;
     GenericFunctionContextPtr               mpContext;
@@ -383,6 +383,7 @@ LightSource::LightSource() : CompoundObject(LIGHT_OBJECT)
     Jitter     = false;
     Orient     = false;
     Circular   = false;
+    Low_Discrepancy = false;
     Parallel   = false;
     Photon_Area_Light = false;
 
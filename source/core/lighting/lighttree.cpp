@@ -0,0 +1,293 @@
+//******************************************************************************
+///
+/// @file core/lighting/lighttree.cpp
+///
+/// Implementations related to the light tree used for sampling many light sources.
+///
+/// @copyright
+/// @parblock
+///
+/// Persistence of Vision Ray Tracer ('POV-Ray') version 3.8.
+/// Copyright 1991-2019 Persistence of Vision Raytracer Pty. Ltd.
+///
+/// POV-Ray is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Affero General Public License as
+/// published by the Free Software Foundation, either version 3 of the
+/// License, or (at your option) any later version.
+///
+/// POV-Ray is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU Affero General Public License for more details.
+///
+/// You should have received a copy of the GNU Affero General Public License
+/// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// ----------------------------------------------------------------------------
+///
+/// POV-Ray is based on the popular DKB raytracer version 2.12.
+/// DKBTrace was originally written by David K. Buck.
+/// DKBTrace Ver 2.0-2.12 were written by David K. Buck & Aaron A. Collins.
+///
+/// @endparblock
+///
+//******************************************************************************
+
+// Unit header file must be the first file included within POV-Ray *.cpp files (pulls in config)
+#include "core/lighting/lighttree.h"
+
+// C++ variants of C standard header files
+#include <cmath>
+
+// C++ standard header files
+#include <algorithm>
+
+// POV-Ray header files (base module)
+//  (none at the moment)
+
+// POV-Ray header files (core module)
+#include "core/lighting/lightsource.h"
+#include "core/scene/object.h"
+
+// this must be the last file included
+#include "base/povdebug.h"
+
+namespace pov
+{
+
+using std::min;
+using std::max;
+using std::vector;
+
+LightTree::LightTree(const vector<LightSource*>& lights) :
+    mTreeLights(0)
+{
+    vector<Node> leaves;
+    leaves.reserve(lights.size());
+
+    for (vector<LightSource*>::const_iterator i = lights.begin(); i != lights.end(); ++i)
+    {
+        const LightSource& light = **i;
+        Node leaf;
+
+        leaf.intensity = 0.0f;
+        for (int channel = 0; channel < MathColour::channels; channel++)
+            leaf.intensity = max(leaf.intensity, float(fabs(light.colour[channel])));
+
+        if (light.Parallel || (leaf.intensity <= 0.0f) ||
+            ((light.Light_Type != POINT_SOURCE) && (light.Light_Type != SPOT_SOURCE) && (light.Light_Type != FILL_LIGHT_SOURCE)))
+        {
+            mOtherLights.push_back(light.index);
+            continue;
+        }
+
+        Vector3d extent(0.0);
+        if (light.Area_Light)
+        {
+            for (int axis = X; axis <= Z; axis++)
+                extent[axis] = 0.5 * (fabs(light.Axis1[axis]) + fabs(light.Axis2[axis]));
+        }
+        leaf.lo = light.Center - extent;
+        leaf.hi = light.Center + extent;
+
+        if (light.Fade_Power > 0.0)
+        {
+            leaf.fadeDistance = float(fabs(light.Fade_Distance));
+            leaf.fadePower    = float(light.Fade_Power);
+        }
+        else
+        {
+            leaf.fadeDistance = 0.0f;
+            leaf.fadePower    = 0.0f;
+        }
+
+        // with full area lighting, parts of an area light behind the surface may still contribute
+        leaf.oneSided = !(light.Area_Light && light.Use_Full_Area_Lighting);
+        leaf.child    = -1;
+        leaf.light    = light.index;
+
+        leaves.push_back(leaf);
+    }
+
+    mTreeLights = leaves.size();
+    if (leaves.empty())
+        return;
+
+    mNodes.reserve(2 * leaves.size() - 1);
+    mNodes.resize(1);
+    Build(leaves, 0, leaves.size(), 0);
+}
+
+void LightTree::Build(vector<Node>& leaves, size_t first, size_t last, size_t index)
+{
+    if (last - first == 1)
+    {
+        mNodes[index] = leaves[first];
+        return;
+    }
+
+    // split at the median of the longest axis of the light sources' centres
+    Vector3d lo(leaves[first].lo + leaves[first].hi);
+    Vector3d hi(lo);
+    for (size_t i = first + 1; i < last; i++)
+    {
+        Vector3d centre(leaves[i].lo + leaves[i].hi);
+        for (int axis = X; axis <= Z; axis++)
+        {
+            lo[axis] = min(lo[axis], centre[axis]);
+            hi[axis] = max(hi[axis], centre[axis]);
+        }
+    }
+    Vector3d size = hi - lo;
+    int axis = (size[X] > size[Y]) ? ((size[X] > size[Z]) ? X : Z) : ((size[Y] > size[Z]) ? Y : Z);
+
+    size_t middle = first + (last - first) / 2;
+    std::nth_element(leaves.begin() + first, leaves.begin() + middle, leaves.begin() + last,
+                     [axis](const Node& a, const Node& b) { return (a.lo[axis] + a.hi[axis]) < (b.lo[axis] + b.hi[axis]); });
+
+    int child = int(mNodes.size());
+    mNodes.resize(mNodes.size() + 2);
+    Build(leaves, first, middle, child);
+    Build(leaves, middle, last, child + 1);
+
+    const Node& a = mNodes[child];
+    const Node& b = mNodes[child + 1];
+    Node& node = mNodes[index];
+    for (int i = X; i <= Z; i++)
+    {
+        node.lo[i] = min(a.lo[i], b.lo[i]);
+        node.hi[i] = max(a.hi[i], b.hi[i]);
+    }
+    node.intensity    = a.intensity + b.intensity;
+    node.fadeDistance = max(a.fadeDistance, b.fadeDistance);
+    node.fadePower    = min(a.fadePower, b.fadePower);
+    node.oneSided     = a.oneSided && b.oneSided;
+    node.child        = child;
+    node.light        = 0;
+}
+
+double LightTree::Fade(const Node& node, double distance)
+{
+    if (node.fadePower <= 0.0f)
+        return 1.0;
+    if (node.fadeDistance >= EPSILON)
+        return 2.0 / (1.0 + pow(distance / node.fadeDistance, node.fadePower));
+    return pow(max(distance, EPSILON), -node.fadePower);
+}
+
+double LightTree::CosineBound(const Node& node, const Vector3d& point, const Vector3d& normal)
+{
+    Vector3d toCentre = (node.lo + node.hi) * 0.5 - point;
+    double radius = (node.hi - node.lo).length() * 0.5;
+    double distance = toCentre.length();
+    if (distance <= radius)
+        return 1.0;
+
+    // widen the angle to the centre by the half-angle subtended by the bounding sphere
+    double cosTheta = dot(normal, toCentre) / distance;
+    double sinSpread = radius / distance;
+    double cosSpread = sqrt(1.0 - Sqr(sinSpread));
+    if (cosTheta >= cosSpread)
+        return 1.0;
+    double sinTheta = sqrt(max(0.0, 1.0 - Sqr(cosTheta)));
+    return max(0.0, cosTheta * cosSpread + sinTheta * sinSpread);
+}
+
+double LightTree::ImportanceBound(const Node& node, const Vector3d& point, const Vector3d& normal, bool twoSided) const
+{
+    double distanceSqr = 0.0;
+    for (int axis = X; axis <= Z; axis++)
+    {
+        if (point[axis] < node.lo[axis])
+            distanceSqr += Sqr(node.lo[axis] - point[axis]);
+        else if (point[axis] > node.hi[axis])
+            distanceSqr += Sqr(point[axis] - node.hi[axis]);
+    }
+
+    double importance = node.intensity * Fade(node, sqrt(distanceSqr));
+    if (!twoSided && node.oneSided)
+        importance *= CosineBound(node, point, normal);
+    return importance;
+}
+
+double LightTree::ImportanceEstimate(const Node& node, const Vector3d& point, const Vector3d& normal, bool twoSided) const
+{
+    // keep the distance from dropping below the node's radius, to avoid favouring nearby nodes excessively
+    double distance = max(((node.lo + node.hi) * 0.5 - point).length(), (node.hi - node.lo).length() * 0.5);
+
+    double importance = node.intensity * Fade(node, distance);
+    if (!twoSided && node.oneSided)
+        importance *= CosineBound(node, point, normal);
+    return importance;
+}
+
+void LightTree::SelectLights(const Vector3d& point, const Vector3d& normal, bool twoSided, unsigned int budget,
+                             RandomDoubleSequence::Generator& rng, SelectionVector& selection) const
+{
+    selection.clear();
+    if (mNodes.empty() || (budget == 0))
+        return;
+
+    // Find a cut through the tree, splitting the nodes that could contribute most until the budget is exhausted.
+    // The entries temporarily hold node indices and importance bounds, and are kept in a max-heap of the bounds,
+    // with leaves ranking below all nodes that can still be split.
+    auto splitPriority = [this](const Selection& s) { return (mNodes[s.light].child >= 0) ? s.weight : -1.0; };
+    auto lowerPriority = [&splitPriority](const Selection& a, const Selection& b) { return splitPriority(a) < splitPriority(b); };
+
+    selection.push_back(Selection{ 0, ImportanceBound(mNodes[0], point, normal, twoSided) });
+    while ((selection.size() < budget) && (splitPriority(selection.front()) > 0.0))
+    {
+        std::pop_heap(selection.begin(), selection.end(), lowerPriority);
+        size_t child = size_t(mNodes[selection.back().light].child);
+        selection.back() = Selection{ child, ImportanceBound(mNodes[child], point, normal, twoSided) };
+        std::push_heap(selection.begin(), selection.end(), lowerPriority);
+        selection.push_back(Selection{ child + 1, ImportanceBound(mNodes[child + 1], point, normal, twoSided) });
+        std::push_heap(selection.begin(), selection.end(), lowerPriority);
+    }
+
+    // Pick one light source from each node of the cut, descending the tree at random.
+    size_t count = 0;
+    for (size_t i = 0; i < selection.size(); i++)
+    {
+        if (selection[i].weight <= 0.0)
+            continue;
+
+        const Node* node = &mNodes[selection[i].light];
+        double probability = 1.0;
+        double u = rng();
+        while ((node->child >= 0) && (probability > 0.0))
+        {
+            const Node& left  = mNodes[node->child];
+            const Node& right = mNodes[node->child + 1];
+            double importanceLeft  = ImportanceEstimate(left,  point, normal, twoSided);
+            double importanceRight = ImportanceEstimate(right, point, normal, twoSided);
+            if (importanceLeft + importanceRight <= 0.0)
+            {
+                probability = 0.0;
+                break;
+            }
+
+            // re-use the random number for the next level
+            double probabilityLeft = importanceLeft / (importanceLeft + importanceRight);
+            if (u < probabilityLeft)
+            {
+                u = u / probabilityLeft;
+                probability *= probabilityLeft;
+                node = &left;
+            }
+            else
+            {
+                u = min((u - probabilityLeft) / (1.0 - probabilityLeft), 1.0 - EPSILON);
+                probability *= 1.0 - probabilityLeft;
+                node = &right;
+            }
+        }
+
+        if (probability > 0.0)
+            selection[count++] = Selection{ node->light, 1.0 / probability };
+    }
+    selection.resize(count);
+}
+
+}
+// end of namespace pov
@@ -0,0 +1,150 @@
+//******************************************************************************
+///
+/// @file core/lighting/lighttree.h
+///
+/// Declarations related to the light tree used for sampling many light sources.
+///
+/// @copyright
+/// @parblock
+///
+/// Persistence of Vision Ray Tracer ('POV-Ray') version 3.8.
+/// Copyright 1991-2019 Persistence of Vision Raytracer Pty. Ltd.
+///
+/// POV-Ray is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Affero General Public License as
+/// published by the Free Software Foundation, either version 3 of the
+/// License, or (at your option) any later version.
+///
+/// POV-Ray is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU Affero General Public License for more details.
+///
+/// You should have received a copy of the GNU Affero General Public License
+/// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// ----------------------------------------------------------------------------
+///
+/// POV-Ray is based on the popular DKB raytracer version 2.12.
+/// DKBTrace was originally written by David K. Buck.
+/// DKBTrace Ver 2.0-2.12 were written by David K. Buck & Aaron A. Collins.
+///
+/// @endparblock
+///
+//******************************************************************************
+
+#ifndef POVRAY_CORE_LIGHTTREE_H
+#define POVRAY_CORE_LIGHTTREE_H
+
+// Module config header file must be the first file included within POV-Ray unit header files
+#include "core/configcore.h"
+
+// C++ variants of C standard header files
+//  (none at the moment)
+
+// C++ standard header files
+#include <vector>
+
+// POV-Ray header files (base module)
+//  (none at the moment)
+
+// POV-Ray header files (core module)
+#include "core/coretypes.h"
+#include "core/math/randomsequence.h"
+
+namespace pov
+{
+
+//##############################################################################
+///
+/// @addtogroup PovCoreLightingLightsource
+///
+/// @{
+
+/// Bounding hierarchy over the global light sources of a scene, for scenes with too many light sources to test them
+/// all at every shading point.
+///
+/// Each node of the tree holds the bounding box of its light sources' positions, their total intensity and a
+/// conservative approximation of their distance fading. For a given shading point, the tree is split into a cut of
+/// a limited number of clusters, refining the clusters that could contribute most first; from each cluster, a single
+/// light source is then picked at random, with a probability proportional to an estimate of its contribution, as
+/// proposed by Conty Estevez and Kulla in their 2018 paper "Importance Sampling of Many Lights with Adaptive Tree
+/// Splitting". Scaling each light source's contribution by the reciprocal of its probability, the expected result is
+/// the sum over all light sources, and as the cut grows to include every light source, the result becomes exact.
+///
+/// Only point, spot and shadowless light sources that are not parallel are placed in the tree; any others are to be
+/// tested at every shading point.
+///
+class LightTree final
+{
+    public:
+
+        /// A light source picked for a shading point.
+        struct Selection final
+        {
+            size_t  light;      ///< Index of the light source among the global light sources.
+            double  weight;     ///< Factor to scale the light source's contribution by.
+        };
+        typedef std::vector<Selection> SelectionVector;
+
+        LightTree(const std::vector<LightSource*>& lights);
+
+        /// Get the number of light sources placed in the tree.
+        size_t GetTreeLightCount() const { return mTreeLights; }
+
+        /// Get the indices of the light sources not placed in the tree.
+        const std::vector<size_t>& GetOtherLights() const { return mOtherLights; }
+
+        /// Pick light sources from the tree for a given shading point.
+        ///
+        /// @param[in]      point       The shading point.
+        /// @param[in]      normal      The surface normal at the shading point.
+        /// @param[in]      twoSided    Whether light sources behind the surface may contribute.
+        /// @param[in]      budget      Maximum number of light sources to pick.
+        /// @param[in]      rng         Generator of uniform random numbers in the range [0, 1).
+        /// @param[out]     selection   The light sources picked.
+        ///
+        void SelectLights(const Vector3d& point, const Vector3d& normal, bool twoSided, unsigned int budget,
+                          RandomDoubleSequence::Generator& rng, SelectionVector& selection) const;
+
+    private:
+
+        struct Node final
+        {
+            Vector3d    lo, hi;         ///< Bounding box of the light sources' positions.
+            float       intensity;      ///< Total intensity of the light sources.
+            float       fadeDistance;   ///< Largest fade distance of the light sources.
+            float       fadePower;      ///< Smallest fade power of the light sources, or 0 if any of them does not fade.
+            bool        oneSided;       ///< Whether light sources behind a surface can safely be ignored.
+            int         child;          ///< Index of the first of the two child nodes, or -1 for leaf nodes.
+            size_t      light;          ///< Index of the light source, for leaf nodes.
+        };
+
+        std::vector<Node>   mNodes;
+        std::vector<size_t> mOtherLights;
+        size_t              mTreeLights;
+
+        /// Set up a node over a range of leaf nodes, recursively setting up its children.
+        void Build(std::vector<Node>& leaves, size_t first, size_t last, size_t index);
+
+        /// Compute an upper bound of the contribution of a node's light sources.
+        double ImportanceBound(const Node& node, const Vector3d& point, const Vector3d& normal, bool twoSided) const;
+
+        /// Estimate the contribution of a node's light sources.
+        double ImportanceEstimate(const Node& node, const Vector3d& point, const Vector3d& normal, bool twoSided) const;
+
+        /// Compute an upper bound of the cosine of the angle between the normal and the direction to a node.
+        static double CosineBound(const Node& node, const Vector3d& point, const Vector3d& normal);
+
+        /// Compute the distance fading of a node's light sources.
+        static double Fade(const Node& node, double distance);
+};
+
+/// @}
+///
+//##############################################################################
+
+}
+// end of namespace pov
+
+#endif // POVRAY_CORE_LIGHTTREE_H
@@ -41,6 +41,7 @@
 
 // C++ standard header files
 #include <algorithm>
+#include <future>
 #include <limits>
 
 // POV-Ray header files (base module)
@@ -1390,6 +1391,18 @@ void PhotonMap::mergeMap(PhotonMap* map)
 
 ******************************************************************************/
 
+void PhotonMap::swap(PhotonMap& map)
+{
+    mBlockList.swap(map.mBlockList);
+    for (int i = 0; i < 3; ++i)
+        mLoc[i].swap(map.mLoc[i]);
+    std::swap(numPhotons,       map.numPhotons);
+    std::swap(minGatherRad,     map.minGatherRad);
+    std::swap(minGatherRadMult, map.minGatherRadMult);
+    std::swap(gatherRadStep,    map.gatherRadStep);
+    std::swap(gatherNumSteps,   map.gatherNumSteps);
+}
+
 PhotonMap::~PhotonMap()
 {
     // free all non-nullptr blocks
@@ -1523,137 +1536,15 @@ void ShootingDirection::compute()
 
   FUNCTION
 
-  swapPhotons
-
-  swaps two photons
-
-  Precondition:
-    photon memory initialized
-    'a' and 'b' are indexes within the range of photons in the map
-      (NO ERROR CHECKING IS DONE)
-
-  Postconditions:
-    the photons indexed by 'a' and 'b' are swapped
-
-*****************************************************************************/
-
-void PhotonMap::swapPhotons(int a, int b)
-{
-    Photon tmp;
-    Photon& phA = GetPhoton(a);
-    Photon& phB = GetPhoton(b);
-
-    tmp = phA;
-    phA = phB;
-    phB = tmp;
-}
-
-/*****************************************************************************
-
-  FUNCTION
-
-  insertSort
-  (modified from Data Structures textbook)
-
-  Preconditions:
-    photon memory initialized
-    'start' is the index of the first photon
-    'end' is the index of the last photon
-    'd' is the dimension to sort on (X, Y, or Z)
-
-  Postconditions:
-    photons from 'start' to 'end' in the map are sorted in
-    ascending order on dimension d
-******************************************************************************/
-void PhotonMap::insertSort(int start, int end, int d)
-{
-    int j,k;
-    Photon tmp;
-
-    for(k=end-1; k>=start; k--)
-    {
-        j=k+1;
-        tmp = GetPhoton(k);
-        while (tmp.Loc[d] > GetPhoton(j).Loc[d])
-        {
-            GetPhoton(j-1) = GetPhoton(j);
-            j++;
-            if (j>end) break;
-        }
-        GetPhoton(j-1) = tmp;
-    }
-}
-
-/*****************************************************************************
-
-  FUNCTION
-
-  quickSortRec
-  (modified from Data Structures textbook)
-
-  Recursive part of the quicksort routine
-  This does not sort all the way.  once this is done, insertSort
-  should be called to finish the sorting process!
-
-  Preconditions:
-    photon memory initialized
-    'left' is the index of the first photon
-    'right' is the index of the last photon
-    'd' is the dimension to sort on (X, Y, or Z)
-
-  Postconditions:
-    photons from 'left' to 'right' in the map are MOSTLY sorted in
-    ascending order on dimension d
-******************************************************************************/
-void PhotonMap::quickSortRec(int left, int right, int d)
-{
-    int j,k;
-    if(left<right)
-    {
-        swapPhotons(((left+right)>>1), left+1);
-        if (GetPhoton(left+1).Loc[d] > GetPhoton(right).Loc[d])
-            swapPhotons(left+1,right);
-        if (GetPhoton(left).Loc[d] > GetPhoton(right).Loc[d])
-            swapPhotons(left,right);
-        if (GetPhoton(left+1).Loc[d] > GetPhoton(left).Loc[d])
-            swapPhotons(left+1,left);
-
-        j=left+1; k=right;
-        while(j<=k)
-        {
-            for (j++; (j <= right) && (GetPhoton(j).Loc[d] < GetPhoton(left).Loc[d]); j++) { }
-            for (k--; (k >= left) && (GetPhoton(k).Loc[d] > GetPhoton(left).Loc[d]); k--) { }
-
-            if(j<k)
-                swapPhotons(j,k);
-        }
-
-        swapPhotons(left,k);
-        if(k-left > 10)
-        {
-            quickSortRec(left,k-1,d);
-        }
-        if(right-k > 10)
-        {
-            quickSortRec(k+1,right,d);
-        }
-        // leave the rest for insertSort
-    }
-}
-
-/*****************************************************************************
-
-  FUNCTION
-
-  halfSortRec
+  halfSort
   (modified quicksort algorithm)
 
-  Recursive part of the quicksort routine, but it only does half
-  the quicksort.  It only recurses one branch - the branch that contains
-  the midpoint (median).
+  Partitioning part of the quicksort routine, but it only does half
+  the quicksort.  It only continues with one branch - the branch that
+  contains the midpoint (median).
 
   Preconditions:
-    photon memory initialized
+    'photons' is a contiguous array of photons
     'left' is the index of the first photon
     'right' is the index of the last photon
     'd' is the dimension to sort on (X, Y, or Z)
@@ -1663,43 +1554,43 @@ void PhotonMap::quickSortRec(int left, int right, int d)
     the photon at the midpoint (mid) is the median of the photons
     when sorted on dimension d.
 ******************************************************************************/
-void PhotonMap::halfSortRec(int left, int right, int d, int mid)
+static void halfSort(Photon* photons, int left, int right, int d, int mid)
 {
     int j,k;
-    if(left<right)
+    while(left<right)
     {
-        swapPhotons(((left+right)>>1), left+1);
-        if (GetPhoton(left+1).Loc[d] > GetPhoton(right).Loc[d])
-            swapPhotons(left+1,right);
-        if (GetPhoton(left).Loc[d] > GetPhoton(right).Loc[d])
-            swapPhotons(left,right);
-        if (GetPhoton(left+1).Loc[d] > GetPhoton(left).Loc[d])
-            swapPhotons(left+1,left);
+        std::swap(photons[(left+right)>>1], photons[left+1]);
+        if (photons[left+1].Loc[d] > photons[right].Loc[d])
+            std::swap(photons[left+1], photons[right]);
+        if (photons[left].Loc[d] > photons[right].Loc[d])
+            std::swap(photons[left], photons[right]);
+        if (photons[left+1].Loc[d] > photons[left].Loc[d])
+            std::swap(photons[left+1], photons[left]);
+
+        const PhotonScalar pivot = photons[left].Loc[d];
 
         j=left+1; k=right;
         while(j<=k)
         {
-            for (j++; (j <= right) && (GetPhoton(j).Loc[d] < GetPhoton(left).Loc[d]); j++) { }
-            for (k--; (k >= left) && (GetPhoton(k).Loc[d] > GetPhoton(left).Loc[d]); k--) { }
+            for (j++; (j <= right) && (photons[j].Loc[d] < pivot); j++) { }
+            for (k--; (k >= left) && (photons[k].Loc[d] > pivot); k--) { }
 
             if(j<k)
-                swapPhotons(j,k);
+                std::swap(photons[j], photons[k]);
         }
 
         // put the pivot into its position
-        swapPhotons(left,k);
+        std::swap(photons[left], photons[k]);
 
         // only go down the side that contains the midpoint
         // don't do anything if the midpoint=k (the pivot, which is
         // now in the correct position
         if(k-left > 0 && (mid>=left) && (mid<k))
-        {
-            halfSortRec(left,k-1,d,mid);
-        }
+            right = k-1;
         else if(right-k > 0 && (mid>k) && (mid<=right))
-        {
-            halfSortRec(k+1,right,d,mid);
-        }
+            left = k+1;
+        else
+            break;
     }
 }
 
@@ -1709,30 +1600,33 @@ void PhotonMap::halfSortRec(int left, int right, int d, int mid)
 
   sortAndSubdivide
 
-  Finds the dimension with the greatest range, sorts the photons on that
-  dimension.  Then it recurses on the left and right halves (keeping
-  the median photon as a pivot).  This produces a balanced kd-tree.
+  Finds the dimension with the greatest range, and partitions the photons
+  around the median on that dimension.  Then it recurses on the left and
+  right halves (keeping the median photon as a pivot).  This produces a
+  balanced kd-tree.
+
+  Large halves are processed on separate threads, dividing the 'threads'
+  available between them; as the halves do not overlap, the result does not
+  depend on the number of threads used.
 
   Preconditions:
-    photon memory initialized
+    'photons' is a contiguous array of photons
     'start' is the index of the first photon
     'end' is the index of the last photon
-    'sorted' is the dimension that was last sorted (so we don't sort again)
 
   Postconditions:
-    photons from 'start' to 'end' in the map are in a valid kd-tree format
+    photons from 'start' to 'end' in the array are in a valid kd-tree format
 ******************************************************************************/
-void PhotonMap::sortAndSubdivide(int start, int end, int /*sorted*/)
+void PhotonMap::sortAndSubdivide(Photon* photons, int start, int end, unsigned int threads)
 {
     int i,j;             // counters
     PhotonVector3d min,max; // min/max vectors for finding range
     int DimToUse;        // which dimension has the greatest range
     int mid;             // index of median (middle)
-    int len;             // length of the array we're sorting
 
     if (end==start)
     {
-        GetPhoton(start).info = 0;
+        photons[start].info = 0;
         return;
     }
 
@@ -1747,12 +1641,10 @@ void PhotonMap::sortAndSubdivide(int start, int end, int /*sorted*/)
     {
         for(j=X; j<=Z; j++)
         {
-            Photon *ph = &GetPhoton(i);
-
-            if (ph->Loc[j] < min[j])
-                min[j]=ph->Loc[j];
-            if (ph->Loc[j] > max[j])
-                max[j]=ph->Loc[j];
+            if (photons[i].Loc[j] < min[j])
+                min[j]=photons[i].Loc[j];
+            if (photons[i].Loc[j] > max[j])
+                max[j]=photons[i].Loc[j];
         }
     }
 
@@ -1767,25 +1659,24 @@ void PhotonMap::sortAndSubdivide(int start, int end, int /*sorted*/)
     mid = (end+start)>>1;
 
     // use half of a quicksort to find the median
-    len = end-start;
-    if (len>=2)
-    {
-        // only display status every so often
-        if(len > 1000)
-        {
-//          Send_ProgressUpdate(PROGRESS_SORTING_PHOTONS);
-        }
-
-        halfSortRec(start, end, DimToUse, mid);
-        //don't do this - but why? quickSortRec(start, end, DimToUse);
-    }
+    if (end-start>=2)
+        halfSort(photons, start, end, DimToUse, mid);
 
     // set DimToUse for the midpoint
-    GetPhoton(mid).info = DimToUse;
+    photons[mid].info = DimToUse;
 
     // now recurse to continue building the kd-tree
-    sortAndSubdivide(start, mid - 1, DimToUse);
-    sortAndSubdivide(mid + 1, end, DimToUse);
+    if ((threads > 1) && (end - start >= POV_PHOTON_BUILD_PARALLEL_THRESHOLD))
+    {
+        std::future<void> left = std::async(std::launch::async, &PhotonMap::sortAndSubdivide, photons, start, mid - 1, threads / 2);
+        sortAndSubdivide(photons, mid + 1, end, threads - threads / 2);
+        left.get();
+    }
+    else
+    {
+        sortAndSubdivide(photons, start, mid - 1, 1);
+        sortAndSubdivide(photons, mid + 1, end, 1);
+    }
 }
 
 /*****************************************************************************
@@ -1794,7 +1685,9 @@ void PhotonMap::sortAndSubdivide(int start, int end, int /*sorted*/)
 
   buildTree
 
-  Builds the kd-tree by calling sortAndSubdivide().
+  Builds the kd-tree by calling sortAndSubdivide() on a contiguous copy of
+  the photons, using up to 'threads' threads, and builds the location arrays
+  used for gathering.
 
   Preconditions:
     photon memory initialized
@@ -1804,10 +1697,57 @@ void PhotonMap::sortAndSubdivide(int start, int end, int /*sorted*/)
   Postconditions:
     photons are in a valid kd-tree format
 ******************************************************************************/
-void PhotonMap::buildTree()
+void PhotonMap::buildTree(unsigned int threads)
 {
 //  Send_Progress("Sorting photons", PROGRESS_SORTING_PHOTONS);
-    sortAndSubdivide(0, numPhotons-1, X+Y+Z /* this is not X, Y, or Z */);
+
+    // the block storage is too costly to index in the inner loops of the sort,
+    // so we sort a contiguous copy instead
+    vector<Photon> photons(numPhotons);
+    for (int i = 0; i < numPhotons; i += PHOTON_BLOCK_SIZE)
+    {
+        int count = min(numPhotons - i, PHOTON_BLOCK_SIZE);
+        std::copy(&GetPhoton(i), &GetPhoton(i) + count, photons.begin() + i);
+    }
+
+    threads = max(1u, min((unsigned int)POV_PHOTON_BUILD_MAX_THREADS, threads));
+
+    sortAndSubdivide(photons.data(), 0, numPhotons-1, threads);
+
+    for (int i = 0; i < numPhotons; i += PHOTON_BLOCK_SIZE)
+    {
+        int count = min(numPhotons - i, PHOTON_BLOCK_SIZE);
+        std::copy(photons.begin() + i, photons.begin() + i + count, &GetPhoton(i));
+    }
+
+    buildLocationArrays();
+}
+
+/*****************************************************************************
+
+  FUNCTION
+
+  buildLocationArrays
+
+  Copies the photon locations into separate arrays per axis.
+
+  Preconditions:
+    photons are in a valid kd-tree format
+
+  Postconditions:
+    'mLoc' holds the locations of all photons, in kd-tree order
+******************************************************************************/
+void PhotonMap::buildLocationArrays()
+{
+    for (int d = X; d <= Z; d++)
+        mLoc[d].resize(numPhotons);
+
+    for (int i = 0; i < numPhotons; i++)
+    {
+        const Photon& photon = GetPhoton(i);
+        for (int d = X; d <= Z; d++)
+            mLoc[d][i] = photon.Loc[d];
+    }
 }
 
 /*****************************************************************************
@@ -2247,6 +2187,13 @@ void PhotonGatherer::gatherPhotonsRec(int start, int end)
     Vector3d ptToPhoton;
     DBL discFix;   // use disc(ellipsoid) for gathering instead of sphere
 
+    // small ranges are cheaper to test in one go than to traverse
+    if (end - start < POV_PHOTON_GATHER_BLOCK_SIZE)
+    {
+        gatherPhotonsBlock(start, end);
+        return;
+    }
+
     // find midpoint
     mid = (end+start)>>1;
     photon = &map->GetPhoton(mid);
@@ -2346,6 +2293,67 @@ void PhotonGatherer::gatherPhotonsRec(int start, int end)
     }
 }
 
+/*****************************************************************************
+
+  FUNCTION
+
+  gatherPhotonsBlock()
+
+  Non-recursive part of gatherPhotons
+  Tests all photons in the range start..end against the gather radius,
+  computing their distances from the gather point in one go.
+
+  Preconditions:
+    same as gatherPhotonsRec()
+    the range 'start..end' holds no more than POV_PHOTON_GATHER_BLOCK_SIZE photons
+
+  Postconditions:
+    same as gatherPhotonsRec()
+
+******************************************************************************/
+
+void PhotonGatherer::gatherPhotonsBlock(int start, int end)
+{
+    DBL distances[POV_PHOTON_GATHER_BLOCK_SIZE];
+    const int count = end - start + 1;
+    const PhotonScalar *locX = &map->mLoc[X][start];
+    const PhotonScalar *locY = &map->mLoc[Y][start];
+    const PhotonScalar *locZ = &map->mLoc[Z][start];
+    const DBL ptX = (*pt_s)[X];
+    const DBL ptY = (*pt_s)[Y];
+    const DBL ptZ = (*pt_s)[Z];
+    Vector3d norm(0.0);
+    if (flattenFactor != 0.0)
+        norm = *norm_s;
+
+    // compute the distances (flattened to an ellipsoid as in gatherPhotonsRec()) for all photons
+    // first; this loop has no data-dependent branches, so the compiler can vectorize it
+    for (int i = 0; i < count; i++)
+    {
+        DBL dx = DBL(locX[i]) - ptX;
+        DBL dy = DBL(locY[i]) - ptY;
+        DBL dz = DBL(locZ[i]) - ptZ;
+        DBL dSqr = dx*dx + dy*dy + dz*dz;
+        DBL discFix = fabs(norm[X]*dx + norm[Y]*dy + norm[Z]*dz);
+        distances[i] = dSqr + flattenFactor*(discFix)*dSqr*16;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        if (distances[i] < dmax_s)
+        {
+            Photon *photon = &map->GetPhoton(start + i);
+            if (gatheredPhotons.numFound+1>TargetNum_s)
+            {
+                FullPQInsert(photon, distances[i]);
+                sqrt_dmax_s = sqrt(dmax_s);
+            }
+            else
+                PQInsert(photon, distances[i]);
+        }
+    }
+}
+
 /*****************************************************************************
 
   FUNCTION
@@ -193,6 +193,10 @@ class PhotonMap final
 
         std::vector<PhotonBlock*> mBlockList;
 
+        /// Photon locations in kd-tree order, one array per axis, so that several photons
+        /// can be tested at once when gathering. Built by @ref buildLocationArrays().
+        std::vector<PhotonScalar> mLoc[3];
+
         int numPhotons;         /* total number of photons used */
         DBL minGatherRad;       /* minimum gather radius */
         DBL minGatherRadMult;   /* minimum gather radius multiplier (for speed adjustments) */
@@ -202,12 +206,8 @@ class PhotonMap final
         PhotonMap();
         ~PhotonMap();
 
-        void swapPhotons(int a, int b);
-        void insertSort(int start, int end, int d);
-        void quickSortRec(int left, int right, int d);
-        void halfSortRec(int left, int right, int d, int mid);
-        void sortAndSubdivide(int start, int end, int /*sorted*/);
-        void buildTree();
+        void buildTree(unsigned int threads = 1);
+        void buildLocationArrays();
 
         void setGatherOptions(ScenePhotonSettings& photonSettings, bool mediaMap);
 
@@ -215,6 +215,9 @@ class PhotonMap final
 
         void mergeMap(PhotonMap* map);
 
+        /// Exchange the photons and gather options with those of another map.
+        void swap(PhotonMap& map);
+
         Photon& GetPhoton(unsigned int photonId);
         const Photon& GetPhoton(unsigned int photonId) const;
 
@@ -257,6 +260,8 @@ class PhotonMap final
 
         Photon& GetPhoton(unsigned int blockId, unsigned int indexInBlock);
         const Photon& GetPhoton(unsigned int blockId, unsigned int indexInBlock) const;
+
+        static void sortAndSubdivide(Photon* photons, int start, int end, unsigned int threads);
 };
 
 
@@ -303,6 +308,7 @@ class PhotonGatherer final
         PhotonGatherer(PhotonMap *map, ScenePhotonSettings& photonSettings);
 
         void gatherPhotonsRec(int start, int end);
+        void gatherPhotonsBlock(int start, int end);
         int gatherPhotons(const Vector3d* pt, DBL Size, DBL *r, const Vector3d* norm, bool flatten);
         DBL gatherPhotonsAdaptive(const Vector3d* pt, const Vector3d* norm, bool flatten);
 
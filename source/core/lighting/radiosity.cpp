@@ -1017,6 +1017,32 @@ void RadiosityCache::InitAutosave(const Path& outputFile, bool append)
     ot_fd = NewOStream(outputFile, POV_File_Data_RCA, append);
 }
 
+static void MarkSamplesLoaded(ot_node_struct* node)
+{
+    if (node == nullptr)
+        return;
+    for (ot_block_struct* block = node->Values; block != nullptr; block = block->next)
+    {
+        block->Pass   = OT_PASS(PRETRACE_STEP_LOADED);
+        block->TileId = 0;
+    }
+    for (unsigned int i = 0; i < 8; i ++)
+        MarkSamplesLoaded(node->Kids[i]);
+}
+
+void RadiosityCache::TakeSamples(RadiosityCache& source)
+{
+    POV_RADIOSITY_ASSERT(octree.root == nullptr);
+
+    octree.root = source.octree.root.load();
+    source.octree.root = nullptr;
+    MarkSamplesLoaded(octree.root);
+
+    // The blocks are owned by the pools they were allocated from, so we need to take those too.
+    blockPools.insert(blockPools.end(), source.blockPools.begin(), source.blockPools.end());
+    source.blockPools.clear();
+}
+
 /*****************************************************************************
 *
 * FUNCTION  Deinitialize_Radiosity_Code()
@@ -1060,10 +1086,11 @@ RadiosityCache::~RadiosityCache()
     { // mutex scope
 #if POV_MULTITHREADED
         std::lock_guard<std::mutex> lockTree(octree.treeMutex);
-        std::lock_guard<std::mutex> lockBlock(octree.blockMutex);
 #endif
-        if (octree.root != nullptr)
-            ot_free_tree(&octree.root);
+        ot_node_struct *root = octree.root;
+        if (root != nullptr)
+            ot_free_tree(&root);
+        octree.root = nullptr;
     }
 
     { // mutex scope
@@ -1235,7 +1262,7 @@ void RadiosityCache::AddBlock(BlockPool* pool, RenderStatistics* stats, const Ve
 ot_node_struct *RadiosityCache::GetNode(RenderStatistics* stats, const ot_id_struct& id)
 {
     int target_size, dx, dy, dz, index;
-    ot_node_struct *temp_node, *this_node, *temp_root;
+    ot_node_struct *temp_node, *this_node, *temp_root, *kid_node;
     ot_id_struct temp_id;
 
 #if POV_MULTITHREADED
@@ -1246,19 +1273,22 @@ ot_node_struct *RadiosityCache::GetNode(RenderStatistics* stats, const ot_id_str
     ot_inscount++;
 #endif
 
+    // Nodes are only ever added to the tree, never removed or moved, so the tree can be walked and
+    // extended without locking: new nodes are fully built before being hooked in by compare-and-swap,
+    // and if another thread beats us to it, we simply discard ours and use theirs.
+    // Only replacing the root requires exclusive access, as it may take several steps.
+
     // If there is no root yet, create one.  This is a first-time-through
-    if (octree.root == nullptr)
+    temp_root = octree.root;
+    if (temp_root == nullptr)
     {
-        // now is the time to lock the tree for modification
-#if POV_MULTITHREADED
-        treeLock.lock();
-#endif
+        temp_node = new ot_node_struct;
+
+        // Might as well make it the right size for our first data block
+        temp_node->Id = id;
 
-        // Now that we have exclusive write access, make sure we REALLY don't have a root
-        // (some other thread might have created it just as we were waiting to get the lock)
-        if (octree.root == nullptr)
+        if (octree.root.compare_exchange_strong(temp_root, temp_node))
         {
-            octree.root = new ot_node_struct;
 #ifdef OCTREE_PERFORMANCE_DEBUG
             if (stats != nullptr)
                 (*stats)[Radiosity_OctreeNodes]++;
@@ -1268,27 +1298,21 @@ ot_node_struct *RadiosityCache::GetNode(RenderStatistics* stats, const ot_id_str
             ot_nodecount = 1;
 #endif
 
-            // Might as well make it the right size for our first data block
-            octree.root->Id = id;
-
             // Having constructed the node to match our needs, we're already in the right place;
             // let's take the shortest route out of here
-            return octree.root;
+            return temp_node;
         }
-        // no else
-
-        // Still here? Well, fooled by the pitfalls of multithreading, are we!
-        // The root is there now, but we didn't create it ourselves, so we need to go the long way
 
-        // As this is an exceptional case (happens at most once per task), we pay the price of releasing
-        // and possibly re-acquiring the lock, for the sake of code simplicity
+        // Some other thread created the root just as we were about to (temp_root now points to it),
+        // so we need to go the long way
+        delete temp_node;
     }
     // no else
 
     // What if the thing we're inserting is bigger than the biggest node in the
     // existing tree?  Add a new top to the tree till it's big enough.
 
-    if (octree.root->Id.Size < id.Size)
+    if (temp_root->Id.Size < id.Size)
     {
         // now is the time to lock the tree for modification, in case we haven't yet
 #if POV_MULTITHREADED
@@ -1296,13 +1320,15 @@ ot_node_struct *RadiosityCache::GetNode(RenderStatistics* stats, const ot_id_str
             treeLock.lock();
 #endif
 
-        // (Note that the following can't be a do...while() loop because we may not have had a lock when we first tested,
-        // and some other task may have modified the root while we were not looking)
-        while (octree.root->Id.Size < id.Size)
+        // (Note that the following can't be a do...while() loop because some other task may have
+        // modified the root while we were waiting for the lock)
+        temp_root = octree.root;
+        while (temp_root->Id.Size < id.Size)
         {
             // root too small
-            ot_newroot(&octree.root);
+            ot_newroot(&temp_root);
         }
+        octree.root = temp_root;
     }
 
     // What if the new block is the right size, but for an area of space which
@@ -1312,9 +1338,6 @@ ot_node_struct *RadiosityCache::GetNode(RenderStatistics* stats, const ot_id_str
     // Build a temp id, like a cursor to move around with
     temp_id = id;
 
-    // make sure we're using a stable root to work with
-    temp_root = octree.root;
-
     // First, find the parent of our new node which is as big as root
     while (temp_id.Size < temp_root->Id.Size)
     {
@@ -1332,7 +1355,8 @@ ot_node_struct *RadiosityCache::GetNode(RenderStatistics* stats, const ot_id_str
             treeLock.lock();
 
             // Acquired the lock just now, so some other task may have changed the root since last time we looked
-            while (temp_id.Size < octree.root->Id.Size)
+            temp_root = octree.root;
+            while (temp_id.Size < temp_root->Id.Size)
             {
                 ot_parent(&temp_id, &temp_id);
             }
@@ -1341,21 +1365,29 @@ ot_node_struct *RadiosityCache::GetNode(RenderStatistics* stats, const ot_id_str
 
         // (Note that the following can't be a do...while() loop because we may not have had a lock when we first tested,
         // and some other task may have modified the root while we were not looking)
-        while((temp_id.x != octree.root->Id.x) ||
-              (temp_id.y != octree.root->Id.y) ||
-              (temp_id.z != octree.root->Id.z))
+        while((temp_id.x != temp_root->Id.x) ||
+              (temp_id.y != temp_root->Id.y) ||
+              (temp_id.z != temp_root->Id.z))
         {
             // while separate subtrees...
-            ot_newroot(&octree.root);           // create bigger root
+            ot_newroot(&temp_root);         // create bigger root
             ot_parent(&temp_id, &temp_id);  // and move cursor up one, too
         }
+
+        // publish the new root only after it has been fully built
+        octree.root = temp_root;
     }
 
+#if POV_MULTITHREADED
+    if (treeLock.owns_lock())
+        treeLock.unlock();
+#endif
+
     // At this point, the new node is known to fit under the current tree
     // somewhere.  Go back down the tree to the right level, making new nodes
     // as you go.
 
-    this_node = octree.root; // start at the root
+    this_node = temp_root; // start at the root
 
     while (this_node->Id.Size > id.Size)
     {
@@ -1378,20 +1410,22 @@ ot_node_struct *RadiosityCache::GetNode(RenderStatistics* stats, const ot_id_str
 
         index = dx + dy + dz;
 
-        if (this_node->Kids[index] == nullptr)
+        kid_node = this_node->Kids[index];
+        if (kid_node == nullptr)
         {
             // Next level down doesn't exist yet, so create it
 
-#if POV_MULTITHREADED
-            // now is the time to lock the tree for modification, in case we haven't yet
-            if (!treeLock.owns_lock())
-                treeLock.lock();
-#endif
+            temp_node = new ot_node_struct;
+
+            // Fill in the data
+            temp_node->Id = temp_id;
+            // (all other data fields are automatically zeroed by the constructor)
 
-            // We may have acquired the lock just now, so some other task may have changed the root since last time we looked
-            if (this_node->Kids[index] == nullptr)
+            // Add it onto the tree, unless some other task has done so in the meantime
+            // (in which case kid_node now points to the node that task has added)
+            if (this_node->Kids[index].compare_exchange_strong(kid_node, temp_node))
             {
-                temp_node = new ot_node_struct;
+                kid_node = temp_node;
 #ifdef OCTREE_PERFORMANCE_DEBUG
                 if (stats!= nullptr)
                     (*stats)[Radiosity_OctreeNodes]++;
@@ -1400,18 +1434,13 @@ ot_node_struct *RadiosityCache::GetNode(RenderStatistics* stats, const ot_id_str
 #ifdef RADSTATS
                 ot_nodecount++;
 #endif
-
-                // Fill in the data
-                temp_node->Id = temp_id;
-                // (all other data fields are automatically zeroed by the allocation function)
-
-                // Add it onto the tree
-                this_node->Kids[index] = temp_node;
             }
+            else
+                delete temp_node;
         }
 
         // Now follow it down and repeat
-        this_node = this_node->Kids[index];
+        this_node = kid_node;
     }
 
     // Finally, we're in the right place, so return a pointer to the block
@@ -1420,12 +1449,14 @@ ot_node_struct *RadiosityCache::GetNode(RenderStatistics* stats, const ot_id_str
 
 void RadiosityCache::InsertBlock(ot_node_struct *node, ot_block_struct *block)
 {
-#if POV_MULTITHREADED
-    std::lock_guard<std::mutex> lock(octree.blockMutex);
-#endif
-
-    block->next = node->Values;
-    node->Values = block;
+    // Prepend the block to the node's list; the block is fully built at this point,
+    // so other threads walking the list will never see it in an incomplete state.
+    ot_block_struct *head = node->Values;
+    do
+    {
+        block->next = head;
+    }
+    while (!node->Values.compare_exchange_weak(head, block));
 }
 
 /*****************************************************************************
@@ -1457,7 +1488,9 @@ void RadiosityCache::InsertBlock(ot_node_struct *node, ot_block_struct *block)
 
 DBL RadiosityCache::FindReusableBlock(RenderStatistics& stats, DBL errorbound, const Vector3d& ipoint, const Vector3d& snormal, DBL brilliance, MathColour& illuminance, int recursionDepth, int pretraceStep, int tileId)
 {
-    if (octree.root != nullptr)
+    ot_node_struct *root = octree.root;
+
+    if (root != nullptr)
     {
         WT_AVG gather;
 
@@ -1486,7 +1519,7 @@ DBL RadiosityCache::FindReusableBlock(RenderStatistics& stats, DBL errorbound, c
         // Go through the tree calculating a weighted average of all of the usable points near this one
         // [CLi] inspection of octree.cpp tree code indicates that tree traversal is perfectly safe
         // regarding insertions by other threads, so no locking is needed
-        ot_dist_traverse(octree.root, ipoint, recursionDepth, AverageNearBlock, reinterpret_cast<void *>(&gather));
+        ot_dist_traverse(root, ipoint, recursionDepth, AverageNearBlock, reinterpret_cast<void *>(&gather));
 
 #ifdef OCTREE_PERFORMANCE_DEBUG
         stats[Radiosity_OctreeLookups]  += gather.Lookup_Count;
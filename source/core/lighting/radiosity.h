@@ -43,6 +43,7 @@
 //  (none at the moment)
 
 // C++ standard header files
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <vector>
@@ -214,6 +215,15 @@ class RadiosityCache final
         bool Load(const Path& inputFile);
         void InitAutosave(const Path& outputFile, bool append);
 
+        /// Take over all samples of another cache, e.g. one used for the previous frame of an animation.
+        ///
+        /// The samples are treated as if loaded from file, i.e. they are re-used regardless of the
+        /// pass and tile they were originally computed in.
+        ///
+        /// @note   This cache must not contain any samples yet, and neither cache may be in use.
+        ///
+        void TakeSamples(RadiosityCache& source);
+
         DBL FindReusableBlock(RenderStatistics& stats, DBL errorbound, const Vector3d& ipoint, const Vector3d& snormal, DBL brilliance, MathColour& illuminance, int recursionDepth, int pretraceStep, int tileId);
         BlockPool* AcquireBlockPool();
         void AddBlock(BlockPool* pool, RenderStatistics* stats, const Vector3d& Point, const Vector3d& S_Normal, DBL brilliance, const Vector3d& To_Nearest_Surface,
@@ -225,10 +235,9 @@ class RadiosityCache final
 
         struct Octree final
         {
-            ot_node_struct *root;
+            std::atomic<ot_node_struct *> root;
 #if POV_MULTITHREADED
-            std::mutex treeMutex;   // lock this when adding nodes to the tree
-            std::mutex blockMutex;  // lock this when adding blocks to any node of the tree
+            std::mutex treeMutex;   // lock this when replacing the root of the tree (other nodes and blocks are added lock-free)
 #endif
 
             Octree() : root(nullptr) {}
@@ -289,6 +298,9 @@ class RadiosityFunction final : public Trace::RadiosityFunctor
         // checks whether the specified recursion depth is still within the configured limits
         virtual bool CheckRadiosityTraceLevel(const TraceTicket& ticket) override;
 
+        // checks whether this is the final trace (i.e. not a radiosity pretrace step)
+        virtual bool IsFinalTrace() const override { return isFinalTrace; }
+
         // retrieves top level statistics information to drive pretrace re-iteration
         virtual void GetTopLevelStats(long& queryCount, float& reuse);
         virtual void ResetTopLevelStats();
@@ -37,14 +37,22 @@
 #include "core/lighting/subsurface.h"
 
 // C++ variants of C standard header files
-// C++ standard header files
 //  (none at the moment)
 
+// C++ standard header files
+#include <algorithm>
+
 // POV-Ray header files (base module)
 #include "base/mathutil.h"
 
 // POV-Ray header files (core module)
-//  (none at the moment)
+#include "core/bounding/boundingbox.h"
+#include "core/material/interior.h"
+#include "core/material/pattern.h"
+#include "core/material/pigment.h"
+#include "core/material/texture.h"
+#include "core/scene/object.h"
+#include "core/scene/scenedata.h"
 
 // this must be the last file included
 #include "base/povdebug.h"
@@ -52,6 +60,12 @@
 namespace pov
 {
 
+using std::min;
+using std::max;
+
+#define SSLT_CACHE_MIN_LINES 4096
+#define SSLT_CACHE_MAX_LINES 1048576
+
 /// Computes the BRDF approximation of the diffuse reflectance term.
 inline double DiffuseReflectance(double A, double alphaPrime)
 {
@@ -119,5 +133,384 @@ PreciseMathColour SubsurfaceInterior::GetReducedAlbedo(const MathColour& diffuse
     return result;
 }
 
+
+SubsurfaceDipole::SubsurfaceDipole(const PreciseMathColour& sigmaPrimeS, const PreciseMathColour& sigmaA, double eta)
+{
+    double F_dr = FresnelDiffuseReflectance(eta);
+    double Aconst = ((1 + F_dr) / (1 - F_dr));
+    minSigmaTr = HUGE_VAL;
+    for (int i = 0; i < MathColour::channels; i ++)
+    {
+        double sigmaPrimeT = sigmaPrimeS[i] + sigmaA[i];
+        sigmaTr[i]    = sqrt(3 * sigmaA[i] * sigmaPrimeT);
+        zr[i]         = 1.0 / sigmaPrimeT;
+        zv[i]         = zr[i] * (1.0 + Aconst * 4.0/3.0);
+        commonTerm[i] = (sigmaPrimeS[i] / sigmaPrimeT) / (4.0 * M_PI);
+        minSigmaTr    = min(minSigmaTr, double(sigmaTr[i]));
+    }
+}
+
+PreciseMathColour SubsurfaceDipole::Rd(double distSqr) const
+{
+    PreciseMathColour result;
+    for (int i = 0; i < MathColour::channels; i ++)
+    {
+        double dSqr_r = Sqr(zr[i]) + distSqr;
+        double d_r    = sqrt(dSqr_r);
+        double dSqr_v = Sqr(zv[i]) + distSqr;
+        double d_v    = sqrt(dSqr_v);
+        double r_term = zr[i] * (sigmaTr[i] + 1.0/d_r) * exp(-sigmaTr[i] * d_r) / dSqr_r;
+        double v_term = zv[i] * (sigmaTr[i] + 1.0/d_v) * exp(-sigmaTr[i] * d_v) / dSqr_v;
+        result[i] = commonTerm[i] * (r_term + v_term);
+    }
+    return result;
+}
+
+PreciseMathColour SubsurfaceDipole::RdDisc(double radiusSqr) const
+{
+    // The integral of z*(sigma_tr + 1/d)*exp(-sigma_tr*d)/d^2 over the disc (with d = sqrt(z^2+r^2))
+    // is 2*pi*(exp(-sigma_tr*z) - z*exp(-sigma_tr*d_max)/d_max).
+    PreciseMathColour result;
+    for (int i = 0; i < MathColour::channels; i ++)
+    {
+        double d_r    = sqrt(Sqr(zr[i]) + radiusSqr);
+        double d_v    = sqrt(Sqr(zv[i]) + radiusSqr);
+        double r_term = exp(-sigmaTr[i] * zr[i]) - zr[i] * exp(-sigmaTr[i] * d_r) / d_r;
+        double v_term = exp(-sigmaTr[i] * zv[i]) - zv[i] * exp(-sigmaTr[i] * d_v) / d_v;
+        result[i] = commonTerm[i] * 2.0 * (r_term + v_term) / radiusSqr;
+    }
+    return result;
+}
+
+
+SubsurfaceIrradianceCache::SubsurfaceIrradianceCache(std::vector<Sample>& samples, double mmPerUnit) :
+    mmPerUnit(mmPerUnit),
+    mMaxSampleArea(0.0)
+{
+    mSamples.swap(samples);
+    for (const Sample& sample : mSamples)
+        mMaxSampleArea = max(mMaxSampleArea, sample.area);
+    if (!mSamples.empty())
+    {
+        mNodes.reserve(2 * mSamples.size() / kMaxLeafSamples + 1);
+        (void)BuildNode(0, (unsigned int)mSamples.size(), 0);
+    }
+}
+
+unsigned int SubsurfaceIrradianceCache::BuildNode(unsigned int first, unsigned int count, unsigned int depth)
+{
+    unsigned int index = (unsigned int)mNodes.size();
+    mNodes.emplace_back();
+
+    Node node;
+    node.lo = node.hi = mSamples[first].point;
+    node.centroid = Vector3d(0.0);
+    node.power.Clear();
+    node.area = 0.0;
+    node.first = first;
+    node.count = count;
+    node.leaf = true;
+    for (unsigned int i = 0; i < 8; i ++)
+        node.children[i] = kNoChild;
+
+    for (unsigned int i = first; i < first + count; i ++)
+    {
+        const Sample& sample = mSamples[i];
+        for (int axis = X; axis <= Z; axis ++)
+        {
+            node.lo[axis] = min(node.lo[axis], sample.point[axis]);
+            node.hi[axis] = max(node.hi[axis], sample.point[axis]);
+        }
+        node.centroid += sample.point * sample.area;
+        node.power    += sample.irradiance * sample.area;
+        node.area     += sample.area;
+    }
+    if (node.area > 0.0)
+        node.centroid /= node.area;
+    else
+        node.centroid = (node.lo + node.hi) * 0.5;
+
+    if ((count > kMaxLeafSamples) && (depth < kMaxDepth))
+    {
+        // sort the samples by octant, and build a child node for each non-empty octant
+        Vector3d center = (node.lo + node.hi) * 0.5;
+        auto octant = [&center](const Sample& sample)
+        {
+            return (int(sample.point[X] > center[X]) << 2) | (int(sample.point[Y] > center[Y]) << 1) | int(sample.point[Z] > center[Z]);
+        };
+        std::sort(mSamples.begin() + first, mSamples.begin() + first + count,
+                  [&octant](const Sample& a, const Sample& b) { return octant(a) < octant(b); });
+
+        unsigned int begin = first;
+        while (begin < first + count)
+        {
+            int oct = octant(mSamples[begin]);
+            unsigned int end = begin + 1;
+            while ((end < first + count) && (octant(mSamples[end]) == oct))
+                end ++;
+            if ((begin == first) && (end == first + count))
+                break; // all samples in a single octant (they must be coincident); make this a leaf
+            node.children[oct] = BuildNode(begin, end - begin, depth + 1);
+            node.leaf = false;
+            begin = end;
+        }
+    }
+
+    mNodes[index] = node;
+    return index;
+}
+
+MathColour SubsurfaceIrradianceCache::ComputeRadiantExitance(const Vector3d& point, const SubsurfaceDipole& dipole, double errorBound) const
+{
+    PreciseMathColour result;
+
+    if (mNodes.empty())
+        return MathColour(result);
+
+    double mmPerUnitSqr = Sqr(mmPerUnit);
+    // contributions from beyond this distance (in mm) are negligible
+    double maxDist = (dipole.minSigmaTr > 0.0 ? 30.0 / dipole.minSigmaTr : HUGE_VAL);
+    double maxDistSqr = Sqr(maxDist);
+    // samples closer than this are never evaluated as part of a node
+    double maxNearRadiusSqr = Sqr(kNearFieldScale) * mMaxSampleArea / M_PI;
+    double lastNearRadiusSqr = -1.0;
+    PreciseMathColour nearRd;
+
+    unsigned int stack[kMaxDepth * 7 + 8];
+    unsigned int stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0)
+    {
+        const Node& node = mNodes[stack[--stackSize]];
+
+        double boxDistSqr = 0.0;
+        for (int axis = X; axis <= Z; axis ++)
+        {
+            if (point[axis] < node.lo[axis])
+                boxDistSqr += Sqr(node.lo[axis] - point[axis]);
+            else if (point[axis] > node.hi[axis])
+                boxDistSqr += Sqr(point[axis] - node.hi[axis]);
+        }
+        boxDistSqr *= mmPerUnitSqr;
+
+        if (boxDistSqr > maxDistSqr)
+            continue;
+
+        double distSqr = (node.centroid - point).lengthSqr() * mmPerUnitSqr;
+        if ((boxDistSqr > maxNearRadiusSqr) && (node.area < errorBound * distSqr))
+        {
+            // node is small enough as seen from the point to be evaluated as a whole
+            result += dipole.Rd(distSqr) * PreciseMathColour(node.power);
+        }
+        else if (node.leaf)
+        {
+            for (unsigned int i = node.first; i < node.first + node.count; i ++)
+            {
+                const Sample& sample = mSamples[i];
+                double sampleDistSqr = (sample.point - point).lengthSqr() * mmPerUnitSqr;
+                double nearRadiusSqr = Sqr(kNearFieldScale) * sample.area / M_PI;
+                if (sampleDistSqr < nearRadiusSqr)
+                {
+                    // Close to the point, the samples are too sparse to resolve the peak of the dipole profile;
+                    // instead, spread each sample's contribution evenly across a disc around the point. (This
+                    // presumes that the samples are spaced evenly.)
+                    if (nearRadiusSqr != lastNearRadiusSqr)
+                    {
+                        nearRd = dipole.RdDisc(nearRadiusSqr);
+                        lastNearRadiusSqr = nearRadiusSqr;
+                    }
+                    result += nearRd * PreciseMathColour(sample.irradiance * sample.area);
+                }
+                else
+                    result += dipole.Rd(sampleDistSqr) * PreciseMathColour(sample.irradiance * sample.area);
+            }
+        }
+        else
+        {
+            for (unsigned int i = 0; i < 8; i ++)
+                if (node.children[i] != kNoChild)
+                    stack[stackSize++] = node.children[i];
+        }
+    }
+
+    return MathColour(result);
+}
+
+
+void SubsurfaceCacheTable::Set(const Interior* interior, const SubsurfaceIrradianceCachePtr& cache)
+{
+    mCaches[interior] = cache;
+}
+
+SubsurfaceIrradianceCachePtr SubsurfaceCacheTable::Get(const Interior* interior) const
+{
+    auto i = mCaches.find(interior);
+    if (i == mCaches.end())
+        return SubsurfaceIrradianceCachePtr();
+    return i->second;
+}
+
+
+/// Computes the smallest mean free path of all SSLT layers of a texture, in mm.
+///
+/// @note   As the pigment colour is only known at shading time for non-uniform pigments, white is assumed for those.
+///
+static void ComputeSSLTMeanFreePath(const TEXTURE *texture, const SubsurfaceInterior& subsurface, double& meanFreePath)
+{
+    for (; texture != nullptr; texture = texture->Next)
+    {
+        if (texture->Blend_Map)
+        {
+            for (const TextureBlendMapEntry& entry : texture->Blend_Map->Blend_Map_Entries)
+                ComputeSSLTMeanFreePath(entry.Vals, subsurface, meanFreePath);
+        }
+
+        for (const TEXTURE *material : texture->Materials)
+            ComputeSSLTMeanFreePath(material, subsurface, meanFreePath);
+
+        const FINISH *finish = texture->Finish;
+        if ((finish == nullptr) || !finish->UseSubsurface)
+            continue;
+
+        MathColour pigmentColour(1.0);
+        if ((texture->Pigment != nullptr) && (texture->Pigment->Type == PLAIN_PATTERN))
+            pigmentColour = texture->Pigment->colour.colour();
+
+        // same as in Trace::ComputeSubsurfaceScattering()
+        PreciseMathColour   alpha_prime     = subsurface.GetReducedAlbedo(pigmentColour * finish->Diffuse);
+        PreciseMathColour   sigma_prime_s   = 1.0 / PreciseMathColour(finish->SubsurfaceTranslucency);
+        PreciseMathColour   sigma_prime_t   = sigma_prime_s / alpha_prime;
+        PreciseMathColour   sigma_a         = sigma_prime_t - sigma_prime_s;
+        double              sigma_prime_t_mean = sigma_a.Greyscale() + sigma_prime_s.Greyscale();
+
+        if (sigma_prime_t_mean > 0.0)
+            meanFreePath = min(meanFreePath, 1.0 / sigma_prime_t_mean);
+    }
+}
+
+/// Finds the leaf objects having SSLT interiors, and collects the data needed to build their caches.
+static void FindSSLTObjects(ConstObjectPtr object, ObjectPtr topLevelObject, std::vector<SubsurfaceCacheBuilder::Job>& jobs,
+                            std::vector<Vector3d>& lo, std::vector<Vector3d>& hi, std::vector<double>& meanFreePath)
+{
+    if (object->Type & IS_COMPOUND_OBJECT)
+    {
+        for (ConstObjectPtr child : static_cast<const CompoundObject *>(object)->children)
+            FindSSLTObjects(child, topLevelObject, jobs, lo, hi, meanFreePath);
+        return;
+    }
+
+    const Interior *interior = object->interior.get();
+    if ((interior == nullptr) || !interior->subsurface)
+        return;
+
+    double objectMeanFreePath = HUGE_VAL;
+    ComputeSSLTMeanFreePath(object->Texture, *interior->subsurface, objectMeanFreePath);
+    ComputeSSLTMeanFreePath(object->Interior_Texture, *interior->subsurface, objectMeanFreePath);
+    if (objectMeanFreePath == HUGE_VAL)
+        return; // object doesn't use SSLT
+
+    size_t index = 0;
+    while ((index < jobs.size()) && (jobs[index].interior != interior))
+        ++index;
+    if (index == jobs.size())
+    {
+        jobs.emplace_back();
+        jobs.back().interior = interior;
+        lo.push_back(Vector3d(BOUND_HUGE));
+        hi.push_back(Vector3d(-BOUND_HUGE));
+        meanFreePath.push_back(HUGE_VAL);
+    }
+
+    SubsurfaceCacheBuilder::Job& job = jobs[index];
+    if (job.objects.empty() || (job.objects.back() != topLevelObject))
+        job.objects.push_back(topLevelObject);
+
+    Vector3d mins, maxs;
+    Make_min_max_from_BBox(mins, maxs, object->BBox);
+    for (int axis = X; axis <= Z; axis++)
+    {
+        lo[index][axis] = min(lo[index][axis], mins[axis]);
+        hi[index][axis] = max(hi[index][axis], maxs[axis]);
+    }
+    meanFreePath[index] = min(meanFreePath[index], objectMeanFreePath);
+}
+
+SubsurfaceCacheBuilder::SubsurfaceCacheBuilder(const SceneData& sceneData) :
+    mNextChunk(0)
+{
+    std::vector<Job> jobs;
+    std::vector<Vector3d> lo, hi;
+    std::vector<double> meanFreePath;
+    for (ObjectPtr object : sceneData.objects)
+        FindSSLTObjects(object, object, jobs, lo, hi, meanFreePath);
+
+    size_t chunks = 0;
+    for (size_t i = 0; i < jobs.size(); i++)
+    {
+        Job& job = jobs[i];
+
+        bool bounded = true;
+        for (int axis = X; axis <= Z; axis++)
+            if (hi[i][axis] - lo[i][axis] > CRITICAL_LENGTH)
+                bounded = false;
+        if (!bounded)
+            continue; // infinite objects can't be sampled this way
+
+        // The number of lines is chosen to space the samples about one mean free path apart; each intersection
+        // represents an area of 2*pi*R^2/N.
+        job.center = (lo[i] + hi[i]) * 0.5;
+        job.radius = max((hi[i] - lo[i]).length() * 0.5, EPSILON);
+        job.eta = job.interior->IOR / sceneData.atmosphereIOR;
+        double spacing = max(meanFreePath[i] / sceneData.mmPerUnit, EPSILON);
+        double numLines = clip(ceil(2.0 * M_PI * Sqr(job.radius / spacing)), double(SSLT_CACHE_MIN_LINES), double(SSLT_CACHE_MAX_LINES));
+        job.lineCount = size_t(numLines);
+        job.sampleArea = 2.0 * M_PI * Sqr(job.radius * sceneData.mmPerUnit) / numLines;
+        job.directionGenerator = GetIndexedSubRandomDirectionGenerator(0);
+        job.discGenerator = GetIndexedSubRandomOnDiscGenerator(2, job.radius);
+
+        chunks += (job.lineCount + kChunkSize - 1) / kChunkSize;
+        mJobs.push_back(std::move(job));
+        mChunkEnd.push_back(chunks);
+    }
+
+    mSamples.resize(mJobs.size());
+}
+
+bool SubsurfaceCacheBuilder::GetNextChunk(size_t& job, size_t& first, size_t& count)
+{
+    size_t chunk = mNextChunk++;
+    auto end = std::upper_bound(mChunkEnd.begin(), mChunkEnd.end(), chunk);
+    if (end == mChunkEnd.end())
+        return false;
+
+    job = size_t(end - mChunkEnd.begin());
+    size_t jobFirstChunk = (job == 0 ? 0 : mChunkEnd[job - 1]);
+    first = (chunk - jobFirstChunk) * kChunkSize;
+    count = min(kChunkSize, mJobs[job].lineCount - first);
+    return true;
+}
+
+void SubsurfaceCacheBuilder::AddSamples(size_t job, size_t first, std::vector<Sample>& samples)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mSamples[job][first].swap(samples);
+}
+
+void SubsurfaceCacheBuilder::Finish(SubsurfaceCacheTable& table, double mmPerUnit)
+{
+    for (size_t i = 0; i < mJobs.size(); i++)
+    {
+        std::vector<Sample> samples;
+        for (auto& chunk : mSamples[i])
+        {
+            samples.insert(samples.end(), chunk.second.begin(), chunk.second.end());
+            std::vector<Sample>().swap(chunk.second);
+        }
+        table.Set(mJobs[i].interior, std::make_shared<SubsurfaceIrradianceCache>(samples, mmPerUnit));
+    }
+    mSamples.clear();
+}
+
 }
 // end of namespace pov
@@ -40,9 +40,15 @@
 #include "core/configcore.h"
 
 // C++ variants of C standard header files
-// C++ standard header files
 //  (none at the moment)
 
+// C++ standard header files
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
 // Boost header files
 #include <boost/flyweight.hpp>
 #include <boost/flyweight/key_value.hpp>
@@ -52,6 +58,8 @@
 
 // POV-Ray header files (core module)
 #include "core/coretypes.h"
+#include "core/math/randomsequence.h"
+#include "core/scene/scenedata_fwd.h"
 
 namespace pov
 {
@@ -107,6 +115,192 @@ inline double FresnelDiffuseReflectance(double eta)
 #endif
 }
 
+/// Diffuse reflectance profile according to the dipole diffusion approximation.
+///
+/// All distances are in mm.
+///
+struct SubsurfaceDipole final
+{
+    SubsurfaceDipole(const PreciseMathColour& sigmaPrimeS, const PreciseMathColour& sigmaA, double eta);
+
+    /// Computes the diffuse reflectance for a given squared distance between points of incidence and exitance.
+    ///
+    /// @note   As usual in POV-Ray, the 1/pi factor is left out.
+    ///
+    PreciseMathColour Rd(double distSqr) const;
+
+    /// Computes the mean diffuse reflectance over a disc centered at the point of exitance.
+    ///
+    /// @note   As usual in POV-Ray, the 1/pi factor is left out.
+    ///
+    PreciseMathColour RdDisc(double radiusSqr) const;
+
+    PreciseMathColour   sigmaTr;        ///< Effective transport extinction coefficient.
+    PreciseMathColour   zr;             ///< Depth of the real source.
+    PreciseMathColour   zv;             ///< Height of the virtual source.
+    PreciseMathColour   commonTerm;     ///< Reduced albedo divided by 4*pi.
+    double              minSigmaTr;     ///< Smallest of the effective transport extinction coefficients.
+};
+
+/// Hierarchical cache of irradiance samples distributed over the surface of an SSLT object.
+///
+/// The samples are organized in an octree, each node of which also holds the total area and the area-weighted
+/// irradiance of its samples. When computing the radiant exitance at a point, nodes that are small enough as seen from
+/// that point are evaluated as a whole, as proposed by Jensen and Buhler in their 2002 paper.
+///
+class SubsurfaceIrradianceCache final
+{
+    public:
+
+        struct Sample final
+        {
+            Vector3d    point;          ///< Location of the sample, in POV-Ray units.
+            MathColour  irradiance;     ///< Irradiance transmitted into the object at the sample.
+            double      area;           ///< Surface area represented by the sample, in mm^2.
+        };
+
+        /// Builds the cache from a set of samples.
+        ///
+        /// @note   The samples are taken over, leaving the vector empty.
+        ///
+        SubsurfaceIrradianceCache(std::vector<Sample>& samples, double mmPerUnit);
+
+        /// Computes the diffuse radiant exitance at a point on the surface.
+        ///
+        /// This is the sum of the irradiance samples, weighted by their area and the diffuse reflectance profile.
+        ///
+        /// @param[in]  point       Point on the surface.
+        /// @param[in]  dipole      Diffuse reflectance profile.
+        /// @param[in]  errorBound  Maximum solid angle of a node (area divided by squared distance) to evaluate as a whole.
+        /// @return                 Radiant exitance, not including the Fresnel transmittance at the point.
+        ///
+        MathColour ComputeRadiantExitance(const Vector3d& point, const SubsurfaceDipole& dipole, double errorBound) const;
+
+        size_t GetSampleCount() const { return mSamples.size(); }
+
+    private:
+
+        static const unsigned int kMaxDepth = 24;
+        static const unsigned int kMaxLeafSamples = 8;
+        static const unsigned int kNoChild = 0xFFFFFFFFu;
+
+        /// Radius of the disc around the point across which nearby samples are spread, relative to the radius of
+        /// the area they represent.
+        static constexpr double kNearFieldScale = 3.0;
+
+        struct Node final
+        {
+            Vector3d        lo, hi;         ///< Bounding box of the samples.
+            Vector3d        centroid;       ///< Area-weighted mean location of the samples.
+            MathColour      power;          ///< Sum of irradiance times area of the samples.
+            double          area;           ///< Sum of the areas of the samples.
+            unsigned int    first;          ///< Index of first sample.
+            unsigned int    count;          ///< Number of samples.
+            unsigned int    children[8];    ///< Indices of child nodes, or @ref kNoChild for empty octants.
+            bool            leaf;           ///< Whether the node has no child nodes.
+        };
+
+        std::vector<Node>   mNodes;
+        std::vector<Sample> mSamples;
+        double              mmPerUnit;
+        double              mMaxSampleArea;
+
+        unsigned int BuildNode(unsigned int first, unsigned int count, unsigned int depth);
+};
+
+typedef std::shared_ptr<const SubsurfaceIrradianceCache> SubsurfaceIrradianceCachePtr;
+
+/// Table of the irradiance caches of all SSLT interiors in a scene.
+///
+/// The table is filled by @ref SubsurfaceCacheBuilder before the main render starts, and is not modified while
+/// rendering; lookups therefore require no locking.
+///
+class SubsurfaceCacheTable final
+{
+    public:
+
+        /// Sets the cache for a given interior.
+        ///
+        /// @note   This method must not be called while other threads may be calling @ref Get().
+        ///
+        void Set(const Interior* interior, const SubsurfaceIrradianceCachePtr& cache);
+
+        /// Gets the cache for a given interior.
+        ///
+        /// @return     The cache, or a null pointer if no cache has been built for the interior.
+        ///
+        SubsurfaceIrradianceCachePtr Get(const Interior* interior) const;
+
+    private:
+
+        std::map<const Interior*, SubsurfaceIrradianceCachePtr> mCaches;
+};
+
+/// Helper class to build the irradiance caches of all SSLT interiors in a scene.
+///
+/// The builder identifies the SSLT interiors and sets up the parameters of their caches on construction; the samples
+/// are then computed in chunks by any number of render threads, and merged into the caches by a final call to
+/// @ref Finish(). Chunks are merged in order of their first line, so that the result does not depend on the number of
+/// threads or the order in which chunks are completed.
+///
+class SubsurfaceCacheBuilder final
+{
+    public:
+
+        typedef SubsurfaceIrradianceCache::Sample Sample;
+
+        /// Parameters of the cache for a single SSLT interior.
+        ///
+        /// The samples are placed at the intersections of uniformly distributed lines through the bounding sphere of
+        /// the objects with their surfaces. Per Cauchy-Crofton, the intersections are distributed uniformly over the
+        /// surface, each representing the same area.
+        ///
+        struct Job final
+        {
+            const Interior*                 interior;
+            std::vector<ObjectPtr>          objects;            ///< Top-level objects containing the SSLT objects.
+            Vector3d                        center;             ///< Center of the bounding sphere.
+            double                          radius;             ///< Radius of the bounding sphere.
+            double                          eta;                ///< Relative index of refraction.
+            size_t                          lineCount;          ///< Number of lines to shoot.
+            double                          sampleArea;         ///< Surface area represented by each sample, in mm^2.
+            IndexedVectorGeneratorPtr       directionGenerator; ///< Source of the line directions.
+            IndexedVector2dGeneratorPtr     discGenerator;      ///< Source of the line offsets from the center.
+        };
+
+        SubsurfaceCacheBuilder(const SceneData& sceneData);
+
+        /// Gets the next chunk of lines to process.
+        ///
+        /// @param[out] job     Index of the job the chunk belongs to.
+        /// @param[out] first   Index of the first line in the chunk.
+        /// @param[out] count   Number of lines in the chunk.
+        /// @return             `false` if no lines are left to process.
+        ///
+        bool GetNextChunk(size_t& job, size_t& first, size_t& count);
+
+        const Job& GetJob(size_t job) const { return mJobs[job]; }
+
+        /// Adds the samples computed for a chunk of lines.
+        ///
+        /// @note   The samples are taken over, leaving the vector empty.
+        ///
+        void AddSamples(size_t job, size_t first, std::vector<Sample>& samples);
+
+        /// Builds the caches from the samples, and stores them in a table.
+        void Finish(SubsurfaceCacheTable& table, double mmPerUnit);
+
+    private:
+
+        static const size_t kChunkSize = 1024;
+
+        std::vector<Job>                                    mJobs;
+        std::vector<size_t>                                 mChunkEnd;  ///< Cumulative number of chunks up to and including each job.
+        std::vector<std::map<size_t, std::vector<Sample>>>  mSamples;   ///< Samples of each job, by first line of chunk.
+        std::atomic<size_t>                                 mNextChunk;
+        std::mutex                                          mMutex;
+};
+
 /// @}
 ///
 //##############################################################################
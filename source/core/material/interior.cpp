@@ -105,6 +105,12 @@ void Interior::PostProcess()
         i->PostProcess();
 }
 
+void Interior::PrepareDensityGrids(const Vector3d& lo, const Vector3d& hi)
+{
+    for(std::vector<Media>::iterator i(media.begin());i != media.end(); i++)
+        i->PrepareDensityGrid(lo, hi);
+}
+
 /*****************************************************************************
 *
 * FUNCTION
@@ -37,13 +37,13 @@
 #include "core/material/media.h"
 
 // C++ variants of C standard header files
-//  (none at the moment)
+#include <cmath>
 
 // C++ standard header files
 #include <algorithm>
 
 // POV-Ray header files (base module)
-//  (none at the moment)
+#include "base/mathutil.h"
 
 // POV-Ray header files (core module)
 #include "core/lighting/lightsource.h"
@@ -100,6 +100,8 @@ Media::Media()
     AA_Threshold = 0.1;
     AA_Level = 3;
     Jitter = 0.0;
+
+    Density_Grid_Resolution = 0;
 }
 
 Media::Media(const Media& source)
@@ -145,6 +147,9 @@ Media& Media::operator=(const Media& source)
         Variance = source.Variance;
         AA_Threshold = source.AA_Threshold;
         AA_Level = source.AA_Level;
+        Density_Grid_Resolution = source.Density_Grid_Resolution;
+        // (the copied density pigments are identical, so the grid can be shared)
+        densityGrid = source.densityGrid;
 
         if (Sample_Threshold != nullptr)
             delete[] Sample_Threshold;
@@ -175,6 +180,7 @@ Media& Media::operator=(const Media& source)
 void Media::Transform(const TRANSFORM *Trans)
 {
     Transform_Density(Density, Trans);
+    densityGrid.reset();
 }
 
 void Media::PostProcess()
@@ -220,12 +226,286 @@ void Media::PostProcess()
         Post_Pigment(*i);
 }
 
+void Media::PrepareDensityGrid(const Vector3d& lo, const Vector3d& hi)
+{
+    if ((Density_Grid_Resolution <= 0) || Density.empty())
+        return;
+
+    Vector3d gridLo(lo), gridHi(hi);
+    if (densityGrid != nullptr)
+    {
+        for (int axis = X; axis <= Z; axis++)
+        {
+            gridLo[axis] = min(gridLo[axis], densityGrid->GetMin()[axis]);
+            gridHi[axis] = max(gridHi[axis], densityGrid->GetMax()[axis]);
+        }
+    }
+
+    // the grid is of no use for unbounded media
+    for (int axis = X; axis <= Z; axis++)
+        if (!(gridHi[axis] - gridLo[axis] <= CRITICAL_LENGTH))
+            return;
+
+    densityGrid = std::make_shared<MediaDensityGrid>(gridLo, gridHi, Density_Grid_Resolution);
+}
+
 void Transform_Density(vector<PIGMENT*>& Density, const TRANSFORM *Trans)
 {
     for (vector<PIGMENT*>::iterator i = Density.begin(); i != Density.end(); ++ i)
         Transform_Tpattern(*i, Trans);
 }
 
+MediaDensityGrid::MediaDensityGrid(const Vector3d& lo, const Vector3d& hi, int resolution) :
+    mReady(false),
+    mFailed(false),
+    mNextSlice(0),
+    mSlicesDone(0)
+{
+    // pad the grid a bit, so that rays through the container object do not start just outside
+    Vector3d size = hi - lo;
+    Vector3d padding = size * 1.0e-4 + Vector3d(EPSILON);
+    mLo = lo - padding;
+    mHi = hi + padding;
+    size = mHi - mLo;
+
+    double maxSize = max(size[X], max(size[Y], size[Z]));
+    for (int axis = X; axis <= Z; axis++)
+    {
+        mCells[axis]       = max(1, int(ceil(resolution * size[axis] / maxSize)));
+        mCellSize[axis]    = size[axis] / mCells[axis];
+        mInvCellSize[axis] = 1.0 / mCellSize[axis];
+        mBlocks[axis]      = (mCells[axis] + kBlockCells - 1) / kBlockCells;
+    }
+}
+
+bool MediaDensityGrid::Fill(vector<PIGMENT*>& density, TraceThreadData *ttd)
+{
+    if (mReady.load(std::memory_order_acquire))
+        return true;
+    if (mFailed.load(std::memory_order_acquire))
+        return false;
+
+    int slices = mCells[Z] + 1;
+
+    try
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mNodes.empty() && !mReady.load(std::memory_order_relaxed) && !mFailed.load(std::memory_order_relaxed))
+                mNodes.resize(size_t(mCells[X] + 1) * (mCells[Y] + 1) * slices);
+        }
+
+        // help filling slices of the grid until there are none left
+        int z;
+        while (!mFailed.load(std::memory_order_relaxed) && ((z = mNextSlice.fetch_add(1)) < slices))
+        {
+            for (int y = 0; y <= mCells[Y]; y++)
+            {
+                for (int x = 0; x <= mCells[X]; x++)
+                {
+                    Vector3d p(mLo[X] + x * mCellSize[X], mLo[Y] + y * mCellSize[Y], mLo[Z] + z * mCellSize[Z]);
+                    Evaluate_Density_Pigment(density, p, mNodes[NodeIndex(x, y, z)], ttd);
+                }
+            }
+
+            if (mSlicesDone.fetch_add(1) + 1 == slices)
+            {
+                // this thread has filled the last slice; finish up and release the other threads
+                ComputeBlockMax();
+                std::lock_guard<std::mutex> lock(mMutex);
+                mReady.store(true, std::memory_order_release);
+                mCondition.notify_all();
+            }
+        }
+    }
+    catch (...)
+    {
+        // the grid will never be complete; don't leave the other threads waiting for it
+        Abandon();
+        throw;
+    }
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCondition.wait(lock, [this]() { return mReady.load(std::memory_order_relaxed) || mFailed.load(std::memory_order_relaxed); });
+    return mReady.load(std::memory_order_relaxed);
+}
+
+void MediaDensityGrid::Abandon()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mFailed.store(true, std::memory_order_release);
+    mCondition.notify_all();
+}
+
+void MediaDensityGrid::ComputeBlockMax()
+{
+    mBlockMax.assign(size_t(mBlocks[X]) * mBlocks[Y] * mBlocks[Z], 0.0f);
+
+    for (int bz = 0; bz < mBlocks[Z]; bz++)
+    {
+        for (int by = 0; by < mBlocks[Y]; by++)
+        {
+            for (int bx = 0; bx < mBlocks[X]; bx++)
+            {
+                // the density within a cell never exceeds that at its corners, so examining the nodes will do
+                float blockMax = 0.0f;
+                for (int z = bz * kBlockCells; z <= min((bz + 1) * kBlockCells, mCells[Z]); z++)
+                    for (int y = by * kBlockCells; y <= min((by + 1) * kBlockCells, mCells[Y]); y++)
+                        for (int x = bx * kBlockCells; x <= min((bx + 1) * kBlockCells, mCells[X]); x++)
+                        {
+                            const MathColour& node = mNodes[NodeIndex(x, y, z)];
+                            for (int i = 0; i < MathColour::channels; i++)
+                                blockMax = max(blockMax, float(fabs(node[i])));
+                        }
+                mBlockMax[(size_t(bz) * mBlocks[Y] + by) * mBlocks[X] + bx] = blockMax;
+            }
+        }
+    }
+}
+
+void MediaDensityGrid::Evaluate(vector<PIGMENT*>& density, const Vector3d& p, MathColour& c, TraceThreadData *ttd)
+{
+    if (!Fill(density, ttd))
+    {
+        Evaluate_Density_Pigment(density, p, c, ttd);
+        return;
+    }
+
+    Vector3d g = (p - mLo) * mInvCellSize;
+    int i[3];
+    double f[3];
+    for (int axis = X; axis <= Z; axis++)
+    {
+        if (!((g[axis] >= 0.0) && (g[axis] <= mCells[axis])))
+        {
+            Evaluate_Density_Pigment(density, p, c, ttd);
+            return;
+        }
+        i[axis] = min(int(g[axis]), mCells[axis] - 1);
+        f[axis] = g[axis] - i[axis];
+    }
+
+    const MathColour& c000 = mNodes[NodeIndex(i[X],     i[Y],     i[Z])];
+    const MathColour& c100 = mNodes[NodeIndex(i[X] + 1, i[Y],     i[Z])];
+    const MathColour& c010 = mNodes[NodeIndex(i[X],     i[Y] + 1, i[Z])];
+    const MathColour& c110 = mNodes[NodeIndex(i[X] + 1, i[Y] + 1, i[Z])];
+    const MathColour& c001 = mNodes[NodeIndex(i[X],     i[Y],     i[Z] + 1)];
+    const MathColour& c101 = mNodes[NodeIndex(i[X] + 1, i[Y],     i[Z] + 1)];
+    const MathColour& c011 = mNodes[NodeIndex(i[X],     i[Y] + 1, i[Z] + 1)];
+    const MathColour& c111 = mNodes[NodeIndex(i[X] + 1, i[Y] + 1, i[Z] + 1)];
+
+    MathColour c00 = c000 + (c100 - c000) * f[X];
+    MathColour c10 = c010 + (c110 - c010) * f[X];
+    MathColour c01 = c001 + (c101 - c001) * f[X];
+    MathColour c11 = c011 + (c111 - c011) * f[X];
+    MathColour c0  = c00  + (c10  - c00)  * f[Y];
+    MathColour c1  = c01  + (c11  - c01)  * f[Y];
+    c = c0 + (c1 - c0) * f[Z];
+}
+
+void MediaDensityGrid::FindOccupiedRanges(vector<PIGMENT*>& density, const BasicRay& ray, DBL depth, RangeVector& ranges, TraceThreadData *ttd)
+{
+    ranges.clear();
+
+    if (!Fill(density, ttd))
+    {
+        ranges.push_back(Range(0.0, depth));
+        return;
+    }
+
+    // clip the ray against the grid
+    DBL tEnter = 0.0;
+    DBL tExit  = depth;
+    for (int axis = X; axis <= Z; axis++)
+    {
+        DBL o = ray.Origin[axis];
+        DBL d = ray.Direction[axis];
+        if (fabs(d) < EPSILON)
+        {
+            if ((o < mLo[axis]) || (o > mHi[axis]))
+                tExit = -1.0;
+        }
+        else
+        {
+            DBL t0 = (mLo[axis] - o) / d;
+            DBL t1 = (mHi[axis] - o) / d;
+            if (t0 > t1)
+                std::swap(t0, t1);
+            tEnter = max(tEnter, t0);
+            tExit  = min(tExit, t1);
+        }
+    }
+
+    if (tEnter >= tExit)
+    {
+        // ray misses the grid entirely
+        ranges.push_back(Range(0.0, depth));
+        return;
+    }
+
+    // outside the grid we know nothing about the density
+    if (tEnter > 0.0)
+        ranges.push_back(Range(0.0, tEnter));
+
+    // walk the blocks along the ray
+    Vector3d blockSize = mCellSize * DBL(kBlockCells);
+    Vector3d p = ray.Evaluate(tEnter);
+    int b[3], step[3];
+    DBL tNext[3], tDelta[3];
+    for (int axis = X; axis <= Z; axis++)
+    {
+        b[axis] = clip(int((p[axis] - mLo[axis]) / blockSize[axis]), 0, mBlocks[axis] - 1);
+        DBL d = ray.Direction[axis];
+        if (d > EPSILON)
+        {
+            step[axis]   = 1;
+            tNext[axis]  = tEnter + (mLo[axis] + (b[axis] + 1) * blockSize[axis] - p[axis]) / d;
+            tDelta[axis] = blockSize[axis] / d;
+        }
+        else if (d < -EPSILON)
+        {
+            step[axis]   = -1;
+            tNext[axis]  = tEnter + (mLo[axis] + b[axis] * blockSize[axis] - p[axis]) / d;
+            tDelta[axis] = -blockSize[axis] / d;
+        }
+        else
+        {
+            step[axis]   = 0;
+            tNext[axis]  = HUGE_VAL;
+            tDelta[axis] = HUGE_VAL;
+        }
+    }
+
+    DBL t = tEnter;
+    while (t < tExit)
+    {
+        int axis = (tNext[X] < tNext[Y]) ? ((tNext[X] < tNext[Z]) ? X : Z) : ((tNext[Y] < tNext[Z]) ? Y : Z);
+        DBL tBlockExit = min(tNext[axis], tExit);
+
+        if (mBlockMax[(size_t(b[Z]) * mBlocks[Y] + b[Y]) * mBlocks[X] + b[X]] > 0.0f)
+        {
+            if (!ranges.empty() && (ranges.back().second >= t))
+                ranges.back().second = tBlockExit;
+            else
+                ranges.push_back(Range(t, tBlockExit));
+        }
+
+        t = tBlockExit;
+        b[axis] += step[axis];
+        if ((b[axis] < 0) || (b[axis] >= mBlocks[axis]))
+            break;
+        tNext[axis] += tDelta[axis];
+    }
+
+    if (tExit < depth)
+    {
+        if (!ranges.empty() && (ranges.back().second >= tExit))
+            ranges.back().second = depth;
+        else
+            ranges.push_back(Range(tExit, depth));
+    }
+}
+
 MediaFunction::MediaFunction(TraceThreadData *td, Trace *t, PhotonGatherer *pg) :
     randomNumbers(0.0, 1.0, 32768),
     randomNumberGenerator(&randomNumbers),
@@ -352,6 +632,8 @@ void MediaFunction::ComputeMedia(MediaVector& medias, const Ray& ray, Intersecti
                                  isect.Depth - mediaintervals.back().s1,
                                  0, 0));
 
+    ComputeMediaOccupiedIntervals(medias, mediaintervals, ray, isect.Depth);
+
     minSamples = IMedia->Min_Samples;
 
     // Sample all intervals.
@@ -524,6 +806,67 @@ void MediaFunction::ComputeMediaColour(MediaIntervalVector& mediaintervals, Math
     transm *= Od.Greyscale(); // TODO - in the long run, we should make transm a full-fledged RGB term
 }
 
+void MediaFunction::ComputeMediaOccupiedIntervals(MediaVector& medias, MediaIntervalVector& mediaintervals, const Ray& ray, DBL depth)
+{
+    // Empty space can only be skipped if the density of all media is known.
+    for(MediaVector::iterator i(medias.begin()); i != medias.end(); i++)
+    {
+        if((*i)->densityGrid == nullptr)
+            return;
+    }
+
+    // Find the sections of the ray where any media may have a non-zero density.
+    MediaDensityGrid::RangeVector occupied;
+    for(MediaVector::iterator i(medias.begin()); i != medias.end(); i++)
+    {
+        MediaDensityGrid::RangeVector ranges;
+        (*i)->densityGrid->FindOccupiedRanges((*i)->Density, ray, depth, ranges, threadData);
+        if(occupied.empty())
+            occupied.swap(ranges);
+        else
+        {
+            occupied.insert(occupied.end(), ranges.begin(), ranges.end());
+            std::sort(occupied.begin(), occupied.end());
+            size_t n = 0;
+            for(size_t j = 1; j < occupied.size(); j++)
+            {
+                if(occupied[j].first <= occupied[n].second)
+                    occupied[n].second = max(occupied[n].second, occupied[j].second);
+                else
+                    occupied[++n] = occupied[j];
+            }
+            occupied.resize(n + 1);
+        }
+    }
+
+    // Shrink each interval to the occupied sections within, and drop intervals that are entirely empty.
+    // Since the density elsewhere in the interval is zero, this does not change the result.
+    size_t n = 0;
+    MediaDensityGrid::RangeVector::const_iterator r(occupied.begin());
+    for(MediaIntervalVector::iterator i(mediaintervals.begin()); i != mediaintervals.end(); i++)
+    {
+        while((r != occupied.end()) && (r->second <= i->s0))
+            r++;
+
+        DBL s0 = HUGE_VAL, s1 = -HUGE_VAL;
+        for(MediaDensityGrid::RangeVector::const_iterator j(r); (j != occupied.end()) && (j->first < i->s1); j++)
+        {
+            s0 = min(s0, max(i->s0, j->first));
+            s1 = max(s1, min(i->s1, j->second));
+        }
+
+        if(s1 > s0)
+        {
+            i->s0 = s0;
+            i->s1 = s1;
+            i->ds = s1 - s0;
+            mediaintervals[n++] = *i;
+        }
+    }
+    while(mediaintervals.size() > n)
+        mediaintervals.pop_back();
+}
+
 void MediaFunction::ComputeMediaSampleInterval(LitIntervalVector& litintervals, MediaIntervalVector& mediaintervals, const Media *media)
 {
     size_t i, j, n, r, remaining, intervals;
@@ -954,7 +1297,10 @@ void MediaFunction::ComputeOneMediaSample(MediaVector& medias, LightSourceEntryV
     {
         P = H;
 
-        Evaluate_Density_Pigment((*i)->Density, P, C0, threadData);
+        if ((*i)->densityGrid != nullptr)
+            (*i)->densityGrid->Evaluate((*i)->Density, P, C0, threadData);
+        else
+            Evaluate_Density_Pigment((*i)->Density, P, C0, threadData);
 
         Extinction += C0 * (*i)->Extinction;
 
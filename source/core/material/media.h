@@ -43,6 +43,10 @@
 //  (none at the moment)
 
 // C++ standard header files
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <utility>
 #include <vector>
 
 // POV-Ray header files (base module)
@@ -74,6 +78,76 @@ enum
 
 void Transform_Density(std::vector<PIGMENT*>& Density, const TRANSFORM *Trans);
 
+/// Cached density of a media on a regular grid.
+///
+/// The grid stores the density pigment stack's colour at each grid node, to be interpolated trilinearly, plus the
+/// maximum density within each block of cells, used to skip empty space along a ray.
+///
+/// The grid is filled on first use, by all threads that need it at that time; each thread fills whole slices of the
+/// grid until none are left.
+///
+class MediaDensityGrid final
+{
+    public:
+
+        typedef std::pair<DBL, DBL> Range;
+        typedef std::vector<Range> RangeVector;
+
+        /// Largest resolution supported, keeping the grid to some 200 MiB.
+        static const int kMaxResolution = 256;
+
+        MediaDensityGrid(const Vector3d& lo, const Vector3d& hi, int resolution);
+
+        const Vector3d& GetMin() const { return mLo; }
+        const Vector3d& GetMax() const { return mHi; }
+
+        /// Get the density at a given point.
+        ///
+        /// Points outside the grid, or all points if the grid could not be filled, are evaluated from the density
+        /// pigments.
+        ///
+        void Evaluate(std::vector<PIGMENT*>& density, const Vector3d& p, MathColour& c, TraceThreadData *ttd);
+
+        /// Find the sections of a ray where the density may be non-zero.
+        ///
+        /// @param[in]      density     Density pigments to fill the grid from.
+        /// @param[in]      ray         The ray.
+        /// @param[in]      depth       Length of the section of the ray to examine.
+        /// @param[out]     ranges      Sorted list of non-overlapping ranges of the ray. Sections outside the grid are
+        ///                             always included, as is the whole ray if the grid could not be filled.
+        /// @param[in]      ttd         Thread data.
+        ///
+        void FindOccupiedRanges(std::vector<PIGMENT*>& density, const BasicRay& ray, DBL depth, RangeVector& ranges, TraceThreadData *ttd);
+
+    private:
+
+        static const int kBlockCells = 4;
+
+        Vector3d                mLo, mHi;
+        Vector3d                mCellSize;
+        Vector3d                mInvCellSize;
+        int                     mCells[3];
+        int                     mBlocks[3];
+        std::vector<MathColour> mNodes;
+        std::vector<float>      mBlockMax;
+
+        std::atomic<bool>       mReady;
+        std::atomic<bool>       mFailed;
+        std::atomic<int>        mNextSlice;
+        std::atomic<int>        mSlicesDone;
+        std::mutex              mMutex;
+        std::condition_variable mCondition;
+
+        bool Fill(std::vector<PIGMENT*>& density, TraceThreadData *ttd);
+        void Abandon();
+        void ComputeBlockMax();
+
+        inline size_t NodeIndex(int x, int y, int z) const
+        {
+            return (size_t(z) * (mCells[Y] + 1) + y) * (mCells[X] + 1) + x;
+        }
+};
+
 class MediaFunction : public Trace::MediaFunctor
 {
     public:
@@ -100,6 +174,7 @@ class MediaFunction : public Trace::MediaFunctor
         void ComputeMediaAdaptiveSampling(MediaVector& medias, LightSourceEntryVector& lights, MediaIntervalVector& mediaintervals,
                                           const Ray& ray, const Media *IMedia, DBL aa_threshold, int minsamples, bool ignore_photons, bool use_scattering);
         void ComputeMediaColour(MediaIntervalVector& mediaintervals, MathColour& colour, ColourChannel& transm);
+        void ComputeMediaOccupiedIntervals(MediaVector& medias, MediaIntervalVector& mediaintervals, const Ray& ray, DBL depth);
         void ComputeMediaSampleInterval(LitIntervalVector& litintervals, MediaIntervalVector& mediaintervals, const Media *media);
         void ComputeMediaLightInterval(LightSourceEntryVector& lights, LitIntervalVector& litintervals, const Ray& ray, const Intersection& isect);
         void ComputeOneMediaLightInterval(LightSource *light, LightSourceEntryVector&lights, const Ray& ray, const Intersection& isect);
@@ -516,6 +516,7 @@ SolidDNoise(const Vector3d& P, Vector3d& D)
 *
 * CHANGES
 *   ??? ???? : Updated with varible Octaves, Lambda, & Omega by [DMF]
+*   Oct 2026 : All octaves are now evaluated with a single call to MultiNoise.
 *
 ******************************************************************************/
 
@@ -523,46 +524,57 @@ DBL Turbulence(const Vector3d& EPoint, const GenericTurbulenceWarp *Turb, int no
 {
     int i;
     DBL Lambda, Omega, l, o, value;
-    Vector3d temp;
+    DBL scale[kMaxTurbulenceOctaves];
+    DBL noise[kMaxTurbulenceOctaves];
     int Octaves=Turb->Octaves;
 
+    POV_CORE_ASSERT((Octaves >= 1) && (Octaves <= kMaxTurbulenceOctaves));
+
+    /* Evaluate the noise for all octaves in one go. */
+
+    scale[0] = 1.0;
+
+    l = Lambda = Turb->Lambda;
+
+    for (i = 1; i < Octaves; i++)
+    {
+        scale[i] = l;
+        l *= Lambda;
+    }
+
+    MultiNoise(noise, EPoint, scale, Octaves, noise_generator);
+
     // TODO - This distinction (with minor variations that seem to be more of an inconsistency rather than intentional)
     // appears in other places as well; make it a function.
     switch(noise_generator)
     {
         case kNoiseGen_Default:
         case kNoiseGen_Original:
-            value = Noise(EPoint, noise_generator);
+            value = noise[0];
             break;
         default:
-            value = (2.0 * Noise(EPoint, noise_generator) - 0.5);
+            value = (2.0 * noise[0] - 0.5);
             value = min(max(value,0.0),1.0);
             break;
     }
 
-    l = Lambda = Turb->Lambda;
     o = Omega  = Turb->Omega;
 
-    for (i = 2; i <= Octaves; i++)
+    for (i = 1; i < Octaves; i++)
     {
-        temp = EPoint * l;
         // TODO - This distinction (with minor variations that seem to be more of an inconsistency rather than intentional)
         // appears in other places as well; make it a function.
         switch(noise_generator)
         {
             case kNoiseGen_Default:
             case kNoiseGen_Original:
-                value += o * Noise(temp, noise_generator);
+                value += o * noise[i];
                 break;
             default:
-                value += o * (2.0 * Noise(temp, noise_generator) - 0.5); // TODO similar code clips the (2.0 * Noise(temp, noise_generator) - 0.5) term
+                value += o * (2.0 * noise[i] - 0.5); // TODO similar code clips the (2.0 * Noise(temp, noise_generator) - 0.5) term
                 break;
         }
-        if (i < Octaves)
-        {
-            l *= Lambda;
-            o *= Omega;
-        }
+        o *= Omega;
     }
     return (value);
 }
@@ -595,6 +607,7 @@ DBL Turbulence(const Vector3d& EPoint, const GenericTurbulenceWarp *Turb, int no
 *
 * CHANGES
 *   ??? ???? : Updated with varible Octaves, Lambda, & Omega by [DMF]
+*   Oct 2026 : All octaves are now evaluated with a single call to MultiDNoise.
 *
 ******************************************************************************/
 
@@ -604,28 +617,34 @@ void DTurbulence(Vector3d& result, const Vector3d& EPoint, const GenericTurbulen
     DBL Omega, Lambda;
     int i;
     DBL l, o;
-    Vector3d value, temp;
+    DBL scale[kMaxTurbulenceOctaves];
+    Vector3d value[kMaxTurbulenceOctaves];
     int Octaves=Turb->Octaves;
 
-    result[X] = result[Y] = result[Z] = 0.0;
-    value[X]  = value[Y]  = value[Z]  = 0.0;
+    POV_CORE_ASSERT((Octaves >= 1) && (Octaves <= kMaxTurbulenceOctaves));
+
+    /* Evaluate the noise for all octaves in one go. */
 
-    DNoise(result, EPoint);
+    scale[0] = 1.0;
 
     l = Lambda = Turb->Lambda;
-    o = Omega  = Turb->Omega;
 
-    for (i = 2; i <= Octaves; i++)
+    for (i = 1; i < Octaves; i++)
     {
-        temp = EPoint * l;
+        scale[i] = l;
+        l *= Lambda;
+    }
 
-        DNoise(value, temp);
-        result += o * value;
-        if (i < Octaves)
-        {
-            l *= Lambda;
-            o *= Omega;
-        }
+    MultiDNoise(value, EPoint, scale, Octaves);
+
+    result = value[0];
+
+    o = Omega  = Turb->Omega;
+
+    for (i = 1; i < Octaves; i++)
+    {
+        result += o * value[i];
+        o *= Omega;
     }
 }
 
@@ -634,6 +653,22 @@ void DTurbulence(Vector3d& result, const Vector3d& EPoint, const GenericTurbulen
 
 NoiseFunction Noise;
 DNoiseFunction DNoise;
+MultiNoiseFunction MultiNoise;
+MultiDNoiseFunction MultiDNoise;
+
+/// Multi-point noise for implementations that provide single-point noise only.
+static void GenericMultiNoise(DBL *result, const Vector3d& EPoint, const DBL *scale, int count, int noise_generator)
+{
+    for (int i = 0; i < count; i++)
+        result[i] = Noise(EPoint * scale[i], noise_generator);
+}
+
+/// Multi-point vector-valued noise for implementations that provide single-point noise only.
+static void GenericMultiDNoise(Vector3d *result, const Vector3d& EPoint, const DBL *scale, int count)
+{
+    for (int i = 0; i < count; i++)
+        DNoise(result[i], EPoint * scale[i]);
+}
 
 /*****************************************************************************
 *
@@ -675,6 +710,8 @@ void Initialise_NoiseDispatch()
         if (pNoiseImpl->init) pNoiseImpl->init();
         Noise = pNoiseImpl->noise;
         DNoise = pNoiseImpl->dNoise;
+        MultiNoise = (pNoiseImpl->multiNoise != nullptr ? pNoiseImpl->multiNoise : GenericMultiNoise);
+        MultiDNoise = (pNoiseImpl->multiDNoise != nullptr ? pNoiseImpl->multiDNoise : GenericMultiDNoise);
     }
 }
 
@@ -686,7 +723,9 @@ OptimizedNoiseInfo gPortableNoiseInfo = {
     nullptr,        // enabled,
     nullptr,        // supported,
     nullptr,        // recommended,
-    nullptr         // init
+    nullptr,        // init,
+    nullptr,        // multiNoise,
+    nullptr         // multiDNoise
 };
 
 const OptimizedNoiseInfo* GetRecommendedOptimizedNoise()
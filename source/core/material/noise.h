@@ -121,6 +121,20 @@ void PortableDNoise(Vector3d& result, const Vector3d& EPoint);
 typedef DBL(*NoiseFunction) (const Vector3d& EPoint, int noise_generator);
 typedef void(*DNoiseFunction) (Vector3d& result, const Vector3d& EPoint);
 
+/// Function to evaluate noise at several scaled copies of a point at once.
+///
+/// Implementations must be equivalent to setting `result[i] = Noise(EPoint * scale[i], noise_generator)`
+/// for each `i` from 0 to `count-1`, as needed for the octaves of fractal noise.
+///
+typedef void(*MultiNoiseFunction) (DBL *result, const Vector3d& EPoint, const DBL *scale, int count, int noise_generator);
+
+/// Function to evaluate vector-valued noise at several scaled copies of a point at once.
+///
+/// Implementations must be equivalent to calling `DNoise(result[i], EPoint * scale[i])`
+/// for each `i` from 0 to `count-1`, as needed for the octaves of fractal noise.
+///
+typedef void(*MultiDNoiseFunction) (Vector3d *result, const Vector3d& EPoint, const DBL *scale, int count);
+
 /// Optimized noise dispatch information.
 struct OptimizedNoiseInfo final
 {
@@ -163,6 +177,14 @@ struct OptimizedNoiseInfo final
     /// Pointer to the initialization function.
     /// A value of `nullptr` indicates that initialization is not required.
     void(*init)();
+
+    /// Pointer to the optimized multi-point noise function.
+    /// A value of `nullptr` indicates that @ref noise is to be called for each point instead.
+    MultiNoiseFunction multiNoise;
+
+    /// Pointer to the optimized multi-point vector-valued noise function.
+    /// A value of `nullptr` indicates that @ref dNoise is to be called for each point instead.
+    MultiDNoiseFunction multiDNoise;
 };
 
 /// Optimized noise dispatch table.
@@ -188,6 +210,8 @@ const OptimizedNoiseInfo* GetOptimizedNoise(const std::string& name);
 
 extern NoiseFunction Noise;
 extern DNoiseFunction DNoise;
+extern MultiNoiseFunction MultiNoise;
+extern MultiDNoiseFunction MultiDNoise;
 
 void Initialise_NoiseDispatch();
 
@@ -195,9 +219,24 @@ void Initialise_NoiseDispatch();
 
 inline DBL Noise(const Vector3d& EPoint, int noise_generator) { return PortableNoise(EPoint, noise_generator); }
 inline void DNoise(Vector3d& result, const Vector3d& EPoint) { PortableDNoise(result, EPoint); }
+inline void MultiNoise(DBL *result, const Vector3d& EPoint, const DBL *scale, int count, int noise_generator)
+{
+    for (int i = 0; i < count; i++)
+        result[i] = PortableNoise(EPoint * scale[i], noise_generator);
+}
+inline void MultiDNoise(Vector3d *result, const Vector3d& EPoint, const DBL *scale, int count)
+{
+    for (int i = 0; i < count; i++)
+        PortableDNoise(result[i], EPoint * scale[i]);
+}
 
 #endif // TRY_OPTIMIZED_NOISE
 
+/// Maximum number of octaves supported by @ref Turbulence() and @ref DTurbulence().
+/// @note
+///     The parser limits the number of octaves accordingly.
+const int kMaxTurbulenceOctaves = 10;
+
 DBL Turbulence (const Vector3d& EPoint, const GenericTurbulenceWarp* Turb, int noise_generator);
 void DTurbulence (Vector3d& result, const Vector3d& EPoint, const GenericTurbulenceWarp* Turb);
 
@@ -324,20 +324,20 @@ static void dents (const Vector3d& EPoint, const TNORMAL *Tnormal, Vector3d& nor
 
 static void wrinkles (const Vector3d& EPoint, const TNORMAL *Tnormal, Vector3d& normal)
 {
+    static const DBL scale[10] = { 1.0, 2.0, 4.0, 8.0, 16.0, 32.0, 64.0, 128.0, 256.0, 512.0 };
+
     int i;
-    DBL scale = 1.0;
-    Vector3d result, value, value2;
+    Vector3d result, value[10];
 
     result = Vector3d(0.0, 0.0, 0.0);
 
-    for (i = 0; i < 10; scale *= 2.0, i++)
-    {
-        value2 = EPoint * scale;
-        DNoise(value, value2);
+    MultiDNoise(value, EPoint, scale, 10);
 
-        result[X] += fabs(value[X] / scale);
-        result[Y] += fabs(value[Y] / scale);
-        result[Z] += fabs(value[Z] / scale);
+    for (i = 0; i < 10; i++)
+    {
+        result[X] += fabs(value[i][X] / scale[i]);
+        result[Y] += fabs(value[i][Y] / scale[i]);
+        result[Z] += fabs(value[i][Z] / scale[i]);
     }
 
     /* Displace "normal". */
@@ -861,7 +861,7 @@ void Perturb_Normal(Vector3d& Layer_Normal, const TNORMAL *Tnormal, const Vector
 
         switch (Tnormal->Type)
         {
-            case BITMAP_PATTERN:    bump_map    (TPoint, Tnormal, Layer_Normal);            break;
+            case BITMAP_PATTERN:    bump_map    (TPoint, Tnormal, Layer_Normal, GetFilterSize(Tnormal->pattern->warps, Intersection, ray)); break;
             case BUMPS_PATTERN:     bumps       (TPoint, Tnormal, Layer_Normal);            break;
             case DENTS_PATTERN:     dents       (TPoint, Tnormal, Layer_Normal, Thread);    break;
             case RIPPLES_PATTERN:   ripples     (TPoint, Tnormal, Layer_Normal, Thread);    break;
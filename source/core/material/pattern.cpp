@@ -43,7 +43,7 @@
 #include "core/material/pattern.h"
 
 // C++ variants of C standard header files
-//  (none at the moment)
+#include <cmath>
 
 // C++ standard header files
 #include <algorithm>
@@ -62,6 +62,7 @@
 #include "core/math/matrix.h"
 #include "core/math/randomsequence.h"
 #include "core/render/ray.h"
+#include "core/render/trace.h"
 #include "core/scene/object.h"
 #include "core/scene/scenedata.h"
 #include "core/scene/tracethreaddata.h"
@@ -490,6 +491,31 @@ bool ColourFunctionPattern::HasTransparency() const
 }
 
 
+DBL GetFilterSize(const WarpList& warps, const Intersection *pIsection, const Ray *pRay)
+{
+    if ((pIsection == nullptr) || (pRay == nullptr))
+        return 0.0;
+
+    const TraceTicket& ticket = pRay->GetTicket();
+    DBL size = ticket.pixelFootprint + ticket.pixelSpread * pIsection->Depth;
+
+    // Account for any scaling of the pattern.
+    for (WarpList::const_iterator iWarp = warps.begin(); (size > 0.0) && (iWarp != warps.end()); ++iWarp)
+    {
+        const TransformWarp *pTransform = dynamic_cast<const TransformWarp*>(*iWarp);
+        if (pTransform != nullptr)
+        {
+            const MATRIX& m = pTransform->Trans.inverse;
+            DBL det = m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+                    - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+                    + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+            size *= cbrt(fabs(det));
+        }
+    }
+
+    return size;
+}
+
 bool ColourImagePattern::Evaluate(TransColour& result, const Vector3d& EPoint, const Intersection *pIsection, const Ray *pRay, TraceThreadData *pThread) const
 {
     // TODO ALPHA - the caller does expect non-premultiplied data, but maybe he could profit from premultiplied data?
@@ -507,7 +533,10 @@ bool ColourImagePattern::Evaluate(TransColour& result, const Vector3d& EPoint, c
     else
     {
         RGBFTColour rgbft;
-        image_colour_at(pImage, xcoor, ycoor, rgbft, &reg_number, false);
+        DBL footprint = 0.0;
+        if (!pImage->MipLevels.empty())
+            footprint = image_footprint(EPoint, pImage, xcoor, ycoor, GetFilterSize(warps, pIsection, pRay));
+        image_colour_at(pImage, xcoor, ycoor, rgbft, &reg_number, false, footprint);
         result = ToTransColour(rgbft);
         return true;
     }
@@ -578,7 +607,9 @@ unsigned int HexagonPattern::NumDiscreteBlendMapEntries() const { return 3; }
 
 DBL ImagePattern::EvaluateRaw(const Vector3d& EPoint, const Intersection *pIsection, const Ray *pRay, TraceThreadData *pThread) const
 {
-    return image_pattern(EPoint, this);
+    if (pImage->MipLevels.empty())
+        return image_pattern(EPoint, this);
+    return image_pattern(EPoint, this, GetFilterSize(warps, pIsection, pRay));
 }
 
 
@@ -6428,36 +6459,39 @@ DBL GradientPattern::EvaluateRaw(const Vector3d& EPoint, const Intersection *pIs
 
 DBL GranitePattern::EvaluateRaw(const Vector3d& EPoint, const Intersection *pIsection, const Ray *pRay, TraceThreadData *pThread) const
 {
+    static const DBL freq[6] = { 1.0, 2.0, 4.0, 8.0, 16.0, 32.0 };
+
     int noise_generator = GetNoiseGen(pThread);
 
     int i;
-    DBL temp, noise = 0.0, freq = 1.0;
-    Vector3d tv1, tv2;
+    DBL temp, noise = 0.0;
+    DBL octave[6];
+    Vector3d tv1;
 
     tv1 = EPoint * 4.0;
 
-    for (i = 0; i < 6; freq *= 2.0, i++)
-    {
-        tv2 = tv1 * freq;
+    MultiNoise(octave, tv1, freq, 6, noise_generator);
 
+    for (i = 0; i < 6; i++)
+    {
         // TODO - This distinction (with minor variations that seem to be more of an inconsistency rather than intentional)
         // appears in other places as well; make it a function.
         switch (noise_generator)
         {
             case kNoiseGen_Default:
             case kNoiseGen_Original:
-                temp = 0.5 - Noise (tv2, noise_generator);
+                temp = 0.5 - octave[i];
                 temp = fabs(temp);
                 break;
 
             default:
-                temp = 1.0 - 2.0 * Noise (tv2, noise_generator); // TODO similar code clips the result
+                temp = 1.0 - 2.0 * octave[i]; // TODO similar code clips the result
                 temp = fabs(temp);
                 if (temp>0.5) temp=0.5;
                 break;
         }
 
-        noise += temp / freq;
+        noise += temp / freq[i];
     }
 
     return(noise);
@@ -8719,51 +8753,50 @@ bool WoodPattern::HasSpecialTurbulenceHandling() const
 
 DBL WrinklesPattern::EvaluateRaw(const Vector3d& EPoint, const Intersection *pIsection, const Ray *pRay, TraceThreadData *pThread) const
 {
+    static const DBL lambda[10] = { 1.0, 2.0, 4.0, 8.0, 16.0, 32.0, 64.0, 128.0, 256.0, 512.0 };
+
     int noise_generator = GetNoiseGen(pThread);
 
     int i;
-    DBL lambda = 2.0;
     DBL omega = 0.5;
     DBL value;
-    Vector3d temp;
+    DBL octave[10];
     DBL noise;
 
+    MultiNoise(octave, EPoint, lambda, 10, noise_generator);
+
     // TODO - This distinction (with minor variations that seem to be more of an inconsistency rather than intentional)
     // appears in other places as well; make it a function.
     switch (noise_generator)
     {
         case kNoiseGen_Default:
         case kNoiseGen_Original:
-            value = Noise(EPoint, noise_generator);
+            value = octave[0];
             break;
 
         default:
-            noise = Noise(EPoint, noise_generator)*2.0-0.5;
+            noise = octave[0]*2.0-0.5;
             value = min(max(noise,0.0),1.0);
             break;
     }
 
     for (i = 1; i < 10; i++)
     {
-        temp = EPoint * lambda;
-
         // TODO - This distinction (with minor variations that seem to be more of an inconsistency rather than intentional)
         // appears in other places as well; make it a function.
         switch (noise_generator)
         {
             case kNoiseGen_Default:
             case kNoiseGen_Original:
-                value += omega * Noise(temp, noise_generator);
+                value += omega * octave[i];
                 break;
 
             default:
-                noise = Noise(temp, noise_generator)*2.0-0.5;
+                noise = octave[i]*2.0-0.5;
                 value += omega * min(max(noise,0.0),1.0);
                 break;
         }
 
-        lambda *= 2.0;
-
         omega *= 0.5;
     }
 
@@ -1117,6 +1117,15 @@ void Transform_Tpattern (TPATTERN *Tpattern, const TRANSFORM *Trans);
 DBL quilt_cubic (DBL t,DBL p1,DBL p2);
 int GetNoiseGen (const TPATTERN *TPat, const TraceThreadData *Thread);
 
+/// Estimate the diameter of the area covered by a ray at an intersection, in pattern space.
+///
+/// @param[in]  warps       Warps of the pattern.
+/// @param[in]  pIsection   Intersection, or `nullptr` if unknown.
+/// @param[in]  pRay        Ray, or `nullptr` if unknown.
+/// @return                 The estimated diameter, or 0.0 if unknown.
+///
+DBL GetFilterSize (const WarpList& warps, const Intersection *pIsection, const Ray *pRay);
+
 DENSITY_FILE *Create_Density_File ();
 DENSITY_FILE *Copy_Density_File (DENSITY_FILE *);
 void Destroy_Density_File (DENSITY_FILE *);
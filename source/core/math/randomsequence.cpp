@@ -1061,6 +1061,12 @@ SequentialVectorGeneratorPtr GetSubRandomDirectionGenerator(unsigned int id, siz
         return SequentialVectorGeneratorPtr(new HaltonUniformDirectionGenerator(param));
 }
 
+IndexedVectorGeneratorPtr GetIndexedSubRandomDirectionGenerator(unsigned int id)
+{
+    HaltonUniformDirectionGenerator::ParameterStruct param(primeTable[id % PRIME_TABLE_COUNT], primeTable[(id+1) % PRIME_TABLE_COUNT]);
+    return IndexedVectorGeneratorPtr(new HaltonUniformDirectionGenerator(param));
+}
+
 SequentialVector2dGeneratorPtr GetSubRandomOnDiscGenerator(unsigned int id, double radius, size_t count)
 {
     HaltonOnDiscGenerator::ParameterStruct param(primeTable[id % PRIME_TABLE_COUNT], primeTable[(id+1) % PRIME_TABLE_COUNT], radius);
@@ -1073,6 +1079,12 @@ SequentialVector2dGeneratorPtr GetSubRandomOnDiscGenerator(unsigned int id, doub
         return SequentialVector2dGeneratorPtr(new HaltonOnDiscGenerator(param));
 }
 
+IndexedVector2dGeneratorPtr GetIndexedSubRandomOnDiscGenerator(unsigned int id, double radius)
+{
+    HaltonOnDiscGenerator::ParameterStruct param(primeTable[id % PRIME_TABLE_COUNT], primeTable[(id+1) % PRIME_TABLE_COUNT], radius);
+    return IndexedVector2dGeneratorPtr(new HaltonOnDiscGenerator(param));
+}
+
 SequentialVector2dGeneratorPtr GetSubRandom2dGenerator(unsigned int id, double minX, double maxX, double minY, double maxY, size_t count)
 {
     Halton2dGenerator::ParameterStruct param(primeTable[id % PRIME_TABLE_COUNT], primeTable[(id+1) % PRIME_TABLE_COUNT], minX, maxX, minY, maxY);
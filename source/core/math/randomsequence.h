@@ -341,6 +341,16 @@ SequentialVectorGeneratorPtr GetSubRandomCosWeightedDirectionGenerator(unsigned
 ///
 SequentialVectorGeneratorPtr GetSubRandomDirectionGenerator(unsigned int id, size_t count = 0);
 
+/// Gets a source for sub-random (low discrepancy) vectors on the unit sphere, accessible by index.
+///
+/// The values are identical to those provided by @ref GetSubRandomDirectionGenerator() with the same `id`, in
+/// the same order, but can be accessed concurrently from multiple threads.
+///
+/// @param[in]  id              Selects one of multiple sources.
+/// @return                     A shared pointer to a corresponding number generator.
+///
+IndexedVectorGeneratorPtr GetIndexedSubRandomDirectionGenerator(unsigned int id);
+
 /// Gets a source for sub-random (low discrepancy) 2D vectors on a disc.
 ///
 /// @param[in]  id              Selects one of multiple sources.
@@ -350,6 +360,17 @@ SequentialVectorGeneratorPtr GetSubRandomDirectionGenerator(unsigned int id, siz
 ///
 SequentialVector2dGeneratorPtr GetSubRandomOnDiscGenerator(unsigned int id, double radius, size_t count = 0);
 
+/// Gets a source for sub-random (low discrepancy) 2D vectors on a disc, accessible by index.
+///
+/// The values are identical to those provided by @ref GetSubRandomOnDiscGenerator() with the same `id` and `radius`,
+/// in the same order, but can be accessed concurrently from multiple threads.
+///
+/// @param[in]  id              Selects one of multiple sources.
+/// @param[in]  radius          Radius of the disc.
+/// @return                     A shared pointer to a corresponding number generator.
+///
+IndexedVector2dGeneratorPtr GetIndexedSubRandomOnDiscGenerator(unsigned int id, double radius);
+
 /// Gets a source for sub-random (low discrepancy) 2D vectors within a square.
 ///
 /// @param[in]  id              Selects one of multiple sources.
@@ -47,7 +47,9 @@
 
 // POV-Ray header files (core module)
 #include "core/bounding/bsptree.h"
+#include "core/bounding/bvhtree.h"
 #include "core/lighting/lightsource.h"
+#include "core/lighting/lighttree.h"
 #include "core/lighting/radiosity.h"
 #include "core/lighting/subsurface.h"
 #include "core/material/interior.h"
@@ -139,6 +141,19 @@ double Trace::TraceRay(Ray& ray, MathColour& colour, ColourChannel& transm, COLC
     NoSomethingFlagRayObjectCondition precond;
     TrueRayObjectCondition postcond;
 
+    if(!CheckTraceRay(ray, colour, transm, weight))
+        return HUGE_VAL;
+
+    if (maxDepth >= EPSILON)
+        bestisect.Depth = maxDepth;
+
+    found = FindIntersection(bestisect, ray, precond, postcond);
+
+    return ShadeRay(ray, colour, transm, weight, continuedRay, bestisect, found);
+}
+
+bool Trace::CheckTraceRay(Ray& ray, MathColour& colour, ColourChannel& transm, COLC weight)
+{
     POV_ULONG nrays = threadData->Stats()[Number_Of_Rays]++;
     if(ray.IsPrimaryRay() || (((unsigned char) nrays & 0x0f) == 0x00))
         cooperate();
@@ -151,14 +166,14 @@ double Trace::TraceRay(Ray& ray, MathColour& colour, ColourChannel& transm, COLC
 
         colour.Clear();
         transm = 0.0;
-        return HUGE_VAL;
+        return false;
     }
 
-    if (maxDepth >= EPSILON)
-        bestisect.Depth = maxDepth;
-
-    found = FindIntersection(bestisect, ray, precond, postcond);
+    return true;
+}
 
+double Trace::ShadeRay(Ray& ray, MathColour& colour, ColourChannel& transm, COLC weight, bool continuedRay, Intersection& bestisect, bool found)
+{
     // Check if we're busy shooting too many radiosity sample rays at an unimportant object
     if (ray.GetTicket().radiosityImportanceQueried >= 0.0)
     {
@@ -231,6 +246,27 @@ bool Trace::FindIntersection(Intersection& bestisect, const Ray& ray)
 {
     switch(sceneData->boundingMethod)
     {
+        case 3:
+        {
+            BSPIntersectFunctor ifn(bestisect, ray, sceneData->objects, threadData);
+            bool found = false;
+
+            found = (*(sceneData->bvhTree))(ray, ifn, bestisect.Depth);
+
+            // test infinite objects
+            for(vector<ObjectPtr>::iterator it = sceneData->objects.begin() + sceneData->numberOfFiniteObjects; it != sceneData->objects.end(); it++)
+            {
+                Intersection isect;
+
+                if(FindIntersection(*it, isect, ray) && (isect.Depth < bestisect.Depth))
+                {
+                    bestisect = isect;
+                    found = true;
+                }
+            }
+
+            return found;
+        }
         case 2:
         {
             BSPIntersectFunctor ifn(bestisect, ray, sceneData->objects, threadData);
@@ -286,6 +322,30 @@ bool Trace::FindIntersection(Intersection& bestisect, const Ray& ray, const RayO
 {
     switch(sceneData->boundingMethod)
     {
+        case 3:
+        {
+            BSPIntersectCondFunctor ifn(bestisect, ray, sceneData->objects, threadData, precondition, postcondition);
+            bool found = false;
+
+            found = (*(sceneData->bvhTree))(ray, ifn, bestisect.Depth);
+
+            // test infinite objects
+            for(vector<ObjectPtr>::iterator it = sceneData->objects.begin() + sceneData->numberOfFiniteObjects; it != sceneData->objects.end(); it++)
+            {
+                if(precondition(ray, *it, 0.0) == true)
+                {
+                    Intersection isect;
+
+                    if(FindIntersection(*it, isect, ray, postcondition) && (isect.Depth < bestisect.Depth))
+                    {
+                        bestisect = isect;
+                        found = true;
+                    }
+                }
+            }
+
+            return found;
+        }
         case 2:
         {
             BSPIntersectCondFunctor ifn(bestisect, ray, sceneData->objects, threadData, precondition, postcondition);
@@ -343,6 +403,17 @@ bool Trace::FindIntersection(Intersection& bestisect, const Ray& ray, const RayO
     return false;
 }
 
+void Trace::FindIntersections(Intersection isects[], bool found[], const Ray* const rays[], int count, const RayObjectCondition& precondition, const RayObjectCondition& postcondition)
+{
+    if ((sceneData->boundingMethod == 1) && (sceneData->boundingSlabs != nullptr))
+        Intersect_BBox_Tree_Packet(packetStack, sceneData->boundingSlabs, rays, count, isects, found, precondition, postcondition, threadData);
+    else
+    {
+        for (int i = 0; i < count; i++)
+            found[i] = FindIntersection(isects[i], *rays[i], precondition, postcondition);
+    }
+}
+
 bool Trace::FindIntersection(ObjectPtr object, Intersection& isect, const Ray& ray, double closest)
 {
     if (object != nullptr)
@@ -1497,8 +1568,29 @@ void Trace::ComputeDiffuseLight(const FINISH *finish, const Vector3d& ipoint, co
     // global light sources, if not turned off for this object
     if((object->Flags & NO_GLOBAL_LIGHTS_FLAG) != NO_GLOBAL_LIGHTS_FLAG)
     {
-        for(int i = 0; i < threadData->lightSources.size(); i++)
-            ComputeOneDiffuseLight(*threadData->lightSources[i], reye, finish, ipoint, eye, layer_normal, layer_pigment_colour, colour, attenuation, object, relativeIor, i);
+        if(sceneData->lightTree != nullptr)
+        {
+            // too many light sources to test them all; test those not in the light tree, plus a random pick from it
+            const LightTree& lightTree = *sceneData->lightTree;
+            for(size_t i : lightTree.GetOtherLights())
+                ComputeOneDiffuseLight(*threadData->lightSources[i], reye, finish, ipoint, eye, layer_normal, layer_pigment_colour, colour, attenuation, object, relativeIor, i);
+
+            bool twoSided = Test_Flag(object, DOUBLE_ILLUMINATE_FLAG) || (finish->DiffuseBack != 0.0);
+            LightTree::SelectionVector selection;
+            selection.reserve(sceneData->lightBudget);
+            lightTree.SelectLights(ipoint, layer_normal, twoSided, sceneData->lightBudget, randomNumberGenerator, selection);
+            for(const LightTree::Selection& pick : selection)
+            {
+                MathColour lightColour;
+                ComputeOneDiffuseLight(*threadData->lightSources[pick.light], reye, finish, ipoint, eye, layer_normal, layer_pigment_colour, lightColour, attenuation, object, relativeIor, pick.light);
+                colour += lightColour * pick.weight;
+            }
+        }
+        else
+        {
+            for(size_t i = 0; i < threadData->lightSources.size(); i++)
+                ComputeOneDiffuseLight(*threadData->lightSources[i], reye, finish, ipoint, eye, layer_normal, layer_pigment_colour, colour, attenuation, object, relativeIor, i);
+        }
     }
 
     // local light sources from a light group, if any
@@ -2082,19 +2174,6 @@ void Trace::TraceAreaLightShadowRay(const LightSource &lightsource, double& ligh
     Vector3d axis1Temp, axis2Temp;
     double axis1_Length;
 
-    lightGrid.resize(lightsource.Area_Size1 * lightsource.Area_Size2);
-
-    // Flag uncalculated points with a negative value for Red
-    /*
-    for(i = 0; i < lightsource.Area_Size1; i++)
-    {
-        for(j = 0; j < lightsource.Area_Size2; j++)
-            lightGrid[i * lightsource.Area_Size2 + j].Invalidate();
-    }
-    */
-    for(size_t ind = 0; ind < lightGrid.size(); ++ind)
-        lightGrid[ind].Invalidate();
-
     axis1Temp = lightsource.Axis1;
     axis2Temp = lightsource.Axis2;
 
@@ -2125,9 +2204,204 @@ void Trace::TraceAreaLightShadowRay(const LightSource &lightsource, double& ligh
         axis2Temp *= axis1_Length;
     }
 
+    if(lightsource.Low_Discrepancy)
+    {
+        TraceAreaLightSampledShadowRay(lightsource, lightsourcedepth, lightsourceray, ipoint, lightcolour, axis1Temp, axis2Temp);
+        return;
+    }
+
+    lightGrid.resize(lightsource.Area_Size1 * lightsource.Area_Size2);
+
+    // Flag uncalculated points with a negative value for Red
+    /*
+    for(i = 0; i < lightsource.Area_Size1; i++)
+    {
+        for(j = 0; j < lightsource.Area_Size2; j++)
+            lightGrid[i * lightsource.Area_Size2 + j].Invalidate();
+    }
+    */
+    for(size_t ind = 0; ind < lightGrid.size(); ++ind)
+        lightGrid[ind].Invalidate();
+
     TraceAreaLightSubsetShadowRay(lightsource, lightsourcedepth, lightsourceray, ipoint, lightcolour, 0, 0, lightsource.Area_Size1 - 1, lightsource.Area_Size2 - 1, 0, axis1Temp, axis2Temp);
 }
 
+void Trace::TraceAreaLightSampledShadowRay(const LightSource &lightsource, double& lightsourcedepth, Ray& lightsourceray,
+                                           const Vector3d& ipoint, MathColour& lightcolour, const Vector3d& axis1, const Vector3d& axis2)
+{
+    // Largest standard error of the mean, relative to the unobstructed light colour, at which to stop sampling.
+    const double kConvergenceThreshold = 0.02;
+
+    int maxSamples = lightsource.Area_Size1 * lightsource.Area_Size2;
+    int minSamples = maxSamples;
+    if(lightsource.Adaptive_Level < 8)
+    {
+        // take at least as many samples as the corners of the initial grid in adaptive grid sampling
+        int side = (1 << max(0, lightsource.Adaptive_Level)) + 1;
+        minSamples = min(maxSamples, side * side);
+    }
+
+    int cornerSamples = ((maxSamples >= 8) ? 4 : 0);
+
+    if(areaLightSamples.size() < size_t(maxSamples - cornerSamples))
+    {
+        SequentialVector2dGeneratorPtr generator(GetSubRandom2dGenerator(0, 0.0, 1.0, 0.0, 1.0));
+        areaLightSamples = *generator->GetSequence(maxSamples - cornerSamples);
+    }
+
+    // rotate the sequence at random per shading point, to trade banding for noise
+    Vector2d offset(0.0, 0.0);
+    if(lightsource.Jitter)
+        offset = Vector2d(randomNumberGenerator(), randomNumberGenerator());
+
+    double limit = lightcolour.WeightMaxAbs() * kConvergenceThreshold;
+    MathColour sum, sumSqr, first;
+    bool uniform = true;
+    int n = 0;
+
+    static_assert(BBOX_PACKET_SIZE == 4, "Ray batch initialization assumes packets of 4 rays.");
+    Ray lsr[BBOX_PACKET_SIZE] = { lightsourceray, lightsourceray, lightsourceray, lightsourceray };
+    double depths[BBOX_PACKET_SIZE];
+    MathColour colours[BBOX_PACKET_SIZE];
+
+    while(n < maxSamples)
+    {
+        int count = min(BBOX_PACKET_SIZE, maxSamples - n);
+
+        for(int i = 0; i < count; i++)
+        {
+            double jitter_u, jitter_v;
+            if(n + i < cornerSamples)
+            {
+                // sample the corners first, so that shadow edges crossing the light are unlikely to go unnoticed
+                jitter_u = ((n + i) & 1) ? 0.5 : -0.5;
+                jitter_v = ((n + i) & 2) ? 0.5 : -0.5;
+            }
+            else
+            {
+                Vector2d sample = areaLightSamples[n + i - cornerSamples] + offset;
+                jitter_u = sample.x() - floor(sample.x()) - 0.5;
+                jitter_v = sample.y() - floor(sample.y()) - 0.5;
+            }
+
+            // Create circular area lights the same way as in grid sampling
+            if(lightsource.Circular == true)
+            {
+                double length = sqrt(jitter_u * jitter_u + jitter_v * jitter_v);
+                if(length > 0.0)
+                {
+                    double scaleFactor = max(fabs(jitter_u), fabs(jitter_v)) / length;
+                    jitter_u *= scaleFactor;
+                    jitter_v *= scaleFactor;
+                }
+            }
+
+            Vector3d jitterAxis1 = (lightsource.Area_Size1 > 1) ? axis1 * jitter_u : Vector3d(0.0, 0.0, 0.0);
+            Vector3d jitterAxis2 = (lightsource.Area_Size2 > 1) ? axis2 * jitter_v : Vector3d(0.0, 0.0, 0.0);
+
+            // Recalculate the light source ray but not the colour
+            ComputeOneWhiteLightRay(lightsource, depths[i], lsr[i], ipoint, jitterAxis1 + jitterAxis2);
+            colours[i] = lightcolour;
+        }
+
+        TracePointLightShadowRays(lightsource, depths, lsr, colours, count);
+
+        for(int i = 0; i < count; i++)
+        {
+            if(n + i == 0)
+                first = colours[i];
+            else if(uniform && (ColourDistance(colours[i], first) > EPSILON))
+                uniform = false;
+            sum += colours[i];
+            sumSqr += colours[i] * colours[i];
+        }
+        n += count;
+        lightsourcedepth = depths[count - 1];
+
+        if(n >= minSamples)
+        {
+            // stop if fully lit or fully shadowed
+            if(uniform)
+                break;
+
+            // stop if the mean has converged
+            if(n > 1)
+            {
+                MathColour mean = sum / double(n);
+                MathColour variance = (sumSqr / double(n) - mean * mean) / double(n - 1);
+                bool converged = true;
+                for(int i = 0; i < MathColour::channels; i++)
+                    converged = converged && (variance[i] <= Sqr(limit));
+                if(converged)
+                    break;
+            }
+        }
+    }
+
+    lightcolour = sum / double(n);
+}
+
+void Trace::TracePointLightShadowRays(const LightSource &lightsource, double lightsourcedepths[], Ray lightsourcerays[], MathColour lightcolours[], int count)
+{
+    if((count < 2) || (lightsource.Projected_Through_Object != nullptr))
+    {
+        for(int i = 0; i < count; i++)
+            TracePointLightShadowRay(lightsource, lightsourcedepths[i], lightsourcerays[i], lightcolours[i]);
+        return;
+    }
+
+    NoShadowFlagRayObjectCondition precond;
+    SmallToleranceRayObjectCondition postcond;
+    Intersection isects[BBOX_PACKET_SIZE];
+    bool found[BBOX_PACKET_SIZE];
+    const Ray* rays[BBOX_PACKET_SIZE];
+
+    for(int i = 0; i < count; i++)
+    {
+        isects[i].Depth = lightsourcedepths[i];
+        rays[i] = &lightsourcerays[i];
+    }
+
+    FindIntersections(isects, found, rays, count, precond, postcond);
+
+    for(int i = 0; i < count; i++)
+    {
+        if(!found[i] ||
+           (isects[i].Depth >= lightsourcedepths[i] - SHADOW_TOLERANCE) ||
+           (isects[i].Depth <= SHADOW_TOLERANCE))
+        {
+            // nothing in the way
+            threadData->Stats()[Shadow_Ray_Tests]++;
+            continue;
+        }
+
+        MathColour colour(lightcolours[i]);
+        Ray ray(lightsourcerays[i]);
+        ComputeShadowColour(lightsource, isects[i], ray, colour);
+
+        ObjectPtr testObject(isects[i].Csg != nullptr ? isects[i].Csg : isects[i].Object);
+
+        if(colour.IsNearZero(EPSILON) && Test_Flag(testObject, OPAQUE_FLAG))
+        {
+            // fully shadowed; remember the object for the light source shadow cache, like TracePointLightShadowRay does
+            threadData->Stats()[Shadow_Ray_Tests]++;
+            threadData->Stats()[Shadow_Rays_Succeeded]++;
+            lightcolours[i] = colour;
+
+            if(lightsource.lightGroupLight == false)
+            {
+                if(lightsourcerays[i].GetTicket().traceLevel == 2)
+                    lightSourceLevel1ShadowCache[lightsource.index] = testObject;
+                else
+                    lightSourceOtherShadowCache[lightsource.index] = testObject;
+            }
+        }
+        else
+            // partially transparent objects in the way; trace the ray the hard way
+            TracePointLightShadowRay(lightsource, lightsourcedepths[i], lightsourcerays[i], lightcolours[i]);
+    }
+}
+
 void Trace::TraceAreaLightSubsetShadowRay(const LightSource &lightsource, double& lightsourcedepth, Ray& lightsourceray,
                                           const Vector3d& ipoint, MathColour& lightcolour, int u1, int  v1, int  u2, int  v2, int level, const Vector3d& axis1, const Vector3d& axis2)
 {
@@ -3690,6 +3964,117 @@ void Trace::ComputeDiffuseAmbientContribution1(const Intersection& out, const Ve
 #endif
 }
 
+void Trace::ComputeDiffuseCacheIrradiance(const Intersection& in, double eta, bool useRadiosity, MathColour& irradiance, TraceTicket& ticket)
+{
+    // TODO FIXME - part of this code is very alike to ComputeDiffuseContribution1()
+
+    irradiance.Clear();
+
+    const ObjectBase *object = in.Object;
+
+    auto addLight = [&](const LightSource& lightsource)
+    {
+        Ray lightsourceray(ticket);
+        double lightsourcedepth;
+        MathColour lightcolour;
+        ComputeOneLightRay(lightsource, lightsourcedepth, lightsourceray, in.IPoint, lightcolour, true);
+
+        if(lightcolour.IsNearZero(EPSILON))
+            return;
+
+        // [CLi] we're coming from inside the object, so the surface /must/ be properly oriented towards the camera; if it isn't,
+        // it must be the normal's fault
+        double cos_in = fabs(dot(in.INormal, lightsourceray.Direction));
+        if(cos_in < EPSILON)
+            return;
+
+        if (qualityFlags.shadows && ((lightsource.Projected_Through_Object != nullptr) || (lightsource.Light_Type != FILL_LIGHT_SOURCE)))
+            TraceShadowRay(lightsource, lightsourcedepth, lightsourceray, in.IPoint, lightcolour);
+
+        if(lightcolour.IsNearZero(EPSILON))
+            return;
+
+        irradiance += lightcolour * (cos_in * ComputeFt(acos(min(cos_in, 1.0)), eta));
+    };
+
+    // global light sources, if not turned off for this object
+    if((object->Flags & NO_GLOBAL_LIGHTS_FLAG) != NO_GLOBAL_LIGHTS_FLAG)
+    {
+        for(size_t k = 0; k < threadData->lightSources.size(); k++)
+            addLight(*threadData->lightSources[k]);
+    }
+
+    // local light sources from a light group, if any
+    for(size_t k = 0; k < object->LLights.size(); k++)
+        addLight(*object->LLights[k]);
+
+    if (useRadiosity && (Test_Flag(object, IGNORE_RADIOSITY_FLAG) == false))
+    {
+        // Note: radiosity data is already cosine-weighted, so we're using the surface normal as incident light direction
+        MathColour ambientcolour;
+        radiosity.ComputeAmbient(in.IPoint, in.INormal, in.INormal, 1.0 /* TODO - brilliance */, ambientcolour, 1.0, ticket);
+        irradiance += ambientcolour * ComputeFt(0.0, eta);
+    }
+}
+
+void Trace::ComputeSubsurfaceCacheSamples(const SubsurfaceCacheBuilder::Job& job, size_t first, size_t count,
+                                          vector<SubsurfaceIrradianceCache::Sample>& samples, TraceTicket& ticket)
+{
+    bool useRadiosity = (sceneData->radiositySettings.radiosityEnabled == true) &&
+                        (sceneData->subsurfaceUseRadiosity == true);
+
+    // any SSLT objects encountered while computing the irradiance are to be shaded as if seen from within SSLT
+    unsigned int oldSubsurfaceRecursionDepth = ticket.subsurfaceRecursionDepth;
+    ticket.subsurfaceRecursionDepth = 1;
+
+    for (size_t i = first; i < first + count; i++)
+    {
+        Vector3d direction = (*job.directionGenerator)[i];
+        Vector2d offset = (*job.discGenerator)[i];
+        Vector3d axisU, axisV;
+        ComputeSurfaceTangents(direction, axisU, axisV);
+        Ray ray(ticket, job.center + axisU * offset.x() + axisV * offset.y() - direction * (job.radius * 1.01), direction, Ray::SubsurfaceRay);
+
+        for (ObjectPtr object : job.objects)
+        {
+            IStack depthstack(stackPool);
+            POV_REFPOOL_ASSERT(depthstack->empty()); // verify that the IStack pulled from the pool is in a cleaned-up condition
+
+            if (object->All_Intersections(ray, depthstack, threadData))
+            {
+                while (depthstack->size() > 0)
+                {
+                    Intersection in = depthstack->top();
+                    depthstack->pop();
+
+                    if ((in.Depth <= 0.0) || (in.Object->interior.get() != job.interior))
+                        continue;
+
+                    ComputeSSLTNormal(in);
+
+                    SubsurfaceIrradianceCache::Sample sample;
+                    ComputeDiffuseCacheIrradiance(in, job.eta, useRadiosity, sample.irradiance, ticket);
+                    // samples without irradiance don't contribute anything
+                    if (sample.irradiance.IsZero())
+                        continue;
+                    sample.point = in.IPoint;
+                    sample.area = job.sampleArea;
+                    samples.push_back(sample);
+                }
+            }
+
+            POV_REFPOOL_ASSERT(depthstack->empty()); // verify that the IStack is in a cleaned-up condition (again)
+        }
+    }
+
+    ticket.subsurfaceRecursionDepth = oldSubsurfaceRecursionDepth;
+}
+
+SubsurfaceIrradianceCachePtr Trace::GetSubsurfaceIrradianceCache(const Intersection& out)
+{
+    return sceneData->subsurfaceCaches.Get(out.Object->interior.get());
+}
+
 void Trace::ComputeSubsurfaceScattering(const FINISH *Finish, const MathColour& layer_pigment_colour, const Intersection& out, Ray& Eye, const Vector3d& Layer_Normal, MathColour& Final_Colour, double Attenuation)
 {
     int NumSamplesDiffuse = sceneData->subsurfaceSamplesDiffuse;
@@ -3761,53 +4146,67 @@ void Trace::ComputeSubsurfaceScattering(const FINISH *Finish, const MathColour&
                             (radiosity.CheckRadiosityTraceLevel(Eye.GetTicket()) == true) &&
                             (Test_Flag(out.Object, IGNORE_RADIOSITY_FLAG) == false);
 
-    Vector3d sampleBase;
-    ComputeDiffuseSampleBase(sampleBase, out, vOut, 1.0 / (sigma_prime_t_mean * sceneData->mmPerUnit), Eye.GetTicket());
-
-    weightSum = 0.0;
-    trueNumSamples = 0;
+    SubsurfaceIrradianceCachePtr irradianceCache;
+    if ((sceneData->subsurfaceErrorBound > 0.0) && (Eye.GetTicket().subsurfaceRecursionDepth == 1))
+        irradianceCache = GetSubsurfaceIrradianceCache(out);
 
-    for (int i = 0; i < NumSamplesDiffuse; i++)
+    if (irradianceCache)
     {
-        Intersection in;
-        ComputeDiffuseSamplePoint(sampleBase, in, sampleArea, Eye.GetTicket());
+        // look up the irradiance samples distributed over the object's surface
+        SubsurfaceDipole dipole(sigma_prime_s, sigma_a, eta);
+        double cos_phi_out = clip(dot(vOut, out.INormal), -1.0, 1.0);
+        Total_Colour = irradianceCache->ComputeRadiantExitance(out.IPoint, dipole, sceneData->subsurfaceErrorBound) * ComputeFt(acos(cos_phi_out), eta);
+    }
+    else
+    {
+        Vector3d sampleBase;
+        ComputeDiffuseSampleBase(sampleBase, out, vOut, 1.0 / (sigma_prime_t_mean * sceneData->mmPerUnit), Eye.GetTicket());
+
+        weightSum = 0.0;
+        trueNumSamples = 0;
 
-        // avoid pathological cases
-        if (sampleArea != 0)
+        for (int i = 0; i < NumSamplesDiffuse; i++)
         {
-            weight = sampleArea;
-            weightSum += weight;
-            trueNumSamples ++;
+            Intersection in;
+            ComputeDiffuseSamplePoint(sampleBase, in, sampleArea, Eye.GetTicket());
 
-            if (IsSameSSLTObject(in.Object, out.Object))
+            // avoid pathological cases
+            if (sampleArea != 0)
             {
-                // radiosity-alike ambient illumination
-                if (radiosity_needed)
-                    // shoot just one random ray to account for ambient illumination (we're averaging stuff anyway)
-                    ComputeDiffuseAmbientContribution1(out, vOut, in, Total_Colour, sigma_prime_s, sigma_a, eta, weight, Eye.GetTicket());
+                weight = sampleArea;
+                weightSum += weight;
+                trueNumSamples ++;
 
-                // global light sources, if not turned off for this object
-                if((out.Object->Flags & NO_GLOBAL_LIGHTS_FLAG) != NO_GLOBAL_LIGHTS_FLAG)
+                if (IsSameSSLTObject(in.Object, out.Object))
                 {
-                    for(int k = 0; k < threadData->lightSources.size(); k++)
-                        ComputeDiffuseContribution1(*threadData->lightSources[k], out, vOut, in, Total_Colour, sigma_prime_s, sigma_a, eta, weight, Eye.GetTicket());
-                }
+                    // radiosity-alike ambient illumination
+                    if (radiosity_needed)
+                        // shoot just one random ray to account for ambient illumination (we're averaging stuff anyway)
+                        ComputeDiffuseAmbientContribution1(out, vOut, in, Total_Colour, sigma_prime_s, sigma_a, eta, weight, Eye.GetTicket());
+
+                    // global light sources, if not turned off for this object
+                    if((out.Object->Flags & NO_GLOBAL_LIGHTS_FLAG) != NO_GLOBAL_LIGHTS_FLAG)
+                    {
+                        for(size_t k = 0; k < threadData->lightSources.size(); k++)
+                            ComputeDiffuseContribution1(*threadData->lightSources[k], out, vOut, in, Total_Colour, sigma_prime_s, sigma_a, eta, weight, Eye.GetTicket());
+                    }
 
-                // local light sources from a light group, if any
-                if(!out.Object->LLights.empty())
+                    // local light sources from a light group, if any
+                    if(!out.Object->LLights.empty())
+                    {
+                        for(size_t k = 0; k < out.Object->LLights.size(); k++)
+                            ComputeDiffuseContribution1(*out.Object->LLights[k], out, vOut, in, Total_Colour, sigma_prime_s, sigma_a, eta, weight, Eye.GetTicket());
+                    }
+                }
+                else
                 {
-                    for(int k = 0; k < out.Object->LLights.size(); k++)
-                        ComputeDiffuseContribution1(*out.Object->LLights[k], out, vOut, in, Total_Colour, sigma_prime_s, sigma_a, eta, weight, Eye.GetTicket());
+                    // TODO - what's the proper thing to do?
                 }
             }
-            else
-            {
-                // TODO - what's the proper thing to do?
-            }
         }
+        if (trueNumSamples > 0)
+            Total_Colour /= trueNumSamples;
     }
-    if (trueNumSamples > 0)
-        Total_Colour /= trueNumSamples;
 
 #endif
 
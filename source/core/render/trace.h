@@ -52,6 +52,7 @@
 // POV-Ray header files (core module)
 #include "core/coretypes.h"
 #include "core/bounding/bsptree.h"
+#include "core/lighting/subsurface.h"
 #include "core/math/randomsequence.h"
 #include "core/render/ray.h"
 #include "core/scene/atmosphere_fwd.h"
@@ -172,11 +173,16 @@ struct TraceTicket final
     /// something the subsurface scattering algorithm needs
     unsigned int subsurfaceRecursionDepth;
 
+    /// approximate width of the area covered by a camera ray at its origin, or 0.0 if unknown
+    float pixelFootprint;
+    /// approximate growth of @ref pixelFootprint per distance travelled
+    float pixelSpread;
+
     TraceTicket(unsigned int mtl, double adcb, bool ab = true, unsigned int rrd = 0, unsigned int ssrd = 0,
                 float riq = -1.0, float rq = 1.0):
         traceLevel(0), maxAllowedTraceLevel(mtl), maxFoundTraceLevel(0), adcBailout(adcb), alphaBackground(ab),
         radiosityRecursionDepth(rrd), subsurfaceRecursionDepth(ssrd), radiosityImportanceQueried(riq),
-        radiosityImportanceFound(-1.0), radiosityQuality(rq)
+        radiosityImportanceFound(-1.0), radiosityQuality(rq), pixelFootprint(0.0f), pixelSpread(0.0f)
     {}
 };
 
@@ -213,6 +219,7 @@ class Trace
                 virtual ~RadiosityFunctor() {}
                 virtual void ComputeAmbient(const Vector3d& ipoint, const Vector3d& raw_normal, const Vector3d& layer_normal, double brilliance, MathColour& ambient_colour, double weight, TraceTicket& ticket) { }
                 virtual bool CheckRadiosityTraceLevel(const TraceTicket& ticket) { return false; }
+                virtual bool IsFinalTrace() const { return true; }
         };
 
         /// @todo TraceThreadData already holds a reference to SceneData.
@@ -257,12 +264,61 @@ class Trace
         bool FindIntersection(ObjectPtr object, Intersection& isect, const Ray& ray, double closest = HUGE_VAL);
         bool FindIntersection(ObjectPtr object, Intersection& isect, const Ray& ray, const RayObjectCondition& postcondition, double closest = HUGE_VAL);
 
+        /// Find the nearest intersections for a bundle of coherent rays.
+        ///
+        /// With bounding slabs in use, the rays traverse the bounding hierarchy as a packet,
+        /// sharing bounding box fetches; otherwise, each ray is tested individually.
+        ///
+        /// @param[in,out]  isects          Nearest intersection found per ray; the incoming depths limit the search.
+        /// @param[out]     found           Whether an intersection was found per ray.
+        /// @param[in]      rays            Rays to test.
+        /// @param[in]      count           Number of rays (at most @ref BBOX_PACKET_SIZE).
+        /// @param[in]      precondition    Condition an object must meet before being tested.
+        /// @param[in]      postcondition   Condition an intersection must meet to be accepted.
+        ///
+        void FindIntersections(Intersection isects[], bool found[], const Ray* const rays[], int count, const RayObjectCondition& precondition, const RayObjectCondition& postcondition);
+
         unsigned int GetHighestTraceLevel();
 
         bool TestShadow(const LightSource &light, double& depth, Ray& light_source_ray, const Vector3d& p, MathColour& colour); // TODO FIXME - this should not be exposed here
 
+        /// Compute the irradiance samples for a chunk of lines of a subsurface irradiance cache.
+        ///
+        /// @param[in]      job             Parameters of the cache.
+        /// @param[in]      first           Index of the first line to shoot.
+        /// @param[in]      count           Number of lines to shoot.
+        /// @param[out]     samples         Computed samples.
+        /// @param[in,out]  ticket          Ray tracing bookkeeping data.
+        ///
+        void ComputeSubsurfaceCacheSamples(const SubsurfaceCacheBuilder::Job& job, size_t first, size_t count,
+                                           std::vector<SubsurfaceIrradianceCache::Sample>& samples, TraceTicket& ticket);
+
     protected: // TODO FIXME - should be private
 
+        /// Account for a new ray, and check whether it needs to be traced at all.
+        ///
+        /// @param[in,out]  ray             Ray and associated information.
+        /// @param[out]     colour          Colour to use if the ray is not traced.
+        /// @param[out]     transm          Transmittance to use if the ray is not traced.
+        /// @param[in]      weight          Importance of this computation.
+        /// @return                         `false` if max trace level or ADC bailout have been reached.
+        ///
+        bool CheckTraceRay(Ray& ray, MathColour& colour, ColourChannel& transm, COLC weight);
+
+        /// Compute the colour of a ray for which the nearest intersection has already been determined.
+        ///
+        /// @param[in,out]  ray             Ray and associated information.
+        /// @param[out]     colour          Computed colour.
+        /// @param[out]     transm          Computed transmittance.
+        /// @param[in]      weight          Importance of this computation.
+        /// @param[in]      continuedRay    Set to true when tracing a ray after it went through some surface
+        ///                                 without a change in direction; this governs trace level handling.
+        /// @param[in]      bestisect       Nearest intersection of the ray.
+        /// @param[in]      found           Whether the ray hits any object at all.
+        /// @return                         The distance to the nearest object hit.
+        ///
+        double ShadeRay(Ray& ray, MathColour& colour, ColourChannel& transm, COLC weight, bool continuedRay, Intersection& bestisect, bool found);
+
         /// Structure used to cache reflection information for multi-layered textures.
         struct WNRX final
         {
@@ -311,10 +367,14 @@ class Trace
 
         /// Bounding slabs priority queue.
         BBoxPriorityQueue priorityQueue;
+        /// Bounding slabs ray packet stack.
+        BBoxPacketStack packetStack;
         /// BSP tree mailbox.
         BSPTree::Mailbox mailbox;
         /// Area light grid buffer.
         std::vector<MathColour> lightGrid;
+        /// Low-discrepancy sample positions for area lights, in the unit square.
+        std::vector<Vector2d> areaLightSamples;
         /// Fast stack pool.
         IStackPool stackPool;
         /// Fast texture list pool.
@@ -586,6 +646,28 @@ class Trace
         void TraceAreaLightSubsetShadowRay(const LightSource &lightsource, double& lightsourcedepth, Ray& lightsourceray,
                                            const Vector3d& ipoint, MathColour& lightcolour, int u1, int  v1, int  u2, int  v2, int level, const Vector3d& axis1, const Vector3d& axis2);
 
+        /// Trace shadow rays towards an area light at low-discrepancy sample positions.
+        ///
+        /// Samples are taken in batches, and sampling stops early once the minimum number of samples implied by the
+        /// light source's adaptive level has been taken and the samples are either all equal or their mean has
+        /// converged.
+        ///
+        void TraceAreaLightSampledShadowRay(const LightSource &lightsource, double& lightsourcedepth, Ray& lightsourceray,
+                                            const Vector3d& ipoint, MathColour& lightcolour, const Vector3d& axis1, const Vector3d& axis2);
+
+        /// Trace a batch of shadow rays towards a point light source or sample positions of an area light.
+        ///
+        /// With bounding slabs in use, the rays first traverse the bounding hierarchy as a packet; only rays found
+        /// to be blocked by objects that are not fully opaque are then traced individually.
+        ///
+        /// @param[in]      lightsource         Light source to test.
+        /// @param[in,out]  lightsourcedepths   Distances to the light source per ray.
+        /// @param[in,out]  lightsourcerays     Shadow rays to test.
+        /// @param[in,out]  lightcolours        Unobstructed light colour per ray, replaced by the colour reaching the point.
+        /// @param[in]      count               Number of rays (at most @ref BBOX_PACKET_SIZE).
+        ///
+        void TracePointLightShadowRays(const LightSource &lightsource, double lightsourcedepths[], Ray lightsourcerays[], MathColour lightcolours[], int count);
+
         /// Compute the filtering effect of an object on incident light from a particular light source.
         ///
         /// Computations include any media effects between the ray's origin and the point of intersection.
@@ -820,6 +902,13 @@ class Trace
         void ComputeSubsurfaceScattering (const FINISH *Finish, const MathColour& layer_pigment_colour, const Intersection& isect, Ray& Eye, const Vector3d& Layer_Normal, MathColour& colour, double Attenuation);
         bool SSLTComputeRefractedDirection(const Vector3d& v, const Vector3d& n, double eta, Vector3d& refracted);
 
+        /// Get the cache of irradiance samples for an SSLT object.
+        ///
+        /// @return                         The cache, or a null pointer if it is not available.
+        ///
+        SubsurfaceIrradianceCachePtr GetSubsurfaceIrradianceCache(const Intersection& out);
+        void ComputeDiffuseCacheIrradiance(const Intersection& in, double eta, bool useRadiosity, MathColour& irradiance, TraceTicket& ticket);
+
     ///
     /// @}
     ///
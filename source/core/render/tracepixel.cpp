@@ -51,6 +51,7 @@
 #include <algorithm>
 
 // POV-Ray header files (core module)
+#include "core/bounding/bvhtree.h"
 #include "core/material/normal.h"
 #include "core/material/pigment.h"
 #include "core/math/chi2.h"
@@ -319,6 +320,7 @@ void TracePixel::operator()(DBL x, DBL y, DBL width, DBL height, RGBTColour& col
             TraceTicket ticket(maxTraceLevel, adcBailout, sceneData->outputAlpha);
             Ray ray(ticket);
 
+            SetupFootprint(ticket, width);
             if (CreateCameraRay(ray, x, y, width, height, rayno) == true)
             {
                 MathColour col;
@@ -338,6 +340,94 @@ void TracePixel::operator()(DBL x, DBL y, DBL width, DBL height, RGBTColour& col
         TraceRayWithFocalBlur(colour, x, y, width, height);
 }
 
+void TracePixel::operator()(const Vector2d points[], int count, DBL width, DBL height, RGBTColour colours[])
+{
+    // Packet tracing only pays off with a single coherent primary ray per pixel.
+    if (useFocalBlur || (camera.Rays_Per_Pixel != 1) || (sceneData->boundingMethod != 1) || (count < 2))
+    {
+        for (int i = 0; i < count; i++)
+            (*this)(points[i].x(), points[i].y(), width, height, colours[i]);
+        return;
+    }
+
+    NoSomethingFlagRayObjectCondition precond;
+    TrueRayObjectCondition postcond;
+    static_assert(BBOX_PACKET_SIZE == 4, "Ray packet initialization assumes packets of 4 rays.");
+    TraceTicket ticket(maxTraceLevel, adcBailout, sceneData->outputAlpha);
+    TraceTicket tickets[BBOX_PACKET_SIZE] = { ticket, ticket, ticket, ticket };
+    Ray rays[BBOX_PACKET_SIZE] = { Ray(tickets[0]), Ray(tickets[1]), Ray(tickets[2]), Ray(tickets[3]) };
+    const Ray* packet[BBOX_PACKET_SIZE];
+    Intersection isects[BBOX_PACKET_SIZE];
+    bool found[BBOX_PACKET_SIZE];
+    bool traced[BBOX_PACKET_SIZE];
+    int packetSize = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        SetupFootprint(tickets[i], width);
+        traced[i] = CreateCameraRay(rays[i], points[i].x(), points[i].y(), width, height, 0);
+        if (traced[i])
+            packet[packetSize++] = &rays[i];
+    }
+
+    if (packetSize > 0)
+    {
+        Intersection packetIsects[BBOX_PACKET_SIZE];
+        bool packetFound[BBOX_PACKET_SIZE];
+
+        if (camera.Max_Ray_Distance >= EPSILON)
+            for (int i = 0; i < packetSize; i++)
+                packetIsects[i].Depth = camera.Max_Ray_Distance;
+
+        FindIntersections(packetIsects, packetFound, packet, packetSize, precond, postcond);
+
+        // Scatter the results back to the corresponding pixels.
+        for (int i = 0, j = 0; i < count; i++)
+        {
+            if (traced[i])
+            {
+                isects[i] = packetIsects[j];
+                found[i] = packetFound[j];
+                j++;
+            }
+        }
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        colours[i].Clear();
+
+        if (traced[i])
+        {
+            MathColour col;
+            ColourChannel transm = 0.0;
+
+            if (CheckTraceRay(rays[i], col, transm, 1.0))
+                ShadeRay(rays[i], col, transm, 1.0, false, isects[i], found[i]);
+            colours[i] = RGBTColour(ToRGBColour(col), transm);
+        }
+        else
+            colours[i].transm() = 1.0;
+    }
+}
+
+void TracePixel::SetupFootprint(TraceTicket& ticket, DBL width) const
+{
+    // Estimate how much of the scene a single pixel covers, for the benefit
+    // of texture filtering; leave it unknown for all but the basic cameras.
+    switch(camera.Type)
+    {
+        case PERSPECTIVE_CAMERA:
+            ticket.pixelSpread = float(cameraLengthRight / (width * cameraDirection.length()));
+            break;
+        case ORTHOGRAPHIC_CAMERA:
+            ticket.pixelFootprint = float(cameraLengthRight / width);
+            break;
+        default:
+            break;
+    }
+}
+
 bool TracePixel::CreateCameraRay(Ray& ray, DBL x, DBL y, DBL width, DBL height, size_t ray_number)
 {
     DBL x0 = 0.0, y0 = 0.0;
@@ -947,6 +1037,19 @@ void TracePixel::InitRayContainerState(Ray& ray, bool compute)
                 if (((*object)->interior != nullptr) && Inside_BBox(ray.Origin, (*object)->BBox) && (*object)->Inside(ray.Origin, threadData))
                     containingInteriors.push_back((*object)->interior.get());
         }
+        else if(sceneData->boundingMethod == 3)
+        {
+            HasInteriorPointObjectCondition precond;
+            ContainingInteriorsPointObjectCondition postcond(containingInteriors);
+            BSPInsideCondFunctor ifn(ray.Origin, sceneData->objects, threadData, precond, postcond);
+
+            (*sceneData->bvhTree)(ray.Origin, ifn);
+
+            // test infinite objects
+            for(std::vector<ObjectPtr>::iterator object = sceneData->objects.begin() + sceneData->numberOfFiniteObjects; object != sceneData->objects.end(); object++)
+                if (((*object)->interior != nullptr) && Inside_BBox(ray.Origin, (*object)->BBox) && (*object)->Inside(ray.Origin, threadData))
+                    containingInteriors.push_back((*object)->interior.get());
+        }
         else if ((sceneData->boundingMethod == 0) || (sceneData->boundingSlabs == nullptr))
         {
             for(std::vector<ObjectPtr>::iterator object = sceneData->objects.begin(); object != sceneData->objects.end(); object++)
@@ -1019,6 +1122,7 @@ void TracePixel::TraceRayWithFocalBlur(RGBTColour& colour, DBL x, DBL y, DBL wid
     TraceTicket ticket(maxTraceLevel, adcBailout, sceneData->outputAlpha);
     Ray ray(ticket);
 
+    SetupFootprint(ticket, width);
     colour.Clear();
     V1.Clear();
     S1.Clear();
@@ -90,6 +90,16 @@ class TracePixel final : public Trace
         /// @param[in]  height  Vertical size of the image in pixels.
         /// @param[out] colour  Computed colour of the (sub-)pixel.
         void operator()(DBL x, DBL y, DBL width, DBL height, RGBTColour& colour);
+
+        /// Trace a bundle of neighbouring pixels or sub-pixels.
+        /// Where possible, the primary rays are traced as a packet through the bounding hierarchy;
+        /// otherwise this is equivalent to tracing each (sub-)pixel individually.
+        /// @param[in]  points  Coordinates of the (sub-)pixels' centers.
+        /// @param[in]  count   Number of (sub-)pixels (at most @ref BBOX_PACKET_SIZE).
+        /// @param[in]  width   Horizontal size of the image in pixels.
+        /// @param[in]  height  Vertical size of the image in pixels.
+        /// @param[out] colours Computed colours of the (sub-)pixels.
+        void operator()(const Vector2d points[], int count, DBL width, DBL height, RGBTColour colours[]);
     private:
         // Focal blur data
         class FocalBlurData final
@@ -148,6 +158,7 @@ class TracePixel final : public Trace
         GenericScalarFunctionInstancePtr mpCameraDirectionFn[3];
 
         bool CreateCameraRay(Ray& ray, DBL x, DBL y, DBL width, DBL height, size_t ray_number);
+        void SetupFootprint(TraceTicket& ticket, DBL width) const;
 
         void InitRayContainerState(Ray& ray, bool compute = false);
         void InitRayContainerStateTree(Ray& ray, BBOX_TREE *node);
@@ -150,7 +150,7 @@ namespace pov
 #define TEXTURED_OBJECT             0x0002u ///< Object has texture, possibly in children.
 #define IS_COMPOUND_OBJECT          0x0004u ///< Object has children field.
 #define STURM_OK_OBJECT             0x0008u ///< Object accepts the `sturm` parameter.
-// 0x0010u currently not used
+#define UNBOUNDED_INSIDE_OBJECT     0x0010u ///< Object's inside may extend beyond its bounding box.
 #define LIGHT_SOURCE_OBJECT         0x0020u ///< Object is to be linked in frame.light_sources.
 // 0x0040u currently not used
 // 0x0080u currently not used
@@ -328,6 +328,7 @@ class LightSource final : public CompoundObject
         bool Jitter : 1;
         bool Orient : 1;
         bool Circular : 1;
+        bool Low_Discrepancy : 1; ///< Sample area light at low-discrepancy positions rather than on a grid.
         bool Parallel : 1;
         bool Photon_Area_Light : 1;
         bool Media_Attenuation : 1;
@@ -48,6 +48,8 @@
 #include "base/image/colourspace.h"
 
 // POV-Ray header files (core module)
+#include "core/bounding/bsptree.h"
+#include "core/bounding/bvhtree.h"
 #include "core/material/noise.h"
 #include "core/material/pattern.h"
 #include "core/scene/atmosphere.h"
@@ -79,6 +81,8 @@ SceneData::SceneData() :
     noiseGenerator = kNoiseGen_RangeCorrected;
     explicitNoiseGenerator = false; // scene has not set the noise generator explicitly
     boundingMethod = 0;
+    includeCacheMaxFileSize = POV_OFF_T(64) << 20;
+    textureCacheMemory = size_t(512) << 20;
     numberOfWaves = 10;
     parsedMaxTraceLevel = MAX_TRACE_LEVEL_DEFAULT;
     parsedAdcBailout = 1.0 / 255.0; // adc bailout sufficient for displays
@@ -92,6 +96,9 @@ SceneData::SceneData() :
     subsurfaceSamplesDiffuse = 50;
     subsurfaceSamplesSingle = 50;
     subsurfaceUseRadiosity = false;
+    subsurfaceErrorBound = 0.0;
+
+    lightBudget = 0;
 
     bspMaxDepth = 0;
     bspObjectIsectCost = bspBaseAccessCost = bspChildAccessCost = bspMissChance = 0.0f;
@@ -105,6 +112,7 @@ SceneData::SceneData() :
     removeBounds = true;
 
     tree = nullptr;
+    bvhTree = nullptr;
 }
 
 SceneData::~SceneData()
@@ -134,6 +142,9 @@ SceneData::~SceneData()
 
     if (tree != nullptr)
         delete tree;
+
+    if (bvhTree != nullptr)
+        delete bvhTree;
 }
 
 }
@@ -45,6 +45,7 @@
 
 // C++ standard header files
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -52,7 +53,9 @@
 #include "base/image/colourspace_fwd.h"
 
 // POV-Ray header files (core module)
+#include "core/lighting/lighttree.h"
 #include "core/lighting/radiosity.h"
+#include "core/lighting/subsurface.h"
 #include "core/scene/atmosphere_fwd.h"
 #include "core/scene/camera.h"
 #include "core/shape/truetype.h"
@@ -69,6 +72,7 @@ namespace pov
 using namespace pov_base;
 
 class BSPTree;
+class BVHTree;
 
 /// Class holding scene specific data.
 ///
@@ -97,6 +101,10 @@ class SceneData
         std::vector<LightSource*> lightSources;
         /// list of all lights that are part of light groups
         std::vector<LightSource*> lightGroupLightSources;
+        /// maximum number of global light sources to test per shading point, or 0 to test all of them
+        unsigned int lightBudget;
+        /// tree for picking global light sources to test, if there are more than the budget allows
+        std::shared_ptr<LightTree> lightTree;
         /// factory generating contexts for legacy VM-based functions in scene
         GenericFunctionContextFactoryIPtr functionContextFactory;
         /// atmosphere index of refraction
@@ -157,6 +165,10 @@ class SceneData
         int subsurfaceSamplesSingle;
         /// whether to compute radiosity contribution to subsurface effects
         bool subsurfaceUseRadiosity;
+        /// error bound for the subsurface irradiance cache, or 0 to trace sample rays instead
+        double subsurfaceErrorBound;
+        /// subsurface irradiance caches, built before the main render
+        SubsurfaceCacheTable subsurfaceCaches;
 
         // ********************************************************************************
         // temporary variables for BSP testing ... we may or may not keep these in future
@@ -201,6 +213,14 @@ class SceneData
         // name of the parsed file
         UCS2String inputFile; // TODO - handle differently
         UCS2String headerFile;
+        /// Directory to keep pre-tokenized include files in, or empty if none.
+        UCS2String includeCachePath;
+        /// Size limit for include files to be pre-tokenized, in bytes.
+        POV_OFF_T includeCacheMaxFileSize;
+        /// Directory to keep MIP-mapped copies of image files in, or empty if none.
+        UCS2String textureCachePath;
+        /// Maximum amount of memory to hold tiles of MIP-mapped copies of image files, in bytes.
+        size_t textureCacheMemory;
 
         /// Aspect ratio of the output image.
         DBL aspectRatio;
@@ -226,10 +246,11 @@ class SceneData
 
         // experimental
         BSPTree *tree;
+        BVHTree *bvhTree;
         unsigned int numberOfFiniteObjects;
         unsigned int numberOfInfiniteObjects;
 
-        // BSP statistics // TODO - not sure if this is the best place for stats
+        // BSP and BVH statistics // TODO - not sure if this is the best place for stats
         unsigned int nodes, splitNodes, objectNodes, emptyNodes, maxObjects, maxDepth, aborts;
         float averageObjects, averageDepth, averageAborts, averageAbortObjects;
 
@@ -103,6 +103,7 @@ class TraceThreadData : public ThreadData
         std::vector<BCYL_INT> BCyl_RInt;
         std::vector<BCYL_INT> BCyl_HInt;
         IStackPool stackPool;
+        RefPool<std::vector<unsigned int>> csgCandidatePool;
         std::vector<GenericFunctionContextPtr> functionContextPool;
         int Facets_Last_Seed;
         int Facets_CVC;
@@ -75,6 +75,80 @@ using std::vector;
 #define MERGE_OBJECT        (IS_COMPOUND_OBJECT | IS_CSG_OBJECT)
 #define INTERSECTION_OBJECT (IS_COMPOUND_OBJECT | IS_CSG_OBJECT)
 
+/* Relative amount by which to enlarge the children's bounding boxes in the child tree. */
+#define CSG_CHILD_BBOX_PADDING 1.0e-4
+
+/* Maximum depth of the child tree. */
+#define CSG_CHILD_TREE_MAX_DEPTH 64
+
+/* Maximum number of children per leaf of the child tree. */
+#define CSG_CHILD_TREE_LEAF_SIZE 4
+
+/// Children of a CSG object to visit.
+///
+/// Without a child tree, this is all of the children. With a child tree, it
+/// is the candidates found by the most recent call to @ref FindRayCandidates()
+/// or @ref FindPointCandidates().
+///
+class CSGChildSelection final
+{
+    public:
+
+        CSGChildSelection(const vector<ObjectPtr>& children, const CSGChildTree *tree, TraceThreadData *Thread) :
+            mChildren(children),
+            mpTree(tree),
+            mPool(Thread->csgCandidatePool),
+            mpCandidates((tree != nullptr) ? mPool.alloc() : nullptr)
+        {}
+
+        ~CSGChildSelection()
+        {
+            if (mpCandidates != nullptr)
+            {
+                mpCandidates->clear();
+                mPool.release(mpCandidates);
+            }
+        }
+
+        void FindRayCandidates(const BasicRay& ray)
+        {
+            if (mpTree != nullptr)
+            {
+                mpCandidates->clear();
+                mpTree->FindRayCandidates(ray, *mpCandidates);
+            }
+        }
+
+        /// @return `false` if the point is known to be outside of an intersection.
+        bool FindPointCandidates(const Vector3d& point, unsigned int skip = CSGChildTree::kNoChild)
+        {
+            if (mpTree == nullptr)
+                return true;
+            mpCandidates->clear();
+            return mpTree->FindPointCandidates(point, skip, *mpCandidates);
+        }
+
+        size_t size() const { return (mpCandidates != nullptr) ? mpCandidates->size() : mChildren.size(); }
+
+        /// Index of the i-th child to visit among all the children.
+        unsigned int Index(size_t i) const { return (mpCandidates != nullptr) ? ((*mpCandidates)[i] & ~CSGChildTree::kKnownInside) : (unsigned int)i; }
+
+        /// Whether the i-th child to visit is known to contain the point.
+        bool KnownInside(size_t i) const { return (mpCandidates != nullptr) && (((*mpCandidates)[i] & CSGChildTree::kKnownInside) != 0); }
+
+        ObjectPtr operator[](size_t i) const { return mChildren[Index(i)]; }
+
+    private:
+
+        const vector<ObjectPtr>&            mChildren;
+        const CSGChildTree*                 mpTree;
+        RefPool<vector<unsigned int>>&      mPool;
+        vector<unsigned int>*               mpCandidates;
+
+        CSGChildSelection(const CSGChildSelection&) = delete;
+        CSGChildSelection& operator=(const CSGChildSelection&) = delete;
+};
+
 
 
 inline bool Test_Ray_Flags(const Ray& ray, ConstObjectPtr obj)
@@ -99,6 +173,556 @@ inline bool Test_Ray_Flags_Shadow(const Ray& ray, ConstObjectPtr obj)
              ( ray.IsShadowTestRay() && !Test_Flag(obj, NO_SHADOW_FLAG) ) );
 }
 
+/*****************************************************************************
+*
+* FUNCTION
+*
+*   CSGChildTree::Build
+*
+* INPUT
+*
+*   children     - children of the CSG object
+*   intersection - whether the CSG object is an intersection or difference
+*
+* OUTPUT
+*
+* RETURNS
+*
+* AUTHOR
+*
+*   POV-Ray Team
+*
+* DESCRIPTION
+*
+*   Build a bounding volume hierarchy over the children of a CSG object,
+*   splitting at the median of the box centres along the longest axis.
+*   Small CSG objects don't get a tree at all.
+*
+* CHANGES
+*
+*   -
+*
+******************************************************************************/
+
+CSGChildTree::CSGChildTree() :
+    mNumChildren(0),
+    mNumRequired(0),
+    mIntersection(false)
+{}
+
+void CSGChildTree::Clear()
+{
+    mNodes.clear();
+    mLeafChildren.clear();
+    mUnboundedChildren.clear();
+    mAlwaysTest.clear();
+    mOutsideInside.clear();
+    mOutside.clear();
+    mNumChildren = 0;
+    mNumRequired = 0;
+}
+
+bool CSGChildTree::Build(const vector<ObjectPtr>& children, bool intersection)
+{
+    Clear();
+
+    if ((children.size() < CSG_CHILD_TREE_THRESHOLD) || (children.size() >= kNoChild))
+        return false;
+
+    mIntersection = intersection;
+    mOutside.reserve(children.size());
+
+    vector<MinMaxBoundingBox> boxes(children.size());
+    vector<unsigned int> items;
+    items.reserve(children.size());
+
+    for (unsigned int i = 0; i < children.size(); i++)
+    {
+        ConstObjectPtr child = children[i];
+        OutsideBBox outside = ClassifyOutside(child);
+        mOutside.push_back(outside);
+
+        if (IsUnbounded(child))
+        {
+            mUnboundedChildren.push_back(i);
+            continue;
+        }
+
+        // Enlarge the box a bit, to be on the safe side with respect to the precision of both the
+        // box and the points on the child's surface.
+        Vector3d pmin, pmax;
+        Make_min_max_from_BBox(pmin, pmax, child->BBox);
+        DBL pad = 1.0e-6;
+        for (int j = X; j <= Z; j++)
+            pad = max(pad, max(fabs(pmin[j]), fabs(pmax[j])));
+        pad *= CSG_CHILD_BBOX_PADDING;
+        boxes[i].pmin = BBoxVector3d(pmin - pad);
+        boxes[i].pmax = BBoxVector3d(pmax + pad);
+        items.push_back(i);
+
+        switch (outside)
+        {
+            case kOutsideFalse:
+                if (intersection)
+                    mNumRequired++;
+                break;
+
+            case kOutsideTrue:
+                if (!intersection)
+                    mOutsideInside.push_back(i);
+                break;
+
+            case kOutsideUnknown:
+                mAlwaysTest.push_back(i);
+                break;
+
+            case kOutsideIgnored:
+                break;
+        }
+    }
+
+    if (items.empty())
+    {
+        Clear();
+        return false;
+    }
+
+    mNodes.reserve(2 * items.size());
+    mLeafChildren.reserve(items.size());
+    BuildNode(items, 0, items.size(), boxes);
+    mNumChildren = children.size();
+    return true;
+}
+
+void CSGChildTree::BuildNode(vector<unsigned int>& items, size_t begin, size_t end, const vector<MinMaxBoundingBox>& boxes)
+{
+    size_t nodeIndex = mNodes.size();
+    mNodes.emplace_back();
+
+    BBoxVector3d pmin(boxes[items[begin]].pmin);
+    BBoxVector3d pmax(boxes[items[begin]].pmax);
+    BBoxVector3d cmin(boxes[items[begin]].pmin + boxes[items[begin]].pmax);
+    BBoxVector3d cmax(cmin);
+    for (size_t i = begin + 1; i < end; i++)
+    {
+        const MinMaxBoundingBox& box = boxes[items[i]];
+        pmin = min(pmin, box.pmin);
+        pmax = max(pmax, box.pmax);
+        cmin = min(cmin, box.pmin + box.pmax);
+        cmax = max(cmax, box.pmin + box.pmax);
+    }
+    mNodes[nodeIndex].box.pmin = pmin;
+    mNodes[nodeIndex].box.pmax = pmax;
+
+    BBoxVector3d extent(cmax - cmin);
+    int axis = X;
+    if (extent[Y] > extent[axis])
+        axis = Y;
+    if (extent[Z] > extent[axis])
+        axis = Z;
+
+    if ((end - begin <= CSG_CHILD_TREE_LEAF_SIZE) || (extent[axis] <= 0.0))
+    {
+        mNodes[nodeIndex].first = mLeafChildren.size();
+        mNodes[nodeIndex].count = end - begin;
+        mLeafChildren.insert(mLeafChildren.end(), items.begin() + begin, items.begin() + end);
+        return;
+    }
+
+    size_t mid = begin + (end - begin) / 2;
+    std::nth_element(items.begin() + begin, items.begin() + mid, items.begin() + end,
+                     [&boxes, axis](unsigned int a, unsigned int b)
+                     {
+                         return (boxes[a].pmin[axis] + boxes[a].pmax[axis]) < (boxes[b].pmin[axis] + boxes[b].pmax[axis]);
+                     });
+
+    mNodes[nodeIndex].count = 0;
+    BuildNode(items, begin, mid, boxes);
+    mNodes[nodeIndex].first = mNodes.size();
+    BuildNode(items, mid, end, boxes);
+}
+
+/*****************************************************************************
+*
+* FUNCTION
+*
+*   CSGChildTree::ClassifyOutside
+*
+* INPUT
+*
+*   object - child object
+*
+* OUTPUT
+*
+* RETURNS
+*
+*   What Inside_Object() yields for the object at points outside its
+*   bounding box.
+*
+* AUTHOR
+*
+*   POV-Ray Team
+*
+* DESCRIPTION
+*
+*   Primitives are presumed not to extend beyond their bounding box. This
+*   can't be relied on for objects with clipping or bounding objects, as
+*   those have their bounding boxes trimmed to the clipping or bounding
+*   objects' boxes.
+*
+*   A union is known to contain all points outside its bounding box if any
+*   of its children does, and none of them if none of its children does.
+*   An intersection is known to contain none of the points outside its
+*   bounding box only if it is the intersection of the bounding boxes of
+*   children containing none of them (see CSG::Compute_BBox()).
+*
+* CHANGES
+*
+*   -
+*
+******************************************************************************/
+
+CSGChildTree::OutsideBBox CSGChildTree::ClassifyOutside(ConstObjectPtr object)
+{
+    if (object->Type & LIGHT_SOURCE_OBJECT)
+        return ((reinterpret_cast<const LightSource *>(object))->children.empty() ? kOutsideIgnored : kOutsideUnknown);
+
+    if (!object->Bound.empty() || !object->Clip.empty() || IsUnbounded(object))
+        return kOutsideUnknown;
+
+    if (!(object->Type & IS_CSG_OBJECT))
+        return (Test_Flag(object, INVERTED_FLAG) ? kOutsideTrue : kOutsideFalse);
+
+    const CSG *csg = static_cast<const CSG *>(object);
+    if (csg->Is_Intersection())
+    {
+        // The bounding box is taken from (some of) the non-inverted children, so it confines the intersection
+        // if all of those are confined to their own bounding boxes.
+        bool haveBoxFromChildren = false;
+        for (vector<ObjectPtr>::const_iterator Current_Sib = csg->children.begin(); Current_Sib != csg->children.end(); Current_Sib++)
+        {
+            if (!Test_Flag((*Current_Sib), INVERTED_FLAG))
+            {
+                if (ClassifyOutside(*Current_Sib) != kOutsideFalse)
+                    return kOutsideUnknown;
+                haveBoxFromChildren = true;
+            }
+        }
+        return (haveBoxFromChildren ? kOutsideFalse : kOutsideUnknown);
+    }
+    else
+    {
+        OutsideBBox result = kOutsideFalse;
+        for (vector<ObjectPtr>::const_iterator Current_Sib = csg->children.begin(); Current_Sib != csg->children.end(); Current_Sib++)
+        {
+            switch (ClassifyOutside(*Current_Sib))
+            {
+                case kOutsideTrue:
+                    return kOutsideTrue;
+
+                case kOutsideUnknown:
+                    result = kOutsideUnknown;
+                    break;
+
+                default:
+                    break;
+            }
+        }
+        return result;
+    }
+}
+
+/*****************************************************************************
+*
+* FUNCTION
+*
+*   CSGChildTree::IsUnbounded
+*
+* INPUT
+*
+*   object - child object
+*
+* OUTPUT
+*
+* RETURNS
+*
+*   Whether the object's bounding box is of no help.
+*
+* AUTHOR
+*
+*   POV-Ray Team
+*
+* DESCRIPTION
+*
+*   Besides infinite objects, this covers objects whose inside may extend
+*   beyond their bounding box, such as quadrics (whose bounding box may be
+*   confined to the range of their siblings in an intersection), discs
+*   (whose inside is a half-space) and polynomials, as well as light
+*   sources.
+*
+* CHANGES
+*
+*   -
+*
+******************************************************************************/
+
+bool CSGChildTree::IsUnbounded(ConstObjectPtr object)
+{
+    if (object->Type & (LIGHT_SOURCE_OBJECT | UNBOUNDED_INSIDE_OBJECT))
+        return true;
+
+    return (object->BBox.isEmpty() ||
+            (object->BBox.size[X] > CRITICAL_LENGTH) ||
+            (object->BBox.size[Y] > CRITICAL_LENGTH) ||
+            (object->BBox.size[Z] > CRITICAL_LENGTH));
+}
+
+/*****************************************************************************
+*
+* FUNCTION
+*
+*   CSGChildTree::FindRayCandidates
+*
+* INPUT
+*
+*   ray - ray to test
+*
+* OUTPUT
+*
+*   candidates - indices of children the ray may hit, in ascending order
+*
+* RETURNS
+*
+* AUTHOR
+*
+*   POV-Ray Team
+*
+* DESCRIPTION
+*
+*   -
+*
+* CHANGES
+*
+*   -
+*
+******************************************************************************/
+
+void CSGChildTree::FindRayCandidates(const BasicRay& ray, vector<unsigned int>& candidates) const
+{
+    Vector3d invDirection;
+    bool parallel[3];
+    for (int i = X; i <= Z; i++)
+    {
+        parallel[i] = (ray.Direction[i] == 0.0);
+        invDirection[i] = (parallel[i] ? 0.0 : 1.0 / ray.Direction[i]);
+    }
+
+    unsigned int stack[CSG_CHILD_TREE_MAX_DEPTH];
+    int stackSize = 0;
+    unsigned int nodeIndex = 0;
+
+    candidates.insert(candidates.end(), mUnboundedChildren.begin(), mUnboundedChildren.end());
+
+    while (true)
+    {
+        const Node& node = mNodes[nodeIndex];
+
+        DBL tmin = 0.0;
+        DBL tmax = BOUND_HUGE;
+        bool hit = true;
+        for (int i = X; (i <= Z) && hit; i++)
+        {
+            if (parallel[i])
+                hit = (ray.Origin[i] >= node.box.pmin[i]) && (ray.Origin[i] <= node.box.pmax[i]);
+            else
+            {
+                DBL t1 = (node.box.pmin[i] - ray.Origin[i]) * invDirection[i];
+                DBL t2 = (node.box.pmax[i] - ray.Origin[i]) * invDirection[i];
+                if (t1 > t2)
+                    std::swap(t1, t2);
+                tmin = max(tmin, t1);
+                tmax = min(tmax, t2);
+                hit = (tmin <= tmax);
+            }
+        }
+
+        if (hit)
+        {
+            if (node.count > 0)
+                candidates.insert(candidates.end(), mLeafChildren.begin() + node.first, mLeafChildren.begin() + node.first + node.count);
+            else
+            {
+                POV_SHAPE_ASSERT(stackSize < CSG_CHILD_TREE_MAX_DEPTH);
+                stack[stackSize++] = node.first;
+                nodeIndex++;
+                continue;
+            }
+        }
+
+        if (stackSize == 0)
+            break;
+        nodeIndex = stack[--stackSize];
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+}
+
+/*****************************************************************************
+*
+* FUNCTION
+*
+*   CSGChildTree::FindPointCandidates
+*
+* INPUT
+*
+*   point - point to test
+*   skip  - index of child to disregard
+*
+* OUTPUT
+*
+*   candidates - indices of children that need testing, in ascending order
+*
+* RETURNS
+*
+*   false if the point is known to be outside the intersection
+*
+* AUTHOR
+*
+*   POV-Ray Team
+*
+* DESCRIPTION
+*
+*   -
+*
+* CHANGES
+*
+*   -
+*
+******************************************************************************/
+
+bool CSGChildTree::FindPointCandidates(const Vector3d& point, unsigned int skip, vector<unsigned int>& candidates) const
+{
+    unsigned int stack[CSG_CHILD_TREE_MAX_DEPTH];
+    int stackSize = 0;
+    unsigned int nodeIndex = 0;
+    size_t numRequired = mNumRequired;
+    size_t numRequiredFound = 0;
+
+    if ((skip != kNoChild) && mIntersection && (mOutside[skip] == kOutsideFalse) &&
+        !std::binary_search(mUnboundedChildren.begin(), mUnboundedChildren.end(), skip))
+        numRequired--;
+
+    for (vector<unsigned int>::const_iterator i = mUnboundedChildren.begin(); i != mUnboundedChildren.end(); i++)
+        if ((*i != skip) && (mOutside[*i] != kOutsideIgnored))
+            candidates.push_back(*i);
+
+    while (true)
+    {
+        const Node& node = mNodes[nodeIndex];
+
+        if ((point[X] >= node.box.pmin[X]) && (point[X] <= node.box.pmax[X]) &&
+            (point[Y] >= node.box.pmin[Y]) && (point[Y] <= node.box.pmax[Y]) &&
+            (point[Z] >= node.box.pmin[Z]) && (point[Z] <= node.box.pmax[Z]))
+        {
+            if (node.count > 0)
+            {
+                for (unsigned int i = node.first; i < node.first + node.count; i++)
+                {
+                    unsigned int child = mLeafChildren[i];
+                    if (child == skip)
+                        continue;
+                    switch (mOutside[child])
+                    {
+                        case kOutsideFalse:
+                            if (mIntersection)
+                                numRequiredFound++;
+                            candidates.push_back(child);
+                            break;
+
+                        case kOutsideTrue:
+                            candidates.push_back(child);
+                            break;
+
+                        case kOutsideUnknown:
+                        case kOutsideIgnored:
+                            // Unknown ones are taken care of separately.
+                            break;
+                    }
+                }
+            }
+            else
+            {
+                POV_SHAPE_ASSERT(stackSize < CSG_CHILD_TREE_MAX_DEPTH);
+                stack[stackSize++] = node.first;
+                nodeIndex++;
+                continue;
+            }
+        }
+
+        if (stackSize == 0)
+            break;
+        nodeIndex = stack[--stackSize];
+    }
+
+    if (numRequiredFound < numRequired)
+        return false;
+
+    for (vector<unsigned int>::const_iterator i = mAlwaysTest.begin(); i != mAlwaysTest.end(); i++)
+        if (*i != skip)
+            candidates.push_back(*i);
+
+    if (!mIntersection)
+    {
+        // Children known to contain the point, unless already found to need testing.
+        size_t numTested = candidates.size();
+        for (vector<unsigned int>::const_iterator i = mOutsideInside.begin(); i != mOutsideInside.end(); i++)
+            if ((*i != skip) && (std::find(candidates.begin(), candidates.begin() + numTested, *i) == candidates.begin() + numTested))
+                candidates.push_back(*i | kKnownInside);
+    }
+
+    std::sort(candidates.begin(), candidates.end(),
+              [](unsigned int a, unsigned int b) { return (a & ~kKnownInside) < (b & ~kKnownInside); });
+    return true;
+}
+
+/*****************************************************************************
+*
+* FUNCTION
+*
+*   CSG::Build_Child_Tree
+*
+* INPUT
+*
+* OUTPUT
+*
+* RETURNS
+*
+* AUTHOR
+*
+*   POV-Ray Team
+*
+* DESCRIPTION
+*
+*   (Re-)build the child tree if the object has sufficiently many children.
+*
+* CHANGES
+*
+*   -
+*
+******************************************************************************/
+
+void CSG::Build_Child_Tree()
+{
+    childTree.reset();
+
+    if (children.size() >= CSG_CHILD_TREE_THRESHOLD)
+    {
+        std::shared_ptr<CSGChildTree> tree(new CSGChildTree);
+        if (tree->Build(children, Is_Intersection()))
+            childTree = tree;
+    }
+}
+
 /*****************************************************************************
 *
 * FUNCTION
@@ -133,17 +757,21 @@ bool CSGUnion::All_Intersections(const Ray& ray, IStack& Depth_Stack, TraceThrea
 
     Found = false;
 
+    CSGChildSelection Sibs(children, Child_Tree(), Thread);
+    Sibs.FindRayCandidates(ray);
+
     // Use shortcut if no clip.
 
     if(Clip.empty())
     {
-        for(vector<ObjectPtr>::const_iterator Current_Sib = children.begin(); Current_Sib != children.end(); Current_Sib++)
+        for(size_t i = 0; i < Sibs.size(); i++)
         {
-            if(Test_Ray_Flags(ray, (*Current_Sib))) // TODO CLARIFY - why does CSGUnion use Test_Ray_Flags(), while CSGMerge uses Test_Ray_Flags_Shadow(), and CSGIntersection uses neither?
+            ObjectPtr Current_Sib = Sibs[i];
+            if(Test_Ray_Flags(ray, Current_Sib)) // TODO CLARIFY - why does CSGUnion use Test_Ray_Flags(), while CSGMerge uses Test_Ray_Flags_Shadow(), and CSGIntersection uses neither?
             {
-                if((*Current_Sib)->Bound.empty() == true || Ray_In_Bound(ray, (*Current_Sib)->Bound, Thread))
+                if(Current_Sib->Bound.empty() == true || Ray_In_Bound(ray, Current_Sib->Bound, Thread))
                 {
-                    if((*Current_Sib)->All_Intersections(ray, Depth_Stack, Thread))
+                    if(Current_Sib->All_Intersections(ray, Depth_Stack, Thread))
                         Found = true;
                 }
             }
@@ -154,13 +782,14 @@ bool CSGUnion::All_Intersections(const Ray& ray, IStack& Depth_Stack, TraceThrea
         IStack Local_Stack(Thread->stackPool);
         POV_REFPOOL_ASSERT(Local_Stack->empty()); // verify that the IStack pulled from the pool is in a cleaned-up condition
 
-        for(vector<ObjectPtr>::const_iterator Current_Sib = children.begin(); Current_Sib != children.end(); Current_Sib++)
+        for(size_t i = 0; i < Sibs.size(); i++)
         {
-            if(Test_Ray_Flags(ray, (*Current_Sib))) // TODO CLARIFY - why does CSGUnion use Test_Ray_Flags(), while CSGMerge uses Test_Ray_Flags_Shadow(), and CSGIntersection uses neither?
+            ObjectPtr Current_Sib = Sibs[i];
+            if(Test_Ray_Flags(ray, Current_Sib)) // TODO CLARIFY - why does CSGUnion use Test_Ray_Flags(), while CSGMerge uses Test_Ray_Flags_Shadow(), and CSGIntersection uses neither?
             {
-                if((*Current_Sib)->Bound.empty() == true || Ray_In_Bound(ray, (*Current_Sib)->Bound, Thread))
+                if(Current_Sib->Bound.empty() == true || Ray_In_Bound(ray, Current_Sib->Bound, Thread))
                 {
-                    if((*Current_Sib)->All_Intersections (ray, Local_Stack, Thread))
+                    if(Current_Sib->All_Intersections (ray, Local_Stack, Thread))
                     {
                         while(Local_Stack->size() > 0)
                         {
@@ -226,27 +855,31 @@ bool CSGIntersection::All_Intersections(const Ray& ray, IStack& Depth_Stack, Tra
 
     Found = false;
 
-    for(vector<ObjectPtr>::const_iterator Current_Sib = children.begin(); Current_Sib != children.end(); Current_Sib++)
+    const CSGChildTree *tree = Child_Tree();
+    CSGChildSelection Sibs(children, tree, Thread);
+    CSGChildSelection Inside_Sibs(children, tree, Thread);
+    Sibs.FindRayCandidates(ray);
+
+    for(size_t i = 0; i < Sibs.size(); i++)
     {
-        if ((*Current_Sib)->Bound.empty() == true || Ray_In_Bound(ray, (*Current_Sib)->Bound, Thread))
+        ObjectPtr Current_Sib = Sibs[i];
+        if (Current_Sib->Bound.empty() == true || Ray_In_Bound(ray, Current_Sib->Bound, Thread))
         {
-            if((*Current_Sib)->All_Intersections(ray, Local_Stack, Thread))
+            if(Current_Sib->All_Intersections(ray, Local_Stack, Thread))
             {
                 while(Local_Stack->size() > 0)
                 {
-                    Maybe_Found = true;
+                    Maybe_Found = Inside_Sibs.FindPointCandidates(Local_Stack->top().IPoint, Sibs.Index(i));
 
-                    for(vector<ObjectPtr>::const_iterator Inside_Sib = children.begin(); Inside_Sib != children.end(); Inside_Sib++)
+                    for(size_t j = 0; Maybe_Found && (j < Inside_Sibs.size()); j++)
                     {
-                        if(*Inside_Sib != *Current_Sib)
+                        ObjectPtr Inside_Sib = Inside_Sibs[j];
+                        if(Inside_Sib != Current_Sib)
                         {
-                            if(!((*Inside_Sib)->Type & LIGHT_SOURCE_OBJECT) || (!(reinterpret_cast<LightSource *>(*Inside_Sib))->children.empty()))
+                            if(!(Inside_Sib->Type & LIGHT_SOURCE_OBJECT) || (!(reinterpret_cast<LightSource *>(Inside_Sib))->children.empty()))
                             {
-                                if(!Inside_Object(Local_Stack->top().IPoint, *Inside_Sib, Thread))
-                                {
+                                if(!Inside_Object(Local_Stack->top().IPoint, Inside_Sib, Thread))
                                     Maybe_Found = false;
-                                    break;
-                                }
                             }
                         }
                     }
@@ -315,19 +948,19 @@ bool CSGMerge::All_Intersections(const Ray& ray, IStack& Depth_Stack, TraceThrea
 
     Found = false;
 
-    // FIXME - though the name is misleading, the OPTIMISE_SHADOW_TEST flag can be used to
-    //  determine if we're in a shadow ray, but it SHOULD be renamed.
-    // We should probably change Optimization_Flags to a "ray-type" variable, that will tell
-    // us if it is primary, reflection, refraction, shadow, primary photon, photon refleciton, or photon refraction ray.
-    int shadow_flag = ray.IsShadowTestRay(); // TODO FIXME - why is this flag not used?!
+    const CSGChildTree *tree = Child_Tree();
+    CSGChildSelection Sibs(children, tree, Thread);
+    CSGChildSelection Inside_Sibs(children, tree, Thread);
+    Sibs.FindRayCandidates(ray);
 
-    for(vector<ObjectPtr>::const_iterator Sib1 = children.begin(); Sib1 != children.end(); Sib1++)
+    for(size_t i = 0; i < Sibs.size(); i++)
     {
-        if ( Test_Ray_Flags_Shadow(ray, (*Sib1)) )// TODO CLARIFY - why does CSGUnion use Test_Ray_Flags(), while CSGMerge uses Test_Ray_Flags_Shadow(), and CSGIntersection uses neither?
+        ObjectPtr Sib1 = Sibs[i];
+        if ( Test_Ray_Flags_Shadow(ray, Sib1) )// TODO CLARIFY - why does CSGUnion use Test_Ray_Flags(), while CSGMerge uses Test_Ray_Flags_Shadow(), and CSGIntersection uses neither?
         {
-            if ((*Sib1)->Bound.empty() == true || Ray_In_Bound (ray, (*Sib1)->Bound, Thread))
+            if (Sib1->Bound.empty() == true || Ray_In_Bound (ray, Sib1->Bound, Thread))
             {
-                if ((*Sib1)->All_Intersections (ray, Local_Stack, Thread))
+                if (Sib1->All_Intersections (ray, Local_Stack, Thread))
                 {
                     while (Local_Stack->size() > 0)
                     {
@@ -335,15 +968,18 @@ bool CSGMerge::All_Intersections(const Ray& ray, IStack& Depth_Stack, TraceThrea
                         {
                             inside_flag = true;
 
-                            for(vector<ObjectPtr>::const_iterator Sib2 = children.begin(); (Sib2 != children.end()) && (inside_flag == true); Sib2++)
+                            Inside_Sibs.FindPointCandidates(Local_Stack->top().IPoint, Sibs.Index(i));
+
+                            for(size_t j = 0; (j < Inside_Sibs.size()) && (inside_flag == true); j++)
                             {
-                                if (*Sib1 != *Sib2)
+                                ObjectPtr Sib2 = Inside_Sibs[j];
+                                if (Sib1 != Sib2)
                                 {
-                                    if (!((*Sib2)->Type & LIGHT_SOURCE_OBJECT) || (!(reinterpret_cast<LightSource *>(*Sib2))->children.empty()))
+                                    if (!(Sib2->Type & LIGHT_SOURCE_OBJECT) || (!(reinterpret_cast<LightSource *>(Sib2))->children.empty()))
                                     {
-                                        if ( Test_Ray_Flags_Shadow(ray, (*Sib2)) )// TODO CLARIFY - why does CSGUnion use Test_Ray_Flags(), while CSGMerge uses Test_Ray_Flags_Shadow(), and CSGIntersection uses neither?
+                                        if ( Test_Ray_Flags_Shadow(ray, Sib2) )// TODO CLARIFY - why does CSGUnion use Test_Ray_Flags(), while CSGMerge uses Test_Ray_Flags_Shadow(), and CSGIntersection uses neither?
                                         {
-                                            if (Inside_Object(Local_Stack->top().IPoint, *Sib2, Thread))
+                                            if (Inside_Sibs.KnownInside(j) || Inside_Object(Local_Stack->top().IPoint, Sib2, Thread))
                                                 inside_flag = false;
                                         }
                                     }
@@ -404,11 +1040,15 @@ bool CSGMerge::All_Intersections(const Ray& ray, IStack& Depth_Stack, TraceThrea
 
 bool CSGUnion::Inside(const Vector3d& IPoint, TraceThreadData *Thread) const
 {
-    for(vector<ObjectPtr>::const_iterator Current_Sib = children.begin(); Current_Sib != children.end(); Current_Sib++)
+    CSGChildSelection Sibs(children, Child_Tree(), Thread);
+    Sibs.FindPointCandidates(IPoint);
+
+    for(size_t i = 0; i < Sibs.size(); i++)
     {
-        if(!((*Current_Sib)->Type & LIGHT_SOURCE_OBJECT) || (!(reinterpret_cast<LightSource *>(*Current_Sib))->children.empty()))
+        ObjectPtr Current_Sib = Sibs[i];
+        if(!(Current_Sib->Type & LIGHT_SOURCE_OBJECT) || (!(reinterpret_cast<LightSource *>(Current_Sib))->children.empty()))
         {
-            if(Inside_Object(IPoint, *Current_Sib, Thread))
+            if(Sibs.KnownInside(i) || Inside_Object(IPoint, Current_Sib, Thread))
                 return (true);
         }
     }
@@ -446,16 +1086,22 @@ bool CSGUnion::Inside(const Vector3d& IPoint, TraceThreadData *Thread) const
 
 bool CSGIntersection::Inside(const Vector3d& IPoint, TraceThreadData *Thread) const
 {
-    for(vector<ObjectPtr>::const_iterator Current_Sib = children.begin(); Current_Sib != children.end(); Current_Sib++)
-        if(!((*Current_Sib)->Type & LIGHT_SOURCE_OBJECT) || (!(reinterpret_cast<LightSource *>(*Current_Sib))->children.empty()))
-            if(!Inside_Object(IPoint, (*Current_Sib), Thread))
+    CSGChildSelection Sibs(children, Child_Tree(), Thread);
+    if(!Sibs.FindPointCandidates(IPoint))
+        return (false);
+
+    for(size_t i = 0; i < Sibs.size(); i++)
+    {
+        ObjectPtr Current_Sib = Sibs[i];
+        if(!(Current_Sib->Type & LIGHT_SOURCE_OBJECT) || (!(reinterpret_cast<LightSource *>(Current_Sib))->children.empty()))
+            if(!Inside_Object(IPoint, Current_Sib, Thread))
                 return (false);
+    }
     return (true);
 }
 
 
 
-
 /*****************************************************************************
 *
 * FUNCTION
@@ -489,6 +1135,8 @@ void CSG::Translate(const Vector3d& Vector, const TRANSFORM *tr)
         Translate_Object (*Current_Sib, Vector, tr) ;
 
     Recompute_BBox(&BBox, tr);
+
+    Build_Child_Tree();
 }
 
 
@@ -526,6 +1174,8 @@ void CSG::Rotate(const Vector3d& Vector, const TRANSFORM *tr)
         Rotate_Object (*Current_Sib, Vector, tr) ;
 
     Recompute_BBox(&BBox, tr);
+
+    Build_Child_Tree();
 }
 
 
@@ -563,6 +1213,8 @@ void CSG::Scale(const Vector3d& Vector, const TRANSFORM *tr)
         Scale_Object (*Current_Sib, Vector, tr) ;
 
     Recompute_BBox(&BBox, tr);
+
+    Build_Child_Tree();
 }
 
 
@@ -600,6 +1252,8 @@ void CSG::Transform(const TRANSFORM *tr)
         Transform_Object(*Current_Sib, tr);
 
     Recompute_BBox(&BBox, tr);
+
+    Build_Child_Tree();
 }
 
 /*****************************************************************************
@@ -632,6 +1286,7 @@ ObjectPtr CSGUnion::Invert()
     POV_SHAPE_ASSERT(p == this);
 
     CSGIntersection *New = new CSGIntersection(false, *this, true);
+    New->Build_Child_Tree();
     delete this;
     return (New);
 }
@@ -642,6 +1297,7 @@ ObjectPtr CSGIntersection::Invert()
     POV_SHAPE_ASSERT(p == this);
 
     CSGMerge *New = new CSGMerge(*this, true);
+    New->Build_Child_Tree();
     delete this;
     return (New);
 }
@@ -963,6 +1619,8 @@ void CSG::Compute_BBox()
                 Make_BBox(BBox, -BOUND_HUGE/2, -BOUND_HUGE/2, -BOUND_HUGE/2, BOUND_HUGE, BOUND_HUGE, BOUND_HUGE);
         }
     }
+
+    Build_Child_Tree();
 }
 
 
@@ -1014,14 +1672,20 @@ void CSG::Determine_Textures(Intersection *isect, bool hitinside, WeightedTextur
         {
             size_t firstinserted = textures.size();
 
-            for(vector<ObjectPtr>::const_iterator Current_Sib = children.begin(); Current_Sib != children.end(); Current_Sib++)
+            // For unions and merges, the child tree can tell which children may contain the point;
+            // for intersections it omits the ones known to contain it, so we need to go through them all.
+            CSGChildSelection Sibs(children, Is_Intersection() ? nullptr : Child_Tree(), threaddata);
+            Sibs.FindPointCandidates(isect->IPoint);
+
+            for(size_t i = 0; i < Sibs.size(); i++)
             {
-                if((*Current_Sib)->Inside(isect->IPoint, threaddata))
+                ObjectPtr Current_Sib = Sibs[i];
+                if(Sibs.KnownInside(i) || Current_Sib->Inside(isect->IPoint, threaddata))
                 {
-                    if((*Current_Sib)->Type & IS_COMPOUND_OBJECT)
-                        (*Current_Sib)->Determine_Textures(isect, hitinside, textures, threaddata);
-                    else if ((*Current_Sib)->Texture != nullptr)
-                        textures.push_back(WeightedTexture(1.0, (*Current_Sib)->Texture));
+                    if(Current_Sib->Type & IS_COMPOUND_OBJECT)
+                        Current_Sib->Determine_Textures(isect, hitinside, textures, threaddata);
+                    else if (Current_Sib->Texture != nullptr)
+                        textures.push_back(WeightedTexture(1.0, Current_Sib->Texture));
                 }
             }
 
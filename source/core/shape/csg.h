@@ -41,9 +41,12 @@
 #include "core/shape/csg_fwd.h"
 
 // C++ variants of C standard header files
-// C++ standard header files
 //  (none at the moment)
 
+// C++ standard header files
+#include <memory>
+#include <vector>
+
 // POV-Ray header files (base module)
 //  (none at the moment)
 
@@ -73,10 +76,115 @@ namespace pov
 
 
 
+/// Minimum number of children for a CSG object to build a @ref CSGChildTree.
+#define CSG_CHILD_TREE_THRESHOLD   8
+
+
+
 /*****************************************************************************
 * Global typedefs
 ******************************************************************************/
 
+/// Bounding volume hierarchy over the children of a CSG object.
+///
+/// Allows CSG objects with many children (e.g. a wall with hundreds of windows
+/// cut out) to find the children a ray may hit, or a point may be inside of,
+/// without testing each and every one of them.
+///
+/// Besides its bounding box, the tree records for each child what an inside
+/// test yields for points outside the box: Non-inverted objects are presumed
+/// not to extend beyond their bounding box (as the top-level bounding code
+/// does), so they are known to be outside; inverted ones are known to be
+/// inside. Children for which this cannot be told (e.g. quadrics, whose
+/// bounding boxes may be confined by the parent, or objects with a manual
+/// bounding shape) are always tested.
+///
+/// @note   The tree refers to children by index, so it can be shared when the
+///         CSG object is copied, but must be rebuilt whenever the children
+///         change.
+///
+class CSGChildTree final
+{
+    public:
+
+        /// Flag marking a child as known to contain the point in @ref FindPointCandidates().
+        static const unsigned int kKnownInside = 0x80000000u;
+
+        /// Pseudo-index for @ref FindPointCandidates() to not skip any child.
+        static const unsigned int kNoChild = 0x7FFFFFFFu;
+
+        CSGChildTree();
+
+        /// Build the tree.
+        ///
+        /// @param[in]  children        Children of the CSG object.
+        /// @param[in]  intersection    Whether the CSG object is an intersection (or difference), as
+        ///                             opposed to a union or merge.
+        /// @return                     `false` if the tree would be of no help.
+        ///
+        bool Build(const std::vector<ObjectPtr>& children, bool intersection);
+
+        /// Test whether the tree has been built for the given children.
+        bool IsValid(const std::vector<ObjectPtr>& children) const { return (mNumChildren == children.size()); }
+
+        /// Find the children that a ray may intersect.
+        ///
+        /// @param[in]  ray             Ray to test.
+        /// @param[out] candidates      Indices of the candidate children, in ascending order.
+        ///
+        void FindRayCandidates(const BasicRay& ray, std::vector<unsigned int>& candidates) const;
+
+        /// Find the children that need to be tested for whether they contain a point.
+        ///
+        /// For a union or merge, children known to contain the point are included as well, marked
+        /// with @ref kKnownInside. For an intersection, they are omitted instead, and the search
+        /// is aborted as soon as a child is found to not contain the point.
+        ///
+        /// Children that are ignored by inside tests (light sources without `looks_like` object)
+        /// are never included.
+        ///
+        /// @param[in]  point           Point to test.
+        /// @param[in]  skip            Index of a child to disregard, or @ref kNoChild.
+        /// @param[out] candidates      Indices of the candidate children, in ascending order.
+        /// @return                     `false` if the point is known to be outside of the
+        ///                             intersection, `true` otherwise.
+        ///
+        bool FindPointCandidates(const Vector3d& point, unsigned int skip, std::vector<unsigned int>& candidates) const;
+
+    private:
+
+        /// What an inside test yields for points outside a child's bounding box.
+        enum OutsideBBox : unsigned char
+        {
+            kOutsideFalse,      ///< Point is not inside the child.
+            kOutsideTrue,       ///< Point is inside the child.
+            kOutsideUnknown,    ///< Child needs to be tested.
+            kOutsideIgnored,    ///< Child is ignored by inside tests.
+        };
+
+        struct Node final
+        {
+            MinMaxBoundingBox   box;
+            unsigned int        first;  ///< Leaf: Index of first entry in @ref mLeafChildren; Inner node: Index of second sub-node.
+            unsigned int        count;  ///< Leaf: Number of entries; Inner node: 0.
+        };
+
+        std::vector<Node>           mNodes;             ///< Tree nodes, first sub-node of each inner node immediately following it.
+        std::vector<unsigned int>   mLeafChildren;      ///< Children referenced by the leaves.
+        std::vector<unsigned int>   mUnboundedChildren; ///< Children not in the tree, as their bounding box is no help.
+        std::vector<unsigned int>   mAlwaysTest;        ///< Children in the tree that must be tested even outside their bounding box.
+        std::vector<unsigned int>   mOutsideInside;     ///< Children in the tree known to be inside outside their bounding box (unions only).
+        std::vector<OutsideBBox>    mOutside;           ///< Per-child behaviour outside the bounding box.
+        size_t                      mNumChildren;       ///< Number of children the tree was built for.
+        size_t                      mNumRequired;       ///< Number of children in the tree known not to contain points outside their bounding box (intersections only).
+        bool                        mIntersection;      ///< Whether the tree belongs to an intersection.
+
+        void Clear();
+        static OutsideBBox ClassifyOutside(ConstObjectPtr object);
+        static bool IsUnbounded(ConstObjectPtr object);
+        void BuildNode(std::vector<unsigned int>& items, size_t begin, size_t end, const std::vector<MinMaxBoundingBox>& boxes);
+};
+
 class CSG : public CompoundObject
 {
     public:
@@ -85,6 +193,12 @@ class CSG : public CompoundObject
 
         int do_split;
 
+        /// Bounding hierarchy over the children, if there are sufficiently many of them.
+        std::shared_ptr<const CSGChildTree> childTree;
+
+        /// Rebuild the bounding hierarchy over the children.
+        void Build_Child_Tree();
+
         virtual void Normal(Vector3d&, Intersection *, TraceThreadData *) const override { }
         virtual void Translate(const Vector3d&, const TRANSFORM *) override;
         virtual void Rotate(const Vector3d&, const TRANSFORM *) override;
@@ -94,6 +208,14 @@ class CSG : public CompoundObject
         virtual void Compute_BBox() override;
 
         virtual void Determine_Textures(Intersection *isect, bool hitinside, WeightedTextureVector& textures, TraceThreadData *Threaddata) override;
+
+        /// Test whether the object is an intersection (or difference), as opposed to a union or merge.
+        virtual bool Is_Intersection() const { return false; }
+
+    protected:
+
+        /// Bounding hierarchy over the children, or `nullptr` if there is none or it is out of date.
+        const CSGChildTree *Child_Tree() const { return ((childTree != nullptr) && childTree->IsValid(children)) ? childTree.get() : nullptr; }
 };
 
 class CSGUnion : public CSG
@@ -132,6 +254,7 @@ class CSGIntersection final : public CSG
         virtual bool All_Intersections(const Ray&, IStack&, TraceThreadData *) override;
         virtual bool Inside(const Vector3d&, TraceThreadData *) const override;
         virtual ObjectPtr Invert() override;
+        virtual bool Is_Intersection() const override { return true; }
 
         bool isDifference;
 };
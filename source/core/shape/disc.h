@@ -64,7 +64,7 @@ namespace pov
 ///
 /// @{
 
-#define DISC_OBJECT            (BASIC_OBJECT)
+#define DISC_OBJECT            (BASIC_OBJECT+UNBOUNDED_INSIDE_OBJECT)
 
 /// @}
 ///
@@ -53,6 +53,9 @@
 *
 *  Feb 1995 : Major rewrite of the height field intersection tests. [DB]
 *
+*  Oct 2026 : Replaced the two-level block grid with a min/max pyramid
+*             of the height values, traversed hierarchically.
+*
 *****************************************************************************/
 
 // Unit header file must be the first file included within POV-Ray *.cpp files (pulls in config)
@@ -63,6 +66,7 @@
 
 // C++ standard header files
 #include <algorithm>
+#include <vector>
 
 // POV-Ray header files (base module)
 #include "base/pov_err.h"
@@ -98,6 +102,10 @@ const DBL HFIELD_OFFSET = 0.001;
 
 const DBL HFIELD_TOLERANCE = 1.0e-6;
 
+/* Size of the blocks of grid cells forming the bottom of the pyramid. */
+
+const int HFIELD_BLOCK_SIZE = 8;
+
 
 //****************************************************************************
 // Local Types
@@ -111,17 +119,34 @@ struct HFBlock final
     DBL ymin, ymax;
 };
 
+/// Range of height values within a node of the height field pyramid.
+struct HFBounds final
+{
+    HF_VAL min_y, max_y;
+};
+
+/// Level of the height field pyramid.
+///
+/// Each node of level 0 covers a block of @ref HFIELD_BLOCK_SIZE by
+/// @ref HFIELD_BLOCK_SIZE grid cells; each node of the levels above covers
+/// (up to) 2 by 2 nodes of the level below. The topmost level has a single
+/// node covering the entire height field.
+///
+struct HFLevel final
+{
+    int size_x, size_z;
+    std::vector<HFBounds> Bounds;
+};
+
 struct HFData final
 {
     int References;
     int Normals_Height;  /* Needed for Destructor */
     int max_x, max_z;
     HF_VAL min_y, max_y;
-    int block_max_x, block_max_z;
-    int block_width_x, block_width_z;
     HF_VAL **Map;
     HF_Normals **Normals;
-    HFBlock **Block;
+    std::vector<HFLevel> Pyramid;
 };
 
 
@@ -913,7 +938,7 @@ void HField::Compute_HField(const ImageData *image)
     Data->max_x = max_x-2;
     Data->max_z = max_z-2;
 
-    build_hfield_blocks();
+    build_hfield_pyramid();
 }
 
 
@@ -922,7 +947,7 @@ void HField::Compute_HField(const ImageData *image)
 *
 * FUNCTION
 *
-*   build_hfield_blocks
+*   build_hfield_pyramid
 *
 * INPUT
 *
@@ -936,125 +961,114 @@ void HField::Compute_HField(const ImageData *image)
 *
 * DESCRIPTION
 *
-*   Create the bounding block hierarchy used by the block traversal.
+*   Create the bounding hierarchy used by the pyramid traversal: A pyramid
+*   of minimum and maximum heights, the bottom level of which covers
+*   blocks of HFIELD_BLOCK_SIZE x HFIELD_BLOCK_SIZE grid cells, while each
+*   level above covers 2 x 2 nodes of the level below.
 *
 * CHANGES
 *
 *   Feb 1995 : Creation.
 *
+*   Oct 2026 : Changed from a single level of blocks to a pyramid.
+*
 ******************************************************************************/
 
-void HField::build_hfield_blocks()
+void HField::build_hfield_pyramid()
 {
-    int x, z, nx, nz, wx, wz;
-    int i, j;
+    int x, z, nx, nz;
+    int i, j, level;
     int xmin, xmax, zmin, zmax;
-    DBL y, ymin, ymax, water;
-
-    /* Get block size. */
+    HF_VAL y;
+    HFBounds bounds;
 
-    nx = max(1, (int)(sqrt((DBL)Data->max_x)));
-    nz = max(1, (int)(sqrt((DBL)Data->max_z)));
+    Data->Pyramid.clear();
 
-    /* Get dimensions of sub-block. */
+    /* Get number of blocks. */
 
-    wx = (int)ceil((DBL)(Data->max_x + 2) / (DBL)nx);
-    wz = (int)ceil((DBL)(Data->max_z + 2) / (DBL)nz);
+    nx = (Data->max_x + HFIELD_BLOCK_SIZE) / HFIELD_BLOCK_SIZE;
+    nz = (Data->max_z + HFIELD_BLOCK_SIZE) / HFIELD_BLOCK_SIZE;
 
-    /* Increase number of sub-blocks if necessary. */
-
-    if (nx * wx < Data->max_x + 2)
+    if (!Test_Flag(this, HIERARCHY_FLAG) || ((nx == 1) && (nz == 1)))
     {
-        nx++;
-    }
+        /* We don't want a bounding hierarchy. Just step through the grid. */
 
-    if (nz * wz < Data->max_z + 2)
-    {
-        nz++;
+        return;
     }
 
-    if (!Test_Flag(this, HIERARCHY_FLAG) || ((nx == 1) && (nz == 1)))
-    {
-        /* We don't want a bounding hierarchy. Just use one block. */
+    /* Find min. and max. height in each block. */
 
-        Data->Block = new HFBlock*[1];
+    Data->Pyramid.emplace_back();
 
-        Data->Block[0] = new HFBlock[1];
+    Data->Pyramid[0].size_x = nx;
+    Data->Pyramid[0].size_z = nz;
+    Data->Pyramid[0].Bounds.reserve(nx * nz);
 
-        Data->Block[0][0].xmin = 0;
-        Data->Block[0][0].xmax = Data->max_x;
-        Data->Block[0][0].zmin = 0;
-        Data->Block[0][0].zmax = Data->max_z;
+    for (z = 0; z < nz; z++)
+    {
+        zmin = z * HFIELD_BLOCK_SIZE;
+        zmax = min(zmin + HFIELD_BLOCK_SIZE, Data->max_z + 1);
 
-        Data->Block[0][0].ymin = bounding_corner1[Y];
-        Data->Block[0][0].ymax = bounding_corner2[Y];
+        for (x = 0; x < nx; x++)
+        {
+            xmin = x * HFIELD_BLOCK_SIZE;
+            xmax = min(xmin + HFIELD_BLOCK_SIZE, Data->max_x + 1);
 
-        Data->block_max_x = 1;
-        Data->block_max_z = 1;
+            bounds.min_y = 65535;
+            bounds.max_y = 0;
 
-        Data->block_width_x = Data->max_x + 2;
-        Data->block_width_z = Data->max_y + 2;
+            for (j = zmin; j <= zmax; j++)
+            {
+                for (i = xmin; i <= xmax; i++)
+                {
+                    y = Data->Map[j][i];
 
-//      Debug_Info("Height field: %d x %d (1 x 1 blocks)\n", Data->max_x+2, Data->max_z+2);
+                    bounds.min_y = min(bounds.min_y, y);
+                    bounds.max_y = max(bounds.max_y, y);
+                }
+            }
 
-        return;
+            Data->Pyramid[0].Bounds.push_back(bounds);
+        }
     }
 
-//  Debug_Info("Height field: %d x %d (%d x %d blocks)\n", Data->max_x+2, Data->max_z+2, nx, nz);
-
-    /* Allocate memory for blocks. */
-
-    Data->Block = new HFBlock*[nz];
+    /* Merge 2 x 2 nodes at a time until only one node is left. */
 
-    /* Store block information. */
-
-    Data->block_max_x = nx;
-    Data->block_max_z = nz;
-
-    Data->block_width_x = wx;
-    Data->block_width_z = wz;
-
-    water = bounding_corner1[Y];
-
-    for (z = 0; z < nz; z++)
+    for (level = 1; (nx > 1) || (nz > 1); level++)
     {
-        Data->Block[z] = new HFBlock[nx];
+        const int below_x = nx;
+        const int below_z = nz;
 
-        for (x = 0; x < nx; x++)
-        {
-            /* Get block's borders. */
+        nx = (nx + 1) / 2;
+        nz = (nz + 1) / 2;
 
-            xmin = x * wx;
-            zmin = z * wz;
+        Data->Pyramid.emplace_back();
 
-            xmax = min((x + 1) * wx - 1, Data->max_x);
-            zmax = min((z + 1) * wz - 1, Data->max_z);
+        const HFLevel& Below = Data->Pyramid[level-1];
+        HFLevel& Level = Data->Pyramid[level];
 
-            /* Find min. and max. height in current block. */
+        Level.size_x = nx;
+        Level.size_z = nz;
+        Level.Bounds.reserve(nx * nz);
 
-            ymin = BOUND_HUGE;
-            ymax = -BOUND_HUGE;
-
-            for (i = xmin; i <= xmax+1; i++)
+        for (z = 0; z < nz; z++)
+        {
+            for (x = 0; x < nx; x++)
             {
-                for (j = zmin; j <= zmax+1; j++)
-                {
-                    y = Get_Height(i, j);
+                bounds.min_y = 65535;
+                bounds.max_y = 0;
 
-                    ymin = min(ymin, y);
-                    ymax = max(ymax, y);
+                for (j = 2 * z; j < min(2 * z + 2, below_z); j++)
+                {
+                    for (i = 2 * x; i < min(2 * x + 2, below_x); i++)
+                    {
+                        bounds.min_y = min(bounds.min_y, Below.Bounds[j * below_x + i].min_y);
+                        bounds.max_y = max(bounds.max_y, Below.Bounds[j * below_x + i].max_y);
+                    }
                 }
-            }
-
-            /* Store block's borders. */
 
-            Data->Block[z][x].xmin = xmin;
-            Data->Block[z][x].xmax = xmax;
-            Data->Block[z][x].zmin = zmin;
-            Data->Block[z][x].zmax = zmax;
-
-            Data->Block[z][x].ymin = max(ymin, water) - HFIELD_OFFSET;
-            Data->Block[z][x].ymax = ymax + HFIELD_OFFSET;
+                Level.Bounds.push_back(bounds);
+            }
         }
     }
 }
@@ -1242,12 +1256,6 @@ HField::HField() : ObjectBase(HFIELD_OBJECT)
     Data->max_x = 0;
     Data->max_z = 0;
 
-    Data->block_max_x = 0;
-    Data->block_max_z = 0;
-
-    Data->block_width_x = 0;
-    Data->block_width_z = 0;
-
     Set_Flag(this, HIERARCHY_FLAG);
 }
 
@@ -1359,16 +1367,6 @@ HField::~HField()
             delete[] Data->Normals;
         }
 
-        if (Data->Block != nullptr)
-        {
-            for (i = 0; i < Data->block_max_z; i++)
-            {
-                delete[] Data->Block[i];
-            }
-
-            delete[] Data->Block;
-        }
-
         delete Data;
     }
 }
@@ -1873,42 +1871,26 @@ bool HField::dda_traversal(const BasicRay &ray, const Vector3d& Start, const HFB
 *              which some boundary tests in two different places were
 *              made. It was easy to fix.
 *
+*   Oct 2026 : Moved the block walk to pyramid_traversal.
+*
 ******************************************************************************/
 
 bool HField::block_traversal(const BasicRay &ray, const Vector3d& Start, IStack &HField_Stack, const BasicRay &RRay, DBL mindist, DBL maxdist, TraceThreadData *Thread)
 {
-    int xmax, zmax;
-    int x, z, nx, nz, signx, signz;
-    int found = false;
-    int dx_zero, dz_zero;
-    DBL px, pz, dx, dy, dz;
-    DBL maxdv;
-    DBL ymin, ymax, y1, y2;
+    int x, z;
     DBL neary, fary;
-    DBL k1, k2, dist;
-    Vector3d nearP;
-    Vector3d farP;
-    HFBlock *Block;
-
-    px = Start[X];
-    pz = Start[Z];
-
-    dx = ray.Direction[X];
-    dy = ray.Direction[Y];
-    dz = ray.Direction[Z];
-
-    maxdv = (dx > dz) ? dx : dz;
+    HFBlock Block;
 
     /* First test for 'perpendicular' rays. */
 
-    if ((fabs(dx) < EPSILON) && (fabs(dz) < EPSILON))
+    if ((fabs(ray.Direction[X]) < EPSILON) && (fabs(ray.Direction[Z]) < EPSILON))
     {
-        x = (int)px;
-        z = (int)pz;
+        x = (int)Start[X];
+        z = (int)Start[Z];
 
         neary = Start[Y];
 
-        if (dy >= 0.0)
+        if (ray.Direction[Y] >= 0.0)
         {
             fary = 65536.0;
         }
@@ -1922,170 +1904,228 @@ bool HField::block_traversal(const BasicRay &ray, const Vector3d& Start, IStack
 
     /* If we don't have blocks we just step through the grid. */
 
-    if ((Data->block_max_x <= 1) && (Data->block_max_z <= 1))
+    if (Data->Pyramid.empty())
     {
-        return dda_traversal(ray, Start, &Data->Block[0][0], HField_Stack, RRay, mindist, maxdist, Thread);
+        Block.xmin = 0;
+        Block.xmax = Data->max_x;
+        Block.zmin = 0;
+        Block.zmax = Data->max_z;
+
+        Block.ymin = bounding_corner1[Y];
+        Block.ymax = bounding_corner2[Y];
+
+        return dda_traversal(ray, Start, &Block, HField_Stack, RRay, mindist, maxdist, Thread);
     }
 
-    /* Get dimensions of grid. */
+    /* Walk down the pyramid, starting with the single topmost node. */
 
-    xmax = Data->block_max_x;
-    zmax = Data->block_max_z;
+    return pyramid_traversal(ray, (int)Data->Pyramid.size() - 1, 0, 0, mindist, maxdist, HField_Stack, RRay, mindist, maxdist, Thread);
+}
 
-    ymin = (DBL)Data->min_y - EPSILON;
-    ymax = (DBL)Data->max_y + EPSILON;
 
-    dx_zero = (fabs(dx) < EPSILON);
-    dz_zero = (fabs(dz) < EPSILON);
 
-    signx = sign(dx);
-    signz = sign(dz);
+/*****************************************************************************
+*
+* FUNCTION
+*
+*   pyramid_traversal
+*
+* INPUT
+*
+*   Ray    - Current ray
+*   Level  - Level of the pyramid node to traverse
+*   X, Z   - Indices of the pyramid node to traverse
+*   T1, T2 - Section of the ray within the pyramid node
+*
+* OUTPUT
+*
+* RETURNS
+*
+*   int - true if intersection was found
+*
+* AUTHOR
+*
+* DESCRIPTION
+*
+*   Traverse a node of the height field pyramid: Skip it entirely if the
+*   ray passes above or below all of its heights; otherwise visit the
+*   nodes it covers in the order the ray passes them, or, at the bottom
+*   level, traverse the block's grid cells.
+*
+*   As the nodes of each level are split along the same planes as those
+*   of the levels above, the ray is only ever intersected with the two
+*   planes splitting the current node.
+*
+* CHANGES
+*
+*   Oct 2026 : Creation, based on the previous block walk.
+*
+******************************************************************************/
 
-    /* Walk on the block grid. */
+bool HField::pyramid_traversal(const BasicRay &ray, int level, int x, int z, DBL t1, DBL t2, IStack &HField_Stack, const BasicRay &RRay, DBL mindist, DBL maxdist, TraceThreadData *Thread)
+{
+    int cx, cz;
+    int found = false;
+    DBL y1, y2, ymin, ymax, water;
+    DBL neary, fary;
+    DBL tx, tz, split, dist;
+    HFBlock Block;
 
-    px /= Data->block_width_x;
-    pz /= Data->block_width_z;
+    const HFLevel& Level = Data->Pyramid[level];
+    const HFBounds& Bounds = Level.Bounds[z * Level.size_x + x];
 
-    x = (int)px;
-    z = (int)pz;
+#ifdef HFIELD_EXTRA_STATS
+    Thread->Stats()[Ray_HField_Block_Tests]++;
+#endif
 
-    nearP = Start;
+    /* Can we hit current node at all? */
 
-    neary = Start[Y];
+    water = bounding_corner1[Y];
 
-    /*
-     * Here comes the block walk algorithm.
-     */
+    ymin = max((DBL)Bounds.min_y, water) - HFIELD_OFFSET;
+    ymax = (DBL)Bounds.max_y + HFIELD_OFFSET;
+
+    neary = ray.Origin[Y] + t1 * ray.Direction[Y];
+    fary  = ray.Origin[Y] + t2 * ray.Direction[Y];
 
-    do
+    if (neary < fary)
+    {
+        y1 = neary;
+        y2 = fary;
+    }
+    else
     {
+        y1 = fary;
+        y2 = neary;
+    }
+
+    if ((y1 > ymax + EPSILON) || (y2 < ymin - EPSILON))
+    {
+        return(false);
+    }
+
 #ifdef HFIELD_EXTRA_STATS
-        Thread->Stats()[Ray_HField_Block_Tests]++;
+    Thread->Stats()[Ray_HField_Block_Tests_Succeeded]++;
 #endif
 
-        /* Get current block. */
+    if (level == 0)
+    {
+        /* Test current block. */
+
+        Block.xmin = x * HFIELD_BLOCK_SIZE;
+        Block.xmax = min(Block.xmin + HFIELD_BLOCK_SIZE - 1, Data->max_x);
+        Block.zmin = z * HFIELD_BLOCK_SIZE;
+        Block.zmax = min(Block.zmin + HFIELD_BLOCK_SIZE - 1, Data->max_z);
+
+        Block.ymin = ymin;
+        Block.ymax = ymax;
+
+        return dda_traversal(ray, ray.Evaluate(t1), &Block, HField_Stack, RRay, mindist, maxdist, Thread);
+    }
 
-        Block = &Data->Block[z][x];
+    const HFLevel& Below = Data->Pyramid[level-1];
 
-        /* Intersect ray with bounding planes. */
+    /*
+     * Find the half of the node along each axis the ray starts in, and
+     * where the ray crosses into the other half, if it does at all.
+     */
+
+    cx = 0;
+    cz = 0;
 
-        if (dx_zero)
+    tx = BOUND_HUGE;
+    tz = BOUND_HUGE;
+
+    if (2 * x + 1 < Below.size_x)
+    {
+        split = (DBL)(((2 * x + 1) << (level - 1)) * HFIELD_BLOCK_SIZE);
+
+        if (fabs(ray.Direction[X]) < EPSILON)
         {
-            k1 = BOUND_HUGE;
+            cx = (ray.Origin[X] >= split);
         }
         else
         {
-            if (signx >= 0)
+            tx = (split - ray.Origin[X]) / ray.Direction[X];
+
+            if (tx <= t1)
             {
-                k1 = ((DBL)Block->xmax + 1.0 - ray.Origin[X]) / dx;
+                cx = (ray.Direction[X] > 0.0);
+
+                tx = BOUND_HUGE;
             }
             else
             {
-                k1 = ((DBL)Block->xmin - ray.Origin[X]) / dx;
+                cx = (ray.Direction[X] < 0.0);
             }
         }
+    }
+
+    if (2 * z + 1 < Below.size_z)
+    {
+        split = (DBL)(((2 * z + 1) << (level - 1)) * HFIELD_BLOCK_SIZE);
 
-        if (dz_zero)
+        if (fabs(ray.Direction[Z]) < EPSILON)
         {
-            k2 = BOUND_HUGE;
+            cz = (ray.Origin[Z] >= split);
         }
         else
         {
-            if (signz >= 0)
+            tz = (split - ray.Origin[Z]) / ray.Direction[Z];
+
+            if (tz <= t1)
             {
-                k2 = ((DBL)Block->zmax + 1.0 - ray.Origin[Z]) / dz;
+                cz = (ray.Direction[Z] > 0.0);
+
+                tz = BOUND_HUGE;
             }
             else
             {
-                k2 = ((DBL)Block->zmin - ray.Origin[Z]) / dz;
+                cz = (ray.Direction[Z] < 0.0);
             }
         }
+    }
 
-        /* Figure out the indices of the next block. */
-
-        if (dz_zero || ((!dx_zero) && (k1<k2 - EPSILON / maxdv) && (k1>0.0)))
-/*      if ((k1 < k2 - EPSILON / maxdv) && (k1 > 0.0)) */
-        {
-            /* Step along the x-axis. */
+    /* Visit the nodes below in the order the ray passes them. */
 
-            dist = k1;
+    while (true)
+    {
+        dist = min(min(tx, tz), t2);
 
-            nx = x + signx;
-            nz = z;
-        }
-        else
+        if (pyramid_traversal(ray, level - 1, 2 * x + cx, 2 * z + cz, t1, dist, HField_Stack, RRay, mindist, maxdist, Thread))
         {
-            if (dz_zero || ((!dx_zero) && (k1<k2 + EPSILON / maxdv) && (k1>0.0)))
-/*          if ((k1 < k2 + EPSILON / maxdv) && (k1 > 0.0))  */
+            if (Type & IS_CHILD_OBJECT)
             {
-                /* Step along both axis (very rare case). */
-
-                dist = k1;
-
-                nx = x + signx;
-                nz = z + signz;
+                found = true;
             }
             else
             {
-                /* Step along the z-axis. */
-
-                dist = k2;
-
-                nx = x;
-                nz = z + signz;
+                return(true);
             }
         }
 
-        /* Get point where ray leaves current block. */
-
-        farP = ray.Evaluate(dist);
-
-        fary = farP[Y];
-
-        if (neary < fary)
+        if (dist >= t2)
         {
-            y1 = neary;
-            y2 = fary;
-        }
-        else
-        {
-            y1 = fary;
-            y2 = neary;
+            break;
         }
 
-        /* Can we hit current block at all? */
+        /* Step to next node. */
 
-        if ((y1 <= (DBL)Block->ymax + EPSILON) && (y2 >= (DBL)Block->ymin - EPSILON))
+        if (tx <= tz)
         {
-            /* Test current block. */
-
-#ifdef HFIELD_EXTRA_STATS
-            Thread->Stats()[Ray_HField_Block_Tests_Succeeded]++;
-#endif
+            cx = 1 - cx;
 
-            if (dda_traversal(ray, nearP, &Data->Block[z][x], HField_Stack, RRay, mindist, maxdist, Thread))
-            {
-                if (Type & IS_CHILD_OBJECT)
-                {
-                    found = true;
-                }
-                else
-                {
-                    return(true);
-                }
-            }
+            tx = BOUND_HUGE;
         }
+        else
+        {
+            cz = 1 - cz;
 
-        /* Step to next block. */
-
-        x = nx;
-        z = nz;
-
-        nearP = farP;
+            tz = BOUND_HUGE;
+        }
 
-        neary = fary;
+        t1 = dist;
     }
-    while ((x >= 0) && (x < xmax) && (z >= 0) && (z < zmax) && (neary >= ymin) && (neary <= ymax));
 
     return(found);
 }
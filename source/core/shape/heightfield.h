@@ -88,7 +88,8 @@ class ImageData;
 ///
 /// The basic intersection routine first computes the ray's intersection with the box marking the limits of the shape,
 /// then follows the line from one intersection point to the other, testing the two triangles which form the pixel for
-/// an intersection with the ray at each step.
+/// an intersection with the ray at each step. Sections of the grid that lie entirely above or below the ray are skipped
+/// with the help of a pyramid of minimum and maximum heights.
 ///
 class HField final : public ObjectBase
 {
@@ -119,7 +120,8 @@ class HField final : public ObjectBase
         static int add_single_normal(HF_VAL **data, int xsize, int zsize, int x0, int z0,int x1, int z1,int x2, int z2, Vector3d& N);
         bool dda_traversal(const BasicRay &ray, const Vector3d& Start, const HFBlock *Block, IStack &HField_Stack, const BasicRay &RRay, DBL mindist, DBL maxdist, TraceThreadData *Thread);
         bool block_traversal(const BasicRay &ray, const Vector3d& Start, IStack &HField_Stack, const BasicRay &RRay, DBL mindist, DBL maxdist, TraceThreadData *Thread);
-        void build_hfield_blocks();
+        bool pyramid_traversal(const BasicRay &ray, int level, int x, int z, DBL t1, DBL t2, IStack &HField_Stack, const BasicRay &RRay, DBL mindist, DBL maxdist, TraceThreadData *Thread);
+        void build_hfield_pyramid();
 };
 
 /// @}
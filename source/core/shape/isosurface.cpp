@@ -403,20 +403,21 @@ void IsoSurface::Normal(Vector3d& Result, Intersection *Inter, TraceThreadData *
         else
             New_Point = Inter->IPoint;
 
-        TPoint = New_Point;
-        funct = fn.Evaluate(TPoint);
+        // Evaluate the function at the point and at the three offset points in one go
+        DBL px[4], py[4], pz[4], funct[4];
 
-        TPoint = New_Point;
-        TPoint[X] += accuracy;
-        Result[X] = fn.Evaluate(TPoint) - funct;
-            TPoint = New_Point;
+        px[0] = px[1] = px[2] = px[3] = New_Point[X];
+        py[0] = py[1] = py[2] = py[3] = New_Point[Y];
+        pz[0] = pz[1] = pz[2] = pz[3] = New_Point[Z];
+        px[1] += accuracy;
+        py[2] += accuracy;
+        pz[3] += accuracy;
 
-        TPoint[Y] += accuracy;
-        Result[Y] = fn.Evaluate(TPoint) - funct;
-            TPoint = New_Point;
+        fn.EvaluateBatch(px, py, pz, funct, 4);
 
-        TPoint[Z] += accuracy;
-        Result[Z] = fn.Evaluate(TPoint) - funct;
+        Result[X] = funct[1] - funct[0];
+        Result[Y] = funct[2] - funct[0];
+        Result[Z] = funct[3] - funct[0];
 
         if((Result[X] == 0) && (Result[Y] == 0) && (Result[Z] == 0))
             Result[X] = 1.0;
@@ -865,6 +866,7 @@ void IsoSurface::Compute_BBox()
 bool IsoSurface::Function_Find_Root(ISO_ThreadData& itd, const Vector3d& PP, const Vector3d& DD, DBL* Depth1, DBL* Depth2, DBL& maxg, bool in_shadow_test, TraceThreadData* pThreadData)
 {
     DBL dt, t21, l_b, l_e, oldmg;
+    DBL fpair[2];
     ISO_Pair EP1, EP2;
     Vector3d VTmp;
 
@@ -893,7 +895,10 @@ bool IsoSurface::Function_Find_Root(ISO_ThreadData& itd, const Vector3d& PP, con
 
     itd.cache.current = nullptr;
     EP1.t = *Depth1;
-    EP1.f = Float_Function(itd, *Depth1);
+    EP2.t = *Depth2;
+    Float_Function_Pair(itd, EP1.t, EP2.t, fpair);
+
+    EP1.f = (DBL)itd.Inv3 * fpair[0];
     itd.cache.fmax = EP1.f;
     if((closed == false) && (EP1.f < 0.0))
     {
@@ -901,8 +906,7 @@ bool IsoSurface::Function_Find_Root(ISO_ThreadData& itd, const Vector3d& PP, con
         EP1.f *= -1;
     }
 
-    EP2.t = *Depth2;
-    EP2.f = Float_Function(itd, *Depth2);
+    EP2.f = (DBL)itd.Inv3 * fpair[1];
     itd.cache.fmax = min(EP2.f, itd.cache.fmax);
 
     oldmg = maxg;
@@ -1047,6 +1051,31 @@ DBL IsoSurface::Float_Function(ISO_ThreadData& itd, DBL t) const
     return ((DBL)itd.Inv3 * EvaluatePolarized (*itd.pFn, VTmp));
 }
 
+/*****************************************************************************/
+
+// Evaluates the polarized function at two points along the ray in a single batch, leaving the
+// sign adjustment by `itd.Inv3` to the caller.
+void IsoSurface::Float_Function_Pair(ISO_ThreadData& itd, DBL t1, DBL t2, DBL* f) const
+{
+    Vector3d VTmp;
+    DBL px[2], py[2], pz[2];
+
+    VTmp = itd.cache.Pglobal + t1 * itd.cache.Dglobal;
+    px[0] = VTmp[X]; py[0] = VTmp[Y]; pz[0] = VTmp[Z];
+    VTmp = itd.cache.Pglobal + t2 * itd.cache.Dglobal;
+    px[1] = VTmp[X]; py[1] = VTmp[Y]; pz[1] = VTmp[Z];
+
+    itd.pFn->EvaluateBatch(px, py, pz, f, 2);
+
+    for (int i = 0; i < 2; i++)
+    {
+        if (positivePolarity)
+            f[i] = threshold - f[i];
+        else
+            f[i] = f[i] - threshold;
+    }
+}
+
 
 /*****************************************************************************/
 
@@ -65,13 +65,18 @@
 
 // C++ standard header files
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <limits>
 
 // POV-Ray header files (base module)
+#include "base/fileinputoutput.h"
+#include "base/filesystem.h"
 #include "base/pov_err.h"
 
 // POV-Ray header files (core module)
 #include "core/bounding/boundingbox.h"
+#include "core/bounding/bvhtree.h"
 #include "core/material/texture.h"
 #include "core/math/matrix.h"
 #include "core/render/ray.h"
@@ -97,6 +102,15 @@ const int HASH_SIZE = 1000;
 
 const int INITIAL_NUMBER_OF_ENTRIES = 256;
 
+/// Relative tolerance of the block-wise triangle test, in barycentric coordinates.
+const DBL BLOCK_BARYCENTRIC_TOLERANCE = 1e-5;
+
+/// Tolerance of the block-wise triangle test for the determinant, relative to the edge lengths.
+const DBL BLOCK_DETERMINANT_TOLERANCE = 1e-6;
+
+/// Tolerance to pad triangle bounding boxes by, relative to the mesh size.
+const DBL BOUNDS_TOLERANCE = 1e-6;
+
 
 
 /*****************************************************************************
@@ -107,7 +121,136 @@ HASH_TABLE **Mesh::Vertex_Hash_Table;
 HASH_TABLE **Mesh::Normal_Hash_Table;
 UV_HASH_TABLE **Mesh::UV_Hash_Table;
 
-thread_local std::unique_ptr<BBoxPriorityQueue> Mesh::mtpQueue(new BBoxPriorityQueue());
+
+
+/*****************************************************************************
+* Local types
+******************************************************************************/
+
+/// Bounding volume hierarchy of a mesh's triangles.
+///
+/// In addition to the tree itself, the triangles' geometry is kept in structure-of-arrays
+/// layout, ordered the same way as the leaves of the tree reference them, so that the
+/// triangles of each leaf are stored contiguously and can be tested against a ray in blocks
+/// of @ref POV_MESH_TRIANGLE_BLOCK_SIZE, using SIMD instructions where the compiler supports
+/// them.
+///
+/// The block-wise test is a Möller-Trumbore test with some tolerance, serving only to weed
+/// out triangles that are definitely missed; any candidates are then subjected to the regular
+/// triangle test, so that results do not differ from the unaccelerated case.
+///
+class MeshTriangleTree final
+{
+    public:
+
+        static const unsigned int kBlockSize = POV_MESH_TRIANGLE_BLOCK_SIZE;
+
+        /// Number of per-triangle arrays making up the block data.
+        static const unsigned int kBlockArrays = 10;
+
+        BVHTree tree;
+        /// First vertex of each triangle, in leaf order.
+        const float *v0[3];
+        /// Second vertex of each triangle, in leaf order.
+        const float *v1[3];
+        /// Third vertex of each triangle, in leaf order.
+        const float *v2[3];
+        /// Determinant below which the block-wise test is unreliable, in leaf order.
+        const float *detTolerance;
+        /// Storage for the per-triangle arrays, unless they reside in a mesh file.
+        std::vector<float> blockData;
+
+        MeshTriangleTree();
+
+        /// Get the number of elements in each of the per-triangle arrays, including padding.
+        size_t GetPaddedSize() const { return tree.GetObjectCount() + kBlockSize; }
+
+        /// Set up the per-triangle arrays to reside in the specified block data.
+        void SetBlockData(const float *data);
+
+        /// Find candidate triangles for intersection.
+        ///
+        /// @param[in]  ray     Ray in mesh coordinate space.
+        /// @param[in]  first   Position of the first triangle to test.
+        /// @param[in]  count   Number of triangles to test (at most @ref kBlockSize).
+        /// @return             Bit mask of the triangles that may be hit.
+        ///
+        unsigned int FindCandidates(const BasicRay& ray, unsigned int first, unsigned int count) const;
+};
+
+MeshTriangleTree::MeshTriangleTree() :
+    detTolerance(nullptr)
+{
+    for (int axis = X; axis <= Z; axis++)
+        v0[axis] = v1[axis] = v2[axis] = nullptr;
+}
+
+void MeshTriangleTree::SetBlockData(const float *data)
+{
+    size_t padded = GetPaddedSize();
+    for (int axis = X; axis <= Z; axis++)
+    {
+        v0[axis] = data + (0 + axis) * padded;
+        v1[axis] = data + (3 + axis) * padded;
+        v2[axis] = data + (6 + axis) * padded;
+    }
+    detTolerance = data + 9 * padded;
+}
+
+unsigned int MeshTriangleTree::FindCandidates(const BasicRay& ray, unsigned int first, unsigned int count) const
+{
+    bool candidate[kBlockSize];
+    unsigned int mask = 0;
+
+    // Test all triangles of the block at once; the loop is free of data-dependent branches,
+    // so that the compiler can vectorize it. The arrays are padded at the end, so this is safe
+    // even if the block is not full.
+
+    for (unsigned int i = 0; i < kBlockSize; i++)
+    {
+        // The vertices are single precision, so their differences are exact.
+        DBL e1x = DBL(v1[X][first + i]) - v0[X][first + i];
+        DBL e1y = DBL(v1[Y][first + i]) - v0[Y][first + i];
+        DBL e1z = DBL(v1[Z][first + i]) - v0[Z][first + i];
+        DBL e2x = DBL(v2[X][first + i]) - v0[X][first + i];
+        DBL e2y = DBL(v2[Y][first + i]) - v0[Y][first + i];
+        DBL e2z = DBL(v2[Z][first + i]) - v0[Z][first + i];
+
+        // pvec = Direction x e2
+        DBL px = ray.Direction[Y] * e2z - ray.Direction[Z] * e2y;
+        DBL py = ray.Direction[Z] * e2x - ray.Direction[X] * e2z;
+        DBL pz = ray.Direction[X] * e2y - ray.Direction[Y] * e2x;
+
+        DBL det = e1x * px + e1y * py + e1z * pz;
+
+        // tvec = Origin - v0
+        DBL tx = ray.Origin[X] - v0[X][first + i];
+        DBL ty = ray.Origin[Y] - v0[Y][first + i];
+        DBL tz = ray.Origin[Z] - v0[Z][first + i];
+
+        // qvec = tvec x e1
+        DBL qx = ty * e1z - tz * e1y;
+        DBL qy = tz * e1x - tx * e1z;
+        DBL qz = tx * e1y - ty * e1x;
+
+        // barycentric coordinates, scaled by the determinant; we avoid the division
+        // to keep nearly parallel triangles from producing garbage
+        DBL sign = (det < 0.0 ? -1.0 : 1.0);
+        DBL absdet = det * sign;
+        DBL u = (tx * px + ty * py + tz * pz) * sign;
+        DBL v = (ray.Direction[X] * qx + ray.Direction[Y] * qy + ray.Direction[Z] * qz) * sign;
+        DBL tolerance = absdet * BLOCK_BARYCENTRIC_TOLERANCE;
+
+        candidate[i] = (absdet <= detTolerance[first + i]) ||
+                       ((u >= -tolerance) && (v >= -tolerance) && (u + v <= absdet + tolerance));
+    }
+
+    for (unsigned int i = 0; i < count; i++)
+        if (candidate[i])
+            mask |= (1u << i);
+
+    return mask;
+}
 
 /*****************************************************************************
 *
@@ -727,31 +870,35 @@ Mesh::~Mesh()
 
     if (--(Data->References) == 0)
     {
-        Destroy_BBox_Tree(Data->Tree);
+        delete Data->Tree;
 
-        if (Data->Normals != nullptr)
+        // Arrays residing in a mesh file go away with the file itself.
+        if (Data->File == nullptr)
         {
-            POV_FREE(Data->Normals);
-        }
+            if (Data->Normals != nullptr)
+            {
+                POV_FREE(Data->Normals);
+            }
 
-        /* NK 1998 */
-        if (Data->UVCoords != nullptr)
-        {
-            POV_FREE(Data->UVCoords);
-        }
-        /* NK ---- */
+            /* NK 1998 */
+            if (Data->UVCoords != nullptr)
+            {
+                POV_FREE(Data->UVCoords);
+            }
+            /* NK ---- */
 
-        if (Data->Vertices != nullptr)
-        {
-            POV_FREE(Data->Vertices);
-        }
+            if (Data->Vertices != nullptr)
+            {
+                POV_FREE(Data->Vertices);
+            }
 
-        if (Data->Triangles != nullptr)
-        {
-            POV_FREE(Data->Triangles);
+            if (Data->Triangles != nullptr)
+            {
+                POV_FREE(Data->Triangles);
+            }
         }
 
-        POV_FREE(Data);
+        delete Data;
     }
 }
 
@@ -1375,41 +1522,101 @@ void Mesh::get_triangle_bbox(const MESH_TRIANGLE *Triangle, BoundingBox *BBox) c
 
 void Mesh::Build_Mesh_BBox_Tree()
 {
-    MeshIndex i, nElem, maxelements;
-    BBOX_TREE **Triangles;
+    /// Triangle bounds, as needed to build the tree.
+    class TriangleBounds final : public BVHTree::Objects
+    {
+        public:
+            std::vector<MinMaxBoundingBox> bounds;
+
+            virtual unsigned int size() const override { return (unsigned int)bounds.size(); }
+            virtual float GetMin(unsigned int axis, unsigned int i) const override { return bounds[i].pmin[axis]; }
+            virtual float GetMax(unsigned int axis, unsigned int i) const override { return bounds[i].pmax[axis]; }
+    };
+
+    /// Dummy progress reporting, as building a mesh is part of parsing.
+    class NoProgress final : public BVHTree::Progress
+    {
+        public:
+            virtual void operator()(unsigned int) const override { }
+    };
+
+    MeshIndex i, nElem;
+    TriangleBounds objects;
+    NoProgress progress;
+    Vector3d P1, P2, P3;
+    Vector3d mins, maxs;
+    unsigned int nodes, leafNodes, maxObjects, maxDepth;
+    float averageObjects, averageDepth;
 
     if (!Test_Flag(this, HIERARCHY_FLAG))
+    {
+        /* A tree loaded from a mesh file is not wanted either. */
+        delete Data->Tree;
+        Data->Tree = nullptr;
+        return;
+    }
+
+    /* A tree loaded from a mesh file is ready to use. */
+
+    if (Data->Tree != nullptr)
     {
         return;
     }
 
     nElem = Data->Number_Of_Triangles;
 
-    maxelements = 2 * nElem;
+    /* Get the triangles' bounding boxes, slightly enlarged so that the tree
+       also catches rays grazing axis-aligned triangles. */
 
-    /* Now allocate an array to hold references to these elements. */
+    mins = Vector3d(BOUND_HUGE);
+    maxs = Vector3d(-BOUND_HUGE);
 
-    Triangles = reinterpret_cast<BBOX_TREE **>(POV_MALLOC(maxelements*sizeof(BBOX_TREE *), "mesh bbox tree"));
+    for (i = 0; i < Data->Number_Of_Vertices; i++)
+    {
+        mins = min(mins, Vector3d(Data->Vertices[i]));
+        maxs = max(maxs, Vector3d(Data->Vertices[i]));
+    }
 
-    /* Init list with mesh elements. */
+    DBL tolerance = BOUNDS_TOLERANCE * std::max(std::max(maxs[X] - mins[X], maxs[Y] - mins[Y]), maxs[Z] - mins[Z]);
+
+    objects.bounds.resize(nElem);
 
     for (i = 0; i < nElem; i++)
     {
-        Triangles[i] = reinterpret_cast<BBOX_TREE *>(POV_MALLOC(sizeof(BBOX_TREE), "mesh bbox tree"));
-
-        Triangles[i]->Infinite = false;
-        Triangles[i]->Entries  = 0;
-        Triangles[i]->Node     = reinterpret_cast<BBOX_TREE **>(&Data->Triangles[i]);
+        get_triangle_vertices(&Data->Triangles[i], P1, P2, P3);
 
-        get_triangle_bbox(&Data->Triangles[i], &Triangles[i]->BBox);
+        objects.bounds[i].pmin = BBoxVector3d(min(P1, P2, P3) - tolerance);
+        objects.bounds[i].pmax = BBoxVector3d(max(P1, P2, P3) + tolerance);
     }
 
-    size_t maxfinitecount = 0;
-    Build_BBox_Tree(&Data->Tree, nElem, Triangles, 0, nullptr, maxfinitecount);
+    Data->Tree = new MeshTriangleTree();
+    Data->Tree->tree.build(progress, objects, nodes, leafNodes, maxObjects, averageObjects, maxDepth, averageDepth);
+
+    /* Store the triangles' geometry in the order they are referenced by the tree,
+       padding the arrays so that any block can be read in full. */
+
+    const unsigned int *order = Data->Tree->tree.GetObjectList();
+    size_t count = Data->Tree->tree.GetObjectCount();
+    size_t padded = Data->Tree->GetPaddedSize();
+    std::vector<float>& block = Data->Tree->blockData;
 
-    /* Get rid of the Triangles array. */
+    block.assign(MeshTriangleTree::kBlockArrays * padded, 0.0f);
+    std::fill(block.begin() + 9 * padded, block.end(), -1.0f);
 
-    POV_FREE(Triangles);
+    for (size_t n = 0; n < count; n++)
+    {
+        get_triangle_vertices(&Data->Triangles[order[n]], P1, P2, P3);
+
+        for (int axis = X; axis <= Z; axis++)
+        {
+            block[(0 + axis) * padded + n] = float(P1[axis]);
+            block[(3 + axis) * padded + n] = float(P2[axis]);
+            block[(6 + axis) * padded + n] = float(P3[axis]);
+        }
+        block[9 * padded + n] = float(BLOCK_DETERMINANT_TOLERANCE * (P2 - P1).length() * (P3 - P1).length());
+    }
+
+    Data->Tree->SetBlockData(block.data());
 }
 
 
@@ -1451,80 +1658,63 @@ void Mesh::Build_Mesh_BBox_Tree()
 
 bool Mesh::intersect_bbox_tree(const BasicRay &ray, const BasicRay &Orig_Ray, DBL len, IStack& Depth_Stack, TraceThreadData *Thread)
 {
-    bool found;
-    MeshIndex i;
-    DBL Best, Depth;
-    const BBOX_TREE *Node, *Root;
-    bool OldStyle = has_inside_vector;
-
-    /* Create the direction vectors for this ray. */
-    Rayinfo rayinfo(ray);
-
-    /* Start with an empty priority queue. */
-    mtpQueue->Clear();
-    found = false;
-
-    Best = BOUND_HUGE;
-
-#ifdef BBOX_EXTRA_STATS
-    Thread->Stats()[totalQueueResets]++;
-#endif
-
-    /* Check top node. */
+    /// Intersection test for the triangles in a leaf of the mesh's tree.
+    class IntersectTriangles final : public BVHTree::IntersectLeaf
+    {
+        public:
+            IntersectTriangles(Mesh& m, const BasicRay& r, const BasicRay& o, DBL l, IStack& ds, TraceThreadData *t) :
+                mesh(m), ray(r), origRay(o), len(l), depthStack(ds), thread(t), found(false)
+            {}
 
-    Root = Data->Tree;
+            virtual bool operator()(unsigned int first, unsigned int count, double& maxdist) override
+            {
+                const MeshTriangleTree& tree = *mesh.Data->Tree;
+                const unsigned int *order = tree.tree.GetObjectList();
+                DBL Depth;
 
-    /* Set the root object infinite to avoid a test. */
+                for (unsigned int n; count > 0; first += n, count -= n)
+                {
+                    n = (count < MeshTriangleTree::kBlockSize ? count : MeshTriangleTree::kBlockSize);
 
-    Check_And_Enqueue(*mtpQueue, Root, &Root->BBox, &rayinfo, Thread->Stats());
+                    unsigned int candidates = tree.FindCandidates(ray, first, n);
 
-    /* Check elements in the priority queue. */
+                    for (unsigned int i = 0; candidates != 0; i++, candidates >>= 1)
+                    {
+                        if ((candidates & 1) == 0)
+                            continue;
 
-    while (!mtpQueue->IsEmpty())
-    {
-        mtpQueue->RemoveMin(Depth, Node);
+                        const MESH_TRIANGLE *Triangle = &mesh.Data->Triangles[order[first + i]];
 
-        /*
-         * If current intersection is larger than the best intersection found
-         * so far our task is finished, because all other bounding boxes in
-         * the priority queue are further away.
-         */
-
-        /* NK 1999 - had to comment this out for use with CSG
-        if (Depth > Best)
-        {
-            break;
-        }
-        */
-        if ( !OldStyle && Depth > Best)
-            break;
+                        if (mesh.intersect_mesh_triangle(ray, Triangle, &Depth) &&
+                            mesh.test_hit(Triangle, origRay, Depth, len, depthStack, thread))
+                        {
+                            found = true;
 
-        /* Check current node. */
+                            /* NK 1999 - we must not stop at the nearest hit when used with CSG */
+                            if (!mesh.has_inside_vector && (Depth < maxdist))
+                                maxdist = Depth;
+                        }
+                    }
+                }
 
-        if (Node->Entries)
-        {
-            /* This is a node containing leaves to be checked. */
+                return found;
+            }
 
-            for (i = 0; i < Node->Entries; i++)
-                Check_And_Enqueue(*mtpQueue, Node->Node[i], &Node->Node[i]->BBox, &rayinfo, Thread->Stats());
-        }
-        else
-        {
-            /* This is a leaf so test the contained triangle. */
+            virtual bool operator()() const override { return found; }
 
-            if (intersect_mesh_triangle(ray, reinterpret_cast<MESH_TRIANGLE *>(Node->Node), &Depth))
-            {
-                if (test_hit(reinterpret_cast<MESH_TRIANGLE *>(Node->Node), Orig_Ray, Depth, len, Depth_Stack, Thread))
-                {
-                    found = true;
+        private:
+            Mesh& mesh;
+            const BasicRay& ray;
+            const BasicRay& origRay;
+            DBL len;
+            IStack& depthStack;
+            TraceThreadData *thread;
+            bool found;
+    };
 
-                    Best = Depth;
-                }
-            }
-        }
-    }
+    IntersectTriangles isect(*this, ray, Orig_Ray, len, Depth_Stack, Thread);
 
-    return(found);
+    return Data->Tree->tree(ray, isect, BOUND_HUGE);
 }
 
 
@@ -2365,57 +2555,53 @@ void Mesh::UVCoord(Vector2d& Result, const Intersection *Inter) const
 
 bool Mesh::inside_bbox_tree(const BasicRay &ray, RenderStatistics& stats) const
 {
-    MeshIndex i, found;
-    DBL Best, Depth;
-    const BBOX_TREE *Node, *Root;
+    /// Counts the intersections with the triangles in a leaf of the mesh's tree.
+    class CountTriangles final : public BVHTree::IntersectLeaf
+    {
+        public:
+            CountTriangles(const Mesh& m, const BasicRay& r) : mesh(m), ray(r), found(0) {}
 
-    /* Create the direction vectors for this ray. */
-    Rayinfo rayinfo(ray);
+            virtual bool operator()(unsigned int first, unsigned int count, double&) override
+            {
+                const MeshTriangleTree& tree = *mesh.Data->Tree;
+                const unsigned int *order = tree.tree.GetObjectList();
+                DBL Depth;
 
-    /* Start with an empty priority queue. */
-    mtpQueue->Clear();
-    found = 0;
+                for (unsigned int n; count > 0; first += n, count -= n)
+                {
+                    n = (count < MeshTriangleTree::kBlockSize ? count : MeshTriangleTree::kBlockSize);
+
+                    unsigned int candidates = tree.FindCandidates(ray, first, n);
+
+                    for (unsigned int i = 0; candidates != 0; i++, candidates >>= 1)
+                    {
+                        /* actually, this should push onto a local depth stack and
+                           make sure that we don't have the same intersection point from
+                           two (or three) different triangles!!!!! */
+                        if (((candidates & 1) != 0) && mesh.intersect_mesh_triangle(ray, &mesh.Data->Triangles[order[first + i]], &Depth))
+                            found++;
+                    }
+                }
 
-    Best = BOUND_HUGE;
+                return (found > 0);
+            }
 
-#ifdef BBOX_EXTRA_STATS
-    stats[totalQueueResets]++;
-#endif
+            virtual bool operator()() const override { return (found > 0); }
 
-    /* Check top node. */
-    Root = Data->Tree;
+            /* odd number = inside, even number = outside */
+            bool IsInside() const { return ((found & 1) != 0); }
 
-    /* Set the root object infinite to avoid a test. */
-    Check_And_Enqueue(*mtpQueue, Root, &Root->BBox, &rayinfo, stats);
+        private:
+            const Mesh& mesh;
+            const BasicRay& ray;
+            MeshIndex found;
+    };
 
-    /* Check elements in the priority queue. */
-    while (!mtpQueue->IsEmpty())
-    {
-        mtpQueue->RemoveMin(Depth, Node);
+    CountTriangles isect(*this, ray);
 
-        /* Check current node. */
-        if (Node->Entries)
-        {
-            /* This is a node containing leaves to be checked. */
-            for (i = 0; i < Node->Entries; i++)
-                Check_And_Enqueue(*mtpQueue, Node->Node[i], &Node->Node[i]->BBox, &rayinfo, stats);
-        }
-        else
-        {
-            /* This is a leaf so test the contained triangle. */
-
-            if (intersect_mesh_triangle(ray, reinterpret_cast<MESH_TRIANGLE *>(Node->Node), &Depth))
-            {
-                /* actually, this should push onto a local depth stack and
-                   make sure that we don't have the same intersection point from
-                   two (or three) different triangles!!!!! */
-                found++;
-            }
-        }
-    }
+    Data->Tree->tree(ray, isect, BOUND_HUGE);
 
-    /* odd number = inside, even number = outside */
-    return ((found & 1) != 0);
+    return isect.IsInside();
 }
 
 void Mesh::Determine_Textures(Intersection *isect, bool hitinside, WeightedTextureVector& textures, TraceThreadData *Threaddata)
@@ -2456,5 +2642,343 @@ void Mesh::Determine_Textures(Intersection *isect, bool hitinside, WeightedTextu
         textures.push_back(WeightedTexture(1.0, Texture));
 }
 
+
+/*****************************************************************************
+*
+* FUNCTION
+*
+*   Save_Mesh_File, Load_Mesh_File
+*
+* INPUT
+*
+* OUTPUT
+*
+* RETURNS
+*
+* AUTHOR
+*
+* DESCRIPTION
+*
+*   Binary mesh files hold the mesh data in exactly the layout used in memory,
+*   including the bounding volume hierarchy and the per-triangle block data,
+*   so that a memory-mapped file can be used in-place: Nothing needs to be
+*   parsed, copied or built, pages are only loaded as the renderer touches
+*   them, and the operating system shares them between all processes (and
+*   frames of an animation) using the same file.
+*
+*   Since the layout depends on compiler and platform, files carry a layout
+*   signature, and are rejected if it does not match. If the tree was built
+*   with a different node width, only the tree is rebuilt.
+*
+* CHANGES
+*
+*   -
+*
+******************************************************************************/
+
+/// Identifies binary mesh files.
+const char MESH_FILE_MAGIC[8] = { 'P', 'O', 'V', 'M', 'E', 'S', 'H', '\x1a' };
+
+/// Version of the binary mesh file format.
+const std::uint32_t MESH_FILE_VERSION = 1;
+
+/// Alignment of the sections of binary mesh files.
+const std::uint64_t MESH_FILE_ALIGNMENT = 64;
+
+/// Flags of binary mesh files.
+enum : std::uint32_t
+{
+    kMeshFileTextured       = 0x0001,   ///< All triangles have a texture.
+    kMeshFileInsideVector   = 0x0002,   ///< An inside vector is specified.
+};
+
+/// Location of a section of a binary mesh file.
+struct MeshFileSection final
+{
+    std::uint64_t offset;
+    std::uint64_t size;
+};
+
+/// Header of a binary mesh file.
+struct MeshFileHeader final
+{
+    char            magic[8];
+    std::uint32_t   version;
+    std::uint32_t   layout;         ///< Signature of the data layout, as computed by @ref GetMeshFileLayout().
+    std::uint32_t   flags;
+    std::uint32_t   treeWidth;      ///< Node width of the tree, or zero if none is stored.
+    std::int32_t    numTextures;
+    std::int32_t    numVertices;
+    std::int32_t    numNormals;
+    std::int32_t    numUVCoords;
+    std::int32_t    numTriangles;
+    std::int32_t    reserved;
+    double          insideVect[3];
+    double          bboxMin[3];
+    double          bboxMax[3];
+    MeshFileSection vertices;
+    MeshFileSection normals;
+    MeshFileSection uvCoords;
+    MeshFileSection triangles;
+    MeshFileSection treeNodes;
+    MeshFileSection treeObjects;
+    MeshFileSection treeBlocks;
+};
+
+/// Compute a signature of the in-memory data layout.
+///
+/// The signature covers byte order, structure sizes and bit field allocation.
+///
+static std::uint32_t GetMeshFileLayout()
+{
+    MESH_TRIANGLE probe{};
+    probe.Perp          = MeshVector(1.0, 2.0, 3.0);
+    probe.Distance      = 4.0;
+    probe.Normal_Ind    = 0x01020304;
+    probe.P1            = 5;
+    probe.N3            = 6;
+    probe.UV3           = 7;
+    probe.Smooth        = 1;
+    probe.Dominant_Axis = 2;
+    probe.vAxis         = 1;
+    probe.ThreeTex      = 1;
+
+    const std::uint32_t sizes[] = {
+        std::uint32_t(sizeof(MeshVector)),
+        std::uint32_t(sizeof(MeshUVVector)),
+        std::uint32_t(sizeof(MeshIndex)),
+        std::uint32_t(sizeof(MESH_TRIANGLE)),
+        std::uint32_t(sizeof(MeshFileHeader)),
+        std::uint32_t(MeshTriangleTree::kBlockSize),
+        std::uint32_t(MeshTriangleTree::kBlockArrays)
+    };
+
+    // FNV-1a
+    std::uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < sizeof(probe); i++)
+        hash = (hash ^ reinterpret_cast<const unsigned char *>(&probe)[i]) * 16777619u;
+    for (size_t i = 0; i < sizeof(sizes); i++)
+        hash = (hash ^ reinterpret_cast<const unsigned char *>(sizes)[i]) * 16777619u;
+    return hash;
+}
+
+/// Round a file offset up to the section alignment.
+static inline std::uint64_t AlignMeshFileOffset(std::uint64_t offset)
+{
+    return (offset + MESH_FILE_ALIGNMENT - 1) & ~(MESH_FILE_ALIGNMENT - 1);
+}
+
+void Mesh::Save_Mesh_File(OStream& file) const
+{
+    MeshFileHeader header;
+    Vector3d P1, P2, P3;
+    Vector3d mins, maxs;
+    const void *sectionData[7];
+    MeshFileSection *sections[7] = { &header.vertices, &header.normals, &header.uvCoords, &header.triangles,
+                                     &header.treeNodes, &header.treeObjects, &header.treeBlocks };
+
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MESH_FILE_MAGIC, sizeof(header.magic));
+    header.version      = MESH_FILE_VERSION;
+    header.layout       = GetMeshFileLayout();
+    header.numTextures  = Number_Of_Textures;
+    header.numVertices  = Data->Number_Of_Vertices;
+    header.numNormals   = Data->Number_Of_Normals;
+    header.numUVCoords  = Data->Number_Of_UVCoords;
+    header.numTriangles = Data->Number_Of_Triangles;
+
+    if ((Type & TEXTURED_OBJECT) != 0)
+        header.flags |= kMeshFileTextured;
+
+    if (has_inside_vector)
+    {
+        header.flags |= kMeshFileInsideVector;
+        for (int axis = X; axis <= Z; axis++)
+            header.insideVect[axis] = Data->Inside_Vect[axis];
+    }
+
+    /* Store the untransformed bounding box, so that it need not be
+       computed from the triangles when loading. */
+
+    mins = Vector3d(BOUND_HUGE);
+    maxs = Vector3d(-BOUND_HUGE);
+
+    for (MeshIndex i = 0; i < Data->Number_Of_Triangles; i++)
+    {
+        get_triangle_vertices(&Data->Triangles[i], P1, P2, P3);
+
+        mins = min(mins, P1, P2, P3);
+        maxs = max(maxs, P1, P2, P3);
+    }
+
+    for (int axis = X; axis <= Z; axis++)
+    {
+        header.bboxMin[axis] = mins[axis];
+        header.bboxMax[axis] = maxs[axis];
+    }
+
+    sectionData[0] = Data->Vertices;
+    header.vertices.size = std::uint64_t(Data->Number_Of_Vertices) * sizeof(MeshVector);
+    sectionData[1] = Data->Normals;
+    header.normals.size = std::uint64_t(Data->Number_Of_Normals) * sizeof(MeshVector);
+    sectionData[2] = Data->UVCoords;
+    header.uvCoords.size = std::uint64_t(Data->Number_Of_UVCoords) * sizeof(MeshUVVector);
+    sectionData[3] = Data->Triangles;
+    header.triangles.size = std::uint64_t(Data->Number_Of_Triangles) * sizeof(MESH_TRIANGLE);
+    sectionData[4] = sectionData[5] = sectionData[6] = nullptr;
+
+    if (Data->Tree != nullptr)
+    {
+        header.treeWidth = BVHTree::GetNodeWidth();
+        sectionData[4] = Data->Tree->tree.GetNodeData();
+        header.treeNodes.size = Data->Tree->tree.GetNodeDataSize();
+        sectionData[5] = Data->Tree->tree.GetObjectList();
+        header.treeObjects.size = std::uint64_t(Data->Tree->tree.GetObjectCount()) * sizeof(unsigned int);
+        sectionData[6] = Data->Tree->v0[X];
+        header.treeBlocks.size = std::uint64_t(Data->Tree->GetPaddedSize()) * MeshTriangleTree::kBlockArrays * sizeof(float);
+    }
+
+    std::uint64_t offset = AlignMeshFileOffset(sizeof(header));
+    for (int i = 0; i < 7; i++)
+    {
+        sections[i]->offset = offset;
+        offset = AlignMeshFileOffset(offset + sections[i]->size);
+    }
+
+    static const char padding[MESH_FILE_ALIGNMENT] = {};
+    bool ok = file.write(&header, sizeof(header));
+    std::uint64_t written = sizeof(header);
+    for (int i = 0; ok && (i < 7); i++)
+    {
+        if (sections[i]->size == 0)
+            continue;
+        if (sections[i]->offset > written)
+            ok = file.write(padding, size_t(sections[i]->offset - written));
+        ok = ok && file.write(sectionData[i], size_t(sections[i]->size));
+        written = sections[i]->offset + sections[i]->size;
+    }
+
+    if (!ok)
+        throw POV_EXCEPTION(kFileDataErr, "Cannot write mesh file.");
+}
+
+MeshIndex Mesh::Load_Mesh_File(const Filesystem::MappedFilePtr& file)
+{
+    const unsigned char *base = reinterpret_cast<const unsigned char *>(file->GetData());
+    std::uint64_t fileSize = file->GetSize();
+    MeshFileHeader header;
+
+    if ((base == nullptr) || (fileSize < sizeof(header)) || (std::memcmp(base, MESH_FILE_MAGIC, sizeof(MESH_FILE_MAGIC)) != 0))
+        throw POV_EXCEPTION(kFileDataErr, "Not a binary mesh file.");
+
+    std::memcpy(&header, base, sizeof(header));
+
+    if ((header.version != MESH_FILE_VERSION) || (header.layout != GetMeshFileLayout()))
+        throw POV_EXCEPTION(kFileDataErr, "Binary mesh file was written by an incompatible version or platform; re-create it from the original mesh.");
+
+    /* Make sure all sections lie within the file and are suitably aligned,
+       and that the counts are consistent with the section sizes. */
+
+    const MeshFileSection *sections[7] = { &header.vertices, &header.normals, &header.uvCoords, &header.triangles,
+                                           &header.treeNodes, &header.treeObjects, &header.treeBlocks };
+    bool valid = (header.numVertices > 0) && (header.numNormals >= 0) && (header.numUVCoords > 0) &&
+                 (header.numTriangles > 0) && (header.numTextures >= 0) &&
+                 (header.vertices.size  == std::uint64_t(header.numVertices)  * sizeof(MeshVector)) &&
+                 (header.normals.size   == std::uint64_t(header.numNormals)   * sizeof(MeshVector)) &&
+                 (header.uvCoords.size  == std::uint64_t(header.numUVCoords)  * sizeof(MeshUVVector)) &&
+                 (header.triangles.size == std::uint64_t(header.numTriangles) * sizeof(MESH_TRIANGLE));
+    for (int i = 0; valid && (i < 7); i++)
+    {
+        valid = (sections[i]->size == 0) ||
+                ((sections[i]->offset % MESH_FILE_ALIGNMENT == 0) &&
+                 (sections[i]->offset <= fileSize) && (sections[i]->size <= fileSize - sections[i]->offset));
+    }
+
+    const MeshVector    *vertices  = reinterpret_cast<const MeshVector *>   (base + header.vertices.offset);
+    const MeshVector    *normals   = reinterpret_cast<const MeshVector *>   (base + header.normals.offset);
+    const MeshUVVector  *uvCoords  = reinterpret_cast<const MeshUVVector *> (base + header.uvCoords.offset);
+    const MESH_TRIANGLE *triangles = reinterpret_cast<const MESH_TRIANGLE *>(base + header.triangles.offset);
+
+    /* Make sure all indices are in range, as the renderer relies on that. */
+
+    for (MeshIndex i = 0; valid && (i < header.numTriangles); i++)
+    {
+        const MESH_TRIANGLE& t = triangles[i];
+        valid = (t.P1 >= 0) && (t.P1 < header.numVertices) &&
+                (t.P2 >= 0) && (t.P2 < header.numVertices) &&
+                (t.P3 >= 0) && (t.P3 < header.numVertices) &&
+                (t.UV1 >= 0) && (t.UV1 < header.numUVCoords) &&
+                (t.UV2 >= 0) && (t.UV2 < header.numUVCoords) &&
+                (t.UV3 >= 0) && (t.UV3 < header.numUVCoords) &&
+                (t.Normal_Ind >= 0) && (t.Normal_Ind < header.numNormals) &&
+                (t.Texture >= -1) && (t.Texture < header.numTextures) &&
+                (!t.Smooth || ((t.N1 >= 0) && (t.N1 < header.numNormals) &&
+                               (t.N2 >= 0) && (t.N2 < header.numNormals) &&
+                               (t.N3 >= 0) && (t.N3 < header.numNormals))) &&
+                (!t.ThreeTex || ((t.Texture >= 0) &&
+                                 (t.Texture2 >= 0) && (t.Texture2 < header.numTextures) &&
+                                 (t.Texture3 >= 0) && (t.Texture3 < header.numTextures)));
+    }
+
+    if (!valid)
+        throw POV_EXCEPTION(kFileDataErr, "Binary mesh file is corrupted.");
+
+    Data = new MESH_DATA();
+    Data->References          = 1;
+    Data->File                = file;
+    Data->Number_Of_Vertices  = header.numVertices;
+    Data->Number_Of_Normals   = header.numNormals;
+    Data->Number_Of_UVCoords  = header.numUVCoords;
+    Data->Number_Of_Triangles = header.numTriangles;
+
+    // The arrays are never modified once the mesh has been parsed.
+    Data->Vertices  = const_cast<MeshVector *>(vertices);
+    Data->Normals   = const_cast<MeshVector *>(normals);
+    Data->UVCoords  = const_cast<MeshUVVector *>(uvCoords);
+    Data->Triangles = const_cast<MESH_TRIANGLE *>(triangles);
+
+    if ((header.flags & kMeshFileTextured) != 0)
+        Type |= TEXTURED_OBJECT;
+
+    if ((header.flags & kMeshFileInsideVector) != 0)
+    {
+        Data->Inside_Vect = Vector3d(header.insideVect[X], header.insideVect[Y], header.insideVect[Z]);
+        has_inside_vector = true;
+        Type &= ~PATCH_OBJECT;
+    }
+    else
+    {
+        has_inside_vector = false;
+        Type |= PATCH_OBJECT;
+    }
+
+    Make_BBox_from_min_max(BBox, Vector3d(header.bboxMin[X], header.bboxMin[Y], header.bboxMin[Z]),
+                                 Vector3d(header.bboxMax[X], header.bboxMax[Y], header.bboxMax[Z]));
+
+    /* Use the stored tree if it fits; otherwise a new one will be built
+       along with those of regular meshes. */
+
+    if ((header.treeWidth == BVHTree::GetNodeWidth()) &&
+        (header.treeObjects.size == std::uint64_t(header.numTriangles) * sizeof(unsigned int)) &&
+        (header.treeBlocks.size == (std::uint64_t(header.numTriangles) + MeshTriangleTree::kBlockSize) *
+                                   MeshTriangleTree::kBlockArrays * sizeof(float)))
+    {
+        Data->Tree = new MeshTriangleTree();
+        if (Data->Tree->tree.Attach(base + header.treeNodes.offset, size_t(header.treeNodes.size),
+                                    reinterpret_cast<const unsigned int *>(base + header.treeObjects.offset),
+                                    (unsigned int)header.numTriangles))
+        {
+            Data->Tree->SetBlockData(reinterpret_cast<const float *>(base + header.treeBlocks.offset));
+        }
+        else
+        {
+            delete Data->Tree;
+            Data->Tree = nullptr;
+        }
+    }
+
+    return header.numTextures;
+}
+
 }
 // end of namespace pov
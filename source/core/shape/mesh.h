@@ -46,7 +46,8 @@
 #include <memory>
 
 // POV-Ray header files (base module)
-//  (none at the moment)
+#include "base/fileinputoutput_fwd.h"
+#include "base/filesystem_fwd.h"
 
 // POV-Ray header files (core module)
 #include "core/bounding/boundingbox_fwd.h"
@@ -104,6 +105,8 @@ struct Mesh_Triangle_Struct final
 };
 using MESH_TRIANGLE = Mesh_Triangle_Struct; ///< @deprecated
 
+class MeshTriangleTree;
+
 struct Mesh_Data_Struct final
 {
     int References;                    ///< Number of references to the mesh.
@@ -114,8 +117,9 @@ struct Mesh_Data_Struct final
     MeshVector *Normals, *Vertices;    ///< Arrays of normals and vertices.
     MeshUVVector *UVCoords;            ///< Array of UV coordinates
     MESH_TRIANGLE *Triangles;          ///< Array of triangles.
-    BBOX_TREE *Tree;                   ///< Bounding box tree for mesh.
+    MeshTriangleTree *Tree;            ///< Bounding volume hierarchy for mesh.
     Vector3d Inside_Vect;              ///< vector to use to test 'inside'
+    pov_base::Filesystem::MappedFilePtr File; ///< Binary mesh file the arrays reside in, if any.
 };
 using MESH_DATA = Mesh_Data_Struct; ///< @deprecated
 
@@ -165,6 +169,14 @@ class Mesh final : public ObjectBase
         bool Compute_Mesh_Triangle(MESH_TRIANGLE *Triangle, bool Smooth, const Vector3d& P1, const Vector3d& P2, const Vector3d& P3, Vector3d& S_Normal) const;
 
         void Build_Mesh_BBox_Tree();
+
+        /// Write the mesh data, including the bounding volume hierarchy, to a binary mesh file.
+        void Save_Mesh_File(pov_base::OStream& file) const;
+
+        /// Use the mesh data in a memory-mapped binary mesh file in-place.
+        /// @note The object's textures are not stored in the file and need to be supplied separately.
+        /// @return Number of textures referenced by the triangles.
+        MeshIndex Load_Mesh_File(const pov_base::Filesystem::MappedFilePtr& file);
         bool Degenerate(const Vector3d& P1, const Vector3d& P2, const Vector3d& P3);
         void Init_Mesh_Triangle(MESH_TRIANGLE *Triangle);
         void Destroy_Mesh_Hash_Tables();
@@ -196,17 +208,6 @@ private:
         static HASH_TABLE **Vertex_Hash_Table;
         static HASH_TABLE **Normal_Hash_Table;
         static UV_HASH_TABLE **UV_Hash_Table;
-
-        /// Priority queue object.
-        ///
-        /// This object is for temporary use in the intersection and insideness tests;
-        /// the only reason it is not simply a local variable there is that we want to
-        /// avoid the overhead of repeated construction and destruction on the stack.
-        /// Technically we could get the same performance by keeping it local to the
-        /// functions and making it thread-local, but this would mean having one such
-        /// object per function, when it's perfectly safe for them to share one object.
-        ///
-        static thread_local std::unique_ptr<BBoxPriorityQueue> mtpQueue;
 };
 
 /// @}
@@ -450,7 +450,6 @@ bool Parametric::Inside(const Vector3d&, TraceThreadData *Thread) const
 void Parametric::Normal(Vector3d& Result, Intersection *Inter, TraceThreadData *Thread) const
 {
     Vector3d RU, RV;
-    Vector2d uv_vect;
 
     std::array<GenericScalarFunctionInstance,3> aFn = {
         GenericScalarFunctionInstance(Function[0], Thread),
@@ -458,22 +457,21 @@ void Parametric::Normal(Vector3d& Result, Intersection *Inter, TraceThreadData *
         GenericScalarFunctionInstance(Function[2], Thread)
     };
 
-    uv_vect[U] = Inter->Iuv[U];
-    uv_vect[V] = Inter->Iuv[V];
-    RU[X] = RV[X] = -aFn[X].Evaluate(uv_vect);
-    RU[Y] = RV[Y] = -aFn[Y].Evaluate(uv_vect);
-    RU[Z] = RV[Z] = -aFn[Z].Evaluate(uv_vect);
+    // Evaluate each function at the intersection and at the two offset points in one go
+    DBL u[3], v[3], f[3];
 
-    uv_vect[U] += accuracy;
-    RU[X] += aFn[X].Evaluate(uv_vect);
-    RU[Y] += aFn[Y].Evaluate(uv_vect);
-    RU[Z] += aFn[Z].Evaluate(uv_vect);
+    u[0] = u[1] = u[2] = Inter->Iuv[U];
+    v[0] = v[1] = v[2] = Inter->Iuv[V];
+    u[1] += accuracy;
+    v[2] += accuracy;
 
-    uv_vect[U] = Inter->Iuv[U];
-    uv_vect[V] += accuracy;
-    RV[X] += aFn[X].Evaluate(uv_vect);
-    RV[Y] += aFn[Y].Evaluate(uv_vect);
-    RV[Z] += aFn[Z].Evaluate(uv_vect);
+    for (int i = X; i <= Z; i++)
+    {
+        aFn[i].EvaluateBatch(u, v, f, 3);
+        RU[i] = RV[i] = -f[0];
+        RU[i] += f[1];
+        RV[i] += f[2];
+    }
 
     Result = cross(RU, RV);
     if (Trans != nullptr)
@@ -1094,10 +1092,16 @@ void Parametric::Evaluate_Function_Interval_UV(GenericScalarFunctionInstance& fn
 
     /* Calculate the values at each corner */
 
-    f_0_0 = fn.Evaluate(fnvec_low[U], fnvec_low[V]) - threshold;
-    f_0_1 = fn.Evaluate(fnvec_low[U], fnvec_hi[V])  - threshold;
-    f_1_0 = fn.Evaluate(fnvec_hi[U],  fnvec_low[V]) - threshold;
-    f_1_1 = fn.Evaluate(fnvec_hi[U],  fnvec_hi[V])  - threshold;
+    const DBL cornerU[4] = { fnvec_low[U], fnvec_low[U], fnvec_hi[U],  fnvec_hi[U] };
+    const DBL cornerV[4] = { fnvec_low[V], fnvec_hi[V],  fnvec_low[V], fnvec_hi[V] };
+    DBL corner[4];
+
+    fn.EvaluateBatch(cornerU, cornerV, corner, 4);
+
+    f_0_0 = corner[0] - threshold;
+    f_0_1 = corner[1] - threshold;
+    f_1_0 = corner[2] - threshold;
+    f_1_1 = corner[3] - threshold;
 
     /* Determine a min and a max along the left edge of the patch */
     Interval( fnvec_hi[V]-fnvec_low[V], f_0_0, f_0_1, max_gradient, &f_0_min, &f_0_max);
@@ -64,7 +64,7 @@ namespace pov
 ///
 /// @{
 
-#define POLY_OBJECT    (STURM_OK_OBJECT)
+#define POLY_OBJECT    (STURM_OK_OBJECT+UNBOUNDED_INSIDE_OBJECT)
 #define CUBIC_OBJECT   (STURM_OK_OBJECT)
 #define QUARTIC_OBJECT (STURM_OK_OBJECT)
 
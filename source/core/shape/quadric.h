@@ -67,7 +67,7 @@ class Plane;
 ///
 /// @{
 
-#define QUADRIC_OBJECT (BASIC_OBJECT)
+#define QUADRIC_OBJECT (BASIC_OBJECT+UNBOUNDED_INSIDE_OBJECT)
 
 /// @}
 ///
@@ -37,8 +37,11 @@
 #include "core/support/imageutil.h"
 
 // C++ variants of C standard header files
+#include <cmath>
+
 // C++ standard header files
-//  (none at the moment)
+#include <algorithm>
+#include <vector>
 
 // POV-Ray header files (base module)
 #include "base/pov_err.h"
@@ -92,12 +95,13 @@ static int torus_image_map(const Vector3d& EPoint, const ImageData *image, DBL *
 static int spherical_image_map(const Vector3d& EPoint, const ImageData *image, DBL *u, DBL *v);
 static int planar_image_map(const Vector3d& EPoint, const ImageData *image, DBL *u, DBL *v);
 static int angular_image_map(const Vector3d& EPoint, const ImageData *image, DBL *u, DBL  *v);
-static void no_interpolation(const ImageData *image, DBL xcoor, DBL ycoor, RGBFTColour& colour, int *index, bool premul);
+static void no_interpolation(const ImageData *image, Image *data, int width, int height, DBL xcoor, DBL ycoor, RGBFTColour& colour, int *index, bool premul);
 static void bilinear(DBL *factors, DBL x, DBL y);
 static void norm_dist(DBL *factors, DBL x, DBL y);
 static void cubic(DBL *factors, DBL x);
-static void Interp(const ImageData *image, DBL xcoor, DBL ycoor, RGBFTColour& colour, int *index, bool premul);
-static void InterpolateBicubic(const ImageData *image, DBL xcoor, DBL ycoor, RGBFTColour& colour, int *index, bool premul);
+static void Interp(const ImageData *image, Image *data, int width, int height, DBL xcoor, DBL ycoor, RGBFTColour& colour, int *index, bool premul);
+static void InterpolateBicubic(const ImageData *image, Image *data, int width, int height, DBL xcoor, DBL ycoor, RGBFTColour& colour, int *index, bool premul);
+static void interpolate_level(const ImageData *image, unsigned int level, DBL xcoor, DBL ycoor, RGBFTColour& colour, int *index, bool premul);
 
 /*
  * 2-D to 3-D Procedural Texture Mapping of a Bitmapped Image onto an Object:
@@ -190,7 +194,7 @@ TEXTURE *material_map(const Vector3d& EPoint, const TEXTURE *Texture)
 *
 ******************************************************************************/
 
-void bump_map(const Vector3d& EPoint, const TNORMAL *Tnormal, Vector3d& normal)
+void bump_map(const Vector3d& EPoint, const TNORMAL *Tnormal, Vector3d& normal, DBL size)
 {
     DBL xcoor = 0.0, ycoor = 0.0;
     int index = -1, index2 = -1, index3 = -1;
@@ -200,6 +204,8 @@ void bump_map(const Vector3d& EPoint, const TNORMAL *Tnormal, Vector3d& normal)
     Vector3d xprime, yprime, zprime;
     DBL Length;
     DBL Amount = Tnormal->Amount;
+    DBL footprint = 0.0;
+    DBL step = 1.0;
     const ImageData *image;
 
     // NB: Can't use `static_cast` here due to multi-inheritance in the pattern class hierarchy.
@@ -213,11 +219,20 @@ void bump_map(const Vector3d& EPoint, const TNORMAL *Tnormal, Vector3d& normal)
 
     if(map_pos(EPoint, image, &xcoor, &ycoor))
         return;
-    else
-        image_colour_at(image, xcoor, ycoor, colour1, &index); // TODO ALPHA - we should decide whether we prefer premultiplied or non-premultiplied alpha
 
-    xcoor--;
-    ycoor++;
+    // With a MIP-mapped image, take the height differences across the pixel
+    // footprint, from the matching level, so that minified bump maps do not alias.
+    if(!image->MipLevels.empty())
+    {
+        footprint = image_footprint(EPoint, image, xcoor, ycoor, size);
+        step = std::max(1.0, std::min(footprint, 0.5 * std::min(image->iwidth, image->iheight)));
+        Amount /= step;
+    }
+
+    image_colour_at(image, xcoor, ycoor, colour1, &index, image->data->IsPremultiplied(), footprint); // TODO ALPHA - we should decide whether we prefer premultiplied or non-premultiplied alpha
+
+    xcoor -= step;
+    ycoor += step;
 
     if(xcoor < 0.0)
         xcoor += (DBL)image->iwidth;
@@ -229,16 +244,16 @@ void bump_map(const Vector3d& EPoint, const TNORMAL *Tnormal, Vector3d& normal)
     else if(ycoor >= (DBL)image->iheight)
         ycoor -= (DBL)image->iheight;
 
-    image_colour_at(image, xcoor, ycoor, colour2, &index2); // TODO ALPHA - we should decide whether we prefer premultiplied or non-premultiplied alpha
+    image_colour_at(image, xcoor, ycoor, colour2, &index2, image->data->IsPremultiplied(), footprint); // TODO ALPHA - we should decide whether we prefer premultiplied or non-premultiplied alpha
 
-    xcoor += 2.0;
+    xcoor += 2.0 * step;
 
     if(xcoor < 0.0)
         xcoor += (DBL)image->iwidth;
     else if(xcoor >= image->iwidth)
         xcoor -= (DBL)image->iwidth;
 
-    image_colour_at(image, xcoor, ycoor, colour3, &index3); // TODO ALPHA - we should decide whether we prefer premultiplied or non-premultiplied alpha
+    image_colour_at(image, xcoor, ycoor, colour3, &index3, image->data->IsPremultiplied(), footprint); // TODO ALPHA - we should decide whether we prefer premultiplied or non-premultiplied alpha
 
     if(image->Use || (index == -1) || (index2 == -1) || (index3 == -1))
     {
@@ -322,7 +337,7 @@ void bump_map(const Vector3d& EPoint, const TNORMAL *Tnormal, Vector3d& normal)
 *
 ******************************************************************************/
 
-DBL image_pattern(const Vector3d& EPoint, const ImagePattern* pPattern)
+DBL image_pattern(const Vector3d& EPoint, const ImagePattern* pPattern, DBL size)
 {
     DBL xcoor = 0.0, ycoor = 0.0;
     int index = -1;
@@ -338,7 +353,10 @@ DBL image_pattern(const Vector3d& EPoint, const ImagePattern* pPattern)
     if(map_pos(EPoint, pPattern->pImage, &xcoor, &ycoor))
         return 0.0;
     else
-        image_colour_at(image, xcoor, ycoor, colour, &index); // TODO ALPHA - we should decide whether we prefer premultiplied or non-premultiplied alpha
+    {
+        DBL footprint = (image->MipLevels.empty() ? 0.0 : image_footprint(EPoint, image, xcoor, ycoor, size));
+        image_colour_at(image, xcoor, ycoor, colour, &index, image->data->IsPremultiplied(), footprint); // TODO ALPHA - we should decide whether we prefer premultiplied or non-premultiplied alpha
+    }
 
     if((index == -1) || image->Use)
     {
@@ -393,7 +411,7 @@ void image_colour_at(const ImageData *image, DBL xcoor, DBL ycoor, RGBFTColour&
     image_colour_at(image, xcoor, ycoor, colour, index, image->data->IsPremultiplied());
 }
 
-void image_colour_at(const ImageData *image, DBL xcoor, DBL ycoor, RGBFTColour& colour, int *index, bool premul)
+void image_colour_at(const ImageData *image, DBL xcoor, DBL ycoor, RGBFTColour& colour, int *index, bool premul, DBL footprint)
 {
     *index = -1;
 
@@ -407,17 +425,25 @@ void image_colour_at(const ImageData *image, DBL xcoor, DBL ycoor, RGBFTColour&
     bool getPremul = doProperTransmitAll ? (premul && image->data->IsPremultiplied()) :
                                            (premul || image->data->IsPremultiplied());
 
-    switch(image->Interpolation_Type)
+    // Pick the MIP map levels matching the footprint, if any; the full-resolution
+    // image is used as is unless it is minified.
+    DBL lod = ((footprint > 1.0) && !image->MipLevels.empty() ? log2(footprint) : 0.0);
+    unsigned int level = (unsigned int)std::min(lod, (DBL)image->MipLevels.size());
+
+    if (lod <= 0.0)
+        interpolate_level(image, 0, xcoor, ycoor, colour, index, getPremul);
+    else if (level >= image->MipLevels.size())
+        interpolate_level(image, level, xcoor, ycoor, colour, index, getPremul);
+    else
     {
-        case NO_INTERPOLATION:
-            no_interpolation(image, xcoor, ycoor, colour, index, getPremul);
-            break;
-        case BICUBIC:
-            InterpolateBicubic(image, xcoor, ycoor, colour, index, getPremul);
-            break;
-        default:
-            Interp(image, xcoor, ycoor, colour, index, getPremul);
-            break;
+        // Blend between the two nearest levels.
+        RGBFTColour upperColour;
+        int upperIndex;
+        DBL weight = lod - level;
+        interpolate_level(image, level,     xcoor, ycoor, colour,      index,       getPremul);
+        interpolate_level(image, level + 1, xcoor, ycoor, upperColour, &upperIndex, getPremul);
+        colour = RGBFTColour(PreciseRGBFTColour(colour) * (1.0 - weight) + PreciseRGBFTColour(upperColour) * weight);
+        *index = (int)(*index * (1.0 - weight) + upperIndex * weight);
     }
     bool havePremul = getPremul;
 
@@ -460,6 +486,67 @@ void image_colour_at(const ImageData *image, DBL xcoor, DBL ycoor, RGBFTColour&
 }
 
 
+/*****************************************************************************
+*
+* FUNCTION
+*
+*   image_footprint
+*
+* INPUT
+*
+*   EPoint       -- 3-D point at which the image is looked up
+*   image        -- image to look up
+*   xcoor, ycoor -- 2-D point corresponding to EPoint, as computed by map_pos
+*   size         -- approximate diameter of the area to filter over, in the same
+*                   space as EPoint
+*
+* OUTPUT
+*
+* RETURNS
+*
+*   Approximate diameter of the area, in pixels of the full-resolution image,
+*   or 0.0 if unknown.
+*
+* AUTHOR
+*
+* DESCRIPTION
+*
+*   Estimates the image-space footprint from the rate of change of the image
+*   coordinates along each axis. The rate is measured over a small fraction of
+*   the area, so that repeated images do not wrap around in between.
+*
+* CHANGES
+*
+******************************************************************************/
+
+DBL image_footprint(const Vector3d& EPoint, const ImageData *image, DBL xcoor, DBL ycoor, DBL size)
+{
+    const DBL probeFraction = 1.0 / 1024.0;
+    DBL footprint = 0.0;
+
+    if (size <= 0.0)
+        return 0.0;
+
+    for (int axis = X; axis <= Z; axis++)
+    {
+        Vector3d probe(EPoint);
+        DBL u, v;
+
+        probe[axis] += size * probeFraction;
+        if (map_pos(probe, image, &u, &v))
+            continue;
+
+        DBL du = fabs(u - xcoor);
+        DBL dv = fabs(v - ycoor);
+        du = std::min(du, image->iwidth  - du);
+        dv = std::min(dv, image->iheight - dv);
+        footprint = std::max(footprint, sqrt(du * du + dv * dv) / probeFraction);
+    }
+
+    return footprint;
+}
+
+
 /*****************************************************************************
 *
 * FUNCTION
@@ -998,7 +1085,7 @@ int map_pos(const Vector3d& EPoint, const ImageData* image, DBL *xcoor, DBL *yco
 *
 ******************************************************************************/
 
-static void no_interpolation(const ImageData *image, DBL xcoor, DBL ycoor, RGBFTColour& colour, int *index, bool premul)
+static void no_interpolation(const ImageData *image, Image *data, int width, int height, DBL xcoor, DBL ycoor, RGBFTColour& colour, int *index, bool premul)
 {
     int iycoor, ixcoor;
 
@@ -1010,15 +1097,15 @@ static void no_interpolation(const ImageData *image, DBL xcoor, DBL ycoor, RGBFT
 
         if(xcoor < 0.0)
             ixcoor = 0;
-        else if(xcoor >= (DBL)image->iwidth)
-            ixcoor = image->iwidth - 1;
+        else if(xcoor >= (DBL)width)
+            ixcoor = width - 1;
         else
             ixcoor = (int)xcoor;
 
         if(ycoor < 0.0)
             iycoor = 0;
-        else if(ycoor >= (DBL)image->iheight)
-            iycoor = image->iheight - 1;
+        else if(ycoor >= (DBL)height)
+            iycoor = height - 1;
         else
             iycoor = (int)ycoor;
     }
@@ -1027,13 +1114,13 @@ static void no_interpolation(const ImageData *image, DBL xcoor, DBL ycoor, RGBFT
         // image is to be repeated, so when taking samples for interpolation
         // have coordinates wrap around
 
-        ixcoor = (int)wrap(xcoor, (DBL)image->iwidth);
-        iycoor = (int)wrap(ycoor, (DBL)image->iheight);
+        ixcoor = (int)wrap(xcoor, (DBL)width);
+        iycoor = (int)wrap(ycoor, (DBL)height);
     }
 
-    image->data->GetRGBFTValue(ixcoor, iycoor, colour, premul);
+    data->GetRGBFTValue(ixcoor, iycoor, colour, premul);
 
-    if(image->data->IsIndexed() == false)
+    if(data->IsIndexed() == false)
     {
         *index = -1;
 
@@ -1046,7 +1133,7 @@ static void no_interpolation(const ImageData *image, DBL xcoor, DBL ycoor, RGBFT
         }
     }
     else
-        *index = image->data->GetIndexedValue(ixcoor, iycoor);
+        *index = data->GetIndexedValue(ixcoor, iycoor);
 }
 
 
@@ -1071,7 +1158,7 @@ static void no_interpolation(const ImageData *image, DBL xcoor, DBL ycoor, RGBFT
 
 // Interpolate color and filter values when mapping
 
-static void Interp(const ImageData *image, DBL xcoor, DBL ycoor, RGBFTColour& colour, int *index, bool premul)
+static void Interp(const ImageData *image, Image *data, int width, int height, DBL xcoor, DBL ycoor, RGBFTColour& colour, int *index, bool premul)
 {
     int iycoor, ixcoor, i;
     int Corners_Index[4];
@@ -1084,10 +1171,10 @@ static void Interp(const ImageData *image, DBL xcoor, DBL ycoor, RGBFTColour& co
     iycoor = (int)ycoor;
     ixcoor = (int)xcoor;
 
-    no_interpolation(image, (DBL)ixcoor,     (DBL)iycoor,     Corner_Colour[0], &Corners_Index[0], premul);
-    no_interpolation(image, (DBL)ixcoor - 1, (DBL)iycoor,     Corner_Colour[1], &Corners_Index[1], premul);
-    no_interpolation(image, (DBL)ixcoor,     (DBL)iycoor - 1, Corner_Colour[2], &Corners_Index[2], premul);
-    no_interpolation(image, (DBL)ixcoor - 1, (DBL)iycoor - 1, Corner_Colour[3], &Corners_Index[3], premul);
+    no_interpolation(image, data, width, height, (DBL)ixcoor,     (DBL)iycoor,     Corner_Colour[0], &Corners_Index[0], premul);
+    no_interpolation(image, data, width, height, (DBL)ixcoor - 1, (DBL)iycoor,     Corner_Colour[1], &Corners_Index[1], premul);
+    no_interpolation(image, data, width, height, (DBL)ixcoor,     (DBL)iycoor - 1, Corner_Colour[2], &Corners_Index[2], premul);
+    no_interpolation(image, data, width, height, (DBL)ixcoor - 1, (DBL)iycoor - 1, Corner_Colour[3], &Corners_Index[3], premul);
 
     if(image->Interpolation_Type == BILINEAR)
         bilinear(Corner_Factors, xcoor, ycoor);
@@ -1143,7 +1230,7 @@ static void cubic(DBL *factors, DBL x)
     factors[3] = -0.5 * q * p*p;
 }
 
-static void InterpolateBicubic(const ImageData *image, DBL xcoor, DBL  ycoor, RGBFTColour& colour, int *index, bool premul)
+static void InterpolateBicubic(const ImageData *image, Image *data, int width, int height, DBL xcoor, DBL  ycoor, RGBFTColour& colour, int *index, bool premul)
 {
     int iycoor, ixcoor;
     int cornerIndex;
@@ -1174,7 +1261,7 @@ static void InterpolateBicubic(const ImageData *image, DBL xcoor, DBL  ycoor, RG
         for (int j = 0; j < 4; j ++)
         {
             cornerColour.Clear();
-            no_interpolation(image, (DBL)ixcoor + i-2, (DBL)iycoor + j-2, cornerColour, &cornerIndex, premul);
+            no_interpolation(image, data, width, height, (DBL)ixcoor + i-2, (DBL)iycoor + j-2, cornerColour, &cornerIndex, premul);
             factor = factorsX[i] * factorsY[j];
             tempColour += PreciseRGBFTColour(cornerColour) * factor;
             tempIndex  += cornerIndex                      * factor;
@@ -1186,6 +1273,65 @@ static void InterpolateBicubic(const ImageData *image, DBL xcoor, DBL  ycoor, RG
 
 
 
+/*****************************************************************************
+*
+* FUNCTION
+*
+*   interpolate_level
+*
+* INPUT
+*
+*   image        -- image to look up
+*   level        -- MIP map level to use, with 0 designating the full-resolution image
+*   xcoor, ycoor -- coordinates within the full-resolution image
+*
+* OUTPUT
+*
+*   colour, index -- interpolated result
+*
+* RETURNS
+*
+* AUTHOR
+*
+* DESCRIPTION
+*
+*   Look up a single MIP map level, using the image's interpolation type.
+*
+* CHANGES
+*
+******************************************************************************/
+
+static void interpolate_level(const ImageData *image, unsigned int level, DBL xcoor, DBL ycoor, RGBFTColour& colour, int *index, bool premul)
+{
+    Image *data = image->data;
+    int width = image->iwidth;
+    int height = image->iheight;
+
+    if (level > 0)
+    {
+        data = image->MipLevels[level - 1];
+        xcoor *= DBL(data->GetWidth())  / width;
+        ycoor *= DBL(data->GetHeight()) / height;
+        width  = data->GetWidth();
+        height = data->GetHeight();
+    }
+
+    switch(image->Interpolation_Type)
+    {
+        case NO_INTERPOLATION:
+            no_interpolation(image, data, width, height, xcoor, ycoor, colour, index, premul);
+            break;
+        case BICUBIC:
+            InterpolateBicubic(image, data, width, height, xcoor, ycoor, colour, index, premul);
+            break;
+        default:
+            Interp(image, data, width, height, xcoor, ycoor, colour, index, premul);
+            break;
+    }
+}
+
+
+
 /*****************************************************************************
 *
 * FUNCTION
@@ -1403,6 +1549,9 @@ ImageData::~ImageData()
 
     if (data != nullptr)
         delete data;
+
+    for (std::vector<Image*>::iterator i = MipLevels.begin(); i != MipLevels.end(); ++i)
+        delete *i;
 }
 
 }
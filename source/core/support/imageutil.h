@@ -41,9 +41,11 @@
 #include "core/configcore.h"
 
 // C++ variants of C standard header files
-// C++ standard header files
 //  (none at the moment)
 
+// C++ standard header files
+#include <vector>
+
 // POV-Ray header files (base module)
 #include "base/image/image_fwd.h"
 
@@ -117,6 +119,9 @@ class ImageData final
         COLC AllFilter, AllTransmit;
         void *Object;
         Image *data;
+        /// Successively halved versions of @ref data, if available, for filtering
+        /// of minified images; owned by this object.
+        std::vector<Image*> MipLevels;
 
 // it would have been a lot cleaner if POV_VIDCAP_IMPL was a subclass of pov::Image,
 // since we could just assign it to data above and the following would not be needed.
@@ -132,11 +137,12 @@ class ImageData final
 
 typedef ImageData *ImageDataPtr;
 
-DBL image_pattern(const Vector3d& EPoint, const ImagePattern* pPattern); // TODO - move to pattern.cpp
+DBL image_pattern(const Vector3d& EPoint, const ImagePattern* pPattern, DBL size = 0.0); // TODO - move to pattern.cpp
 TEXTURE *material_map(const Vector3d& IPoint, const TEXTURE *Texture);
-void bump_map(const Vector3d& EPoint, const TNORMAL *Tnormal, Vector3d& normal);
+void bump_map(const Vector3d& EPoint, const TNORMAL *Tnormal, Vector3d& normal, DBL size = 0.0);
 void image_colour_at(const ImageData *image, DBL xcoor, DBL ycoor, RGBFTColour& colour, int *index); // TODO ALPHA - caller should decide whether to prefer premultiplied or non-premultiplied alpha
-void image_colour_at(const ImageData *image, DBL xcoor, DBL ycoor, RGBFTColour& colour, int *index, bool premul);
+void image_colour_at(const ImageData *image, DBL xcoor, DBL ycoor, RGBFTColour& colour, int *index, bool premul, DBL footprint = 0.0);
+DBL image_footprint(const Vector3d& EPoint, const ImageData *image, DBL xcoor, DBL ycoor, DBL size);
 HF_VAL image_height_at(const ImageData *image, int x, int y);
 bool is_image_opaque(const ImageData *image);
 int map_pos(const Vector3d& EPoint, const ImageData* pImage, DBL *xcoor, DBL *ycoor);
@@ -460,7 +460,7 @@ bool ot_save_node (const Vector3d& point, OT_ID *node);
 bool ot_traverse (OT_NODE *subtree, bool (*function)(OT_BLOCK *block, void * handle1), void * handle2);
 bool ot_free_subtree (OT_NODE *node);
 
-void ot_list_insert (OT_BLOCK **list_ptr, OT_BLOCK *item);
+void ot_list_insert (std::atomic<OT_BLOCK *> *list_ptr, OT_BLOCK *item);
 bool ot_point_in_node (const Vector3d& point, const OT_ID *node);
 
 /*****************************************************************************
@@ -661,7 +661,7 @@ void ot_ins(OT_NODE **root_ptr, OT_BLOCK *new_block, const OT_ID *new_id)
 *
 ******************************************************************************/
 
-void ot_list_insert(OT_BLOCK **list_head, OT_BLOCK *new_block)
+void ot_list_insert(std::atomic<OT_BLOCK *> *list_head, OT_BLOCK *new_block)
 {
     new_block->next = *list_head; // copy addr of old first block
 
@@ -51,7 +51,7 @@
 #include <climits>
 
 // C++ standard header files
-//  (none at the moment)
+#include <atomic>
 
 // POV-Ray header files (base module)
 #include "base/fileinputoutput_fwd.h"
@@ -128,11 +128,13 @@ struct ot_id_struct final
 using OT_ID = ot_id_struct; ///< @deprecated
 
 // These are the structures that make up the oct-tree itself, known as nodes
+// (Child nodes and the head of the block list are atomic so that they can be hooked in
+// by compare-and-swap while other threads are traversing or inserting into the tree.)
 struct ot_node_struct final
 {
     OT_ID    Id;
-    OT_BLOCK *Values;
-    ot_node_struct *Kids[8];
+    std::atomic<OT_BLOCK *> Values;
+    std::atomic<ot_node_struct *> Kids[8];
 
     ot_node_struct() : Id(), Values(nullptr) { for (unsigned int i = 0; i < 8; i ++) { Kids[i] = nullptr; } }
 };
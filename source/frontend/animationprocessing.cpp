@@ -141,6 +141,10 @@ POVMS_Object AnimationProcessing::GetFrameRenderOptions()
     if(nominalFrameNumber > subsetStartFrame)
         opts.SetBool(kPOVAttrib_AppendConsoleFiles, true);
 
+    // tell the parser whether it may carry over data from the previous frame, and whether to keep any for the next one
+    opts.SetBool(kPOVAttrib_ContinuedAnimation, nominalFrameNumber > subsetStartFrame);
+    opts.SetBool(kPOVAttrib_LastAnimationFrame, !MoreFrames());
+
     POVMS_List declares;
     if(opts.Exist(kPOVAttrib_Declare) == true)
         opts.Get(kPOVAttrib_Declare, declares);
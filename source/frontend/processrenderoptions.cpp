@@ -145,6 +145,7 @@ struct ProcessOptions::INI_Parser_Table RenderOptions_INI_Table[] =
 
     { "End_Column",          kPOVAttrib_Right,              kPOVMSType_Float },
     { "End_Row",             kPOVAttrib_Bottom,             kPOVMSType_Float },
+    { "Export_Lighting",     kPOVAttrib_ExportLighting,     kPOVMSType_UCS2String },
 
     { "Fatal_Console",       kPOVAttrib_FatalConsole,       kPOVMSType_Bool },
     { "Fatal_Error_Command", kPOVAttrib_FatalErrorCommand,  kUseSpecialHandler },
@@ -165,9 +166,13 @@ struct ProcessOptions::INI_Parser_Table RenderOptions_INI_Table[] =
     { "Histogram_Grid_Size", 0,                             0 },
     { "Histogram_Type",      0,                             0 },
 
+    { "Import_Continue_Trace_Log", kPOVAttrib_ImportTraceLog, kPOVMSType_UCS2String },
+    { "Import_Lighting",     kPOVAttrib_ImportLighting,     kPOVMSType_UCS2String },
     { "Initial_Clock",       kPOVAttrib_InitialClock,       kPOVMSType_Float },
     { "Initial_Frame",       kPOVAttrib_InitialFrame,       kPOVMSType_Int },
     { "Input_File_Name",     kPOVAttrib_InputFile,          kPOVMSType_UCS2String },
+    { "Include_Cache_Max_File_Size", kPOVAttrib_IncludeCacheMaxFileSize, kPOVMSType_Int },
+    { "Include_Cache_Path",  kPOVAttrib_IncludeCachePath,   kPOVMSType_UCS2String },
     { "Include_Header",      kPOVAttrib_IncludeHeader,      kPOVMSType_UCS2String },
     { "Include_Ini",         kPOVAttrib_IncludeIni,         kUseSpecialHandler },
 
@@ -208,9 +213,13 @@ struct ProcessOptions::INI_Parser_Table RenderOptions_INI_Table[] =
     { "Remove_Bounds",       kPOVAttrib_RemoveBounds,       kPOVMSType_Bool },
     { "Render_Block_Size",   kPOVAttrib_RenderBlockSize,    kPOVMSType_Int },
     { "Render_Block_Step",   kPOVAttrib_RenderBlockStep,    kPOVMSType_Int },
+    { "Render_Block_Subset_Count", kPOVAttrib_RenderBlockSubsetCount, kPOVMSType_Int },
+    { "Render_Block_Subset_Index", kPOVAttrib_RenderBlockSubsetIndex, kPOVMSType_Int },
     { "Render_Console",      kPOVAttrib_RenderConsole,      kPOVMSType_Bool },
     { "Render_File",         kPOVAttrib_RenderFile,         kPOVMSType_UCS2String },
     { "Render_Pattern",      kPOVAttrib_RenderPattern,      kPOVMSType_Int },
+    { "Reuse_Static_Lighting",kPOVAttrib_ReuseStaticLighting, kPOVMSType_Bool },
+    { "Reuse_Static_Objects",kPOVAttrib_ReuseStaticObjects, kPOVMSType_Bool },
 
     { "Sampling_Method",     kPOVAttrib_SamplingMethod,     kPOVMSType_Int },
     { "Split_Unions",        kPOVAttrib_SplitUnions,        kPOVMSType_Bool },
@@ -224,6 +233,8 @@ struct ProcessOptions::INI_Parser_Table RenderOptions_INI_Table[] =
 
     { "Test_Abort_Count",    kPOVAttrib_TestAbortCount,     kPOVMSType_Int },
     { "Test_Abort",          kPOVAttrib_TestAbort,          kPOVMSType_Bool },
+    { "Texture_Cache_Memory",kPOVAttrib_TextureCacheMemory, kPOVMSType_Int },
+    { "Texture_Cache_Path",  kPOVAttrib_TextureCachePath,   kPOVMSType_UCS2String },
 
     { "User_Abort_Command",  kPOVAttrib_UserAbortCommand,   kUseSpecialHandler },
     { "User_Abort_Return",   kPOVAttrib_UserAbortCommand,   kUseSpecialHandler },
@@ -662,62 +662,12 @@ void RenderFrontendBase::ContinueBackup(POVMS_Object& ropts, ViewData& vd, ViewI
 
     std::unique_ptr<IStream> inbuffer(new IFileStream(vd.imageBackupFile().c_str()));
 
-    size_t pos = sizeof(Backup_File_Header);
+    POV_OFF_T pos = sizeof(Backup_File_Header);
 
     if (inbuffer != nullptr)
     {
-        Backup_File_Header hdr;
-
         if(*inbuffer)
-        {
-            // IOBase::eof() only is based on feof() and will only return
-            // true if we have attempted to read past the end of the file.
-            // therefore msg.Read() will throw an exception when we try to
-            // read from the end of the file, which isn't harmful per se but
-            // makes debugging more difficult since it is caught by the VC++
-            // IDE, and we don't want to disable catching pov_base::Exception
-            // since they are generally useful. therefore we explicitly check
-            // for the end of the file.
-            inbuffer->seekg (0, IOBase::seek_end);
-            POV_OFF_T end = inbuffer->tellg();
-            inbuffer->seekg (0, IOBase::seek_set);
-
-            if (inbuffer->read (&hdr, sizeof (hdr)) == false)
-                throw POV_EXCEPTION(kFileDataErr, "Cannot read header from render state file.");
-            if (memcmp (hdr.sig, RENDER_STATE_SIG, sizeof (hdr.sig)) != 0)
-                throw POV_EXCEPTION(kFileDataErr, "Render state file header appears to be invalid.");
-            if (memcmp (hdr.ver, RENDER_STATE_VER, sizeof (hdr.ver)) != 0)
-                throw POV_EXCEPTION(kFileDataErr, "Render state file was written by another version of POV-Ray.");
-
-            while(pos < end && inbuffer->eof() == false)
-            {
-                POVMS_Message msg;
-
-                try
-                {
-                    msg.Read(*(inbuffer.get()));
-
-                    // do not render complete blocks again
-                    if(msg.Exist(kPOVAttrib_PixelId) == true)
-                    {
-                        POVMSInt pid = msg.GetInt(kPOVAttrib_PixelId);
-
-                        if(pid > serial)
-                            skip.push_back(pid);
-                        else
-                            serial++;
-                    }
-
-                    HandleImageMessage(vid, msg.GetIdentifier(), msg);
-                }
-                catch(pov_base::Exception&)
-                {
-                    // ignore all problems, just assume file is broken from last message on
-                    break;
-                }
-                pos = inbuffer->tellg();
-            }
-        }
+            pos = ReadBackup(*inbuffer, vid, serial, skip);
         else
         {
             // file doesn't exist, we create it via NewBackup
@@ -749,6 +699,73 @@ void RenderFrontendBase::ContinueBackup(POVMS_Object& ropts, ViewData& vd, ViewI
     }
 }
 
+void RenderFrontendBase::ImportBackup(const UCS2String& filename, ViewId vid, POVMSInt& serial, std::vector<POVMSInt>& skip)
+{
+    serial = 0;
+
+    IFileStream inbuffer(filename.c_str());
+    if(!inbuffer)
+        throw POV_EXCEPTION(kCannotOpenFileErr, "Cannot open render state file to import.");
+
+    (void)ReadBackup(inbuffer, vid, serial, skip);
+}
+
+POV_OFF_T RenderFrontendBase::ReadBackup(IStream& inbuffer, ViewId vid, POVMSInt& serial, std::vector<POVMSInt>& skip)
+{
+    Backup_File_Header hdr;
+    POV_OFF_T pos = sizeof(Backup_File_Header);
+
+    // IOBase::eof() only is based on feof() and will only return
+    // true if we have attempted to read past the end of the file.
+    // therefore msg.Read() will throw an exception when we try to
+    // read from the end of the file, which isn't harmful per se but
+    // makes debugging more difficult since it is caught by the VC++
+    // IDE, and we don't want to disable catching pov_base::Exception
+    // since they are generally useful. therefore we explicitly check
+    // for the end of the file.
+    inbuffer.seekg (0, IOBase::seek_end);
+    POV_OFF_T end = inbuffer.tellg();
+    inbuffer.seekg (0, IOBase::seek_set);
+
+    if (inbuffer.read (&hdr, sizeof (hdr)) == false)
+        throw POV_EXCEPTION(kFileDataErr, "Cannot read header from render state file.");
+    if (memcmp (hdr.sig, RENDER_STATE_SIG, sizeof (hdr.sig)) != 0)
+        throw POV_EXCEPTION(kFileDataErr, "Render state file header appears to be invalid.");
+    if (memcmp (hdr.ver, RENDER_STATE_VER, sizeof (hdr.ver)) != 0)
+        throw POV_EXCEPTION(kFileDataErr, "Render state file was written by another version of POV-Ray.");
+
+    while(pos < end && inbuffer.eof() == false)
+    {
+        POVMS_Message msg;
+
+        try
+        {
+            msg.Read(inbuffer);
+
+            // do not render complete blocks again
+            if(msg.Exist(kPOVAttrib_PixelId) == true)
+            {
+                POVMSInt pid = msg.GetInt(kPOVAttrib_PixelId);
+
+                if(pid > serial)
+                    skip.push_back(pid);
+                else
+                    serial++;
+            }
+
+            HandleImageMessage(vid, msg.GetIdentifier(), msg);
+        }
+        catch(pov_base::Exception&)
+        {
+            // ignore all problems, just assume file is broken from last message on
+            break;
+        }
+        pos = inbuffer.tellg();
+    }
+
+    return pos;
+}
+
 namespace Message2Console
 {
 
@@ -1340,6 +1357,18 @@ void ParserStatistics(POVMS_Object& cppmsg, TextStreamBuffer *tsb)
                     cppmsg.TryGetFloat(kPOVAttrib_BSPAverageAbortObjects, 0.0f));
     }
 
+    if(cppmsg.Exist(kPOVAttrib_BVHNodes) == true)
+    {
+        tsb->printf("----------------------------------------------------------------------------\n");
+        tsb->printf("BVH Leaves:       %10d\n", cppmsg.TryGetInt(kPOVAttrib_BVHLeafNodes, 0));
+        tsb->printf("BVH Nodes:        %10d\n", cppmsg.TryGetInt(kPOVAttrib_BVHNodes, 0));
+        tsb->printf("----------------------------------------------------------------------------\n");
+        tsb->printf("BVH Objects/Leaf Average:       %8.2f          Maximum:      %10d\n",
+                    cppmsg.TryGetFloat(kPOVAttrib_BVHAverageObjects, 0.0f), cppmsg.TryGetInt(kPOVAttrib_BVHMaxObjects, 0));
+        tsb->printf("BVH Tree Depth Average:         %8.2f          Maximum:      %10d\n",
+                    cppmsg.TryGetFloat(kPOVAttrib_BVHAverageDepth, 0.0f), cppmsg.TryGetInt(kPOVAttrib_BVHMaxDepth, 0));
+    }
+
     tsb->printf("----------------------------------------------------------------------------\n");
 }
 
@@ -161,6 +161,7 @@ struct ViewData final
     bool greyscaleDisplay;
 
     Path imageBackupFile;
+    bool keepImageBackup; ///< Whether to keep the state file of a completed render (e.g. of a block subset).
 };
 
 namespace Message2Console
@@ -269,6 +270,8 @@ class RenderFrontendBase : public POVMS_MessageReceiver
         void MakeBackupPath(POVMS_Object& ropts, ViewData& vd, const Path& outputpath);
         void NewBackup(POVMS_Object& ropts, ViewData& vd, const Path& outputpath);
         void ContinueBackup(POVMS_Object& ropts, ViewData& vd, ViewId vid, POVMSInt& serial, std::vector<POVMSInt>& skip, const Path& outputpath);
+        void ImportBackup(const UCS2String& filename, ViewId vid, POVMSInt& serial, std::vector<POVMSInt>& skip);
+        POV_OFF_T ReadBackup(IStream& inbuffer, ViewId vid, POVMSInt& serial, std::vector<POVMSInt>& skip);
 };
 
 // TODO - Do we really need this to be a template?
@@ -545,6 +548,8 @@ RenderFrontendBase::ViewId RenderFrontend<PARSER_MH, FILE_MH, RENDER_MH, IMAGE_M
 
             vh.data.greyscaleDisplay = obj.TryGetBool(kPOVAttrib_GrayscaleOutput, false);
 
+            vh.data.keepImageBackup = false;
+
             vh.data.state = ViewData::View_Invalid;
 
             vid = RenderFrontendBase::CreateView(shi->second.data, vh.data, sid, obj);
@@ -642,8 +647,24 @@ void RenderFrontend<PARSER_MH, FILE_MH, RENDER_MH, IMAGE_MH>::StartRender(ViewId
         UCS2String filename = obj.TryGetUCS2String(kPOVAttrib_OutputFile, "");
         std::string fn(UCS2toSysString(filename));
         bool to_stdout = fn == "-" || fn == "stdout" || fn == "stderr";
+        UCS2String importfile = obj.TryGetUCS2String(kPOVAttrib_ImportTraceLog, "");
+
+        // a render of a block subset leaves the image incomplete, so its state file is kept
+        vhi->second.data.keepImageBackup = (obj.TryGetInt(kPOVAttrib_RenderBlockSubsetCount, 1) > 1);
+
+        if(importfile.empty() == false)
+        {
+            // blocks rendered elsewhere (e.g. by the worker processes of a distributed render)
+            POVMSInt serial;
+            std::vector<POVMSInt> skip;
+
+            ImportBackup(importfile, vid, serial, skip);
 
-        if(obj.TryGetBool(kPOVAttrib_ContinueTrace, false) == true)
+            obj.SetInt(kPOVAttrib_PixelId, serial);
+            if(skip.empty() == false)
+                obj.SetIntVector(kPOVAttrib_PixelSkipList, skip);
+        }
+        else if(obj.TryGetBool(kPOVAttrib_ContinueTrace, false) == true)
         {
             if (to_stdout)
                 if(obj.TryGetBool(kPOVAttrib_BackupTrace, true))
@@ -816,7 +837,8 @@ void RenderFrontend<PARSER_MH, FILE_MH, RENDER_MH, IMAGE_MH>::HandleRenderMessag
             if (vhi->second.data.imageBackup != nullptr)
             {
                 vhi->second.data.imageBackup.reset();
-                pov_base::Filesystem::DeleteFile(vhi->second.data.imageBackupFile());
+                if (vhi->second.data.keepImageBackup == false)
+                    pov_base::Filesystem::DeleteFile(vhi->second.data.imageBackupFile());
             }
         }
         else if(ident == kPOVMsgIdent_Failed)
@@ -65,6 +65,33 @@
     #define POV_PARSER_MAX_CACHED_MACRO_SIZE 65536
 #endif
 
+/// @def POV_PARSER_TOKEN_CACHE_SIZE
+/// Maximum total number of raw tokens to be cached for replaying macro and loop bodies.
+///
+/// Define as zero to disable the token cache.
+///
+#ifndef POV_PARSER_TOKEN_CACHE_SIZE
+    #define POV_PARSER_TOKEN_CACHE_SIZE 262144
+#endif
+
+/// @def POV_PARSER_MAX_CACHED_TOKEN_RUN
+/// Maximum number of raw tokens to be cached from any single position in the input.
+///
+#ifndef POV_PARSER_MAX_CACHED_TOKEN_RUN
+    #define POV_PARSER_MAX_CACHED_TOKEN_RUN 16384
+#endif
+
+/// @def POV_PARSER_INCLUDE_CACHE_SIZE
+/// Maximum total number of raw tokens to be kept in memory from pre-tokenized include files.
+///
+/// The cache is shared by all parser instances of the process, and persists across animation
+/// frames. Include files with more tokens are always parsed directly. Define as zero to disable
+/// pre-tokenizing of include files.
+///
+#ifndef POV_PARSER_INCLUDE_CACHE_SIZE
+    #define POV_PARSER_INCLUDE_CACHE_SIZE 1048576
+#endif
+
 //******************************************************************************
 ///
 /// @name Debug Settings.
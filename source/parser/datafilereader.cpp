@@ -0,0 +1,500 @@
+//******************************************************************************
+///
+/// @file parser/datafilereader.cpp
+///
+/// Implementation of the bulk reader of numeric data files.
+///
+/// @copyright
+/// @parblock
+///
+/// Persistence of Vision Ray Tracer ('POV-Ray') version 3.8.
+/// Copyright 1991-2019 Persistence of Vision Raytracer Pty. Ltd.
+///
+/// POV-Ray is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Affero General Public License as
+/// published by the Free Software Foundation, either version 3 of the
+/// License, or (at your option) any later version.
+///
+/// POV-Ray is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU Affero General Public License for more details.
+///
+/// You should have received a copy of the GNU Affero General Public License
+/// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// ----------------------------------------------------------------------------
+///
+/// POV-Ray is based on the popular DKB raytracer version 2.12.
+/// DKBTrace was originally written by David K. Buck.
+/// DKBTrace Ver 2.0-2.12 were written by David K. Buck & Aaron A. Collins.
+///
+/// @endparblock
+///
+//******************************************************************************
+
+// Unit header file must be the first file included within POV-Ray *.cpp files (pulls in config)
+#include "parser/datafilereader.h"
+
+// C++ variants of C standard header files
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+// C++ standard header files
+#include <algorithm>
+#include <string>
+
+// POV-Ray header files (base module)
+#include "base/fileinputoutput.h"
+
+// POV-Ray header files (core module)
+//  (none at the moment)
+
+// POV-Ray header files (parser module)
+//  (none at the moment)
+
+// this must be the last file included
+#include "base/povdebug.h"
+
+namespace pov_parser
+{
+
+using std::uint32_t;
+using std::uint64_t;
+
+//******************************************************************************
+
+/// Size of the chunks in which the stream is read.
+static const size_t kChunkSize = 64 * 1024;
+
+/// Number of octets to have in the buffer before scanning a numeric literal.
+/// Longer literals are handled by growing the buffer as needed.
+static const size_t kLiteralLookahead = 64;
+
+/// Maximum number of significant decimal digits that fit in a 64-bit integer.
+static const int kMaxFastDigits = 19;
+
+/// Powers of ten that are exactly representable as double-precision values.
+static const double kExactPowersOfTen[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static const int kMaxExactPowerOfTen = 22;
+
+static inline bool IsDigit(char c)
+{
+    return ((c >= '0') && (c <= '9'));
+}
+
+/// Test for the same whitespace characters as the @ref Scanner.
+static inline bool IsWhitespace(char c)
+{
+    return ((c == 0x09) || (c == 0x0A) || (c == 0x0D) || (c == 0x1A) || (c == 0x20));
+}
+
+/// Load eight octets as a little-endian 64-bit integer.
+static inline uint64_t LoadEightOctets(const char* p)
+{
+    // Compilers recognize this as a single load on little-endian machines.
+    uint64_t block = 0;
+    for (int i = 0; i < 8; ++i)
+        block |= uint64_t(static_cast<unsigned char>(p[i])) << (i * 8);
+    return block;
+}
+
+/// Test whether all eight octets of a block are decimal digits.
+static inline bool IsEightDigits(uint64_t block)
+{
+    return (((block & 0xF0F0F0F0F0F0F0F0ull) |
+             (((block + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4)) == 0x3333333333333333ull);
+}
+
+/// Convert a block of eight decimal digits in parallel.
+static inline uint32_t ParseEightDigits(uint64_t block)
+{
+    block -= 0x3030303030303030ull;
+    block = (block * 10) + (block >> 8);
+    return uint32_t(((((block & 0x000000FF000000FFull) * (100 + (1000000ull << 32))) +
+                      (((block >> 16) & 0x000000FF000000FFull) * (1 + (10000ull << 32)))) >> 32));
+}
+
+/// Scan a sequence of decimal digits, accumulating the significant ones.
+static inline const char* ScanDigits(const char* p, const char* end, uint64_t& mantissa, int& significantDigits, bool& exact)
+{
+    // Leading zeros are not significant.
+    if (mantissa == 0)
+    {
+        while ((p < end) && (*p == '0'))
+            ++p;
+    }
+
+    // Consume as many digits as possible eight at a time.
+    while ((end - p >= 8) && (significantDigits + 8 <= kMaxFastDigits))
+    {
+        uint64_t block = LoadEightOctets(p);
+        if (!IsEightDigits(block))
+            break;
+        mantissa = mantissa * 100000000 + ParseEightDigits(block);
+        significantDigits += 8;
+        p += 8;
+    }
+
+    for (; (p < end) && IsDigit(*p); ++p)
+    {
+        unsigned int digit = *p - '0';
+        if (significantDigits == kMaxFastDigits)
+        {
+            exact = false;
+            continue;
+        }
+        mantissa = mantissa * 10 + digit;
+        ++significantDigits;
+    }
+    return p;
+}
+
+/// Scan a float literal, using the same syntax as the @ref Scanner.
+///
+/// @return     Pointer past the end of the literal, or `nullptr` if there is
+///             no float literal at the given position.
+///
+static const char* ScanFloatLiteral(const char* p, const char* end, DBL& value)
+{
+    const char* start = p;
+    uint64_t mantissa = 0;
+    int significantDigits = 0;
+    bool exact = true;
+    int exponent = 0;
+
+    p = ScanDigits(p, end, mantissa, significantDigits, exact);
+    bool haveDigits = (p != start);
+
+    if ((p < end) && (*p == '.'))
+    {
+        if (!haveDigits && !((p + 1 < end) && IsDigit(p[1])))
+            return nullptr;
+        const char* fraction = ++p;
+        p = ScanDigits(p, end, mantissa, significantDigits, exact);
+        if (p - fraction > kMaxExactPowerOfTen)
+            exact = exact && (mantissa == 0);
+        else
+            exponent -= int(p - fraction);
+    }
+    else if (!haveDigits)
+        return nullptr;
+
+    if ((p < end) && ((*p == 'e') || (*p == 'E')))
+    {
+        // Just like the scanner, we allow the sign and digits to be missing.
+        bool negative = false;
+        if ((++p < end) && ((*p == '+') || (*p == '-')))
+            negative = (*p++ == '-');
+        int exponentValue = 0;
+        for (; (p < end) && IsDigit(*p); ++p)
+        {
+            if (exponentValue <= kMaxExactPowerOfTen)
+                exponentValue = exponentValue * 10 + (*p - '0');
+        }
+        exponent += (negative ? -exponentValue : exponentValue);
+    }
+
+    if (exact && (mantissa == 0))
+        value = 0.0;
+    else if (exact && (mantissa <= (uint64_t(1) << 53)) &&
+             (exponent >= -kMaxExactPowerOfTen) && (exponent <= kMaxExactPowerOfTen))
+    {
+        // Both operands are exact, so the result is correctly rounded.
+        if (exponent < 0)
+            value = DBL(mantissa) / kExactPowersOfTen[-exponent];
+        else
+            value = DBL(mantissa) * kExactPowersOfTen[exponent];
+    }
+    else
+    {
+        // Leave the hard cases to the C library, just like the tokenizer does.
+        std::string text(start, p);
+        if (std::sscanf(text.c_str(), POV_DBL_FORMAT_STRING, &value) != 1)
+            value = 0.0;
+    }
+    return p;
+}
+
+//******************************************************************************
+
+DataFileReader::DataFileReader(const Scanner::HotBookmark& start) :
+    mpStream(start.pStream),
+    mPosition(start),
+    mSavedStreamPosition(start.pStream->tellg()),
+    mBuffer(kChunkSize),
+    mBufferPos(0),
+    mBufferEnd(0),
+    mStreamExhausted(false),
+    mUTF8(Scanner::GetCharacterEncodingID(start.characterEncoding) == CharacterEncodingID::kUTF8),
+    mTrailingComma(false),
+    mErrorMessage(nullptr)
+{
+    mpStream->clearstate();
+    if (!mpStream->seekg(start.offset))
+        mStreamExhausted = true;
+}
+
+DataFileReader::~DataFileReader()
+{
+    // The scanner may still hold the data around the new position in its
+    // buffer, in which case it will not seek the stream by itself.
+    mpStream->clearstate();
+    (void)mpStream->seekg(mSavedStreamPosition);
+}
+
+size_t DataFileReader::Fill(size_t count)
+{
+    size_t pending = mBufferEnd - mBufferPos;
+    if ((pending >= count) || mStreamExhausted)
+        return pending;
+
+    if (mBufferPos > 0)
+    {
+        std::memmove(mBuffer.data(), mBuffer.data() + mBufferPos, pending);
+        mBufferPos = 0;
+        mBufferEnd = pending;
+    }
+    if (mBuffer.size() < count)
+        mBuffer.resize(std::max(count, mBuffer.size() * 2));
+
+    while (mBufferEnd < count)
+    {
+        size_t got = mpStream->readUpTo(mBuffer.data() + mBufferEnd, mBuffer.size() - mBufferEnd);
+        if (got == 0)
+        {
+            mStreamExhausted = true;
+            break;
+        }
+        mBufferEnd += got;
+    }
+    return mBufferEnd - mBufferPos;
+}
+
+void DataFileReader::Advance()
+{
+    POV_PARSER_ASSERT(mBufferPos < mBufferEnd);
+    unsigned char octet = mBuffer[mBufferPos++];
+    ++mPosition.offset;
+
+    // Keep track of lines and columns in the same manner as the scanner.
+    if ((octet == 0x0A) || (octet == 0x0D))
+    {
+        if (mPosition.nominalEndOfLine == '\0')
+            mPosition.nominalEndOfLine = octet;
+        if (octet == mPosition.nominalEndOfLine)
+        {
+            ++mPosition.line;
+            mPosition.column = 1;
+        }
+    }
+    else if (!mUTF8 || ((octet & 0xC0) != 0x80))
+        ++mPosition.column;
+}
+
+void DataFileReader::AdvanceASCII(size_t count)
+{
+    POV_PARSER_ASSERT(mBufferPos + count <= mBufferEnd);
+    mBufferPos += count;
+    mPosition.offset += count;
+    mPosition.column += count;
+}
+
+bool DataFileReader::SkipSeparators()
+{
+    while ((mBufferPos < mBufferEnd) || (Fill(1) > 0))
+    {
+        char c = mBuffer[mBufferPos];
+        if (IsWhitespace(c))
+        {
+            Advance();
+            continue;
+        }
+        if ((c != '/') || (Fill(2) < 2))
+            return true;
+
+        c = mBuffer[mBufferPos + 1];
+        if (c == '/')
+        {
+            // Line comment; the end-of-line character is handled as whitespace.
+            AdvanceASCII(2);
+            while (((mBufferPos < mBufferEnd) || (Fill(1) > 0)) &&
+                   (mBuffer[mBufferPos] != 0x0A) && (mBuffer[mBufferPos] != 0x0D))
+                Advance();
+        }
+        else if (c == '*')
+        {
+            LexemePosition commentPosition = mPosition;
+            AdvanceASCII(2);
+            unsigned int nestingLevel = 1;
+            while (nestingLevel > 0)
+            {
+                if (Fill(2) < 2)
+                    throw IncompleteCommentException(mpStream->Name(), commentPosition);
+                if ((mBuffer[mBufferPos] == '*') && (mBuffer[mBufferPos + 1] == '/'))
+                {
+                    AdvanceASCII(2);
+                    --nestingLevel;
+                }
+                else if (mPosition.allowNestedBlockComments &&
+                         (mBuffer[mBufferPos] == '/') && (mBuffer[mBufferPos + 1] == '*'))
+                {
+                    AdvanceASCII(2);
+                    ++nestingLevel;
+                }
+                else
+                    Advance();
+            }
+        }
+        else
+            return true;
+    }
+    return false;
+}
+
+bool DataFileReader::ReadFloat(DBL& value)
+{
+    DBL sign = 1.0;
+    char c = mBuffer[mBufferPos];
+    if ((c == '-') || (c == '+'))
+    {
+        if (c == '-')
+            sign = -1.0;
+        AdvanceASCII(1);
+        // Like the tokenizer, we allow whitespace and comments between sign and literal.
+        if (!SkipSeparators())
+            return false;
+    }
+
+    size_t available = Fill(kLiteralLookahead);
+    while (true)
+    {
+        const char* begin = mBuffer.data() + mBufferPos;
+        const char* end = begin + available;
+        const char* literalEnd = ScanFloatLiteral(begin, end, value);
+        if (literalEnd == nullptr)
+            return false;
+        if ((literalEnd == end) && !mStreamExhausted)
+        {
+            // The literal may continue beyond the data buffered so far.
+            available = Fill(available * 2);
+            continue;
+        }
+        AdvanceASCII(literalEnd - begin);
+        value *= sign;
+        return true;
+    }
+}
+
+int DataFileReader::SetError(const char* message)
+{
+    mErrorMessage = message;
+    mErrorPosition = mPosition;
+    return -1;
+}
+
+int DataFileReader::ReadTextValue(DBL* values)
+{
+    int components;
+
+    if (!SkipSeparators())
+        return 0;
+
+    if (mBuffer[mBufferPos] == '<')
+    {
+        AdvanceASCII(1);
+        components = 0;
+        while (true)
+        {
+            if (!SkipSeparators())
+                return SetError("Incomplete vector.");
+            if (mBuffer[mBufferPos] == '>')
+            {
+                AdvanceASCII(1);
+                break;
+            }
+            if (components == 5)
+                return SetError("Too many components in vector.");
+            if (!ReadFloat(values[components]))
+                return SetError("Expected vector component or '>'.");
+            ++components;
+            if (!SkipSeparators())
+                return SetError("Incomplete vector.");
+            if (mBuffer[mBufferPos] == ',')
+                AdvanceASCII(1);
+        }
+        if (components < 2)
+            return SetError("Not enough components in vector.");
+    }
+    else
+    {
+        if (!ReadFloat(values[0]))
+            return SetError("Expected float or vector literal.");
+        components = 1;
+    }
+
+    mTrailingComma = (SkipSeparators() && (mBuffer[mBufferPos] == ','));
+    if (mTrailingComma)
+        AdvanceASCII(1);
+
+    return components;
+}
+
+int DataFileReader::ReadBinaryValue(DBL& value, const BinaryFormat& format)
+{
+    POV_PARSER_ASSERT((format.size >= 1) && (format.size <= 8));
+
+    size_t available = Fill(format.size);
+    if (available == 0)
+        return 0;
+    if (available < format.size)
+        return SetError("Incomplete binary value at end of file.");
+
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(mBuffer.data() + mBufferPos);
+    uint64_t bits = 0;
+    for (unsigned int i = 0; i < format.size; ++i)
+    {
+        unsigned int shift = (format.bigEndian ? (format.size - 1) - i : i) * 8;
+        bits |= uint64_t(p[i]) << shift;
+    }
+
+    if (format.isFloat && (format.size == 4))
+    {
+        uint32_t bits32 = uint32_t(bits);
+        float f;
+        std::memcpy(&f, &bits32, 4);
+        value = f;
+    }
+    else if (format.isFloat)
+    {
+        POV_PARSER_ASSERT(format.size == 8);
+        double d;
+        std::memcpy(&d, &bits, 8);
+        value = d;
+    }
+    else if (format.isSigned && (bits >> (format.size * 8 - 1)) != 0)
+        value = -DBL((~bits & (uint64_t(-1) >> (64 - format.size * 8))) + 1);
+    else
+        value = DBL(bits);
+
+    // Binary data carries no notion of lines, so we just count octets.
+    AdvanceASCII(format.size);
+    return 1;
+}
+
+bool DataFileReader::AtEnd(bool binary)
+{
+    if (binary)
+        return (Fill(1) == 0);
+    // Just like a regular `#read`, we only report the end of the stream early
+    // if there is no comma after the most recent value.
+    return (!mTrailingComma && !SkipSeparators());
+}
+
+}
+// end of namespace pov_parser
@@ -0,0 +1,157 @@
+//******************************************************************************
+///
+/// @file parser/datafilereader.h
+///
+/// Declarations for the bulk reader of numeric data files.
+///
+/// @copyright
+/// @parblock
+///
+/// Persistence of Vision Ray Tracer ('POV-Ray') version 3.8.
+/// Copyright 1991-2019 Persistence of Vision Raytracer Pty. Ltd.
+///
+/// POV-Ray is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Affero General Public License as
+/// published by the Free Software Foundation, either version 3 of the
+/// License, or (at your option) any later version.
+///
+/// POV-Ray is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU Affero General Public License for more details.
+///
+/// You should have received a copy of the GNU Affero General Public License
+/// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// ----------------------------------------------------------------------------
+///
+/// POV-Ray is based on the popular DKB raytracer version 2.12.
+/// DKBTrace was originally written by David K. Buck.
+/// DKBTrace Ver 2.0-2.12 were written by David K. Buck & Aaron A. Collins.
+///
+/// @endparblock
+///
+//******************************************************************************
+
+#ifndef POVRAY_PARSER_DATAFILEREADER_H
+#define POVRAY_PARSER_DATAFILEREADER_H
+
+// Module config header file must be the first file included within POV-Ray unit header files
+#include "parser/configparser.h"
+
+// C++ variants of C standard header files
+//  (none at the moment)
+
+// C++ standard header files
+#include <vector>
+
+// POV-Ray header files (base module)
+//  (none at the moment)
+
+// POV-Ray header files (core module)
+//  (none at the moment)
+
+// POV-Ray header files (parser module)
+#include "parser/parsertypes.h"
+#include "parser/scanner.h"
+
+namespace pov_parser
+{
+
+//******************************************************************************
+
+/// Class implementing a fast reader for bulk numeric data.
+///
+/// This class is used by `#read` to fill an entire array from a data file in one
+/// go. Instead of passing each value through the @ref RawTokenizer, it scans
+/// the stream's octets directly, accepting only what the tokenizer would
+/// accept as float or vector literals (along with whitespace, comments and
+/// single commas between values), or raw binary values.
+///
+/// Decimal literals of up to 19 significant digits and a moderate exponent are
+/// converted directly, using an exact power of ten; all others are passed to
+/// the C library, so that the results are identical to those of a regular
+/// `#read` either way.
+///
+/// @note
+///     The reader shares the stream with the tokenizer it was started from,
+///     and restores the stream position upon destruction; to resume
+///     tokenizing after the data read, go to the bookmark returned by
+///     @ref GetHotBookmark().
+///
+class DataFileReader final
+{
+public:
+
+    /// Binary encoding of raw numeric values.
+    struct BinaryFormat final
+    {
+        unsigned int    size;       ///< Size of each value in octets.
+        bool            bigEndian;  ///< Whether the most significant octet comes first.
+        bool            isSigned;   ///< Whether integer values are two's complement signed.
+        bool            isFloat;    ///< Whether values are IEEE 754 binary floating-point.
+    };
+
+    /// Start reading at a given position.
+    DataFileReader(const Scanner::HotBookmark& start);
+
+    ~DataFileReader();
+
+    /// Read a float or vector literal, along with a comma following it.
+    ///
+    /// @param[out] values  Components of the value read.
+    /// @return             Number of components read (1 for a float, 2 to 5
+    ///                     for a vector), 0 if the end of the stream was
+    ///                     reached, or -1 in case of a syntax error.
+    ///
+    int ReadTextValue(DBL* values);
+
+    /// Read a raw binary value.
+    ///
+    /// @param[out] value   Value read.
+    /// @param[in]  format  Binary encoding of the value.
+    /// @return             1 if a value was read, 0 if the end of the stream
+    ///                     was reached, or -1 if the stream ended in the middle
+    ///                     of a value.
+    ///
+    int ReadBinaryValue(DBL& value, const BinaryFormat& format);
+
+    /// Test whether the end of the stream has been reached after the most recent value.
+    /// In text mode, trailing whitespace and comments are skipped first.
+    bool AtEnd(bool binary);
+
+    /// Get the current position, suitable to resume tokenizing.
+    const Scanner::HotBookmark& GetHotBookmark() const { return mPosition; }
+
+    /// Get a description of the most recent error.
+    const char* GetErrorMessage() const { return mErrorMessage; }
+
+    /// Get the location of the most recent error.
+    const LexemePosition& GetErrorPosition() const { return mErrorPosition; }
+
+private:
+
+    StreamPtr               mpStream;
+    Scanner::HotBookmark    mPosition;
+    POV_OFF_T               mSavedStreamPosition;
+    std::vector<char>       mBuffer;
+    size_t                  mBufferPos;
+    size_t                  mBufferEnd;
+    bool                    mStreamExhausted;
+    bool                    mUTF8;
+    bool                    mTrailingComma;
+    const char*             mErrorMessage;
+    LexemePosition          mErrorPosition;
+
+    size_t Fill(size_t count);
+    void Advance();
+    void AdvanceASCII(size_t count);
+    bool SkipSeparators();
+    bool ReadFloat(DBL& value);
+    int SetError(const char* message);
+};
+
+}
+// end of namespace pov_parser
+
+#endif // POVRAY_PARSER_DATAFILEREADER_H
@@ -0,0 +1,152 @@
+//******************************************************************************
+///
+/// @file parser/diskcache.cpp
+///
+/// Implementation of helpers shared by the parser's on-disk caches.
+///
+/// @copyright
+/// @parblock
+///
+/// Persistence of Vision Ray Tracer ('POV-Ray') version 3.8.
+/// Copyright 1991-2019 Persistence of Vision Raytracer Pty. Ltd.
+///
+/// POV-Ray is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Affero General Public License as
+/// published by the Free Software Foundation, either version 3 of the
+/// License, or (at your option) any later version.
+///
+/// POV-Ray is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU Affero General Public License for more details.
+///
+/// You should have received a copy of the GNU Affero General Public License
+/// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// ----------------------------------------------------------------------------
+///
+/// POV-Ray is based on the popular DKB raytracer version 2.12.
+/// DKBTrace was originally written by David K. Buck.
+/// DKBTrace Ver 2.0-2.12 were written by David K. Buck & Aaron A. Collins.
+///
+/// @endparblock
+///
+//******************************************************************************
+
+// Unit header file must be the first file included within POV-Ray *.cpp files (pulls in config)
+#include "parser/diskcache.h"
+
+// C++ variants of C standard header files
+//  (none at the moment)
+
+// C++ standard header files
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+// POV-Ray header files (base module)
+#include "base/fileinputoutput.h"
+#include "base/filesystem.h"
+#include "base/fileutil.h"
+#include "base/path.h"
+#include "base/platformbase.h"
+#include "base/pov_err.h"
+#include "base/stringutilities.h"
+
+// POV-Ray header files (core module)
+//  (none at the moment)
+
+// POV-Ray header files (parser module)
+//  (none at the moment)
+
+// this must be the last file included
+#include "base/povdebug.h"
+
+namespace pov_parser
+{
+
+using std::uint8_t;
+using std::uint64_t;
+
+//******************************************************************************
+
+/// Format a number as 16 hexadecimal digits.
+static std::string ToHex(uint64_t value)
+{
+    static const char kHexDigits[] = "0123456789abcdef";
+    std::string result;
+    for (int shift = 60; shift >= 0; shift -= 4)
+        result += kHexDigits[(value >> shift) & 0x0F];
+    return result;
+}
+
+//******************************************************************************
+
+uint64_t DiskCache::ComputeHash(const void* data, std::size_t size, uint64_t hash)
+{
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(data);
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        hash ^= p[i];
+        hash *= 0x00000100000001B3ull;
+    }
+    return hash;
+}
+
+UCS2String DiskCache::GetFileName(const UCS2String& diskCachePath, const UCS2String& sourceName,
+                                  unsigned int stype, uint64_t seed)
+{
+    uint64_t nameHash = ComputeHash(sourceName.data(), sourceName.size() * sizeof(UCS2), seed);
+
+    Path path(diskCachePath);
+    if (!path.GetFile().empty())
+    {
+        // The path designates a directory, whether it has a trailing separator or not.
+        path.AppendFolder(path.GetFile());
+    }
+    path.SetFile(ASCIItoUCS2String(ToHex(nameHash) + gPOV_File_Extensions[stype].ext[0]));
+    return path();
+}
+
+bool DiskCache::Write(const UCS2String& fileName, unsigned int stype, const std::function<bool(OStream&)>& write)
+{
+    if (!PlatformBase::GetInstance().AllowLocalFileAccess(fileName, stype, true))
+        return false;
+
+    // Concurrent renders sharing the cache directory may be writing the same
+    // cache file, so the temporary name must be unique across processes.
+    static std::atomic<uint64_t> counter(0);
+    uint64_t now = uint64_t(std::chrono::steady_clock::now().time_since_epoch().count());
+    uint64_t unique = ComputeHash(&now, sizeof(now), uint64_t(std::hash<std::thread::id>()(std::this_thread::get_id())) + counter++);
+    const void* stackAddress = &now; // differs between processes where address space layout is randomized
+    unique = ComputeHash(&stackAddress, sizeof(stackAddress), unique);
+    UCS2String tempName = fileName + ASCIItoUCS2String("." + ToHex(unique) + ".tmp");
+
+    bool created = false;
+    bool ok = false;
+    try
+    {
+        std::unique_ptr<OStream> pFile(NewOStream(tempName, stype, false));
+        if ((pFile != nullptr) && *pFile)
+        {
+            created = true;
+            ok = write(*pFile);
+        }
+    }
+    catch (pov_base::Exception&)
+    {
+        // Not allowed to write there, or out of disk space; the cache is optional anyway.
+        ok = false;
+    }
+
+    if (ok)
+        ok = Filesystem::RenameFile(tempName, fileName);
+    if (!ok && created)
+        Filesystem::DeleteFile(tempName);
+    return ok;
+}
+
+}
+// end of namespace pov_parser
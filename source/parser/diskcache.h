@@ -0,0 +1,126 @@
+//******************************************************************************
+///
+/// @file parser/diskcache.h
+///
+/// Declarations of helpers shared by the parser's on-disk caches.
+///
+/// @copyright
+/// @parblock
+///
+/// Persistence of Vision Ray Tracer ('POV-Ray') version 3.8.
+/// Copyright 1991-2019 Persistence of Vision Raytracer Pty. Ltd.
+///
+/// POV-Ray is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Affero General Public License as
+/// published by the Free Software Foundation, either version 3 of the
+/// License, or (at your option) any later version.
+///
+/// POV-Ray is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU Affero General Public License for more details.
+///
+/// You should have received a copy of the GNU Affero General Public License
+/// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// ----------------------------------------------------------------------------
+///
+/// POV-Ray is based on the popular DKB raytracer version 2.12.
+/// DKBTrace was originally written by David K. Buck.
+/// DKBTrace Ver 2.0-2.12 were written by David K. Buck & Aaron A. Collins.
+///
+/// @endparblock
+///
+//******************************************************************************
+
+#ifndef POVRAY_PARSER_DISKCACHE_H
+#define POVRAY_PARSER_DISKCACHE_H
+
+// Module config header file must be the first file included within POV-Ray unit header files
+#include "parser/configparser.h"
+
+// C++ variants of C standard header files
+#include <cstddef>
+#include <cstdint>
+
+// C++ standard header files
+#include <functional>
+
+// POV-Ray header files (base module)
+#include "base/fileinputoutput_fwd.h"
+#include "base/stringtypes.h"
+
+// POV-Ray header files (core module)
+//  (none at the moment)
+
+// POV-Ray header files (parser module)
+//  (none at the moment)
+
+namespace pov_parser
+{
+
+using namespace pov_base;
+
+//******************************************************************************
+
+/// Helpers shared by the caches that keep derived data of input files on disk.
+///
+/// Each such cache keeps its files in a user-specified directory, with names
+/// derived from a hash of the input file name. Since a cache directory may be
+/// shared by concurrent renders, cache files are always written under a
+/// temporary name first, and only then put in place of any existing file.
+///
+class DiskCache final
+{
+public:
+
+    /// Initial value for @ref ComputeHash().
+    static const std::uint64_t kHashSeed = 0xCBF29CE484222325ull;
+
+    /// Compute the 64-bit FNV-1a hash of a block of data.
+    ///
+    /// @param[in]  data    Data to hash.
+    /// @param[in]  size    Size of the data in bytes.
+    /// @param[in]  hash    Hash of any preceding data.
+    ///
+    static std::uint64_t ComputeHash(const void* data, std::size_t size, std::uint64_t hash = kHashSeed);
+
+    /// Get the name of the cache file for an input file.
+    ///
+    /// @param[in]  diskCachePath   Directory to keep the cache files in, with
+    ///                             or without a trailing separator.
+    /// @param[in]  sourceName      Name of the input file.
+    /// @param[in]  stype           File type of the cache file, determining
+    ///                             its extension.
+    /// @param[in]  seed            Value to distinguish different cache files
+    ///                             for the same input file.
+    ///
+    static UCS2String GetFileName(const UCS2String& diskCachePath, const UCS2String& sourceName,
+                                  unsigned int stype, std::uint64_t seed = kHashSeed);
+
+    /// Create or replace a cache file.
+    ///
+    /// The file is only touched if the I/O restrictions permit writing to it.
+    /// The content is written to a temporary file in the same directory,
+    /// which then atomically replaces any existing file, so that readers never
+    /// see a partially written file, and processes still using the old file
+    /// keep their copy.
+    ///
+    /// @param[in]  fileName    Name of the cache file.
+    /// @param[in]  stype       File type of the cache file.
+    /// @param[in]  write       Function to write the content, returning
+    ///                         `false` or throwing a @ref pov_base::Exception
+    ///                         on failure.
+    /// @return                 `true` if the cache file was written.
+    ///
+    static bool Write(const UCS2String& fileName, unsigned int stype, const std::function<bool(OStream&)>& write);
+
+private:
+
+    DiskCache() = delete;
+};
+
+}
+// end of namespace pov_parser
+
+#endif // POVRAY_PARSER_DISKCACHE_H
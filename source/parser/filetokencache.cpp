@@ -0,0 +1,487 @@
+//******************************************************************************
+///
+/// @file parser/filetokencache.cpp
+///
+/// Implementation of the cache of pre-tokenized include files.
+///
+/// @copyright
+/// @parblock
+///
+/// Persistence of Vision Ray Tracer ('POV-Ray') version 3.8.
+/// Copyright 1991-2019 Persistence of Vision Raytracer Pty. Ltd.
+///
+/// POV-Ray is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Affero General Public License as
+/// published by the Free Software Foundation, either version 3 of the
+/// License, or (at your option) any later version.
+///
+/// POV-Ray is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU Affero General Public License for more details.
+///
+/// You should have received a copy of the GNU Affero General Public License
+/// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// ----------------------------------------------------------------------------
+///
+/// POV-Ray is based on the popular DKB raytracer version 2.12.
+/// DKBTrace was originally written by David K. Buck.
+/// DKBTrace Ver 2.0-2.12 were written by David K. Buck & Aaron A. Collins.
+///
+/// @endparblock
+///
+//******************************************************************************
+
+// Unit header file must be the first file included within POV-Ray *.cpp files (pulls in config)
+#include "parser/filetokencache.h"
+
+// C++ variants of C standard header files
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+
+// C++ standard header files
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// POV-Ray header files (base module)
+#include "base/fileinputoutput.h"
+#include "base/filesystem.h"
+#include "base/path.h"
+#include "base/pov_err.h"
+
+// POV-Ray header files (core module)
+//  (none at the moment)
+
+// POV-Ray header files (parser module)
+#include "parser/diskcache.h"
+#include "parser/reservedwords.h"
+#include "parser/scanner.h"
+
+// this must be the last file included
+#include "base/povdebug.h"
+
+namespace pov_parser
+{
+
+using std::uint8_t;
+using std::uint32_t;
+using std::uint64_t;
+
+//******************************************************************************
+
+/// Identifies a token cache file.
+static const uint32_t kDiskCacheMagic = 0x4B4F5450; // "PTOK" in little-endian byte order
+
+/// Version of the token cache file format; bump whenever the format or the scanner's behaviour changes.
+static const uint32_t kDiskCacheVersion = 1;
+
+/// Distinguishes token cache files written on machines with a different byte order.
+static const uint32_t kDiskCacheByteOrderMark = 0x01020304;
+
+/// Modification time to record if it cannot be determined.
+static const std::int_least64_t kUnknownTime = std::numeric_limits<std::int_least64_t>::max();
+
+struct FileTokenCacheEntry final
+{
+    POV_OFF_T           size;
+    std::int_least64_t  modified;   ///< Modification time of the file as of when we last checked the hash.
+    std::int_least64_t  checked;    ///< Time at which we last checked the hash.
+    uint64_t            hash;
+    RawTokenSequencePtr pTokens;
+    uint64_t            lastUse;
+    bool                tokenized;  ///< Whether we have tried to tokenize the file.
+};
+
+static std::mutex gCacheMutex;
+static std::unordered_map<UCS2String, FileTokenCacheEntry> gCacheEntries;
+static size_t gCachedTokenCount = 0;
+static uint64_t gCacheUseCount = 0;
+
+//------------------------------------------------------------------------------
+
+/// Helper class to serialize token sequences.
+///
+/// Most numbers are stored as variable-length unsigned integers, and positions
+/// relative to the preceding position, to keep the files reasonably small.
+///
+class DiskCacheWriter final
+{
+public:
+    template<typename T> void Put(T value) { Put(&value, sizeof(T)); }
+    void Put(const void* data, size_t size) { const char* p = reinterpret_cast<const char*>(data); mData.insert(mData.end(), p, p + size); }
+    void PutNumber(uint64_t value)
+    {
+        for (; value >= 0x80; value >>= 7)
+            mData.push_back(char(0x80 | (value & 0x7F)));
+        mData.push_back(char(value));
+    }
+    bool PutPosition(const LexemePosition& position, const LexemePosition& reference)
+    {
+        if ((position.line < reference.line) || (position.column < 0) || (position.offset < reference.offset))
+            return false;
+        PutNumber(uint64_t(position.line - reference.line));
+        PutNumber(uint64_t(position.column));
+        PutNumber(uint64_t(position.offset - reference.offset));
+        return true;
+    }
+    void PutState(Scanner::CharacterEncodingPtr characterEncoding, Scanner::Character nominalEndOfLine)
+    {
+        Put<uint8_t>(uint8_t(Scanner::GetCharacterEncodingID(characterEncoding)));
+        PutNumber(nominalEndOfLine);
+    }
+    const std::vector<char>& GetData() const { return mData; }
+private:
+    std::vector<char> mData;
+};
+
+/// Helper class to de-serialize token sequences.
+class DiskCacheReader final
+{
+public:
+    DiskCacheReader(const std::vector<char>& data) : mData(data), mPos(0), mFail(false) {}
+    template<typename T> T Get() { T value = T(); Get(&value, sizeof(T)); return value; }
+    void Get(void* data, size_t size)
+    {
+        if (mFail || (size > mData.size() - mPos))
+        {
+            mFail = true;
+            return;
+        }
+        std::memcpy(data, mData.data() + mPos, size);
+        mPos += size;
+    }
+    uint64_t GetNumber()
+    {
+        uint64_t value = 0;
+        for (int shift = 0; (shift < 64) && (mPos < mData.size()); shift += 7)
+        {
+            uint8_t byte = uint8_t(mData[mPos++]);
+            value |= uint64_t(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+                return value;
+        }
+        mFail = true;
+        return 0;
+    }
+    void GetPosition(LexemePosition& position, const LexemePosition& reference)
+    {
+        position.line   = reference.line + POV_LONG(GetNumber());
+        position.column = POV_LONG(GetNumber());
+        position.offset = reference.offset + POV_OFF_T(GetNumber());
+    }
+    void GetState(Scanner::CharacterEncodingPtr& characterEncoding, Scanner::Character& nominalEndOfLine)
+    {
+        uint8_t encoding = Get<uint8_t>();
+        if (encoding > uint8_t(CharacterEncodingID::kUTF8))
+            mFail = true;
+        else
+            characterEncoding = Scanner::GetCharacterEncoding(CharacterEncodingID(encoding));
+        nominalEndOfLine = Scanner::Character(GetNumber());
+    }
+    size_t GetRemaining() const { return (mFail ? 0 : mData.size() - mPos); }
+    bool Failed() const { return mFail; }
+private:
+    const std::vector<char>& mData;
+    size_t mPos;
+    bool mFail;
+};
+
+/// Flag in the category byte of a token, indicating that the scanner state after the token is stored explicitly.
+static const uint8_t kStateChangeFlag = 0x80;
+
+//------------------------------------------------------------------------------
+
+static void SaveTokens(const UCS2String& fileName, const UCS2String& streamName, POV_OFF_T size, uint64_t hash,
+                       const RawTokenSequence& tokens)
+{
+    DiskCacheWriter writer;
+
+    writer.Put<uint32_t>(kDiskCacheMagic);
+    writer.Put<uint32_t>(kDiskCacheVersion);
+    writer.Put<uint32_t>(kDiskCacheByteOrderMark);
+    writer.Put<uint64_t>(size);
+    writer.Put<uint64_t>(hash);
+    writer.PutNumber(streamName.size());
+    writer.Put(streamName.data(), streamName.size() * sizeof(UCS2));
+
+    LexemePosition origin;
+    origin.line = 0;
+    origin.column = 0;
+    origin.offset = 0;
+    if (!writer.PutPosition(tokens.position, origin))
+        return;
+    writer.PutState(tokens.characterEncoding, tokens.nominalEndOfLine);
+    writer.Put<uint8_t>(tokens.allowNestedBlockComments ? 1 : 0);
+
+    writer.PutNumber(tokens.tokens.size());
+    const LexemePosition* pPrevious = &tokens.position;
+    Scanner::CharacterEncodingPtr characterEncoding = tokens.characterEncoding;
+    Scanner::Character nominalEndOfLine = tokens.nominalEndOfLine;
+    for (size_t i = 0; i < tokens.tokens.size(); ++i)
+    {
+        const RawToken& token = tokens.tokens[i];
+        const RawTokenSequence::TokenEnd& end = tokens.ends[i];
+        bool stateChange = ((end.characterEncoding != characterEncoding) || (end.nominalEndOfLine != nominalEndOfLine));
+        writer.Put<uint8_t>(token.lexeme.category | (stateChange ? kStateChangeFlag : 0));
+        writer.PutNumber(token.lexeme.text.size());
+        writer.Put(token.lexeme.text.data(), token.lexeme.text.size());
+        if (token.lexeme.category == Lexeme::kFloatLiteral)
+            writer.Put<DBL>(token.floatValue); // spare us the conversion when loading
+        if (!writer.PutPosition(token.lexeme.position, *pPrevious) ||
+            !writer.PutPosition(end.position, token.lexeme.position))
+            return;
+        if (stateChange)
+        {
+            writer.PutState(end.characterEncoding, end.nominalEndOfLine);
+            characterEncoding = end.characterEncoding;
+            nominalEndOfLine = end.nominalEndOfLine;
+        }
+        pPrevious = &end.position;
+    }
+
+    writer.Put<uint32_t>(kDiskCacheMagic);
+
+    DiskCache::Write(fileName, POV_File_Data_Tokens,
+                     [&](OStream& file) { return file.write(writer.GetData().data(), writer.GetData().size()); });
+}
+
+static std::shared_ptr<RawTokenSequence> LoadTokens(const UCS2String& fileName, const UCS2String& streamName,
+                                                    POV_OFF_T size, uint64_t hash)
+{
+    std::vector<char> data;
+
+    try
+    {
+        std::unique_ptr<IStream> pFile(NewIStream(fileName, POV_File_Data_Tokens));
+        if ((pFile == nullptr) || !*pFile || !pFile->seekg(0, IOBase::seek_end))
+            return nullptr;
+        POV_OFF_T fileSize = pFile->tellg();
+        if ((fileSize <= 0) || !pFile->seekg(0))
+            return nullptr;
+        data.resize(size_t(fileSize));
+        if (!pFile->read(data.data(), data.size()))
+            return nullptr;
+    }
+    catch (pov_base::Exception&)
+    {
+        // Not allowed to read there; the cache is optional anyway.
+        return nullptr;
+    }
+
+    DiskCacheReader reader(data);
+
+    if ((reader.Get<uint32_t>() != kDiskCacheMagic) ||
+        (reader.Get<uint32_t>() != kDiskCacheVersion) ||
+        (reader.Get<uint32_t>() != kDiskCacheByteOrderMark) ||
+        (reader.Get<uint64_t>() != uint64_t(size)) ||
+        (reader.Get<uint64_t>() != hash))
+        return nullptr;
+
+    UCS2String name(size_t(std::min<uint64_t>(reader.GetNumber(), reader.GetRemaining())), 0);
+    reader.Get(&name[0], name.size() * sizeof(UCS2));
+    if (reader.Failed() || (name != streamName))
+        return nullptr; // hash collision of file names
+
+    auto pTokens = std::make_shared<RawTokenSequence>();
+    LexemePosition origin;
+    origin.line = 0;
+    origin.column = 0;
+    origin.offset = 0;
+    LexemePosition position;
+    Scanner::CharacterEncodingPtr characterEncoding = nullptr;
+    Scanner::Character nominalEndOfLine = '\0';
+    reader.GetPosition(position, origin);
+    reader.GetState(characterEncoding, nominalEndOfLine);
+    bool allowNestedBlockComments = (reader.Get<uint8_t>() != 0);
+    uint64_t tokenCount = reader.GetNumber();
+    if (reader.Failed() || (tokenCount > reader.GetRemaining()) || (tokenCount > POV_PARSER_INCLUDE_CACHE_SIZE))
+        return nullptr;
+    pTokens->Reset(Scanner::HotBookmark(nullptr, position, characterEncoding, nominalEndOfLine, allowNestedBlockComments));
+    pTokens->tokens.reserve(size_t(tokenCount));
+    pTokens->ends.reserve(size_t(tokenCount));
+
+    // Re-process most lexemes rather than storing the raw tokens verbatim, so
+    // that identifier IDs and string values are set up exactly as if freshly
+    // scanned.
+    RawTokenizer tokenizer;
+    tokenizer.SetInputStream(std::make_shared<IMemStream>(nullptr, 0, streamName));
+    try
+    {
+        for (uint64_t i = 0; i < tokenCount; ++i)
+        {
+            pTokens->tokens.emplace_back();
+            RawToken& token = pTokens->tokens.back();
+            uint8_t category = reader.Get<uint8_t>();
+            bool stateChange = ((category & kStateChangeFlag) != 0);
+            category &= ~kStateChangeFlag;
+            if (category > Lexeme::kUTF8SignatureBOM)
+                return nullptr;
+            token.lexeme.category = Lexeme::Category(category);
+            token.lexeme.text.resize(size_t(std::min<uint64_t>(reader.GetNumber(), reader.GetRemaining())));
+            if (!token.lexeme.text.empty())
+                reader.Get(&token.lexeme.text[0], token.lexeme.text.size());
+            if (token.lexeme.category == Lexeme::kFloatLiteral)
+            {
+                token.id = int(FLOAT_TOKEN);
+                token.expressionId = FLOAT_TOKEN_CATEGORY;
+                token.floatValue = reader.Get<DBL>();
+                token.value = nullptr;
+                token.isReservedWord = false;
+                token.isPseudoIdentifier = false;
+            }
+            else if (!tokenizer.ProcessLexeme(token))
+                return nullptr;
+            reader.GetPosition(token.lexeme.position, position);
+            reader.GetPosition(position, token.lexeme.position);
+            if (stateChange)
+                reader.GetState(characterEncoding, nominalEndOfLine);
+            if (reader.Failed())
+                return nullptr;
+            pTokens->ends.push_back(RawTokenSequence::TokenEnd{ position, characterEncoding, nominalEndOfLine });
+        }
+    }
+    catch (TokenizerException&)
+    {
+        return nullptr;
+    }
+
+    if ((reader.Get<uint32_t>() != kDiskCacheMagic) || (reader.GetRemaining() != 0))
+        return nullptr;
+
+    return pTokens;
+}
+
+//******************************************************************************
+
+RawTokenSequencePtr FileTokenCache::Get(StreamPtr pStream, const UCS2String& diskCachePath, POV_OFF_T maxFileSize)
+{
+    if ((POV_PARSER_INCLUDE_CACHE_SIZE == 0) || (pStream == nullptr))
+        return nullptr;
+
+    UCS2String streamName(pStream->Name());
+
+    // If size and modification time of the file are unchanged since we last
+    // checked its content, don't bother reading it at all. This is only safe
+    // if the file was not modified during the same second as (or after) we
+    // last checked, as the timestamp might not reflect a later modification.
+
+    std::int_least64_t now = std::int_least64_t(std::time(nullptr));
+    std::int_least64_t fileSize;
+    std::int_least64_t modified;
+    if (!Filesystem::GetFileInfo(streamName, fileSize, modified))
+        modified = kUnknownTime;
+    else
+    {
+        std::lock_guard<std::mutex> lock(gCacheMutex);
+        auto i = gCacheEntries.find(streamName);
+        if ((i != gCacheEntries.end()) && i->second.tokenized &&
+            (i->second.size == fileSize) && (i->second.modified == modified) && (modified < i->second.checked))
+        {
+            i->second.lastUse = ++gCacheUseCount;
+            return i->second.pTokens;
+        }
+    }
+
+    // Slurp the file to find out whether it has changed since we last saw it.
+
+    if (!pStream->seekg(0, IOBase::seek_end))
+        return nullptr;
+    POV_OFF_T size = pStream->tellg();
+    if (!pStream->seekg(0) || (size <= 0) || (size > maxFileSize))
+        return nullptr;
+    if ((modified != kUnknownTime) && (size != fileSize))
+        modified = kUnknownTime; // file is being modified as we speak
+
+    std::vector<unsigned char> data(size_t(size), 0);
+    bool ok = pStream->read(data.data(), data.size());
+    pStream->seekg(0);
+    if (!ok)
+        return nullptr;
+
+    uint64_t hash = DiskCache::ComputeHash(data.data(), data.size());
+
+    UCS2String diskCacheFileName;
+    if (!diskCachePath.empty())
+        diskCacheFileName = DiskCache::GetFileName(diskCachePath, streamName, POV_File_Data_Tokens);
+
+    {
+        std::lock_guard<std::mutex> lock(gCacheMutex);
+        auto i = gCacheEntries.find(streamName);
+        if ((i != gCacheEntries.end()) && (i->second.size == size) && (i->second.hash == hash))
+        {
+            i->second.modified = modified;
+            i->second.checked = now;
+            i->second.lastUse = ++gCacheUseCount;
+            if (i->second.tokenized)
+                return i->second.pTokens;
+        }
+        else if (diskCacheFileName.empty())
+        {
+            // Pre-tokenizing is more expensive than parsing the file directly,
+            // so without a disk cache only do it once we've seen the file twice.
+            if (i != gCacheEntries.end())
+                gCachedTokenCount -= (i->second.pTokens == nullptr ? 0 : i->second.pTokens->tokens.size());
+            gCacheEntries[streamName] = FileTokenCacheEntry{ size, modified, now, hash, nullptr, ++gCacheUseCount, false };
+            return nullptr;
+        }
+    }
+
+    // Try the disk cache, or tokenize the file afresh.
+
+    std::shared_ptr<RawTokenSequence> pTokens;
+    if (!diskCacheFileName.empty())
+        pTokens = LoadTokens(diskCacheFileName, streamName, size, hash);
+    if (pTokens == nullptr)
+    {
+        pTokens = std::make_shared<RawTokenSequence>();
+        if (!RawTokenizer::TokenizeStream(std::make_shared<IMemStream>(data.data(), data.size(), streamName), *pTokens,
+                                          POV_PARSER_INCLUDE_CACHE_SIZE))
+        {
+            // Leave it to the parser to report the error, or parse the file
+            // directly if it is too large to keep around; also remember not to
+            // try again unless the file changes.
+            pTokens = nullptr;
+        }
+        else if (!diskCacheFileName.empty())
+            SaveTokens(diskCacheFileName, streamName, size, hash, *pTokens);
+    }
+
+    size_t tokenCount = (pTokens == nullptr ? 0 : pTokens->tokens.size());
+
+    std::lock_guard<std::mutex> lock(gCacheMutex);
+
+    auto i = gCacheEntries.find(streamName);
+    if (i != gCacheEntries.end())
+    {
+        gCachedTokenCount -= (i->second.pTokens == nullptr ? 0 : i->second.pTokens->tokens.size());
+        gCacheEntries.erase(i);
+    }
+
+    // Evict the least recently used files until the new one fits.
+    while (gCachedTokenCount + tokenCount > POV_PARSER_INCLUDE_CACHE_SIZE)
+    {
+        auto oldest = gCacheEntries.end();
+        for (auto j = gCacheEntries.begin(); j != gCacheEntries.end(); ++j)
+        {
+            if ((j->second.pTokens != nullptr) && ((oldest == gCacheEntries.end()) || (j->second.lastUse < oldest->second.lastUse)))
+                oldest = j;
+        }
+        POV_PARSER_ASSERT(oldest != gCacheEntries.end());
+        gCachedTokenCount -= oldest->second.pTokens->tokens.size();
+        gCacheEntries.erase(oldest);
+    }
+
+    gCacheEntries[streamName] = FileTokenCacheEntry{ size, modified, now, hash, pTokens, ++gCacheUseCount, true };
+    gCachedTokenCount += tokenCount;
+
+    return pTokens;
+}
+
+}
+// end of namespace pov_parser
@@ -0,0 +1,110 @@
+//******************************************************************************
+///
+/// @file parser/filetokencache.h
+///
+/// Declarations for the cache of pre-tokenized include files.
+///
+/// @copyright
+/// @parblock
+///
+/// Persistence of Vision Ray Tracer ('POV-Ray') version 3.8.
+/// Copyright 1991-2019 Persistence of Vision Raytracer Pty. Ltd.
+///
+/// POV-Ray is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Affero General Public License as
+/// published by the Free Software Foundation, either version 3 of the
+/// License, or (at your option) any later version.
+///
+/// POV-Ray is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU Affero General Public License for more details.
+///
+/// You should have received a copy of the GNU Affero General Public License
+/// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// ----------------------------------------------------------------------------
+///
+/// POV-Ray is based on the popular DKB raytracer version 2.12.
+/// DKBTrace was originally written by David K. Buck.
+/// DKBTrace Ver 2.0-2.12 were written by David K. Buck & Aaron A. Collins.
+///
+/// @endparblock
+///
+//******************************************************************************
+
+#ifndef POVRAY_PARSER_FILETOKENCACHE_H
+#define POVRAY_PARSER_FILETOKENCACHE_H
+
+// Module config header file must be the first file included within POV-Ray unit header files
+#include "parser/configparser.h"
+
+// C++ variants of C standard header files
+//  (none at the moment)
+
+// C++ standard header files
+//  (none at the moment)
+
+// POV-Ray header files (base module)
+#include "base/stringtypes.h"
+
+// POV-Ray header files (core module)
+//  (none at the moment)
+
+// POV-Ray header files (parser module)
+#include "parser/parsertypes.h"
+#include "parser/rawtokenizer.h"
+
+namespace pov_parser
+{
+
+using namespace pov_base;
+
+//******************************************************************************
+
+/// Class implementing a cache of pre-tokenized include files.
+///
+/// Include files are typically parsed over and over again, not only once per
+/// animation frame, but also across renders of different scenes. To avoid
+/// scanning them each time, this class keeps the raw tokens of each include
+/// file in memory for the lifetime of the process, and optionally in a
+/// directory on disk for the benefit of later runs.
+///
+/// Cache entries are validated against the size and modification time of the
+/// file each time it is included, so unchanged files need not even be read.
+/// Only if these differ, or if the file was modified so recently that the
+/// timestamp alone cannot be trusted, is the actual file content read and
+/// compared against a hash, so modified files are picked up reliably, even if
+/// they are re-written in the middle of an animation.
+///
+/// @note
+///     This class is thread-safe.
+///
+class FileTokenCache final
+{
+public:
+
+    /// Get the raw tokens of an entire stream.
+    ///
+    /// @note
+    ///     The stream must be freshly opened; it is rewound to the start
+    ///     before this function returns.
+    ///
+    /// @param[in]  pStream         Stream to tokenize.
+    /// @param[in]  diskCachePath   Directory to store the tokens in for future
+    ///                             runs, or empty to not use a disk cache.
+    /// @param[in]  maxFileSize     Size limit in bytes for files to be cached.
+    /// @return                     The raw tokens of the stream, or `nullptr`
+    ///                             if the stream is not eligible for caching.
+    ///
+    static RawTokenSequencePtr Get(StreamPtr pStream, const UCS2String& diskCachePath, POV_OFF_T maxFileSize);
+
+private:
+
+    FileTokenCache() = delete;
+};
+
+}
+// end of namespace pov_parser
+
+#endif // POVRAY_PARSER_FILETOKENCACHE_H
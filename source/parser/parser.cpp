@@ -50,7 +50,9 @@
 // POV-Ray header files (base module)
 #include "base/fileinputoutput.h"
 #include "base/fileutil.h"
+#include "base/filesystem.h"
 #include "base/path.h"
+#include "base/platformbase.h"
 #include "base/povassert.h"
 #include "base/stringutilities.h"
 #include "base/types.h"
@@ -62,6 +64,7 @@
 #include "core/bounding/boundingsphere.h"
 #include "core/lighting/lightgroup.h"
 #include "core/lighting/lightsource.h"
+#include "core/lighting/lighttree.h"
 #include "core/lighting/photons.h"
 #include "core/lighting/radiosity.h"
 #include "core/lighting/subsurface.h"
@@ -113,7 +116,7 @@
 #include "vm/fnpovfpu.h"
 
 // POV-Ray header files (parser module)
-//  (none at the moment)
+#include "parser/texturecache.h"
 
 // this must be the last file included
 #include "base/povdebug.h"
@@ -154,6 +157,12 @@ Parser::Parser(shared_ptr<SceneData> sd, const Options& opts,
     Destroying_Frame(false),
     mTokenCount(0),
     mTokensSinceLastProgressReport(0),
+    mDirectiveCount(0),
+    mFrameDependent(false),
+    mNotReusable(false),
+    mRandomSequenceFrameDependent(false),
+    mObjectReuseDisabled(false),
+    mLastAnimationFrame(opts.lastAnimationFrame),
     next_rand(nullptr)
 {
     std::tm tmY2K;
@@ -173,10 +182,19 @@ Parser::Parser(shared_ptr<SceneData> sd, const Options& opts,
         mBetaFeatureFlags.realTimeRaytracing = true;
 
     sceneData->functionContextFactory = mpFunctionVM;
+
+    if (opts.reuseStaticObjects)
+        mpStaticObjectCache = StaticObjectCache::Acquire(sceneData->inputFile, opts.continuedAnimation);
+    else
+        StaticObjectCache::Release();
 }
 
 Parser::~Parser()
 {
+    // Objects cached during a frame we didn't finish parsing are of no use to anyone.
+    if (mpStaticObjectCache != nullptr)
+        StaticObjectCache::Release();
+
     // NB: We need to keep fnVMContext around until all functions have been destroyed.
     delete fnVMContext;
 }
@@ -237,10 +255,25 @@ void Parser::Run()
                 }
             }
 
+            // Declared variables that differ from the previous frame invalidate any objects depending on them.
+            if (mpStaticObjectCache != nullptr)
+            {
+                for (auto& name : mpStaticObjectCache->ChangedVariables(sceneData->declaredVariables))
+                    MarkSymbolFrameDependent(GetSymbolHash(name.c_str()));
+            }
+
             IncludeHeader(sceneData->headerFile);
 
             Parse_Frame();
 
+            if (mpStaticObjectCache != nullptr)
+            {
+                mpStaticObjectCache->EndFrame();
+                if (mLastAnimationFrame)
+                    StaticObjectCache::Release();
+                mpStaticObjectCache = nullptr;
+            }
+
             // post process atmospheric media
             for (vector<Media>::iterator i(sceneData->atmosphere.begin()); i != sceneData->atmosphere.end(); i++)
                 i->PostProcess();
@@ -252,6 +285,11 @@ void Parser::Run()
                 sceneData->lightSources[i]->lightGroupLight = false;
             }
 
+            // set up the tree for sampling global light sources, if there are too many to test them all
+            sceneData->lightTree.reset();
+            if ((sceneData->lightBudget > 0) && (sceneData->lightSources.size() > sceneData->lightBudget))
+                sceneData->lightTree = std::make_shared<LightTree>(sceneData->lightSources);
+
             // post process local light sources
             for (size_t i = 0; i < sceneData->lightGroupLightSources.size(); i++)
             {
@@ -287,6 +325,10 @@ void Parser::Run()
         {
             Error(e, "Illegal escape sequence '%s' in string literal.", e.offendingText.c_str());
         }
+        catch (const InputSeekException& e)
+        {
+            Error(e, "Unable to seek in input file.");
+        }
         catch (pov_base::Exception& e)
         {
             // Error was detected by the parser, and already reported when first thrown
@@ -3453,6 +3495,14 @@ ObjectPtr Parser::Parse_Light_Source ()
             }
         END_CASE
 
+        CASE (LOW_DISCREPANCY_TOKEN)
+            Object->Low_Discrepancy = Allow_Float(1.0) > 0.0;
+            if (!(Object->Area_Light))
+            {
+                Warning("Low_discrepancy only affects area_light");
+            }
+        END_CASE
+
         // JN2007: Full area lighting:
         CASE (AREA_ILLUMINATION_TOKEN)
             Object->Use_Full_Area_Lighting = Allow_Float(1.0) > 0.0;
@@ -3572,6 +3622,7 @@ ObjectPtr Parser::Parse_Light_Source ()
 ObjectPtr Parser::Parse_Mesh()
 {
     Mesh *Object;
+    UCS2String saveFileName;
 
     Parse_Begin();
 
@@ -3612,6 +3663,8 @@ ObjectPtr Parser::Parse_Mesh()
 
 #endif
 
+    saveFileName = Parse_Mesh_Save_File();
+
     // Create bounding box.
 
     Object->Compute_BBox();
@@ -3624,6 +3677,9 @@ ObjectPtr Parser::Parse_Mesh()
 
     Object->Build_Mesh_BBox_Tree();
 
+    if (!saveFileName.empty())
+        Save_Mesh_File(Object, saveFileName);
+
     return Object;
 }
 
@@ -3899,7 +3955,7 @@ void Parser::Parse_Mesh1 (Mesh* Object)
 
     /* Init triangle mesh data. */
 
-    Object->Data = reinterpret_cast<MESH_DATA *>(POV_MALLOC(sizeof(MESH_DATA), "triangle mesh data"));
+    Object->Data = new MESH_DATA();
 
 
     Object->Data->References = 1;
@@ -4048,6 +4104,7 @@ void Parser::Parse_Mesh1 (Mesh* Object)
 ObjectPtr Parser::Parse_Mesh2()
 {
     Mesh *Object;
+    UCS2String saveFileName;
 
     Parse_Begin();
 
@@ -4059,11 +4116,23 @@ ObjectPtr Parser::Parse_Mesh2()
 
     Object = new Mesh();
 
-    Parse_Mesh2 (Object);
+    EXPECT_ONE
+        CASE(LOAD_FILE_TOKEN)
+            // Bounding box is read from the file.
+            Parse_Mesh_Load_File (Object);
+        END_CASE
 
-    // Create bounding box.
+        OTHERWISE
+            UNGET
+            Parse_Mesh2 (Object);
 
-    Object->Compute_BBox();
+            // Create bounding box.
+
+            Object->Compute_BBox();
+        END_CASE
+    END_EXPECT
+
+    saveFileName = Parse_Mesh_Save_File();
 
     // Parse object modifiers.
 
@@ -4073,6 +4142,9 @@ ObjectPtr Parser::Parse_Mesh2()
 
     Object->Build_Mesh_BBox_Tree();
 
+    if (!saveFileName.empty())
+        Save_Mesh_File(Object, saveFileName);
+
     return Object;
 }
 
@@ -4202,30 +4274,7 @@ void Parser::Parse_Mesh2 (Mesh* Object)
 
     EXPECT*/
         CASE(TEXTURE_LIST_TOKEN)
-            Parse_Begin();
-
-            number_of_textures = (int)Parse_Float();  Parse_Comma();
-
-            if (number_of_textures>0)
-            {
-                Textures = reinterpret_cast<TEXTURE **>(POV_MALLOC(number_of_textures*sizeof(TEXTURE *), "triangle mesh data"));
-
-                for(i=0; i<number_of_textures; i++)
-                {
-                    /*
-                    GET(TEXTURE_ID_TOKEN)
-                    Textures[i] = Copy_Texture_Pointer(CurrentTokenDataPtr<TEXTURE*>());
-                    */
-                    GET(TEXTURE_TOKEN);
-                    Parse_Begin();
-                    Textures[i] = Parse_Texture();
-                    Post_Textures(Textures[i]);
-                    Parse_End();
-                    Parse_Comma();
-                }
-            }
-
-            Parse_End();
+            Textures = Parse_Mesh_Texture_List(number_of_textures);
             EXIT
         END_CASE
 
@@ -4576,7 +4625,7 @@ void Parser::Parse_Mesh2 (Mesh* Object)
     /* ----------------------------------------------------- */
 
     /* Init triangle mesh data. */
-    Object->Data = reinterpret_cast<MESH_DATA *>(POV_MALLOC(sizeof(MESH_DATA), "triangle mesh data"));
+    Object->Data = new MESH_DATA();
     Object->Data->References = 1;
     Object->Data->Tree = nullptr;
     /* NK 1998 */
@@ -4631,6 +4680,251 @@ void Parser::Parse_Mesh2 (Mesh* Object)
 }
 
 
+/*****************************************************************************
+*
+* FUNCTION
+*
+*   Parse_Mesh_Texture_List
+*
+* INPUT
+*
+* OUTPUT
+*
+*   number_of_textures - number of textures in the list
+*
+* RETURNS
+*
+*   TEXTURE ** - array of textures, or nullptr if the list is empty
+*
+* AUTHOR
+*
+* DESCRIPTION
+*
+*   Parse the contents of a mesh2 texture_list.
+*
+* CHANGES
+*
+*   -
+*
+******************************************************************************/
+
+TEXTURE **Parser::Parse_Mesh_Texture_List(int& number_of_textures)
+{
+    TEXTURE **Textures = nullptr;
+
+    Parse_Begin();
+
+    number_of_textures = (int)Parse_Float();  Parse_Comma();
+
+    if (number_of_textures>0)
+    {
+        Textures = reinterpret_cast<TEXTURE **>(POV_MALLOC(number_of_textures*sizeof(TEXTURE *), "triangle mesh data"));
+
+        for(int i=0; i<number_of_textures; i++)
+        {
+            /*
+            GET(TEXTURE_ID_TOKEN)
+            Textures[i] = Copy_Texture_Pointer(CurrentTokenDataPtr<TEXTURE*>());
+            */
+            GET(TEXTURE_TOKEN);
+            Parse_Begin();
+            Textures[i] = Parse_Texture();
+            Post_Textures(Textures[i]);
+            Parse_End();
+            Parse_Comma();
+        }
+    }
+
+    Parse_End();
+
+    return Textures;
+}
+
+/*****************************************************************************
+*
+* FUNCTION
+*
+*   Parse_Mesh_Load_File
+*
+* INPUT
+*
+* OUTPUT
+*
+* RETURNS
+*
+* AUTHOR
+*
+* DESCRIPTION
+*
+*   Read a triangle mesh from a binary mesh file, as written by save_file.
+*   The file is memory-mapped and used in-place. Textures are not stored in
+*   the file, and need to be specified in a texture_list, in the same order
+*   as in the mesh originally saved.
+*
+*   Syntax:
+*
+*     mesh2 { load_file FILENAME [ texture_list { ... } ] [ inside_vector V ] ... }
+*
+* CHANGES
+*
+*   -
+*
+******************************************************************************/
+
+void Parser::Parse_Mesh_Load_File(Mesh* Object)
+{
+    int number_of_textures = 0;
+    MeshIndex required_textures = 0;
+    TEXTURE **Textures = nullptr;
+    Vector3d Inside_Vect;
+    bool found_inside_vector = false;
+
+    UCS2 *str = Parse_String(true);
+    UCS2String fileName(str);
+    POV_FREE(str);
+
+    UCS2String foundFile = mFileResolver.FindFile(fileName, POV_File_Data_Mesh);
+    if (foundFile.empty())
+        Error("Cannot find mesh file '%s'.", UCS2toSysString(fileName).c_str());
+
+    if (!PlatformBase::GetInstance().AllowLocalFileAccess(foundFile, POV_File_Data_Mesh, false))
+        Error("IO Restrictions prohibit read access to '%s'.", UCS2toSysString(foundFile).c_str());
+
+    Filesystem::MappedFilePtr file(std::make_shared<Filesystem::MappedFile>());
+    if (!file->Open(foundFile))
+        Error("Cannot open mesh file '%s'.", UCS2toSysString(foundFile).c_str());
+
+    try
+    {
+        required_textures = Object->Load_Mesh_File(file);
+    }
+    catch (pov_base::Exception& e)
+    {
+        Error("%s File: '%s'.", e.what(), UCS2toSysString(foundFile).c_str());
+    }
+
+    EXPECT
+        CASE(TEXTURE_LIST_TOKEN)
+            if (Textures != nullptr)
+            {
+                Warning("Duplicate texture_list block; ignoring previous block.");
+                for (int i = 0; i < number_of_textures; i++)
+                    Destroy_Textures(Textures[i]);
+                POV_FREE(Textures);
+            }
+            Textures = Parse_Mesh_Texture_List(number_of_textures);
+        END_CASE
+
+        CASE(INSIDE_VECTOR_TOKEN)
+            Parse_Vector(Inside_Vect);
+            found_inside_vector = true;
+        END_CASE
+
+        OTHERWISE
+            UNGET
+            EXIT
+        END_CASE
+    END_EXPECT
+
+    if (number_of_textures < required_textures)
+        Error("Mesh file references %d textures, but texture_list only has %d.", int(required_textures), number_of_textures);
+
+    Object->Textures = Textures;
+    Object->Number_Of_Textures = number_of_textures;
+
+    if (number_of_textures)
+    {
+        Set_Flag(Object, MULTITEXTURE_FLAG);
+    }
+
+    if (found_inside_vector)
+    {
+        if( (fabs(Inside_Vect[X]) < EPSILON) &&  (fabs(Inside_Vect[Y]) < EPSILON) &&  (fabs(Inside_Vect[Z]) < EPSILON))
+        {
+            Object->has_inside_vector=false;
+            Object->Type |= PATCH_OBJECT;
+        }
+        else
+        {
+            Object->Data->Inside_Vect = Inside_Vect.normalized();
+            Object->has_inside_vector=true;
+            Object->Type &= ~PATCH_OBJECT;
+        }
+    }
+}
+
+/*****************************************************************************
+*
+* FUNCTION
+*
+*   Parse_Mesh_Save_File
+*
+* INPUT
+*
+* OUTPUT
+*
+* RETURNS
+*
+*   UCS2String - name of the binary mesh file to write, or empty if none
+*
+* AUTHOR
+*
+* DESCRIPTION
+*
+*   Parse the optional save_file clause of a mesh or mesh2. The file is
+*   written once the mesh is complete, including its bounding volume
+*   hierarchy; see @ref Save_Mesh_File().
+*
+* CHANGES
+*
+*   -
+*
+******************************************************************************/
+
+UCS2String Parser::Parse_Mesh_Save_File()
+{
+    UCS2String fileName;
+    UCS2 *str;
+
+    EXPECT_ONE
+        CASE(SAVE_FILE_TOKEN)
+            str = Parse_String(true);
+            fileName = str;
+            POV_FREE(str);
+        END_CASE
+
+        OTHERWISE
+            UNGET
+        END_CASE
+    END_EXPECT
+
+    return fileName;
+}
+
+void Parser::Save_Mesh_File(Mesh* Object, const UCS2String& fileName)
+{
+    // Get rid of the old file first rather than overwriting it in place, so
+    // that any other frame or process still having it mapped keeps its copy.
+    Filesystem::DeleteFile(fileName);
+
+    std::unique_ptr<OStream> file(CreateFile(fileName, POV_File_Data_Mesh, false));
+
+    if (file == nullptr)
+        Error("Cannot open mesh file '%s' (write).", UCS2toSysString(fileName).c_str());
+
+    try
+    {
+        Object->Save_Mesh_File(*file);
+    }
+    catch (pov_base::Exception& e)
+    {
+        // Don't leave a truncated file behind for the next frame to pick up.
+        file.reset();
+        Filesystem::DeleteFile(fileName);
+        Error("%s File: '%s'.", e.what(), UCS2toSysString(fileName).c_str());
+    }
+}
+
 /*****************************************************************************
 *
 * FUNCTION
@@ -6475,6 +6769,8 @@ void Parser::Parse_Default ()
 
     defaultsModified = true;
 
+    bool outerFrameDependent = BeginFrameDependencyScope();
+
     EXPECT
         CASE (TEXTURE_TOKEN)
             Local_Texture = Default_Texture;
@@ -6541,6 +6837,10 @@ void Parser::Parse_Default ()
         END_CASE
     END_EXPECT
 
+    // The defaults affect how subsequent statements are parsed.
+    if (EndFrameDependencyScope(outerFrameDependent) || Cond_Stack.back().frameDependent)
+        DisableObjectReuse();
+
     Parse_End();
 
     Not_In_Default = true;
@@ -6682,7 +6982,7 @@ void Parser::Parse_Frame ()
 
         OTHERWISE
             UNGET
-            Object = Parse_Object();
+            Object = Parse_Static_Object(false);
             if (Object == nullptr)
                 Expectation_Error ("object or directive");
             Post_Process (Object, nullptr);
@@ -6693,9 +6993,209 @@ void Parser::Parse_Frame ()
 
 //******************************************************************************
 
+/// Test whether a token starts an object statement we may re-use in later frames.
+///
+/// Text, isosurface and parametric objects reference data owned by the current frame (fonts and
+/// functions, respectively), so they are excluded, as are light sources and light groups.
+///
+static bool IsStaticObjectToken(TokenId tokenId)
+{
+    switch (tokenId)
+    {
+        case BICUBIC_PATCH_TOKEN:
+        case BLOB_TOKEN:
+        case BOX_TOKEN:
+        case COMPOSITE_TOKEN:
+        case CONE_TOKEN:
+        case CUBIC_TOKEN:
+        case CYLINDER_TOKEN:
+        case DIFFERENCE_TOKEN:
+        case DISC_TOKEN:
+        case HEIGHT_FIELD_TOKEN:
+        case INTERSECTION_TOKEN:
+        case JULIA_FRACTAL_TOKEN:
+        case LATHE_TOKEN:
+        case LEMON_TOKEN:
+        case MERGE_TOKEN:
+        case MESH_TOKEN:
+        case MESH2_TOKEN:
+        case OBJECT_TOKEN:
+        case OVUS_TOKEN:
+        case PLANE_TOKEN:
+        case POLY_TOKEN:
+        case POLYGON_TOKEN:
+        case POLYNOMIAL_TOKEN:
+        case PRISM_TOKEN:
+        case QUADRIC_TOKEN:
+        case QUARTIC_TOKEN:
+        case SMOOTH_TRIANGLE_TOKEN:
+        case SOR_TOKEN:
+        case SPHERE_TOKEN:
+        case SPHERE_SWEEP_TOKEN:
+        case SUPERELLIPSOID_TOKEN:
+        case TORUS_TOKEN:
+        case TRIANGLE_TOKEN:
+        case UNION_TOKEN:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+ObjectPtr Parser::Parse_Static_Object(bool declared)
+{
+    StaticStatement statement;
+    ObjectPtr object = BeginStaticStatement(statement, declared);
+    if (object == nullptr)
+    {
+        object = Parse_Object();
+        EndStaticStatement(statement, object);
+    }
+    return object;
+}
+
+/// Start parsing an object statement.
+///
+/// If the statement was found to be static in the previous frame, and none of the symbols it read
+/// have since been assigned frame-dependent values, it is skipped and a copy of the object it
+/// produced is returned.
+///
+/// @return     The re-used object, or `nullptr` if the statement must be parsed (in which case the
+///             caller must invoke @ref EndStaticStatement() afterwards).
+///
+ObjectPtr Parser::BeginStaticStatement(StaticStatement& statement, bool declared)
+{
+    statement.active = (mpStaticObjectCache != nullptr) && mToken.Unget_Token && IsStaticObjectToken(CurrentTrueTokenId());
+    if (!statement.active)
+        return nullptr;
+
+    statement.key.fileName = mToken.GetFileName();
+    statement.key.offset   = mToken.GetOffset();
+    statement.key.context  = 0;
+    for (auto& entry : Cond_Stack)
+        statement.key.context = statement.key.context * 31 + entry.context;
+    for (auto& entry : maIncludeStack)
+        statement.key.context = statement.key.context * 31 + size_t(entry.returnToBookmark.offset);
+    statement.key.declared   = declared;
+    statement.key.occurrence = 0;
+    statement.key.occurrence = mStaticStatementOccurrences[statement.key]++;
+
+    statement.outerFrameDependent = mFrameDependent;
+    statement.outerNotReusable    = mNotReusable;
+    statement.cleanStart          = !mHavePendingRawToken;
+    statement.directiveCount      = mDirectiveCount;
+    statement.condStackSize       = Cond_Stack.size();
+    statement.includeStackSize    = maIncludeStack.size();
+
+    mFrameDependent = false;
+    mNotReusable    = mObjectReuseDisabled;
+    maStaticStatementSymbols.emplace_back();
+
+    if (mObjectReuseDisabled)
+        return nullptr;
+
+    StaticStatementEntryPtr entry = mpStaticObjectCache->Find(statement.key);
+    if (entry == nullptr)
+        return nullptr;
+    for (auto hash : entry->symbols)
+        if ((mFrameDependentSymbols.find(hash) != mFrameDependentSymbols.end()) ||
+            (mNotReusableSymbols.find(hash) != mNotReusableSymbols.end()))
+            return nullptr;
+
+    // Skip the statement, preferably by going straight to where it ended in the previous frame;
+    // if it contains any directives or macro calls, read through its tokens instead, so that
+    // these still take effect.
+    Get_Token();
+    if (!(entry->canSkipToEnd && statement.cleanStart && mTokenizer.GoToBookmark(entry->end)))
+    {
+        int depth = 0;
+        do
+        {
+            Get_Token();
+            if (mToken.End_Of_File)
+                Error("Unexpected end of file in object statement.");
+            if (CurrentTrueTokenId() == LEFT_CURLY_TOKEN)
+                ++depth;
+            else if (CurrentTrueTokenId() == RIGHT_CURLY_TOKEN)
+                --depth;
+        }
+        while (depth > 0);
+    }
+
+    ObjectPtr object = Copy_Object(entry->object);
+
+    if (entry->maxBlobComponents > sceneData->Max_Blob_Components)
+        sceneData->Max_Blob_Components = entry->maxBlobComponents;
+    if (entry->fractalIterationStackLength > sceneData->Fractal_Iteration_Stack_Length)
+    {
+        sceneData->Fractal_Iteration_Stack_Length = entry->fractalIterationStackLength;
+        TraceThreadData *td = GetParserDataPtr();
+        Fractal::Allocate_Iteration_Stack(td->Fractal_IStack, sceneData->Fractal_Iteration_Stack_Length);
+    }
+    if (entry->maxBoundingCylinders > sceneData->Max_Bounding_Cylinders)
+    {
+        TraceThreadData *td = GetParserDataPtr();
+        sceneData->Max_Bounding_Cylinders = entry->maxBoundingCylinders;
+        td->BCyl_Intervals.reserve(4*sceneData->Max_Bounding_Cylinders);
+        td->BCyl_RInt.reserve(2*sceneData->Max_Bounding_Cylinders);
+        td->BCyl_HInt.reserve(2*sceneData->Max_Bounding_Cylinders);
+    }
+
+    for (auto hash : entry->symbols)
+        NoteSymbolRead(hash);
+    LeaveStaticStatement(statement);
+    return object;
+}
+
+/// Finish parsing an object statement, recording the resulting object if it is static.
+void Parser::EndStaticStatement(StaticStatement& statement, ObjectPtr object)
+{
+    if (!statement.active)
+        return;
+
+    if ((object != nullptr) && !mFrameDependent && !mNotReusable)
+    {
+        std::shared_ptr<StaticStatementEntry> entry(new StaticStatementEntry);
+        entry->object  = Copy_Object(object);
+        entry->symbols = maStaticStatementSymbols.back();
+        std::sort(entry->symbols.begin(), entry->symbols.end());
+        entry->symbols.erase(std::unique(entry->symbols.begin(), entry->symbols.end()), entry->symbols.end());
+        entry->end = mTokenizer.GetColdBookmark();
+        entry->canSkipToEnd = statement.cleanStart && !mToken.Unget_Token && !mHavePendingRawToken &&
+                              (mDirectiveCount == statement.directiveCount) &&
+                              (Cond_Stack.size() == statement.condStackSize) &&
+                              (maIncludeStack.size() == statement.includeStackSize) &&
+                              (entry->end.fileName == statement.key.fileName);
+        entry->maxBlobComponents           = sceneData->Max_Blob_Components;
+        entry->fractalIterationStackLength = sceneData->Fractal_Iteration_Stack_Length;
+        entry->maxBoundingCylinders        = sceneData->Max_Bounding_Cylinders;
+        mpStaticObjectCache->Store(statement.key, entry);
+    }
+
+    LeaveStaticStatement(statement);
+}
+
+void Parser::LeaveStaticStatement(const StaticStatement& statement)
+{
+    mFrameDependent = mFrameDependent || statement.outerFrameDependent;
+    mNotReusable    = mNotReusable    || statement.outerNotReusable;
+
+    std::vector<SymbolHash> symbols(std::move(maStaticStatementSymbols.back()));
+    maStaticStatementSymbols.pop_back();
+    if (!maStaticStatementSymbols.empty())
+    {
+        for (auto hash : symbols)
+            NoteSymbolRead(hash);
+    }
+}
+
+//******************************************************************************
+
 void Parser::Parse_Global_Settings()
 {
     Parse_Begin();
+    bool outerFrameDependent = BeginFrameDependencyScope();
     EXPECT
         CASE (IRID_WAVELENGTH_TOKEN)
             Parse_Wavelengths (sceneData->iridWavelengths);
@@ -7149,6 +7649,15 @@ void Parser::Parse_Global_Settings()
             sceneData->mmPerUnit = Parse_Float ();
         END_CASE
 
+        CASE (LIGHT_BUDGET_TOKEN)
+        {
+            int budget = (int)Parse_Float();
+            if (budget < 0)
+                Error("Light budget must not be negative.");
+            sceneData->lightBudget = (unsigned int)budget;
+        }
+        END_CASE
+
         CASE (SUBSURFACE_TOKEN)
             sceneData->useSubsurface = true;
             Parse_Begin();
@@ -7162,6 +7671,12 @@ void Parser::Parse_Global_Settings()
                     sceneData->subsurfaceUseRadiosity = ((int)Parse_Float() != 0);
                 END_CASE
 
+                CASE (ERROR_BOUND_TOKEN)
+                    sceneData->subsurfaceErrorBound = Parse_Float();
+                    if (sceneData->subsurfaceErrorBound < 0.0)
+                        Error("Subsurface error_bound must not be negative.");
+                END_CASE
+
                 OTHERWISE
                     UNGET
                     EXIT
@@ -7175,6 +7690,10 @@ void Parser::Parse_Global_Settings()
             EXIT
         END_CASE
     END_EXPECT
+
+    // Some global settings affect how subsequent statements are parsed.
+    if (EndFrameDependencyScope(outerFrameDependent) || Cond_Stack.back().frameDependent)
+        DisableObjectReuse();
     Parse_End();
 }
 
@@ -8003,6 +8522,9 @@ void Parser::Parse_Declare(bool is_local, bool after_hash)
     POV_EXPERIMENTAL_ASSERT(IsOkToDeclare());
     SetOkToDeclare(false);
 
+    bool outerFrameDependent = BeginFrameDependencyScope();
+    bool outerNotReusable = BeginReuseScope();
+
     if ((sceneData->EffectiveLanguageVersion() >= 350) && (after_hash == false))
     {
         PossibleError("'declare' should be changed to '#declare'.\n"
@@ -8207,6 +8729,8 @@ void Parser::Parse_Declare(bool is_local, bool after_hash)
         lvalue.previous = Previous;
         lvalue.allowRedefine = allow_redefine;
         lvalue.optional = optional;
+        lvalue.symbolHash = mToken.rootSymbolHash;
+        lvalue.parameterRef = mToken.is_parameter_ref;
         lvalues.push_back(lvalue);
 
         if (lvectorDeclare && (lvalues.size() >= 5))
@@ -8353,6 +8877,28 @@ void Parser::Parse_Declare(bool is_local, bool after_hash)
             SymbolTable::Destroy_Entry (i->symEntry);
     }
 
+    if (EndFrameDependencyScope(outerFrameDependent) || Cond_Stack.back().frameDependent)
+    {
+        for (auto& lvalue : lvalues)
+        {
+            MarkSymbolFrameDependent(lvalue.symbolHash);
+            // We can't tell which identifier a macro parameter refers to.
+            if (lvalue.parameterRef)
+                DisableObjectReuse();
+        }
+    }
+
+    if (EndReuseScope(outerNotReusable))
+    {
+        for (auto& lvalue : lvalues)
+        {
+            MarkSymbolNotReusable(lvalue.symbolHash);
+            // We can't tell which identifier a macro parameter refers to.
+            if (lvalue.parameterRef)
+                DisableObjectReuse();
+        }
+    }
+
     if ( after_hash )
     {
         POV_EXPERIMENTAL_ASSERT(IsOkToDeclare());
@@ -8826,7 +9372,7 @@ bool Parser::Parse_RValue (TokenId Previous, TokenId *NumberPtr, void **DataPtr,
 
         OTHERWISE
             UNGET
-            Local_Object = Parse_Object ();
+            Local_Object = Parse_Static_Object(true);
             Found = (Local_Object != nullptr);
             if (Found)
             {
@@ -9119,8 +9665,14 @@ void Parser::Post_Process (ObjectPtr Object, ObjectPtr Parent)
     }
 
     if (Object->interior != nullptr)
+    {
         Object->interior->PostProcess();
 
+        Vector3d mins, maxs;
+        Make_min_max_from_BBox(mins, maxs, Object->BBox);
+        Object->interior->PrepareDensityGrids(mins, maxs);
+    }
+
     if ((Object->Texture == nullptr) &&
         !(Object->Type & TEXTURED_OBJECT) &&
         !(Object->Type & LIGHT_SOURCE_OBJECT))
@@ -9971,7 +10523,7 @@ OStream *Parser::CreateFile(const UCS2String& filename, unsigned int stype, bool
 
 //******************************************************************************
 
-Image *Parser::Read_Image(int filetype, const UCS2 *filename, const ImageReadOptions& options)
+Image *Parser::Read_Image(int filetype, const UCS2 *filename, const ImageReadOptions& options, std::vector<Image*> *pMipLevels)
 {
     unsigned int stype;
     Image::ImageFileType type;
@@ -10040,6 +10592,9 @@ Image *Parser::Read_Image(int filetype, const UCS2 *filename, const ImageReadOpt
     if (file == nullptr)
         throw POV_EXCEPTION(kCannotOpenFileErr, "Cannot find image file.");
 
+    if ((pMipLevels != nullptr) && !sceneData->textureCachePath.empty() && (type != Image::SYS))
+        return TextureCache::Get(file, type, options, sceneData->textureCachePath, sceneData->textureCacheMemory, *pMipLevels);
+
     return Image::Read(type, file.get(), options);
 }
 
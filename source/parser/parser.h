@@ -49,6 +49,8 @@
 #include <chrono>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 // Boost headers
@@ -79,6 +81,7 @@
 #include "parser/parsertypes.h"
 #include "parser/reservedwords.h"
 #include "parser/rawtokenizer.h"
+#include "parser/staticobjectcache.h"
 #include "parser/symboltable.h"
 
 namespace pov
@@ -244,12 +247,14 @@ class Parser final
             TokenId *NumberPtr;
             void **DataPtr;
             SymbolTable* table;                 ///< Table or dictionary the token references an element of.
+            SymbolHash rootSymbolHash;          ///< Hash of the identifier the token references (the element's name for `local` and `global`).
             bool Unget_Token            : 1;    ///< `true` if @ref Get_Token() must re-issue this token as-is.
             bool ungetRaw               : 1;    ///< `true` if @ref Get_Token() must re-evaluate this token from raw.
             bool End_Of_File            : 1;
             bool is_array_elem          : 1;    ///< `true` if token is an array element reference.
             bool is_mixed_array_elem    : 1;    ///< `true` if token is a mixed-type array element reference.
             bool is_dictionary_elem     : 1;    ///< `true` if token is a dictionary element reference.
+            bool is_parameter_ref       : 1;    ///< `true` if token references a variable via a macro parameter.
 
             void SetTokenId(const RawToken& rawToken);
             void SetTokenId(TokenId tokenId);
@@ -277,8 +282,10 @@ class Parser final
             void**       dataPtr;
             TokenId      previous;
             SYM_ENTRY*   symEntry;
+            SymbolHash   symbolHash;
             bool         allowRedefine : 1;
             bool         optional      : 1;
+            bool         parameterRef  : 1;
         };
 
         struct MacroParameter final
@@ -459,7 +466,7 @@ class Parser final
         std::shared_ptr<IStream> Locate_File(const UCS2String& formalFileName, unsigned int stype, UCS2String& actualFileName, bool err_flag = false);
 
         OStream *CreateFile(const UCS2String& filename, unsigned int stype, bool append);
-        Image *Read_Image(int filetype, const UCS2 *filename, const ImageReadOptions& options);
+        Image *Read_Image(int filetype, const UCS2 *filename, const ImageReadOptions& options, std::vector<Image*> *pMipLevels = nullptr);
 
         // tokenize.h/tokenize.cpp
         void Get_Token (void);
@@ -491,6 +498,7 @@ class Parser final
         bool HaveCurrentMessageContext() const;
         const MessageContext& CurrentMessageContext() const;
         void SetInputStream(const std::shared_ptr<IStream>& stream);
+        void SetInputStream(const std::shared_ptr<IStream>& stream, RawTokenSequencePtr pTokens);
         RawTokenizer::HotBookmark GetHotBookmark();
         bool GoToBookmark(const RawTokenizer::HotBookmark& bookmark);
 
@@ -702,7 +710,9 @@ class Parser final
             UTF8String Loop_Identifier;
             DBL For_Loop_End;
             DBL For_Loop_Step;
-            CS_ENTRY() : Cond_Type(BUSY_COND), PMac(nullptr) {}
+            size_t context;         ///< Macro call site or loop iteration, to tell apart statements parsed repeatedly.
+            bool frameDependent;    ///< Whether the condition (or any enclosing one) depends on the frame.
+            CS_ENTRY() : Cond_Type(BUSY_COND), PMac(nullptr), context(0), frameDependent(false) {}
             ~CS_ENTRY() {}
         };
 
@@ -715,6 +725,35 @@ class Parser final
         RawToken        mPendingRawToken;
         bool            mHavePendingRawToken;
 
+        // re-use of static objects across animation frames
+
+        /// State of an object statement that may be re-used in later frames.
+        struct StaticStatement final
+        {
+            StaticStatementKey  key;
+            bool                active;                 ///< Whether the statement is a candidate for re-use.
+            bool                outerFrameDependent;    ///< @ref mFrameDependent of the enclosing scope.
+            bool                outerNotReusable;       ///< @ref mNotReusable of the enclosing scope.
+            bool                cleanStart;             ///< Whether the parser had no raw token pending at the start.
+            POV_LONG            directiveCount;
+            size_t              condStackSize;
+            size_t              includeStackSize;
+        };
+
+        using StaticStatementOccurrenceMap = std::unordered_map<StaticStatementKey, unsigned int, StaticStatementKeyHash>;
+
+        StaticObjectCachePtr                    mpStaticObjectCache;            ///< Cache of static objects, or `nullptr` if not re-using objects.
+        std::unordered_set<SymbolHash>          mFrameDependentSymbols;         ///< Symbols assigned frame-dependent values in this frame so far.
+        std::unordered_set<SymbolHash>          mNotReusableSymbols;            ///< Symbols assigned values that must not outlive the frame (e.g. functions).
+        std::vector<std::vector<SymbolHash>>    maStaticStatementSymbols;       ///< Symbols read by each object statement being parsed.
+        StaticStatementOccurrenceMap            mStaticStatementOccurrences;
+        POV_LONG                                mDirectiveCount;
+        bool                                    mFrameDependent;                ///< Whether the current scope depends on the frame.
+        bool                                    mNotReusable;                   ///< Whether the current object statement must be parsed anew.
+        bool                                    mRandomSequenceFrameDependent;  ///< Whether the number of random numbers drawn depends on the frame.
+        bool                                    mObjectReuseDisabled;           ///< Whether re-use is disabled for the remainder of the frame.
+        bool                                    mLastAnimationFrame;
+
         // parstxtr.h/parstxtr.cpp
         TEXTURE *Default_Texture;
 
@@ -780,6 +819,10 @@ class Parser final
 #endif
         void Parse_Mesh1 (Mesh*);
         void Parse_Mesh2 (Mesh*);
+        TEXTURE **Parse_Mesh_Texture_List(int& number_of_textures);
+        void Parse_Mesh_Load_File(Mesh*);
+        UCS2String Parse_Mesh_Save_File();
+        void Save_Mesh_File(Mesh*, const UCS2String& fileName);
 
         TEXTURE *Parse_Mesh_Texture(TEXTURE **t2, TEXTURE **t3);
         ObjectPtr Parse_TrueType(void);
@@ -794,6 +837,12 @@ class Parser final
         bool Parse_Camera_Mods(Camera& Cam);
         void Parse_Frame();
 
+        /// Parse an object, re-using the result of the previous frame if possible.
+        ObjectPtr Parse_Static_Object(bool declared);
+        ObjectPtr BeginStaticStatement(StaticStatement& statement, bool declared);
+        void EndStaticStatement(StaticStatement& statement, ObjectPtr object);
+        void LeaveStaticStatement(const StaticStatement& statement);
+
         void Link(ObjectPtr New_Object, std::vector<ObjectPtr>& Object_List_Root);
         void Link_To_Frame(ObjectPtr Object);
         void Post_Process(ObjectPtr Object, ObjectPtr Parent);
@@ -833,11 +882,33 @@ class Parser final
         void Parse_Write(void);
         int Parse_Read_Value(DATA_FILE *User_File, TokenId Previous, TokenId *NumberPtr, void **DataPtr);
         bool Parse_Read_Float_Value(DBL& val, DATA_FILE *User_File);
+        int Parse_Read_Array(DATA_FILE *User_File, POV_ARRAY *a, TokenId Format);
         void Check_Macro_Vers(void);
         DBL Parse_Cond_Param(void);
         void Parse_Cond_Param2(DBL *V1,DBL *V2);
         void Inc_CS_Index();
 
+        /// Start tracking whether the following tokens depend on the frame.
+        /// @return     The state of the enclosing scope, to be passed to @ref EndFrameDependencyScope().
+        bool BeginFrameDependencyScope();
+
+        /// Stop tracking whether the preceding tokens depend on the frame.
+        /// @return     Whether any token since the matching @ref BeginFrameDependencyScope() depended on the frame.
+        bool EndFrameDependencyScope(bool outerFrameDependent);
+
+        /// Start tracking whether the following tokens prevent re-use of an object in later frames.
+        /// @return     The state of the enclosing scope, to be passed to @ref EndReuseScope().
+        bool BeginReuseScope();
+
+        /// Stop tracking whether the preceding tokens prevent re-use of an object in later frames.
+        /// @return     Whether any token since the matching @ref BeginReuseScope() prevented re-use.
+        bool EndReuseScope(bool outerNotReusable);
+
+        void NoteSymbolRead(SymbolHash hash);
+        void MarkSymbolFrameDependent(SymbolHash hash);
+        void MarkSymbolNotReusable(SymbolHash hash);
+        void DisableObjectReuse();
+
         // parstxtr.h/parstxtr.cpp
         void Make_Pattern_Image(ImageData *image, FUNCTION_PTR fn, int token);
 
@@ -134,22 +134,21 @@ void Parser::Make_Pattern_Image(ImageData *image, FUNCTION_PTR fn, int token)
     {
         image->data =Image::Create(image->iwidth, image->iheight, ImageDataType::Gray_Int16);
 
-        point[Z] = 0;
+        // Evaluate the function one row at a time
+        vector<DBL> rowX(image->iwidth), rowY(image->iwidth), rowZ(image->iwidth, 0.0), rowValues(image->iwidth);
+        const DBL *rowArgs[3] = { rowX.data(), rowY.data(), rowZ.data() };
+
+        for(j = 0; j < image->iwidth; j++)
+            rowX[j] = ((DBL)j / (image->width - 1));
 
         for(i = 0; i < image->iheight; i++)
         {
-            point[Y] = ((DBL)i / (image->height - 1));
-
-            for( j = 0; j < image->iwidth; j++ )
-            {
-                point[X] = ((DBL)j / (image->width - 1));
+            std::fill(rowY.begin(), rowY.end(), ((DBL)i / (image->height - 1)));
 
-                fnVMContext->SetLocal(X, point[X]);
-                fnVMContext->SetLocal(Y, point[Y]);
-                fnVMContext->SetLocal(Z, point[Z]);
+            POVFPU_RunBatch(fnVMContext, *fn, rowArgs, 3, rowValues.data(), image->iwidth);
 
-                image->data->SetGrayValue(j, i, float(POVFPU_Run(fnVMContext, *fn)));
-            }
+            for( j = 0; j < image->iwidth; j++ )
+                image->data->SetGrayValue(j, i, float(rowValues[j]));
         }
     }
     else if((token == VECTFUNCT_ID_TOKEN) && (f->return_size == 5))
@@ -497,7 +496,7 @@ ImageData *Parser::Parse_Image(int Legal, bool GammaCorrect)
 #endif
         }
         else
-            image->data = Read_Image(filetype, filename.c_str(), options);
+            image->data = Read_Image(filetype, filename.c_str(), options, &image->MipLevels);
 
         if (!options.warnings.empty())
             for (vector<std::string>::iterator it = options.warnings.begin(); it != options.warnings.end(); it++)
@@ -3637,6 +3636,15 @@ void Parser::Parse_Media(vector<Media>& medialist)
             Parse_End();
         END_CASE
 
+        CASE (DENSITY_GRID_TOKEN)
+            IMedia->Density_Grid_Resolution = (int)Parse_Float();
+            if ((IMedia->Density_Grid_Resolution != 0) &&
+                ((IMedia->Density_Grid_Resolution < 2) || (IMedia->Density_Grid_Resolution > MediaDensityGrid::kMaxResolution)))
+            {
+                Error("density_grid resolution in media must be 0 or between 2 and %d.", MediaDensityGrid::kMaxResolution);
+            }
+        END_CASE
+
         CASE (TRANSLATE_TOKEN)
             Parse_Vector (Local_Vector);
             Compute_Translation_Transform(&Local_Trans, Local_Vector);
@@ -555,7 +555,7 @@ void Parser::Parse_Obj (Mesh* mesh)
     if (fullyTextured)
         mesh->Type |= TEXTURED_OBJECT;
 
-    mesh->Data = reinterpret_cast<MESH_DATA *>(POV_MALLOC(sizeof(MESH_DATA), "triangle mesh data"));
+    mesh->Data = new MESH_DATA();
     mesh->Data->References = 1;
     mesh->Data->Tree = nullptr;
 
@@ -43,9 +43,12 @@
 #include "parser/parser.h"
 
 // C++ variants of C standard header files
-//  (none at the moment)
+#include <cstdint>
+#include <cstring>
 
 // C++ standard header files
+#include <algorithm>
+#include <functional>
 #include <limits>
 
 // POV-Ray header files (base module)
@@ -60,6 +63,8 @@
 #include "core/scene/scenedata.h"
 
 // POV-Ray header files (parser module)
+#include "parser/datafilereader.h"
+#include "parser/filetokencache.h"
 #include "parser/scanner.h"
 #include "parser/rawtokenizer.h"
 
@@ -325,6 +330,42 @@ void Parser::Get_Token ()
         while (mToken.ungetRaw);
     }
 
+    if ((mpStaticObjectCache != nullptr) && !Skipping)
+    {
+        switch (CurrentTrueTokenId())
+        {
+            case CLOCK_TOKEN:
+            case NOW_TOKEN:
+            case FILE_EXISTS_TOKEN:
+                mFrameDependent = true;
+                break;
+
+            case RAND_TOKEN:
+                // Once the number of random numbers drawn depends on the frame, so do all
+                // random numbers drawn thereafter.
+                if (mFrameDependent || Cond_Stack.back().frameDependent)
+                    mRandomSequenceFrameDependent = true;
+                if (mRandomSequenceFrameDependent)
+                    mFrameDependent = true;
+                // The random number generator advances with every number drawn, so we must not
+                // skip the statement in later frames.
+                mNotReusable = true;
+                break;
+
+            case FUNCTION_TOKEN:
+            case FUNCT_ID_TOKEN:
+            case VECTFUNCT_ID_TOKEN:
+            case ISOSURFACE_TOKEN:
+            case PARAMETRIC_TOKEN:
+            case TEXT_TOKEN:
+                mNotReusable = true;
+                break;
+
+            default:
+                break;
+        }
+    }
+
     mTokenCount++;
     mTokensSinceLastProgressReport++;
 
@@ -404,6 +445,9 @@ void Parser::Read_Symbol(const RawToken& rawToken)
     int pseudoDictionary = -1;
     RawToken nextRawToken;
     bool haveNextRawToken;
+    SymbolHash rootSymbolHash = rawToken.symbolHash;
+    bool parameterRef = false;
+    bool trackSymbol = (mpStaticObjectCache != nullptr) && !Skipping && !parseRawIdentifiers;
 
     if (rawToken.isReservedWord && !parseRawIdentifiers)
     {
@@ -444,7 +488,10 @@ void Parser::Read_Symbol(const RawToken& rawToken)
         else
         {
             /* See if it's a previously declared identifier. */
-            Temp_Entry = mSymbolStack.Find_Symbol(rawToken.lexeme.text.c_str(), &Local_Index);
+#if POV_PARSER_DEBUG
+            POV_PARSER_ASSERT(rawToken.symbolHash == GetSymbolHash(rawToken.lexeme.text.c_str()));
+#endif
+            Temp_Entry = mSymbolStack.Find_Symbol(rawToken.lexeme.text.c_str(), rawToken.symbolHash, &Local_Index);
             if (Temp_Entry != nullptr)
             {
                 if (Temp_Entry->deprecated && !Temp_Entry->deprecatedShown)
@@ -456,6 +503,8 @@ void Parser::Read_Symbol(const RawToken& rawToken)
                 if ((Temp_Entry->Token_Number==MACRO_ID_TOKEN) && (!Inside_Ifdef))
                 {
                     mToken.Data = Temp_Entry->Data;
+                    if (trackSymbol)
+                        NoteSymbolRead(rootSymbolHash);
                     if (IsOkToDeclare())
                     {
                         Invoke_Macro();
@@ -567,6 +616,7 @@ void Parser::Read_Symbol(const RawToken& rawToken)
                             haveNextRawToken = PeekRawToken(nextRawToken);
 
                             SymbolTable* parentTable = table;
+                            bool pseudoDictionaryElement = (pseudoDictionary >= 0);
                             if (pseudoDictionary >= 0)
                             {
                                 table = mSymbolStack.GetTable(pseudoDictionary);
@@ -607,7 +657,9 @@ void Parser::Read_Symbol(const RawToken& rawToken)
                                 if (mToken.GetTrueTokenId() != IDENTIFIER_TOKEN)
                                     Expectation_Error ("dictionary element identifier");
 
-                                Temp_Entry = table->Find_Symbol (CurrentTokenText().c_str());
+                                Temp_Entry = table->Find_Symbol (CurrentTokenText().c_str(), mToken.raw.symbolHash);
+                                if (pseudoDictionaryElement)
+                                    rootSymbolHash = mToken.raw.symbolHash;
                             }
                             else if (haveNextRawToken && (nextRawToken.lexeme.category == Lexeme::kOther) && (nextRawToken.lexeme.text == "["))
                             {
@@ -622,6 +674,8 @@ void Parser::Read_Symbol(const RawToken& rawToken)
                                 Parse_Square_End();
 
                                 Temp_Entry = table->Find_Symbol (dictIndex);
+                                if (pseudoDictionaryElement)
+                                    rootSymbolHash = GetSymbolHash(dictIndex);
                             }
                             else
                             {
@@ -656,6 +710,7 @@ void Parser::Read_Symbol(const RawToken& rawToken)
                                 POV_FREE(dictIndex);
 
                             Par = reinterpret_cast<POV_PARAM *>(Temp_Entry->Data);
+                            parameterRef = true;
                             mToken.SetTokenId(*(Par->NumberPtr));
                             mToken.is_array_elem        = false;
                             mToken.is_mixed_array_elem  = false;
@@ -677,12 +732,23 @@ void Parser::Read_Symbol(const RawToken& rawToken)
                 mToken.Data = *(mToken.DataPtr);
             mToken.context = Local_Index;
             if (dictIndex != nullptr)
+            {
                 mToken.raw.lexeme.text = dictIndex;
+                mToken.raw.symbolHash = GetSymbolHash(dictIndex);
+            }
+            mToken.rootSymbolHash = rootSymbolHash;
+            mToken.is_parameter_ref = parameterRef;
+            if (trackSymbol)
+                NoteSymbolRead(rootSymbolHash);
             return;
         }
     }
 
     Write_Token (IDENTIFIER_TOKEN, rawToken);
+    mToken.rootSymbolHash = rootSymbolHash;
+    mToken.is_parameter_ref = false;
+    if (trackSymbol)
+        NoteSymbolRead(rootSymbolHash);
 }
 
 inline void Parser::Write_Token(const RawToken& rawToken, SymbolTable* table)
@@ -858,6 +924,12 @@ void Parser::SetInputStream(const shared_ptr<IStream>& stream)
     mToken.sourceFile = mTokenizer.GetInputStream();
 }
 
+void Parser::SetInputStream(const shared_ptr<IStream>& stream, RawTokenSequencePtr pTokens)
+{
+    mTokenizer.SetInputStream(stream, pTokens);
+    mToken.sourceFile = mTokenizer.GetInputStream();
+}
+
 RawTokenizer::HotBookmark Parser::GetHotBookmark()
 {
     return mTokenizer.GetHotBookmark();
@@ -958,6 +1030,7 @@ void Parser::Parse_Directive()
     COND_TYPE Curr_Type = Cond_Stack.back().Cond_Type;
     LexemePosition hashPosition = CurrentFilePosition();
 
+    ++mDirectiveCount;
     Parsing_Directive = true;
 
     EXPECT_ONE
@@ -1323,6 +1396,7 @@ void Parser::Parse_Directive()
                     {
                         Error("Unable to seek in input file for #while directive.");
                     }
+                    ++Cond_Stack.back().context;
 
                     Value=Parse_Cond_Param();
 
@@ -1344,6 +1418,7 @@ void Parser::Parse_Directive()
                     {
                         Error("Unable to seek in input file for #for directive.");
                     }
+                    ++Cond_Stack.back().context;
 
                     {
                         SYM_ENTRY* Entry = mSymbolStack.GetLocalTable()->Find_Symbol(Cond_Stack.back().Loop_Identifier.c_str());
@@ -1561,6 +1636,7 @@ void Parser::Parse_Directive()
             {
                 POV_EXPERIMENTAL_ASSERT(IsOkToDeclare());
                 SetOkToDeclare(false);
+                bool outerFrameDependent = BeginFrameDependencyScope();
                 EXPECT_ONE
                     CASE (IDENTIFIER_TOKEN)
                         Warning("Attempt to undef unknown identifier");
@@ -1592,6 +1668,10 @@ void Parser::Parse_Directive()
                         Parse_Error(IDENTIFIER_TOKEN);
                     END_CASE
                 END_EXPECT
+                if (EndFrameDependencyScope(outerFrameDependent) || Cond_Stack.back().frameDependent)
+                    MarkSymbolFrameDependent(mToken.rootSymbolHash);
+                if (mToken.is_parameter_ref)
+                    DisableObjectReuse();
                 SetOkToDeclare(true);
             }
         END_CASE
@@ -1608,6 +1688,8 @@ void Parser::Parse_Directive()
                 Inside_MacroDef=true;
                 PMac=Parse_Macro();
                 Inside_MacroDef=false;
+                if (Cond_Stack.back().frameDependent && (PMac != nullptr))
+                    MarkSymbolFrameDependent(GetSymbolHash(PMac->Macro_Name));
             }
             Cond_Stack.back().Cond_Type = DECLARING_MACRO_COND;
             Cond_Stack.back().PMac      = PMac;
@@ -1680,6 +1762,7 @@ void Parser::Parse_Version()
         sceneData->languageVersionLate = true;
     POV_EXPERIMENTAL_ASSERT(IsOkToDeclare());
     SetOkToDeclare(false);
+    bool outerFrameDependent = BeginFrameDependencyScope();
     bool wasParsingVersionDirective = parsingVersionDirective;
     parsingVersionDirective = true;
     if (AllowToken(UNOFFICIAL_TOKEN))
@@ -1755,6 +1838,10 @@ void Parser::Parse_Version()
         Error("Your scene file requires POV-Ray version %g or later!\n", (DBL)(sceneData->EffectiveLanguageVersion() / 100.0));
     }
 
+    // The language version affects how subsequent statements are parsed.
+    if (EndFrameDependencyScope(outerFrameDependent) || Cond_Stack.back().frameDependent)
+        DisableObjectReuse();
+
     SetOkToDeclare(true);
     parsingVersionDirective = wasParsingVersionDirective;
 }
@@ -1766,9 +1853,12 @@ void Parser::Open_Include()
     char *asciiFileName;
     UCS2String formalFileName; // Name the file is known by to the user.
 
+    bool outerFrameDependent = BeginFrameDependencyScope();
     asciiFileName = Parse_C_String(true);
     formalFileName = SysToUCS2String(asciiFileName);
     POV_FREE(asciiFileName);
+    if (EndFrameDependencyScope(outerFrameDependent) || Cond_Stack.back().frameDependent)
+        DisableObjectReuse();
 
     IncludeHeader(formalFileName);
 }
@@ -1805,6 +1895,7 @@ void Parser::Skip_Tokens(COND_TYPE cond)
 void Parser::Break()
 {
     int Prev_Skip = Skipping;
+    bool frameDependent = Cond_Stack.back().frameDependent;
 
     Skipping=true;
 
@@ -1822,6 +1913,11 @@ void Parser::Break()
     if (Cond_Stack.size() == 1)
         Error ("Invalid context for #break");
 
+    // Leaving a loop or macro early may affect identifiers assigned in there, even though the
+    // assignments themselves don't depend on the frame.
+    if (frameDependent && (Cond_Stack.back().Cond_Type != CASE_TRUE_COND))
+        DisableObjectReuse();
+
     if (Cond_Stack.back().Cond_Type == INVOKING_MACRO_COND)
     {
         Skipping=Prev_Skip;
@@ -1977,8 +2073,13 @@ void Parser::Invoke_Macro()
     SYM_ENTRY **Table_Entries = nullptr;
     int i,Local_Index;
 
+    ++mDirectiveCount;
     Inc_CS_Index();
 
+    if (mpStaticObjectCache != nullptr)
+        // Tell apart the object statements in the macro body by call site.
+        Cond_Stack.back().context = std::hash<UCS2String>()(mToken.GetFileName()) * 31 + size_t(mToken.GetOffset());
+
     if (PMac == nullptr)
     {
         if (mToken.DataPtr != nullptr)
@@ -2008,7 +2109,14 @@ void Parser::Invoke_Macro()
         {
             bool finalParameter = (i == PMac->parameters.size()-1);
             Table_Entries[i] = SymbolTable::Create_Entry (PMac->parameters[i].name, IDENTIFIER_TOKEN);
-            if (!Parse_RValue(IDENTIFIER_TOKEN, &(Table_Entries[i]->Token_Number), &(Table_Entries[i]->Data), nullptr, true, false, true, true, true, Local_Index))
+            bool outerFrameDependent = BeginFrameDependencyScope();
+            bool outerNotReusable = BeginReuseScope();
+            bool haveValue = Parse_RValue(IDENTIFIER_TOKEN, &(Table_Entries[i]->Token_Number), &(Table_Entries[i]->Data), nullptr, true, false, true, true, true, Local_Index);
+            if (EndFrameDependencyScope(outerFrameDependent))
+                MarkSymbolFrameDependent(GetSymbolHash(PMac->parameters[i].name));
+            if (EndReuseScope(outerNotReusable))
+                MarkSymbolNotReusable(GetSymbolHash(PMac->parameters[i].name));
+            if (!haveValue)
             {
                 EXPECT_ONE
                     CASE (IDENTIFIER_TOKEN)
@@ -2377,12 +2485,17 @@ void Parser::Parse_Fopen(void)
     Entry = mSymbolStack.GetGlobalTable()->Add_Symbol (CurrentTokenText(), FILE_ID_TOKEN);
     Entry->Data=reinterpret_cast<void *>(New);
 
+    bool outerFrameDependent = BeginFrameDependencyScope();
     asciiFileName = Parse_C_String(true);
     fileName = SysToUCS2String(asciiFileName);
     POV_FREE(asciiFileName);
+    bool fileNameFrameDependent = EndFrameDependencyScope(outerFrameDependent);
 
     EXPECT_ONE
         CASE(READ_TOKEN)
+            // We presume that data files don't change between frames, unless written by the scene.
+            if ((mpStaticObjectCache != nullptr) && (fileNameFrameDependent || mpStaticObjectCache->WasWrittenFile(fileName)))
+                DisableObjectReuse();
             New->inTokenizer = std::make_shared<RawTokenizer>();
             rfile = Locate_File(fileName.c_str(), POV_File_Text_User, ign, true);
             if (rfile != nullptr)
@@ -2392,6 +2505,8 @@ void Parser::Parse_Fopen(void)
         END_CASE
 
         CASE(WRITE_TOKEN)
+            if (mpStaticObjectCache != nullptr)
+                mpStaticObjectCache->NoteWrittenFile(fileName);
             wfile = CreateFile(fileName.c_str(), POV_File_Text_User, false);
             if (wfile != nullptr)
                 New->Out_File = std::make_shared<OTextStream>(fileName.c_str(), wfile);
@@ -2403,6 +2518,8 @@ void Parser::Parse_Fopen(void)
         END_CASE
 
         CASE(APPEND_TOKEN)
+            if (mpStaticObjectCache != nullptr)
+                mpStaticObjectCache->NoteWrittenFile(fileName);
             wfile = CreateFile(fileName.c_str(), POV_File_Text_User, true);
             if (wfile != nullptr)
                 New->Out_File = std::make_shared<OTextStream>(fileName.c_str(), wfile);
@@ -2453,6 +2570,7 @@ void Parser::Parse_Read()
     SYM_ENTRY *Temp_Entry;
     int End_File=false;
     char *File_Id;
+    TokenId Binary_Format;
 
     Parse_Paren_Begin();
 
@@ -2508,6 +2626,32 @@ void Parser::Parse_Read()
             }
         END_CASE
 
+        CASE (ARRAY_ID_TOKEN)
+            if (!End_File)
+            {
+                End_File = Parse_Read_Array (User_File, CurrentTokenDataPtr<POV_ARRAY*>(), NOT_A_TOKEN);
+                mToken.is_array_elem = false;
+                mToken.is_mixed_array_elem = false;
+                mToken.is_dictionary_elem = false;
+                Parse_Comma(); /* Scene file comma between 2 idents */
+            }
+        END_CASE
+
+        CASE5 (SINT8_TOKEN,SINT16BE_TOKEN,SINT16LE_TOKEN,SINT32BE_TOKEN,SINT32LE_TOKEN)
+        CASE3 (UINT8_TOKEN,UINT16BE_TOKEN,UINT16LE_TOKEN)
+        CASE4 (FLOAT32BE_TOKEN,FLOAT32LE_TOKEN,FLOAT64BE_TOKEN,FLOAT64LE_TOKEN)
+            Binary_Format = CurrentTrueTokenId();
+            GET (ARRAY_ID_TOKEN)
+            if (!End_File)
+            {
+                End_File = Parse_Read_Array (User_File, CurrentTokenDataPtr<POV_ARRAY*>(), Binary_Format);
+                mToken.is_array_elem = false;
+                mToken.is_mixed_array_elem = false;
+                mToken.is_dictionary_elem = false;
+                Parse_Comma(); /* Scene file comma between 2 idents */
+            }
+        END_CASE
+
         CASE(COMMA_TOKEN)
             if (!End_File)
             {
@@ -2664,6 +2808,122 @@ bool Parser::Parse_Read_Float_Value(DBL& val, DATA_FILE* User_File)
     }
 }
 
+int Parser::Parse_Read_Array(DATA_FILE *User_File, POV_ARRAY *a, TokenId Format)
+{
+    DataFileReader::BinaryFormat binaryFormat;
+    bool binary = true;
+    RawTokenizer::HotBookmark position;
+    EXPRESS Express;
+    int numComponents = 0;
+    TokenId previous;
+    size_t count;
+    bool End_File = true;
+
+    switch (Format)
+    {
+        case SINT8_TOKEN:       binaryFormat = { 1, false, true,  false }; break;
+        case UINT8_TOKEN:       binaryFormat = { 1, false, false, false }; break;
+        case SINT16BE_TOKEN:    binaryFormat = { 2, true,  true,  false }; break;
+        case SINT16LE_TOKEN:    binaryFormat = { 2, false, true,  false }; break;
+        case UINT16BE_TOKEN:    binaryFormat = { 2, true,  false, false }; break;
+        case UINT16LE_TOKEN:    binaryFormat = { 2, false, false, false }; break;
+        case SINT32BE_TOKEN:    binaryFormat = { 4, true,  true,  false }; break;
+        case SINT32LE_TOKEN:    binaryFormat = { 4, false, true,  false }; break;
+        case FLOAT32BE_TOKEN:   binaryFormat = { 4, true,  true,  true  }; break;
+        case FLOAT32LE_TOKEN:   binaryFormat = { 4, false, true,  true  }; break;
+        case FLOAT64BE_TOKEN:   binaryFormat = { 8, true,  true,  true  }; break;
+        case FLOAT64LE_TOKEN:   binaryFormat = { 8, false, true,  true  }; break;
+        default:                binary = false; break;
+    }
+
+    if (a == nullptr)
+        Error("Attempt to access uninitialized nested array.");
+
+    // Pick up where the tokenizer left off, including any token it has already
+    // looked at but not yet handed to us.
+    position = User_File->inTokenizer->GetHotBookmark();
+    if (User_File->inUngetToken)
+    {
+        static_cast<LexemePosition&>(position) = User_File->inToken.lexeme.position;
+        User_File->inUngetToken = false;
+    }
+
+    {
+        DataFileReader reader(position);
+        size_t size = (a->resizable ? SIZE_MAX : a->DataPtrs.size());
+
+        for (count = 0; count < size; ++count)
+        {
+            if (binary)
+                numComponents = reader.ReadBinaryValue(Express[0], binaryFormat);
+            else
+                numComponents = reader.ReadTextValue(Express);
+
+            if (numComponents < 0)
+                Error(SourceInfo(User_File->inTokenizer->GetInputStreamName(), reader.GetErrorPosition()), "%s", reader.GetErrorMessage());
+            if (numComponents == 0)
+                break;
+
+            if (count == a->DataPtrs.size())
+                a->Grow();
+
+            TokenId& elementType = a->ElementType(count);
+            void*& elementData = a->DataPtrs[count];
+            previous = elementType;
+
+            switch (numComponents)
+            {
+                case 1:
+                    elementType = FLOAT_ID_TOKEN;
+                    Test_Redefine(previous, &elementType, elementData, a->mixedType);
+                    elementData = reinterpret_cast<void *>(Create_Float());
+                    *(reinterpret_cast<DBL *>(elementData)) = Express[0];
+                    break;
+
+                case 2:
+                    elementType = UV_ID_TOKEN;
+                    Test_Redefine(previous, &elementType, elementData, a->mixedType);
+                    elementData = reinterpret_cast<void *>(new Vector2d(Express));
+                    break;
+
+                case 3:
+                    elementType = VECTOR_ID_TOKEN;
+                    Test_Redefine(previous, &elementType, elementData, a->mixedType);
+                    elementData = reinterpret_cast<void *>(new Vector3d(Express));
+                    break;
+
+                case 4:
+                    elementType = VECTOR_4D_ID_TOKEN;
+                    Test_Redefine(previous, &elementType, elementData, a->mixedType);
+                    elementData = reinterpret_cast<void *>(Create_Vector_4D());
+                    Assign_Vector_4D(reinterpret_cast<DBL *>(elementData), Express);
+                    break;
+
+                case 5:
+                    elementType = COLOUR_ID_TOKEN;
+                    Test_Redefine(previous, &elementType, elementData, a->mixedType);
+                    elementData = reinterpret_cast<void *>(Create_Colour());
+                    (*reinterpret_cast<RGBFTColour *>(elementData)).Set(Express, 5);
+                    break;
+
+                default:
+                    POV_PARSER_PANIC();
+                    break;
+            }
+        }
+
+        if (numComponents != 0)
+            End_File = reader.AtEnd(binary);
+        position = reader.GetHotBookmark();
+    }
+
+    // Have the tokenizer resume after the data we have consumed.
+    if (!End_File && !User_File->inTokenizer->GoToBookmark(position))
+        Error(SourceInfo(User_File->inTokenizer->GetInputStreamName(), position), "Cannot resume reading after bulk data.");
+
+    return End_File;
+}
+
 void Parser::Parse_Write(void)
 {
     char *temp;
@@ -2690,11 +2950,13 @@ void Parser::Parse_Write(void)
     EXPECT_CAT
         CASE5 (SINT8_TOKEN,SINT16BE_TOKEN,SINT16LE_TOKEN,SINT32BE_TOKEN,SINT32LE_TOKEN)
         CASE3 (UINT8_TOKEN,UINT16BE_TOKEN,UINT16LE_TOKEN)
+        CASE4 (FLOAT32BE_TOKEN,FLOAT32LE_TOKEN,FLOAT64BE_TOKEN,FLOAT64LE_TOKEN)
             {
-                POV_INT32 val_min;
-                POV_INT32 val_max;
+                POV_INT32 val_min = 0;
+                POV_INT32 val_max = 0;
                 int  num_bytes;
                 bool big_endian = false;
+                bool is_float = false;
                 switch (CurrentTrueTokenId())
                 {
                     case SINT8_TOKEN:    val_min = SIGNED8_MIN;  val_max = SIGNED8_MAX;    num_bytes = 1; break;
@@ -2705,6 +2967,10 @@ void Parser::Parse_Write(void)
                     case UINT16LE_TOKEN: val_min = 0;            val_max = UNSIGNED16_MAX; num_bytes = 2; big_endian = false; break;
                     case SINT32BE_TOKEN: val_min = SIGNED32_MIN; val_max = SIGNED32_MAX;   num_bytes = 4; big_endian = true;  break;
                     case SINT32LE_TOKEN: val_min = SIGNED32_MIN; val_max = SIGNED32_MAX;   num_bytes = 4; big_endian = false; break;
+                    case FLOAT32BE_TOKEN: num_bytes = 4; big_endian = true;  is_float = true; break;
+                    case FLOAT32LE_TOKEN: num_bytes = 4; big_endian = false; is_float = true; break;
+                    case FLOAT64BE_TOKEN: num_bytes = 8; big_endian = true;  is_float = true; break;
+                    case FLOAT64LE_TOKEN: num_bytes = 8; big_endian = false; is_float = true; break;
                 }
                 EXPECT_CAT
                     CASE_VECTOR_UNGET
@@ -2713,13 +2979,25 @@ void Parser::Parse_Write(void)
                         {
                             for (int i = 0; i < Terms; i ++)
                             {
-                                signed long val;
-                                if (Express[i] <= val_min)
-                                    val = val_min; // TODO - maybe we should warn the user
+                                std::uint64_t val;
+                                if (is_float && (num_bytes == 4))
+                                {
+                                    float f = float(Express[i]);
+                                    std::uint32_t bits;
+                                    std::memcpy(&bits, &f, 4);
+                                    val = bits;
+                                }
+                                else if (is_float)
+                                {
+                                    double d = double(Express[i]);
+                                    std::memcpy(&val, &d, 8);
+                                }
+                                else if (Express[i] <= val_min)
+                                    val = std::uint64_t(std::int64_t(val_min)); // TODO - maybe we should warn the user
                                 else if (Express[i] >= val_max)
-                                    val = val_max; // TODO - maybe we should warn the user
+                                    val = std::uint64_t(std::int64_t(val_max)); // TODO - maybe we should warn the user
                                 else
-                                    val = (signed long)(floor(Express[i]+0.5));
+                                    val = std::uint64_t(std::int64_t(floor(Express[i]+0.5)));
                                 for (int j = 0; j < num_bytes; j ++)
                                 {
                                     int bitShift = (big_endian? (num_bytes-1)-j : j) * 8;
@@ -2817,7 +3095,10 @@ DBL Parser::Parse_Cond_Param(void)
     SetOkToDeclare(false);
     Skipping      = false;
 
+    bool outerFrameDependent = BeginFrameDependencyScope();
     Val=Parse_Float_Param();
+    if (EndFrameDependencyScope(outerFrameDependent))
+        Cond_Stack.back().frameDependent = true;
 
     SetOkToDeclare(oldOkToDeclare);
     Skipping      = Old_Sk;
@@ -2833,7 +3114,10 @@ void Parser::Parse_Cond_Param2(DBL *V1,DBL *V2)
     SetOkToDeclare(false);
     Skipping      = false;
 
+    bool outerFrameDependent = BeginFrameDependencyScope();
     Parse_Float_Param2(V1,V2);
+    if (EndFrameDependencyScope(outerFrameDependent))
+        Cond_Stack.back().frameDependent = true;
 
     SetOkToDeclare(oldOkToDeclare);
     Skipping      = Old_Sk;
@@ -2841,7 +3125,83 @@ void Parser::Parse_Cond_Param2(DBL *V1,DBL *V2)
 
 void Parser::Inc_CS_Index()
 {
+    // Nested conditionals and loops inherit any dependency on the frame.
+    bool frameDependent = (!Cond_Stack.empty() && Cond_Stack.back().frameDependent);
     Cond_Stack.emplace_back();
+    Cond_Stack.back().frameDependent = frameDependent;
+}
+
+//******************************************************************************
+
+bool Parser::BeginFrameDependencyScope()
+{
+    bool outerFrameDependent = mFrameDependent;
+    mFrameDependent = false;
+    return outerFrameDependent;
+}
+
+bool Parser::EndFrameDependencyScope(bool outerFrameDependent)
+{
+    bool frameDependent = mFrameDependent;
+    mFrameDependent = frameDependent || outerFrameDependent;
+    return frameDependent;
+}
+
+bool Parser::BeginReuseScope()
+{
+    bool outerNotReusable = mNotReusable;
+    mNotReusable = false;
+    return outerNotReusable;
+}
+
+bool Parser::EndReuseScope(bool outerNotReusable)
+{
+    bool notReusable = mNotReusable;
+    mNotReusable = notReusable || outerNotReusable;
+    return notReusable;
+}
+
+void Parser::NoteSymbolRead(SymbolHash hash)
+{
+    if (mFrameDependentSymbols.find(hash) != mFrameDependentSymbols.end())
+        mFrameDependent = true;
+
+    // Values containing functions refer to the current frame's function VM.
+    if (mNotReusableSymbols.find(hash) != mNotReusableSymbols.end())
+        mNotReusable = true;
+
+    if (maStaticStatementSymbols.empty())
+        return;
+
+    std::vector<SymbolHash>& symbols = maStaticStatementSymbols.back();
+    if (!symbols.empty() && (symbols.back() == hash))
+        return;
+    if ((symbols.size() == symbols.capacity()) && (symbols.size() >= 256))
+    {
+        // Loops may read the same few symbols over and over again; weed out duplicates
+        // before growing the list.
+        std::sort(symbols.begin(), symbols.end());
+        symbols.erase(std::unique(symbols.begin(), symbols.end()), symbols.end());
+    }
+    symbols.push_back(hash);
+}
+
+void Parser::MarkSymbolFrameDependent(SymbolHash hash)
+{
+    if (mpStaticObjectCache != nullptr)
+        mFrameDependentSymbols.insert(hash);
+}
+
+void Parser::MarkSymbolNotReusable(SymbolHash hash)
+{
+    if (mpStaticObjectCache != nullptr)
+        mNotReusableSymbols.insert(hash);
+}
+
+void Parser::DisableObjectReuse()
+{
+    mObjectReuseDisabled = true;
+    mNotReusable = true;
 }
 
 bool Parser::Parse_Ifdef_Param ()
@@ -2850,9 +3210,12 @@ bool Parser::Parse_Ifdef_Param ()
 
     Parse_Paren_Begin();
 
+    bool outerFrameDependent = BeginFrameDependencyScope();
     Inside_Ifdef=true;
     Get_Token();
     Inside_Ifdef=false;
+    if (EndFrameDependencyScope(outerFrameDependent))
+        Cond_Stack.back().frameDependent = true;
 
     if (mToken.is_array_elem)
         retval = (*mToken.DataPtr != nullptr);
@@ -2871,6 +3234,7 @@ int Parser::Parse_For_Param (UTF8String& identifierName, DBL* EndPtr, DBL* StepP
 
     Parse_Paren_Begin();
 
+    bool outerFrameDependent = BeginFrameDependencyScope();
     LValue_Ok = true;
 
     EXPECT_ONE
@@ -2957,6 +3321,12 @@ int Parser::Parse_For_Param (UTF8String& identifierName, DBL* EndPtr, DBL* StepP
     if (fabs(*StepPtr) < EPSILON)
         Error ("#for loop increment must be non-zero.");
 
+    if (EndFrameDependencyScope(outerFrameDependent) || Cond_Stack.back().frameDependent)
+    {
+        Cond_Stack.back().frameDependent = true;
+        MarkSymbolFrameDependent(GetSymbolHash(identifierName.c_str()));
+    }
+
     Parse_Paren_End();
 
     return ((*StepPtr > 0) && (*CurrentPtr < *EndPtr + EPSILON)) ||
@@ -2972,13 +3342,19 @@ void Parser::IncludeHeader(const UCS2String& formalFileName)
     if (formalFileName.empty())
         return;
 
+    // We presume that include files don't change between frames, unless written by the scene.
+    if ((mpStaticObjectCache != nullptr) && mpStaticObjectCache->WasWrittenFile(formalFileName))
+        DisableObjectReuse();
+
     maIncludeStack.emplace_back(mTokenizer.GetHotBookmark(), int(Cond_Stack.size()), int(maBraceStack.size()));
 
     shared_ptr<IStream> is = Locate_File (formalFileName.c_str(),POV_File_Text_INC,actualFileName,true);
     if (is == nullptr)
         Error ("Cannot open include file %s.", UCS2toSysString(formalFileName).c_str());
 
-    SetInputStream(is);
+    // Use the file's pre-tokenized content if we can; this also discards any
+    // tokens cached from an earlier version of the file.
+    SetInputStream(is, FileTokenCache::Get(is, sceneData->includeCachePath, sceneData->includeCacheMaxFileSize));
 
     mSymbolStack.PushTable();
 
@@ -53,6 +53,24 @@
 namespace pov_parser
 {
 
+SymbolHash GetSymbolHash(const char* name)
+{
+    // FNV-1a, followed by a final mixing step so that the low-order bits
+    // (which are all a power-of-two sized hash table cares about) depend on
+    // every single character.
+    std::uint32_t hash = 2166136261u;
+    for (const unsigned char* p = reinterpret_cast<const unsigned char*>(name); *p != '\0'; ++p)
+        hash = (hash ^ *p) * 16777619u;
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+//******************************************************************************
+
 LexemePosition::LexemePosition() : SourcePosition(1, 1, 0)
 {}
 
@@ -128,5 +146,9 @@ InvalidEscapeSequenceException::InvalidEscapeSequenceException(const UCS2String&
     offendingText(otb, ote)
 {}
 
+InputSeekException::InputSeekException(const UCS2String& osn, const LexemePosition& op) :
+    TokenizerException(osn, op)
+{}
+
 }
 // end of namespace pov_parser
@@ -40,7 +40,7 @@
 #include "parser/configparser.h"
 
 // C++ variants of C standard header files
-//  (none at the moment)
+#include <cstdint>
 
 // C++ standard header files
 #include <memory>
@@ -70,6 +70,20 @@ using ConstStreamPtr = std::shared_ptr<const pov_base::IStream>;
 
 //------------------------------------------------------------------------------
 
+/// Hash value of an identifier name, as used to look up symbols.
+using SymbolHash = std::uint32_t;
+
+/// Compute the hash value of an identifier name.
+///
+/// @note
+///     The @ref RawTokenizer computes this value only once for each distinct
+///     word, and passes it along with every identifier token, so that symbol
+///     lookups need not hash the name over and over again.
+///
+SymbolHash GetSymbolHash(const char* name);
+
+//------------------------------------------------------------------------------
+
 struct LexemePosition : pov::SourcePosition
 {
     LexemePosition();
@@ -182,6 +196,18 @@ struct InvalidEscapeSequenceException final : TokenizerException
                                    const UTF8String::const_iterator& otb, const UTF8String::const_iterator& ote);
 };
 
+/// Failure to reposition within input file.
+///
+/// This exception is thrown by @ref RawTokenizer to indicate that, after
+/// replaying cached tokens, the @ref Scanner could not be brought up to the
+/// position of the last token replayed, implying that the input file can no
+/// longer be read.
+///
+struct InputSeekException final : TokenizerException
+{
+    InputSeekException(const UCS2String& osn, const LexemePosition& op);
+};
+
 //------------------------------------------------------------------------------
 
 /// Base class for miscellaneous things that can be assigned to a symbol.
@@ -198,7 +224,13 @@ struct ParserOptions final
     bool    useClock;
     DBL     clock;
     size_t  randomSeed;
-    ParserOptions(bool uc, DBL c, size_t rs) : useClock(uc), clock(c), randomSeed(rs) {}
+    bool    reuseStaticObjects;     ///< Whether to re-use static objects across the frames of an animation.
+    bool    continuedAnimation;     ///< Whether the frame continues the animation of the previously parsed frame.
+    bool    lastAnimationFrame;     ///< Whether no more frames of the animation are to follow.
+    ParserOptions(bool uc, DBL c, size_t rs) :
+        useClock(uc), clock(c), randomSeed(rs),
+        reuseStaticObjects(false), continuedAnimation(false), lastAnimationFrame(true)
+    {}
 };
 
 //------------------------------------------------------------------------------
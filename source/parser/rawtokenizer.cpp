@@ -37,7 +37,10 @@
 #include "parser/rawtokenizer.h"
 
 // C++ variants of C standard header files
+#include <cstdint>
+
 // C++ standard header files
+#include <algorithm>
 
 // POV-Ray header files (base module)
 #include "base/fileinputoutput.h"
@@ -93,14 +96,84 @@ TokenId RawToken::GetTokenId() const
 RawTokenizer::KnownWordInfo::KnownWordInfo() :
     id(int(NOT_A_TOKEN)),
     expressionId(NOT_A_TOKEN),
+    symbolHash(0),
     isReservedWord(false),
     isPseudoIdentifier(false)
 {}
 
+RawTokenizer::CachedTokenRun::CachedTokenRun() :
+    visits(0)
+{}
+
+//******************************************************************************
+
+RawTokenSequence::RawTokenSequence() :
+    characterEncoding(nullptr),
+    nominalEndOfLine('\0'),
+    allowNestedBlockComments(true)
+{}
+
+void RawTokenSequence::Reset(const Scanner::Bookmark& start)
+{
+    tokens.clear();
+    ends.clear();
+    position = start;
+    characterEncoding = start.characterEncoding;
+    nominalEndOfLine = start.nominalEndOfLine;
+    allowNestedBlockComments = start.allowNestedBlockComments;
+}
+
+void RawTokenSequence::Append(const RawToken& token, const Scanner::Bookmark& end)
+{
+    tokens.push_back(token);
+    ends.push_back(TokenEnd{ end, end.characterEncoding, end.nominalEndOfLine });
+}
+
+void RawTokenSequence::Truncate(size_t count)
+{
+    if (count >= tokens.size())
+        return;
+    tokens.resize(count);
+    ends.resize(count);
+}
+
+size_t RawTokenSequence::Find(const Scanner::Bookmark& bookmark) const
+{
+    if (bookmark.allowNestedBlockComments != allowNestedBlockComments)
+        return SIZE_MAX;
+
+    if (bookmark.offset == position.offset)
+        return ((bookmark.characterEncoding == characterEncoding) &&
+                (bookmark.nominalEndOfLine == nominalEndOfLine) ? 0 : SIZE_MAX);
+
+    auto i = std::lower_bound(ends.begin(), ends.end(), bookmark.offset,
+                              [](const TokenEnd& end, POV_OFF_T offset) { return end.position.offset < offset; });
+    if ((i == ends.end()) || (i->position.offset != bookmark.offset) ||
+        (i->characterEncoding != bookmark.characterEncoding) ||
+        (i->nominalEndOfLine != bookmark.nominalEndOfLine))
+        return SIZE_MAX;
+
+    return size_t(i - ends.begin()) + 1;
+}
+
+Scanner::HotBookmark RawTokenSequence::GetBookmark(const StreamPtr& pStream, size_t index) const
+{
+    if (index == 0)
+        return Scanner::HotBookmark(pStream, position, characterEncoding, nominalEndOfLine, allowNestedBlockComments);
+
+    const TokenEnd& end = ends[index - 1];
+    return Scanner::HotBookmark(pStream, end.position, end.characterEncoding, end.nominalEndOfLine, allowNestedBlockComments);
+}
+
 //******************************************************************************
 
 RawTokenizer::RawTokenizer() :
-    mNextIdentifierId(TOKEN_COUNT+1)
+    mNextIdentifierId(TOKEN_COUNT+1),
+    mCachedTokenCount(0),
+    mpReplaySequence(nullptr),
+    mpReplayStream(nullptr),
+    mReplayIndex(0),
+    mpRecordSequence(nullptr)
 {
     for (auto i = Reserved_Words; i->Token_Name != nullptr; ++i)
     {
@@ -111,6 +184,7 @@ RawTokenizer::RawTokenizer() :
         KnownWordInfo& knownWord        = mKnownWords[i->Token_Name];
         knownWord.id                    = i->Token_Number;
         knownWord.expressionId          = GetCategorizedTokenId(i->Token_Number);
+        knownWord.symbolHash            = GetSymbolHash(i->Token_Name);
         knownWord.isReservedWord        = true;
         knownWord.isPseudoIdentifier    = ((knownWord.id == GLOBAL_TOKEN) || (knownWord.id == LOCAL_TOKEN));
     }
@@ -118,26 +192,105 @@ RawTokenizer::RawTokenizer() :
 
 void RawTokenizer::SetInputStream(StreamPtr pStream)
 {
+    mpReplaySequence = nullptr;
+    mpReplayStream = nullptr;
+    mpRecordSequence = nullptr;
     mScanner.SetInputStream(pStream);
 }
 
+void RawTokenizer::SetInputStream(StreamPtr pStream, RawTokenSequencePtr pTokens)
+{
+    SetInputStream(pStream);
+    UCS2String streamName(pStream->Name());
+    ForgetCachedTokens(streamName);
+    if ((pTokens == nullptr) || (pTokens->Find(mScanner.GetHotBookmark()) != 0))
+        return;
+    mTokenizedFiles[streamName] = pTokens;
+    mpReplaySequence = pTokens.get();
+    mpReplayStream = pStream;
+    mReplayIndex = 0;
+}
+
+bool RawTokenizer::TokenizeStream(StreamPtr pStream, RawTokenSequence& tokens, size_t maxTokens)
+{
+    RawTokenizer tokenizer;
+    RawToken token;
+    tokenizer.SetInputStream(pStream);
+    tokens.Reset(tokenizer.mScanner.GetHotBookmark());
+    try
+    {
+        while (tokenizer.GetNextScannedToken(token))
+        {
+            if (token.expressionId == SIGNATURE_TOKEN_CATEGORY)
+            {
+                // Switch encoding just like the parser will (see Parser::CheckFileSignature()).
+                if ((token.id != UTF8_SIGNATURE_TOKEN) || !tokens.tokens.empty())
+                    return false;
+                tokenizer.mScanner.SetCharacterEncoding(CharacterEncodingID::kUTF8);
+            }
+            if (tokens.tokens.size() >= maxTokens)
+                return false;
+            tokens.Append(token, tokenizer.mScanner.GetHotBookmark());
+        }
+    }
+    catch (TokenizerException&)
+    {
+        return false;
+    }
+    return true;
+}
+
 void RawTokenizer::SetStringEncoding(CharacterEncodingID encoding)
 {
+    // Cached tokens may have been decoded differently, unless the sequence
+    // we're replaying has already been set up for the new encoding.
+    if ((mpReplaySequence != nullptr) &&
+        (mpReplaySequence->GetBookmark(mpReplayStream, mReplayIndex).characterEncoding == Scanner::GetCharacterEncoding(encoding)))
+        return;
+    LeaveCachedTokens();
     mScanner.SetCharacterEncoding(encoding);
 }
 
 void pov_parser::RawTokenizer::SetNestedBlockComments(bool allow)
 {
+    // Cached tokens may have been delimited differently.
+    LeaveCachedTokens();
     mScanner.SetNestedBlockComments(allow);
 }
 
 //------------------------------------------------------------------------------
 
 bool RawTokenizer::GetNextToken(RawToken& token)
+{
+    if (mpReplaySequence != nullptr)
+    {
+        if (mReplayIndex < mpReplaySequence->tokens.size())
+        {
+            token = mpReplaySequence->tokens[mReplayIndex++];
+            return true;
+        }
+        LeaveCachedTokens();
+    }
+
+    if (!GetNextScannedToken(token))
+        return false;
+
+    if (mpRecordSequence != nullptr)
+        RecordToken(token);
+
+    return true;
+}
+
+bool RawTokenizer::GetNextScannedToken(RawToken& token)
 {
     if (!mScanner.GetNextLexeme(token.lexeme))
         return false;
 
+    return ProcessLexeme(token);
+}
+
+bool RawTokenizer::ProcessLexeme(RawToken& token)
+{
     switch (token.lexeme.category)
     {
         case Lexeme::kWord:             if (ProcessWordLexeme(token))           return true;
@@ -151,6 +304,49 @@ bool RawTokenizer::GetNextToken(RawToken& token)
 
 bool RawTokenizer::GetNextDirective(RawToken& token)
 {
+    if (mpReplaySequence != nullptr)
+    {
+        // Cached sequences are complete, so any `#` lexeme the scanner
+        // would have found is sure to be among them.
+        while (mReplayIndex < mpReplaySequence->tokens.size())
+        {
+            const RawToken& cachedToken = mpReplaySequence->tokens[mReplayIndex++];
+            if (cachedToken.id == int(HASH_TOKEN))
+            {
+                token = cachedToken;
+                return true;
+            }
+        }
+        LeaveCachedTokens();
+    }
+
+    if (mpRecordSequence != nullptr)
+    {
+        // To keep the sequence contiguous, fully tokenize the section to be
+        // skipped. If that section doesn't tokenize cleanly, give up on the
+        // sequence and skip the section the conventional way.
+        HotBookmark start = mScanner.GetHotBookmark();
+        size_t recorded = mpRecordSequence->tokens.size();
+        try
+        {
+            while (mpRecordSequence != nullptr)
+            {
+                if (!GetNextScannedToken(token))
+                    return false;
+                RecordToken(token);
+                if (token.id == int(HASH_TOKEN))
+                    return true;
+            }
+        }
+        catch (TokenizerException&)
+        {
+            mCachedTokenCount -= (mpRecordSequence->tokens.size() - recorded);
+            mpRecordSequence->Truncate(recorded);
+            mpRecordSequence = nullptr;
+            mScanner.GoToBookmark(start);
+        }
+    }
+
     if (!mScanner.GetNextDirective(token.lexeme))
         return false;
 
@@ -176,9 +372,11 @@ bool RawTokenizer::ProcessWordLexeme(RawToken& token)
     {
         i.id = ++mNextIdentifierId;
         i.expressionId = IDENTIFIER_TOKEN;
+        i.symbolHash = GetSymbolHash(token.lexeme.text.c_str());
     }
     token.id = i.id;
     token.expressionId = i.expressionId;
+    token.symbolHash = i.symbolHash;
     token.value = nullptr;
     token.isReservedWord = i.isReservedWord;
     token.isPseudoIdentifier = i.isPseudoIdentifier;
@@ -443,6 +641,7 @@ bool RawTokenizer::ProcessSignatureLexeme(RawToken& token)
 
 bool RawTokenizer::GetRaw(unsigned char* buffer, size_t size)
 {
+    LeaveCachedTokens();
     return mScanner.GetRaw(buffer, size);
 }
 
@@ -450,32 +649,174 @@ bool RawTokenizer::GetRaw(unsigned char* buffer, size_t size)
 
 pov_parser::ConstStreamPtr RawTokenizer::GetInputStream() const
 {
+    if (mpReplaySequence != nullptr)
+        return mpReplayStream;
     return mScanner.GetInputStream();
 }
 
 pov_base::UCS2String RawTokenizer::GetInputStreamName() const
 {
+    if (mpReplaySequence != nullptr)
+        return mpReplayStream->Name();
     return mScanner.GetInputStreamName();
 }
 
 pov_parser::RawTokenizer::HotBookmark RawTokenizer::GetHotBookmark()
 {
+    if (mpReplaySequence != nullptr)
+        return mpReplaySequence->GetBookmark(mpReplayStream, mReplayIndex);
     return mScanner.GetHotBookmark();
 }
 
 pov_parser::RawTokenizer::ColdBookmark RawTokenizer::GetColdBookmark() const
 {
+    if (mpReplaySequence != nullptr)
+    {
+        HotBookmark bookmark = mpReplaySequence->GetBookmark(mpReplayStream, mReplayIndex);
+        return ColdBookmark(mpReplayStream->Name(), bookmark, bookmark.characterEncoding,
+                            bookmark.nominalEndOfLine, bookmark.allowNestedBlockComments);
+    }
     return mScanner.GetColdBookmark();
 }
 
 bool RawTokenizer::GoToBookmark(const HotBookmark& bookmark)
 {
-    return mScanner.GoToBookmark(bookmark);
+    return GoToBookmark(bookmark.pStream, bookmark);
 }
 
 bool RawTokenizer::GoToBookmark(const ColdBookmark& bookmark)
 {
-    return mScanner.GoToBookmark(bookmark);
+    if (bookmark.fileName != GetInputStreamName())
+        return false;
+    StreamPtr pStream = (mpReplaySequence != nullptr ? mpReplayStream : mScanner.GetHotBookmark().pStream);
+    return GoToBookmark(pStream, bookmark);
+}
+
+bool RawTokenizer::GoToBookmark(const StreamPtr& pStream, const Scanner::Bookmark& bookmark)
+{
+    mpReplaySequence = nullptr;
+    mpReplayStream = nullptr;
+    mpRecordSequence = nullptr;
+
+    UCS2String streamName(pStream->Name());
+
+    // Replay the cached tokens if we can, leaving the scanner alone until we run
+    // out of them; this saves us from having to re-fill the scanner's buffer
+    // each time we get here.
+
+    const RawTokenSequence* pSequence = nullptr;
+    size_t index = SIZE_MAX;
+    CachedTokenRun* pRun = nullptr;
+
+    auto tokenizedFile = mTokenizedFiles.find(streamName);
+    if (tokenizedFile != mTokenizedFiles.end())
+    {
+        index = tokenizedFile->second->Find(bookmark);
+        if (index != SIZE_MAX)
+            pSequence = tokenizedFile->second.get();
+    }
+    if (pSequence == nullptr)
+    {
+        pRun = VisitCachedTokens(streamName, bookmark);
+        if ((pRun != nullptr) && !pRun->sequence.tokens.empty())
+        {
+            pSequence = &pRun->sequence;
+            index = 0;
+        }
+    }
+
+    if (index != SIZE_MAX)
+    {
+        mpReplaySequence = pSequence;
+        mpReplayStream = pStream;
+        mReplayIndex = index;
+        return true;
+    }
+
+    if (!mScanner.GoToBookmark(HotBookmark(pStream, bookmark, bookmark.characterEncoding,
+                                           bookmark.nominalEndOfLine, bookmark.allowNestedBlockComments)))
+        return false;
+
+    if ((pRun != nullptr) && (mCachedTokenCount < POV_PARSER_TOKEN_CACHE_SIZE))
+        mpRecordSequence = &pRun->sequence;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+
+void RawTokenizer::ForgetCachedTokens(const UCS2String& streamName)
+{
+    auto tokenizedFile = mTokenizedFiles.find(streamName);
+    if (tokenizedFile != mTokenizedFiles.end())
+    {
+        if (tokenizedFile->second.get() == mpReplaySequence)
+            LeaveCachedTokens();
+        mTokenizedFiles.erase(tokenizedFile);
+    }
+
+    auto i = mCachedTokens.find(streamName);
+    if (i == mCachedTokens.end())
+        return;
+
+    for (auto& run : i->second)
+    {
+        if ((&run.second.sequence == mpReplaySequence) || (&run.second.sequence == mpRecordSequence))
+            LeaveCachedTokens();
+        mCachedTokenCount -= run.second.sequence.tokens.size();
+    }
+    mCachedTokens.erase(i);
+}
+
+RawTokenizer::CachedTokenRun* RawTokenizer::VisitCachedTokens(const UCS2String& streamName, const Scanner::Bookmark& bookmark)
+{
+    if (POV_PARSER_TOKEN_CACHE_SIZE == 0)
+        return nullptr;
+
+    CachedTokenRun& run = mCachedTokens[streamName][bookmark.offset];
+
+    if ((run.visits == 0) || (run.sequence.Find(bookmark) != 0))
+    {
+        // First visit, or the scanner state differs from that of earlier visits;
+        // only note the visit for now, as most positions are never revisited.
+        mCachedTokenCount -= run.sequence.tokens.size();
+        run.sequence.Reset(bookmark);
+        run.visits = 1;
+        return nullptr;
+    }
+
+    ++run.visits;
+    return &run;
+}
+
+void RawTokenizer::LeaveCachedTokens()
+{
+    mpRecordSequence = nullptr;
+
+    if (mpReplaySequence == nullptr)
+        return;
+
+    // Bring the scanner up to the position of the last replayed token.
+    HotBookmark bookmark = mpReplaySequence->GetBookmark(mpReplayStream, mReplayIndex);
+    mpReplaySequence = nullptr;
+    mpReplayStream = nullptr;
+    if (!mScanner.GoToBookmark(bookmark))
+        throw InputSeekException(bookmark.pStream->Name(), bookmark);
+}
+
+void RawTokenizer::RecordToken(const RawToken& token)
+{
+    POV_PARSER_ASSERT(mpRecordSequence != nullptr);
+
+    if ((mpRecordSequence->tokens.size() >= POV_PARSER_MAX_CACHED_TOKEN_RUN) ||
+        (mCachedTokenCount >= POV_PARSER_TOKEN_CACHE_SIZE))
+    {
+        // Keep what we have; anything beyond will be scanned conventionally.
+        mpRecordSequence = nullptr;
+        return;
+    }
+
+    mpRecordSequence->Append(token, mScanner.GetHotBookmark());
+    ++mCachedTokenCount;
 }
 
 }
@@ -43,8 +43,10 @@
 //  (none at the moment)
 
 // C++ standard header files
+#include <limits>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 // POV-Ray header files (base module)
 #include "base/stringtypes.h"
@@ -150,6 +152,12 @@ struct RawToken final
     /// _cooked tokenizer_ to carry the value of the identifier.
     ConstValuePtr value;
 
+    /// Hash value of the identifier name.
+    /// For identifiers and reserved words, this is the value computed by
+    /// @ref GetSymbolHash() from the lexeme text. For other tokens this is
+    /// undefined.
+    SymbolHash symbolHash;
+
     /// Whether the token is a reserved word.
     /// @note
     ///     This flag is _not_ set for operators.
@@ -164,6 +172,54 @@ struct RawToken final
     TokenId GetTokenId() const;
 };
 
+//------------------------------------------------------------------------------
+
+/// Structure representing a contiguous sequence of raw tokens from a stream.
+///
+/// Along with the tokens themselves, this structure holds the scanner state at
+/// the start of the sequence and after each token, so that scanning can be
+/// resumed seamlessly at any point of the sequence.
+///
+struct RawTokenSequence final
+{
+    /// Scanner state immediately after a token.
+    struct TokenEnd final
+    {
+        LexemePosition                  position;
+        Scanner::CharacterEncodingPtr   characterEncoding;
+        Scanner::Character              nominalEndOfLine;
+    };
+
+    std::vector<RawToken>           tokens;
+    std::vector<TokenEnd>           ends;
+    LexemePosition                  position;
+    Scanner::CharacterEncodingPtr   characterEncoding;
+    Scanner::Character              nominalEndOfLine;
+    bool                            allowNestedBlockComments;
+
+    RawTokenSequence();
+
+    /// Discard all tokens, and set the scanner state at the start of the sequence.
+    void Reset(const Scanner::Bookmark& start);
+
+    /// Append a token, along with the scanner state immediately after it.
+    void Append(const RawToken& token, const Scanner::Bookmark& end);
+
+    /// Discard all tokens beyond a given count.
+    void Truncate(size_t count);
+
+    /// Find the index of the token following a given position.
+    /// @return The number of tokens preceding the position, or `SIZE_MAX` if
+    ///     the position does not coincide with the start or the end of a token
+    ///     in the sequence.
+    size_t Find(const Scanner::Bookmark& bookmark) const;
+
+    /// Get the scanner state after a given number of tokens.
+    Scanner::HotBookmark GetBookmark(const StreamPtr& pStream, size_t index) const;
+};
+
+using RawTokenSequencePtr = std::shared_ptr<const RawTokenSequence>;
+
 //******************************************************************************
 
 /// Class implementing the parser's _raw tokenizer_ stage.
@@ -185,6 +241,17 @@ struct RawToken final
 /// In addition, literal lexemes are evaluated, converting their textual
 /// representation into the corresponding internal value representation.
 ///
+/// To speed up repeated execution of macro and loop bodies, the raw tokenizer
+/// also maintains a _token cache_: Whenever the input is rewound to a position
+/// that has been rewound to before, the raw tokens read from there on are
+/// recorded, and any subsequent rewind to the same position replays those
+/// tokens instead of scanning the input stream again. Symbol lookup is left
+/// to the _cooked tokenizer_, as the meaning of an identifier may change from
+/// one invocation to the next.
+///
+/// Token sequences covering entire files may also be handed to the raw
+/// tokenizer from outside, in which case the file is never scanned at all.
+///
 class RawTokenizer final
 {
 public:
@@ -199,6 +266,20 @@ public:
     ///     The input stream must already be opened.
     void SetInputStream(StreamPtr pStream);
 
+    /// Set or change the input stream, replaying pre-tokenized content.
+    /// Any tokens cached from an earlier version of the stream are discarded.
+    /// @note
+    ///     The input stream must already be opened, and the token sequence
+    ///     (if not `nullptr`) must cover the entire stream, as obtained via
+    ///     @ref TokenizeStream().
+    void SetInputStream(StreamPtr pStream, RawTokenSequencePtr pTokens);
+
+    /// Tokenize an entire stream in one go.
+    /// @return `false` if the stream could not be tokenized cleanly, or has
+    ///         more than the specified number of tokens.
+    static bool TokenizeStream(StreamPtr pStream, RawTokenSequence& tokens,
+                               size_t maxTokens = std::numeric_limits<size_t>::max());
+
     /// Change encoding setting.
     void SetStringEncoding(CharacterEncodingID encoding);
 
@@ -211,13 +292,25 @@ public:
     /// Advance to the next `#` token in the input stream.
     bool GetNextDirective(RawToken& token);
 
+    /// Process a lexeme obtained elsewhere into a raw token.
+    /// @note
+    ///     Any errors deferred until the token is used are attributed to
+    ///     the current input stream.
+    bool ProcessLexeme(RawToken& token);
+
     /// Read raw data.
     /// @deprecated
     ///     This method is only intended as a temporary measure to implement
-    ///     binary-level macro caching, to provide a reference for performance
-    ///     testing of the envisioned token-level macro caching.
+    ///     binary-level macro caching, which is still used to avoid re-opening
+    ///     files for macros that have not been token-cached yet.
     bool GetRaw(unsigned char* buffer, size_t size);
 
+    /// Discard all cached tokens recorded from a given stream.
+    /// @note
+    ///     This must be called whenever a stream may have been modified since
+    ///     it was last read, e.g. when a file is (re-)included.
+    void ForgetCachedTokens(const UCS2String& streamName);
+
     /// Get current stream for comparison.
     ConstStreamPtr GetInputStream() const;
 
@@ -240,16 +333,40 @@ private:
 
     struct KnownWordInfo final
     {
-        int     id;
-        TokenId expressionId;
-        bool    isReservedWord     : 1;
-        bool    isPseudoIdentifier : 1;
+        int         id;
+        TokenId     expressionId;
+        SymbolHash  symbolHash;
+        bool        isReservedWord     : 1;
+        bool        isPseudoIdentifier : 1;
         KnownWordInfo();
     };
 
+    /// Sequence of raw tokens recorded from a particular position in a stream.
+    struct CachedTokenRun final
+    {
+        RawTokenSequence                sequence;
+        unsigned int                    visits;
+        CachedTokenRun();
+    };
+
+    using CachedTokenRunMap = std::unordered_map<POV_OFF_T, CachedTokenRun>;
+
     Scanner                                         mScanner;
     std::unordered_map<UTF8String, KnownWordInfo>   mKnownWords;
     unsigned int                                    mNextIdentifierId;
+    std::unordered_map<UCS2String, CachedTokenRunMap> mCachedTokens;
+    std::unordered_map<UCS2String, RawTokenSequencePtr> mTokenizedFiles;
+    size_t                                          mCachedTokenCount;
+    const RawTokenSequence*                         mpReplaySequence;
+    StreamPtr                                       mpReplayStream;
+    size_t                                          mReplayIndex;
+    RawTokenSequence*                               mpRecordSequence;
+
+    bool GetNextScannedToken(RawToken& token);
+    void RecordToken(const RawToken& token);
+    bool GoToBookmark(const StreamPtr& pStream, const Scanner::Bookmark& bookmark);
+    CachedTokenRun* VisitCachedTokens(const UCS2String& streamName, const Scanner::Bookmark& bookmark);
+    void LeaveCachedTokens();
 
     bool ProcessWordLexeme(RawToken& token);
     bool ProcessOtherLexeme(RawToken& token);
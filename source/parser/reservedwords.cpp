@@ -190,6 +190,7 @@ const RESERVED_WORD Reserved_Words[] = {
     { DEGREES_TOKEN,                "degrees" },
     { DENSITY_TOKEN,                "density" },
     { DENSITY_FILE_TOKEN,           "density_file" },
+    { DENSITY_GRID_TOKEN,           "density_grid" },
     { DENSITY_MAP_TOKEN,            "density_map" },
     { DENTS_TOKEN,                  "dents" },
     { DEPRECATED_TOKEN,             "deprecated" },
@@ -242,6 +243,10 @@ const RESERVED_WORD Reserved_Words[] = {
     { FISHEYE_TOKEN,                "fisheye" },
     { FLATNESS_TOKEN,               "flatness" },
     { FLIP_TOKEN,                   "flip" },
+    { FLOAT32BE_TOKEN,              "float32be" },
+    { FLOAT32LE_TOKEN,              "float32le" },
+    { FLOAT64BE_TOKEN,              "float64be" },
+    { FLOAT64LE_TOKEN,              "float64le" },
     { FLOOR_TOKEN,                  "floor" },
     { FOCAL_POINT_TOKEN,            "focal_point" },
     { FOG_TOKEN,                    "fog" },
@@ -307,6 +312,7 @@ const RESERVED_WORD Reserved_Words[] = {
     { LATHE_TOKEN,                  "lathe" },
     { LEMON_TOKEN,                  "lemon" },
     { LEOPARD_TOKEN,                "leopard" },
+    { LIGHT_BUDGET_TOKEN,           "light_budget" },
     { LIGHT_GROUP_TOKEN,            "light_group" },
     { LIGHT_SOURCE_TOKEN,           "light_source" },
     { LINEAR_SPLINE_TOKEN,          "linear_spline" },
@@ -317,6 +323,7 @@ const RESERVED_WORD Reserved_Words[] = {
     { LOCATION_TOKEN,               "location" },
     { LOG_TOKEN,                    "log" },
     { LOOK_AT_TOKEN,                "look_at" },
+    { LOW_DISCREPANCY_TOKEN,        "low_discrepancy" },
     { LOOKS_LIKE_TOKEN,             "looks_like" },
     { LOW_ERROR_FACTOR_TOKEN,       "low_error_factor" },
 
@@ -337,6 +337,7 @@ enum TokenId : int
     DENSITY_TOKEN,
     DENSITY_ID_TOKEN,
     DENSITY_FILE_TOKEN,
+    DENSITY_GRID_TOKEN,
     DENSITY_MAP_TOKEN,
     DENSITY_MAP_ID_TOKEN,
     DENTS_TOKEN,
@@ -388,6 +389,10 @@ enum TokenId : int
     FISHEYE_TOKEN,
     FLATNESS_TOKEN,
     FLIP_TOKEN,
+    FLOAT32BE_TOKEN,
+    FLOAT32LE_TOKEN,
+    FLOAT64BE_TOKEN,
+    FLOAT64LE_TOKEN,
     FOCAL_POINT_TOKEN,
     FOG_TOKEN,
     FOG_ID_TOKEN,
@@ -458,6 +463,7 @@ enum TokenId : int
     LEFT_SQUARE_TOKEN,
     LEMON_TOKEN,
     LEOPARD_TOKEN,
+    LIGHT_BUDGET_TOKEN,
     LIGHT_GROUP_TOKEN,
     LIGHT_SOURCE_TOKEN,
     LINEAR_SPLINE_TOKEN,
@@ -466,6 +472,7 @@ enum TokenId : int
     LOCAL_TOKEN,
     LOCATION_TOKEN,
     LOOK_AT_TOKEN,
+    LOW_DISCREPANCY_TOKEN,
     LOOKS_LIKE_TOKEN,
     LOW_ERROR_FACTOR_TOKEN,
 
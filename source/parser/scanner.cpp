@@ -865,20 +865,37 @@ bool Scanner::SetInputStream(StreamPtr stream, const Bookmark& bookmark)
     return mSource.SetInputStream(stream, bookmark.offset);
 }
 
-void Scanner::SetCharacterEncoding(CharacterEncodingID encoding)
+Scanner::CharacterEncodingPtr Scanner::GetCharacterEncoding(CharacterEncodingID encoding)
 {
     switch (encoding)
     {
-        case CharacterEncodingID::kAutoDetect:      mpCharacterEncoding = AutoDetectEncoding::Instance();   break;
-        case CharacterEncodingID::kASCII:           mpCharacterEncoding = ASCIIEncoding::Instance();        break;
-        case CharacterEncodingID::kLatin1:          mpCharacterEncoding = &kLatin1Encoding;                 break;
-        case CharacterEncodingID::kMacOSRoman:      mpCharacterEncoding = &kMacOSRomanEncoding;             break;
-        case CharacterEncodingID::kWindows1252:     mpCharacterEncoding = &kWindows1252Encoding;            break;
-        case CharacterEncodingID::kUTF8:            mpCharacterEncoding = UTF8Encoding::Instance();         break;
-        default:                                    POV_PARSER_PANIC();                                     break;
+        case CharacterEncodingID::kAutoDetect:      return AutoDetectEncoding::Instance();
+        case CharacterEncodingID::kASCII:           return ASCIIEncoding::Instance();
+        case CharacterEncodingID::kLatin1:          return &kLatin1Encoding;
+        case CharacterEncodingID::kMacOSRoman:      return &kMacOSRomanEncoding;
+        case CharacterEncodingID::kWindows1252:     return &kWindows1252Encoding;
+        case CharacterEncodingID::kUTF8:            return UTF8Encoding::Instance();
+        default:                                    POV_PARSER_PANIC();                 return nullptr;
     }
 }
 
+CharacterEncodingID Scanner::GetCharacterEncodingID(CharacterEncodingPtr pEncoding)
+{
+    if (pEncoding == AutoDetectEncoding::Instance())    return CharacterEncodingID::kAutoDetect;
+    if (pEncoding == ASCIIEncoding::Instance())         return CharacterEncodingID::kASCII;
+    if (pEncoding == &kLatin1Encoding)                  return CharacterEncodingID::kLatin1;
+    if (pEncoding == &kMacOSRomanEncoding)              return CharacterEncodingID::kMacOSRoman;
+    if (pEncoding == &kWindows1252Encoding)             return CharacterEncodingID::kWindows1252;
+    if (pEncoding == UTF8Encoding::Instance())          return CharacterEncodingID::kUTF8;
+    POV_PARSER_PANIC();
+    return CharacterEncodingID::kAutoDetect;
+}
+
+void Scanner::SetCharacterEncoding(CharacterEncodingID encoding)
+{
+    mpCharacterEncoding = GetCharacterEncoding(encoding);
+}
+
 void Scanner::SetNestedBlockComments(bool allow)
 {
     mAllowNestedBlockComments = allow;
@@ -176,6 +176,12 @@ public:
     /// Change encoding setting.
     void SetCharacterEncoding(CharacterEncodingID encoding);
 
+    /// Get character encoding scheme by ID.
+    static CharacterEncodingPtr GetCharacterEncoding(CharacterEncodingID encoding);
+
+    /// Get ID of character encoding scheme.
+    static CharacterEncodingID GetCharacterEncodingID(CharacterEncodingPtr pEncoding);
+
     /// Change the behaviour with regards to nested block comments.
     /// This setting governs the scanner's behaviour when encountering a block
     /// comment start sequence (`/*`) inside another block comment: If allowed
@@ -0,0 +1,183 @@
+//******************************************************************************
+///
+/// @file parser/staticobjectcache.cpp
+///
+/// Implementation of the cache of static objects re-used across animation frames.
+///
+/// @copyright
+/// @parblock
+///
+/// Persistence of Vision Ray Tracer ('POV-Ray') version 3.8.
+/// Copyright 1991-2019 Persistence of Vision Raytracer Pty. Ltd.
+///
+/// POV-Ray is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Affero General Public License as
+/// published by the Free Software Foundation, either version 3 of the
+/// License, or (at your option) any later version.
+///
+/// POV-Ray is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU Affero General Public License for more details.
+///
+/// You should have received a copy of the GNU Affero General Public License
+/// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// ----------------------------------------------------------------------------
+///
+/// POV-Ray is based on the popular DKB raytracer version 2.12.
+/// DKBTrace was originally written by David K. Buck.
+/// DKBTrace Ver 2.0-2.12 were written by David K. Buck & Aaron A. Collins.
+///
+/// @endparblock
+///
+//******************************************************************************
+
+// Unit header file must be the first file included within POV-Ray *.cpp files (pulls in config)
+#include "parser/staticobjectcache.h"
+
+// C++ variants of C standard header files
+//  (none at the moment)
+
+// C++ standard header files
+#include <functional>
+
+// POV-Ray header files (base module)
+//  (none at the moment)
+
+// POV-Ray header files (core module)
+#include "core/scene/object.h"
+
+// POV-Ray header files (parser module)
+//  (none at the moment)
+
+// this must be the last file included
+#include "base/povdebug.h"
+
+namespace pov_parser
+{
+
+static std::mutex gCacheMutex;
+
+// NB: The cache is intentionally never destroyed at program exit: the cached objects may reference
+// data owned by other static objects, which may already be gone by the time our destructor runs.
+static StaticObjectCachePtr& gpCache = *(new StaticObjectCachePtr);
+
+//******************************************************************************
+
+bool StaticStatementKey::operator==(const StaticStatementKey& o) const
+{
+    return (offset == o.offset) && (context == o.context) && (occurrence == o.occurrence) &&
+           (declared == o.declared) && (fileName == o.fileName);
+}
+
+size_t StaticStatementKeyHash::operator()(const StaticStatementKey& key) const
+{
+    size_t hash = std::hash<UCS2String>()(key.fileName);
+    hash = hash * 31 + std::hash<POV_OFF_T>()(key.offset);
+    hash = hash * 31 + key.context;
+    hash = hash * 31 + key.occurrence;
+    return hash * 2 + (key.declared ? 1 : 0);
+}
+
+//******************************************************************************
+
+StaticStatementEntry::StaticStatementEntry() :
+    object(nullptr),
+    canSkipToEnd(false),
+    maxBlobComponents(0),
+    fractalIterationStackLength(0),
+    maxBoundingCylinders(0)
+{}
+
+StaticStatementEntry::~StaticStatementEntry()
+{
+    Destroy_Object(object);
+}
+
+//******************************************************************************
+
+StaticObjectCache::StaticObjectCache(const UCS2String& inputFile) :
+    mInputFile(inputFile),
+    mFrame(0),
+    mHaveDeclaredVariables(false)
+{}
+
+StaticObjectCachePtr StaticObjectCache::Acquire(const UCS2String& inputFile, bool continuedAnimation)
+{
+    std::lock_guard<std::mutex> lock(gCacheMutex);
+    if (!continuedAnimation || (gpCache == nullptr) || (gpCache->mInputFile != inputFile))
+        gpCache.reset(new StaticObjectCache(inputFile));
+    return gpCache;
+}
+
+void StaticObjectCache::Release()
+{
+    std::lock_guard<std::mutex> lock(gCacheMutex);
+    gpCache.reset();
+}
+
+std::vector<std::string> StaticObjectCache::ChangedVariables(const DeclaredVariablesMap& declaredVariables)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    std::vector<std::string> changed;
+    for (auto& i : declaredVariables)
+    {
+        if (mHaveDeclaredVariables)
+        {
+            auto previous = mDeclaredVariables.find(i.first);
+            if ((previous != mDeclaredVariables.end()) && (previous->second == i.second))
+                continue;
+        }
+        changed.push_back(i.first);
+    }
+    mDeclaredVariables = declaredVariables;
+    mHaveDeclaredVariables = true;
+    return changed;
+}
+
+StaticStatementEntryPtr StaticObjectCache::Find(const StaticStatementKey& key)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto i = mEntries.find(key);
+    if (i == mEntries.end())
+        return nullptr;
+    i->second.lastFrame = mFrame;
+    return i->second.entry;
+}
+
+void StaticObjectCache::Store(const StaticStatementKey& key, StaticStatementEntryPtr entry)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    Slot& slot = mEntries[key];
+    slot.entry = entry;
+    slot.lastFrame = mFrame;
+}
+
+void StaticObjectCache::EndFrame()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (auto i = mEntries.begin(); i != mEntries.end(); )
+    {
+        if (i->second.lastFrame != mFrame)
+            i = mEntries.erase(i);
+        else
+            ++i;
+    }
+    ++mFrame;
+}
+
+void StaticObjectCache::NoteWrittenFile(const UCS2String& fileName)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mWrittenFiles.insert(fileName);
+}
+
+bool StaticObjectCache::WasWrittenFile(const UCS2String& fileName)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return (mWrittenFiles.find(fileName) != mWrittenFiles.end());
+}
+
+}
+// end of namespace pov_parser
@@ -0,0 +1,190 @@
+//******************************************************************************
+///
+/// @file parser/staticobjectcache.h
+///
+/// Declarations for the cache of static objects re-used across animation frames.
+///
+/// @copyright
+/// @parblock
+///
+/// Persistence of Vision Ray Tracer ('POV-Ray') version 3.8.
+/// Copyright 1991-2019 Persistence of Vision Raytracer Pty. Ltd.
+///
+/// POV-Ray is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Affero General Public License as
+/// published by the Free Software Foundation, either version 3 of the
+/// License, or (at your option) any later version.
+///
+/// POV-Ray is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU Affero General Public License for more details.
+///
+/// You should have received a copy of the GNU Affero General Public License
+/// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// ----------------------------------------------------------------------------
+///
+/// POV-Ray is based on the popular DKB raytracer version 2.12.
+/// DKBTrace was originally written by David K. Buck.
+/// DKBTrace Ver 2.0-2.12 were written by David K. Buck & Aaron A. Collins.
+///
+/// @endparblock
+///
+//******************************************************************************
+
+#ifndef POVRAY_PARSER_STATICOBJECTCACHE_H
+#define POVRAY_PARSER_STATICOBJECTCACHE_H
+
+// Module config header file must be the first file included within POV-Ray unit header files
+#include "parser/configparser.h"
+
+// C++ variants of C standard header files
+//  (none at the moment)
+
+// C++ standard header files
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// POV-Ray header files (base module)
+#include "base/stringtypes.h"
+
+// POV-Ray header files (core module)
+#include "core/core_fwd.h"
+
+// POV-Ray header files (parser module)
+#include "parser/parsertypes.h"
+#include "parser/scanner.h"
+
+namespace pov_parser
+{
+
+using namespace pov_base;
+using namespace pov;
+
+//******************************************************************************
+
+/// Value identifying an object statement in the scene description.
+struct StaticStatementKey final
+{
+    UCS2String      fileName;   ///< Name of the file holding the statement's first token.
+    POV_OFF_T       offset;     ///< Position of the statement's first token.
+    size_t          context;    ///< Hash of the include sites, macro call sites and loop iterations leading to the statement.
+    unsigned int    occurrence; ///< Number of times the statement has been parsed before in the same context and frame.
+    bool            declared;   ///< Whether the object is assigned to an identifier or passed to a macro, rather than added to the scene.
+
+    bool operator==(const StaticStatementKey& o) const;
+};
+
+struct StaticStatementKeyHash final
+{
+    size_t operator()(const StaticStatementKey& key) const;
+};
+
+/// Object resulting from an object statement that did not depend on the frame.
+struct StaticStatementEntry final
+{
+    ObjectPtr               object;                     ///< Master copy of the resulting object.
+    std::vector<SymbolHash> symbols;                    ///< Symbols read by the statement (sorted).
+    Scanner::ColdBookmark   end;                        ///< Position right after the statement.
+    bool                    canSkipToEnd;               ///< Whether we may go to @ref end directly.
+    int                     maxBlobComponents;          ///< Value of the corresponding scene data field after the statement.
+    int                     fractalIterationStackLength;///< Value of the corresponding scene data field after the statement.
+    unsigned int            maxBoundingCylinders;       ///< Value of the corresponding scene data field after the statement.
+
+    StaticStatementEntry();
+    ~StaticStatementEntry();
+};
+
+using StaticStatementEntryPtr = std::shared_ptr<const StaticStatementEntry>;
+
+class StaticObjectCache;
+using StaticObjectCachePtr = std::shared_ptr<StaticObjectCache>;
+
+/// Class implementing a cache of static objects, to re-use across the frames of an animation.
+///
+/// Each object statement that the parser has found to be independent of the
+/// frame (not depending on `clock` or any other frame-varying value, be it
+/// directly or via identifiers, conditionals or loops) is recorded here, along
+/// with the symbols it has read. In the next frame, the parser looks up each
+/// object statement before parsing it, and provided none of the symbols have
+/// become frame-dependent in the meantime it skips the statement and uses
+/// copies of the recorded objects instead.
+///
+/// There is a single cache per process, covering one animation at a time; it
+/// is discarded whenever a different scene or animation is started.
+///
+/// @note
+///     This class is thread-safe, but frames sharing a cache must not be
+///     parsed concurrently.
+///
+class StaticObjectCache final
+{
+public:
+
+    using DeclaredVariablesMap = std::map<std::string, std::string>;
+
+    /// Get the cache to use for a frame.
+    ///
+    /// @param[in]  inputFile           Name of the scene file.
+    /// @param[in]  continuedAnimation  Whether the frame continues the animation of the previously parsed frame.
+    /// @return                         The cache to use.
+    ///
+    static StaticObjectCachePtr Acquire(const UCS2String& inputFile, bool continuedAnimation);
+
+    /// Discard the process' cache, e.g. after the last frame of an animation.
+    static void Release();
+
+    /// Find the declared variables that may differ from the previous frame.
+    ///
+    /// In the first frame of an animation, all declared variables are reported.
+    ///
+    /// @param[in]  declaredVariables   Declared variables of the current frame.
+    /// @return                         Names of the variables that differ from the previous frame.
+    ///
+    std::vector<std::string> ChangedVariables(const DeclaredVariablesMap& declaredVariables);
+
+    /// Look up an object statement.
+    /// @return                         The entry recorded for the statement, or `nullptr` if none.
+    StaticStatementEntryPtr Find(const StaticStatementKey& key);
+
+    /// Record an object statement.
+    void Store(const StaticStatementKey& key, StaticStatementEntryPtr entry);
+
+    /// Discard all entries not used in the current frame.
+    void EndFrame();
+
+    /// Note that the scene has written to a file.
+    void NoteWrittenFile(const UCS2String& fileName);
+
+    /// Test whether the scene has written to a file in any frame so far.
+    bool WasWrittenFile(const UCS2String& fileName);
+
+private:
+
+    struct Slot final
+    {
+        StaticStatementEntryPtr entry;
+        unsigned int            lastFrame;
+    };
+
+    std::mutex          mMutex;
+    UCS2String          mInputFile;
+    unsigned int        mFrame;
+    bool                mHaveDeclaredVariables;
+    DeclaredVariablesMap mDeclaredVariables;
+    std::unordered_map<StaticStatementKey, Slot, StaticStatementKeyHash> mEntries;
+    std::set<UCS2String> mWrittenFiles;
+
+    StaticObjectCache(const UCS2String& inputFile);
+};
+
+}
+// end of namespace pov_parser
+
+#endif // POVRAY_PARSER_STATICOBJECTCACHE_H
@@ -40,7 +40,7 @@
 #include <cstring>
 
 // C++ standard header files
-//  (none at the moment)
+#include <algorithm>
 
 // POV-Ray header files (base module)
 #include "base/pov_mem.h"
@@ -73,37 +73,52 @@ using namespace pov;
 
 //******************************************************************************
 
-SymbolTable::SymbolTable()
+SymbolTable::SymbolTable() :
+    mUsedSlots(0)
+{}
+
+SymbolTable::SymbolTable(const SymbolTable& obj) :
+    mSlots(obj.mSlots),
+    mUsedSlots(obj.mUsedSlots)
 {
-    for (int i = 0; i < SYM_TABLE_SIZE; i++)
-        mapHashTable[i] = nullptr;
+    for (auto& slot : mSlots)
+    {
+        // Copy the entire chain of same-name symbols, preserving their order.
+        SYM_ENTRY** link = &slot.entry;
+        for (const SYM_ENTRY* oldEntry = slot.entry; oldEntry != nullptr; oldEntry = oldEntry->next)
+        {
+            *link = Copy_Entry(oldEntry);
+            link = &((*link)->next);
+        }
+    }
 }
 
-SymbolTable::SymbolTable(const SymbolTable& obj)
+SymbolTable::~SymbolTable()
 {
-    for (int i = SYM_TABLE_SIZE - 1; i >= 0; i--)
+    for (auto& slot : mSlots)
     {
-        SYM_ENTRY* oldEntry = obj.mapHashTable[i];
-        while (oldEntry)
+        SYM_ENTRY *entry = slot.entry;
+        while (entry)
         {
-            SYM_ENTRY* newEntry = Copy_Entry(oldEntry);
-            newEntry->next = obj.mapHashTable[i];
-            mapHashTable[i] = newEntry;
-            oldEntry = oldEntry->next;
+            entry = Destroy_Entry(entry);
         }
     }
 }
 
-SymbolTable::~SymbolTable()
+void SymbolTable::Clear()
 {
-    for (int i = SYM_TABLE_SIZE - 1; i >= 0; i--)
+    for (auto& slot : mSlots)
     {
-        SYM_ENTRY *entry = mapHashTable[i];
+        SYM_ENTRY *entry = slot.entry;
         while (entry)
         {
             entry = Destroy_Entry(entry);
         }
+        slot.entry = nullptr;
     }
+    mUsedSlots = 0;
+    if (mSlots.size() > 256)
+        std::vector<Slot>().swap(mSlots);
 }
 
 //------------------------------------------------------------------------------
@@ -120,6 +135,7 @@ SYM_ENTRY* SymbolTable::Create_Entry(const UTF8String& Name, TokenId Number)
     New->Deprecation_Message = nullptr;
     New->ref_count = 1;
     New->name = Name;
+    New->hash = GetSymbolHash(Name.c_str());
 
     return New;
 }
@@ -138,6 +154,7 @@ SYM_ENTRY* SymbolTable::Copy_Entry(const SYM_ENTRY* oldEntry)
     newEntry->Deprecation_Message = nullptr;
     newEntry->ref_count = 1;
     newEntry->name = oldEntry->name;
+    newEntry->hash = oldEntry->hash;
 
     return newEntry;
 }
@@ -149,7 +166,7 @@ SYM_ENTRY* SymbolTable::Destroy_Entry(SYM_ENTRY *Entry)
     if (Entry == nullptr)
         return nullptr;
 
-    // always unhook the entry from hash table (if it is still member of one)
+    // always unhook the entry from its chain of same-name symbols (if it is still member of one)
     Next = Entry->next;
     Entry->next = nullptr;
 
@@ -407,10 +424,21 @@ void SymbolTable::Destroy_Ident_Data(void *Data, int Type)
 
 void SymbolTable::Add_Entry(SYM_ENTRY *Table_Entry)
 {
-    int i = get_hash_value(Table_Entry->name.c_str());
+    if ((mUsedSlots + 1) * 4 > mSlots.size() * 3)
+        Grow();
 
-    Table_Entry->next = mapHashTable[i];
-    mapHashTable[i] = Table_Entry;
+    Slot& slot = mSlots[FindSlot(Table_Entry->name.c_str(), Table_Entry->hash)];
+    if (slot.entry == nullptr)
+    {
+        slot.hash = Table_Entry->hash;
+        ++mUsedSlots;
+    }
+
+    // A symbol of the same name already present in this table is shadowed
+    // (rather than replaced), and becomes visible again once the new one
+    // is removed.
+    Table_Entry->next = slot.entry;
+    slot.entry = Table_Entry;
 }
 
 SYM_ENTRY *SymbolTable::Add_Symbol(const UTF8String& Name, TokenId Number)
@@ -425,7 +453,14 @@ SYM_ENTRY *SymbolTable::Add_Symbol(const UTF8String& Name, TokenId Number)
 
 SYM_ENTRY* SymbolTable::Find_Symbol(const char* name) const
 {
-    return Find_Symbol(name, get_hash_value(name));
+    return Find_Symbol(name, GetSymbolHash(name));
+}
+
+SYM_ENTRY* SymbolTable::Find_Symbol(const char* name, SymbolHash hash) const
+{
+    if (mSlots.empty())
+        return nullptr;
+    return mSlots[FindSlot(name, hash)].entry;
 }
 
 void SymbolTable::Remove_Symbol(const char *Name, bool is_array_elem, void **DataPtr, int ttype)
@@ -444,28 +479,21 @@ void SymbolTable::Remove_Symbol(const char *Name, bool is_array_elem, void **Dat
     }
     else
     {
-        SYM_ENTRY *Entry;
-        SYM_ENTRY **EntryPtr;
+        if (mSlots.empty())
+            POV_PARSER_PANIC();
 
-        int i = get_hash_value(Name);
+        size_t i = FindSlot(Name, GetSymbolHash(Name));
+        SYM_ENTRY *Entry = mSlots[i].entry;
 
-        EntryPtr = &(mapHashTable[i]);
-        Entry = *EntryPtr;
+        if (Entry == nullptr)
+            POV_PARSER_PANIC();
 
-        while (Entry)
-        {
-            if (strcmp(Name, Entry->name.c_str()) == 0)
-            {
-                *EntryPtr = Entry->next;
-                Destroy_Entry(Entry);
-                return;
-            }
-
-            EntryPtr = &(Entry->next);
-            Entry = *EntryPtr;
-        }
+        if (Entry->next != nullptr)
+            mSlots[i].entry = Entry->next;
+        else
+            ReleaseSlot(i);
 
-        POV_PARSER_PANIC();
+        Destroy_Entry(Entry);
     }
 }
 
@@ -515,31 +543,54 @@ template<typename T> void SymbolTable::DeleteData(void* data)
 
 //------------------------------------------------------------------------------
 
-SYM_ENTRY* SymbolTable::Find_Symbol(const char* Name, int hash) const
+size_t SymbolTable::FindSlot(const char* name, SymbolHash hash) const
 {
-    SYM_ENTRY* Entry = mapHashTable[hash];
+    POV_PARSER_ASSERT(!mSlots.empty());
 
-    while (Entry)
+    size_t mask = mSlots.size() - 1;
+    for (size_t i = hash & mask; ; i = (i + 1) & mask)
     {
-        if (strcmp(Name, Entry->name.c_str()) == 0)
-            return Entry;
-
-        Entry = Entry->next;
+        const Slot& slot = mSlots[i];
+        if ((slot.entry == nullptr) ||
+            ((slot.hash == hash) && (std::strcmp(name, slot.entry->name.c_str()) == 0)))
+            return i;
     }
-
-    return Entry;
 }
 
-int SymbolTable::get_hash_value(const char *s)
+void SymbolTable::Grow()
 {
-    unsigned int i = 0;
+    std::vector<Slot> oldSlots(std::max(mSlots.size() * 2, size_t(16)), Slot{ nullptr, 0 });
+    oldSlots.swap(mSlots);
 
-    while (*s)
+    size_t mask = mSlots.size() - 1;
+    for (auto& oldSlot : oldSlots)
     {
-        i = (i << 1) ^ *s++;
+        if (oldSlot.entry == nullptr)
+            continue;
+        size_t i = oldSlot.hash & mask;
+        while (mSlots[i].entry != nullptr)
+            i = (i + 1) & mask;
+        mSlots[i] = oldSlot;
     }
+}
 
-    return((int)(i % SYM_TABLE_SIZE));
+void SymbolTable::ReleaseSlot(size_t index)
+{
+    // Rather than leaving a tombstone, move subsequent entries of the same
+    // probe sequence back into the gap, so that lookups of missing symbols
+    // (the most common case when searching the symbol stack) remain short.
+    size_t mask = mSlots.size() - 1;
+    for (size_t i = (index + 1) & mask; mSlots[i].entry != nullptr; i = (i + 1) & mask)
+    {
+        size_t home = mSlots[i].hash & mask;
+        if (((i - home) & mask) >= ((i - index) & mask))
+        {
+            mSlots[index] = mSlots[i];
+            index = i;
+        }
+    }
+    mSlots[index].entry = nullptr;
+    --mUsedSlots;
 }
 
 //******************************************************************************
@@ -593,13 +644,17 @@ SYM_ENTRY *SymbolStack::Add_Symbol(int Index, const UTF8String& Name, TokenId Nu
 
 SYM_ENTRY* SymbolStack::Find_Symbol(int index, const char* name)
 {
-    return Tables[index]->Find_Symbol(name, SymbolTable::get_hash_value(name));
+    return Tables[index]->Find_Symbol(name);
 }
 
 SYM_ENTRY* SymbolStack::Find_Symbol(const char* name, int* pIndex)
+{
+    return Find_Symbol(name, GetSymbolHash(name), pIndex);
+}
+
+SYM_ENTRY* SymbolStack::Find_Symbol(const char* name, SymbolHash hash, int* pIndex)
 {
     SYM_ENTRY *entry;
-    int hash = SymbolTable::get_hash_value(name);
     for (int index = Table_Index; index >= SYM_TABLE_GLOBAL; --index)
     {
         entry = Tables[index]->Find_Symbol(name, hash);
@@ -624,18 +679,24 @@ void SymbolStack::Remove_Symbol(int Index, const char *Name, bool is_array_elem,
 
 SymbolStack::SymbolStack() :
     Table_Index(-1)
-{}
+{
+    for (int i = 0; i < MAX_NUMBER_OF_TABLES; i++)
+        Tables[i] = nullptr;
+}
 
 SymbolStack::~SymbolStack()
 {
-    while (Table_Index >= 0)
-        delete Tables[Table_Index--];
+    for (int i = 0; i < MAX_NUMBER_OF_TABLES; i++)
+        delete Tables[i];
 }
 
 void SymbolStack::Clear()
 {
     while (Table_Index >= 0)
-        delete Tables[Table_Index--];
+    {
+        delete Tables[Table_Index];
+        Tables[Table_Index--] = nullptr;
+    }
 }
 
 void SymbolStack::PushTable()
@@ -646,12 +707,13 @@ void SymbolStack::PushTable()
         throw POV_EXCEPTION_STRING("Too many nested symbol tables");
     }
 
-    Tables[Table_Index] = new SymbolTable();
+    if (Tables[Table_Index] == nullptr)
+        Tables[Table_Index] = new SymbolTable();
 }
 
 void SymbolStack::PopTable()
 {
-    delete Tables[Table_Index--];
+    Tables[Table_Index--]->Clear();
 }
 
 /*
@@ -44,6 +44,7 @@
 
 // C++ standard header files
 #include <memory>
+#include <vector>
 
 // POV-Ray header files (base module)
 #include "base/stringtypes.h"
@@ -63,7 +64,6 @@ using namespace pov_base;
 //------------------------------------------------------------------------------
 
 const int MAX_NUMBER_OF_TABLES = 100;
-const int SYM_TABLE_SIZE = 257;
 
 typedef unsigned short SymTableEntryRefCount;
 
@@ -76,8 +76,9 @@ enum
 /// Structure holding information about a symbol
 struct Sym_Table_Entry final
 {
-    Sym_Table_Entry *next;      ///< Reference to next symbol with same hash
+    Sym_Table_Entry *next;      ///< Reference to older symbol of same name in the same table, shadowed by this one
     UTF8String name;            ///< Symbol name
+    SymbolHash hash;            ///< Hash value of the symbol name
     char *Deprecation_Message;  ///< Warning to print if the symbol is deprecated
     void *Data;                 ///< Reference to the symbol value
     TokenId Token_Number;       ///< Unique ID of this symbol
@@ -112,8 +113,12 @@ struct SymbolTable final
     void Add_Entry(SYM_ENTRY *Table_Entry);
     SYM_ENTRY *Add_Symbol(const UTF8String& Name, TokenId Number);
     SYM_ENTRY* Find_Symbol(const char* s) const;
+    SYM_ENTRY* Find_Symbol(const char* s, SymbolHash hash) const;
     void Remove_Symbol(const char *Name, bool is_array_elem, void **DataPtr, int ttype);
 
+    /// Remove all symbols, keeping the storage for re-use if it is small.
+    void Clear();
+
     static void Acquire_Entry_Reference(SYM_ENTRY *Entry);
     static void Release_Entry_Reference(SYM_ENTRY *Entry);
 
@@ -123,14 +128,26 @@ protected:
     template<typename T> static void* CloneData(const void*);
     template<typename T> static void DeleteData(void*);
 
-    SYM_ENTRY* Find_Symbol(const char* s, int hash) const;
-    static int get_hash_value(const char *s);
+private:
 
-    friend class SymbolStack;
+    /// Slot of the symbol hash table.
+    struct Slot final
+    {
+        SYM_ENTRY*  entry;  ///< Most recent symbol of a given name, or `nullptr` if the slot is unused.
+        SymbolHash  hash;   ///< Hash value of the symbol name.
+    };
 
-private:
+    /// Hash table with open addressing and linear probing.
+    /// The number of slots is either zero (until the first symbol is added) or
+    /// a power of two; the table is grown whenever it becomes 3/4 full.
+    std::vector<Slot> mSlots;
+
+    /// Number of slots in use.
+    size_t mUsedSlots;
 
-    SYM_ENTRY* mapHashTable[SYM_TABLE_SIZE];
+    size_t FindSlot(const char* s, SymbolHash hash) const;
+    void Grow();
+    void ReleaseSlot(size_t index);
 };
 
 using SymbolTablePtr = std::shared_ptr<SymbolTable>;
@@ -158,6 +175,7 @@ public:
     SYM_ENTRY *Add_Symbol(int Index, const UTF8String& Name, TokenId Number);
     SYM_ENTRY* Find_Symbol(int index, const char* s);
     SYM_ENTRY* Find_Symbol(const char* s, int* pIndex = nullptr);
+    SYM_ENTRY* Find_Symbol(const char* s, SymbolHash hash, int* pIndex = nullptr);
     void Remove_Symbol(int Index, const char *Name, bool is_array_elem, void **DataPtr, int ttype);
 
     //------------------------------------------------------------------------------
@@ -172,11 +190,13 @@ public:
     void PushTable();
 
     /// Remove the most local symbol table.
+    /// @note
+    ///     The table object itself is kept for re-use by the next @ref PushTable().
     void PopTable();
 
 protected:
 
-    SymbolTable* Tables[MAX_NUMBER_OF_TABLES];
+    SymbolTable* Tables[MAX_NUMBER_OF_TABLES]; ///< Active tables up to @ref Table_Index, spare tables (or `nullptr`) beyond.
     int Table_Index;
 };
 
@@ -0,0 +1,170 @@
+//******************************************************************************
+///
+/// @file parser/texturecache.cpp
+///
+/// Implementation of the cache of MIP-mapped image files.
+///
+/// @copyright
+/// @parblock
+///
+/// Persistence of Vision Ray Tracer ('POV-Ray') version 3.8.
+/// Copyright 1991-2019 Persistence of Vision Raytracer Pty. Ltd.
+///
+/// POV-Ray is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Affero General Public License as
+/// published by the Free Software Foundation, either version 3 of the
+/// License, or (at your option) any later version.
+///
+/// POV-Ray is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU Affero General Public License for more details.
+///
+/// You should have received a copy of the GNU Affero General Public License
+/// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// ----------------------------------------------------------------------------
+///
+/// POV-Ray is based on the popular DKB raytracer version 2.12.
+/// DKBTrace was originally written by David K. Buck.
+/// DKBTrace Ver 2.0-2.12 were written by David K. Buck & Aaron A. Collins.
+///
+/// @endparblock
+///
+//******************************************************************************
+
+// Unit header file must be the first file included within POV-Ray *.cpp files (pulls in config)
+#include "parser/texturecache.h"
+
+// C++ variants of C standard header files
+#include <cstdint>
+
+// C++ standard header files
+#include <memory>
+
+// POV-Ray header files (base module)
+#include "base/fileinputoutput.h"
+#include "base/path.h"
+#include "base/platformbase.h"
+#include "base/pov_err.h"
+#include "base/image/colourspace.h"
+#include "base/image/mipmap.h"
+
+// POV-Ray header files (core module)
+//  (none at the moment)
+
+// POV-Ray header files (parser module)
+#include "parser/diskcache.h"
+
+// this must be the last file included
+#include "base/povdebug.h"
+
+namespace pov_parser
+{
+
+using std::uint64_t;
+
+//******************************************************************************
+
+template<typename T>
+static uint64_t ComputeHash(const T& value, uint64_t hash)
+{
+    return DiskCache::ComputeHash(&value, sizeof(value), hash);
+}
+
+static uint64_t ComputeHash(const SimpleGammaCurvePtr& gamma, uint64_t hash)
+{
+    if (!gamma)
+        return ComputeHash(int(-1), hash);
+    return ComputeHash(gamma->GetParam(), ComputeHash(gamma->GetTypeId(), hash));
+}
+
+/// Compute a hash of all settings affecting the decoded image.
+static uint64_t ComputeOptionsHash(Image::ImageFileType type, const ImageReadOptions& options)
+{
+    uint64_t hash = ComputeHash(int(type), DiskCache::kHashSeed);
+    hash = ComputeHash(int(options.itype), hash);
+    hash = ComputeHash(options.defaultGamma, hash);
+    hash = ComputeHash(options.workingGamma, hash);
+    hash = ComputeHash(options.gammaOverride, hash);
+    hash = ComputeHash(options.gammacorrect, hash);
+    hash = ComputeHash(options.premultipliedOverride, hash);
+    hash = ComputeHash(options.premultiplied, hash);
+    return hash;
+}
+
+/// Open a cache file, and get its levels if it is valid and matches the key.
+static Image *LoadLevels(const UCS2String& fileName, const MipMap::SourceKey& key, std::vector<Image*>& mipLevels)
+{
+    if (!PlatformBase::GetInstance().AllowLocalFileAccess(fileName, POV_File_Data_MipMap, false))
+        return nullptr;
+
+    std::vector<Image*> levels;
+    std::shared_ptr<IStream> pFile(NewIStream(fileName, POV_File_Data_MipMap));
+    if ((pFile == nullptr) || !*pFile || !MipMap::Read(pFile, key, levels))
+        return nullptr;
+
+    mipLevels.assign(levels.begin() + 1, levels.end());
+    return levels.front();
+}
+
+//******************************************************************************
+
+Image *TextureCache::Get(StreamPtr pStream, Image::ImageFileType type, const ImageReadOptions& options,
+                         const UCS2String& diskCachePath, size_t memoryLimit, std::vector<Image*>& mipLevels)
+{
+    mipLevels.clear();
+    MipMap::SetTileCacheLimit(memoryLimit);
+
+    // Slurp the file to find out whether it has changed since the cache file
+    // was created.
+
+    POV_OFF_T size = -1;
+    std::vector<unsigned char> data;
+    if (pStream->seekg(0, IOBase::seek_end))
+        size = pStream->tellg();
+    if ((size > 0) && pStream->seekg(0))
+    {
+        data.resize(size_t(size));
+        if (!pStream->read(data.data(), data.size()))
+            size = -1;
+    }
+    pStream->clearstate();
+    pStream->seekg(0);
+    if (size <= 0)
+        return Image::Read(type, pStream.get(), options);
+
+    MipMap::SourceKey key;
+    key.size    = uint64_t(size);
+    key.hash    = DiskCache::ComputeHash(data.data(), data.size());
+    key.options = ComputeOptionsHash(type, options);
+    data.clear();
+    data.shrink_to_fit();
+
+    UCS2String fileName = DiskCache::GetFileName(diskCachePath, pStream->Name(), POV_File_Data_MipMap, key.options);
+
+    Image *image = LoadLevels(fileName, key, mipLevels);
+    if (image != nullptr)
+        return image;
+
+    // Not cached yet, or outdated; decode the original file, and cache it
+    // for the next time.
+
+    image = Image::Read(type, pStream.get(), options);
+    if (!MipMap::IsSupported(image))
+        return image;
+
+    if (!DiskCache::Write(fileName, POV_File_Data_MipMap,
+                          [&](OStream& file) { MipMap::Write(&file, image, key); return true; }))
+        return image;
+
+    Image *cachedImage = LoadLevels(fileName, key, mipLevels);
+    if (cachedImage == nullptr)
+        return image;
+
+    delete image;
+    return cachedImage;
+}
+
+}
+// end of namespace pov_parser
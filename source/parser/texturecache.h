@@ -0,0 +1,114 @@
+//******************************************************************************
+///
+/// @file parser/texturecache.h
+///
+/// Declarations for the cache of MIP-mapped image files.
+///
+/// @copyright
+/// @parblock
+///
+/// Persistence of Vision Ray Tracer ('POV-Ray') version 3.8.
+/// Copyright 1991-2019 Persistence of Vision Raytracer Pty. Ltd.
+///
+/// POV-Ray is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Affero General Public License as
+/// published by the Free Software Foundation, either version 3 of the
+/// License, or (at your option) any later version.
+///
+/// POV-Ray is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU Affero General Public License for more details.
+///
+/// You should have received a copy of the GNU Affero General Public License
+/// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+///
+/// ----------------------------------------------------------------------------
+///
+/// POV-Ray is based on the popular DKB raytracer version 2.12.
+/// DKBTrace was originally written by David K. Buck.
+/// DKBTrace Ver 2.0-2.12 were written by David K. Buck & Aaron A. Collins.
+///
+/// @endparblock
+///
+//******************************************************************************
+
+#ifndef POVRAY_PARSER_TEXTURECACHE_H
+#define POVRAY_PARSER_TEXTURECACHE_H
+
+// Module config header file must be the first file included within POV-Ray unit header files
+#include "parser/configparser.h"
+
+// C++ variants of C standard header files
+//  (none at the moment)
+
+// C++ standard header files
+#include <vector>
+
+// POV-Ray header files (base module)
+#include "base/stringtypes.h"
+#include "base/image/image.h"
+
+// POV-Ray header files (core module)
+//  (none at the moment)
+
+// POV-Ray header files (parser module)
+#include "parser/parsertypes.h"
+
+namespace pov_parser
+{
+
+using namespace pov_base;
+
+//******************************************************************************
+
+/// Class implementing a cache of MIP-mapped image files.
+///
+/// Decoding large image files is slow, and the decoded images are held in
+/// memory in their entirety even if only a small portion is ever looked at,
+/// or only at a distance. To avoid this, this class keeps a tiled copy of
+/// each image, along with successively halved versions for filtering,
+/// in a directory on disk; the copies are read tile by tile, so that only the
+/// portions actually used by the renderer are ever loaded, and only a limited
+/// number of tiles is held in memory at any time.
+///
+/// Cache entries are validated against the size and a hash of the actual
+/// image file content, as well as the decoding options, so modified files
+/// are picked up reliably.
+///
+/// @note
+///     This class is thread-safe.
+///
+class TextureCache final
+{
+public:
+
+    /// Read an image, via the cache if possible.
+    ///
+    /// @note
+    ///     The stream must be freshly opened.
+    ///
+    /// @param[in]  pStream         Stream to read the image from.
+    /// @param[in]  type            File format of the image.
+    /// @param[in]  options         Options to decode the image with.
+    /// @param[in]  diskCachePath   Directory to store the MIP-mapped copies in.
+    /// @param[in]  memoryLimit     Maximum amount of memory to hold tiles of
+    ///                             the MIP-mapped copies in, in bytes.
+    /// @param[out] mipLevels       Successively halved versions of the image,
+    ///                             or empty if the image was not cached. The
+    ///                             caller takes ownership.
+    /// @return                     The full-resolution image. The caller
+    ///                             takes ownership.
+    ///
+    static Image *Get(StreamPtr pStream, Image::ImageFileType type, const ImageReadOptions& options,
+                      const UCS2String& diskCachePath, size_t memoryLimit, std::vector<Image*>& mipLevels);
+
+private:
+
+    TextureCache() = delete;
+};
+
+}
+// end of namespace pov_parser
+
+#endif // POVRAY_PARSER_TEXTURECACHE_H
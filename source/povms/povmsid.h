@@ -294,6 +294,7 @@ enum
 
     kPOVAttrib_ContinueTrace         = 'ConT',
     kPOVAttrib_BackupTrace           = 'BacT',
+    kPOVAttrib_ImportTraceLog        = 'ImTL',
 
     kPOVAttrib_Verbose               = 'Verb',
     kPOVAttrib_DebugConsole          = 'DCon',
@@ -334,6 +335,8 @@ enum
     kPOVAttrib_FieldRender           = 'FldR', // currently not supported by code
     kPOVAttrib_OddField              = 'OddF', // currently not supported by code
     kPOVAttrib_FrameStep             = 'FStp',
+    kPOVAttrib_ContinuedAnimation    = 'CnAn',
+    kPOVAttrib_LastAnimationFrame    = 'LAnF',
 
     kPOVAttrib_OutputToFile          = 'OToF',
     kPOVAttrib_OutputFileType        = 'OFTy',
@@ -365,6 +368,11 @@ enum
     // options handled by scene/parser
     kPOVAttrib_InputFile             = 'IFNa',
     kPOVAttrib_IncludeHeader         = 'IncH',
+    kPOVAttrib_IncludeCachePath      = 'IncC',
+    kPOVAttrib_IncludeCacheMaxFileSize = 'IncM',
+    kPOVAttrib_TextureCachePath      = 'TexC',
+    kPOVAttrib_TextureCacheMemory    = 'TexM',
+    kPOVAttrib_ReuseStaticObjects    = 'RStO',
 
     kPOVAttrib_WarningLevel          = 'WLev',
     kPOVAttrib_Declare               = 'Decl',
@@ -418,6 +426,9 @@ enum
     kPOVAttrib_RadiosityFromFile     = 'RaFF',
     kPOVAttrib_RadiosityToFile       = 'RaTF',
     kPOVAttrib_RadiosityVainPretrace = 'RaVP',
+    kPOVAttrib_ReuseStaticLighting   = 'RStL',
+    kPOVAttrib_ExportLighting        = 'ExLi',
+    kPOVAttrib_ImportLighting        = 'ImLi',
 
     kPOVAttrib_RenderBlockSize       = 'RBSi',
 
@@ -463,6 +474,12 @@ enum
     kPOVAttrib_BSPAborts             = 'BAbo',
     kPOVAttrib_BSPAverageAborts      = 'BAAb',
     kPOVAttrib_BSPAverageAbortObjects = 'BAAO',
+    kPOVAttrib_BVHNodes              = 'VNod',
+    kPOVAttrib_BVHLeafNodes          = 'VLNo',
+    kPOVAttrib_BVHMaxObjects         = 'VMOb',
+    kPOVAttrib_BVHAverageObjects     = 'VAOb',
+    kPOVAttrib_BVHMaxDepth           = 'VMDe',
+    kPOVAttrib_BVHAverageDepth       = 'VADe',
 
     // statistics generated by view/render (radiosity)
     kPOVAttrib_RadGatherCount        = 'RGCt',
@@ -645,6 +662,8 @@ enum
     // Rendering order
     kPOVAttrib_RenderBlockStep       = 'RBSt',
     kPOVAttrib_RenderPattern         = 'RPat',
+    kPOVAttrib_RenderBlockSubsetCount= 'RBSC',
+    kPOVAttrib_RenderBlockSubsetIndex= 'RBSN',
 
     // helpers
     kPOVAttrib_StartColumn           = kPOVAttrib_Left,
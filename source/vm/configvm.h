@@ -60,11 +60,44 @@
     #define SYS_MATH_RETURN double
 #endif
 
+/// @def TRY_FUNCTION_JIT
+/// Whether the platform provides a native code generator for user-defined functions.
+///
+/// Define if the platform can translate compiled functions into native code when they are added
+/// to the virtual machine. Leave undefined otherwise. Functions the code generator cannot handle
+/// are still executed by @ref pov::POVFPU_RunDefault().
+///
+/// @note
+///     If this macro is defined, the platform must implement the functions
+///     @ref pov::POVFPU_JITCompile(), @ref pov::POVFPU_JITRelease(), @ref pov::POVFPU_RunJIT()
+///     and @ref pov::POVFPU_RunBatchJIT() as declared in @ref vm/fnpovfpu.h.
+///
+#ifndef TRY_FUNCTION_JIT
+    // leave undefined
+#endif
+
+#ifdef TRY_FUNCTION_JIT
+    #define POVFPU_Run(ctx, fn) POVFPU_RunJIT(ctx, fn)
+    #define POVFPU_RunBatch(ctx, fn, args, argc, results, count) POVFPU_RunBatchJIT(ctx, fn, args, argc, results, count)
+    #define SYS_FUNCTIONS 1
+    #define SYS_ADD_FUNCTION(fn) POVFPU_JITCompile(this, fn)
+    #define SYS_DELETE_FUNCTION(fe) POVFPU_JITRelease(fe)
+    #define SYS_INIT_FUNCTIONS()
+    #define SYS_TERM_FUNCTIONS()
+    #define SYS_RESET_FUNCTIONS()
+    #define SYS_FUNCTION_ENTRY void *jit_code; size_t jit_size;
+#endif
+
 // Function that executes functions, the parameter is the function index
 #ifndef POVFPU_Run
     #define POVFPU_Run(ctx, fn) POVFPU_RunDefault(ctx, fn)
 #endif
 
+// Function that executes functions for a batch of argument tuples
+#ifndef POVFPU_RunBatch
+    #define POVFPU_RunBatch(ctx, fn, args, argc, results, count) POVFPU_RunBatchDefault(ctx, fn, args, argc, results, count)
+#endif
+
 // Adjust to add system specific handling of functions like just-in-time compilation
 #ifndef SYS_FUNCTIONS
     // Note that if SYS_FUNCTIONS is 1, it will enable the field dblstack
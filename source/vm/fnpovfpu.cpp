@@ -1091,10 +1091,11 @@ void FunctionVM::RemoveFunction(FUNCTION fn)
 
         if(functions[fn].reference_count == 0)
         {
+            SYS_DELETE_FUNCTION(&functions[fn]);
+
             FunctionEntry f = functions[fn];
             unsigned int i = 0;
 
-            SYS_DELETE_FUNCTION(&f);
             for(i = 0; i < f.fn.program_size; i++)
             {
                 if(GET_OP(f.fn.program[i]) == OPCODE_CALL)
@@ -1476,6 +1477,49 @@ DBL POVFPU_RunDefault(FPUContext *context, FUNCTION fn)
 #endif
 }
 
+
+/*****************************************************************************
+*
+* FUNCTION
+*
+*   POVFPU_RunBatchDefault
+*
+* INPUT
+*
+*   fn - function reference number
+*   args - argument arrays, args[k][i] being argument k of evaluation i
+*   argc - number of arguments
+*   count - number of evaluations
+*
+* OUTPUT
+*
+*   results - result found in R0 for each evaluation
+*
+* RETURNS
+*
+* AUTHOR
+*
+* DESCRIPTION
+*
+*   Execute a compiled function for a batch of argument tuples.
+*
+* CHANGES
+*
+*   -
+*
+******************************************************************************/
+
+void POVFPU_RunBatchDefault(FPUContext *context, FUNCTION fn, const DBL * const *args, unsigned int argc, DBL *results, size_t count)
+{
+    for(size_t i = 0; i < count; i++)
+    {
+        for(unsigned int k = 0; k < argc; k++)
+            context->SetLocal(k, args[k][i]);
+
+        results[i] = POVFPU_RunDefault(context, fn);
+    }
+}
+
 /*****************************************************************************
 *
 * FUNCTION
@@ -1613,6 +1657,12 @@ DBL FunctionVM::CustomFunction::Execute(GenericFunctionContextPtr pGenericContex
     return POVFPU_Run (pContext, *mpFn);
 }
 
+void FunctionVM::CustomFunction::ExecuteBatch(GenericFunctionContextPtr pGenericContext, const DBL* const* args, unsigned int argc, DBL* results, size_t count)
+{
+    FPUContext* pContext = GetFPUContextPtr(pGenericContext);
+    POVFPU_RunBatch (pContext, *mpFn, args, argc, results, count);
+}
+
 GenericScalarFunctionPtr FunctionVM::CustomFunction::Clone() const
 {
     return new CustomFunction(mpVm.get(), mpVm->CopyFunction(mpFn));
@@ -1651,7 +1701,7 @@ FPUContext::FPUContext(FunctionVM* pVm, TraceThreadData* pThreadData) :
     nextArgument(0)
 {
     #if (SYS_FUNCTIONS == 1)
-    context->dblstack = context->dblstackbase;
+    dblstack = dblstackbase;
     #endif
 }
 
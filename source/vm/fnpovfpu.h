@@ -251,6 +251,14 @@ extern const unsigned int POVFPU_Sys2TableSize;
 
 void POVFPU_Exception(FPUContext *context, FUNCTION fn, const char *msg = nullptr);
 DBL POVFPU_RunDefault(FPUContext *context, FUNCTION k);
+void POVFPU_RunBatchDefault(FPUContext *context, FUNCTION k, const DBL * const *args, unsigned int argc, DBL *results, size_t count);
+
+#ifdef TRY_FUNCTION_JIT
+void POVFPU_JITCompile(FunctionVM *vm, FUNCTION fn);
+void POVFPU_JITRelease(FunctionEntry *f);
+DBL POVFPU_RunJIT(FPUContext *context, FUNCTION fn);
+void POVFPU_RunBatchJIT(FPUContext *context, FUNCTION fn, const DBL * const *args, unsigned int argc, DBL *results, size_t count);
+#endif
 
 void FNCode_Delete(FunctionCode *);
 
@@ -258,6 +266,11 @@ class FunctionVM : public GenericFunctionContextFactory
 {
         friend void POVFPU_Exception(FPUContext *, FUNCTION, const char *);
         friend DBL POVFPU_RunDefault(FPUContext *, FUNCTION);
+#ifdef TRY_FUNCTION_JIT
+        friend void POVFPU_JITCompile(FunctionVM *, FUNCTION);
+        friend DBL POVFPU_RunJIT(FPUContext *, FUNCTION);
+        friend void POVFPU_RunBatchJIT(FPUContext *, FUNCTION, const DBL * const *, unsigned int, DBL *, size_t);
+#endif
 
     public:
 
@@ -271,6 +284,7 @@ class FunctionVM : public GenericFunctionContextFactory
                 virtual void InitArguments(GenericFunctionContextPtr pContext) override;
                 virtual void PushArgument(GenericFunctionContextPtr pContext, DBL arg) override;
                 virtual DBL Execute(GenericFunctionContextPtr pContext) override;
+                virtual void ExecuteBatch(GenericFunctionContextPtr pContext, const DBL* const* args, unsigned int argc, DBL* results, size_t count) override;
                 virtual GenericScalarFunctionPtr Clone() const override;
                 virtual const CustomFunctionSourceInfo* GetSourceInfo() const override;
             protected:
@@ -165,6 +165,10 @@
     #define DISABLE_OPTIMIZED_NOISE_AVX2FMA3
 #endif
 
+#if defined(__x86_64__)
+    #define TRY_FUNCTION_JIT                    // native code generator for user-defined functions.
+#endif
+
 #endif // BUILD_X86
 
 
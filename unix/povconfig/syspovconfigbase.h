@@ -80,7 +80,16 @@
 // We want to implement a specialized Filesystem::DeleteFile.
 #define POV_USE_DEFAULT_DELETEFILE 0
 
+// We want to implement a specialized Filesystem::RenameFile.
+#define POV_USE_DEFAULT_RENAMEFILE 0
+
+// We want to implement a specialized Filesystem::GetFileInfo.
+#define POV_USE_DEFAULT_FILEINFO 0
+
 // We want to implement a specialized Filesystem::LargeFile.
 #define POV_USE_DEFAULT_LARGEFILE 0
 
+// We want to implement a specialized Filesystem::MappedFile.
+#define POV_USE_DEFAULT_MAPPEDFILE 0
+
 #endif // POVRAY_UNIX_SYSPOVCONFIGBASE_H
@@ -38,18 +38,26 @@
 #include <cstdlib>
 
 // C++ standard header files
+#include <algorithm>
+#include <fstream>
+#include <iostream>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 
 // Boost library files
 #include <boost/algorithm/string.hpp>
 
 // Other library header files
+#include <dirent.h>
+#include <fcntl.h>
 #include <termios.h>
 #include <unistd.h>
 #include <sys/select.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
 
 // from directory "vfe"
 #include "vfe.h"
@@ -427,6 +435,206 @@ static void CleanupBenchmark(vfeUnixSession *session, std::string& ini, std::str
     session->DeleteTemporaryFile(SysToUCS2String(pov.c_str()));
 }
 
+// Starts a copy of this program with the same options plus the given ones, writing its console
+// output to a log file.
+static pid_t StartWorker(char **argv, const std::vector<std::string>& options, const std::string& log)
+{
+    std::vector<std::string> args;
+
+    args.push_back(argv[0]);
+    args.push_back("--workers");
+    args.push_back("1");
+    for (char **arg = argv + 1; *arg != nullptr; arg++)
+        args.push_back(*arg);
+    args.push_back("Display=off");
+    args.push_back("Pause_When_Done=off");
+    args.push_back("Continue_Trace=off");
+    args.insert(args.end(), options.begin(), options.end());
+
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        std::vector<char *> cargs;
+        for (std::vector<std::string>::iterator arg = args.begin(); arg != args.end(); arg++)
+            cargs.push_back(const_cast<char *>(arg->c_str()));
+        cargs.push_back(nullptr);
+
+        int fd = open(log.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+        if (fd >= 0)
+        {
+            dup2(fd, STDOUT_FILENO);
+            dup2(fd, STDERR_FILENO);
+            close(fd);
+        }
+        execvp(cargs[0], cargs.data());
+        _exit(127);
+    }
+    return pid;
+}
+
+// Waits for worker processes to finish, terminating them if the render is cancelled. The log of
+// any process that fails is copied to the console.
+static ReturnValue WaitForWorkers(std::vector<pid_t>& pids, const std::vector<std::string>& logs)
+{
+    int running = 0;
+    for (size_t i = 0; i < pids.size(); i++)
+        if (pids[i] > 0)
+            running++;
+
+    bool failed = false;
+    while (running > 0)
+    {
+        ProcessSignal();
+        if (gCancelRender)
+        {
+            for (size_t i = 0; i < pids.size(); i++)
+                if (pids[i] > 0)
+                    kill(pids[i], SIGTERM);
+        }
+
+        for (size_t i = 0; i < pids.size(); i++)
+        {
+            int status;
+            if ((pids[i] > 0) && (waitpid(pids[i], &status, gCancelRender ? 0 : WNOHANG) == pids[i]))
+            {
+                pids[i] = -1;
+                running--;
+                if (!WIFEXITED(status) || (WEXITSTATUS(status) != RETURN_OK))
+                {
+                    if (!gCancelRender)
+                    {
+                        fprintf(stderr, "%s: worker process failed:\n", PACKAGE);
+                        std::ifstream log(logs[i].c_str());
+                        std::cerr << log.rdbuf();
+                    }
+                    failed = true;
+                }
+            }
+        }
+
+        if (running > 0)
+            Delay(100);
+    }
+
+    if (gCancelRender)
+        return RETURN_USER_ABORT;
+    if (failed)
+        return RETURN_ERROR;
+    return RETURN_OK;
+}
+
+// Distributed rendering: the photons and radiosity pretrace are computed once by a first copy of
+// this program using all work threads, and saved to files. Each worker process is then another
+// copy run with the same options, importing that lighting data, tracing every n-th render block
+// only and logging the completed blocks to a render state file of its own. The logs are finally
+// merged into a single file that this process imports in place of rendering, so that the output
+// file is written as usual.
+static ReturnValue RunWorkers(vfeUnixSession *session, int workers, char **argv, std::string& dir, std::string& mergedlog)
+{
+    dir = UCS2toSysString(session->CreateTemporaryFile()) + ".d";
+    mergedlog = dir + "/merged.pov-state";
+    if (mkdir(dir.c_str(), 0700) != 0)
+    {
+        fprintf(stderr, "%s: cannot create directory %s for worker processes\n", PACKAGE, dir.c_str());
+        return RETURN_ERROR;
+    }
+
+    int totalThreads = session->GetIntOption("Work_Threads", 1);
+    std::string lighting = dir + "/lighting";
+
+    fprintf(stderr, "%s: computing lighting with %d thread(s)\n", PACKAGE, totalThreads);
+
+    std::vector<std::string> options;
+    options.push_back("Output_To_File=off");
+    options.push_back("Create_Continue_Trace_Log=off");
+    options.push_back("Work_Threads=" + std::to_string(totalThreads));
+    options.push_back("Export_Lighting=" + lighting);
+
+    std::vector<pid_t> pids(1, StartWorker(argv, options, lighting + ".log"));
+    std::vector<std::string> logs(1, lighting + ".log");
+    if (pids[0] < 0)
+    {
+        fprintf(stderr, "%s: cannot start worker process\n", PACKAGE);
+        return RETURN_ERROR;
+    }
+
+    ReturnValue result = WaitForWorkers(pids, logs);
+    if (result != RETURN_OK)
+        return result;
+
+    // share the render threads between the workers
+    int threads = std::max(1, totalThreads / workers);
+
+    fprintf(stderr, "%s: rendering with %d worker processes of %d thread(s) each\n", PACKAGE, workers, threads);
+
+    pids.clear();
+    logs.clear();
+    for (int i = 0; i < workers; i++)
+    {
+        std::string part = dir + "/part" + std::to_string(i);
+
+        options.clear();
+        options.push_back("Output_To_File=on");
+        options.push_back("Create_Continue_Trace_Log=on");
+        options.push_back("Output_File_Name=" + part);
+        options.push_back("Work_Threads=" + std::to_string(threads));
+        options.push_back("Render_Block_Subset_Count=" + std::to_string(workers));
+        options.push_back("Render_Block_Subset_Index=" + std::to_string(i));
+        options.push_back("Import_Lighting=" + lighting);
+
+        pid_t pid = StartWorker(argv, options, part + ".log");
+        if (pid < 0)
+        {
+            fprintf(stderr, "%s: cannot start worker process %d\n", PACKAGE, i);
+            gCancelRender = true;
+            break;
+        }
+        pids.push_back(pid);
+        logs.push_back(part + ".log");
+    }
+
+    result = WaitForWorkers(pids, logs);
+    if (result != RETURN_OK)
+        return result;
+
+    // merge the render state files, keeping the header of the first one only
+    std::ofstream merged(mergedlog.c_str(), std::ios::binary);
+    for (int i = 0; i < workers; i++)
+    {
+        std::ifstream part((dir + "/part" + std::to_string(i) + ".pov-state").c_str(), std::ios::binary);
+        if (!part)
+        {
+            fprintf(stderr, "%s: worker process %d did not write a render state file\n", PACKAGE, i);
+            return RETURN_ERROR;
+        }
+        if (i > 0)
+            part.seekg(sizeof(pov_frontend::Backup_File_Header));
+        merged << part.rdbuf();
+    }
+    if (!merged)
+    {
+        fprintf(stderr, "%s: cannot write %s\n", PACKAGE, mergedlog.c_str());
+        return RETURN_ERROR;
+    }
+
+    return RETURN_OK;
+}
+
+static void CleanupWorkers(const std::string& dir)
+{
+    if (DIR *d = opendir(dir.c_str()))
+    {
+        while (struct dirent *entry = readdir(d))
+        {
+            std::string name(entry->d_name);
+            if ((name != ".") && (name != ".."))
+                unlink((dir + "/" + name).c_str());
+        }
+        closedir(d);
+    }
+    rmdir(dir.c_str());
+}
+
 static void TerminateSignalHandler(std::thread* sigthread)
 {
     gTerminateSignalHandler = true;
@@ -455,6 +663,9 @@ int main (int argc, char **argv)
     bool              running_benchmark = false;
     std::string       bench_ini_name;
     std::string       bench_pov_name;
+    int               workers = 1;
+    std::string       workers_dir;
+    std::string       workers_log;
     sigset_t          sigset;
     std::thread*      sigthread;
     char **           argv_copy=argv; /* because argv is updated later */
@@ -560,6 +771,11 @@ int main (int argc, char **argv)
         }
     }
 
+    // distributed rendering
+    if (!running_benchmark)
+        workers = std::max(1, session->GetUnixOptions()->QueryOptionInt("general", "workers", 1));
+    char **worker_argv = argv;
+
     // process INI settings
     if (running_benchmark)
     {
@@ -589,6 +805,35 @@ int main (int argc, char **argv)
         }
         ErrorExit(session);
     }
+
+    if (workers > 1)
+    {
+        if (session->GetIntOption("Initial_Frame", 1) != session->GetIntOption("Final_Frame", session->GetIntOption("Initial_Frame", 1)))
+            fprintf(stderr, "%s: animations cannot be rendered with worker processes, ignoring --workers\n", PACKAGE);
+        else
+        {
+            retval = RunWorkers(session, workers, worker_argv, workers_dir, workers_log);
+            if (retval != RETURN_OK)
+            {
+                CleanupWorkers(workers_dir);
+                session->Shutdown();
+                TerminateSignalHandler(sigthread);
+                delete sigthread;
+                delete session;
+                return retval;
+            }
+
+            // let this process pick up the blocks rendered by the workers
+            opts.AddCommand("Import_Continue_Trace_Log=" + workers_log);
+            session->ClearOptions();
+            if (session->SetOptions(opts) != vfeNoError)
+            {
+                CleanupWorkers(workers_dir);
+                ErrorExit(session);
+            }
+        }
+    }
+
     if (session->StartRender() != vfeNoError)
         ErrorExit(session);
 
@@ -649,6 +894,8 @@ int main (int argc, char **argv)
 
     if (running_benchmark)
         CleanupBenchmark(session, bench_ini_name, bench_pov_name);
+    if (!workers_dir.empty())
+        CleanupWorkers(workers_dir);
 
     if (session->Succeeded() == false)
         retval = gCancelRender ? RETURN_USER_ABORT : RETURN_ERROR;
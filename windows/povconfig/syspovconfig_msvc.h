@@ -216,6 +216,10 @@
     #define TRY_OPTIMIZED_NOISE_AVX2FMA3        // AVX2/FMA3 hand-optimized noise (Intel).
 #endif
 
+#if defined(_M_X64)
+    #define TRY_FUNCTION_JIT                    // native code generator for user-defined functions.
+#endif
+
 #define POV_CPUINFO         CPUInfo::GetFeatures()
 #define POV_CPUINFO_DETAILS CPUInfo::GetDetails()
 #define POV_CPUINFO_H       "cpuid.h"
@@ -61,7 +61,16 @@
 // Windows requires a platform-specific function to delete a file.
 #define POV_USE_DEFAULT_DELETEFILE 0
 
+// Windows requires a platform-specific function to replace a file by renaming.
+#define POV_USE_DEFAULT_RENAMEFILE 0
+
+// Windows requires a platform-specific function to query file size and modification time.
+#define POV_USE_DEFAULT_FILEINFO 0
+
 // Windows gets a platform-specific implementation of large file handling.
 #define POV_USE_DEFAULT_LARGEFILE 0
 
+// Windows gets a platform-specific implementation of memory-mapped files.
+#define POV_USE_DEFAULT_MAPPEDFILE 0
+
 #endif // POVRAY_WINDOWS_SYSPOVCONFIGBASE_H